@@ -0,0 +1,39 @@
+#include "activity_trace.h"
+
+void ActivityTrace::Event(TraceEvent event, int32_t arg) {
+  // slot reserved atomically, so both cores can add events
+  uint32_t index = trace_count_.fetch_add(1, std::memory_order_relaxed) & (kTraceRingSize - 1);
+  trace_ring_[index] = { (uint32_t)millis(), event, arg };
+}
+
+void ActivityTrace::CloseBusyHour() {
+  uint32_t now_ms = millis();
+  uint32_t window_ms = now_ms - busy_window_start_ms_;
+  busy_window_start_ms_ = now_ms;
+  if(window_ms == 0) return;
+
+  for (uint8_t core = 0; core < kCoresCount; core++) {
+    uint32_t busy_us = busy_us_[core].exchange(0, std::memory_order_relaxed);
+    int16_t busy_per_mille = min((uint64_t)busy_us / window_ms, (uint64_t)1000);
+    Event((core == kCore0 ? kTraceCore0BusyHour : kTraceCore1BusyHour), busy_per_mille);
+  }
+}
+
+void ActivityTrace::PrintTrace() {
+  uint32_t count = trace_count_.load(std::memory_order_relaxed);
+  uint32_t next_index = (count > kTraceRingSize ? count - kTraceRingSize : 0);
+  Serial.printf("Activity trace, last %u of %u events:\n", count - next_index, count);
+  TraceEntry entry;
+  while(next_index < count && Read(next_index, entry))
+    Serial.printf("%10u ms  %-20s %ld\n", entry.time_ms, kTraceEventNames[entry.event], (long)entry.arg);
+}
+
+bool ActivityTrace::Read(uint32_t &next_index, TraceEntry &entry) {
+  uint32_t count = trace_count_.load(std::memory_order_relaxed);
+  if(next_index >= count) return false;
+  if(count - next_index > kTraceRingSize)
+    next_index = count - kTraceRingSize;
+  entry = trace_ring_[next_index & (kTraceRingSize - 1)];
+  next_index++;
+  return true;
+}
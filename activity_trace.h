@@ -0,0 +1,78 @@
+#ifndef ACTIVITY_TRACE_H
+#define ACTIVITY_TRACE_H
+
+#include "common.h"
+#include <atomic>
+
+// Timeline trace of clock activity and CPU busy accounting, to see how loop(), loop1(),
+// screensaver, inactivity timeouts, brightness and alarm interact over a day.
+// Events are kept in a small ring that can be called from either core and is dumped on
+// serial command 'T'. Busy time of work sections is summed per core and closed every hour
+// into a busy percentage that is also put in the trace.
+class ActivityTrace {
+
+public:
+
+  enum TraceEvent : uint8_t {
+    kTraceMinuteTick = 0,     // arg = minute of day
+    kTraceTimeJump,           // arg = minute of day
+    kTracePage,               // arg = ScreenPage
+    kTraceBrightness,         // arg = brightness
+    kTraceAlarmStart,
+    kTraceAlarmEnd,
+    kTraceTaskStart,          // arg = SecondCoreTask
+    kTraceTaskDone,           // arg = SecondCoreTask * 10 + success
+    kTraceCore0BusyHour,      // arg = busy per mille of last hour
+    kTraceCore1BusyHour,      // arg = busy per mille of last hour
+    kTraceNetworkSession,     // arg = session tasks count
+    kTraceRadioOnDay,         // arg = radio on seconds of last day
+    kTraceWiFiConnect,        // arg = WiFiConnectState * 10 + attempt
+    kTraceEventsCount,
+  };
+
+  enum Core : uint8_t {
+    kCore0 = 0,     // loop()
+    kCore1,         // loop1()
+    kCoresCount,
+  };
+
+  struct TraceEntry {
+    uint32_t time_ms;
+    TraceEvent event;
+    int32_t arg;
+  };
+
+  void Event(TraceEvent event, int32_t arg = 0);
+
+  // add time spent in a work section
+  void AddBusyTime(Core core, uint32_t busy_us) { busy_us_[core].fetch_add(busy_us, std::memory_order_relaxed); }
+
+  // close busy accounting window, call once every hour
+  void CloseBusyHour();
+
+  void PrintTrace();
+
+  // read events in order, next_index starts at 0 and is advanced past each event read
+  // events overwritten in the ring since last read are skipped, returns false when no event is left
+  bool Read(uint32_t &next_index, TraceEntry &entry);
+
+  static const char* EventName(TraceEvent event) { return kTraceEventNames[event]; }
+
+private:
+
+  static const uint8_t kTraceRingSize = 64;    // power of 2
+  TraceEntry trace_ring_[kTraceRingSize] = {};
+  std::atomic<uint32_t> trace_count_ = {0};
+
+  std::atomic<uint32_t> busy_us_[kCoresCount] = {};
+  uint32_t busy_window_start_ms_ = 0;
+
+  static inline const char* const kTraceEventNames[kTraceEventsCount] = {
+    "minute", "time_jump", "page", "brightness", "alarm_start", "alarm_end",
+    "task_start", "task_done", "core0_busy_permille", "core1_busy_permille",
+    "network_session", "radio_on_s_day", "wifi_connect"
+  };
+
+};
+
+#endif  // ACTIVITY_TRACE_H
@@ -4,6 +4,8 @@
 #include "wifi_stuff.h"
 #include "nvs_preferences.h"
 #include "touchscreen.h"
+#include "minute_scheduler.h"
+#include "activity_trace.h"
 
 // program setup function
 void AlarmClock::Setup() {
@@ -14,8 +16,10 @@ void AlarmClock::Setup() {
   pinMode(BUZZER_PIN, OUTPUT);
   digitalWrite(BUZZER_PIN, LOW);
 
-  // retrieve alarm settings
-  nvs_preferences->RetrieveAlarmSettings(alarm_hr_, alarm_min_, alarm_is_AM_, alarm_ON_);
+  // retrieve alarm schedule
+  nvs_preferences->RetrieveAlarmSchedule(alarm_schedule_);
+  last_minute_of_week_ = rtc->Now().minute_of_week();
+  UpdateNextAlarm(last_minute_of_week_, /*skip_this_minute = */ false);
 
   // retrieve long press seconds
   nvs_preferences->RetrieveLongPressSeconds(alarm_long_press_seconds_);
@@ -26,118 +30,261 @@ void AlarmClock::Setup() {
   PrintLn("Alarm Clock Initialized!");
 }
 
-void AlarmClock::SaveAlarm() {
-  alarm_hr_ = var_1_;
-  alarm_min_ = var_2_;
-  alarm_is_AM_ = var_3_is_AM_;
-  alarm_ON_ = var_4_ON_;
+void AlarmClock::LoadSetScreenVariables(uint8_t slot) {
+  if(slot >= kAlarmSlotsMax) return;
+  var_0_slot_ = slot;
+  uint16_t minute_of_day = alarm_schedule_[slot].minute_of_day;
+  var_1_ = (minute_of_day / 60) % 12;
+  if(var_1_ == 0) var_1_ = 12;
+  var_2_ = minute_of_day % 60;
+  var_3_is_AM_ = (minute_of_day < 12 * 60);
+  var_4_ON_ = alarm_schedule_[slot].on;
+  var_5_weekday_mask_ = alarm_schedule_[slot].weekday_mask;
+}
 
-  // save alarm settings
-  nvs_preferences->SaveAlarm(alarm_hr_, alarm_min_, alarm_is_AM_, alarm_ON_);
+void AlarmClock::SaveAlarm() {
+  // alarm set page edits slot var_0_slot_
+  uint16_t minute_of_day = (var_1_ % 12) * 60 + var_2_ + (var_3_is_AM_ ? 0 : 12 * 60);
+  SetAlarmSlot(var_0_slot_, minute_of_day, var_4_ON_, var_5_weekday_mask_);
 
   PrintLn("Alarm Settings Saved!");
 }
 
-int16_t AlarmClock::MinutesToAlarm() {
+void AlarmClock::SetAlarmSlot(uint8_t slot, uint16_t minute_of_day, bool on, uint8_t weekday_mask, bool save) {
+  if(slot >= kAlarmSlotsMax || minute_of_day >= kMinutesInDay) return;
 
-  if(!alarm_ON_) return -1;
+  alarm_schedule_[slot].minute_of_day = minute_of_day;
+  alarm_schedule_[slot].on = on;
+  alarm_schedule_[slot].weekday_mask = weekday_mask & kAlarmEveryDay;
 
-  uint16_t minutesToday, alarmAtMinute;
+  // save alarm schedule
+  if(save)
+    nvs_preferences->SaveAlarmSchedule(alarm_schedule_);
 
-  // calculate alarmAtMinute
-  if(alarm_hr_ == 12)
-    alarmAtMinute = alarm_min_;
-  else
-    alarmAtMinute = alarm_hr_ * 60 + alarm_min_;
-  if(!alarm_is_AM_) 
-    alarmAtMinute += 12 * 60;
-
-  // calculate minutesToday
-  if(rtc->hourModeAndAmPm() == 0) {
-    // 24 hour clock mode
-    minutesToday = rtc->hour() * 60 + rtc->minute();
+  UpdateNextAlarm(rtc->Now().minute_of_week(), /*skip_this_minute = */ false);
+}
+
+// main page alarm on/off: turns every slot off, remembering which were on, or turns them back on.
+// If none are remembered (first toggle after boot), slot 0 is turned on.
+void AlarmClock::ToggleAlarms() {
+  if(alarm_ON_) {
+    slots_toggled_off_mask_ = 0;
+    for (int i = 0; i < kAlarmSlotsMax; i++) {
+      if(!alarm_schedule_[i].on) continue;
+      slots_toggled_off_mask_ |= (1 << i);
+      alarm_schedule_[i].on = 0;
+    }
+  }
+  else {
+    if(slots_toggled_off_mask_ == 0) {
+      slots_toggled_off_mask_ = 1;
+      if(alarm_schedule_[0].weekday_mask == 0)
+        alarm_schedule_[0].weekday_mask = kAlarmEveryDay;
+    }
+    for (int i = 0; i < kAlarmSlotsMax; i++)
+      if(slots_toggled_off_mask_ & (1 << i))
+        alarm_schedule_[i].on = 1;
+  }
+
+  nvs_preferences->SaveAlarmSchedule(alarm_schedule_);
+  UpdateNextAlarm(rtc->Now().minute_of_week(), /*skip_this_minute = */ false);
+}
+
+// main page shows the next alarm of the whole schedule, "Alarm Off" if no slot will fire
+void AlarmClock::MirrorNextAlarm() {
+  if(next_alarm_minute_of_week_ < 0) {
+    alarm_ON_ = false;
+    return;
   }
-  else { // 12 hour mode
-    if(rtc->hour() == 12)
-      minutesToday = rtc->minute();
-    else
-      minutesToday = rtc->hour() * 60 + rtc->minute();
-    if(rtc->hourModeAndAmPm() == 2) 
-      minutesToday += 12 * 60;
+  uint16_t minute_of_day = next_alarm_minute_of_week_ % kMinutesInDay;
+  alarm_hr_ = (minute_of_day / 60) % 12;
+  if(alarm_hr_ == 0) alarm_hr_ = 12;
+  alarm_min_ = minute_of_day % 60;
+  alarm_is_AM_ = (minute_of_day < 12 * 60);
+  alarm_ON_ = true;
+}
+
+// find earliest alarm at or after minute_of_week (strictly after if skip_this_minute)
+void AlarmClock::UpdateNextAlarm(uint16_t minute_of_week, bool skip_this_minute) {
+  uint16_t today = minute_of_week / kMinutesInDay;
+  uint16_t min_delta = kMinutesInWeek + 1;
+  for (int i = 0; i < kAlarmSlotsMax; i++) {
+    if(!alarm_schedule_[i].on) continue;
+    // check today and next 7 days, so an alarm only on today's weekday can fire today or next week
+    for (uint16_t d = 0; d <= 7; d++) {
+      if(!(alarm_schedule_[i].weekday_mask & (1 << ((today + d) % 7)))) continue;
+      int32_t delta = (int32_t)d * kMinutesInDay + alarm_schedule_[i].minute_of_day - (minute_of_week % kMinutesInDay);
+      if(delta < 0 || (delta == 0 && skip_this_minute)) continue;
+      if(delta < min_delta) min_delta = delta;
+      break;
+    }
   }
+  if(min_delta > kMinutesInWeek)
+    next_alarm_minute_of_week_ = -1;
+  else
+    next_alarm_minute_of_week_ = (minute_of_week + min_delta) % kMinutesInWeek;
+  if(debug_mode)
+    Serial.printf("Next alarm minute of week: %d\n", next_alarm_minute_of_week_);
+  MirrorNextAlarm();
+  SchedulePreAlarmJob();
+}
+
+void AlarmClock::SetPreAlarmJob(uint8_t job_id, uint8_t minutes_before) {
+  pre_alarm_job_id_ = job_id;
+  pre_alarm_job_minutes_before_ = minutes_before;
+  SchedulePreAlarmJob();
+}
 
-  return alarmAtMinute - minutesToday;
+void AlarmClock::SchedulePreAlarmJob() {
+  if(pre_alarm_job_id_ == MinuteScheduler::kNoJob) return;
+  if(next_alarm_minute_of_week_ < 0)
+    minute_scheduler.CancelJob(pre_alarm_job_id_);
+  else
+    minute_scheduler.ScheduleJobAt(pre_alarm_job_id_, (next_alarm_minute_of_week_ + kMinutesInWeek - pre_alarm_job_minutes_before_) % kMinutesInWeek);
 }
 
-// Function that starts buzzer and Alarm Screen
-// It wait for user to press button to pause buzzer
-// User needs to continue to press and hold button for
-// ALARM_END_BUTTON_PRESS_AND_HOLD_SECONDS to end alarm.
-// If user stops pressing button before alarm end, it will
-// restart buzzer and the alarm end counter.
-// If user does not end alarm by ALARM_MAX_ON_TIME_MS milliseconds,
-// it will end alarm on its own.
-void AlarmClock::BuzzAlarmFn() {
+int16_t AlarmClock::MinutesToAlarm() {
+
+  if(next_alarm_minute_of_week_ < 0) return -1;
+
+  return (next_alarm_minute_of_week_ - rtc->Now().minute_of_week() + kMinutesInWeek) % kMinutesInWeek;
+}
+
+// called once every new minute, returns true if an alarm is due
+bool AlarmClock::NewMinute(uint16_t minute_of_week) {
+  // recompute on day rollover or if time jumped (time set manually or by NTP)
+  if(minute_of_week % kMinutesInDay == 0 || minute_of_week != (last_minute_of_week_ + 1) % kMinutesInWeek)
+    UpdateNextAlarm(minute_of_week, /*skip_this_minute = */ false);
+  last_minute_of_week_ = minute_of_week;
+
+  if(minute_of_week != next_alarm_minute_of_week_)
+    return false;
+
+  // alarm is due, schedule the next one
+  UpdateNextAlarm(minute_of_week, /*skip_this_minute = */ true);
+  return true;
+}
+
+// Starts buzzer and Alarm Screen. AdvanceAlarm() then needs to be called
+// from loop() with the current time and the button event of the pass, if any:
+// User needs to press button to pause buzzer and continue to press and
+// hold button for alarm_long_press_seconds_ to end alarm.
+// If user stops pressing button before alarm end, buzzer and the alarm
+// end counter restart.
+// If user does not end alarm by kAlarmMaxON_TimeMs milliseconds,
+// alarm ends on its own.
+void AlarmClock::StartAlarm(unsigned long now_ms) {
+  if(alarm_state_ != kAlarmIdle) return;
   // start alarm triggered page
   SetPage(kAlarmTriggeredPage);
   //start buzzer!
   BuzzerEnable();
-  bool alarmStopped = false, buzzerPausedByUser = false;
-  unsigned long alarmStartTimeMs = millis();
-  int buttonPressSecondsCounter = alarm_long_press_seconds_;
-  while(!alarmStopped) {
-    ResetWatchdog();
-    // if user presses button then pauze buzzer and start alarm end countdown!
-    if(AnyButtonPressed()) {
-      if(!buzzerPausedByUser) {
+  alarm_start_time_ms_ = now_ms;
+  button_press_seconds_counter_ = alarm_long_press_seconds_;
+  alarm_state_ = kAlarmRinging;
+  activity_trace.Event(ActivityTrace::kTraceAlarmStart);
+}
+
+// button presses and releases are taken from button events, not pin levels. A hold ends the alarm
+// once ButtonEvents has reported it as a long press and it lasted alarm_long_press_seconds_.
+void AlarmClock::AdvanceAlarm(unsigned long now_ms, const ButtonEvents::Event* button_event) {
+  switch(alarm_state_) {
+    case kAlarmIdle:
+      break;
+    case kAlarmRinging:
+      // if user presses button then pause buzzer and start alarm end countdown!
+      // (a button already held when alarm started gives only repeats, it needs to be pressed again)
+      if(button_event != NULL && (button_event->type == ButtonEvents::kPress || button_event->type == ButtonEvents::kChord || button_event->type == ButtonEvents::kLongPress)) {
         BuzzerDisable();
-        buzzerPausedByUser = true;
+        button_press_start_time_ms_ = now_ms;  //note time of button press
+        held_buttons_ = button_event->buttons;
+        long_press_reached_ = (button_event->type == ButtonEvents::kLongPress);
+        alarm_state_ = kAlarmHeld;
       }
-      unsigned long buttonPressStartTimeMs = millis(); //note time of button press
-      // while button is pressed, display seconds countdown
-      while(AnyButtonPressed() && !alarmStopped) {
-        ResetWatchdog();
-        // display countdown to alarm off
-        if(alarm_long_press_seconds_ - (millis() - buttonPressStartTimeMs) / 1000 < buttonPressSecondsCounter) {
-          buttonPressSecondsCounter--;
-          display->AlarmTriggeredScreen(false, buttonPressSecondsCounter);
-        }
-        // end alarm after holding button for ALARM_END_BUTTON_PRESS_AND_HOLD_SECONDS
-        if(millis() - buttonPressStartTimeMs > alarm_long_press_seconds_ * 1000) {
-          alarmStopped = true;
-          // good morning screen! :)
-          display->GoodMorningScreen();
-        }
+      // if user did not stop alarm within kAlarmMaxON_TimeMs, make sure to stop buzzer
+      else if(now_ms - alarm_start_time_ms_ > kAlarmMaxON_TimeMs) {
+        BuzzerDisable();
+        alarm_state_ = kAlarmDismissed;
       }
-    }
-    // activate buzzer if button is not pressed by user
-    if(!AnyButtonPressed() && !alarmStopped) {
-      if(buzzerPausedByUser) {
-        BuzzerEnable();
-        buzzerPausedByUser = false;
+      break;
+    case kAlarmHeld:
+      if(button_event != NULL) {
+        if(button_event->type == ButtonEvents::kRelease)
+          held_buttons_ &= ~button_event->buttons;
+        else
+          held_buttons_ |= button_event->buttons;
+        if(button_event->type == ButtonEvents::kLongPress)
+          long_press_reached_ = true;
       }
+      if(held_buttons_ == 0) {
+        alarm_state_ = kAlarmReleased;
+        break;
+      }
+      // display countdown to alarm off
+      if(alarm_long_press_seconds_ - (int)((now_ms - button_press_start_time_ms_) / 1000) < button_press_seconds_counter_) {
+        button_press_seconds_counter_--;
+        display->AlarmTriggeredScreen(false, button_press_seconds_counter_);
+      }
+      // end alarm after holding button for alarm_long_press_seconds_
+      if(long_press_reached_ && now_ms - button_press_start_time_ms_ > alarm_long_press_seconds_ * 1000UL)
+        GoodMorning(now_ms);
+      break;
+    case kAlarmReleased:
+      // activate buzzer as button is not pressed by user
+      BuzzerEnable();
       // if user lifts button press before alarm end then reset counter and re-display alarm-On screen
-      if(buttonPressSecondsCounter != alarm_long_press_seconds_) {
+      if(button_press_seconds_counter_ != alarm_long_press_seconds_) {
         // display Alarm On screen with seconds user needs to press and hold button to end alarm
-        buttonPressSecondsCounter = alarm_long_press_seconds_;
+        button_press_seconds_counter_ = alarm_long_press_seconds_;
         display->AlarmTriggeredScreen(false, alarm_long_press_seconds_);
       }
-    }
-    // if user did not stop alarm within ALARM_MAX_ON_TIME_MS, make sure to stop buzzer
-    if(millis() - alarmStartTimeMs > kAlarmMaxON_TimeMs) {
-      BuzzerDisable();
-      alarmStopped = true;
-    }
+      alarm_state_ = kAlarmRinging;
+      break;
+    case kAlarmGoodMorning:
+      // sun is animated a frame per loop() pass, so that rest of the system keeps running
+      if(now_ms - good_morning_start_time_ms_ >= kGoodMorningScreenMs) {
+        display->GoodMorningScreenEnd();
+        alarm_state_ = kAlarmDismissed;
+      }
+      else
+        display->GoodMorningScreenFrame();
+      break;
+    case kAlarmDismissed:
+      alarm_state_ = kAlarmIdle;
+      activity_trace.Event(ActivityTrace::kTraceAlarmEnd);
+      // returned from Alarm Triggered Screen and Good Morning Screen
+      // set main page
+      SetPage(kMainPage);
+      inactivity_millis = 0;
+      break;
   }
 }
 
-// Passive Buzzer Timer Interrupt Service Routine
+// good morning screen! :) shown for kGoodMorningScreenMs after a long press, or on its own from serial
+void AlarmClock::GoodMorning(unsigned long now_ms) {
+  if(alarm_state_ != kAlarmIdle && alarm_state_ != kAlarmHeld) return;
+  // keep main page from redrawing over it
+  if(alarm_state_ == kAlarmIdle)
+    SetPage(kAlarmTriggeredPage);
+  display->GoodMorningScreen();
+  good_morning_start_time_ms_ = now_ms;
+  alarm_state_ = kAlarmGoodMorning;
+}
+
+// Passive Buzzer Timer Callbacks
 #if defined(MCU_IS_ESP32)
-void IRAM_ATTR AlarmClock::PassiveBuzzerTimerISR() {
+// esp_timer callback, runs in esp_timer task every kBeepLengthMs, not in an ISR as ledcWrite() and
+// digitalWrite() are not IRAM safe. Buzzer square wave itself is generated by LEDC hardware
+void AlarmClock::BeepTimerCallback(void* arg) {
+  buzzer_timer_isr_count_++;
+  beep_toggle_ = !beep_toggle_;
+  ledcWrite(kBuzzerLedcChannel, (beep_toggle_ ? kBuzzerLedcDuty : 0));
+  digitalWrite(LED_PIN, beep_toggle_);
+}
 #elif defined(MCU_IS_RASPBERRY_PI_PICO_W)
 bool AlarmClock::PassiveBuzzerTimerISR(struct repeating_timer *t) {
-#endif
   // PassiveBuzzerTimerISR() function
+  buzzer_timer_isr_count_++;
   if(millis() - beep_start_time_ms_ > kBeepLengthMs) {
     beep_toggle_ = !beep_toggle_;
     beep_start_time_ms_ = millis();
@@ -146,18 +293,24 @@ bool AlarmClock::PassiveBuzzerTimerISR(struct repeating_timer *t) {
   buzzer_square_wave_toggle_ = !buzzer_square_wave_toggle_;
   digitalWrite(BUZZER_PIN, buzzer_square_wave_toggle_ && beep_toggle_);
 
-  #if defined(MCU_IS_RASPBERRY_PI_PICO_W)
-    return true;
-  #endif
+  return true;
 }
+#endif
 
 void AlarmClock::BuzzerEnable() {
+  buzzer_timer_isr_count_ = 0;
+  buzzer_enable_time_ms_ = millis();
+
   // Timer Enable
   #if defined(MCU_IS_ESP32)
-  // Set alarm to call onTimer function every second (value in microseconds).
-  // Repeat the alarm (third parameter) with unlimited count = 0 (fourth parameter).
-  // timerAlarm(passive_buzzer_timer_ptr_, 1000000 / (kBuzzerFrequency * 2), true, 0);
-  timerAlarmEnable(passive_buzzer_timer_ptr_);
+    // attach buzzer pin to LEDC channel every time as arduino tone() detaches it after playing
+    ledcSetup(kBuzzerLedcChannel, kBuzzerFrequency, kBuzzerLedcResolutionBits);
+    ledcAttachPin(BUZZER_PIN, kBuzzerLedcChannel);
+    // start with a beep
+    beep_toggle_ = true;
+    ledcWrite(kBuzzerLedcChannel, kBuzzerLedcDuty);
+    digitalWrite(LED_PIN, HIGH);
+    esp_timer_start_periodic(beep_timer_, kBeepLengthMs * 1000);
   #elif defined(MCU_IS_RASPBERRY_PI_PICO_W)
     int64_t delay_us = 1000000 / (kBuzzerFrequency * 2);
     add_repeating_timer_us(delay_us, PassiveBuzzerTimerISR, NULL, passive_buzzer_timer_ptr_);
@@ -169,13 +322,10 @@ void AlarmClock::BuzzerEnable() {
 void AlarmClock::BuzzerDisable() {
   // Timer Disable
   #if defined(MCU_IS_ESP32)
-    // If timer is still running
-    // if (passive_buzzer_timer_ptr_) {
-    //   // Stop and free timer
-    //   timerEnd(passive_buzzer_timer_ptr_);
-    //   passive_buzzer_timer_ptr_ = NULL;
-    // }
-    timerAlarmDisable(passive_buzzer_timer_ptr_);
+    esp_timer_stop(beep_timer_);
+    ledcWrite(kBuzzerLedcChannel, 0);
+    ledcDetachPin(BUZZER_PIN);
+    pinMode(BUZZER_PIN, OUTPUT);
   #elif defined(MCU_IS_RASPBERRY_PI_PICO_W)
     cancel_repeating_timer(passive_buzzer_timer_ptr_);
   #endif
@@ -184,19 +334,20 @@ void AlarmClock::BuzzerDisable() {
   buzzer_square_wave_toggle_ = false;
   beep_toggle_ = false;
 
-  PrintLn("BuzzerDisable!");
+  // buzzer interrupt load
+  unsigned long buzzer_on_ms = millis() - buzzer_enable_time_ms_;
+  Serial.printf("BuzzerDisable! Buzzer timer interrupts: %u in %lu ms (%lu per sec)\n", buzzer_timer_isr_count_, buzzer_on_ms, (buzzer_on_ms > 0 ? buzzer_timer_isr_count_ * 1000UL / buzzer_on_ms : 0));
 }
 
 void AlarmClock::SetupBuzzerTimer() {
 
   #if defined(MCU_IS_ESP32)
-    passive_buzzer_timer_ptr_ = timerBegin(1, 80, true);  // using timer 0, prescaler 80 (1MHz as ESP32 is 80MHz), counting up (true)
-    timerAttachInterrupt(passive_buzzer_timer_ptr_, &PassiveBuzzerTimerISR, true);    //attach ISR to timer
-    timerAlarmWrite(passive_buzzer_timer_ptr_, 1000000 / (kBuzzerFrequency * 2), true);
-    // Set timer frequency to 1Mhz
-    // passive_buzzer_timer_ptr_ = timerBegin(1000000);
-    // // Attach onTimer function to our timer.
-    // timerAttachInterrupt(passive_buzzer_timer_ptr_, &PassiveBuzzerTimerISR);
+    // beep gating only, tone is generated by LEDC
+    esp_timer_create_args_t beep_timer_args = {};
+    beep_timer_args.callback = &BeepTimerCallback;
+    beep_timer_args.name = "beep";
+    esp_timer_create(&beep_timer_args, &beep_timer_);
+    ledcSetup(kBuzzerLedcChannel, kBuzzerFrequency, kBuzzerLedcResolutionBits);
   #elif defined(MCU_IS_RASPBERRY_PI_PICO_W)
     passive_buzzer_timer_ptr_ = new struct repeating_timer;
   #endif
@@ -213,46 +364,32 @@ void AlarmClock::DeallocateBuzzerTimer() {
   #endif
 }
 
-// inspired from rp2040 Tone example; Non-blocking
-// Play a note of the specified frequency and for the specified duration.
-// Hold is an optional bool that specifies if this note should be held a
-// little longer, i.e. for eighth notes that are tied together.
-// While waiting for a note to play the waitBreath delay function is used
-// so breath detection and pixel animation continues to run.  No tones
-// will play if the slide switch is in the -/off position or all the
-// candles have been blown out.
-void AlarmClock::playNote(int frequency, int duration, bool hold) {
-  if (hold) {
-    // For a note that's held play it a little longer than the specified duration
-    // so it blends into the next tone (but there's still a small delay to
-    // hear the next note).
-    tone(BUZZER_PIN, frequency, duration + duration / 32);
-  } else {
-    // For a note that isn't held just play it for the specified duration.
-    tone(BUZZER_PIN, frequency, duration);
-  }
+// continuous buzzer tone for melody notes, safe to call from timer callbacks
+void AlarmClock::BuzzerToneOn(uint16_t frequency_hz) {
+  #if defined(MCU_IS_ESP32)
+    ledcAttachPin(BUZZER_PIN, kBuzzerLedcChannel);
+    ledcWriteTone(kBuzzerLedcChannel, frequency_hz);
+  #elif defined(MCU_IS_RP2040)
+    // pico sdk pwm register writes, IRQ safe. pwm counter clock = sys clock / 64
+    const float kPwmClkDiv = 64;
+    uint slice_num = pwm_gpio_to_slice_num(BUZZER_PIN);
+    uint32_t wrap = clock_get_hz(clk_sys) / kPwmClkDiv / frequency_hz - 1;
+    if(wrap > 65535) wrap = 65535;
+    gpio_set_function(BUZZER_PIN, GPIO_FUNC_PWM);
+    pwm_set_clkdiv(slice_num, kPwmClkDiv);
+    pwm_set_wrap(slice_num, wrap);
+    pwm_set_gpio_level(BUZZER_PIN, wrap / 2);
+    pwm_set_enabled(slice_num, true);
+  #endif
 }
 
-// inspired from rp2040 Tone example; Non-blocking
-// Song to play when the candles are blown out.
-void AlarmClock::celebrateSong(int &tone_note_index, unsigned long &next_tone_change_time) {
-  // Play a little charge melody, from:
-  //  https://en.wikipedia.org/wiki/Charge_(fanfare)
-  // Note the explicit boolean parameters in particular the measure=false
-  // at the end.  This means the notes will play without any breath measurement
-  // logic.  Without this false value playNote will try to keep waiting for candles
-  // to blow out during the celebration song!
-
-  int duration = 0;
-  switch(tone_note_index) {
-    case 0: { duration = 183; playNote(392, duration, true); } break;
-    case 1: { duration = 183; playNote(523, duration, true); } break;
-    case 2: { duration = 183; playNote(659, duration, false); } break;
-    case 3: { duration = 275; playNote(784, duration, true); } break;
-    case 4: { duration = 137; playNote(659, duration, false); } break;
-    case 5: { duration = 1100; playNote(784, duration, false); } break;
-    default: { duration = 2000; }
-  }
-  tone_note_index++;
-  next_tone_change_time += duration;
-}
\ No newline at end of file
+void AlarmClock::BuzzerToneOff() {
+  #if defined(MCU_IS_ESP32)
+    ledcWrite(kBuzzerLedcChannel, 0);
+  #elif defined(MCU_IS_RP2040)
+    pwm_set_gpio_level(BUZZER_PIN, 0);
+    // give pin back to SIO, so that beeps of PassiveBuzzerTimerISR through digitalWrite() work again
+    gpio_set_function(BUZZER_PIN, GPIO_FUNC_SIO);
+    gpio_put(BUZZER_PIN, 0);
+  #endif
+}
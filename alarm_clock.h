@@ -2,13 +2,19 @@
 #define ALARM_CLOCK_H
 
 #include "common.h"
+#include "melody.h"
+#include "button_events.h"
 // include files for timer
 #include <stdio.h>
-#if defined(MCU_IS_RP2040)   // include files for timer
+#if defined(MCU_IS_ESP32)
+  #include "esp_timer.h"
+#elif defined(MCU_IS_RP2040)   // include files for timer
   #include <stdio.h>
   #include "pico/stdlib.h"
   #include "hardware/timer.h"
   #include "hardware/irq.h"
+  #include "hardware/pwm.h"
+  #include "hardware/clocks.h"
 #endif
 
 class AlarmClock {
@@ -20,40 +26,97 @@ public:
   // function declerations
   void Setup();
   void SaveAlarm();
+  // fill Set Screen variables from alarm_schedule_[slot]
+  void LoadSetScreenVariables(uint8_t slot);
+  // save = false when caller writes alarm_schedule_ to NVS itself, as in a settings batch
+  void SetAlarmSlot(uint8_t slot, uint16_t minute_of_day, bool on, uint8_t weekday_mask, bool save = true);
+  void ToggleAlarms();
   int16_t MinutesToAlarm();
-  void BuzzAlarmFn();
-  void playNote(int frequency, int duration, bool hold = false);
-  void celebrateSong(int &tone_note_index, unsigned long &next_tone_change_time);
+  bool NewMinute(uint16_t minute_of_week);
+  void StartAlarm(unsigned long now_ms);
+  void AdvanceAlarm(unsigned long now_ms, const ButtonEvents::Event* button_event);
+  void GoodMorning(unsigned long now_ms);
+  bool AlarmActive() { return alarm_state_ != kAlarmIdle; }
+  void BuzzerToneOn(uint16_t frequency_hz);
+  void BuzzerToneOff();
+  // minute scheduler job to keep scheduled minutes_before next alarm
+  void SetPreAlarmJob(uint8_t job_id, uint8_t minutes_before);
 
 
 // OBJECTS and VARIABLES
 
-  // alarm time
+  // next alarm of the schedule, as shown on main page
   uint8_t alarm_hr_ = 7;
   uint8_t alarm_min_ = 0;
   bool alarm_is_AM_ = true;
-  bool alarm_ON_ = true;    // flag to set alarm On or Off
+  bool alarm_ON_ = true;    // false when no slot will fire
+
+  // alarm schedule, next alarm of it is mirrored in alarm_hr_, alarm_min_, alarm_is_AM_, alarm_ON_
+  AlarmSlot alarm_schedule_[kAlarmSlotsMax];
+
+  // alarm state machine, advanced from loop() by AdvanceAlarm()
+  enum AlarmState {
+    kAlarmIdle = 0,
+    kAlarmRinging,      // buzzer on, waiting for button press
+    kAlarmHeld,         // buzzer paused, button is being held
+    kAlarmReleased,     // button let go before long press time, resume ringing
+    kAlarmGoodMorning,  // long press complete, good morning screen animated until kGoodMorningScreenMs
+    kAlarmDismissed,    // good morning screen done or max on time reached
+  };
+  AlarmState alarm_state_ = kAlarmIdle;
 
   // Alarm variables & constants
   uint8_t alarm_long_press_seconds_ = 25;
   const unsigned long kAlarmMaxON_TimeMs = 120*1000;
+  const unsigned long kGoodMorningScreenMs = 5000;
 
-  // Set Screen variables
+  // melody sequencer for alarm and celebration songs
+  Melody melody_;
+
+  // Set Screen variables, var_0_slot_ is the alarm_schedule_ slot being edited
+  uint8_t var_0_slot_ = 0;
   uint8_t var_1_ = alarm_hr_;
   uint8_t var_2_ = alarm_min_;
   bool var_3_is_AM_ = alarm_is_AM_;
   bool var_4_ON_ = alarm_ON_;
+  uint8_t var_5_weekday_mask_ = kAlarmEveryDay;
 
 
 // PRIVATE FUNCTIONS AND VARIABLES / CONSTANTS
 
 private:
 
+  void MirrorNextAlarm();
+  void UpdateNextAlarm(uint16_t minute_of_week, bool skip_this_minute);
+
+  // next alarm fire minute of week (Sunday 12:00 AM = 0), -1 if no alarm is scheduled
+  // refreshed only on alarm edits, day rollover, time jumps and after an alarm fires
+  int16_t next_alarm_minute_of_week_ = -1;
+  uint16_t last_minute_of_week_ = 0;
+
+  // slots ToggleAlarms() turned off, to turn them back on
+  uint8_t slots_toggled_off_mask_ = 0;
+
+  // minute scheduler job rescheduled with next alarm
+  void SchedulePreAlarmJob();
+  uint8_t pre_alarm_job_id_ = 0xFF;
+  uint8_t pre_alarm_job_minutes_before_ = 0;
+
+  // alarm state machine timestamps
+  unsigned long alarm_start_time_ms_ = 0;
+  unsigned long button_press_start_time_ms_ = 0;
+  uint8_t held_buttons_ = 0;            // ButtonEvents bits pressed and not yet released
+  bool long_press_reached_ = false;     // ButtonEvents reported a long press during this hold
+  unsigned long good_morning_start_time_ms_ = 0;
+  int button_press_seconds_counter_ = 0;
+
   // buzzer functions
-  // buzzer used is a passive buzzer which is run using timers
+  // buzzer used is a passive buzzer
+  // ESP32: tone is generated in hardware by a LEDC PWM channel, an esp_timer callback only gates beeps
+  // RP2040: a timer ISR toggles buzzer pin at 2 x kBuzzerFrequency
   void SetupBuzzerTimer();
   #if defined(MCU_IS_ESP32)
-    static void IRAM_ATTR PassiveBuzzerTimerISR();
+    static void BeepTimerCallback(void* arg);
   #elif defined(MCU_IS_RP2040)
     static bool PassiveBuzzerTimerISR(struct repeating_timer *t);
   #endif
@@ -61,9 +124,9 @@ private:
   void BuzzerDisable();
   void DeallocateBuzzerTimer();
 
-  // Hardware Timer
+  // Beep Timer
   #if defined(MCU_IS_ESP32)
-    hw_timer_t *passive_buzzer_timer_ptr_ = NULL;
+    esp_timer_handle_t beep_timer_ = NULL;
   #elif defined(MCU_IS_RP2040)
     struct repeating_timer *passive_buzzer_timer_ptr_ = NULL;
   #endif
@@ -71,6 +134,17 @@ private:
   const int kBuzzerFrequency = 2048;
   static inline const unsigned long kBeepLengthMs = 800;
 
+  #if defined(MCU_IS_ESP32)
+    // LEDC channel for buzzer (arduino tone() uses channel 0, analogWrite() allocates from the top)
+    static inline const uint8_t kBuzzerLedcChannel = 2;
+    static inline const uint8_t kBuzzerLedcResolutionBits = 8;
+    static inline const uint32_t kBuzzerLedcDuty = 128;   // 50% duty square wave
+  #endif
+
+  // buzzer timer callback count while buzzer is enabled, to know interrupt load
+  static inline volatile uint32_t buzzer_timer_isr_count_ = 0;
+  unsigned long buzzer_enable_time_ms_ = 0;
+
   static inline bool buzzer_square_wave_toggle_ = false;
   static inline bool beep_toggle_ = false;
   static inline unsigned long beep_start_time_ms_ = 0;
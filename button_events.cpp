@@ -0,0 +1,150 @@
+#include "button_events.h"
+
+ButtonEvents::ButtonEvents() {
+  for (uint8_t i = 0; i < kButtonsCount; i++) {
+    pinMode(kButtonPins[i], (kButtonActiveLow ? INPUT_PULLUP : INPUT));
+    debouncers_[i].raw_pressed = debouncers_[i].stable_pressed = (digitalRead(kButtonPins[i]) == (kButtonActiveLow ? LOW : HIGH));
+    debouncers_[i].accept_time_us = micros() - kDebounceUs;    // first edge is taken
+  }
+  attachInterrupt(digitalPinToInterrupt(BUTTON_PIN), PushButtonISR, CHANGE);
+  attachInterrupt(digitalPinToInterrupt(INC_BUTTON_PIN), IncButtonISR, CHANGE);
+  attachInterrupt(digitalPinToInterrupt(DEC_BUTTON_PIN), DecButtonISR, CHANGE);
+
+  PrintLn("Button Interrupts Setup!");
+}
+
+// single producer: button ISRs are attached on one core and do not preempt each other
+void IRAM_ATTR ButtonEvents::PushEdge(uint8_t button) {
+  uint8_t head = edge_ring_head_;
+  uint8_t next_head = (head + 1) & (kEdgeRingSize - 1);
+  if(next_head == edge_ring_tail_) {
+    edge_ring_overflows_++;
+    return;
+  }
+  edge_ring_[head].time_us = micros();
+  edge_ring_[head].button = button;
+  edge_ring_[head].pressed = (digitalRead(kButtonPins[button]) == (kButtonActiveLow ? LOW : HIGH));
+  __sync_synchronize();   // edge data visible before head moves
+  edge_ring_head_ = next_head;
+}
+
+void IRAM_ATTR ButtonEvents::PushButtonISR() { PushEdge(kPushButton); }
+void IRAM_ATTR ButtonEvents::IncButtonISR() { PushEdge(kIncButton); }
+void IRAM_ATTR ButtonEvents::DecButtonISR() { PushEdge(kDecButton); }
+
+void ButtonEvents::Update() {
+  // consume edge ring
+  while(edge_ring_tail_ != edge_ring_head_) {
+    __sync_synchronize();
+    Edge edge = edge_ring_[edge_ring_tail_];
+    __sync_synchronize();   // edge copied before slot is released
+    edge_ring_tail_ = (edge_ring_tail_ + 1) & (kEdgeRingSize - 1);
+
+    Debouncer &d = debouncers_[edge.button];
+    d.raw_pressed = edge.pressed;
+    if(edge.time_us - d.accept_time_us >= kDebounceUs && edge.pressed != d.stable_pressed)
+      Accept(edge.button, edge.pressed, edge.time_us);
+  }
+
+  if(edge_ring_overflows_ > 0) {
+    PrintLn("ButtonEvents: edge ring overflows ", edge_ring_overflows_);
+    edge_ring_overflows_ = 0;
+    // edges were lost, last edge in ring may not be current level
+    for (uint8_t i = 0; i < kButtonsCount; i++)
+      debouncers_[i].raw_pressed = (digitalRead(kButtonPins[i]) == (kButtonActiveLow ? LOW : HIGH));
+  }
+
+  uint32_t now_us = micros();
+  uint32_t now_ms = millis();
+  for (uint8_t i = 0; i < kButtonsCount; i++) {
+    Debouncer &d = debouncers_[i];
+    // last edge of a bounce came within lockout time, take settled level
+    if(now_us - d.accept_time_us >= kDebounceUs && d.raw_pressed != d.stable_pressed)
+      Accept(i, d.raw_pressed, now_us);
+
+    // no chord within window, a single press
+    if(d.press_pending && (now_us - d.press_time_us) / 1000 >= kChordWindowMs) {
+      d.press_pending = false;
+      QueueEvent(kPress, (1 << i), d.press_time_us);
+    }
+
+    if(!d.stable_pressed) continue;
+
+    // long press, timestamped when it was reached
+    if(!d.long_press_sent && now_us - d.press_time_us >= kLongPressMs * 1000) {
+      d.long_press_sent = true;
+      QueueEvent(kLongPress, (1 << i), d.press_time_us + kLongPressMs * 1000);
+    }
+
+    if(d.press_pending || d.chorded) continue;
+
+    // repeat while held
+    if((int32_t)(now_ms - d.next_repeat_ms) >= 0) {
+      d.next_repeat_ms = now_ms + kRepeatIntervalMs;
+      QueueEvent(kRepeat, (1 << i), now_us);
+    }
+  }
+}
+
+void ButtonEvents::Accept(uint8_t button, bool pressed, uint32_t time_us) {
+  Debouncer &d = debouncers_[button];
+  d.stable_pressed = pressed;
+  d.accept_time_us = time_us;
+  if(pressed) {
+    d.press_time_us = time_us;
+    d.next_repeat_ms = millis() + kRepeatIntervalMs;
+    d.chorded = false;
+    d.long_press_sent = false;
+    if(button == kPushButton) {
+      QueueEvent(kPress, (1 << button), time_us);
+      return;
+    }
+    // inc + dec together is a chord, if other one's press is still held back
+    Debouncer &other = debouncers_[button == kIncButton ? kDecButton : kIncButton];
+    if(other.press_pending) {
+      other.press_pending = false;
+      other.chorded = d.chorded = true;
+      QueueEvent(kChord, kIncButtonBit | kDecButtonBit, time_us);
+    }
+    else
+      d.press_pending = true;
+  }
+  else {
+    // tap shorter than chord window is still a press
+    if(d.press_pending) {
+      d.press_pending = false;
+      QueueEvent(kPress, (1 << button), d.press_time_us);
+    }
+    QueueEvent(kRelease, (1 << button), time_us);
+  }
+}
+
+void ButtonEvents::QueueEvent(EventType type, uint8_t buttons, uint32_t time_us) {
+  uint8_t next_head = (event_queue_head_ + 1) & (kEventQueueSize - 1);
+  if(next_head == event_queue_tail_)    // full, drop oldest
+    event_queue_tail_ = (event_queue_tail_ + 1) & (kEventQueueSize - 1);
+  event_queue_[event_queue_head_] = { type, buttons, time_us };
+  event_queue_head_ = next_head;
+}
+
+bool ButtonEvents::GetEvent(Event &event) {
+  if(event_queue_tail_ == event_queue_head_)
+    return false;
+  event = event_queue_[event_queue_tail_];
+  event_queue_tail_ = (event_queue_tail_ + 1) & (kEventQueueSize - 1);
+  return true;
+}
+
+void ButtonEvents::RecordReaction(const Event &event) {
+  uint32_t latency_us = micros() - event.edge_time_us;
+  latency_count_++;
+  latency_sum_us_ += latency_us;
+  if(latency_us > latency_max_us_)
+    latency_max_us_ = latency_us;
+  if(debug_mode)
+    Serial.printf("Button press to reaction latency: %u us\n", latency_us);
+}
+
+void ButtonEvents::PrintLatencyStats() {
+  Serial.printf("Button press to reaction latency: count=%u avg=%u us max=%u us\n", latency_count_, (latency_count_ > 0 ? (uint32_t)(latency_sum_us_ / latency_count_) : 0), latency_max_us_);
+}
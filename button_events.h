@@ -0,0 +1,106 @@
+#ifndef BUTTON_EVENTS_H
+#define BUTTON_EVENTS_H
+
+#include "common.h"
+#if !defined (MCU_IS_ESP32)
+ #define IRAM_ATTR
+#endif
+
+// Push buttons read using GPIO edge interrupts.
+// ISRs push timestamped edges into a lock-free single producer single consumer ring,
+// Update() called from loop() debounces them and emits press, release, repeat, long press and chord
+// events. A press of inc or dec is held back for kChordWindowMs, so that inc + dec pressed together
+// give only a chord event. Edge timestamps allow measuring press to reaction latency.
+class ButtonEvents {
+
+public:
+
+  enum Button : uint8_t {
+    kPushButton = 0,
+    kIncButton,
+    kDecButton,
+    kButtonsCount,
+  };
+
+  // Event::buttons bits
+  static const uint8_t kPushButtonBit = (1 << kPushButton), kIncButtonBit = (1 << kIncButton), kDecButtonBit = (1 << kDecButton);
+
+  enum EventType : uint8_t {
+    kPress = 0,
+    kRelease,
+    kRepeat,        // button still held, every kRepeatIntervalMs
+    kLongPress,     // button held for kLongPressMs, once per hold, also when part of a chord
+    kChord,         // inc and dec buttons pressed together, within kChordWindowMs
+  };
+
+  struct Event {
+    EventType type;
+    uint8_t buttons;          // kPushButtonBit | kIncButtonBit | kDecButtonBit
+    uint32_t edge_time_us;    // micros() at the interrupt edge (or repeat / long press time) that caused this event
+  };
+
+  ButtonEvents();
+  void Update();
+  bool GetEvent(Event &event);
+  bool Pressed(Button button) { return debouncers_[button].stable_pressed; }
+  bool AnyPressed() { return Pressed(kPushButton) || Pressed(kIncButton) || Pressed(kDecButton); }
+
+  // latency instrumentation: call when an event has been acted upon
+  void RecordReaction(const Event &event);
+  void PrintLatencyStats();
+
+private:
+
+  static const bool kButtonActiveLow = true;
+  static const uint32_t kDebounceUs = 20000;
+  static const uint32_t kRepeatIntervalMs = kUserInputDelayMs;
+  static const uint32_t kChordWindowMs = 100;
+  static const uint32_t kLongPressMs = 1000;
+
+  // edge ring written by ISRs, read by Update()
+  struct Edge {
+    uint32_t time_us;
+    uint8_t button;
+    bool pressed;
+  };
+  static const uint8_t kEdgeRingSize = 32;    // power of 2
+  static inline Edge edge_ring_[kEdgeRingSize];
+  static inline volatile uint8_t edge_ring_head_ = 0;   // written by ISRs only
+  static inline volatile uint8_t edge_ring_tail_ = 0;   // written by Update() only
+  static inline volatile uint16_t edge_ring_overflows_ = 0;
+  static inline const int kButtonPins[kButtonsCount] = { BUTTON_PIN, INC_BUTTON_PIN, DEC_BUTTON_PIN };
+
+  static void IRAM_ATTR PushEdge(uint8_t button);
+  static void IRAM_ATTR PushButtonISR();
+  static void IRAM_ATTR IncButtonISR();
+  static void IRAM_ATTR DecButtonISR();
+
+  // debouncer state per button
+  // leading edge debounce: first edge after a quiet kDebounceUs is taken, edges within kDebounceUs after it are bounce
+  struct Debouncer {
+    bool stable_pressed;
+    bool raw_pressed;
+    uint32_t accept_time_us;    // last level change taken, compared as elapsed time so it holds across micros() wrap
+    uint32_t press_time_us;
+    uint32_t next_repeat_ms;
+    bool press_pending;     // inc or dec press waiting for chord window to pass
+    bool chorded;           // part of a chord, no repeats until pressed again
+    bool long_press_sent;
+  };
+  Debouncer debouncers_[kButtonsCount] = {};
+  void Accept(uint8_t button, bool pressed, uint32_t time_us);
+
+  // events queue, produced and consumed in loop()
+  static const uint8_t kEventQueueSize = 8;    // power of 2
+  Event event_queue_[kEventQueueSize];
+  uint8_t event_queue_head_ = 0, event_queue_tail_ = 0;
+  void QueueEvent(EventType type, uint8_t buttons, uint32_t time_us);
+
+  // press to reaction latency
+  uint32_t latency_count_ = 0;
+  uint32_t latency_max_us_ = 0;
+  uint64_t latency_sum_us_ = 0;
+
+};
+
+#endif  // BUTTON_EVENTS_H
@@ -5,7 +5,6 @@
 #include <Arduino.h>
 #include "pin_defs.h"
 #include "general_constants.h"
-#include <queue>          // std::queue
 #include <vector>         // std::vector
 #include "SPI.h"
 #include <elapsedMillis.h>
@@ -31,7 +30,7 @@ class AlarmClock;
 class WiFiStuff;
 class EEPROM;
 class NvsPreferences;
-class PushButtonTaps;
+class ButtonEvents;
 class Touchscreen;
 
 // spi
@@ -43,9 +42,7 @@ extern RGBDisplay* display;
 extern AlarmClock* alarm_clock;
 extern WiFiStuff* wifi_stuff;
 extern NvsPreferences* nvs_preferences;
-extern PushButtonTaps* push_button;
-extern PushButtonTaps* inc_button;
-extern PushButtonTaps* dec_button;
+extern ButtonEvents* button_events;
 extern Touchscreen* ts;
 
 // debug mode turned On by pulling debug pin Low
@@ -100,9 +97,17 @@ enum Cursor {
   kCursorNoSelection = 0,
   kMainPageSettingsWheel,
   kMainPageSetAlarm,
+  kAlarmSetPageSlot,
   kAlarmSetPageHour,
   kAlarmSetPageMinute,
   kAlarmSetPageAmPm,
+  kAlarmSetPageSunday,    // weekday cursors in order Sunday .. Saturday
+  kAlarmSetPageMonday,
+  kAlarmSetPageTuesday,
+  kAlarmSetPageWednesday,
+  kAlarmSetPageThursday,
+  kAlarmSetPageFriday,
+  kAlarmSetPageSaturday,
   kAlarmSetPageOn,
   kAlarmSetPageOff,
   kAlarmSetPageSet,
@@ -163,13 +168,38 @@ enum SecondCoreTask {
   kConnectWiFi,
   kDisconnectWiFi,
   kFirmwareVersionCheck,
-  kNoTask    // needs to be last entry ibn the enum -> used to create second_core_task_added_flag_array
+  kNoTask    // needs to be last entry ibn the enum -> used to size SecondCoreTaskQueue slots
   };
 
-// second core current task
-// extern volatile SecondCoreTask second_core_task;
-extern std::queue<SecondCoreTask> second_core_tasks_queue;
-extern bool second_core_task_added_flag_array[];
+// returned on adding a second core task, used to wait for that task's completion and result
+struct SecondCoreTaskHandle {
+  SecondCoreTask task;      // kNoTask = invalid handle
+  uint32_t generation;      // submission count of this task
+};
+
+// second core tasks queue
+class SecondCoreTaskQueue;
+extern SecondCoreTaskQueue second_core_tasks;
+
+// minute tick housekeeping jobs
+class MinuteScheduler;
+extern MinuteScheduler minute_scheduler;
+
+// activity timeline trace
+class ActivityTrace;
+extern ActivityTrace activity_trace;
+
+// batches background network jobs into one WiFi session
+class NetworkSessionPlanner;
+extern NetworkSessionPlanner network_session;
+
+// REST API for alarms and settings on the web server
+class RestApi;
+extern RestApi rest_api;
+
+// live display mirror over WebSocket
+class FramebufferMirror;
+extern FramebufferMirror framebuffer_mirror;
 
 
 // Display Items
@@ -194,6 +224,73 @@ struct DisplayButton {
 
 extern std::vector<std::vector<DisplayButton*>> display_pages_vec;
 
+// one alarm of the alarm schedule, packed into 4 bytes and stored as a blob in NVS
+struct AlarmSlot {
+  uint16_t minute_of_day : 11;  // 0 - 1439, 24 hour
+  uint16_t on : 1;
+  uint16_t reserved : 4;
+  uint8_t weekday_mask;         // bit 0 = Sunday .. bit 6 = Saturday
+  uint8_t reserved2;
+};
+const uint8_t kAlarmSlotsMax = 4;
+const uint8_t kAlarmEveryDay = 0x7F;
+const uint16_t kMinutesInDay = 24 * 60, kMinutesInWeek = 7 * 24 * 60;
+
+// last fetched weather with its fetch time, stored as a blob in NVS
+struct WeatherCacheRecord {
+  uint32_t fetch_minutes;         // RTC minutes since 2024 of fetch, 0 = empty
+  uint32_t zip_code;              // location and units the weather was fetched for
+  char country_code[4];
+  uint8_t units_metric;
+  uint8_t humidity;
+  int16_t temp_x10, feels_like_x10, temp_min_x10, temp_max_x10, wind_speed_x10;
+  int32_t gmt_offset_sec;
+  char weather_main[16];
+  char weather_description[32];
+  char city[32];
+};
+
+// last successful WiFi association and DHCP lease, stored as a blob in NVS for fast reconnect
+struct WiFiConnectCacheRecord {
+  uint32_t ssid_hash;             // WiFi details the record is valid for, 0 = empty
+  uint32_t lease_minutes;         // RTC minutes since 2024 when lease was obtained
+  uint8_t bssid[6];
+  uint8_t channel;
+  uint8_t reserved;
+  uint32_t ip, gateway, subnet, dns;
+};
+
+// resolved host address, DnsCache entries are stored as a blob in NVS
+struct DnsCacheRecord {
+  char host[28];                  // "" = empty entry
+  uint32_t ip;                    // as IPAddress uint32_t
+  uint32_t expires_seconds;       // RTC seconds since 2024 when TTL runs out, 0 = expired
+  uint16_t resolve_ms;            // last live resolution time, saved by a cache hit
+  uint16_t reserved;
+};
+
+// resumable OTA download progress, stored as a blob in NVS
+struct OtaCheckpointRecord {
+  uint8_t image_sha256[32];       // firmware being downloaded, from OTA manifest
+  uint32_t partition_address;     // OTA partition it is written to
+  uint32_t bytes_done;            // verified chunks written, 0 = no download in progress
+};
+
+// settings changed together, as by REST API, written to NVS with a single commit
+struct SettingsBatch {
+  uint8_t fields;                 // kSettings... bits of fields to apply
+  uint8_t alarm_slots_mask;       // kSettingsAlarmSchedule: bit per changed slot
+  AlarmSlot alarm_schedule[kAlarmSlotsMax];
+  uint8_t long_press_seconds;
+  uint8_t night_time_dim_hour;    // PM hour
+  uint8_t autorun_rgb_led_strip_mode;
+  bool screensaver_bounce_not_fly_horizontally;
+};
+
+// SettingsBatch fields bits
+const uint8_t kSettingsAlarmSchedule = 0x01, kSettingsLongPressSeconds = 0x02, kSettingsNightTimeDimHour = 0x04,
+  kSettingsAutorunRgbLedStripMode = 0x08, kSettingsScreensaverMotion = 0x10;
+
 // display time data in char arrays
 struct DisplayData {
   char time_HHMM[kHHMM_ArraySize];
@@ -203,14 +300,18 @@ struct DisplayData {
   bool _12_hour_mode;
   bool pm_not_am;
   bool alarm_ON;
+  uint8_t changed_fields;   // kTimeSSChanged | kTimeHHMMChanged | kDateChanged | kAlarmChanged bits, cleared once drawn
 };
 
+// DisplayData changed_fields bits
+const uint8_t kTimeSSChanged = 0x01, kTimeHHMMChanged = 0x02, kDateChanged = 0x04, kAlarmChanged = 0x08;
+
 // Display Visible Data Struct
 extern DisplayData new_display_data_, displayed_data_;
 
 // extern all global functions
-extern void AddSecondCoreTaskIfNotThere(SecondCoreTask task);
-extern void WaitForExecutionOfSecondCoreTask();
+extern SecondCoreTaskHandle AddSecondCoreTaskIfNotThere(SecondCoreTask task, unsigned long deadline_ms = 0);
+extern bool WaitForExecutionOfSecondCoreTask(SecondCoreTaskHandle task_handle, unsigned long timeout_ms = kWatchdogTimeoutMs - 3000);
 extern int AvailableRam();
 extern void SerialInputWait();
 extern void SerialInputFlush();
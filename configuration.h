@@ -24,7 +24,7 @@
 #define WIFI_IS_USED
 
 
-// FIRMWARE VERSION   (update these when pushing new MCU specific binaries to github)
+// FIRMWARE VERSION   (update these when pushing new MCU specific binaries to github, and build/<board>/version.txt manifests)
 
 #define ESP32_S2_MINI_FIRMWARE_VERSION            "2.4"
 #define ESP32_WROOM_DA_MODULE_FIRMWARE_VERSION    "2.4"
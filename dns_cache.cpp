@@ -0,0 +1,181 @@
+#include "dns_cache.h"
+
+DnsCache::Result DnsCache::Resolve(const char* host, uint32_t now_seconds, uint32_t &ip) {
+  DnsCacheRecord* entry = Find(host);
+  if(entry != NULL && now_seconds != 0 && now_seconds < entry->expires_seconds) {
+    ip = entry->ip;
+    hits_++;
+    session_hits_++;
+    saved_ms_ += entry->resolve_ms;
+    session_saved_ms_ += entry->resolve_ms;
+    return kHit;
+  }
+
+  uint32_t ttl_seconds = 0;
+  unsigned long resolve_start_ms = millis();
+  bool resolved = resolver_(host, ip, ttl_seconds);
+  unsigned long resolve_ms = millis() - resolve_start_ms;
+  lookups_++;
+  session_lookups_++;
+
+  if(!resolved) {
+    if(entry != NULL && entry->expires_seconds != 0 && now_seconds - entry->expires_seconds < kStaleMaxSeconds) {
+      ip = entry->ip;
+      return kStale;
+    }
+    return kFailed;
+  }
+
+  if(now_seconds == 0 || strlen(host) >= sizeof(entry->host))
+    return kLive;
+  if(entry == NULL) {
+    // empty entry, else one that expired first
+    entry = &entries_[0];
+    for (uint8_t i = 0; i < kEntries && entry->host[0] != '\0'; i++)
+      if(entries_[i].host[0] == '\0' || entries_[i].expires_seconds < entry->expires_seconds)
+        entry = &entries_[i];
+    strcpy(entry->host, host);
+    entry->ip = 0;
+  }
+  if(entry->ip != ip)
+    entries_changed_ = true;
+  entry->ip = ip;
+  entry->expires_seconds = now_seconds + min(ttl_seconds, (uint32_t)kTtlMaxSeconds);
+  entry->resolve_ms = min(resolve_ms, (unsigned long)UINT16_MAX);
+  return kLive;
+}
+
+void DnsCache::Invalidate(const char* host) {
+  DnsCacheRecord* entry = Find(host);
+  if(entry != NULL)
+    entry->expires_seconds = 0;
+}
+
+void DnsCache::StartSession() {
+  session_hits_ = 0;
+  session_lookups_ = 0;
+  session_saved_ms_ = 0;
+}
+
+void DnsCache::PrintSession() {
+  if(session_hits_ + session_lookups_ == 0)
+    return;
+  Serial.printf("DNS cache: %u hits, %u lookups, %lu ms saved this session, %lu ms since boot\n",
+    session_hits_, session_lookups_, (unsigned long)session_saved_ms_, (unsigned long)saved_ms_);
+}
+
+DnsCacheRecord* DnsCache::Find(const char* host) {
+  for (uint8_t i = 0; i < kEntries; i++)
+    if(entries_[i].host[0] != '\0' && strncmp(entries_[i].host, host, sizeof(entries_[i].host)) == 0)
+      return &entries_[i];
+  return NULL;
+}
+
+size_t DnsCache::BuildQuery(uint8_t* buffer, size_t size, uint16_t id, const char* host) {
+  const uint8_t kHeader[12] = { (uint8_t)(id >> 8), (uint8_t)id, 0x01, 0x00, 0, 1, 0, 0, 0, 0, 0, 0 };   // RD, 1 question
+  size_t host_length = strlen(host);
+  if(host_length == 0 || host_length > 253 || size < sizeof(kHeader) + host_length + 2 + 4)
+    return 0;
+  memcpy(buffer, kHeader, sizeof(kHeader));
+  size_t pos = sizeof(kHeader);
+  // labels: length byte then label chars
+  const char* label = host;
+  while(true) {
+    const char* dot = strchr(label, '.');
+    size_t label_length = (dot == NULL ? strlen(label) : dot - label);
+    if(label_length == 0 || label_length > 63)
+      return 0;
+    buffer[pos++] = label_length;
+    memcpy(buffer + pos, label, label_length);
+    pos += label_length;
+    if(dot == NULL)
+      break;
+    label = dot + 1;
+  }
+  buffer[pos++] = 0;
+  const uint8_t kTypeAClassIn[4] = { 0, 1, 0, 1 };
+  memcpy(buffer + pos, kTypeAClassIn, sizeof(kTypeAClassIn));
+  return pos + sizeof(kTypeAClassIn);
+}
+
+bool DnsCache::ParseResponse(const uint8_t* buffer, size_t length, uint16_t id, const char* host, uint32_t &ip, uint32_t &ttl_seconds) {
+  if(length < 12)
+    return false;
+  uint16_t flags = (buffer[2] << 8) | buffer[3];
+  uint16_t questions = (buffer[4] << 8) | buffer[5];
+  uint16_t answers = (buffer[6] << 8) | buffer[7];
+  // our id, a response, not truncated, no error
+  if(((buffer[0] << 8) | buffer[1]) != id || !(flags & 0x8000) || (flags & 0x0200) || (flags & 0x000F) != 0 || questions != 1)
+    return false;
+  size_t pos = 12;
+  if(!NameEquals(buffer, length, pos, host) || !SkipName(buffer, length, pos) || pos + 4 > length)
+    return false;
+  pos += 4;
+
+  uint32_t chain_ttl = UINT32_MAX;
+  for (uint16_t i = 0; i < answers; i++) {
+    if(!SkipName(buffer, length, pos) || pos + 10 > length)
+      return false;
+    uint16_t type = (buffer[pos] << 8) | buffer[pos + 1];
+    uint16_t rr_class = (buffer[pos + 2] << 8) | buffer[pos + 3];
+    uint32_t ttl = ((uint32_t)buffer[pos + 4] << 24) | ((uint32_t)buffer[pos + 5] << 16) | (buffer[pos + 6] << 8) | buffer[pos + 7];
+    uint16_t data_length = (buffer[pos + 8] << 8) | buffer[pos + 9];
+    pos += 10;
+    if(pos + data_length > length)
+      return false;
+    // TTL with top bit set is treated as 0 (RFC 2181)
+    if(ttl & 0x80000000)
+      ttl = 0;
+    if(rr_class == 1 && type == 5)      // CNAME
+      chain_ttl = min(chain_ttl, ttl);
+    else if(rr_class == 1 && type == 1 && data_length == 4) {
+      ip = buffer[pos] | (buffer[pos + 1] << 8) | (buffer[pos + 2] << 16) | ((uint32_t)buffer[pos + 3] << 24);
+      ttl_seconds = min(chain_ttl, ttl);
+      return true;
+    }
+    pos += data_length;
+  }
+  return false;
+}
+
+// name at pos: labels ending with a zero byte or a compression pointer
+bool DnsCache::SkipName(const uint8_t* buffer, size_t length, size_t &pos) {
+  while(pos < length) {
+    uint8_t label_length = buffer[pos];
+    if(label_length == 0) {
+      pos++;
+      return true;
+    }
+    if((label_length & 0xC0) == 0xC0) {
+      pos += 2;
+      return pos <= length;
+    }
+    if(label_length & 0xC0)
+      return false;
+    pos += 1 + label_length;
+  }
+  return false;
+}
+
+// uncompressed name at pos equals host, ignoring case
+bool DnsCache::NameEquals(const uint8_t* buffer, size_t length, size_t pos, const char* host) {
+  const char* label = host;
+  while(pos < length) {
+    uint8_t label_length = buffer[pos++];
+    if(label_length == 0)
+      return (*label == '\0');
+    if(label_length > 63 || pos + label_length > length)
+      return false;
+    if(label != host) {
+      if(*label != '.')
+        return false;
+      label++;
+    }
+    if(strnlen(label, label_length) != label_length || strncasecmp(label, (const char*)buffer + pos, label_length) != 0
+        || (label[label_length] != '.' && label[label_length] != '\0'))
+      return false;
+    label += label_length;
+    pos += label_length;
+  }
+  return false;
+}
@@ -0,0 +1,61 @@
+#ifndef DNS_CACHE_H
+#define DNS_CACHE_H
+
+#include "common.h"
+
+// DNS results of the few hosts clock talks to (weather and NTP), kept across WiFi sessions so that
+// a short radio session can skip the DNS round trip. Entries are used while their TTL runs, an
+// expired entry resolves live and is used only if live resolution fails, for up to kStaleMaxSeconds.
+// Live resolution is done by resolver, so that cache logic and DNS wire format are host testable.
+class DnsCache {
+
+public:
+
+  // live resolution, ttl_seconds 0 if resolver does not know TTL
+  typedef bool (*Resolver)(const char* host, uint32_t &ip, uint32_t &ttl_seconds);
+
+  enum Result : uint8_t {
+    kFailed = 0,
+    kHit,           // fresh cached address, no DNS query
+    kLive,          // resolved now
+    kStale,         // live resolution failed, expired cached address
+  };
+
+  static const uint8_t kEntries = 4;
+  static const uint32_t kTtlMaxSeconds = 24 * 3600;
+  static const uint32_t kStaleMaxSeconds = 24 * 3600;
+
+  explicit DnsCache(Resolver resolver) : resolver_(resolver) {}
+
+  // now_seconds: RTC seconds since 2024, 0 if clock is not set (nothing is cached then)
+  Result Resolve(const char* host, uint32_t now_seconds, uint32_t &ip);
+  // cached address did not answer, next Resolve() goes live
+  void Invalidate(const char* host);
+
+  // per WiFi session latency saved by cache hits
+  void StartSession();
+  void PrintSession();
+
+  DnsCacheRecord entries_[kEntries] = {};
+  bool entries_changed_ = false;      // host or address changed, worth saving to NVS
+
+  uint16_t session_hits_ = 0, session_lookups_ = 0;
+  uint32_t session_saved_ms_ = 0;
+  uint32_t hits_ = 0, lookups_ = 0, saved_ms_ = 0;
+
+  // DNS message for A record of host with recursion desired, returns length, 0 if host is not a valid name
+  static size_t BuildQuery(uint8_t* buffer, size_t size, uint16_t id, const char* host);
+  // first A record answering query id for host, ttl_seconds is lowest TTL on CNAME chain to it
+  static bool ParseResponse(const uint8_t* buffer, size_t length, uint16_t id, const char* host, uint32_t &ip, uint32_t &ttl_seconds);
+
+private:
+
+  DnsCacheRecord* Find(const char* host);
+  static bool SkipName(const uint8_t* buffer, size_t length, size_t &pos);
+  static bool NameEquals(const uint8_t* buffer, size_t length, size_t pos, const char* host);
+
+  Resolver resolver_;
+
+};
+
+#endif  // DNS_CACHE_H
@@ -0,0 +1,81 @@
+#include "firmware_version_matcher.h"
+
+bool FirmwareVersionMatcher::Reset(const char* search_str) {
+  version[0] = '\0';
+  version_length_ = 0;
+  matched_length_ = 0;
+  state_ = kSearching;
+  size_t search_length = strlen(search_str);
+  if(search_length == 0 || search_length > kMaxSearchLength)
+    return false;
+  search_str_ = search_str;
+  search_length_ = search_length;
+
+  failure_[0] = 0;
+  uint8_t k = 0;
+  for (uint8_t i = 1; i < search_length_; i++) {
+    while(k > 0 && search_str_[i] != search_str_[k])
+      k = failure_[k - 1];
+    if(search_str_[i] == search_str_[k])
+      k++;
+    failure_[i] = k;
+  }
+  return true;
+}
+
+void FirmwareVersionMatcher::Search(char c) {
+  while(matched_length_ > 0 && c != search_str_[matched_length_])
+    matched_length_ = failure_[matched_length_ - 1];
+  if(c == search_str_[matched_length_])
+    matched_length_++;
+  if(matched_length_ == search_length_)
+    state_ = kExpectSpace;
+}
+
+bool FirmwareVersionMatcher::Feed(const uint8_t* data, size_t length) {
+  for (size_t i = 0; i < length && state_ != kDone; i++) {
+    char c = data[i];
+    switch(state_) {
+      case kSearching:
+        Search(c);
+        break;
+      case kExpectSpace:
+        if(c == ' ' || c == '\t')
+          state_ = kExpectQuote;
+        else {
+          // a longer name or not the define, search on from longest matched prefix that is also a suffix
+          matched_length_ = failure_[search_length_ - 1];
+          state_ = kSearching;
+          Search(c);
+        }
+        break;
+      case kExpectQuote:
+        if(c == '"')
+          state_ = kInVersion;
+        else if(c != ' ' && c != '\t') {
+          // a use of the define, no prefix of search string is matched after the spaces
+          matched_length_ = 0;
+          state_ = kSearching;
+          Search(c);
+        }
+        break;
+      case kInVersion:
+        if(c == '"') {
+          version[version_length_] = '\0';
+          state_ = kDone;
+        }
+        else if(version_length_ < sizeof(version) - 1)
+          version[version_length_++] = c;
+        else {
+          // too long for a version, search on after it
+          version_length_ = 0;
+          matched_length_ = 0;
+          state_ = kSearching;
+        }
+        break;
+      default:
+        break;
+    }
+  }
+  return state_ == kDone;
+}
@@ -0,0 +1,52 @@
+#ifndef FIRMWARE_VERSION_MATCHER_H
+#define FIRMWARE_VERSION_MATCHER_H
+
+#include "common.h"
+
+// Streaming matcher of the firmware version define of this MCU, as in configuration.h
+// or in a version manifest served alongside build/ binaries:
+//   #define ESP32_S2_MINI_FIRMWARE_VERSION            "2.4"
+// Body chunks are fed as they arrive, the search string is matched with KMP so that a match
+// split across chunks is found, and only the version literal characters are kept.
+// Only spaces and tabs, at least one, may come between the name and the opening quote, anything
+// else (a longer name, a use of the define, the name in a string) resumes the search. A literal
+// that does not fit version is skipped.
+// Caller stops reading as soon as Done().
+class FirmwareVersionMatcher {
+
+public:
+
+  static const uint8_t kMaxSearchLength = 48;
+
+  // parsed version literal, without quotes
+  char version[16];
+
+  // search_str is kept by pointer, returns false if it is too long
+  bool Reset(const char* search_str);
+  // returns true once version literal is parsed
+  bool Feed(const uint8_t* data, size_t length);
+  bool Done() { return state_ == kDone; }
+
+private:
+
+  enum State : uint8_t {
+    kSearching = 0,
+    kExpectSpace,
+    kExpectQuote,
+    kInVersion,
+    kDone,
+  };
+  State state_ = kSearching;
+
+  const char* search_str_ = "";
+  uint8_t search_length_ = 0;
+  uint8_t matched_length_ = 0;
+  uint8_t failure_[kMaxSearchLength];   // KMP: longest proper prefix that is also a suffix of search_str_[0..i]
+  uint8_t version_length_ = 0;
+
+  // KMP step of search state
+  void Search(char c);
+
+};
+
+#endif  // FIRMWARE_VERSION_MATCHER_H
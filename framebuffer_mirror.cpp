@@ -0,0 +1,87 @@
+#include "framebuffer_mirror.h"
+#if defined(MCU_IS_ESP32)
+  #include <AsyncTCP.h>
+  #include <ESPAsyncWebServer.h>
+  #include "rgb_display.h"
+#endif
+
+#if defined(MCU_IS_ESP32)
+
+void FramebufferMirror::Register(AsyncWebServer* server) {
+  AsyncWebSocket* ws = new AsyncWebSocket("/fb");
+  ws->onEvent([](AsyncWebSocket *ws, AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t length){
+    if(type == WS_EVT_CONNECT) {
+      // oldest viewers beyond kMaxClients are closed, every viewer costs a copy in its send queue
+      ws->cleanupClients(kMaxClients);
+      // redraw so that a new viewer gets the whole screen
+      display->redraw_display_ = true;
+      Serial.printf("Framebuffer mirror client %u connected\n", client->id());
+    }
+  });
+  server->addHandler(ws);
+  budget_us_ = 0;
+  last_blit_us_ = micros();
+  ws_.store(ws);
+}
+
+void FramebufferMirror::Unregister() {
+  ws_.store(NULL);
+  // server deletes WebSocket, wait for a Blit() that still uses it
+  while(blit_active_.load())
+    delay(1);
+}
+
+uint8_t FramebufferMirror::Clients() {
+  AsyncWebSocket* ws = ws_.load();
+  return (ws == NULL ? 0 : ws->count());
+}
+
+// a client's message stays queued until all of it is acknowledged, an empty queue writes a new message
+// to TCP right away inside binaryAll()
+bool FramebufferMirror::QueuesEmpty(AsyncWebSocket* ws) {
+  for (AsyncWebSocketClient &client : ws->getClients())
+    if(client.queueLen() > 0)
+      return false;
+  return true;
+}
+
+void FramebufferMirror::Blit(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h, uint16_t fg, uint16_t bg) {
+  blit_active_.store(true);
+  AsyncWebSocket* ws = ws_.load();
+  if(ws == NULL || ws->count() == 0) {
+    blit_active_.store(false);
+    return;
+  }
+
+  // earn fps_cost_percent_limit_ of time since last blit
+  uint32_t now_us = micros();
+  uint64_t earned_us = (uint64_t)(now_us - last_blit_us_) * fps_cost_percent_limit_ / 100;
+  last_blit_us_ = now_us;
+  budget_us_ = min((int64_t)budget_us_ + (int64_t)earned_us, (int64_t)kBudgetMaxUs);
+
+  if(budget_us_ <= 0 || !QueuesEmpty(ws)) {
+    blits_skipped_++;
+    blit_active_.store(false);
+    return;
+  }
+
+  size_t bitmap_size = ((w + 7) >> 3) * h;
+  AsyncWebSocketMessageBuffer* buffer = ws->makeBuffer(kHeaderSize + bitmap_size);
+  if(buffer != NULL) {
+    uint8_t* message = buffer->get();
+    const uint16_t header[kHeaderSize / 2] = { (uint16_t)x, (uint16_t)y, (uint16_t)w, (uint16_t)h, fg, bg };
+    for (uint8_t i = 0; i < kHeaderSize / 2; i++) {
+      message[2 * i] = header[i] & 0xFF;
+      message[2 * i + 1] = header[i] >> 8;
+    }
+    memcpy(message + kHeaderSize, bitmap, bitmap_size);
+    ws->binaryAll(buffer);
+    blits_sent_++;
+  }
+  blit_active_.store(false);
+
+  // spend budget on time taken by copy and send
+  budget_us_ -= (int32_t)(micros() - now_us);
+}
+
+#endif
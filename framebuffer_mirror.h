@@ -0,0 +1,55 @@
+#ifndef FRAMEBUFFER_MIRROR_H
+#define FRAMEBUFFER_MIRROR_H
+
+#include "common.h"
+#include <atomic>
+
+class AsyncWebServer;
+class AsyncWebSocket;
+
+// Live mirror of display for remote support, on WebSocket /fb of the web server with a viewer page on /fb.html.
+// Every 1-bit canvas blitted to the display by FastDrawTwoColorBitmapSpi() is sent as one binary message:
+//   int16 x, int16 y, uint16 w, uint16 h, uint16 fg_rgb565, uint16 bg_rgb565 (little endian), then
+//   ((w + 7) / 8) * h bitmap bytes, rows MSB first, as in GFXcanvas1 buffer.
+// Canvas bytes are copied once into a message buffer shared by all clients, as the canvas is redrawn before
+// AsyncTCP sends it. Time spent here is budgeted to fps_cost_percent_limit_ of loop() time, blits over
+// budget or while a client still has a message queued are skipped. With empty queues binaryAll() writes the
+// message to TCP before it returns, so the budget is charged its send time too; messages queued behind
+// others would be sent later by AsyncTCP's task, uncharged. Screensaver redraws its whole canvas every
+// frame so a skipped frame is filled in by the next one.
+class FramebufferMirror {
+
+public:
+
+  // server owns the WebSocket handler, Unregister() before deleting server
+  void Register(AsyncWebServer* server);
+  void Unregister();
+
+  // display side, called after every two color bitmap blit
+  void Blit(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h, uint16_t fg, uint16_t bg);
+
+  // max percent of loop() time spent on mirroring, so screensaver fps drops by about this much at most
+  uint8_t fps_cost_percent_limit_ = 10;
+
+  uint32_t blits_sent_ = 0, blits_skipped_ = 0;
+  uint8_t Clients();
+
+private:
+
+  static const uint8_t kHeaderSize = 12;
+  static const uint8_t kMaxClients = 2;
+  // unused budget carried over is capped, so an idle mirror does not send a burst of frames later
+  static const int32_t kBudgetMaxUs = 20000;
+
+  bool QueuesEmpty(AsyncWebSocket* ws);
+
+  // set and cleared by web server side, Blit() holds blit_active_ while it uses ws_
+  std::atomic<AsyncWebSocket*> ws_ = {NULL};
+  std::atomic<bool> blit_active_ = {false};
+
+  int32_t budget_us_ = 0;
+  uint32_t last_blit_us_ = 0;
+
+};
+
+#endif  // FRAMEBUFFER_MIRROR_H
@@ -0,0 +1,232 @@
+#include "json_reader.h"
+
+JsonReader::TokenType JsonReader::Next(Token &token) {
+  token.start = NULL;
+  token.length = 0;
+  while(true) {
+    if(state_ == kFailed)
+      return (token.type = kError);
+    SkipWhitespace();
+    if(pos_ == length_) {
+      token.type = (state_ == kExpectEnd ? kEnd : Fail());
+      return token.type;
+    }
+    char c = data_[pos_];
+    bool in_array = (depth_ > 0 && (array_bits_ & (1 << (depth_ - 1))));
+
+    switch(state_) {
+      case kExpectEnd:
+        return (token.type = Fail());
+
+      case kExpectCommaOrEnd:
+        pos_++;
+        if(c == ',') {
+          state_ = (in_array ? kExpectValue : kExpectKey);
+          continue;
+        }
+        if(c == (in_array ? ']' : '}')) {
+          depth_--;
+          ValueDone();
+          return (token.type = (in_array ? kArrayEnd : kObjectEnd));
+        }
+        return (token.type = Fail());
+
+      case kExpectKeyOrObjectEnd:
+      case kExpectKey:
+        if(c == '}' && state_ == kExpectKeyOrObjectEnd) {
+          pos_++;
+          depth_--;
+          ValueDone();
+          return (token.type = kObjectEnd);
+        }
+        if(c != '"' || !ScanString(token))
+          return (token.type = Fail());
+        // colon belongs to key
+        SkipWhitespace();
+        if(pos_ == length_ || data_[pos_] != ':')
+          return (token.type = Fail());
+        pos_++;
+        state_ = kExpectValue;
+        return (token.type = kKey);
+
+      case kExpectValue:
+      case kExpectValueOrArrayEnd:
+        if(c == ']' && state_ == kExpectValueOrArrayEnd) {
+          pos_++;
+          depth_--;
+          ValueDone();
+          return (token.type = kArrayEnd);
+        }
+        if(c == '{' || c == '[') {
+          if(depth_ >= kMaxDepth)
+            return (token.type = Fail());
+          pos_++;
+          if(c == '[')
+            array_bits_ |= (1 << depth_);
+          else
+            array_bits_ &= ~(1 << depth_);
+          depth_++;
+          state_ = (c == '[' ? kExpectValueOrArrayEnd : kExpectKeyOrObjectEnd);
+          return (token.type = (c == '[' ? kArrayStart : kObjectStart));
+        }
+        if(c == '"') {
+          if(!ScanString(token))
+            return (token.type = Fail());
+          token.type = kString;
+        }
+        else if(c == '-' || (c >= '0' && c <= '9')) {
+          if(!ScanNumber(token))
+            return (token.type = Fail());
+          token.type = kNumber;
+        }
+        else if(c == 't' && ScanLiteral("true"))
+          token.type = kTrue;
+        else if(c == 'f' && ScanLiteral("false"))
+          token.type = kFalse;
+        else if(c == 'n' && ScanLiteral("null"))
+          token.type = kNull;
+        else
+          return (token.type = Fail());
+        ValueDone();
+        return token.type;
+
+      default:
+        return (token.type = Fail());
+    }
+  }
+}
+
+bool JsonReader::SkipValue(const Token &first_token) {
+  if(first_token.type != kObjectStart && first_token.type != kArrayStart)
+    return (first_token.type != kError);
+  uint8_t end_depth = depth_ - 1;
+  Token token;
+  while(depth_ > end_depth)
+    if(Next(token) == kError)
+      return false;
+  return true;
+}
+
+bool JsonReader::Equals(const Token &token, const char* str) {
+  return strlen(str) == token.length && memcmp(token.start, str, token.length) == 0;
+}
+
+bool JsonReader::ToInt(const Token &token, int32_t &value) {
+  if(token.type != kNumber) return false;
+  bool negative = (token.start[0] == '-');
+  int64_t result = 0;
+  for (uint16_t i = (negative ? 1 : 0); i < token.length; i++) {
+    char c = token.start[i];
+    if(c < '0' || c > '9') return false;
+    result = result * 10 + (c - '0');
+    if(result > (int64_t)INT32_MAX + 1) return false;
+  }
+  result = (negative ? -result : result);
+  if(result > INT32_MAX) return false;
+  value = (int32_t)result;
+  return true;
+}
+
+bool JsonReader::CopyString(const Token &token, char* out, size_t size) {
+  if(size == 0) return false;
+  size_t out_length = 0;
+  for (uint16_t i = 0; i < token.length; i++) {
+    char c = token.start[i];
+    if(c == '\\') {
+      c = token.start[++i];    // ScanString made sure an escape is complete
+      if(c == 'n') c = '\n';
+      else if(c == 't') c = '\t';
+      else if(c == 'r') c = '\r';
+      else if(c == 'b') c = '\b';
+      else if(c == 'f') c = '\f';
+      else if(c == 'u') {
+        uint16_t code = 0;
+        for (uint8_t k = 1; k <= 4; k++) {
+          char h = token.start[i + k];
+          code = code * 16 + (h <= '9' ? h - '0' : (h | 0x20) - 'a' + 10);
+        }
+        if(code > 0x7F) return false;
+        c = (char)code;
+        i += 4;
+      }
+    }
+    if(out_length + 1 >= size) return false;
+    out[out_length++] = c;
+  }
+  out[out_length] = '\0';
+  return true;
+}
+
+void JsonReader::SkipWhitespace() {
+  while(pos_ < length_ && (data_[pos_] == ' ' || data_[pos_] == '\n' || data_[pos_] == '\r' || data_[pos_] == '\t'))
+    pos_++;
+}
+
+// string at pos_ (opening quote), token points inside quotes
+bool JsonReader::ScanString(Token &token) {
+  size_t start = ++pos_;
+  while(pos_ < length_) {
+    char c = data_[pos_];
+    if(c == '"') {
+      if(pos_ - start > UINT16_MAX) return false;
+      token.start = data_ + start;
+      token.length = pos_ - start;
+      pos_++;
+      return true;
+    }
+    if((uint8_t)c < 0x20) return false;
+    if(c == '\\') {
+      if(pos_ + 1 >= length_) return false;
+      char e = data_[pos_ + 1];
+      if(e == 'u') {
+        if(pos_ + 5 >= length_) return false;
+        for (uint8_t k = 2; k <= 5; k++) {
+          char h = data_[pos_ + k];
+          if(!((h >= '0' && h <= '9') || ((h | 0x20) >= 'a' && (h | 0x20) <= 'f'))) return false;
+        }
+        pos_ += 6;
+        continue;
+      }
+      if(e != '"' && e != '\\' && e != '/' && e != 'b' && e != 'f' && e != 'n' && e != 'r' && e != 't') return false;
+      pos_ += 2;
+      continue;
+    }
+    pos_++;
+  }
+  return false;
+}
+
+// JSON number grammar: -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+bool JsonReader::ScanNumber(Token &token) {
+  size_t start = pos_;
+  auto digits = [this]() {
+    size_t digits_start = pos_;
+    while(pos_ < length_ && data_[pos_] >= '0' && data_[pos_] <= '9') pos_++;
+    return pos_ > digits_start;
+  };
+  if(data_[pos_] == '-') pos_++;
+  if(pos_ < length_ && data_[pos_] == '0')
+    pos_++;
+  else if(!digits())
+    return false;
+  if(pos_ < length_ && data_[pos_] == '.') {
+    pos_++;
+    if(!digits()) return false;
+  }
+  if(pos_ < length_ && (data_[pos_] == 'e' || data_[pos_] == 'E')) {
+    pos_++;
+    if(pos_ < length_ && (data_[pos_] == '+' || data_[pos_] == '-')) pos_++;
+    if(!digits()) return false;
+  }
+  token.start = data_ + start;
+  token.length = pos_ - start;
+  return true;
+}
+
+bool JsonReader::ScanLiteral(const char* literal) {
+  size_t literal_length = strlen(literal);
+  if(length_ - pos_ < literal_length || memcmp(data_ + pos_, literal, literal_length) != 0)
+    return false;
+  pos_ += literal_length;
+  return true;
+}
@@ -0,0 +1,79 @@
+#ifndef JSON_READER_H
+#define JSON_READER_H
+
+#include "common.h"
+
+// Bounded pull parser for small JSON request bodies, no heap allocation.
+// Next() returns one token at a time, pointing into the caller's buffer, and checks structure
+// (nesting, commas, colons) as it goes. Strings are unescaped only when copied out with
+// CopyString() into a fixed buffer. Nesting deeper than kMaxDepth is an error.
+class JsonReader {
+
+public:
+
+  enum TokenType : uint8_t {
+    kObjectStart = 0,
+    kObjectEnd,
+    kArrayStart,
+    kArrayEnd,
+    kKey,
+    kString,
+    kNumber,
+    kTrue,
+    kFalse,
+    kNull,
+    kEnd,         // root value closed and only whitespace after it
+    kError,       // malformed input, every later Next() returns kError too
+  };
+
+  struct Token {
+    TokenType type;
+    const char* start;    // strings and keys: inside quotes, escapes not decoded
+    uint16_t length;
+  };
+
+  static const uint8_t kMaxDepth = 8;
+
+  JsonReader(const char* data, size_t length) : data_(data), length_(length) {}
+
+  TokenType Next(Token &token);
+  // skip rest of value whose first token was just returned, true if structure is valid
+  bool SkipValue(const Token &first_token);
+  uint8_t depth() { return depth_; }
+
+  // key or string token equals str, token must not contain escapes
+  static bool Equals(const Token &token, const char* str);
+  // integer number token, false for fractions, exponents and out of range values
+  static bool ToInt(const Token &token, int32_t &value);
+  // unescaped string into out with null termination, false if it does not fit or has \u escapes above 0x7F
+  static bool CopyString(const Token &token, char* out, size_t size);
+
+private:
+
+  enum State : uint8_t {
+    kExpectValue = 0,
+    kExpectValueOrArrayEnd,
+    kExpectKeyOrObjectEnd,
+    kExpectKey,
+    kExpectCommaOrEnd,
+    kExpectEnd,
+    kFailed,
+  };
+
+  TokenType Fail() { state_ = kFailed; return kError; }
+  void SkipWhitespace();
+  bool ScanString(Token &token);
+  bool ScanNumber(Token &token);
+  bool ScanLiteral(const char* literal);
+  void ValueDone() { state_ = (depth_ == 0 ? kExpectEnd : kExpectCommaOrEnd); }
+
+  const char* data_;
+  size_t length_;
+  size_t pos_ = 0;
+  State state_ = kExpectValue;
+  uint8_t depth_ = 0;
+  uint8_t array_bits_ = 0;    // bit per depth, set if that level is an array
+
+};
+
+#endif  // JSON_READER_H
@@ -0,0 +1,120 @@
+#include "json_writer.h"
+
+JsonWriter::JsonWriter(char* buffer, size_t size) : buffer_(buffer), size_(size) {
+  if(size_ > 0)
+    buffer_[0] = '\0';
+  else
+    overflow_ = true;
+}
+
+void JsonWriter::BeginObject(const char* key) {
+  Member(key);
+  Append('{');
+  if(depth_ < kMaxDepth) {
+    depth_++;
+    has_members_ &= ~(1 << (depth_ - 1));
+  }
+  else
+    overflow_ = true;
+}
+
+void JsonWriter::EndObject() {
+  if(depth_ > 0) depth_--;
+  Append('}');
+}
+
+void JsonWriter::BeginArray(const char* key) {
+  Member(key);
+  Append('[');
+  if(depth_ < kMaxDepth) {
+    depth_++;
+    has_members_ &= ~(1 << (depth_ - 1));
+  }
+  else
+    overflow_ = true;
+}
+
+void JsonWriter::EndArray() {
+  if(depth_ > 0) depth_--;
+  Append(']');
+}
+
+void JsonWriter::AddInt(const char* key, int32_t value) {
+  Member(key);
+  char number[12];
+  Append(number, snprintf(number, sizeof(number), "%ld", (long)value));
+}
+
+void JsonWriter::AddUInt(const char* key, uint32_t value) {
+  Member(key);
+  char number[12];
+  Append(number, snprintf(number, sizeof(number), "%lu", (unsigned long)value));
+}
+
+void JsonWriter::AddFloat(const char* key, float value, uint8_t decimals) {
+  Member(key);
+  // JSON has no NaN or infinity
+  if(value != value || value > 1e9 || value < -1e9) {
+    Append("null", 4);
+    return;
+  }
+  char number[24];
+  Append(number, snprintf(number, sizeof(number), "%.*f", decimals, value));
+}
+
+void JsonWriter::AddBool(const char* key, bool value) {
+  Member(key);
+  if(value)
+    Append("true", 4);
+  else
+    Append("false", 5);
+}
+
+void JsonWriter::AddString(const char* key, const char* value) {
+  Member(key);
+  Append('"');
+  AppendEscaped(value);
+  Append('"');
+}
+
+// comma before all but first member, then "key":
+void JsonWriter::Member(const char* key) {
+  if(depth_ > 0) {
+    uint8_t bit = 1 << (depth_ - 1);
+    if(has_members_ & bit)
+      Append(',');
+    has_members_ |= bit;
+  }
+  if(key != NULL) {
+    Append('"');
+    AppendEscaped(key);
+    Append("\":", 2);
+  }
+}
+
+void JsonWriter::Append(const char* str, size_t length) {
+  if(overflow_) return;
+  if(length_ + length >= size_) {
+    overflow_ = true;
+    return;
+  }
+  memcpy(buffer_ + length_, str, length);
+  length_ += length;
+  buffer_[length_] = '\0';
+}
+
+void JsonWriter::AppendEscaped(const char* str) {
+  for (; *str != '\0'; str++) {
+    char c = *str;
+    if(c == '"' || c == '\\') {
+      char escaped[2] = { '\\', c };
+      Append(escaped, 2);
+    }
+    else if((uint8_t)c < 0x20) {
+      char escaped[7];
+      Append(escaped, snprintf(escaped, sizeof(escaped), "\\u%04x", (uint8_t)c));
+    }
+    else
+      Append(c);
+  }
+}
@@ -0,0 +1,50 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include "common.h"
+
+// Compact JSON serializer into a caller provided fixed buffer, no heap allocation.
+// Members are appended in order, commas and nesting are tracked on a depth bitmask.
+// Output that does not fit sets overflow() and is cut, the buffer always stays null terminated.
+class JsonWriter {
+
+public:
+
+  JsonWriter(char* buffer, size_t size);
+
+  // key is NULL for root object and array elements
+  void BeginObject(const char* key = NULL);
+  void EndObject();
+  void BeginArray(const char* key);
+  void EndArray();
+
+  void AddInt(const char* key, int32_t value);
+  void AddUInt(const char* key, uint32_t value);
+  void AddFloat(const char* key, float value, uint8_t decimals);
+  void AddBool(const char* key, bool value);
+  // quotes, backslash and control characters are escaped
+  void AddString(const char* key, const char* value);
+
+  const char* c_str() { return buffer_; }
+  size_t length() { return length_; }
+  bool overflow() { return overflow_; }
+
+private:
+
+  void Member(const char* key);
+  void Append(const char* str, size_t length);
+  void Append(char c) { Append(&c, 1); }
+  void AppendEscaped(const char* str);
+
+  char* buffer_;
+  size_t size_;
+  size_t length_ = 0;
+  bool overflow_ = false;
+
+  static const uint8_t kMaxDepth = 8;
+  uint8_t depth_ = 0;
+  uint8_t has_members_ = 0;     // bit per depth, set after first member of that object or array
+
+};
+
+#endif  // JSON_WRITER_H
@@ -67,7 +67,11 @@ Prashant Kumar
 
 ***************************************************************************/
 #include "common.h"
-#include <PushButtonTaps.h>
+#include "button_events.h"
+#include "second_core_task_queue.h"
+#include "minute_scheduler.h"
+#include "activity_trace.h"
+#include "network_session.h"
 #include "eeprom.h"
 #include "nvs_preferences.h"
 #if defined(WIFI_IS_USED)
@@ -79,6 +83,10 @@ Prashant Kumar
 #include "touchscreen.h"
 #if defined(MCU_IS_ESP32)
   #include <esp_task_wdt.h>   // ESP32 Watchdog header
+  #include <esp_timer.h>
+  #include "json_writer.h"
+  #include "rest_api.h"
+  #include "framebuffer_mirror.h"
 #endif
 #include <Adafruit_I2CDevice.h>
 #include <Adafruit_NeoPixel.h>
@@ -87,9 +95,7 @@ Prashant Kumar
 #endif
 
 // modules - hardware or software
-PushButtonTaps* push_button = NULL;   // Push Button object
-PushButtonTaps* inc_button = NULL;   // Push Button object
-PushButtonTaps* dec_button = NULL;   // Push Button object
+ButtonEvents* button_events = NULL;   // Push, Inc and Dec Buttons object
 NvsPreferences* nvs_preferences = NULL;    // ptr to NVS Preferences class object
 WiFiStuff* wifi_stuff = NULL;  // ptr to wifi stuff class object that contains WiFi and Weather Fetch functions
 RTC* rtc = NULL;  // ptr to class object containing RTC HW
@@ -107,11 +113,21 @@ SPIClass* spi_obj = NULL;
 
 // random afternoon hour and minute to update firmware
 uint16_t ota_update_days_minutes = 0;
+const uint16_t kOtaUpdateWindowOpenMinutes = 600;   // 10 AM
 
 // RGB LED Strip Neopixels
 Adafruit_NeoPixel* rgb_led_strip = NULL;
 const int kRgbStripLedCount = 4;  // rgb_led_strip
 bool rgb_led_strip_on = false;
+uint8_t night_time_rgb_led_strip_job = MinuteScheduler::kNoJob;
+
+// minute of week the screensaver last showed main page for the new hour, -1 if never
+int16_t screensaver_hourly_wake_minute_of_week = -1;
+
+#if defined(WIFI_IS_USED)
+  uint8_t ntp_time_update_retry_job = MinuteScheduler::kNoJob;
+  uint32_t last_power_loss_ntp_generation = 0;    // to log once per power loss time update submission
+#endif
 
 // LOCAL FUNCTIONS
 // populate all pages in display_pages_vec
@@ -176,10 +192,8 @@ void setup() {
     spi_obj->begin(TFT_CLK, TS_CIPO, TFT_COPI, TFT_CS); //SCLK, MISO, MOSI, SS
   #endif
 
-  // initialize push button
-  push_button = new PushButtonTaps(BUTTON_PIN);
-  inc_button = new PushButtonTaps(INC_BUTTON_PIN);
-  dec_button = new PushButtonTaps(DEC_BUTTON_PIN);
+  // initialize push buttons
+  button_events = new ButtonEvents();
 
   // initialize modules
   // setup nvs preferences data (needs to be first)
@@ -204,6 +218,8 @@ void setup() {
   // initialize wifi (needs to be before display setup)
   #if defined(WIFI_IS_USED)
     wifi_stuff = new WiFiStuff();
+    wifi_stuff->SetWiFiConnectProgressCallback(WiFiConnectProgress);
+    wifi_stuff->SetOtaProgressCallback(OtaProgress);
   #endif
   // check if hardware has LDR
   use_photoresistor = nvs_preferences->RetrieveUseLdr();
@@ -214,16 +230,13 @@ void setup() {
   if(nvs_preferences->RetrieveIsTouchscreen())
     ts = new Touchscreen();
 
-  // second core task added flag array
-  for (int i = 0; i < kNoTask; i++)
-    second_core_task_added_flag_array[i] = false;
-
   // initialize random seed
-  unsigned long seed = rtc->minute() * 60 + rtc->second();
+  RTC::TimeSnapshot now = rtc->RefreshedNow();
+  unsigned long seed = now.minute * 60 + now.second;
   randomSeed(seed);
 
   // pick random time between 10AM and 6PM for firmware OTA update
-  ota_update_days_minutes = random(600, 1080);
+  ota_update_days_minutes = random(kOtaUpdateWindowOpenMinutes, 1080);
   uint8_t ota_update_hour_mode_and_am_pm, ota_update_hr, ota_update_min;
   rtc->DaysMinutesToClockTime(ota_update_days_minutes, ota_update_hour_mode_and_am_pm, ota_update_hr, ota_update_min);
   Serial.printf("OTA Update random 10AM-6PM time %02d:%02d %s\n", ota_update_hr, ota_update_min, (ota_update_hour_mode_and_am_pm == 1 ? kAmLabel : kPmLabel));
@@ -248,8 +261,10 @@ void setup() {
   rgb_led_strip = new Adafruit_NeoPixel(kRgbStripLedCount, RGB_LED_STRIP_PIN, NEO_GRB + NEO_KHZ800);
   rgb_led_strip->begin();
   autorun_rgb_led_strip_mode = nvs_preferences->RetrieveAutorunRgbLedStripMode();
-  if(autorun_rgb_led_strip_mode > 1)
-    TurnOnRgbStrip();
+  AutorunRgbLedStrip(now.todays_minutes);
+
+  // register minute tick housekeeping jobs
+  SetupMinuteJobs(now);
 
   PopulateDisplayPages(); // needs to be after all saved values have been retrieved
 
@@ -268,23 +283,46 @@ void setup() {
 }
 
 uint8_t frames_per_second = 0;
+uint8_t screensaver_fps = 0;    // frames drawn in last second, 0 when screensaver is off
 
 // arduino loop function on core0 - High Priority one with time update tasks
 void loop() {
-  // note if button pressed or touchscreen touched
-  bool push_button_pressed = push_button->buttonActiveDebounced();
-  bool inc_button_pressed = inc_button->buttonActiveDebounced();
-  bool dec_button_pressed = dec_button->buttonActiveDebounced();
+  // loop iteration time is busy time if any work section runs
+  uint32_t loop_start_us = micros();
+  bool loop_busy = false;
+
+  // note if button pressed (press, repeat or chord event) or touchscreen touched
+  button_events->Update();
+  ButtonEvents::Event button_event;
+  bool button_event_available = button_events->GetEvent(button_event);
+
+  // alarm is ringing: advance alarm state machine with the button event instead of taking user input action
+  if(alarm_clock->AlarmActive()) {
+    alarm_clock->AdvanceAlarm(millis(), (button_event_available ? &button_event : NULL));
+    button_event_available = false;
+    loop_busy = true;
+  }
+
+  // releases and long presses are not user input actions
+  if(button_event_available && (button_event.type == ButtonEvents::kRelease || button_event.type == ButtonEvents::kLongPress))
+    button_event_available = false;
+  bool push_button_pressed = button_event_available && (button_event.buttons & ButtonEvents::kPushButtonBit);
+  bool inc_button_pressed = button_event_available && (button_event.buttons & ButtonEvents::kIncButtonBit);
+  bool dec_button_pressed = button_event_available && (button_event.buttons & ButtonEvents::kDecButtonBit);
 
   // if user presses main LED Push button, show instant response by turning On LED
-  if(push_button_pressed)
-    digitalWrite(LED_PIN, HIGH);
-  else
-    digitalWrite(LED_PIN, LOW);
+  // (LED beeps with buzzer while alarm is ringing)
+  if(!alarm_clock->AlarmActive()) {
+    if(button_events->Pressed(ButtonEvents::kPushButton))
+      digitalWrite(LED_PIN, HIGH);
+    else
+      digitalWrite(LED_PIN, LOW);
+  }
 
   // if a button or touchscreen is pressed then take action
-  if((inactivity_millis >= kUserInputDelayMs) && (push_button_pressed || inc_button_pressed || dec_button_pressed || (ts != NULL && ts->IsTouched()))) {
+  if(!alarm_clock->AlarmActive() && (push_button_pressed || inc_button_pressed || dec_button_pressed || ((inactivity_millis >= kUserInputDelayMs) && ts != NULL && ts->IsTouched()))) {
     bool ts_input = (ts != NULL && ts->IsTouched());
+    loop_busy = true;
     // show instant response by turing up brightness
     display->SetMaxBrightness();
 
@@ -320,7 +358,6 @@ void loop() {
         TurnOffRgbStrip();
       else
         TurnOnRgbStrip();
-      delay(kUserInputDelayMs);
     }
     else if(inc_button_pressed) {
       PrintLn("inc_button");
@@ -353,94 +390,58 @@ void loop() {
 
     // show firmware updated info only for the first time user uses the device
     firmware_updated_flag_user_information = false;
+
+    // press to reaction latency
+    if(button_event_available)
+      button_events->RecordReaction(button_event);
   }
 
   // new second! Update Time!
   if (rtc->rtc_hw_sec_update_) {
     rtc->rtc_hw_sec_update_ = false;
+    loop_busy = true;
 
     // if time is lost because of power failure
     if(rtc->year() < 2024 && !(wifi_stuff->incorrect_wifi_details_) && !(wifi_stuff->incorrect_zip_code)) {
-      PrintLn("**** Update RTC HW Time from NTP Server ****");
-      // update time from NTP server
-      AddSecondCoreTaskIfNotThere(kUpdateTimeFromNtpServer);
-      WaitForExecutionOfSecondCoreTask();
+      // update time from NTP server, not waited for so that WiFi connect does not freeze clock
+      SecondCoreTaskHandle ntp_task_handle = AddSecondCoreTaskIfNotThere(kUpdateTimeFromNtpServer);
+      if(ntp_task_handle.generation != last_power_loss_ntp_generation) {
+        PrintLn("**** Update RTC HW Time from NTP Server ****");
+        last_power_loss_ntp_generation = ntp_task_handle.generation;
+      }
     }
 
     // new minute!
     if (rtc->rtc_hw_min_update_) {
       rtc->rtc_hw_min_update_ = false;
 
+      // resync with RTC HW and take one consistent copy of time for all checks of this minute
+      RTC::TimeSnapshot now = rtc->RefreshedNow();
+      activity_trace.Event(ActivityTrace::kTraceMinuteTick, now.todays_minutes);
+
       // PrintLn("New Minute!");
       // Serial.print("CPU"); Serial.print(xPortGetCoreID()); Serial.print(" "); Serial.println(getCpuFrequencyMhz());
 
-      // Activate Buzzer if Alarm Time has arrived
-      if(rtc->year() >= 2024 && alarm_clock->MinutesToAlarm() == 0) {
-        // go to buzz alarm function and show alarm triggered screen!
-        alarm_clock->BuzzAlarmFn();
-        // returned from Alarm Triggered Screen and Good Morning Screen
-        // set main page
-        SetPage(kMainPage);
-        inactivity_millis = 0;
+      // run housekeeping jobs due this minute
+      // scheduler is ticked first, so that jobs rescheduled below are relative to this minute
+      bool time_jumped = minute_scheduler.Tick(now);
+      // rgb led strip autorun jobs run only at day, evening and night time, re-evaluate after a time jump
+      if(time_jumped) {
+        activity_trace.Event(ActivityTrace::kTraceTimeJump, now.todays_minutes);
+        AutorunRgbLedStrip(now.todays_minutes);
+        network_session.TimeJumped(now.minute_of_week());
       }
 
-      // if screensaver is On, then update time on it
-      if(current_page == kScreensaverPage) {
-        display->refresh_screensaver_canvas_ = true;
-        // every new hour, show main page
-        if(rtc->minute() == 0) {
-          SetPage(kMainPage);
-          inactivity_millis = 0;
-        }
+      // Activate Buzzer if Alarm Time has arrived, reschedules pre alarm job
+      bool alarm_due = alarm_clock->NewMinute(now.minute_of_week());
+      if(now.year >= 2024 && alarm_due) {
+        // start alarm and show alarm triggered screen!
+        alarm_clock->StartAlarm(millis());
       }
 
-      #if defined(WIFI_IS_USED)
-        // try to get weather info 5 mins before alarm time
-        if(alarm_clock->alarm_ON_ && (inactivity_millis > kInactivityMillisLimit) && !(wifi_stuff->incorrect_zip_code) && (alarm_clock->MinutesToAlarm() == 5)) {
-          AddSecondCoreTaskIfNotThere(kGetWeatherInfo);
-          PrintLn("Get Weather Info!");
-        }
-
-        // reset time updated today to false every new day, for auto update of time at 2:01AM
-        if(rtc->hourModeAndAmPm() == 1 && rtc->hour() == 12)
-          wifi_stuff->auto_updated_time_today_ = false;
-
-        // auto update time at 2:01 AM  every morning
-        // (the 1 minute helps take into account daylight savings time that kicks in and ends at 2AM in March and November once every year. At exactly 2AM, server time might not have updated)
-        // try for upto 59 times - once per min until successful time update
-        if(!(wifi_stuff->incorrect_zip_code) && !(wifi_stuff->auto_updated_time_today_) && rtc->hourModeAndAmPm() == 1 && rtc->hour() == 2 && rtc->minute() >= 1) {
-          // update time from NTP server
-          AddSecondCoreTaskIfNotThere(kUpdateTimeFromNtpServer);
-          PrintLn("Get Time Update from NTP Server");
-        }
-
-        // check for firmware update everyday
-        if(rtc->todays_minutes == ota_update_days_minutes) {
-          PrintLn("**** Web OTA Firmware Update Check ****");
-          AddSecondCoreTaskIfNotThere(kFirmwareVersionCheck);
-          WaitForExecutionOfSecondCoreTask();
-        }
-
-        // auto disconnect wifi if connected and inactivity millis is over limit
-        if(wifi_stuff->wifi_connected_ && (inactivity_millis > kInactivityMillisLimit)) {
-          PrintLn("**** Auto disconnect WiFi ****");
-          AddSecondCoreTaskIfNotThere(kDisconnectWiFi);
-        }
-      #endif
-
-      // set rgb led strip
-      if(autorun_rgb_led_strip_mode == 3) { // run rgb led strip all evening + night
-        if(rtc->todays_minutes >= kEveningTimeMinutes || rtc->todays_minutes < kDayTimeMinutes)
-          TurnOnRgbStrip();
-        else
-          TurnOffRgbStrip();
-      }
-      else if(autorun_rgb_led_strip_mode == 2) {  // // run rgb led strip all evening only
-        if(rtc->todays_minutes >= kEveningTimeMinutes && rtc->todays_minutes < night_time_minutes)
-          TurnOnRgbStrip();
-        else
-          TurnOffRgbStrip();
-      }
+      // if screensaver is On, then update time on it
+      if(current_page == kScreensaverPage)
+        display->refresh_screensaver_canvas_ = true;
     }
 
     // prepare date and time arrays
@@ -454,7 +455,7 @@ void loop() {
     // SerialPrintRtcDateTime();
 
     // check for inactivity
-    if(inactivity_millis > (((current_page == kSoftApInputsPage) || (current_page == kLocationInputsPage)) ? 5 * kInactivityMillisLimit : kInactivityMillisLimit)) {
+    if(!alarm_clock->AlarmActive() && inactivity_millis > (((current_page == kSoftApInputsPage) || (current_page == kLocationInputsPage)) ? 5 * kInactivityMillisLimit : kInactivityMillisLimit)) {
       // if softap server is on, then end it
       if(current_page == kSoftApInputsPage)
         AddSecondCoreTaskIfNotThere(kStopSetWiFiSoftAP);
@@ -473,7 +474,7 @@ void loop() {
 
     #if defined(WIFI_IS_USED)
       // update firmware if available
-      if(wifi_stuff->firmware_update_available_) {
+      if(wifi_stuff->firmware_update_available_ && !alarm_clock->AlarmActive()) {
         PrintLn("**** Web OTA Firmware Update ****");
         #if defined(MCU_IS_ESP32)
           // set Web OTA Update Pagte
@@ -490,22 +491,38 @@ void loop() {
     ResetWatchdog();
 
     // print fps
+    screensaver_fps = (current_page == kScreensaverPage ? frames_per_second : 0);
     if(debug_mode && current_page == kScreensaverPage) {
       // Serial.printf("FPS: %d\n", frames_per_second);
       PrintLn("FPS: ", frames_per_second);
-      frames_per_second = 0;
     }
+    frames_per_second = 0;
   }
 
+  #if defined(MCU_IS_ESP32)
+    // apply settings accepted by REST API
+    SettingsBatch settings_batch;
+    if(rest_api.TakePending(settings_batch)) {
+      ApplySettingsBatch(settings_batch);
+      loop_busy = true;
+    }
+  #endif
+
   // make screensaver motion fast
   if(current_page == kScreensaverPage) {
     display->Screensaver();
-    if(debug_mode) frames_per_second++;
+    frames_per_second++;
+    loop_busy = true;
   }
 
   // accept user serial inputs
-  if (Serial.available() != 0)
+  if (Serial.available() != 0) {
     ProcessSerialInput();
+    loop_busy = true;
+  }
+
+  if(loop_busy)
+    activity_trace.AddBusyTime(ActivityTrace::kCore0, micros() - loop_start_us);
 
   #if defined(MCU_IS_ESP32_S2_MINI)
     // ESP32_S2_MINI is single core MCU
@@ -527,14 +544,33 @@ void setup1() {
 void loop1() {
   ResetWatchdog();
   // run the core only to do specific not time important operations
-  while (!second_core_tasks_queue.empty())
+  SecondCoreTask current_task;
+  bool waiting_for_wifi = false;
+  while (second_core_tasks.Pop(current_task))
   {
-    SecondCoreTask current_task = second_core_tasks_queue.front();
+  #if defined(WIFI_IS_USED)
+    // connect WiFi without blocking, task waits in queue while WiFi connects
+    if(TaskNeedsWiFi(current_task) && !(wifi_stuff->wifi_connected_)) {
+      WiFiStuff::WiFiConnectState wifi_state = wifi_stuff->WiFiConnectStep();
+      if(wifi_state != WiFiStuff::kWiFiConnected && wifi_state != WiFiStuff::kWiFiFailedCredentials && wifi_state != WiFiStuff::kWiFiFailedNoAp) {
+        second_core_tasks.Defer(current_task);
+        waiting_for_wifi = true;
+        break;
+      }
+    }
+  #endif
+
     // Serial.print("CPU"); Serial.print(xPortGetCoreID()); Serial.print(" "); Serial.println(getCpuFrequencyMhz());
+    activity_trace.Event(ActivityTrace::kTraceTaskStart, current_task);
+    uint32_t task_start_us = micros();
 
     bool success = false;
 
-    if(current_task == kGetWeatherInfo && (!wifi_stuff->got_weather_info_ || wifi_stuff->last_fetch_weather_info_time_ms_ == 0 || millis() - wifi_stuff->last_fetch_weather_info_time_ms_ > wifi_stuff->kFetchWeatherInfoMinIntervalMs)) {
+    if(current_task == kGetWeatherInfo && wifi_stuff->WeatherCacheFresh()) {
+      // served from weather cache
+      success = true;
+    }
+    else if(current_task == kGetWeatherInfo) {
       // get today's weather info
       wifi_stuff->GetTodaysWeatherInfo();
       success = wifi_stuff->got_weather_info_;
@@ -588,8 +624,7 @@ void loop1() {
       success = true;
     }
     else if(current_task == kFirmwareVersionCheck) {
-      wifi_stuff->TurnWiFiOn();
-      ResetWatchdog();
+      // reuse connection of a network session
       if(!(wifi_stuff->wifi_connected_))
         wifi_stuff->TurnWiFiOn();
       ResetWatchdog();
@@ -599,12 +634,28 @@ void loop1() {
   #endif
 
     // done processing the task
-    // if(success) {
-      second_core_tasks_queue.pop();
-      delay(1);   // a delay to avoid race condition in dual core MCUs
-      second_core_task_added_flag_array[current_task] = false;
-    // }
+    activity_trace.AddBusyTime(ActivityTrace::kCore1, micros() - task_start_us);
+    activity_trace.Event(ActivityTrace::kTraceTaskDone, current_task * 10 + success);
+    second_core_tasks.Done(current_task, success);
   }
+
+  #if defined(WIFI_IS_USED)
+    if(waiting_for_wifi) {
+      // single core returns to UI loop, second core polls WiFi connect
+      #if !defined(ESP32_SINGLE_CORE)
+        delay(wifi_stuff->kWiFiConnectPollMs);
+      #endif
+      return;
+    }
+
+    // failed connect: tasks have failed, radio goes off and connect state machine resets
+    WiFiStuff::WiFiConnectState wifi_state = wifi_stuff->wifi_connect_state();
+    if(wifi_state == WiFiStuff::kWiFiFailedCredentials || wifi_state == WiFiStuff::kWiFiFailedNoAp)
+      wifi_stuff->TurnWiFiOff();
+
+    // power radio down once network session tasks are done
+    network_session.SecondCoreIdle();
+  #endif
   // RGB565 to RGB888
   // if(inactivity_millis - last_inactivity_millis > 50) {
   //   byte r = random(0, 255);
@@ -620,6 +671,220 @@ void loop1() {
   // }
 }
 
+// MINUTE SCHEDULER JOBS
+
+void SetupMinuteJobs(const RTC::TimeSnapshot &now) {
+  minute_scheduler.Setup(now.minute_of_week());
+
+  // every new hour, show main page if screensaver is On
+  minute_scheduler.AddPeriodicJob(ScreensaverHourlyJob, 60, 0);
+
+  // close hourly cpu busy accounting window
+  minute_scheduler.AddPeriodicJob(CpuBusyHourJob, 60, 0);
+
+  // rgb led strip autorun changes only at day, evening and night time
+  minute_scheduler.AddDailyJob(AutorunRgbLedStripJob, kDayTimeMinutes);
+  minute_scheduler.AddDailyJob(AutorunRgbLedStripJob, kEveningTimeMinutes);
+  night_time_rgb_led_strip_job = minute_scheduler.AddDailyJob(AutorunRgbLedStripJob, night_time_minutes);
+
+  #if defined(WIFI_IS_USED)
+    // background network jobs are batched into network sessions
+    network_session.Setup();
+
+    // get weather info before alarm time, in a network session starting 30 to 5 mins before alarm
+    alarm_clock->SetPreAlarmJob(minute_scheduler.AddJob(PreAlarmWeatherJob), 30);
+
+    // auto update time at 2:01 AM every morning
+    // (the 1 minute helps take into account daylight savings time that kicks in and ends at 2AM in March and November once every year. At exactly 2AM, server time might not have updated)
+    minute_scheduler.AddDailyJob(NtpTimeUpdateJob, 2 * 60 + 1);
+    ntp_time_update_retry_job = minute_scheduler.AddJob(NtpTimeUpdateRetryJob);
+
+    // check for firmware update everyday, in a network session between 10 AM and ota update time
+    minute_scheduler.AddDailyJob(FirmwareVersionCheckJob, kOtaUpdateWindowOpenMinutes);
+
+    // report radio on time of last day
+    minute_scheduler.AddDailyJob(RadioOnDailyReportJob, 0);
+
+    // auto disconnect wifi if connected and inactivity millis is over limit
+    minute_scheduler.AddPeriodicJob(WiFiAutoDisconnectJob, 1, 0);
+  #endif
+}
+
+void ScreensaverHourlyJob(const RTC::TimeSnapshot &now) {
+  if(current_page == kScreensaverPage) {
+    SetPage(kMainPage);
+    inactivity_millis = 0;
+    screensaver_hourly_wake_minute_of_week = now.minute_of_week();
+  }
+}
+
+void CpuBusyHourJob(const RTC::TimeSnapshot &now) {
+  activity_trace.CloseBusyHour();
+}
+
+void AutorunRgbLedStripJob(const RTC::TimeSnapshot &now) {
+  AutorunRgbLedStrip(now.todays_minutes);
+}
+
+#if defined(WIFI_IS_USED)
+void PreAlarmWeatherJob(const RTC::TimeSnapshot &now) {
+  // main page shown by screensaver for the new hour in this minute is no user activity
+  bool user_inactive = (inactivity_millis > kInactivityMillisLimit || screensaver_hourly_wake_minute_of_week == now.minute_of_week());
+  if(user_inactive && !(wifi_stuff->incorrect_zip_code)) {
+    // joins any network session of next 25 mins, latest 5 mins before alarm
+    network_session.Plan(kGetWeatherInfo, now.minute_of_week(), (now.minute_of_week() + 25) % kMinutesInWeek);
+    PrintLn("Get Weather Info!");
+  }
+}
+
+void NtpTimeUpdateJob(const RTC::TimeSnapshot &now) {
+  // reset time updated today to false every new day
+  wifi_stuff->auto_updated_time_today_ = false;
+  NtpTimeUpdateRetryJob(now);
+}
+
+// try for upto 59 times - once per min until successful time update
+void NtpTimeUpdateRetryJob(const RTC::TimeSnapshot &now) {
+  if(wifi_stuff->incorrect_zip_code || wifi_stuff->auto_updated_time_today_ || !(now.hour_mode_and_am_pm == 1 && now.hour == 2))
+    return;
+  // update time from NTP server, due now
+  network_session.Plan(kUpdateTimeFromNtpServer, now.minute_of_week(), now.minute_of_week());
+  PrintLn("Get Time Update from NTP Server");
+  minute_scheduler.ScheduleJobIn(ntp_time_update_retry_job, 1);
+}
+
+void FirmwareVersionCheckJob(const RTC::TimeSnapshot &now) {
+  PrintLn("**** Web OTA Firmware Update Check ****");
+  // joins any network session from now on, latest at ota update time
+  uint16_t start_of_day_minute_of_week = now.minute_of_week() - now.todays_minutes;
+  network_session.Plan(kFirmwareVersionCheck, now.minute_of_week(), start_of_day_minute_of_week + ota_update_days_minutes);
+}
+
+void RadioOnDailyReportJob(const RTC::TimeSnapshot &now) {
+  uint32_t radio_on_seconds = wifi_stuff->TakeRadioOnSeconds();
+  Serial.printf("Radio on seconds of last day: %u\n", radio_on_seconds);
+  activity_trace.Event(ActivityTrace::kTraceRadioOnDay, radio_on_seconds);
+}
+
+void WiFiAutoDisconnectJob(const RTC::TimeSnapshot &now) {
+  if(wifi_stuff->wifi_connected_ && (inactivity_millis > kInactivityMillisLimit)) {
+    PrintLn("**** Auto disconnect WiFi ****");
+    AddSecondCoreTaskIfNotThere(kDisconnectWiFi);
+  }
+}
+#endif
+
+#if defined(WIFI_IS_USED)
+// tasks that connect WiFi first
+bool TaskNeedsWiFi(SecondCoreTask task) {
+  if(task == kGetWeatherInfo)
+    return !(wifi_stuff->WeatherCacheFresh());
+  return (task == kUpdateTimeFromNtpServer || task == kConnectWiFi || task == kFirmwareVersionCheck || task == kStartLocationInputsLocalServer);
+}
+
+// WiFi connect progress, WiFi LED blinks with connect attempts
+void WiFiConnectProgress(WiFiStuff::WiFiConnectState state, uint8_t attempt) {
+  activity_trace.Event(ActivityTrace::kTraceWiFiConnect, state * 10 + attempt);
+  if(state == WiFiStuff::kWiFiFastConnecting || state == WiFiStuff::kWiFiConnecting)
+    digitalWrite(WIFI_LED, HIGH);
+  else if(state == WiFiStuff::kWiFiBackoff)
+    digitalWrite(WIFI_LED, LOW);
+  if(state >= WiFiStuff::kWiFiConnected && current_page == kWiFiSettingsPage)
+    display->redraw_display_ = true;
+}
+
+#if defined(MCU_IS_ESP32)
+// read-only status document served on /status of the web server, returns JSON length, 0 if buffer is too small
+size_t WriteStatusJson(char* buffer, size_t size) {
+  JsonWriter json(buffer, size);
+  json.BeginObject();
+  json.AddUInt("uptime_s", esp_timer_get_time() / 1000000);
+  json.AddString("firmware", kFirmwareVersion.c_str());
+  json.BeginObject("heap");
+  json.AddUInt("free", esp_get_free_heap_size());
+  json.AddUInt("min_free", esp_get_minimum_free_heap_size());
+  json.EndObject();
+  json.AddUInt("screensaver_fps", screensaver_fps);
+  json.AddUInt("task_queue_pending", second_core_tasks.PendingCount());
+  json.BeginObject("ntp");
+  if(wifi_stuff->ntp_offset_valid_) {
+    json.AddInt("last_offset_s", wifi_stuff->last_ntp_offset_sec_);
+    json.AddUInt("last_update_s_ago", (millis() - wifi_stuff->last_ntp_server_time_update_time_ms) / 1000);
+  }
+  json.AddFloat("rtc_drift_ppm", wifi_stuff->rtc_drift_ppm_, 1);
+  json.EndObject();
+  json.BeginObject("wifi");
+  json.AddBool("connected", wifi_stuff->wifi_connected_);
+  for (uint8_t fast_connect = 0; fast_connect < 2; fast_connect++) {
+    uint16_t connects, p50_ms, p90_ms, max_ms;
+    json.BeginObject(fast_connect ? "fast_connect" : "full_connect");
+    bool has_samples = wifi_stuff->WiFiConnectTimePercentiles(fast_connect, connects, p50_ms, p90_ms, max_ms);
+    json.AddUInt("connects", connects);
+    if(has_samples) {
+      json.AddUInt("p50_ms", p50_ms);
+      json.AddUInt("p90_ms", p90_ms);
+      json.AddUInt("max_ms", max_ms);
+    }
+    json.EndObject();
+  }
+  json.EndObject();
+  json.BeginObject("dns_cache");
+  json.AddUInt("hits", wifi_stuff->dns_cache_.hits_);
+  json.AddUInt("lookups", wifi_stuff->dns_cache_.lookups_);
+  json.AddUInt("saved_ms", wifi_stuff->dns_cache_.saved_ms_);
+  json.EndObject();
+  json.BeginObject("fb_mirror");
+  json.AddUInt("clients", framebuffer_mirror.Clients());
+  json.AddUInt("blits_sent", framebuffer_mirror.blits_sent_);
+  json.AddUInt("blits_skipped", framebuffer_mirror.blits_skipped_);
+  json.EndObject();
+  json.EndObject();
+  return (json.overflow() ? 0 : json.length());
+}
+
+// apply settings accepted by REST API, same effects as settings page buttons, one NVS commit
+void ApplySettingsBatch(SettingsBatch &batch) {
+  if(batch.fields & kSettingsAlarmSchedule) {
+    for (uint8_t slot = 0; slot < kAlarmSlotsMax; slot++)
+      if(batch.alarm_slots_mask & (1 << slot))
+        alarm_clock->SetAlarmSlot(slot, batch.alarm_schedule[slot].minute_of_day, batch.alarm_schedule[slot].on, batch.alarm_schedule[slot].weekday_mask, /* save = */ false);
+    // schedule blob is saved whole
+    memcpy(batch.alarm_schedule, alarm_clock->alarm_schedule_, sizeof(batch.alarm_schedule));
+    if(current_page == kMainPage)
+      display->redraw_display_ = true;
+  }
+  if(batch.fields & kSettingsLongPressSeconds) {
+    alarm_clock->alarm_long_press_seconds_ = batch.long_press_seconds;
+    display_pages_vec[kSettingsPage][DisplayPagesVecButtonIndex(kSettingsPage, kSettingsPageAlarmLongPressTime)]->btn_value = std::to_string(alarm_clock->alarm_long_press_seconds_) + "sec";
+  }
+  if(batch.fields & kSettingsScreensaverMotion) {
+    display->screensaver_bounce_not_fly_horizontally_ = batch.screensaver_bounce_not_fly_horizontally;
+    display_pages_vec[kScreensaverSettingsPage][DisplayPagesVecButtonIndex(kScreensaverSettingsPage, kScreensaverSettingsPageMotion)]->btn_value = (display->screensaver_bounce_not_fly_horizontally_ ? bounceScreensaverStr : flyOutScreensaverStr);
+  }
+  if(batch.fields & kSettingsNightTimeDimHour) {
+    night_time_minutes = batch.night_time_dim_hour * 60 + 720;
+    minute_scheduler.ScheduleJobAtMinuteOfDay(night_time_rgb_led_strip_job, night_time_minutes);
+    display_pages_vec[kScreensaverSettingsPage][DisplayPagesVecButtonIndex(kScreensaverSettingsPage, kScreensaverSettingsPageNightTmDimHr)]->btn_value = (std::to_string(batch.night_time_dim_hour) + "PM");
+  }
+  if(batch.fields & kSettingsAutorunRgbLedStripMode) {
+    autorun_rgb_led_strip_mode = batch.autorun_rgb_led_strip_mode;
+    display_pages_vec[kScreensaverSettingsPage][DisplayPagesVecButtonIndex(kScreensaverSettingsPage, kScreensaverSettingsPageRgbLedStripMode)]->btn_value = (autorun_rgb_led_strip_mode == 1 ? manualStr : (autorun_rgb_led_strip_mode == 2 ? eveningStr : sunDownStr));
+  }
+  if(batch.fields & (kSettingsNightTimeDimHour | kSettingsAutorunRgbLedStripMode))
+    AutorunRgbLedStrip(rtc->Now().todays_minutes);
+  if(current_page == kSettingsPage || current_page == kScreensaverSettingsPage)
+    display->redraw_display_ = true;
+  nvs_preferences->SaveSettingsBatch(batch);
+}
+#endif
+
+// resumable firmware download progress, called from UpdateFirmware() after every verified chunk
+void OtaProgress(uint32_t bytes_done, uint32_t bytes_total, uint32_t bytes_per_second) {
+  Serial.printf("OTA %u / %u bytes, %u B/s\n", bytes_done, bytes_total, bytes_per_second);
+  display->FirmwareUpdateProgress(bytes_done, bytes_total, bytes_per_second);
+}
+#endif
+
 #if defined(ESP32_DUAL_CORE)
 void Task1code( void * parameter) {
   for(;;) 
@@ -627,16 +892,31 @@ void Task1code( void * parameter) {
 }
 #endif
 
-void WaitForExecutionOfSecondCoreTask() {
-  #if defined(ESP32_SINGLE_CORE)
-    // ESP32_S2_MINI is single core MCU
-    loop1();
-  #elif defined(MCU_IS_RP2040) || defined(ESP32_DUAL_CORE)
-    unsigned long time_start = millis();
-    while (!second_core_tasks_queue.empty() && millis() - time_start <  kWatchdogTimeoutMs - 3000) {
-      delay(10);
-    }
-  #endif
+// wait for completion of a second core task, returns task's success
+// core 0 sleeps until second core is done with the task, not for the whole queue
+// WiFi connect with all its attempts and backoff takes longer than timeout_ms, so timeout starts
+// again for as long as WiFi connect is in progress
+bool WaitForExecutionOfSecondCoreTask(SecondCoreTaskHandle task_handle, unsigned long timeout_ms) {
+  while(true) {
+    #if defined(ESP32_SINGLE_CORE)
+      // ESP32_S2_MINI is single core MCU, run loop1() until task is done, it returns early while WiFi connects
+      unsigned long wait_start_ms = millis();
+      loop1();
+      while(!second_core_tasks.Completed(task_handle) && millis() - wait_start_ms < timeout_ms) {
+        delay(10);
+        loop1();
+      }
+    #elif defined(MCU_IS_RP2040) || defined(ESP32_DUAL_CORE)
+      second_core_tasks.Wait(task_handle, timeout_ms);
+    #endif
+    #if defined(WIFI_IS_USED)
+      if(!second_core_tasks.Completed(task_handle) && wifi_stuff->WiFiConnectInProgress()) {
+        ResetWatchdog();
+        continue;
+      }
+    #endif
+    return second_core_tasks.Succeeded(task_handle);
+  }
 }
 
 // GLOBAL VARIABLES AND FUNCTIONS
@@ -669,7 +949,7 @@ uint32_t cpu_speed_mhz = 80;
 elapsedMillis inactivity_millis = 0;
 
 // Display Visible Data Structure variables
-DisplayData new_display_data_ { "", "", "", "", true, false, true }, displayed_data_ { "", "", "", "", true, false, true };
+DisplayData new_display_data_ { "", "", "", "", true, false, true, 0 }, displayed_data_ { "", "", "", "", true, false, true, 0 };
 
 // current page on display
 ScreenPage current_page = kMainPage;
@@ -677,17 +957,30 @@ ScreenPage current_page = kMainPage;
 // current cursor highlight location on page
 Cursor current_cursor = kCursorNoSelection;
 
-// second core current task queue
-std::queue<SecondCoreTask> second_core_tasks_queue;
-// second core task added flag
-bool second_core_task_added_flag_array[kNoTask];
+// second core tasks queue
+SecondCoreTaskQueue second_core_tasks;
+
+// minute tick housekeeping jobs
+MinuteScheduler minute_scheduler;
+
+// activity timeline trace and cpu busy accounting
+ActivityTrace activity_trace;
+
+// batches background network jobs into one WiFi session
+NetworkSessionPlanner network_session;
+
+#if defined(MCU_IS_ESP32)
+  // REST API for alarms and settings, PUTs are applied by loop()
+  RestApi rest_api;
+
+  // live display mirror over WebSocket for remote support
+  FramebufferMirror framebuffer_mirror;
+#endif
 
 // function to safely add second core task if not already there
-void AddSecondCoreTaskIfNotThere(SecondCoreTask task) {
-  if(!second_core_task_added_flag_array[task]) {
-    second_core_tasks_queue.push(task);
-    second_core_task_added_flag_array[task] = true;
-  }
+// a task with a deadline is dropped if second core could not start it before deadline_ms
+SecondCoreTaskHandle AddSecondCoreTaskIfNotThere(SecondCoreTask task, unsigned long deadline_ms) {
+  return second_core_tasks.Push(task, deadline_ms);
 }
 
 int AvailableRam() {
@@ -721,17 +1014,18 @@ void SerialTimeStampPrefix() {
   Serial.print(kCharSpace);
   Serial.print('(');
   if(rtc != NULL) {
-    Serial.print(rtc->hour());
+    RTC::TimeSnapshot now = rtc->Now();
+    Serial.print(now.hour);
     Serial.print(kCharColon);
-    if(rtc->minute() < 10) Serial.print(kCharZero);
-    Serial.print(rtc->minute());
+    if(now.minute < 10) Serial.print(kCharZero);
+    Serial.print(now.minute);
     Serial.print(kCharColon);
-    if(rtc->second() < 10) Serial.print(kCharZero);
-    Serial.print(rtc->second());
+    if(now.second < 10) Serial.print(kCharZero);
+    Serial.print(now.second);
     Serial.print(kCharSpace);
-    if(rtc->hourModeAndAmPm() == 1)
+    if(now.hour_mode_and_am_pm == 1)
       Serial.print(kAmLabel);
-    else if(rtc->hourModeAndAmPm() == 2)
+    else if(now.hour_mode_and_am_pm == 2)
       Serial.print(kPmLabel);
   }
   Serial.print(" :i");
@@ -794,27 +1088,89 @@ void PrintLn() {
 }
 
 void PrepareTimeDayDateArrays() {
+  // strings are updated incrementally: seconds digits are incremented in place and HH:MM, date and
+  // alarm strings are only rebuilt when their inputs change. Changed fields are OR-ed into
+  // new_display_data_.changed_fields and cleared by the display once drawn.
+  static bool strings_valid = false;
+  static uint8_t last_second = 0, last_minute = 0, last_hour = 0, last_hour_mode_and_am_pm = 0;
+  static uint8_t last_day = 0, last_month = 0, last_day_of_week = 0;
+  static uint8_t last_alarm_hr = 0, last_alarm_min = 0;
+  static bool last_alarm_is_AM = false, last_alarm_ON = false;
+
+  RTC::TimeSnapshot now = rtc->RefreshedNow();
+  uint8_t changed = 0;
+
   // HH:MM
-  snprintf(new_display_data_.time_HHMM, kHHMM_ArraySize, "%d:%02d", rtc->hour(), rtc->minute());
-  // :SS
-  snprintf(new_display_data_.time_SS, kSS_ArraySize, ":%02d", rtc->second());
-  if(rtc->hourModeAndAmPm() == 0)
-    new_display_data_._12_hour_mode = false;
-  else if(rtc->hourModeAndAmPm() == 1) {
-    new_display_data_._12_hour_mode = true;
-    new_display_data_.pm_not_am = false;
+  if(!strings_valid || now.minute != last_minute || now.hour != last_hour || now.hour_mode_and_am_pm != last_hour_mode_and_am_pm) {
+    char* c = new_display_data_.time_HHMM;
+    if(now.hour >= 10)
+      *c++ = '0' + now.hour / 10;
+    *c++ = '0' + now.hour % 10;
+    *c++ = ':';
+    *c++ = '0' + now.minute / 10;
+    *c++ = '0' + now.minute % 10;
+    *c = '\0';
+    if(now.hour_mode_and_am_pm == 0)
+      new_display_data_._12_hour_mode = false;
+    else if(now.hour_mode_and_am_pm == 1) {
+      new_display_data_._12_hour_mode = true;
+      new_display_data_.pm_not_am = false;
+    }
+    else {
+      new_display_data_._12_hour_mode = true;
+      new_display_data_.pm_not_am = true;
+    }
+    last_minute = now.minute;
+    last_hour = now.hour;
+    last_hour_mode_and_am_pm = now.hour_mode_and_am_pm;
+    changed |= kTimeHHMMChanged;
   }
-  else {
-    new_display_data_._12_hour_mode = true;
-    new_display_data_.pm_not_am = true;
+
+  // :SS
+  if(!strings_valid || now.second != last_second) {
+    char* ss = new_display_data_.time_SS;
+    if(strings_valid && now.second == last_second + 1) {
+      // common case, just increment the ascii digits
+      if(++ss[2] > '9') {
+        ss[2] = '0';
+        ss[1]++;
+      }
+    }
+    else {
+      ss[0] = ':';
+      ss[1] = '0' + now.second / 10;
+      ss[2] = '0' + now.second % 10;
+      ss[3] = '\0';
+    }
+    last_second = now.second;
+    changed |= kTimeSSChanged;
   }
+
   // Mon dd Day
-  snprintf(new_display_data_.date_str, kDateArraySize, "%s  %d  %s", kDaysTable_[rtc->dayOfWeek() - 1], rtc->day(), kMonthsTable[rtc->month() - 1]);
-  if(alarm_clock->alarm_ON_)
-    snprintf(new_display_data_.alarm_str, kAlarmArraySize, "%d:%02d %s", alarm_clock->alarm_hr_, alarm_clock->alarm_min_, (alarm_clock->alarm_is_AM_ ? kAmLabel : kPmLabel));
-  else
-    snprintf(new_display_data_.alarm_str, kAlarmArraySize, "%s %s", kAlarmLabel, kOffLabel);
-  new_display_data_.alarm_ON = alarm_clock->alarm_ON_;
+  if(!strings_valid || now.day != last_day || now.month != last_month || now.day_of_week != last_day_of_week) {
+    snprintf(new_display_data_.date_str, kDateArraySize, "%s  %d  %s", kDaysTable_[now.day_of_week - 1], now.day, kMonthsTable[now.month - 1]);
+    last_day = now.day;
+    last_month = now.month;
+    last_day_of_week = now.day_of_week;
+    changed |= kDateChanged;
+  }
+
+  // alarm
+  if(!strings_valid || alarm_clock->alarm_ON_ != last_alarm_ON || alarm_clock->alarm_hr_ != last_alarm_hr || alarm_clock->alarm_min_ != last_alarm_min || alarm_clock->alarm_is_AM_ != last_alarm_is_AM) {
+    if(alarm_clock->alarm_ON_)
+      snprintf(new_display_data_.alarm_str, kAlarmArraySize, "%d:%02d %s", alarm_clock->alarm_hr_, alarm_clock->alarm_min_, (alarm_clock->alarm_is_AM_ ? kAmLabel : kPmLabel));
+    else
+      snprintf(new_display_data_.alarm_str, kAlarmArraySize, "%s %s", kAlarmLabel, kOffLabel);
+    new_display_data_.alarm_ON = alarm_clock->alarm_ON_;
+    last_alarm_ON = alarm_clock->alarm_ON_;
+    last_alarm_hr = alarm_clock->alarm_hr_;
+    last_alarm_min = alarm_clock->alarm_min_;
+    last_alarm_is_AM = alarm_clock->alarm_is_AM_;
+    changed |= kAlarmChanged;
+  }
+
+  strings_valid = true;
+  new_display_data_.changed_fields |= changed;
 }
 
 void SerialPrintRtcDateTime() {
@@ -894,7 +1250,7 @@ void ProcessSerialInput() {
   switch (input) {
     case 'a':   // toggle alarm On Off
       Serial.println(F("**** Toggle Alarm ****"));
-      alarm_clock->alarm_ON_ = !alarm_clock->alarm_ON_;
+      alarm_clock->ToggleAlarms();
       Serial.print(F("alarmOn = ")); Serial.println(alarm_clock->alarm_ON_);
       break;
     case 'b':   // brightness
@@ -928,7 +1284,7 @@ void ProcessSerialInput() {
       Serial.print(F("RTC hourModeAndAmPm() = ")); Serial.println(rtc->hourModeAndAmPm());
       break;
     case 'g':   // good morning
-      display->GoodMorningScreen();
+      alarm_clock->GoodMorning(millis());
       break;
     case 'h':   // enable / disable TOUCHSCREEN
       if(ts != NULL) {
@@ -1015,13 +1371,10 @@ void ProcessSerialInput() {
       else
         SetPage(kMainPage);
       break;
-    case 't':   // go to buzzAlarm Function
-      Serial.println(F("**** buzzAlarm Function ****"));
-      // go to buzz alarm function
-      alarm_clock->BuzzAlarmFn();
-      // set main page back
-      SetPage(kMainPage);
-      inactivity_millis = 0;
+    case 't':   // start alarm
+      Serial.println(F("**** Start Alarm ****"));
+      // start alarm, loop() runs the alarm state machine
+      alarm_clock->StartAlarm(millis());
       break;
     case 'u':   // Web OTA Update Available Check
       Serial.println(F("**** Web OTA Update Available Check ****"));
@@ -1056,6 +1409,7 @@ void ProcessSerialInput() {
       else
         autorun_rgb_led_strip_mode = 1;
       nvs_preferences->SaveAutorunRgbLedStripMode(autorun_rgb_led_strip_mode);
+      AutorunRgbLedStrip(rtc->Now().todays_minutes);
       PrintLn("RGB LED Strip Mode = ", (autorun_rgb_led_strip_mode == 1 ? manualStr : (autorun_rgb_led_strip_mode == 2 ? eveningStr : sunDownStr)));
       break;
     case 'y':   // show alarm triggered screen
@@ -1091,6 +1445,20 @@ void ProcessSerialInput() {
         display->refresh_screensaver_canvas_ = true;
       }
       break;
+    case 'B':   // button press to reaction latency
+      Serial.println(F("**** Button Press To Reaction Latency ****"));
+      button_events->PrintLatencyStats();
+      break;
+    case 'T':   // activity timeline trace
+      Serial.println(F("**** Activity Trace ****"));
+      activity_trace.PrintTrace();
+      break;
+  #if defined(WIFI_IS_USED)
+    case 'W':   // WiFi connect time percentiles
+      Serial.println(F("**** WiFi Connect Times ****"));
+      wifi_stuff->PrintWiFiConnectTimes();
+      break;
+  #endif
     default:
       Serial.println(F("Unrecognized user input"));
   }
@@ -1132,6 +1500,22 @@ void SetRgbStripColor(uint16_t rgb565_color, bool set_color_sequentially) {
   rgb_led_strip->show();
 }
 
+// run rgb led strip as per autorun mode, called at day, evening and night time
+void AutorunRgbLedStrip(uint16_t todays_minutes) {
+  if(autorun_rgb_led_strip_mode == 3) { // run rgb led strip all evening + night
+    if(todays_minutes >= kEveningTimeMinutes || todays_minutes < kDayTimeMinutes)
+      TurnOnRgbStrip();
+    else
+      TurnOffRgbStrip();
+  }
+  else if(autorun_rgb_led_strip_mode == 2) {  // // run rgb led strip all evening only
+    if(todays_minutes >= kEveningTimeMinutes && todays_minutes < night_time_minutes)
+      TurnOnRgbStrip();
+    else
+      TurnOffRgbStrip();
+  }
+}
+
 void TurnOnRgbStrip() {
   rgb_led_strip->setBrightness(255);
   rgb_led_strip->fill(0xFFFFFF, 0, 0);
@@ -1149,13 +1533,11 @@ void TurnOffRgbStrip() {
 }
 
 bool AnyButtonPressed() {
-  if(push_button->buttonActiveDebounced() || inc_button->buttonActiveDebounced() || dec_button->buttonActiveDebounced())
-    return true;
-  else
-    return false;
+  return button_events->AnyPressed();
 }
 
 void SetPage(ScreenPage set_this_page) {
+  activity_trace.Event(ActivityTrace::kTracePage, set_this_page);
   switch(set_this_page) {
     case kMainPage:
       // if screensaver is active then clear screensaver canvas to free memory
@@ -1184,11 +1566,8 @@ void SetPage(ScreenPage set_this_page) {
     case kAlarmSetPage:
       current_page = set_this_page;     // new page needs to be set before any action
       current_cursor = kAlarmSetPageHour;
-      // set variables for alarm set screen
-      alarm_clock->var_1_ = alarm_clock->alarm_hr_;
-      alarm_clock->var_2_ = alarm_clock->alarm_min_;
-      alarm_clock->var_3_is_AM_ = alarm_clock->alarm_is_AM_;
-      alarm_clock->var_4_ON_ = alarm_clock->alarm_ON_;
+      // set variables for alarm set screen, starting with first alarm slot
+      alarm_clock->LoadSetScreenVariables(0);
       display->SetAlarmScreen(/* process_user_input */ false, /* inc_button_pressed */ false, /* dec_button_pressed */ false, /* push_button_pressed */ false);
       break;
     case kAlarmTriggeredPage:
@@ -1339,7 +1718,7 @@ void MoveCursor(bool increment) {
   else if(current_page == kAlarmSetPage) {
     if(increment) {
       if(current_cursor == kCursorNoSelection)
-        current_cursor = kAlarmSetPageHour;
+        current_cursor = kAlarmSetPageSlot;
       else if(current_cursor == kAlarmSetPageCancel)
         current_cursor = kCursorNoSelection;
       else
@@ -1348,7 +1727,7 @@ void MoveCursor(bool increment) {
     else {
       if(current_cursor == kCursorNoSelection)
         current_cursor = kAlarmSetPageCancel;
-      else if(current_cursor == kAlarmSetPageHour)
+      else if(current_cursor == kAlarmSetPageSlot)
         current_cursor = kCursorNoSelection;
       else
         current_cursor--;
@@ -1473,8 +1852,7 @@ void LedButtonClickAction() {
       }
       else if(current_cursor == kSettingsPageLocationAndWeather) {
         LedButtonClickUiResponse(2);
-        AddSecondCoreTaskIfNotThere(kGetWeatherInfo);
-        WaitForExecutionOfSecondCoreTask();
+        WaitForExecutionOfSecondCoreTask(AddSecondCoreTaskIfNotThere(kGetWeatherInfo));
         SetPage(kLocationAndWeatherSettingsPage);
       }
       else if(current_cursor == kSettingsPageAlarmLongPressTime) {
@@ -1500,8 +1878,7 @@ void LedButtonClickAction() {
       }
       else if(current_cursor == kSettingsPageUpdate) {
         LedButtonClickUiResponse(2);
-        AddSecondCoreTaskIfNotThere(kFirmwareVersionCheck);
-        WaitForExecutionOfSecondCoreTask();
+        WaitForExecutionOfSecondCoreTask(AddSecondCoreTaskIfNotThere(kFirmwareVersionCheck));
         if(wifi_stuff->firmware_update_available_str_.size() > 0)
           display->DisplayFirmwareVersionAndDate();
         LedButtonClickUiResponse(3);
@@ -1514,14 +1891,12 @@ void LedButtonClickAction() {
     else if(current_page == kWiFiSettingsPage) {          // WIFI SETTINGS PAGE
       if(current_cursor == kWiFiSettingsPageSetSsidPasswd) {
         LedButtonClickUiResponse(2);
-        AddSecondCoreTaskIfNotThere(kStartSetWiFiSoftAP);
-        WaitForExecutionOfSecondCoreTask();
+        WaitForExecutionOfSecondCoreTask(AddSecondCoreTaskIfNotThere(kStartSetWiFiSoftAP));
         SetPage(kSoftApInputsPage);
       }
       else if(current_cursor == kWiFiSettingsPageClearSsidAndPasswd) {
         LedButtonClickUiResponse(2);
-        AddSecondCoreTaskIfNotThere(kDisconnectWiFi);
-        WaitForExecutionOfSecondCoreTask();
+        WaitForExecutionOfSecondCoreTask(AddSecondCoreTaskIfNotThere(kDisconnectWiFi));
         wifi_stuff->wifi_ssid_ = "Enter SSID";
         wifi_stuff->wifi_password_ = "Enter Passwd";
         wifi_stuff->SaveWiFiDetails();
@@ -1531,15 +1906,13 @@ void LedButtonClickAction() {
       }
       else if(current_cursor == kWiFiSettingsPageConnect) {
         LedButtonClickUiResponse(2);
-        AddSecondCoreTaskIfNotThere(kConnectWiFi);
-        WaitForExecutionOfSecondCoreTask();
+        WaitForExecutionOfSecondCoreTask(AddSecondCoreTaskIfNotThere(kConnectWiFi));
         LedButtonClickUiResponse(3);
         display->DisplayWiFiConnectionStatus();
       }
       else if(current_cursor == kWiFiSettingsPageDisconnect) {
         LedButtonClickUiResponse(1);
-        AddSecondCoreTaskIfNotThere(kDisconnectWiFi);
-        WaitForExecutionOfSecondCoreTask();
+        WaitForExecutionOfSecondCoreTask(AddSecondCoreTaskIfNotThere(kDisconnectWiFi));
         LedButtonClickUiResponse(3);
         display->DisplayWiFiConnectionStatus();
       }
@@ -1551,8 +1924,7 @@ void LedButtonClickAction() {
     else if(current_page == kSoftApInputsPage) {          // SOFT AP SET WIFI SSID PASSWD PAGE
       if(current_cursor == kPageSaveButton) {
         LedButtonClickUiResponse(1);
-        AddSecondCoreTaskIfNotThere(kStopSetWiFiSoftAP);
-        WaitForExecutionOfSecondCoreTask();
+        WaitForExecutionOfSecondCoreTask(AddSecondCoreTaskIfNotThere(kStopSetWiFiSoftAP));
         wifi_stuff->SaveWiFiDetails();
         int display_pages_vec_wifi_ssid_passwd_button_index = DisplayPagesVecButtonIndex(kWiFiSettingsPage, kWiFiSettingsPageSetSsidPasswd);
         display_pages_vec[kWiFiSettingsPage][display_pages_vec_wifi_ssid_passwd_button_index]->btn_value = wifi_stuff->WiFiDetailsShortString();
@@ -1560,36 +1932,32 @@ void LedButtonClickAction() {
       }
       else if(current_cursor == kPageCancelButton) {
         LedButtonClickUiResponse(1);
-        AddSecondCoreTaskIfNotThere(kStopSetWiFiSoftAP);
-        WaitForExecutionOfSecondCoreTask();
+        WaitForExecutionOfSecondCoreTask(AddSecondCoreTaskIfNotThere(kStopSetWiFiSoftAP));
         SetPage(kWiFiSettingsPage);
       }
     }
     else if(current_page == kLocationAndWeatherSettingsPage) {       // LOCATION AND WEATHER SETTINGS PAGE
       if(current_cursor == kLocationAndWeatherSettingsPageSetLocation) {
         LedButtonClickUiResponse(2);
-        AddSecondCoreTaskIfNotThere(kStartLocationInputsLocalServer);
-        WaitForExecutionOfSecondCoreTask();
+        WaitForExecutionOfSecondCoreTask(AddSecondCoreTaskIfNotThere(kStartLocationInputsLocalServer));
         SetPage(kLocationInputsPage);
       }
       else if(current_cursor == kLocationAndWeatherSettingsPageUnits) {
         wifi_stuff->weather_units_metric_not_imperial_ = !wifi_stuff->weather_units_metric_not_imperial_;
         wifi_stuff->SaveWeatherUnits();
-        wifi_stuff->got_weather_info_ = false;
+        wifi_stuff->InvalidateWeatherCache();
         display_pages_vec[current_page][DisplayPagesVecCurrentButtonIndex()]->btn_value = (wifi_stuff->weather_units_metric_not_imperial_ ? metricUnitStr : imperialUnitStr);
         LedButtonClickUiResponse(1);
         SetPage(kLocationAndWeatherSettingsPage);
       }
       else if(current_cursor == kLocationAndWeatherSettingsPageFetch) {
         LedButtonClickUiResponse(1);
-        AddSecondCoreTaskIfNotThere(kGetWeatherInfo);
-        WaitForExecutionOfSecondCoreTask();
+        WaitForExecutionOfSecondCoreTask(AddSecondCoreTaskIfNotThere(kGetWeatherInfo));
         SetPage(kLocationAndWeatherSettingsPage);
       }
       else if(current_cursor == kLocationAndWeatherSettingsPageUpdateTime) {
         LedButtonClickUiResponse(1);
-        AddSecondCoreTaskIfNotThere(kUpdateTimeFromNtpServer);
-        WaitForExecutionOfSecondCoreTask();
+        WaitForExecutionOfSecondCoreTask(AddSecondCoreTaskIfNotThere(kUpdateTimeFromNtpServer));
         if(wifi_stuff->manual_time_update_successful_)
           SetPage(kMainPage);
         else
@@ -1603,10 +1971,9 @@ void LedButtonClickAction() {
     else if(current_page == kLocationInputsPage) {          // LOCATION INPUTS PAGE
       if(current_cursor == kPageSaveButton) {
         LedButtonClickUiResponse(1);
-        AddSecondCoreTaskIfNotThere(kStopLocationInputsLocalServer);
-        WaitForExecutionOfSecondCoreTask();
+        WaitForExecutionOfSecondCoreTask(AddSecondCoreTaskIfNotThere(kStopLocationInputsLocalServer));
         wifi_stuff->SaveWeatherLocationDetails();
-        wifi_stuff->got_weather_info_ = false;
+        wifi_stuff->InvalidateWeatherCache();
         int display_pages_vec_location_and_weather_button_index = DisplayPagesVecButtonIndex(kLocationAndWeatherSettingsPage, kLocationAndWeatherSettingsPageSetLocation);
         std::string location_str = (std::to_string(wifi_stuff->location_zip_code_) + " " + wifi_stuff->location_country_code_);
         display_pages_vec[kLocationAndWeatherSettingsPage][display_pages_vec_location_and_weather_button_index]->btn_value = location_str;
@@ -1614,8 +1981,7 @@ void LedButtonClickAction() {
       }
       else if(current_cursor == kPageCancelButton) {
         LedButtonClickUiResponse(1);
-        AddSecondCoreTaskIfNotThere(kStopLocationInputsLocalServer);
-        WaitForExecutionOfSecondCoreTask();
+        WaitForExecutionOfSecondCoreTask(AddSecondCoreTaskIfNotThere(kStopLocationInputsLocalServer));
         SetPage(kLocationAndWeatherSettingsPage);
       }
     }
@@ -1644,6 +2010,8 @@ void LedButtonClickAction() {
           night_time_dim_hour = 8;
         nvs_preferences->SaveNightTimeDimHour(night_time_dim_hour);
         night_time_minutes = night_time_dim_hour * 60 + 720;
+        minute_scheduler.ScheduleJobAtMinuteOfDay(night_time_rgb_led_strip_job, night_time_minutes);
+        AutorunRgbLedStrip(rtc->Now().todays_minutes);
         display_pages_vec[current_page][DisplayPagesVecCurrentButtonIndex()]->btn_value = (std::to_string(night_time_dim_hour) + "PM");
         LedButtonClickUiResponse();
       }
@@ -1653,6 +2021,7 @@ void LedButtonClickAction() {
         else
           autorun_rgb_led_strip_mode = 1;
         nvs_preferences->SaveAutorunRgbLedStripMode(autorun_rgb_led_strip_mode);
+        AutorunRgbLedStrip(rtc->Now().todays_minutes);
         display_pages_vec[current_page][DisplayPagesVecCurrentButtonIndex()]->btn_value = (autorun_rgb_led_strip_mode == 1 ? manualStr : (autorun_rgb_led_strip_mode == 2 ? eveningStr : sunDownStr));
         LedButtonClickUiResponse();
       }
@@ -0,0 +1,201 @@
+#include "melody.h"
+#include "alarm_clock.h"
+
+// note frequencies of octave 4, C4 to B4, in Hz
+static const uint16_t kOctave4FrequenciesHz[12] = { 262, 277, 294, 311, 330, 349, 370, 392, 415, 440, 466, 494 };
+
+// semitone index in an octave of notes a to g
+static const uint8_t kNoteSemitones[7] = { 9, 11, 0, 2, 4, 5, 7 };
+
+static uint16_t RtttlReadNumber(const char* rtttl, uint16_t &i) {
+  uint16_t num = 0;
+  char c = pgm_read_byte(rtttl + i);
+  while(c >= '0' && c <= '9') {
+    num = num * 10 + (c - '0');
+    c = pgm_read_byte(rtttl + (++i));
+  }
+  return num;
+}
+
+uint8_t Melody::ParseRtttl(const char* rtttl, Note* notes, uint8_t max_notes) {
+  uint16_t i = 0;
+  char c;
+
+  // skip song name
+  while((c = pgm_read_byte(rtttl + i)) != ':') {
+    if(c == '\0') return 0;
+    i++;
+  }
+  i++;
+
+  // defaults section "d=4,o=5,b=120"
+  uint16_t default_duration = 4, default_octave = 6, bpm = 63;
+  while((c = pgm_read_byte(rtttl + i)) != ':') {
+    if(c == '\0') return 0;
+    if((c == 'd' || c == 'o' || c == 'b') && pgm_read_byte(rtttl + i + 1) == '=') {
+      i += 2;
+      uint16_t value = RtttlReadNumber(rtttl, i);
+      if(c == 'd' && value > 0) default_duration = value;
+      else if(c == 'o' && value >= 3 && value <= 7) default_octave = value;
+      else if(c == 'b' && value > 0) bpm = value;
+    }
+    else
+      i++;
+  }
+  i++;
+
+  // length of a whole note, 4 beats
+  uint32_t whole_note_ms = 60000UL * 4 / bpm;
+
+  // notes
+  uint8_t note_count = 0;
+  while(note_count < max_notes) {
+    // skip separators
+    while((c = pgm_read_byte(rtttl + i)) == ',' || c == ' ')
+      i++;
+    if(c == '\0') break;
+
+    // duration
+    uint16_t duration = RtttlReadNumber(rtttl, i);
+    if(duration == 0) duration = default_duration;
+    uint32_t duration_ms = whole_note_ms / duration;
+
+    // note letter
+    c = pgm_read_byte(rtttl + i);
+    if(c >= 'A' && c <= 'Z') c += 'a' - 'A';
+    int8_t semitone = -1;   // rest
+    if(c >= 'a' && c <= 'g')
+      semitone = kNoteSemitones[c - 'a'];
+    else if(c != 'p')
+      return 0;   // malformed
+    i++;
+
+    // sharp
+    if(pgm_read_byte(rtttl + i) == '#') {
+      if(semitone >= 0) semitone++;
+      i++;
+    }
+
+    // dotted note, can come before or after octave
+    if(pgm_read_byte(rtttl + i) == '.') {
+      duration_ms += duration_ms / 2;
+      i++;
+    }
+
+    // octave
+    uint16_t octave = RtttlReadNumber(rtttl, i);
+    if(octave == 0) octave = default_octave;
+
+    if(pgm_read_byte(rtttl + i) == '.') {
+      duration_ms += duration_ms / 2;
+      i++;
+    }
+
+    // frequency
+    uint16_t frequency_hz = 0;
+    if(semitone >= 0) {
+      if(semitone == 12) {    // b#
+        semitone = 0;
+        octave++;
+      }
+      frequency_hz = kOctave4FrequenciesHz[semitone];
+      if(octave > 4)
+        frequency_hz <<= (octave - 4);
+      else
+        frequency_hz >>= (4 - octave);
+    }
+
+    notes[note_count].frequency_hz = frequency_hz;
+    notes[note_count].duration_ms = min(duration_ms, (uint32_t)UINT16_MAX);
+    note_count++;
+  }
+
+  return note_count;
+}
+
+bool Melody::Play(const char* rtttl) {
+  Stop();
+
+  note_count_ = ParseRtttl(rtttl, notes_, kMaxNotes);
+  if(note_count_ == 0) {
+    PrintLn("Melody::Play(): Song could not be parsed!");
+    return false;
+  }
+  note_index_ = 0;
+  playing_ = true;
+
+  #if defined(MCU_IS_ESP32)
+    if(note_timer_ == NULL) {
+      esp_timer_create_args_t note_timer_args = {};
+      note_timer_args.callback = &NextNoteCallback;
+      note_timer_args.arg = this;
+      note_timer_args.name = "melody";
+      esp_timer_create(&note_timer_args, &note_timer_);
+    }
+    next_note_time_us_ = esp_timer_get_time() + notes_[0].duration_ms * 1000LL;
+    StartNote(0);
+    // first note ends on the timeline too, also if starting its tone took a while
+    int64_t delay_us = next_note_time_us_ - esp_timer_get_time();
+    esp_timer_start_once(note_timer_, (delay_us > 0 ? delay_us : 1));
+  #elif defined(MCU_IS_RP2040)
+    absolute_time_t first_note_end = make_timeout_time_ms(notes_[0].duration_ms);
+    StartNote(0);
+    note_alarm_id_ = add_alarm_at(first_note_end, NextNoteCallback, this, true);
+  #endif
+
+  return true;
+}
+
+void Melody::Stop() {
+  #if defined(MCU_IS_ESP32)
+    if(note_timer_ != NULL)
+      esp_timer_stop(note_timer_);
+  #elif defined(MCU_IS_RP2040)
+    if(note_alarm_id_ > 0)
+      cancel_alarm(note_alarm_id_);
+    note_alarm_id_ = 0;
+  #endif
+  // also when melody has ended by itself, buzzer pin is left to alarm beeps
+  alarm_clock->BuzzerToneOff();
+  playing_ = false;
+}
+
+void Melody::StartNote(uint8_t note_index) {
+  if(notes_[note_index].frequency_hz > 0)
+    alarm_clock->BuzzerToneOn(notes_[note_index].frequency_hz);
+  else
+    alarm_clock->BuzzerToneOff();
+}
+
+#if defined(MCU_IS_ESP32)
+// esp_timer callback, runs in esp_timer task
+void Melody::NextNoteCallback(void* arg) {
+  Melody* melody = (Melody*)arg;
+  melody->note_index_++;
+  if(melody->note_index_ >= melody->note_count_) {
+    alarm_clock->BuzzerToneOff();
+    melody->playing_ = false;
+    return;
+  }
+  melody->StartNote(melody->note_index_);
+  // schedule next note at absolute time so that callback latency does not accumulate
+  melody->next_note_time_us_ += melody->notes_[melody->note_index_].duration_ms * 1000LL;
+  int64_t delay_us = melody->next_note_time_us_ - esp_timer_get_time();
+  esp_timer_start_once(melody->note_timer_, (delay_us > 0 ? delay_us : 1));
+}
+#elif defined(MCU_IS_RP2040)
+// hardware alarm callback, runs in timer IRQ
+int64_t Melody::NextNoteCallback(alarm_id_t id, void* arg) {
+  Melody* melody = (Melody*)arg;
+  melody->note_index_++;
+  if(melody->note_index_ >= melody->note_count_) {
+    alarm_clock->BuzzerToneOff();
+    melody->playing_ = false;
+    melody->note_alarm_id_ = 0;
+    return 0;
+  }
+  melody->StartNote(melody->note_index_);
+  // positive return value reschedules relative to when this alarm was due, so timing does not drift
+  return melody->notes_[melody->note_index_].duration_ms * 1000LL;
+}
+#endif
@@ -0,0 +1,60 @@
+#ifndef MELODY_H
+#define MELODY_H
+
+#include "common.h"
+#if defined(MCU_IS_ESP32)
+  #include "esp_timer.h"
+#elif defined(MCU_IS_RP2040)
+  #include "pico/stdlib.h"
+  #include "hardware/timer.h"
+#endif
+
+// Songs in RTTTL format "name:d=<default duration>,o=<default octave>,b=<beats per minute>:notes"
+// https://en.wikipedia.org/wiki/Ring_Tone_Text_Transfer_Language
+// note: [duration][a-g or p][#][.][octave][.] e.g. 8c#6, 2g., p
+// Charge fanfare https://en.wikipedia.org/wiki/Charge_(fanfare)
+const char kSongCharge[] PROGMEM = "charge:d=16,o=5,b=109:g4.,c.,e.,8g,e,2g";
+const char kSongEntertainer[] PROGMEM = "entertainer:d=4,o=5,b=140:8d,8d#,8e,c6,8e,c6,8e,2c.6,8c6,8d6,8d#6,8e6,8c6,8d6,e6,8b,d6,2c6";
+const char kSongMorning[] PROGMEM = "morning:d=8,o=6,b=100:g5,e5,d5,c5,d5,e5,g5,e5,d5,c5,d5,e.5,d5,e5,g5,e5,g5,a5,e5,a5,g5,e5,d5,2c5";
+
+// Melody sequencer. Parses an RTTTL song into a note table on Play() and
+// advances notes from a hardware timer callback, independent of the loop
+// and render timing. Notes are started at absolute times so they do not drift.
+class Melody {
+
+public:
+
+  struct Note {
+    uint16_t frequency_hz;    // 0 = rest
+    uint16_t duration_ms;
+  };
+
+  static const uint8_t kMaxNotes = 64;
+
+  // parse RTTTL song into notes[], returns number of notes (0 if song is malformed)
+  static uint8_t ParseRtttl(const char* rtttl, Note* notes, uint8_t max_notes);
+
+  bool Play(const char* rtttl);
+  void Stop();
+  bool IsPlaying() { return playing_; }
+
+private:
+
+  void StartNote(uint8_t note_index);
+  #if defined(MCU_IS_ESP32)
+    static void NextNoteCallback(void* arg);
+    esp_timer_handle_t note_timer_ = NULL;
+    int64_t next_note_time_us_ = 0;
+  #elif defined(MCU_IS_RP2040)
+    static int64_t NextNoteCallback(alarm_id_t id, void* arg);
+    alarm_id_t note_alarm_id_ = 0;
+  #endif
+
+  Note notes_[kMaxNotes];
+  uint8_t note_count_ = 0;
+  volatile uint8_t note_index_ = 0;
+  volatile bool playing_ = false;
+
+};
+
+#endif  // MELODY_H
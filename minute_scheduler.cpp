@@ -0,0 +1,163 @@
+#include "minute_scheduler.h"
+
+void MinuteScheduler::Setup(uint16_t minute_of_week) {
+  current_minute_of_week_ = minute_of_week % kMinutesInWeek;
+  memset(level0_, kNoJob, sizeof(level0_));
+  memset(level1_, kNoJob, sizeof(level1_));
+}
+
+uint8_t MinuteScheduler::AddJob(JobFunction function, uint16_t period_minutes) {
+  if(period_minutes >= kMinutesInWeek) return kNoJob;
+  for (uint8_t i = 0; i < kMaxJobs; i++) {
+    if(jobs_[i].in_use) continue;
+    jobs_[i] = { function, 0, period_minutes, kNoJob, 0, /*in_use = */ true, /*scheduled = */ false };
+    return i;
+  }
+  PrintLn("MinuteScheduler::AddJob(): no free job!");
+  return kNoJob;
+}
+
+uint8_t MinuteScheduler::AddDailyJob(JobFunction function, uint16_t minute_of_day) {
+  uint8_t job_id = AddJob(function, kMinutesInDay);
+  ScheduleJobAtMinuteOfDay(job_id, minute_of_day);
+  return job_id;
+}
+
+uint8_t MinuteScheduler::AddPeriodicJob(JobFunction function, uint16_t period_minutes, uint16_t first_minute_of_day) {
+  uint8_t job_id = AddJob(function, period_minutes);
+  if(job_id == kNoJob) return kNoJob;
+  // first run after current minute that is in phase with first_minute_of_day
+  uint16_t current_minute_of_day = current_minute_of_week_ % kMinutesInDay;
+  uint16_t delta = (first_minute_of_day + kMinutesInDay - current_minute_of_day) % kMinutesInDay;
+  delta %= period_minutes;
+  if(delta == 0) delta = period_minutes;
+  ScheduleJobIn(job_id, delta);
+  return job_id;
+}
+
+void MinuteScheduler::ScheduleJobAt(uint8_t job_id, uint16_t minute_of_week) {
+  if(job_id >= kMaxJobs || !jobs_[job_id].in_use) return;
+  Unlink(job_id);
+  jobs_[job_id].due_minute_of_week = minute_of_week % kMinutesInWeek;
+  Link(job_id, /*include_current_minute = */ false);
+}
+
+void MinuteScheduler::ScheduleJobAtMinuteOfDay(uint8_t job_id, uint16_t minute_of_day) {
+  uint16_t current_minute_of_day = current_minute_of_week_ % kMinutesInDay;
+  uint16_t delta = (minute_of_day + kMinutesInDay - current_minute_of_day) % kMinutesInDay;
+  if(delta == 0) delta = kMinutesInDay;
+  ScheduleJobIn(job_id, delta);
+}
+
+void MinuteScheduler::ScheduleJobIn(uint8_t job_id, uint16_t minutes) {
+  ScheduleJobAt(job_id, (current_minute_of_week_ + minutes) % kMinutesInWeek);
+}
+
+void MinuteScheduler::CancelJob(uint8_t job_id) {
+  if(job_id >= kMaxJobs) return;
+  Unlink(job_id);
+}
+
+bool MinuteScheduler::Tick(const RTC::TimeSnapshot &now) {
+  uint16_t minute_of_week = now.minute_of_week();
+  // same minute again, after time was set back by seconds over a minute change: its jobs already ran
+  if(minute_of_week == current_minute_of_week_)
+    return false;
+  bool time_jumped = (minute_of_week != (current_minute_of_week_ + 1) % kMinutesInWeek);
+  uint16_t previous_minute_of_week = current_minute_of_week_;
+  current_minute_of_week_ = minute_of_week;
+
+  if(time_jumped)
+    Rebuild(previous_minute_of_week);
+  else if((minute_of_week & (kLevel0Slots - 1)) == 0) {
+    // new block, cascade its jobs into level 0
+    uint8_t* level1_head = &level1_[minute_of_week >> kLevel0Bits];
+    while(*level1_head != kNoJob) {
+      uint8_t job_id = *level1_head;
+      *level1_head = jobs_[job_id].next;
+      jobs_[job_id].scheduled = false;
+      Link(job_id, /*include_current_minute = */ true);
+    }
+  }
+
+  // run due jobs
+  // job functions may schedule or cancel any job, so take one job at a time from slot head
+  uint8_t* level0_head = &level0_[minute_of_week & (kLevel0Slots - 1)];
+  while(*level0_head != kNoJob) {
+    uint8_t job_id = *level0_head;
+    Job &job = jobs_[job_id];
+    *level0_head = job.next;
+    job.scheduled = false;
+    if(job.due_minute_of_week != minute_of_week) {
+      Link(job_id, /*include_current_minute = */ false);
+      continue;
+    }
+    if(job.period_minutes > 0) {
+      job.due_minute_of_week = (minute_of_week + job.period_minutes) % kMinutesInWeek;
+      Link(job_id, /*include_current_minute = */ false);
+    }
+    job.function(now);
+  }
+
+  return time_jumped;
+}
+
+uint8_t* MinuteScheduler::SlotHead(uint8_t job_id) {
+  uint16_t due = jobs_[job_id].due_minute_of_week;
+  if(jobs_[job_id].level == 0)
+    return &level0_[due & (kLevel0Slots - 1)];
+  return &level1_[due >> kLevel0Bits];
+}
+
+// link job in level 0 if due in rest of current block, else in its block's level 1 slot
+// a job due earlier in current block (or now, if !include_current_minute) is due next week
+void MinuteScheduler::Link(uint8_t job_id, bool include_current_minute) {
+  Job &job = jobs_[job_id];
+  uint16_t due = job.due_minute_of_week;
+  bool in_current_block = ((due >> kLevel0Bits) == (current_minute_of_week_ >> kLevel0Bits));
+  bool later_this_block = (due > current_minute_of_week_ || (include_current_minute && due == current_minute_of_week_));
+  job.level = ((in_current_block && later_this_block) ? 0 : 1);
+  uint8_t* head = SlotHead(job_id);
+  job.next = *head;
+  *head = job_id;
+  job.scheduled = true;
+}
+
+void MinuteScheduler::Unlink(uint8_t job_id) {
+  if(!jobs_[job_id].scheduled) return;
+  uint8_t* link = SlotHead(job_id);
+  while(*link != kNoJob) {
+    if(*link == job_id) {
+      *link = jobs_[job_id].next;
+      break;
+    }
+    link = &jobs_[*link].next;
+  }
+  jobs_[job_id].scheduled = false;
+}
+
+void MinuteScheduler::Rebuild(uint16_t previous_minute_of_week) {
+  memset(level0_, kNoJob, sizeof(level0_));
+  memset(level1_, kNoJob, sizeof(level1_));
+  // a jump by more than half a week forward is taken as time set back
+  uint16_t jump_minutes = (current_minute_of_week_ + kMinutesInWeek - previous_minute_of_week) % kMinutesInWeek;
+  bool forward_jump = (jump_minutes < kMinutesInWeek / 2);
+  for (uint8_t i = 0; i < kMaxJobs; i++) {
+    Job &job = jobs_[i];
+    if(!job.in_use || !job.scheduled) continue;
+    job.scheduled = false;
+    // periodic jobs run at their first in phase minute from now on
+    if(job.period_minutes > 0) {
+      uint16_t delta = (job.due_minute_of_week + kMinutesInWeek - current_minute_of_week_) % kMinutesInWeek;
+      job.due_minute_of_week = (current_minute_of_week_ + delta % job.period_minutes) % kMinutesInWeek;
+    }
+    // one shot job whose minute was skipped runs now instead of a week later
+    else if(forward_jump) {
+      uint16_t minutes_to_due = (job.due_minute_of_week + kMinutesInWeek - previous_minute_of_week) % kMinutesInWeek;
+      if(minutes_to_due > 0 && minutes_to_due <= jump_minutes)
+        job.due_minute_of_week = current_minute_of_week_;
+    }
+    Link(i, /*include_current_minute = */ true);
+  }
+  PrintLn("MinuteScheduler: time jumped, schedule rebuilt");
+}
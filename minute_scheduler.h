@@ -0,0 +1,74 @@
+#ifndef MINUTE_SCHEDULER_H
+#define MINUTE_SCHEDULER_H
+
+#include "common.h"
+#include "rtc.h"
+
+// Hierarchical timer wheel of minute jobs, ticked once every new minute from loop().
+// Jobs are due at an absolute minute of week (Sunday 12:00 AM = 0) and are either
+// one shot or periodic. Level 0 has one slot per minute of the current 64 minute block,
+// level 1 has one slot per 64 minute block of the week. A block's jobs are cascaded into
+// level 0 when the block starts, so a tick only touches jobs that are due.
+// If time jumps (time set manually or by NTP) the wheel is rebuilt around the new time,
+// periodic jobs keep their phase and wait for their next occurrence. One shot jobs due in minutes
+// skipped by a forward jump of less than half a week run right away in the same tick.
+class MinuteScheduler {
+
+public:
+
+  typedef void (*JobFunction)(const RTC::TimeSnapshot &now);
+  static const uint8_t kNoJob = 0xFF;
+
+  // call before adding jobs with current minute of week
+  void Setup(uint16_t minute_of_week);
+
+  // returns job id, kNoJob if there is no free job
+  // period_minutes = 0 for one shot jobs, has to be less than a week
+  uint8_t AddJob(JobFunction function, uint16_t period_minutes = 0);
+  // periodic every day at minute_of_day
+  uint8_t AddDailyJob(JobFunction function, uint16_t minute_of_day);
+  // periodic every period_minutes, phase aligned to first_minute_of_day
+  uint8_t AddPeriodicJob(JobFunction function, uint16_t period_minutes, uint16_t first_minute_of_day);
+
+  // schedule job's next run, always after current minute
+  void ScheduleJobAt(uint8_t job_id, uint16_t minute_of_week);
+  void ScheduleJobAtMinuteOfDay(uint8_t job_id, uint16_t minute_of_day);
+  void ScheduleJobIn(uint8_t job_id, uint16_t minutes);
+  void CancelJob(uint8_t job_id);
+
+  // call once every new minute, runs due jobs, a minute ticked again runs nothing
+  // returns true if time jumped and schedule was rebuilt
+  bool Tick(const RTC::TimeSnapshot &now);
+
+private:
+
+  static const uint8_t kMaxJobs = 12;
+  static const uint8_t kLevel0Bits = 6;
+  static const uint8_t kLevel0Slots = (1 << kLevel0Bits);
+  static const uint8_t kLevel1Slots = (kMinutesInWeek + kLevel0Slots - 1) / kLevel0Slots;
+
+  struct Job {
+    JobFunction function;
+    uint16_t due_minute_of_week;
+    uint16_t period_minutes;    // 0 = one shot
+    uint8_t next;               // next job in same wheel slot
+    uint8_t level;              // wheel level job is linked in
+    bool in_use;
+    bool scheduled;
+  };
+  Job jobs_[kMaxJobs] = {};
+
+  // wheel slot list heads
+  uint8_t level0_[kLevel0Slots];
+  uint8_t level1_[kLevel1Slots];
+
+  uint16_t current_minute_of_week_ = 0;
+
+  uint8_t* SlotHead(uint8_t job_id);
+  void Link(uint8_t job_id, bool include_current_minute);
+  void Unlink(uint8_t job_id);
+  void Rebuild(uint16_t previous_minute_of_week);
+
+};
+
+#endif  // MINUTE_SCHEDULER_H
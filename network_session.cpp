@@ -0,0 +1,93 @@
+#include "network_session.h"
+#include "second_core_task_queue.h"
+#include "minute_scheduler.h"
+#include "activity_trace.h"
+#include "wifi_stuff.h"
+
+void NetworkSessionPlanner::Setup() {
+  session_job_id_ = minute_scheduler.AddJob(SessionJob);
+}
+
+void NetworkSessionPlanner::Plan(SecondCoreTask task, uint16_t window_open_minute_of_week, uint16_t deadline_minute_of_week) {
+  planned_tasks_[task] = { true, window_open_minute_of_week, deadline_minute_of_week };
+  if(debug_mode)
+    Serial.printf("NetworkSessionPlanner::Plan(): task %d window %u..%u\n", task, window_open_minute_of_week, deadline_minute_of_week);
+
+  uint16_t minute_of_week = rtc->Now().minute_of_week();
+  if(deadline_minute_of_week == minute_of_week)
+    StartSession(minute_of_week);
+  else
+    ScheduleSessionJob(minute_of_week);
+}
+
+void NetworkSessionPlanner::TimeJumped(uint16_t minute_of_week) {
+  for (uint8_t task = 0; task < kNoTask; task++) {
+    PlannedTask &planned_task = planned_tasks_[task];
+    if(planned_task.planned && MinutesSince(minute_of_week, planned_task.window_open_minute_of_week) > MinutesSince(planned_task.deadline_minute_of_week, planned_task.window_open_minute_of_week)) {
+      planned_task.planned = false;
+      PrintLn("NetworkSessionPlanner::TimeJumped(): dropped task ", task);
+    }
+  }
+  ScheduleSessionJob(minute_of_week);
+}
+
+// session job is due at earliest deadline of planned tasks
+void NetworkSessionPlanner::ScheduleSessionJob(uint16_t minute_of_week) {
+  uint16_t minutes_to_deadline = kMinutesInWeek;
+  for (uint8_t task = 0; task < kNoTask; task++)
+    if(planned_tasks_[task].planned)
+      minutes_to_deadline = min(minutes_to_deadline, MinutesSince(planned_tasks_[task].deadline_minute_of_week, minute_of_week));
+
+  if(minutes_to_deadline == kMinutesInWeek)
+    minute_scheduler.CancelJob(session_job_id_);
+  else
+    minute_scheduler.ScheduleJobIn(session_job_id_, max(minutes_to_deadline, (uint16_t)1));
+}
+
+void NetworkSessionPlanner::SessionJob(const RTC::TimeSnapshot &now) {
+  network_session.StartSession(now.minute_of_week());
+}
+
+// queue all tasks whose window is open, in one go so that they share one WiFi association
+void NetworkSessionPlanner::StartSession(uint16_t minute_of_week) {
+  if(SessionActive()) {
+    // previous session still running, try again next minute
+    minute_scheduler.ScheduleJobIn(session_job_id_, 1);
+    return;
+  }
+
+  session_tasks_count_ = 0;
+  session_wifi_was_connected_ = wifi_stuff->wifi_connected_;
+  session_start_ms_ = millis();
+
+  for (uint8_t task = 0; task < kNoTask; task++) {
+    PlannedTask &planned_task = planned_tasks_[task];
+    if(planned_task.planned && MinutesSince(minute_of_week, planned_task.window_open_minute_of_week) <= MinutesSince(planned_task.deadline_minute_of_week, planned_task.window_open_minute_of_week)) {
+      planned_task.planned = false;
+      session_handles_[session_tasks_count_++] = AddSecondCoreTaskIfNotThere((SecondCoreTask)task, session_start_ms_ + kSessionMaxMs);
+    }
+  }
+  // publish session after its handles, second core reads them only after seeing session_active_ set.
+  // Tasks that complete before this are found completed at the next SecondCoreIdle().
+  session_active_.store(true, std::memory_order_release);
+  PrintLn("NetworkSessionPlanner::StartSession(): tasks ", session_tasks_count_);
+  activity_trace.Event(ActivityTrace::kTraceNetworkSession, session_tasks_count_);
+
+  ScheduleSessionJob(minute_of_week);
+}
+
+// runs on second core
+void NetworkSessionPlanner::SecondCoreIdle() {
+  // acquire pairs with release in StartSession(), session_handles_ and session_tasks_count_ are complete after it
+  if(!session_active_.load(std::memory_order_acquire)) return;
+
+  for (uint8_t i = 0; i < session_tasks_count_; i++)
+    if(!second_core_tasks.Completed(session_handles_[i]) && (millis() - session_start_ms_ < kSessionMaxMs))
+      return;
+
+  // power radio down right away, unless WiFi was already on for the user or firmware update will need it
+  if(!session_wifi_was_connected_ && !(wifi_stuff->firmware_update_available_))
+    wifi_stuff->TurnWiFiOff();
+  PrintLn("NetworkSessionPlanner::SecondCoreIdle(): session ms ", millis() - session_start_ms_);
+  session_active_.store(false, std::memory_order_release);
+}
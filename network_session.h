@@ -0,0 +1,64 @@
+#ifndef NETWORK_SESSION_H
+#define NETWORK_SESSION_H
+
+#include "common.h"
+#include "rtc.h"
+#include <atomic>
+
+// Network session planner, batches background network jobs into one WiFi-on window.
+// Each planned network task has a window in minutes of week: it runs latest at its deadline
+// and joins any session that starts after its window opened. A session starts when the earliest
+// deadline arrives, all tasks with open windows are queued back to back on the second core under
+// one WiFi association, and the radio is powered down as soon as the last of them is done.
+// Radio on time itself is accounted in WiFiStuff and reported once a day.
+class NetworkSessionPlanner {
+
+public:
+
+  // call after minute_scheduler.Setup(), registers session start job
+  void Setup();
+
+  // plan a network task, a task already planned gets the new window
+  void Plan(SecondCoreTask task, uint16_t window_open_minute_of_week, uint16_t deadline_minute_of_week);
+
+  // drop planned tasks whose deadline was skipped by a time jump
+  void TimeJumped(uint16_t minute_of_week);
+
+  // called by loop1() when its task queue is drained, ends session once its tasks are done
+  void SecondCoreIdle();
+
+  bool SessionActive() { return session_active_.load(std::memory_order_acquire); }
+
+private:
+
+  void StartSession(uint16_t minute_of_week);
+  void ScheduleSessionJob(uint16_t minute_of_week);
+  static void SessionJob(const RTC::TimeSnapshot &now);
+
+  // minutes from window open, wraps around week
+  static uint16_t MinutesSince(uint16_t minute_of_week, uint16_t since_minute_of_week) {
+    return (minute_of_week + kMinutesInWeek - since_minute_of_week) % kMinutesInWeek;
+  }
+
+  struct PlannedTask {
+    bool planned;
+    uint16_t window_open_minute_of_week;
+    uint16_t deadline_minute_of_week;
+  };
+  PlannedTask planned_tasks_[kNoTask] = {};
+
+  uint8_t session_job_id_ = 0xFF;
+
+  // tasks not started by second core within this time are dropped, radio does not stay on
+  const unsigned long kSessionMaxMs = 3 * 60 * 1000UL;
+
+  // current session, written on core 0 while session_active_ is false, then published by its release store
+  SecondCoreTaskHandle session_handles_[kNoTask] = {};
+  uint8_t session_tasks_count_ = 0;
+  bool session_wifi_was_connected_ = false;
+  unsigned long session_start_ms_ = 0;
+  std::atomic<bool> session_active_ = {false};
+
+};
+
+#endif  // NETWORK_SESSION_H
@@ -1,4 +1,5 @@
 #include "nvs_preferences.h"
+#include <nvs.h>
 
 NvsPreferences::NvsPreferences() {
 
@@ -96,14 +97,34 @@ void NvsPreferences::RetrieveAlarmSettings(uint8_t &alarmHr, uint8_t &alarmMin,
   preferences.end();
 }
 
-void NvsPreferences::SaveAlarm(uint8_t alarmHr, uint8_t alarmMin, bool alarmIsAm, bool alarmOn) {
+void NvsPreferences::RetrieveAlarmSchedule(AlarmSlot* alarm_schedule) {
+  preferences.begin(kNvsDataKey, /*readOnly = */ true);
+  bool schedule_present = (preferences.getBytesLength(kAlarmScheduleKey) == kAlarmSlotsMax * sizeof(AlarmSlot));
+  if(schedule_present)
+    preferences.getBytes(kAlarmScheduleKey, alarm_schedule, kAlarmSlotsMax * sizeof(AlarmSlot));
+  preferences.end();
+  if(schedule_present)
+    return;
+
+  // migrate single alarm settings into slot 0 of a new schedule
+  uint8_t alarmHr, alarmMin;
+  bool alarmIsAm, alarmOn;
+  RetrieveAlarmSettings(alarmHr, alarmMin, alarmIsAm, alarmOn);
+  memset(alarm_schedule, 0, kAlarmSlotsMax * sizeof(AlarmSlot));
+  for (int i = 0; i < kAlarmSlotsMax; i++)
+    alarm_schedule[i].weekday_mask = kAlarmEveryDay;
+  alarm_schedule[0].minute_of_day = (alarmHr % 12) * 60 + alarmMin + (alarmIsAm ? 0 : 12 * 60);
+  alarm_schedule[0].on = alarmOn;
+  SaveAlarmSchedule(alarm_schedule);
+  PrintLn("NVS Memory alarm settings migrated to alarm schedule.");
+}
+
+void NvsPreferences::SaveAlarmSchedule(const AlarmSlot* alarm_schedule) {
   preferences.begin(kNvsDataKey, /*readOnly = */ false);
-  preferences.putUChar(kAlarmHrKey, alarmHr);
-  preferences.putUChar(kAlarmMinKey, alarmMin);
-  preferences.putBool(kAlarmIsAmKey, alarmIsAm);
-  preferences.putBool(kAlarmOnKey, alarmOn);
+  preferences.putBytes(kAlarmScheduleKey, alarm_schedule, kAlarmSlotsMax * sizeof(AlarmSlot));
   preferences.end();
-  Serial.printf("NVS Memory SaveAlarm %2d:%02d alarmIsAm=%d alarmOn=%d\n", alarmHr, alarmMin, alarmIsAm, alarmOn);
+  for (int i = 0; i < kAlarmSlotsMax; i++)
+    Serial.printf("NVS Memory SaveAlarmSchedule slot %d: %2d:%02d on=%d weekdays=0x%02X\n", i, alarm_schedule[i].minute_of_day / 60, alarm_schedule[i].minute_of_day % 60, alarm_schedule[i].on, alarm_schedule[i].weekday_mask);
 }
 
 void NvsPreferences::RetrieveWiFiDetails(std::string &wifi_ssid, std::string &wifi_password) {
@@ -186,6 +207,74 @@ void NvsPreferences::SaveWeatherUnits(bool weather_units_metric_not_imperial) {
   PrintLn("Weather Location details written to NVS Memory");
 }
 
+// returns false if no weather cache is saved
+bool NvsPreferences::RetrieveWeatherCache(WeatherCacheRecord* weather_cache) {
+  preferences.begin(kNvsDataKey, /*readOnly = */ true);
+  bool cache_present = (preferences.getBytesLength(kWeatherCacheKey) == sizeof(WeatherCacheRecord));
+  if(cache_present)
+    preferences.getBytes(kWeatherCacheKey, weather_cache, sizeof(WeatherCacheRecord));
+  preferences.end();
+  PrintLn("NVS Memory weather cache present: ", cache_present);
+  return cache_present;
+}
+
+void NvsPreferences::SaveWeatherCache(const WeatherCacheRecord* weather_cache) {
+  preferences.begin(kNvsDataKey, /*readOnly = */ false);
+  preferences.putBytes(kWeatherCacheKey, weather_cache, sizeof(WeatherCacheRecord));
+  preferences.end();
+  PrintLn("Weather cache written to NVS Memory");
+}
+
+bool NvsPreferences::RetrieveWiFiConnectCache(WiFiConnectCacheRecord* wifi_connect_cache) {
+  preferences.begin(kNvsDataKey, /*readOnly = */ true);
+  bool cache_present = (preferences.getBytesLength(kWiFiConnectCacheKey) == sizeof(WiFiConnectCacheRecord));
+  if(cache_present)
+    preferences.getBytes(kWiFiConnectCacheKey, wifi_connect_cache, sizeof(WiFiConnectCacheRecord));
+  preferences.end();
+  PrintLn("NVS Memory WiFi connect cache present: ", cache_present);
+  return cache_present;
+}
+
+void NvsPreferences::SaveWiFiConnectCache(const WiFiConnectCacheRecord* wifi_connect_cache) {
+  preferences.begin(kNvsDataKey, /*readOnly = */ false);
+  preferences.putBytes(kWiFiConnectCacheKey, wifi_connect_cache, sizeof(WiFiConnectCacheRecord));
+  preferences.end();
+  PrintLn("WiFi connect cache written to NVS Memory");
+}
+
+bool NvsPreferences::RetrieveOtaCheckpoint(OtaCheckpointRecord* ota_checkpoint) {
+  preferences.begin(kNvsDataKey, /*readOnly = */ true);
+  bool checkpoint_present = (preferences.getBytesLength(kOtaCheckpointKey) == sizeof(OtaCheckpointRecord));
+  if(checkpoint_present)
+    preferences.getBytes(kOtaCheckpointKey, ota_checkpoint, sizeof(OtaCheckpointRecord));
+  preferences.end();
+  PrintLn("NVS Memory OTA checkpoint present: ", checkpoint_present);
+  return checkpoint_present;
+}
+
+void NvsPreferences::SaveOtaCheckpoint(const OtaCheckpointRecord* ota_checkpoint) {
+  preferences.begin(kNvsDataKey, /*readOnly = */ false);
+  preferences.putBytes(kOtaCheckpointKey, ota_checkpoint, sizeof(OtaCheckpointRecord));
+  preferences.end();
+}
+
+bool NvsPreferences::RetrieveDnsCache(DnsCacheRecord* dns_cache, uint8_t entries) {
+  preferences.begin(kNvsDataKey, /*readOnly = */ true);
+  bool cache_present = (preferences.getBytesLength(kDnsCacheKey) == entries * sizeof(DnsCacheRecord));
+  if(cache_present)
+    preferences.getBytes(kDnsCacheKey, dns_cache, entries * sizeof(DnsCacheRecord));
+  preferences.end();
+  PrintLn("NVS Memory DNS cache present: ", cache_present);
+  return cache_present;
+}
+
+void NvsPreferences::SaveDnsCache(const DnsCacheRecord* dns_cache, uint8_t entries) {
+  preferences.begin(kNvsDataKey, /*readOnly = */ false);
+  preferences.putBytes(kDnsCacheKey, dns_cache, entries * sizeof(DnsCacheRecord));
+  preferences.end();
+  PrintLn("DNS cache written to NVS Memory");
+}
+
 uint32_t NvsPreferences::RetrieveSavedCpuSpeed() {
   preferences.begin(kNvsDataKey, /*readOnly = */ true);
   uint32_t saved_cpu_speed_mhz = preferences.getUInt(kCpuSpeedMhzKey);
@@ -298,3 +387,26 @@ void NvsPreferences::SaveIsTouchscreen(bool is_touchscreen) {
   Serial.printf("NVS Memory is_touchscreen: %d saved.\n", is_touchscreen);
 }
 
+// Preferences commits after every put, batch goes through NVS API directly so that
+// all its keys are committed together. Types match Preferences: putUChar / putBool are u8, putBytes is blob.
+bool NvsPreferences::SaveSettingsBatch(const SettingsBatch &batch) {
+  nvs_handle_t handle;
+  if(nvs_open(kNvsDataKey, NVS_READWRITE, &handle) != ESP_OK)
+    return false;
+  esp_err_t err = ESP_OK;
+  if(err == ESP_OK && (batch.fields & kSettingsAlarmSchedule))
+    err = nvs_set_blob(handle, kAlarmScheduleKey, batch.alarm_schedule, kAlarmSlotsMax * sizeof(AlarmSlot));
+  if(err == ESP_OK && (batch.fields & kSettingsLongPressSeconds))
+    err = nvs_set_u8(handle, kAlarmLongPressSecondsKey, batch.long_press_seconds);
+  if(err == ESP_OK && (batch.fields & kSettingsNightTimeDimHour))
+    err = nvs_set_u8(handle, kNightTimeDimHourKey, batch.night_time_dim_hour);
+  if(err == ESP_OK && (batch.fields & kSettingsAutorunRgbLedStripMode))
+    err = nvs_set_u8(handle, kAutorunRgbLedStripModeKey, batch.autorun_rgb_led_strip_mode);
+  if(err == ESP_OK && (batch.fields & kSettingsScreensaverMotion))
+    err = nvs_set_u8(handle, kScreensaverMotionTypeKey, batch.screensaver_bounce_not_fly_horizontally);
+  if(err == ESP_OK)
+    err = nvs_commit(handle);
+  nvs_close(handle);
+  Serial.printf("NVS Memory settings batch 0x%02X saved, err %d\n", batch.fields, err);
+  return err == ESP_OK;
+}
@@ -20,12 +20,21 @@ public:
   void RetrieveLongPressSeconds(uint8_t &long_press_seconds);
   void SaveLongPressSeconds(uint8_t long_press_seconds);
   void RetrieveAlarmSettings(uint8_t &alarmHr, uint8_t &alarmMin, bool &alarmIsAm, bool &alarmOn);
-  void SaveAlarm(uint8_t alarmHr, uint8_t alarmMin, bool alarmIsAm, bool alarmOn);
+  void RetrieveAlarmSchedule(AlarmSlot* alarm_schedule);
+  void SaveAlarmSchedule(const AlarmSlot* alarm_schedule);
   void RetrieveWiFiDetails(std::string &wifi_ssid, std::string &wifi_password);
   void SaveWiFiDetails(std::string wifi_ssid, std::string wifi_password);
   void RetrieveWeatherLocationDetails(uint32_t &location_zip_code, std::string &location_country_code, bool &weather_units_metric_not_imperial);
   void SaveWeatherLocationDetails(uint32_t location_zip_code, std::string location_country_code, bool weather_units_metric_not_imperial);
   void SaveWeatherUnits(bool weather_units_metric_not_imperial);
+  bool RetrieveWeatherCache(WeatherCacheRecord* weather_cache);
+  void SaveWeatherCache(const WeatherCacheRecord* weather_cache);
+  bool RetrieveWiFiConnectCache(WiFiConnectCacheRecord* wifi_connect_cache);
+  void SaveWiFiConnectCache(const WiFiConnectCacheRecord* wifi_connect_cache);
+  bool RetrieveOtaCheckpoint(OtaCheckpointRecord* ota_checkpoint);
+  void SaveOtaCheckpoint(const OtaCheckpointRecord* ota_checkpoint);
+  bool RetrieveDnsCache(DnsCacheRecord* dns_cache, uint8_t entries);
+  void SaveDnsCache(const DnsCacheRecord* dns_cache, uint8_t entries);
   void RetrieveSavedFirmwareVersion(std::string &savedFirmwareVersion);
   void SaveCurrentFirmwareVersion();
   void CopyFirmwareVersionFromEepromToNvs(std::string firmwareVersion);
@@ -47,6 +56,8 @@ public:
   void SaveTestVal(uint8_t test_val);
   bool RetrieveIsTouchscreen();
   void SaveIsTouchscreen(bool is_touchscreen);
+  // write fields of batch with one NVS commit, alarm_schedule is written whole
+  bool SaveSettingsBatch(const SettingsBatch &batch);
 
 private:
 
@@ -68,6 +79,8 @@ private:
   const char* kAlarmOnKey = "AlarmOn";
   const bool kAlarmOn = false;
 
+  const char* kAlarmScheduleKey = "AlarmSchedule";  // kAlarmSlotsMax * sizeof(AlarmSlot) bytes, replaces the 4 single alarm keys above
+
   const char* kWiFiSsidKey = "WiFiSsid";  // kWifiSsidPasswordLengthMax bytes
   #if defined(MY_WIFI_SSID)   // create a secrets.h file with #define for MY_WIFI_SSID and uncomment the include statement at top of this file
     std::string kWiFiSsid = MY_WIFI_SSID;
@@ -91,6 +104,14 @@ private:
   const char* kWeatherUnitsMetricNotImperialKey = "WeatherUnits";
   const bool kWeatherUnitsMetricNotImperial = false;
 
+  const char* kWeatherCacheKey = "WeatherCache";  // sizeof(WeatherCacheRecord) bytes
+
+  const char* kWiFiConnectCacheKey = "WiFiConnCache";  // sizeof(WiFiConnectCacheRecord) bytes
+
+  const char* kOtaCheckpointKey = "OtaCheckpoint";  // sizeof(OtaCheckpointRecord) bytes
+
+  const char* kDnsCacheKey = "DnsCache";  // DnsCache::kEntries * sizeof(DnsCacheRecord) bytes
+
   const char* kAlarmLongPressSecondsKey = "AlarmLongPrsSec";
   const uint8_t kAlarmLongPressSeconds = 15;
 
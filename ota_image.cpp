@@ -0,0 +1,307 @@
+#include "ota_image.h"
+
+static uint32_t ReadU32(const uint8_t* data) {
+  return data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+void OtaImageDecoder::Begin(WriteFunction write, BaseReadFunction base_read, void* context) {
+  write_ = write;
+  base_read_ = base_read;
+  context_ = context;
+  error_ = kOk;
+  header_length_ = 0;
+  hs_state_ = kTagBit;
+  hs_bits_needed_ = 1;
+  hs_bits_value_ = 0;
+  hs_window_position_ = 0;
+  delta_state_ = kCommand;
+  delta_arguments_length_ = 0;
+  output_buffer_length_ = 0;
+  output_size_ = 0;
+  mbedtls_sha256_init(&sha256_);
+  mbedtls_sha256_starts(&sha256_, /*is224 = */ 0);
+}
+
+bool OtaImageDecoder::Feed(const uint8_t* data, size_t length) {
+  for (size_t i = 0; i < length && error_ == kOk; i++) {
+    if(header_length_ < kHeaderSize) {
+      ((uint8_t*)&header_)[header_length_++] = data[i];
+      if(header_length_ == kHeaderSize && !ParseHeader())
+        return false;
+    }
+    else if(header_.flags & kFlagHeatshrink)
+      HeatshrinkFeed(data[i]);
+    else if(header_.flags & kFlagDelta)
+      DeltaFeed(data[i]);
+    else
+      Output(&data[i], 1);
+  }
+  return error_ == kOk;
+}
+
+bool OtaImageDecoder::Finish() {
+  if(error_ != kOk) return false;
+  if(!HeaderReady()) {
+    error_ = kBadHeader;
+    return false;
+  }
+  if(!FlushOutput()) return false;
+  if(output_size_ != header_.image_size || delta_state_ != kCommand) {
+    error_ = kSizeMismatch;
+    return false;
+  }
+  uint8_t sha256[32];
+  mbedtls_sha256_finish(&sha256_, sha256);
+  mbedtls_sha256_free(&sha256_);
+  if(memcmp(sha256, header_.image_sha256, sizeof(sha256)) != 0) {
+    error_ = kHashMismatch;
+    return false;
+  }
+  return true;
+}
+
+bool OtaImageDecoder::ParseHeader() {
+  if(memcmp(header_.magic, "LPOI", 4) != 0 || header_.format_version != 1 || header_.image_size == 0
+      || ((header_.flags & kFlagHeatshrink) && (header_.window_sz2 < 4 || header_.window_sz2 > kMaxWindowSz2 || header_.lookahead_sz2 < 3 || header_.lookahead_sz2 >= header_.window_sz2))) {
+    error_ = kBadHeader;
+    return false;
+  }
+  if((header_.flags & kFlagDelta) && !BaseMatches()) {
+    error_ = kBaseMismatch;
+    return false;
+  }
+  return true;
+}
+
+// delta is applied only on the firmware it was made against
+bool OtaImageDecoder::BaseMatches() {
+  if(base_read_ == NULL) return false;
+  mbedtls_sha256_context base_sha256;
+  mbedtls_sha256_init(&base_sha256);
+  mbedtls_sha256_starts(&base_sha256, /*is224 = */ 0);
+  bool read_ok = true;
+  for (uint32_t offset = 0; offset < header_.base_size && read_ok; offset += sizeof(output_buffer_)) {
+    size_t length = std::min((uint32_t)sizeof(output_buffer_), header_.base_size - offset);
+    read_ok = base_read_(offset, output_buffer_, length, context_);
+    mbedtls_sha256_update(&base_sha256, output_buffer_, length);
+  }
+  uint8_t sha256[32];
+  mbedtls_sha256_finish(&base_sha256, sha256);
+  mbedtls_sha256_free(&base_sha256);
+  return read_ok && memcmp(sha256, header_.base_sha256, sizeof(sha256)) == 0;
+}
+
+bool OtaImageDecoder::HeatshrinkFeed(uint8_t byte) {
+  for (int8_t bit = 7; bit >= 0 && error_ == kOk; bit--) {
+    hs_bits_value_ = (hs_bits_value_ << 1) | ((byte >> bit) & 1);
+    if(--hs_bits_needed_ > 0) continue;
+
+    uint16_t value = hs_bits_value_;
+    hs_bits_value_ = 0;
+    switch(hs_state_) {
+      case kTagBit:
+        hs_state_ = (value ? kLiteral : kBackrefIndex);
+        hs_bits_needed_ = (value ? 8 : header_.window_sz2);
+        break;
+      case kLiteral:
+        HeatshrinkEmit(value);
+        hs_state_ = kTagBit;
+        hs_bits_needed_ = 1;
+        break;
+      case kBackrefIndex:
+        hs_backref_index_ = value + 1;
+        hs_state_ = kBackrefCount;
+        hs_bits_needed_ = header_.lookahead_sz2;
+        break;
+      case kBackrefCount: {
+        uint16_t window_mask = (1 << header_.window_sz2) - 1;
+        for (uint16_t count = value + 1; count > 0 && error_ == kOk; count--)
+          HeatshrinkEmit(hs_window_[(hs_window_position_ - hs_backref_index_) & window_mask]);
+        hs_state_ = kTagBit;
+        hs_bits_needed_ = 1;
+        break;
+      }
+    }
+  }
+  return error_ == kOk;
+}
+
+bool OtaImageDecoder::HeatshrinkEmit(uint8_t byte) {
+  hs_window_[hs_window_position_ & ((1 << header_.window_sz2) - 1)] = byte;
+  hs_window_position_++;
+  if(header_.flags & kFlagDelta)
+    return DeltaFeed(byte);
+  return Output(&byte, 1);
+}
+
+bool OtaImageDecoder::DeltaFeed(uint8_t byte) {
+  switch(delta_state_) {
+    case kCommand:
+      if(byte != 0x01 && byte != 0x02) {
+        error_ = kBadPayload;
+        return false;
+      }
+      delta_command_ = byte;
+      delta_arguments_length_ = 0;
+      delta_state_ = kArguments;
+      return true;
+
+    case kArguments:
+      delta_arguments_[delta_arguments_length_++] = byte;
+      if(delta_command_ == 0x02 && delta_arguments_length_ == 4) {
+        delta_literal_remaining_ = ReadU32(delta_arguments_);
+        delta_state_ = (delta_literal_remaining_ > 0 ? kLiteralBytes : kCommand);
+      }
+      else if(delta_command_ == 0x01 && delta_arguments_length_ == 8) {
+        // copy from base firmware through output buffer
+        uint32_t offset = ReadU32(delta_arguments_), length = ReadU32(delta_arguments_ + 4);
+        if((uint64_t)offset + length > header_.base_size || (uint64_t)output_size_ + length > header_.image_size) {
+          error_ = kBadPayload;
+          return false;
+        }
+        while(length > 0) {
+          if(output_buffer_length_ == sizeof(output_buffer_) && !FlushOutput())
+            return false;
+          size_t chunk = std::min(length, (uint32_t)(sizeof(output_buffer_) - output_buffer_length_));
+          if(!base_read_(offset, output_buffer_ + output_buffer_length_, chunk, context_)) {
+            error_ = kBadPayload;
+            return false;
+          }
+          output_buffer_length_ += chunk;
+          output_size_ += chunk;
+          offset += chunk;
+          length -= chunk;
+        }
+        delta_state_ = kCommand;
+      }
+      return true;
+
+    case kLiteralBytes:
+      if(--delta_literal_remaining_ == 0)
+        delta_state_ = kCommand;
+      return Output(&byte, 1);
+  }
+  return true;
+}
+
+bool OtaImageDecoder::Output(const uint8_t* data, size_t length) {
+  if(output_size_ + length > header_.image_size) {
+    error_ = kSizeMismatch;
+    return false;
+  }
+  while(length > 0) {
+    if(output_buffer_length_ == sizeof(output_buffer_) && !FlushOutput())
+      return false;
+    size_t chunk = std::min(length, sizeof(output_buffer_) - output_buffer_length_);
+    memcpy(output_buffer_ + output_buffer_length_, data, chunk);
+    output_buffer_length_ += chunk;
+    output_size_ += chunk;
+    data += chunk;
+    length -= chunk;
+  }
+  return true;
+}
+
+bool OtaImageDecoder::FlushOutput() {
+  if(output_buffer_length_ == 0) return true;
+  mbedtls_sha256_update(&sha256_, output_buffer_, output_buffer_length_);
+  if(!write_(output_buffer_, output_buffer_length_, context_)) {
+    error_ = kWriteFailed;
+    return false;
+  }
+  output_buffer_length_ = 0;
+  return true;
+}
+
+bool OtaChunkedWriter::SetManifest(const uint8_t* manifest, size_t length, FlashWriteFunction write, FlashEraseFunction erase, FlashReadFunction read, void* context) {
+  write_ = write;
+  erase_ = erase;
+  read_ = read;
+  context_ = context;
+  bytes_done_ = 0;
+  chunk_offset_ = 0;
+  delete[] chunk_hashes_;
+  chunk_hashes_ = NULL;
+  chunks_count_ = 0;
+
+  if(length < sizeof(ManifestHeader)) return false;
+  memcpy(&manifest_, manifest, sizeof(ManifestHeader));
+  if(memcmp(manifest_.magic, "LPOM", 4) != 0 || manifest_.format_version != 1 || manifest_.chunk_sz2 < 12 || manifest_.chunk_sz2 > 20 || manifest_.image_size == 0)
+    return false;
+  uint32_t chunks_count = (manifest_.image_size + (1UL << manifest_.chunk_sz2) - 1) >> manifest_.chunk_sz2;
+  if(length != sizeof(ManifestHeader) + chunks_count * 32)
+    return false;
+  chunks_count_ = chunks_count;
+  chunk_hashes_ = new uint8_t[chunks_count_ * 32];
+  memcpy(chunk_hashes_, manifest + sizeof(ManifestHeader), chunks_count_ * 32);
+  return true;
+}
+
+uint32_t OtaChunkedWriter::ChunkSize(uint32_t chunk_index) {
+  uint32_t chunk_start = chunk_index << manifest_.chunk_sz2;
+  return std::min((uint32_t)(1UL << manifest_.chunk_sz2), manifest_.image_size - chunk_start);
+}
+
+// finishes sha256
+bool OtaChunkedWriter::ChunkHashMatches(uint32_t chunk_index, mbedtls_sha256_context* sha256) {
+  uint8_t chunk_sha256[32];
+  mbedtls_sha256_finish(sha256, chunk_sha256);
+  mbedtls_sha256_free(sha256);
+  return memcmp(chunk_sha256, chunk_hashes_ + chunk_index * 32, 32) == 0;
+}
+
+uint32_t OtaChunkedWriter::Resume(uint32_t bytes_done) {
+  bytes_done_ = 0;
+  chunk_offset_ = 0;
+  bytes_done = std::min(bytes_done, manifest_.image_size);
+  uint8_t buffer[256];
+  // flash may have been written since checkpoint, only chunks that still match count
+  for (uint32_t chunk_index = 0; chunk_index < chunks_count_ && (chunk_index << manifest_.chunk_sz2) + ChunkSize(chunk_index) <= bytes_done; chunk_index++) {
+    uint32_t chunk_start = chunk_index << manifest_.chunk_sz2, chunk_size = ChunkSize(chunk_index);
+    mbedtls_sha256_context sha256;
+    mbedtls_sha256_init(&sha256);
+    mbedtls_sha256_starts(&sha256, /*is224 = */ 0);
+    bool read_ok = true;
+    for (uint32_t offset = 0; offset < chunk_size && read_ok; offset += sizeof(buffer)) {
+      size_t length = std::min((uint32_t)sizeof(buffer), chunk_size - offset);
+      read_ok = read_(chunk_start + offset, buffer, length, context_);
+      mbedtls_sha256_update(&sha256, buffer, length);
+    }
+    if(!ChunkHashMatches(chunk_index, &sha256) || !read_ok)
+      break;
+    bytes_done_ = chunk_start + chunk_size;
+  }
+  return bytes_done_;
+}
+
+bool OtaChunkedWriter::Feed(const uint8_t* data, size_t length) {
+  while(length > 0 && !Complete()) {
+    uint32_t chunk_index = bytes_done_ >> manifest_.chunk_sz2;
+    uint32_t chunk_size = ChunkSize(chunk_index);
+    if(chunk_offset_ == 0) {
+      // chunk starts: erase its sectors, start its hash
+      uint32_t erase_size = (chunk_size + kFlashSectorSize - 1) / kFlashSectorSize * kFlashSectorSize;
+      if(!erase_(bytes_done_, erase_size, context_))
+        return false;
+      mbedtls_sha256_init(&chunk_sha256_);
+      mbedtls_sha256_starts(&chunk_sha256_, /*is224 = */ 0);
+    }
+    size_t write_length = std::min((uint32_t)length, chunk_size - chunk_offset_);
+    if(!write_(bytes_done_ + chunk_offset_, data, write_length, context_)) {
+      chunk_offset_ = 0;
+      return false;
+    }
+    mbedtls_sha256_update(&chunk_sha256_, data, write_length);
+    chunk_offset_ += write_length;
+    data += write_length;
+    length -= write_length;
+
+    if(chunk_offset_ == chunk_size) {
+      chunk_offset_ = 0;
+      if(!ChunkHashMatches(chunk_index, &chunk_sha256_))
+        return false;
+      bytes_done_ += chunk_size;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,183 @@
+#ifndef OTA_IMAGE_H
+#define OTA_IMAGE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <algorithm>
+#include "mbedtls/sha256.h"
+
+// Streaming decoder of OTA images made by tools/ota_image.py.
+// An image is a header followed by a payload that is the firmware binary, optionally
+// heatshrink (LZSS) compressed, and optionally a delta against the running firmware:
+// a list of copy-from-base and literal commands. Bytes are fed as they are downloaded,
+// decompressed and patched in fixed buffers and written out through a write function
+// (Update partition writer on ESP32) with a running SHA-256 of the output.
+// Base firmware is read back through a read function (running partition on ESP32).
+// The decoder does not use any Arduino API, so that it can be run on a PC against real images.
+class OtaImageDecoder {
+
+public:
+
+  typedef bool (*WriteFunction)(const uint8_t* data, size_t length, void* context);
+  typedef bool (*BaseReadFunction)(uint32_t offset, uint8_t* data, size_t length, void* context);
+
+  enum Flags : uint8_t {
+    kFlagHeatshrink = 0x01,
+    kFlagDelta = 0x02,
+  };
+
+  enum Error : uint8_t {
+    kOk = 0,
+    kBadHeader,
+    kBaseMismatch,      // delta is not against running firmware
+    kBadPayload,
+    kWriteFailed,
+    kSizeMismatch,
+    kHashMismatch,
+  };
+
+  // little endian on the wire
+  struct __attribute__((packed)) Header {
+    char magic[4];                // "LPOI"
+    uint8_t format_version;       // 1
+    uint8_t flags;                // Flags
+    uint8_t window_sz2;           // heatshrink window size, log2
+    uint8_t lookahead_sz2;        // heatshrink lookahead size, log2
+    uint32_t image_size;          // firmware binary size
+    uint32_t base_size;           // delta base size
+    uint8_t image_sha256[32];     // of firmware binary
+    uint8_t base_sha256[32];      // of first base_size bytes of base firmware
+  };
+  static const size_t kHeaderSize = sizeof(Header);
+  static const uint8_t kMaxWindowSz2 = 11;
+
+  void Begin(WriteFunction write, BaseReadFunction base_read, void* context);
+  // feed image bytes, returns false on error
+  bool Feed(const uint8_t* data, size_t length);
+  // call after last byte, returns true if whole firmware was written and its hash matches
+  bool Finish();
+
+  bool HeaderReady() { return header_length_ == kHeaderSize && error_ == kOk; }
+  const Header& header() { return header_; }
+  Error error() { return error_; }
+  uint32_t output_size() { return output_size_; }
+
+private:
+
+  bool ParseHeader();
+  bool BaseMatches();
+
+  // heatshrink stage
+  bool HeatshrinkFeed(uint8_t byte);
+  bool HeatshrinkEmit(uint8_t byte);
+
+  // delta stage
+  bool DeltaFeed(uint8_t byte);
+
+  // output stage
+  bool Output(const uint8_t* data, size_t length);
+  bool FlushOutput();
+
+  WriteFunction write_ = NULL;
+  BaseReadFunction base_read_ = NULL;
+  void* context_ = NULL;
+  Error error_ = kOk;
+
+  Header header_;
+  size_t header_length_ = 0;
+
+  // heatshrink LZSS: tag bit 1 = 8 bit literal, 0 = backref of window_sz2 bit index and lookahead_sz2 bit count, MSB first
+  enum HeatshrinkState : uint8_t {
+    kTagBit = 0,
+    kLiteral,
+    kBackrefIndex,
+    kBackrefCount,
+  };
+  HeatshrinkState hs_state_ = kTagBit;
+  uint8_t hs_bits_needed_ = 1;
+  uint16_t hs_bits_value_ = 0;
+  uint16_t hs_backref_index_ = 0;
+  uint8_t hs_window_[1 << kMaxWindowSz2];
+  uint16_t hs_window_position_ = 0;
+
+  // delta commands: 0x01 copy <u32 base offset> <u32 length>, 0x02 literal <u32 length> <bytes>
+  enum DeltaState : uint8_t {
+    kCommand = 0,
+    kArguments,
+    kLiteralBytes,
+  };
+  DeltaState delta_state_ = kCommand;
+  uint8_t delta_command_ = 0;
+  uint8_t delta_arguments_[8];
+  uint8_t delta_arguments_length_ = 0;
+  uint32_t delta_literal_remaining_ = 0;
+
+  // output buffer, also used to read base firmware for copies
+  uint8_t output_buffer_[256];
+  size_t output_buffer_length_ = 0;
+  uint32_t output_size_ = 0;
+  mbedtls_sha256_context sha256_;
+
+};
+
+// Resumable chunked writer of a raw firmware binary into an OTA partition.
+// A manifest made by tools/ota_image.py holds SHA-256 of every chunk. Downloaded bytes are
+// written to flash as they arrive and a chunk counts as done only once its hash matches, so
+// a download can stop at any byte and resume at the last done chunk, also after a reboot.
+// Flash is accessed through functions (OTA partition on ESP32), so it can be run on a PC.
+class OtaChunkedWriter {
+
+public:
+
+  typedef bool (*FlashWriteFunction)(uint32_t offset, const uint8_t* data, size_t length, void* context);
+  typedef bool (*FlashEraseFunction)(uint32_t offset, size_t length, void* context);
+  typedef bool (*FlashReadFunction)(uint32_t offset, uint8_t* data, size_t length, void* context);
+
+  // little endian on the wire, followed by SHA-256 of every chunk
+  struct __attribute__((packed)) ManifestHeader {
+    char magic[4];                // "LPOM"
+    uint8_t format_version;       // 1
+    uint8_t chunk_sz2;            // chunk size, log2, at least flash erase sector size
+    uint16_t reserved;
+    uint32_t image_size;
+    uint8_t image_sha256[32];
+  };
+  static const uint32_t kFlashSectorSize = 4096;
+
+  ~OtaChunkedWriter() { delete[] chunk_hashes_; }
+
+  // returns false if manifest is invalid
+  bool SetManifest(const uint8_t* manifest, size_t length, FlashWriteFunction write, FlashEraseFunction erase, FlashReadFunction read, void* context);
+  // verify chunks of a previous download by reading them back, returns offset to download from
+  uint32_t Resume(uint32_t bytes_done);
+  // feed downloaded bytes from offset bytes_done() + partial chunk, returns false on flash error or chunk hash mismatch
+  bool Feed(const uint8_t* data, size_t length);
+  // forget partially received chunk, download restarts at bytes_done()
+  void DropPartialChunk() { chunk_offset_ = 0; }
+
+  const ManifestHeader& manifest() { return manifest_; }
+  uint32_t bytes_done() { return bytes_done_; }
+  bool Complete() { return bytes_done_ == manifest_.image_size; }
+
+private:
+
+  uint32_t ChunkSize(uint32_t chunk_index);
+  bool ChunkHashMatches(uint32_t chunk_index, mbedtls_sha256_context* sha256);
+
+  FlashWriteFunction write_ = NULL;
+  FlashEraseFunction erase_ = NULL;
+  FlashReadFunction read_ = NULL;
+  void* context_ = NULL;
+
+  ManifestHeader manifest_ = {};
+  uint8_t* chunk_hashes_ = NULL;
+  uint32_t chunks_count_ = 0;
+
+  uint32_t bytes_done_ = 0;       // verified chunks
+  uint32_t chunk_offset_ = 0;     // bytes of current chunk written
+  mbedtls_sha256_context chunk_sha256_;
+
+};
+
+#endif  // OTA_IMAGE_H
@@ -0,0 +1,225 @@
+#include "rest_api.h"
+#include "json_reader.h"
+#include "json_writer.h"
+#include "alarm_clock.h"
+#include "rgb_display.h"
+#if defined(MCU_IS_ESP32)
+  #include <AsyncTCP.h>
+  #include <ESPAsyncWebServer.h>
+#endif
+
+// integer member value within [min_value, max_value]
+static bool ReadInt(JsonReader &reader, int32_t min_value, int32_t max_value, int32_t &value) {
+  JsonReader::Token token;
+  return reader.Next(token) == JsonReader::kNumber && JsonReader::ToInt(token, value) && value >= min_value && value <= max_value;
+}
+
+static bool ReadBool(JsonReader &reader, bool &value) {
+  JsonReader::Token token;
+  JsonReader::TokenType type = reader.Next(token);
+  value = (type == JsonReader::kTrue);
+  return type == JsonReader::kTrue || type == JsonReader::kFalse;
+}
+
+const char* RestApi::ParseAlarms(const char* body, size_t length, SettingsBatch &batch) {
+  JsonReader reader(body, length);
+  JsonReader::Token token;
+  batch.fields = 0;
+  batch.alarm_slots_mask = 0;
+  if(reader.Next(token) != JsonReader::kObjectStart)
+    return "expected object";
+  while(reader.Next(token) == JsonReader::kKey) {
+    if(!JsonReader::Equals(token, "alarms"))
+      return "unknown member";
+    if(reader.Next(token) != JsonReader::kArrayStart)
+      return "alarms: expected array";
+    while(reader.Next(token) == JsonReader::kObjectStart) {
+      int32_t slot = -1, minute_of_day = -1, weekdays = -1;
+      bool on = false, on_present = false;
+      while(reader.Next(token) == JsonReader::kKey) {
+        bool valid;
+        if(JsonReader::Equals(token, "slot"))
+          valid = ReadInt(reader, 0, kAlarmSlotsMax - 1, slot);
+        else if(JsonReader::Equals(token, "minute_of_day"))
+          valid = ReadInt(reader, 0, kMinutesInDay - 1, minute_of_day);
+        else if(JsonReader::Equals(token, "weekdays"))
+          valid = ReadInt(reader, 0, kAlarmEveryDay, weekdays);
+        else if(JsonReader::Equals(token, "on"))
+          valid = on_present = ReadBool(reader, on);
+        else
+          return "alarm: unknown member";
+        if(!valid)
+          return "alarm: invalid value";
+      }
+      if(token.type != JsonReader::kObjectEnd)
+        return "malformed JSON";
+      if(slot < 0 || minute_of_day < 0 || weekdays < 0 || !on_present)
+        return "alarm: needs slot, minute_of_day, on and weekdays";
+      if(batch.alarm_slots_mask & (1 << slot))
+        return "alarm: slot repeated";
+      AlarmSlot &alarm_slot = batch.alarm_schedule[slot];
+      alarm_slot.minute_of_day = minute_of_day;
+      alarm_slot.on = on;
+      alarm_slot.weekday_mask = weekdays;
+      batch.alarm_slots_mask |= (1 << slot);
+    }
+    if(token.type != JsonReader::kArrayEnd)
+      return "malformed JSON";
+  }
+  if(token.type != JsonReader::kObjectEnd || reader.Next(token) != JsonReader::kEnd)
+    return "malformed JSON";
+  if(batch.alarm_slots_mask == 0)
+    return "no alarms";
+  batch.fields = kSettingsAlarmSchedule;
+  return NULL;
+}
+
+const char* RestApi::ParseSettings(const char* body, size_t length, SettingsBatch &batch) {
+  JsonReader reader(body, length);
+  JsonReader::Token token;
+  batch.fields = 0;
+  if(reader.Next(token) != JsonReader::kObjectStart)
+    return "expected object";
+  while(reader.Next(token) == JsonReader::kKey) {
+    int32_t value;
+    bool valid;
+    uint8_t field;
+    if(JsonReader::Equals(token, "long_press_seconds")) {
+      valid = ReadInt(reader, kLongPressSecondsMin, kLongPressSecondsMax, value) && (value - kLongPressSecondsMin) % kLongPressSecondsStep == 0;
+      batch.long_press_seconds = value;
+      field = kSettingsLongPressSeconds;
+    }
+    else if(JsonReader::Equals(token, "night_dim_hour")) {
+      valid = ReadInt(reader, kNightDimHourMin, kNightDimHourMax, value);
+      batch.night_time_dim_hour = value;
+      field = kSettingsNightTimeDimHour;
+    }
+    else if(JsonReader::Equals(token, "rgb_strip_mode")) {
+      valid = ReadInt(reader, kRgbStripModeMin, kRgbStripModeMax, value);
+      batch.autorun_rgb_led_strip_mode = value;
+      field = kSettingsAutorunRgbLedStripMode;
+    }
+    else if(JsonReader::Equals(token, "screensaver_bounce")) {
+      valid = ReadBool(reader, batch.screensaver_bounce_not_fly_horizontally);
+      field = kSettingsScreensaverMotion;
+    }
+    else
+      return "unknown member";
+    if(!valid)
+      return "invalid value";
+    if(batch.fields & field)
+      return "member repeated";
+    batch.fields |= field;
+  }
+  if(token.type != JsonReader::kObjectEnd || reader.Next(token) != JsonReader::kEnd)
+    return "malformed JSON";
+  if(batch.fields == 0)
+    return "no settings";
+  return NULL;
+}
+
+bool RestApi::TakePending(SettingsBatch &batch) {
+  if(!pending_ready_.load(std::memory_order_acquire))
+    return false;
+  batch = pending_;
+  pending_ready_.store(false, std::memory_order_release);
+  return true;
+}
+
+#if defined(MCU_IS_ESP32)
+
+void RestApi::Register(AsyncWebServer* server) {
+  server->on("/api/alarms", HTTP_GET, [this](AsyncWebServerRequest *request){ HandleGet(request, kAlarms); });
+  server->on("/api/settings", HTTP_GET, [this](AsyncWebServerRequest *request){ HandleGet(request, kSettings); });
+  server->on("/api/alarms", HTTP_PUT, [this](AsyncWebServerRequest *request){ HandlePut(request, kAlarms); }, NULL,
+    [this](AsyncWebServerRequest *request, uint8_t *data, size_t length, size_t index, size_t total){ ReceiveBody(request, data, length, index, total); });
+  server->on("/api/settings", HTTP_PUT, [this](AsyncWebServerRequest *request){ HandlePut(request, kSettings); }, NULL,
+    [this](AsyncWebServerRequest *request, uint8_t *data, size_t length, size_t index, size_t total){ ReceiveBody(request, data, length, index, total); });
+}
+
+// constant time compare of bearer token
+bool RestApi::Authorized(AsyncWebServerRequest* request) {
+  if(!request->hasHeader("Authorization"))
+    return false;
+  const char* header = request->header("Authorization").c_str();
+  const char* kBearer = "Bearer ";
+  if(strncmp(header, kBearer, strlen(kBearer)) != 0)
+    return false;
+  const char* token = header + strlen(kBearer);
+  size_t token_length = strlen(token), api_token_length = strlen(api_token_);
+  uint8_t difference = (token_length != api_token_length);
+  for (size_t i = 0; i < token_length; i++)
+    difference |= token[i] ^ api_token_[i % api_token_length];
+  return difference == 0;
+}
+
+// body arrives in chunks before HandlePut(), a second request's body takes over the buffer
+void RestApi::ReceiveBody(AsyncWebServerRequest* request, uint8_t* data, size_t length, size_t index, size_t total) {
+  if(index == 0) {
+    body_owner_ = request;
+    body_length_ = 0;
+    body_too_large_ = (total >= kBodyMaxSize);
+  }
+  if(request != body_owner_ || body_too_large_ || index != body_length_ || body_length_ + length >= kBodyMaxSize)
+    return;
+  memcpy(body_ + body_length_, data, length);
+  body_length_ += length;
+}
+
+void RestApi::HandleGet(AsyncWebServerRequest* request, Resource resource) {
+  if(api_token_[0] == '\0') { SendError(request, 403, "REST API off, no MY_REST_API_TOKEN"); return; }
+  if(!Authorized(request)) { SendError(request, 401, "unauthorized"); return; }
+  JsonWriter json(response_, sizeof(response_));
+  json.BeginObject();
+  if(resource == kAlarms) {
+    json.BeginArray("alarms");
+    for (uint8_t slot = 0; slot < kAlarmSlotsMax; slot++) {
+      const AlarmSlot &alarm_slot = alarm_clock->alarm_schedule_[slot];
+      json.BeginObject();
+      json.AddUInt("slot", slot);
+      json.AddUInt("minute_of_day", alarm_slot.minute_of_day);
+      json.AddBool("on", alarm_slot.on);
+      json.AddUInt("weekdays", alarm_slot.weekday_mask);
+      json.EndObject();
+    }
+    json.EndArray();
+  }
+  else {
+    json.AddUInt("long_press_seconds", alarm_clock->alarm_long_press_seconds_);
+    json.AddUInt("night_dim_hour", (night_time_minutes - 720) / 60);
+    json.AddUInt("rgb_strip_mode", autorun_rgb_led_strip_mode);
+    json.AddBool("screensaver_bounce", display->screensaver_bounce_not_fly_horizontally_);
+  }
+  json.EndObject();
+  request->send(200, "application/json", response_);
+}
+
+void RestApi::HandlePut(AsyncWebServerRequest* request, Resource resource) {
+  bool body_complete = (request == body_owner_);
+  body_owner_ = NULL;
+  if(api_token_[0] == '\0') { SendError(request, 403, "REST API off, no MY_REST_API_TOKEN"); return; }
+  if(!Authorized(request)) { SendError(request, 401, "unauthorized"); return; }
+  if(!body_complete) { SendError(request, 400, "no body"); return; }
+  if(body_too_large_) { SendError(request, 413, "body too large"); return; }
+  if(pending_ready_.load(std::memory_order_acquire)) { SendError(request, 503, "busy, previous change not applied yet"); return; }
+
+  SettingsBatch batch;
+  const char* error = (resource == kAlarms ? ParseAlarms(body_, body_length_, batch) : ParseSettings(body_, body_length_, batch));
+  if(error != NULL) { SendError(request, 400, error); return; }
+  pending_ = batch;
+  pending_ready_.store(true, std::memory_order_release);
+  request->send(202, "application/json", "{\"accepted\":true}");
+}
+
+void RestApi::SendError(AsyncWebServerRequest* request, int code, const char* message) {
+  JsonWriter json(response_, sizeof(response_));
+  json.BeginObject();
+  json.AddString("error", message);
+  json.EndObject();
+  AsyncWebServerResponse *response = request->beginResponse(code, "application/json", response_);
+  if(code == 401)
+    response->addHeader("WWW-Authenticate", "Bearer");
+  request->send(response);
+}
+
+#endif
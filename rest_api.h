@@ -0,0 +1,71 @@
+#ifndef REST_API_H
+#define REST_API_H
+
+#include "common.h"
+#include "secrets.h"
+#include <atomic>
+
+class AsyncWebServer;
+class AsyncWebServerRequest;
+
+// Authenticated REST API on the web server for alarms and settings.
+//   GET  /api/alarms     {"alarms":[{"slot":0,"minute_of_day":420,"on":true,"weekdays":127},...]}
+//   PUT  /api/alarms     same shape, only listed slots change, every slot object has all 4 members
+//   GET  /api/settings   {"long_press_seconds":15,"night_dim_hour":10,"rgb_strip_mode":2,"screensaver_bounce":true}
+//   PUT  /api/settings   any subset of the members
+// Requests need header "Authorization: Bearer <MY_REST_API_TOKEN>", API is off without a token.
+// Bodies are copied into a fixed buffer and parsed with JsonReader. A valid PUT is put in a
+// one batch mailbox, loop() takes it and applies it, saving to NVS in one commit.
+class RestApi {
+
+public:
+
+  void Register(AsyncWebServer* server);
+
+  // loop() side, returns true with batch if a PUT was accepted since last call
+  bool TakePending(SettingsBatch &batch);
+
+  // parse PUT bodies into batch, return NULL if valid or an error message
+  static const char* ParseAlarms(const char* body, size_t length, SettingsBatch &batch);
+  static const char* ParseSettings(const char* body, size_t length, SettingsBatch &batch);
+
+  // accepted ranges, as offered by settings pages: long press 5, 15 or 25 seconds
+  static const uint8_t kLongPressSecondsMin = 5, kLongPressSecondsMax = 25, kLongPressSecondsStep = 10;
+  static const uint8_t kNightDimHourMin = 8, kNightDimHourMax = 11;
+  static const uint8_t kRgbStripModeMin = 1, kRgbStripModeMax = 3;
+
+private:
+
+  enum Resource : uint8_t {
+    kAlarms = 0,
+    kSettings,
+  };
+
+  bool Authorized(AsyncWebServerRequest* request);
+  void ReceiveBody(AsyncWebServerRequest* request, uint8_t* data, size_t length, size_t index, size_t total);
+  void HandleGet(AsyncWebServerRequest* request, Resource resource);
+  void HandlePut(AsyncWebServerRequest* request, Resource resource);
+  void SendError(AsyncWebServerRequest* request, int code, const char* message);
+
+  #if defined(MY_REST_API_TOKEN)   // create a secrets.h file with #define for MY_REST_API_TOKEN
+    const char* api_token_ = MY_REST_API_TOKEN;
+  #else
+    const char* api_token_ = "";
+  #endif
+
+  // request body, one request at a time, all handlers run on web server task
+  static const uint16_t kBodyMaxSize = 512;
+  char body_[kBodyMaxSize];
+  size_t body_length_ = 0;
+  bool body_too_large_ = false;
+  AsyncWebServerRequest* body_owner_ = NULL;
+
+  char response_[384];
+
+  // written by web server task while pending_ready_ is false, read by loop() while it is true
+  SettingsBatch pending_ = {};
+  std::atomic<bool> pending_ready_ = {false};
+
+};
+
+#endif  // REST_API_H
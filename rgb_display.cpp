@@ -3,6 +3,7 @@
 #include "alarm_clock.h"
 #include "rtc.h"
 #include "nvs_preferences.h"
+#include "activity_trace.h"
 
 void RGBDisplay::Setup() {
 
@@ -98,6 +99,7 @@ void RGBDisplay::SetBrightness(int brightness) {
     analogWrite(TFT_BL, brightness);
     if(debug_mode)
       PrintLn("Display Brightness set to ", brightness);
+    activity_trace.Event(ActivityTrace::kTraceBrightness, brightness);
   }
   // if(debug_mode)
   //   RealTimeOnScreenOutput(std::to_string(brightness), 50);
@@ -122,9 +124,10 @@ void RGBDisplay::CheckPhotoresistorAndSetBrightness() {
   int photodiode_light_raw = analogRead(PHOTORESISTOR_PIN);
   // int lcd_brightness_val = max(photodiode_light_raw * kBrightnessInactiveMax / kPhotodiodeLightRawMax, 1);
   int lcd_brightness_val2 = max((int)map(photodiode_light_raw, 0.2 / 3.3 * kPhotodiodeLightRawMax, kPhotodiodeLightRawMax, kNightBrightness, kBrightnessInactiveMax), kNightBrightness);
+  uint16_t todays_minutes = rtc->todays_minutes();
   if(rgb_led_strip_on)
     lcd_brightness_val2 = max(lcd_brightness_val2, kRgbStripOnDispMinBrightness);
-  else if(rtc->todays_minutes < night_time_minutes && rtc->todays_minutes >= kDayTimeMinutes)
+  else if(todays_minutes < night_time_minutes && todays_minutes >= kDayTimeMinutes)
     lcd_brightness_val2 = max(lcd_brightness_val2, kNonNightMinBrightness);
   if(debug_mode)
     Serial.printf("photodiode_light_raw = %d, lcd_brightness_val2 = %d\n", photodiode_light_raw, lcd_brightness_val2);
@@ -139,11 +142,12 @@ void RGBDisplay::CheckTimeAndSetBrightness() {
     SetBrightness(kDayBrightness);
   }
   else {
-    if(rtc->todays_minutes >= night_time_minutes)
+    uint16_t todays_minutes = rtc->todays_minutes();
+    if(todays_minutes >= night_time_minutes)
       SetBrightness(kNightBrightness);
-    else if(rtc->todays_minutes >= kEveningTimeMinutes)
+    else if(todays_minutes >= kEveningTimeMinutes)
       SetBrightness(kEveningBrightness);
-    else if(rtc->todays_minutes >= kDayTimeMinutes)
+    else if(todays_minutes >= kDayTimeMinutes)
       SetBrightness(kDayBrightness);
     else
       SetBrightness(kNightBrightness);
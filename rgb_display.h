@@ -41,6 +41,8 @@ public:
   void DisplayTimeUpdate();
   void Screensaver();
   void GoodMorningScreen();
+  void GoodMorningScreenFrame();
+  void GoodMorningScreenEnd();
   void SetAlarmScreen(bool process_user_input, bool inc_button_pressed, bool dec_button_pressed, bool push_button_pressed);
   void AlarmTriggeredScreen(bool first_time, int8_t button_press_seconds_counter);
   void DisplayWeatherInfo();
@@ -50,6 +52,7 @@ public:
   void ButtonHighlight(int16_t x, int16_t y, uint16_t w, uint16_t h, bool turnOn, int gap);
   void IncorrectTimeBanner();
   void FirmwareUpdatePage();
+  void FirmwareUpdateProgress(uint32_t bytes_done, uint32_t bytes_total, uint32_t bytes_per_second);
   void RealTimeOnScreenOutput(std::string text, int width);
   void DisplayCurrentPage();
   void DisplayCurrentPageButtonRow(bool is_on);
@@ -103,12 +106,15 @@ private:
 
 // PRIVATE FUNCTIONS
 
-  void DrawSun(int16_t x0, int16_t y0, uint16_t edge, int &tone_note_index, unsigned long &next_tone_change_time);
+  void DrawSunFrame(int16_t x0, int16_t y0, uint16_t edge, uint16_t frame);
+  int16_t SunRayVariation(int16_t i);
   void DrawRays(int16_t &cx, int16_t &cy, int16_t &rr, int16_t &rl, int16_t &rw, uint8_t &rn, int16_t &degStart, uint16_t &color);
   void DrawDenseCircle(int16_t &cx, int16_t &cy, int16_t r, uint16_t &color);
   void PickNewRandomColor();  // for screensaver
   void DrawButton(int16_t x, int16_t y, uint16_t w, uint16_t h, const char* label, uint16_t borderColor, uint16_t onFill, uint16_t offFill, bool isOn);
   void DrawTriangleButton(int16_t x, int16_t y, uint16_t w, uint16_t h, bool isUp, uint16_t borderColor, uint16_t fillColor);
+  // alarm set page weekday toggle, day 0 = Sunday
+  void DrawWeekdayButton(int16_t x, int16_t y, uint16_t w, uint16_t h, uint8_t day, uint16_t borderColor, uint16_t onFill, uint16_t offFill, bool isOn);
   void FastDrawTwoColorBitmapSpi(int16_t x, int16_t y, uint8_t* bitmap, int16_t w, int16_t h, uint16_t color, uint16_t bg);
   // keyboard functions
   void MakeKeyboard(const char type[][13], char* label);
@@ -139,6 +145,11 @@ private:
   int16_t alarm_row_x0_ = 0;
   int16_t alarm_icon_x0_ = 0, alarm_icon_y0_ = 0;
 
+  // good morning screen sun animation
+  uint16_t sun_frame_ = 0;
+  unsigned long sun_frame_time_ms_ = 0;
+  int16_t sun_variation_prev_ = 0;
+
 
 // PRIVATE CONSTANTS
 
@@ -159,6 +170,12 @@ private:
   const int kEveningBrightness = 100;
   const int kDayBrightness = 150;
 
+  // good morning screen sun position, size, frame time and ray steps of one animation cycle
+  const int16_t kSunX0 = 80, kSunY0 = 80;
+  const uint16_t kSunEdge = 160;
+  const unsigned long kSunFrameMs = 30;
+  const int16_t kSunRaySteps = 120;
+
 
   // color definitions
   const uint16_t  kDisplayColorBlack        = 0x0000;
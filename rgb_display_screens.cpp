@@ -3,6 +3,9 @@
 #include "wifi_stuff.h"
 #include "rtc.h"
 #include "touchscreen.h"
+#if defined(MCU_IS_ESP32)
+  #include "framebuffer_mirror.h"
+#endif
 
 /*!
     @brief  Draw a 565 RGB image at the specified (x,y) position using monochrome 8-bit image.
@@ -73,6 +76,9 @@ void RGBDisplay::FastDrawTwoColorBitmapSpi(int16_t x, int16_t y, uint8_t *bitmap
   }
   tft.endWrite();
   // Serial.print(" fastDrawBitmapTime "); Serial.print(charSpace); Serial.println(timer1);
+  #if defined(MCU_IS_ESP32)
+    framebuffer_mirror.Blit(x - bx1, y - by1, bitmap, saveW, saveH, color, bg);
+  #endif
 }
 
 void RGBDisplay::SetAlarmScreen(bool processUserInput, bool inc_button_pressed, bool dec_button_pressed, bool push_button_pressed) {
@@ -85,6 +91,10 @@ void RGBDisplay::SetAlarmScreen(bool processUserInput, bool inc_button_pressed,
   uint16_t onFill = kDisplayColorGreen, offFill = kDisplayColorBlack, borderColor = kDisplayColorCyan;
   uint16_t button_w = 2*gap_x, button_h = 2*gap_y;
   const char onStr[] = "ON", offStr[] = "OFF", setStr[] = "Set";
+  // title shows alarm slot being edited, weekday buttons row below time
+  int16_t slot_x = 2.5*gap_x, slot_y = gap_y / 2, day_y = 8.2*gap_y;
+  int16_t day_gap_x = 0.85*gap_x;
+  uint16_t slot_w = 6*gap_x, slot_h = 1.75*gap_y, day_w = 0.75*gap_x, day_h = 0.95*gap_y;
 
   if(!processUserInput) {
     // make alarm set page
@@ -94,7 +104,8 @@ void RGBDisplay::SetAlarmScreen(bool processUserInput, bool inc_button_pressed,
     // set title font
     tft.setFont(&Satisfy_Regular18pt7b);
 
-    char title[] = "Set Alarm";
+    char title[] = "Set Alarm 1";
+    title[sizeof(title) - 2] = '1' + alarm_clock->var_0_slot_;
 
     // change the text color to the background color
     tft.setTextColor(kDisplayBackroundColor);
@@ -148,7 +159,12 @@ void RGBDisplay::SetAlarmScreen(bool processUserInput, bool inc_button_pressed,
     // Cancel button
     DrawButton(setCancel_x, offCancel_y, button_w, button_h, cancelStr, borderColor, kDisplayColorOrange, offFill, true);
 
+    // weekday buttons
+    for (uint8_t day = 0; day < 7; day++)
+      DrawWeekdayButton(hr_x + day * day_gap_x, day_y, day_w, day_h, day, borderColor, onFill, offFill, (alarm_clock->var_5_weekday_mask_ & (1 << day)));
+
     // high light text / buttons
+    ButtonHighlight(slot_x, slot_y, slot_w, slot_h, (current_cursor == kAlarmSetPageSlot), 2);
     ButtonHighlight(hr_x, time_y - gap_y, gap_x, gap_y, (current_cursor == kAlarmSetPageHour), 10);
   }
   else {
@@ -166,6 +182,9 @@ void RGBDisplay::SetAlarmScreen(bool processUserInput, bool inc_button_pressed,
     //    8 = Alarm Off button
     //    9 = Set button
     //    10 = Cancel button
+    //    11 = Next alarm slot
+    //    12 = Previous alarm slot
+    //    13 - 19 = toggle Sunday - Saturday
     int16_t userButtonClick = 0;
 
     if(!inc_button_pressed && !dec_button_pressed && !push_button_pressed) {
@@ -203,6 +222,13 @@ void RGBDisplay::SetAlarmScreen(bool processUserInput, bool inc_button_pressed,
         userButtonClick = 9;
       else if(ts_x > setCancel_x && ts_x < setCancel_x + button_w && ts_y > offCancel_y && ts_y < offCancel_y + button_h)
         userButtonClick = 10;
+      else if(ts_x > slot_x && ts_x < slot_x + slot_w && ts_y > slot_y && ts_y < slot_y + slot_h)
+        userButtonClick = 11;
+      else if(ts_y > day_y && ts_y < day_y + day_h) {
+        for (uint8_t day = 0; day < 7; day++)
+          if(ts_x > hr_x + day * day_gap_x && ts_x < hr_x + day * day_gap_x + day_w)
+            userButtonClick = 13 + day;
+      }
     }
     else {
       // button input
@@ -218,8 +244,16 @@ void RGBDisplay::SetAlarmScreen(bool processUserInput, bool inc_button_pressed,
       //    8 = Alarm Off button
       //    9 = Set button
       //    10 = Cancel button
-
-      if(current_cursor == kAlarmSetPageHour) {
+      //    11 = Next alarm slot
+      //    12 = Previous alarm slot
+      //    13 - 19 = toggle Sunday - Saturday
+
+      if(current_cursor == kAlarmSetPageSlot) {
+        if(inc_button_pressed) userButtonClick = 11;
+        else if(dec_button_pressed) userButtonClick = 12;
+        else current_cursor = kAlarmSetPageHour;
+      }
+      else if(current_cursor == kAlarmSetPageHour) {
         if(inc_button_pressed) userButtonClick = 1;
         else if(dec_button_pressed) userButtonClick = 2;
         else current_cursor = kAlarmSetPageMinute;
@@ -232,12 +266,13 @@ void RGBDisplay::SetAlarmScreen(bool processUserInput, bool inc_button_pressed,
       else if(current_cursor == kAlarmSetPageAmPm) {
         if(inc_button_pressed) userButtonClick = 5;
         else if(dec_button_pressed) userButtonClick = 6;
-        else {
-          // if(alarm_clock->var_4_ON_)
-            current_cursor = kAlarmSetPageOn;
-          // else
-            // highlight = kAlarmSetPageOff;
-        }
+        else
+          current_cursor = kAlarmSetPageSunday;
+      }
+      else if(current_cursor >= kAlarmSetPageSunday && current_cursor <= kAlarmSetPageSaturday) {
+        // inc/dec toggles weekday, push moves to next weekday and after Saturday to On button
+        if(inc_button_pressed || dec_button_pressed) userButtonClick = 13 + (current_cursor - kAlarmSetPageSunday);
+        else current_cursor++;
       }
       else if(current_cursor == kAlarmSetPageOn || current_cursor == kAlarmSetPageOff) {
         if(inc_button_pressed || dec_button_pressed) {
@@ -271,7 +306,10 @@ void RGBDisplay::SetAlarmScreen(bool processUserInput, bool inc_button_pressed,
     }
 
     // high light text / buttons
+    ButtonHighlight(slot_x, slot_y, slot_w, slot_h, (current_cursor == kAlarmSetPageSlot), 2);
     ButtonHighlight(hr_x, time_y - gap_y, gap_x, gap_y, (current_cursor == kAlarmSetPageHour), 10);
+    for (uint8_t day = 0; day < 7; day++)
+      ButtonHighlight(hr_x + day * day_gap_x, day_y, day_w, day_h, (current_cursor == kAlarmSetPageSunday + day), 1);
     ButtonHighlight(min_x, time_y - gap_y, gap_x, gap_y, (current_cursor == kAlarmSetPageMinute), 10);
     ButtonHighlight(amPm_x, time_y - gap_y, gap_x, gap_y, (current_cursor == kAlarmSetPageAmPm), 10);
     ButtonHighlight(onOff_x, onSet_y, button_w, button_h, (current_cursor == kAlarmSetPageOn), 5);
@@ -392,6 +430,17 @@ void RGBDisplay::SetAlarmScreen(bool processUserInput, bool inc_button_pressed,
         DrawButton(onOff_x, offCancel_y, button_w, button_h, offStr, borderColor, onFill, offFill, !alarm_clock->var_4_ON_);
       }
     }
+    else if(userButtonClick == 11 || userButtonClick == 12) {
+      // show another alarm slot, unsaved edits of shown slot are dropped
+      alarm_clock->LoadSetScreenVariables((alarm_clock->var_0_slot_ + (userButtonClick == 11 ? 1 : kAlarmSlotsMax - 1)) % kAlarmSlotsMax);
+      SetAlarmScreen(/* process_user_input */ false, /* inc_button_pressed */ false, /* dec_button_pressed */ false, /* push_button_pressed */ false);
+    }
+    else if(userButtonClick >= 13 && userButtonClick <= 19) {
+      // toggle weekday
+      uint8_t day = userButtonClick - 13;
+      alarm_clock->var_5_weekday_mask_ ^= (1 << day);
+      DrawWeekdayButton(hr_x + day * day_gap_x, day_y, day_w, day_h, day, borderColor, onFill, offFill, (alarm_clock->var_5_weekday_mask_ & (1 << day)));
+    }
     else if(userButtonClick == 9 || userButtonClick == 10) {
       // set or cancel button pressed
       if(userButtonClick == 9) {  // set button pressed
@@ -431,6 +480,21 @@ void RGBDisplay::DrawButton(int16_t x, int16_t y, uint16_t w, uint16_t h, const
   tft.print(label);
 }
 
+void RGBDisplay::DrawWeekdayButton(int16_t x, int16_t y, uint16_t w, uint16_t h, uint8_t day, uint16_t borderColor, uint16_t onFill, uint16_t offFill, bool isOn) {
+  const char kWeekdayLetters[] = "SMTWTFS";
+  char label[2] = { kWeekdayLetters[day], '\0' };
+  tft.setFont(&FreeMonoBold9pt7b);
+  int16_t label_x0, label_y0;
+  uint16_t label_w, label_h;
+  tft.getTextBounds(label, x, y + h, &label_x0, &label_y0, &label_w, &label_h);
+  // make button
+  tft.fillRoundRect(x, y, w, h, kRadiusButtonRoundRect, (isOn ? onFill : offFill));
+  tft.drawRoundRect(x, y, w, h, kRadiusButtonRoundRect, borderColor);
+  tft.setTextColor((isOn ? offFill : onFill));
+  tft.setCursor(x + (w - label_w) / 2, y + h / 2 + label_h / 2);
+  tft.print(label);
+}
+
 void RGBDisplay::DrawTriangleButton(int16_t x, int16_t y, uint16_t w, uint16_t h, bool isUp, uint16_t borderColor, uint16_t fillColor) {
   int16_t x1, y1, x2, y2, x3, y3;
   if(isUp) {
@@ -865,6 +929,18 @@ void RGBDisplay::FirmwareUpdatePage() {
   tft.print(wifi_stuff->firmware_update_available_str_.c_str());
 }
 
+// download progress row under title, redrawn after every verified chunk
+void RGBDisplay::FirmwareUpdateProgress(uint32_t bytes_done, uint32_t bytes_total, uint32_t bytes_per_second) {
+  if(current_page != kFirmwareUpdatePage) return;
+  char progress_str[24];
+  snprintf(progress_str, sizeof(progress_str), "%u%%  %u KB/s", (unsigned int)((uint64_t)bytes_done * 100 / max(bytes_total, (uint32_t)1)), (unsigned int)(bytes_per_second / 1024));
+  tft.fillRect(0, 160, kTftWidth, 40, kDisplayBackroundColor);
+  tft.setFont(&FreeSans12pt7b);
+  tft.setTextColor(kDisplayColorCyan);
+  tft.setCursor(20, 190);
+  tft.print(progress_str);
+}
+
 void RGBDisplay::AlarmTriggeredScreen(bool firstTime, int8_t buttonPressSecondsCounter) {
 
   int16_t title_x0 = 30, title_y0 = 40;
@@ -1078,104 +1154,112 @@ void RGBDisplay::PickNewRandomColor() {
 
 void RGBDisplay::DisplayTimeUpdate() {
 
+  // nothing changed since last draw
+  if(!redraw_display_ && new_display_data_.changed_fields == 0)
+    return;
+
   bool isThisTheFirstTime = strcmp(displayed_data_.time_SS, "") == 0;
   if(redraw_display_) {
     tft.fillScreen(kDisplayBackroundColor);
     isThisTheFirstTime = true;
   }
+  const uint8_t changed_fields = new_display_data_.changed_fields;
 
   // initial gap if single digit hour
   const int16_t SINGLE_DIGIT_HOUR_GAP = 30;
   int16_t hh_gap_x = (rtc->hour() >= 10 ? 0 : SINGLE_DIGIT_HOUR_GAP);
 
-  if(1) {   // CODE USES CANVAS AND ALWAYS PUTS HH:MM:SS AmPm on it every second
+  if(1) {   // CODE USES CANVAS AND PUTS HH:MM:SS AmPm on it whenever time changes
 
-    // delete canvas if it exists
-    if(my_canvas_ != NULL) {
-      delete my_canvas_;
-      my_canvas_ = NULL;
-      // myCanvas.reset(nullptr);
-    }
+    if((changed_fields & (kTimeHHMMChanged | kTimeSSChanged)) || redraw_display_) {
 
-    // create new canvas for time row
-    if(rtc->year() < 2024)  { // incorrect time
-      my_canvas_ = new GFXcanvas1(kTftWidth, kTimeRowY0IncorrectTime);
+      // delete canvas if it exists
+      if(my_canvas_ != NULL) {
+        delete my_canvas_;
+        my_canvas_ = NULL;
+        // myCanvas.reset(nullptr);
+      }
 
-      IncorrectTimeBanner();
+      // create new canvas for time row
+      if(rtc->year() < 2024)  { // incorrect time
+        my_canvas_ = new GFXcanvas1(kTftWidth, kTimeRowY0IncorrectTime);
 
-      // draw canvas to tft   fastDrawBitmap
-      FastDrawTwoColorBitmapSpi(0, 0, my_canvas_->getBuffer(), kTftWidth, kTimeRowY0IncorrectTime, kDisplayTimeColor, kDisplayBackroundColor); // Copy to screen
-    }
-    else {
-      my_canvas_ = new GFXcanvas1(kTftWidth, kTimeRowY0 + 6);
-      my_canvas_->fillScreen(kDisplayBackroundColor);
-      my_canvas_->setTextWrap(false);
+        IncorrectTimeBanner();
 
-      // HH:MM
+        // draw canvas to tft   fastDrawBitmap
+        FastDrawTwoColorBitmapSpi(0, 0, my_canvas_->getBuffer(), kTftWidth, kTimeRowY0IncorrectTime, kDisplayTimeColor, kDisplayBackroundColor); // Copy to screen
+      }
+      else {
+        my_canvas_ = new GFXcanvas1(kTftWidth, kTimeRowY0 + 6);
+        my_canvas_->fillScreen(kDisplayBackroundColor);
+        my_canvas_->setTextWrap(false);
 
-      // set font
-      my_canvas_->setFont(&FreeSansBold48pt7b);
+        // HH:MM
 
-      // home the cursor
-      my_canvas_->setCursor(kTimeRowX0 + hh_gap_x, kTimeRowY0);
+        // set font
+        my_canvas_->setFont(&FreeSansBold48pt7b);
 
-      // change the text color to foreground color
-      my_canvas_->setTextColor(kDisplayTimeColor);
+        // home the cursor
+        my_canvas_->setCursor(kTimeRowX0 + hh_gap_x, kTimeRowY0);
 
-      // draw the new time value
-      my_canvas_->print(new_display_data_.time_HHMM);
-      // tft.setTextSize(1);
-      // delay(2000);
+        // change the text color to foreground color
+        my_canvas_->setTextColor(kDisplayTimeColor);
 
-      // and remember the new value
-      strcpy(displayed_data_.time_HHMM, new_display_data_.time_HHMM);
+        // draw the new time value
+        my_canvas_->print(new_display_data_.time_HHMM);
+        // tft.setTextSize(1);
+        // delay(2000);
 
+        // and remember the new value
+        strcpy(displayed_data_.time_HHMM, new_display_data_.time_HHMM);
 
-      // AM/PM
 
-      int16_t x0_pos = my_canvas_->getCursorX();
+        // AM/PM
 
-      // set font
-      my_canvas_->setFont(&FreeSans18pt7b);
+        int16_t x0_pos = my_canvas_->getCursorX();
 
-      // draw new AM/PM
-      if(new_display_data_._12_hour_mode) {
+        // set font
+        my_canvas_->setFont(&FreeSans18pt7b);
 
-        // home the cursor
-        my_canvas_->setCursor(x0_pos + kDisplayTextGap, kAM_PM_row_Y0);
-        // Serial.print("tft_AmPm_x0 "); Serial.print(tft_AmPm_x0); Serial.print(" y0 "); Serial.print(tft_AmPm_y0); Serial.print(" tft.getCursorX() "); Serial.print(tft.getCursorX()); Serial.print(" tft.getCursorY() "); Serial.println(tft.getCursorY()); 
+        // draw new AM/PM
+        if(new_display_data_._12_hour_mode) {
 
-        // draw the new time value
-        if(new_display_data_.pm_not_am)
-          my_canvas_->print(kPmLabel);
-        else
-          my_canvas_->print(kAmLabel);
-      }
+          // home the cursor
+          my_canvas_->setCursor(x0_pos + kDisplayTextGap, kAM_PM_row_Y0);
+          // Serial.print("tft_AmPm_x0 "); Serial.print(tft_AmPm_x0); Serial.print(" y0 "); Serial.print(tft_AmPm_y0); Serial.print(" tft.getCursorX() "); Serial.print(tft.getCursorX()); Serial.print(" tft.getCursorY() "); Serial.println(tft.getCursorY()); 
 
-      // and remember the new value
-      displayed_data_._12_hour_mode = new_display_data_._12_hour_mode;
-      displayed_data_.pm_not_am = new_display_data_.pm_not_am;
+          // draw the new time value
+          if(new_display_data_.pm_not_am)
+            my_canvas_->print(kPmLabel);
+          else
+            my_canvas_->print(kAmLabel);
+        }
 
+        // and remember the new value
+        displayed_data_._12_hour_mode = new_display_data_._12_hour_mode;
+        displayed_data_.pm_not_am = new_display_data_.pm_not_am;
 
-      // :SS
 
-      // home the cursor
-      my_canvas_->setCursor(x0_pos + kDisplayTextGap, kTimeRowY0);
+        // :SS
 
-      // draw the new time value
-      my_canvas_->print(new_display_data_.time_SS);
+        // home the cursor
+        my_canvas_->setCursor(x0_pos + kDisplayTextGap, kTimeRowY0);
 
-      // and remember the new value
-      strcpy(displayed_data_.time_SS, new_display_data_.time_SS);
+        // draw the new time value
+        my_canvas_->print(new_display_data_.time_SS);
 
-      // draw canvas to tft   fastDrawBitmap
-      FastDrawTwoColorBitmapSpi(0, 0, my_canvas_->getBuffer(), kTftWidth, kTimeRowY0 + 6, kDisplayTimeColor, kDisplayBackroundColor); // Copy to screen
-    }
+        // and remember the new value
+        strcpy(displayed_data_.time_SS, new_display_data_.time_SS);
 
-    // delete created canvas and null the pointer
-    delete my_canvas_;
-    my_canvas_ = NULL;
-    // myCanvas.reset(nullptr);
+        // draw canvas to tft   fastDrawBitmap
+        FastDrawTwoColorBitmapSpi(0, 0, my_canvas_->getBuffer(), kTftWidth, kTimeRowY0 + 6, kDisplayTimeColor, kDisplayBackroundColor); // Copy to screen
+      }
+
+      // delete created canvas and null the pointer
+      delete my_canvas_;
+      my_canvas_ = NULL;
+      // myCanvas.reset(nullptr);
+    }
 
   }
   else {    // CODE THAT CHECKS AND UPDATES ONLY CHANGES ON SCREEN HH:MM :SS AmPm
@@ -1189,7 +1273,7 @@ void RGBDisplay::DisplayTimeUpdate() {
     }
 
     // HH:MM string and AM/PM string
-    if (rtc->second() == 0 || strcmp(new_display_data_.time_HHMM, displayed_data_.time_HHMM) != 0 || redraw_display_) {
+    if (rtc->second() == 0 || (changed_fields & kTimeHHMMChanged) || redraw_display_) {
 
       // HH:MM
 
@@ -1295,7 +1379,7 @@ void RGBDisplay::DisplayTimeUpdate() {
     }
 
     // :SS string
-    if (rtc->second() == 0 || strcmp(new_display_data_.time_SS, displayed_data_.time_SS) != 0 || redraw_display_) {
+    if (rtc->second() == 0 || (changed_fields & kTimeSSChanged) || redraw_display_) {
       // set font
       tft.setFont(&FreeSans24pt7b);
 
@@ -1332,7 +1416,7 @@ void RGBDisplay::DisplayTimeUpdate() {
   }
 
   // date string center aligned
-  if (strcmp(new_display_data_.date_str, displayed_data_.date_str) != 0 || redraw_display_) {
+  if ((changed_fields & kDateChanged) || redraw_display_) {
     if(rtc->year() < 2024) {
       // if time is incorrect then don't bother drawing date row
 
@@ -1383,7 +1467,7 @@ void RGBDisplay::DisplayTimeUpdate() {
   }
 
   // alarm string center aligned
-  if (strcmp(new_display_data_.alarm_str, displayed_data_.alarm_str) != 0 || new_display_data_.alarm_ON != displayed_data_.alarm_ON || redraw_display_) {
+  if ((changed_fields & kAlarmChanged) || redraw_display_) {
     // set font
     tft.setFont(&Satisfy_Regular24pt7b);
 
@@ -1478,6 +1562,7 @@ void RGBDisplay::DisplayTimeUpdate() {
     tft.print(kChangeLog.c_str());
   }
 
+  new_display_data_.changed_fields = 0;
   redraw_display_ = false;
 }
 
@@ -1527,28 +1612,35 @@ void RGBDisplay::GoodMorningScreen() {
   // redraw the old value to erase
   tft.print(F("MORNING!!"));
 
-  int16_t x0 = 80, y0 = 80;
-  uint16_t edge = 160;
-  
-  unsigned int startTime = millis();
+  // start celebration song, played by timer callbacks while sun is drawn
+  alarm_clock->melody_.Play(kSongCharge);
 
-  // start tone
-  int tone_note_index = 0;
-  unsigned long next_tone_change_time = startTime;
-  alarm_clock->celebrateSong(tone_note_index, next_tone_change_time);
+  // sun is drawn a frame at a time by GoodMorningScreenFrame()
+  sun_frame_ = 0;
+  sun_frame_time_ms_ = millis();
+  DrawSunFrame(kSunX0, kSunY0, kSunEdge, sun_frame_);
+}
 
-  while(millis() - startTime < 5000)
-    DrawSun(x0, y0, edge, tone_note_index, next_tone_change_time);
+// called every loop() pass while good morning screen is shown, draws next sun frame when due
+void RGBDisplay::GoodMorningScreenFrame() {
+  if(millis() - sun_frame_time_ms_ < kSunFrameMs) return;
+  sun_frame_time_ms_ = millis();
+  sun_frame_++;
+  DrawSunFrame(kSunX0, kSunY0, kSunEdge, sun_frame_);
+}
 
+void RGBDisplay::GoodMorningScreenEnd() {
+  alarm_clock->melody_.Stop();
   tft.fillScreen(kDisplayColorBlack);
   redraw_display_ = true;
 }
 
-/* draw Sun
+/* draw Sun, one frame of its changing rays
  * 
- * params: top left corner 'x0' and 'y0', square edge length of graphic 'edge'
+ * params: top left corner 'x0' and 'y0', square edge length of graphic 'edge', frame number 'frame'
+ * each frame undraws rays of the previous frame and draws the next, face is drawn every kSunRaySteps frames
  */ 
-void RGBDisplay::DrawSun(int16_t x0, int16_t y0, uint16_t edge, int &tone_note_index, unsigned long &next_tone_change_time) {
+void RGBDisplay::DrawSunFrame(int16_t x0, int16_t y0, uint16_t edge, uint16_t frame) {
 
   // set dimensions of sun and rays
 
@@ -1569,60 +1661,62 @@ void RGBDisplay::DrawSun(int16_t x0, int16_t y0, uint16_t edge, int &tone_note_i
   uint16_t color = kDisplayColorYellow;
   uint16_t background = kDisplayColorBlack;
 
-  int16_t variation_prev = 0;
-
-  // sun
-  tft.fillCircle(cx, cy, sr, color);
-
-  // eyes
-  int16_t eye_offset_x = sr / 2, eye_offset_y = sr / 3, eye_r = max(sr / 8, 3);
-  tft.fillCircle(cx - eye_offset_x, cy - eye_offset_y, eye_r, background);
-  tft.fillCircle(cx + eye_offset_x, cy - eye_offset_y, eye_r, background);
-
-  // draw smile
-  int16_t smile_angle_deg = 37;
-  int16_t smile_cy = cy - sr / 2;
-  int16_t smile_r = sr * 1.1, smile_w = max(sr / 15, 3);
-  for(uint8_t i = 0; i <= smile_angle_deg; i=i+2) {
-    float smile_angle_rad = DEG_TO_RAD * i;
-    int16_t smile_tapered_w = max(smile_w - i / 13, 1);
-    // Serial.print(i); Serial.print(" "); Serial.print(smile_w); Serial.print(" "); Serial.println(smile_tapered_w);
-    int16_t smile_offset_x = smile_r * sin(smile_angle_rad), smile_offset_y = smile_r * cos(smile_angle_rad);
-    tft.fillCircle(cx - smile_offset_x, smile_cy + smile_offset_y, smile_tapered_w, background);
-    tft.fillCircle(cx + smile_offset_x, smile_cy + smile_offset_y, smile_tapered_w, background);
-  }
-
-  // draw changing rays
-  for(int16_t i = 0; i < 120; i++) {
-    ResetWatchdog();
-    // variation goes from 0 to 5 to 0
-    int16_t i_base10_fwd = i % 10;
-    int16_t i_base10_bwd = ((i / 10) + 1) * 10 - i;
-    int16_t variation = min(i_base10_fwd, i_base10_bwd);
-    // Serial.println(variation);
+  // undraw previous frame
+  if(frame > 0) {
+    int16_t i = (frame - 1) % kSunRaySteps;
+    int16_t variation = SunRayVariation(i);
     int16_t r_variable = rr + variation;
-    // draw rays
-    DrawRays(cx, cy, r_variable, rl, rw, rn, i, color);
-    // increase sun size
-    // tft.drawCircle(cx, cy, sr + variation, color);
-    DrawDenseCircle(cx, cy, sr + variation, color);
-    // show for sometime
-    delay(30);
-
     // undraw rays
     DrawRays(cx, cy, r_variable, rl, rw, rn, i, background);
     // reduce sun size
-    if(variation < variation_prev){
+    if(variation < sun_variation_prev_){
       // tft.drawCircle(cx, cy, sr + variation_prev, background);
-      DrawDenseCircle(cx, cy, sr + variation_prev + 1, background);
+      DrawDenseCircle(cx, cy, sr + sun_variation_prev_ + 1, background);
     }
-    // delay(1000);
-    variation_prev = variation;
+    sun_variation_prev_ = variation;
+  }
 
-    // celebration tone
-    if(millis() > next_tone_change_time)
-      alarm_clock->celebrateSong(tone_note_index, next_tone_change_time);
+  int16_t i = frame % kSunRaySteps;
+  if(i == 0) {
+    sun_variation_prev_ = 0;
+
+    // sun
+    tft.fillCircle(cx, cy, sr, color);
+
+    // eyes
+    int16_t eye_offset_x = sr / 2, eye_offset_y = sr / 3, eye_r = max(sr / 8, 3);
+    tft.fillCircle(cx - eye_offset_x, cy - eye_offset_y, eye_r, background);
+    tft.fillCircle(cx + eye_offset_x, cy - eye_offset_y, eye_r, background);
+
+    // draw smile
+    int16_t smile_angle_deg = 37;
+    int16_t smile_cy = cy - sr / 2;
+    int16_t smile_r = sr * 1.1, smile_w = max(sr / 15, 3);
+    for(uint8_t i = 0; i <= smile_angle_deg; i=i+2) {
+      float smile_angle_rad = DEG_TO_RAD * i;
+      int16_t smile_tapered_w = max(smile_w - i / 13, 1);
+      // Serial.print(i); Serial.print(" "); Serial.print(smile_w); Serial.print(" "); Serial.println(smile_tapered_w);
+      int16_t smile_offset_x = smile_r * sin(smile_angle_rad), smile_offset_y = smile_r * cos(smile_angle_rad);
+      tft.fillCircle(cx - smile_offset_x, smile_cy + smile_offset_y, smile_tapered_w, background);
+      tft.fillCircle(cx + smile_offset_x, smile_cy + smile_offset_y, smile_tapered_w, background);
+    }
   }
+
+  // draw changing rays
+  int16_t variation = SunRayVariation(i);
+  int16_t r_variable = rr + variation;
+  // draw rays
+  DrawRays(cx, cy, r_variable, rl, rw, rn, i, color);
+  // increase sun size
+  // tft.drawCircle(cx, cy, sr + variation, color);
+  DrawDenseCircle(cx, cy, sr + variation, color);
+}
+
+// variation goes from 0 to 5 to 0 over every 10 ray steps
+int16_t RGBDisplay::SunRayVariation(int16_t i) {
+  int16_t i_base10_fwd = i % 10;
+  int16_t i_base10_bwd = ((i / 10) + 1) * 10 - i;
+  return min(i_base10_fwd, i_base10_bwd);
 }
 
 /* draw rays
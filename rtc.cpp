@@ -77,7 +77,7 @@ void RTC::Ds3231RtcSetup() {
 
   // set rtcHw in 12 hour mode if not already
   if(rtc_hw_.hourModeAndAmPm() == 0) {
-    rtc_hw_.set_12hour_mode(true);
+    set_12hour_mode(true);    // refreshes snapshot too
     delay(100);
   }
 
@@ -99,7 +99,7 @@ void RTC::Ds3231RtcSetup() {
     PrintLn("Oscillator will use VBAT if VCC cuts off.");
 
   // // make RTC class object _second equal to rtcHw second; + 2 seconds to let time synchronization happen on first time 60 seconds hitting
-  // second_ = rtc_hw_.second() + 2;
+  // snapshot_.second = rtc_hw_.second() + 2;
 
   // seconds interrupt pin
   pinMode(SQW_INT_PIN, INPUT_PULLUP);
@@ -114,13 +114,11 @@ void RTC::Refresh() {
   rtc_hw_.refresh();
   rtc_refresh_reqd_ = false;
 
-  // make _second equal to rtcHw seconds -> should be 0
-  second_ = rtc_hw_.second();
+  // publish RTC HW time and date, seconds should be 0
+  PublishSnapshotFromRtcHw();
 
   PrintLn("__RTC Refresh__ ");
 
-  SetTodaysMinutes();
-
   // Check whether RTC HW experienced a power loss and thereby know if time is up to date or not
   if (rtc_hw_.lostPower()) {
     PrintLn("RTC POWER FAILED. Time is not up to date!");
@@ -133,30 +131,158 @@ void RTC::Refresh() {
 
 }
 
+// publish time and date read from RTC HW into snapshot_
+// seqlock writer: sequence is odd while fields are being written
+void RTC::PublishSnapshotFromRtcHw() {
+  TimeSnapshot fresh;
+  fresh.second = rtc_hw_.second();
+  fresh.minute = rtc_hw_.minute();
+  fresh.hour = rtc_hw_.hour();
+  fresh.hour_mode_and_am_pm = rtc_hw_.hourModeAndAmPm();
+  fresh.day = rtc_hw_.day();
+  fresh.month = rtc_hw_.month();
+  fresh.year = rtc_hw_.year() + 2000;
+  fresh.day_of_week = rtc_hw_.dayOfWeek();
+  fresh.todays_minutes = ClockTimeToDaysMinutes(fresh.hour_mode_and_am_pm, fresh.hour, fresh.minute);
+
+  // keep seconds ISR out while publishing
+  #if defined(MCU_IS_ESP32)
+    portENTER_CRITICAL(&snapshot_writer_mux_);
+  #else
+    noInterrupts();
+  #endif
+  snapshot_seq_ = snapshot_seq_ + 1;
+  __sync_synchronize();
+  snapshot_ = fresh;
+  __sync_synchronize();
+  snapshot_seq_ = snapshot_seq_ + 1;
+  #if defined(MCU_IS_ESP32)
+    portEXIT_CRITICAL(&snapshot_writer_mux_);
+  #else
+    interrupts();
+  #endif
+}
+
+// seqlock reader: copy snapshot and retry if a writer was active or published meanwhile
+RTC::TimeSnapshot RTC::Now() {
+  TimeSnapshot copy;
+  while(1) {
+    uint32_t seq_start = snapshot_seq_;
+    if(seq_start & 1)
+      continue;   // writer mid-publish
+    __sync_synchronize();
+    copy = snapshot_;
+    __sync_synchronize();
+    if(snapshot_seq_ == seq_start)
+      break;
+  }
+  return copy;
+}
+
+uint32_t RTC::TimeSnapshot::minutes_since_2024() const {
+  if(year < 2024 || month < 1 || month > 12) return 0;
+  static const uint16_t kDaysBeforeMonth[12] = { 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334 };
+  uint32_t days = 0;
+  for (uint16_t y = 2024; y < year; y++)
+    days += (y % 4 == 0 ? 366 : 365);
+  days += kDaysBeforeMonth[month - 1] + (month > 2 && year % 4 == 0 ? 1 : 0) + day - 1;
+  return days * kMinutesInDay + todays_minutes;
+}
+
 // clock seconds interrupt ISR
 void IRAM_ATTR RTC::SecondsUpdateInterruptISR() {
-  // update seconds
-  second_++;
+  #if defined(MCU_IS_ESP32)
+    portENTER_CRITICAL_ISR(&snapshot_writer_mux_);
+  #endif
+  snapshot_seq_ = snapshot_seq_ + 1;
+  __sync_synchronize();
+  // update seconds, rolling over minute, hour and date
+  AdvanceSnapshotOneSecond();
+  __sync_synchronize();
+  snapshot_seq_ = snapshot_seq_ + 1;
+  #if defined(MCU_IS_ESP32)
+    portEXIT_CRITICAL_ISR(&snapshot_writer_mux_);
+  #endif
+
   // a flag for others that time has updated!
   rtc_hw_sec_update_ = true;
 
-  // refresh time on rtc class object on new minute
-  if(second_ >= 60) {
+  // refresh time on rtc class object from RTC HW on new minute
+  if(snapshot_.second == 0) {
     rtc_hw_min_update_ = true;
     rtc_refresh_reqd_ = true;
   }
 }
 
-uint8_t RTC::minute() {
+// advance snapshot by one second inside ISR, rolling over minute, hour and date
+// RTC HW refresh on new minute will overwrite it with RTC HW values
+void IRAM_ATTR RTC::AdvanceSnapshotOneSecond() {
+  snapshot_.second++;
+  if(snapshot_.second < 60)
+    return;
+  snapshot_.second = 0;
+
+  // new minute
+  snapshot_.todays_minutes++;
+  snapshot_.minute++;
+  if(snapshot_.minute < 60)
+    return;
+  snapshot_.minute = 0;
+
+  // new hour
+  if(snapshot_.hour_mode_and_am_pm == 0) {
+    // 24 hour mode
+    snapshot_.hour = (snapshot_.hour + 1) % 24;
+  }
+  else {
+    // 12 hour mode, AM and PM flip going from 11 to 12
+    if(snapshot_.hour == 12)
+      snapshot_.hour = 1;
+    else {
+      snapshot_.hour++;
+      if(snapshot_.hour == 12)
+        snapshot_.hour_mode_and_am_pm = (snapshot_.hour_mode_and_am_pm == 1 ? 2 : 1);
+    }
+  }
+  if(snapshot_.todays_minutes < 24 * 60)
+    return;
+  snapshot_.todays_minutes = 0;
+
+  // new day
+  snapshot_.day_of_week = (snapshot_.day_of_week % 7) + 1;
+  uint8_t days_in_month = 31;
+  if(snapshot_.month == 2)
+    days_in_month = (snapshot_.year % 4 == 0 ? 29 : 28);
+  else if(snapshot_.month == 4 || snapshot_.month == 6 || snapshot_.month == 9 || snapshot_.month == 11)
+    days_in_month = 30;
+  snapshot_.day++;
+  if(snapshot_.day <= days_in_month)
+    return;
+  snapshot_.day = 1;
+  snapshot_.month++;
+  if(snapshot_.month <= 12)
+    return;
+  snapshot_.month = 1;
+  snapshot_.year++;
+}
+
+RTC::TimeSnapshot RTC::RefreshedNow() {
   if(rtc_refresh_reqd_)
     Refresh();
-  return rtc_hw_.minute();
+  return Now();
+}
+
+uint8_t RTC::minute() {
+  return RefreshedNow().minute;
 }
 
 uint8_t RTC::hour() {
-  if(rtc_refresh_reqd_)
-    Refresh();
-  return rtc_hw_.hour();
+  return RefreshedNow().hour;
+}
+
+void RTC::set_12hour_mode(const bool twelveHrMode) {
+  rtc_hw_.set_12hour_mode(twelveHrMode);
+  Refresh();
 }
 
 /**
@@ -191,22 +317,6 @@ void RTC::SetRtcTimeAndDate(uint8_t second, uint8_t minute, uint8_t hour_24_hr_m
   Refresh();
 }
 
-void RTC::SetTodaysMinutes() {
-  uint16_t todays_minutes_temp = minute();
-  if(hourModeAndAmPm() == 0) {
-    // 24 hour mode
-    todays_minutes_temp += hour() * 60;
-  }
-  else {
-    // 12 hour mode
-    if(hour() != 12)
-      todays_minutes_temp += hour() * 60;
-    if(hourModeAndAmPm() == 2)
-      todays_minutes_temp += 12 * 60;
-  }
-  todays_minutes = todays_minutes_temp;
-}
-
 void RTC::DaysMinutesToClockTime(uint16_t todays_minutes_val, uint8_t &hour_mode_and_am_pm, uint8_t &hr, uint8_t &min) {
   if(todays_minutes_val >= 60 * 12) {
     hour_mode_and_am_pm = 2;
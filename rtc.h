@@ -20,7 +20,34 @@ public:
   static inline volatile bool rtc_hw_sec_update_ = false;     // seconds flag triggered by interrupt
   static inline volatile bool rtc_hw_min_update_ = false;     // minutes change flag
 
-  uint16_t todays_minutes = 0;
+  // time and date copy that the seconds ISR and RTC HW refresh publish together
+  // readers on any core get a consistent copy using Now(), without locks
+  struct TimeSnapshot {
+    uint8_t second;
+    uint8_t minute;
+    uint8_t hour;
+    uint8_t hour_mode_and_am_pm;    // 0 = 24 hour mode, 1 = 12 hour AM, 2 = 12 hour PM
+    uint8_t day;
+    uint8_t month;
+    uint16_t year;
+    uint8_t day_of_week;            // Sunday = 1
+    uint16_t todays_minutes;
+    uint16_t minute_of_week() const { return (day_of_week - 1) * kMinutesInDay + todays_minutes; }   // Sunday 12:00 AM = 0
+    uint32_t minutes_since_2024() const;    // local time minutes since Jan 1 2024 12:00 AM, 0 if time is not set
+  };
+
+  /**
+  * \brief Returns a consistent copy of time and date. Lock-free seqlock read,
+  * retries if the seconds ISR or an RTC HW refresh published while copying.
+  * Safe to call from either core.
+  */
+  TimeSnapshot Now();
+
+  /**
+  * \brief Refreshes from RTC HW if a new minute has arrived, then returns Now().
+  * RTC HW is on I2C, so call it only from core0 loop.
+  */
+  TimeSnapshot RefreshedNow();
 
   /**
   * \brief Sets RTC HW datetime data with input Hr in 24 hour mode and puts RTC to 12 hour mode
@@ -35,12 +62,13 @@ public:
   */
   void SetRtcTimeAndDate(uint8_t second, uint8_t minute, uint8_t hour_24_hr_mode, uint8_t dayOfWeek_Sun_is_1, uint8_t day, uint8_t month_Jan_is_1, uint16_t year);
 
-  uint8_t second() { return second_; }
+  uint8_t second() { return Now().second; }
   uint8_t minute();
   uint8_t hour();
-  uint8_t day() { return rtc_hw_.day(); }
-  uint8_t month() { return rtc_hw_.month(); }
-  uint16_t year() { return rtc_hw_.year() + 2000; }
+  uint8_t day() { return Now().day; }
+  uint8_t month() { return Now().month; }
+  uint16_t year() { return Now().year; }
+  uint16_t todays_minutes() { return Now().todays_minutes; }
   /**
   * \brief Returns actual Day Of Week
   *
@@ -53,7 +81,7 @@ public:
   *   - #URTCLIB_WEEKDAY_FRIDAY = 6
   *   - #URTCLIB_WEEKDAY_SATURDAY = 7
   */
-  uint8_t dayOfWeek() { return rtc_hw_.dayOfWeek(); }
+  uint8_t dayOfWeek() { return Now().day_of_week; }
   /**
   * \brief Returns whether clock is in 12 or 24 hour mode
   * and AM or PM if in 12 hour mode
@@ -63,7 +91,7 @@ public:
   *
   * @return byte with value 0, 1 or 2
   */
-  uint8_t hourModeAndAmPm() { return rtc_hw_.hourModeAndAmPm(); }
+  uint8_t hourModeAndAmPm() { return Now().hour_mode_and_am_pm; }
 
   /**
   * \brief Set clock in 12 or 24 hour mode
@@ -73,7 +101,7 @@ public:
   *
   * @param twelveHrMode true or false
   */
-  void set_12hour_mode(const bool twelveHrMode) { rtc_hw_.set_12hour_mode(twelveHrMode); }
+  void set_12hour_mode(const bool twelveHrMode);
 
   void DaysMinutesToClockTime(uint16_t todays_minutes_val, uint8_t &hour_mode_and_am_pm, uint8_t &hr, uint8_t &min);
 
@@ -84,22 +112,33 @@ private:
   // RTC clock object for DC3231 rtc
   uRTCLib rtc_hw_;
 
-  // seconds counter to track RTC HW seconds, without
+  // published time snapshot, tracks RTC HW seconds without
   // bothering it with I2C calls all the time.
-  // we'll refresh RTC time everytime second reaches 60
-  // All other parameters of RTC will not change at any other time
-  // at 60 seconds, we'll update the time row
-  static inline volatile uint8_t second_ = 0;
+  // ISR advances it every second and rolls it over on new minute,
+  // we'll refresh RTC time from HW everytime second reaches 60
+  static inline TimeSnapshot snapshot_ = { 0, 0, 12, 1, 1, 1, 2000, 1, 0 };
+
+  // seqlock sequence counter: odd while a writer is publishing snapshot_
+  static inline volatile uint32_t snapshot_seq_ = 0;
+
+  // writers (seconds ISR and Refresh) exclude each other, readers never block
+  #if defined(MCU_IS_ESP32)
+    static inline portMUX_TYPE snapshot_writer_mux_ = portMUX_INITIALIZER_UNLOCKED;
+  #endif
 
   static inline volatile bool rtc_refresh_reqd_ = false;
 
   // private function to refresh time from RTC HW and do basic power failure checks
   void Refresh();
 
+  // publish time and date read from RTC HW into snapshot_
+  void PublishSnapshotFromRtcHw();
+
   // clock seconds interrupt ISR
   static void IRAM_ATTR SecondsUpdateInterruptISR();
 
-  void SetTodaysMinutes();
+  // advance snapshot by one second inside ISR, rolling over minute, hour and date
+  static void IRAM_ATTR AdvanceSnapshotOneSecond();
 
 };
 
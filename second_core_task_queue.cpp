@@ -0,0 +1,141 @@
+#include "second_core_task_queue.h"
+
+SecondCoreTaskHandle SecondCoreTaskQueue::Push(SecondCoreTask task, unsigned long deadline_ms) {
+  if(task >= kNoTask) return { kNoTask, 0 };
+
+  while(true) {
+    uint8_t expected = kSlotFree;
+    if(slot_state_[task].compare_exchange_strong(expected, kSlotClaimed, std::memory_order_acquire))
+      return Submit(task, deadline_ms, kSlotPending);
+    // running task may have read its inputs already, so it runs again for this submission
+    if(expected == kSlotRunning) {
+      if(slot_state_[task].compare_exchange_strong(expected, kSlotRunningClaimed, std::memory_order_acquire))
+        return Submit(task, deadline_ms, kSlotRunningRequeued);
+      continue;
+    }
+    // already waiting for consumer, wait on that submission
+    if(expected == kSlotPending || expected == kSlotRunningRequeued)
+      return { task, submitted_generation_[task].load(std::memory_order_acquire) };
+    // another producer is writing slot data, retry
+  }
+}
+
+// producer side, slot is claimed
+SecondCoreTaskHandle SecondCoreTaskQueue::Submit(SecondCoreTask task, unsigned long deadline_ms, SlotState submitted_state) {
+  slot_deadline_ms_[task] = deadline_ms;
+  slot_sequence_[task] = next_sequence_.fetch_add(1, std::memory_order_relaxed);
+  uint32_t generation = submitted_generation_[task].load(std::memory_order_relaxed) + 1;
+  submitted_generation_[task].store(generation, std::memory_order_relaxed);
+  slot_state_[task].store(submitted_state, std::memory_order_release);
+  return { task, generation };
+}
+
+uint8_t SecondCoreTaskQueue::PendingCount() {
+  uint8_t pending_count = 0;
+  for (int i = 0; i < kNoTask; i++)
+    if(slot_state_[i].load(std::memory_order_relaxed) == kSlotPending || slot_state_[i].load(std::memory_order_relaxed) == kSlotRunningRequeued)
+      pending_count++;
+  return pending_count;
+}
+
+bool SecondCoreTaskQueue::Pop(SecondCoreTask &task) {
+  while(true) {
+    // highest priority pending task
+    int best_task = kNoTask;
+    for (int i = 0; i < kNoTask; i++) {
+      if(slot_state_[i].load(std::memory_order_acquire) != kSlotPending) continue;
+      if(best_task == kNoTask || kTaskPriority[i] > kTaskPriority[best_task])
+        best_task = i;
+    }
+    if(best_task == kNoTask)
+      return false;
+    // earlier submitted pending pair task goes first
+    SecondCoreTask pair_task = kTaskPair[best_task];
+    if(pair_task != kNoTask && slot_state_[pair_task].load(std::memory_order_acquire) == kSlotPending
+        && (int32_t)(slot_sequence_[pair_task] - slot_sequence_[best_task]) < 0)
+      best_task = pair_task;
+
+    // only consumer moves a slot out of pending state, run covers all submissions made so far
+    // slot data is read before release to running, after which a producer may write a new submission
+    running_generation_[best_task] = submitted_generation_[best_task].load(std::memory_order_relaxed);
+    unsigned long deadline_ms = slot_deadline_ms_[best_task];
+    slot_state_[best_task].store(kSlotRunning, std::memory_order_release);
+
+    // drop stale task
+    if(deadline_ms != 0 && (long)(millis() - deadline_ms) > 0) {
+      PrintLn("SecondCoreTaskQueue: deadline passed, dropped task ", best_task);
+      Done((SecondCoreTask)best_task, false);
+      continue;
+    }
+
+    task = (SecondCoreTask)best_task;
+    return true;
+  }
+}
+
+void SecondCoreTaskQueue::Done(SecondCoreTask task, bool success) {
+  result_[task].store(success, std::memory_order_relaxed);
+  completed_generation_[task].store(running_generation_[task], std::memory_order_release);
+  EndRun(task, kSlotFree);
+
+  // wake up waiting core
+  #if defined(MCU_IS_ESP32)
+    TaskHandle_t waiter_task = waiter_task_.load(std::memory_order_acquire);
+    if(waiter_task != NULL)
+      xTaskNotifyGive(waiter_task);
+  #elif defined(MCU_IS_RP2040)
+    __sev();
+  #endif
+}
+
+void SecondCoreTaskQueue::Defer(SecondCoreTask task) {
+  EndRun(task, kSlotPending);
+}
+
+void SecondCoreTaskQueue::EndRun(SecondCoreTask task, SlotState not_requeued_state) {
+  while(true) {
+    uint8_t expected = kSlotRunning;
+    if(slot_state_[task].compare_exchange_strong(expected, not_requeued_state, std::memory_order_acq_rel))
+      return;
+    if(expected == kSlotRunningRequeued) {
+      // producers do not touch a requeued slot
+      slot_state_[task].store(kSlotPending, std::memory_order_release);
+      return;
+    }
+    // a producer is writing a new submission, retry
+  }
+}
+
+bool SecondCoreTaskQueue::Completed(const SecondCoreTaskHandle &handle) {
+  if(handle.task >= kNoTask) return true;
+  return (int32_t)(completed_generation_[handle.task].load(std::memory_order_acquire) - handle.generation) >= 0;
+}
+
+bool SecondCoreTaskQueue::Succeeded(const SecondCoreTaskHandle &handle) {
+  if(handle.task >= kNoTask || !Completed(handle)) return false;
+  return result_[handle.task].load(std::memory_order_relaxed);
+}
+
+bool SecondCoreTaskQueue::Wait(const SecondCoreTaskHandle &handle, unsigned long timeout_ms) {
+  unsigned long time_start = millis();
+  #if defined(MCU_IS_ESP32)
+    waiter_task_.store(xTaskGetCurrentTaskHandle(), std::memory_order_release);
+  #endif
+  // notification is latched, so a Done() between Completed() check and sleep is not missed
+  while(!Completed(handle)) {
+    unsigned long elapsed_ms = millis() - time_start;
+    if(elapsed_ms >= timeout_ms) {
+      PrintLn("SecondCoreTaskQueue::Wait(): timed out, task ", handle.task);
+      break;
+    }
+    #if defined(MCU_IS_ESP32)
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout_ms - elapsed_ms));
+    #elif defined(MCU_IS_RP2040)
+      best_effort_wfe_or_timeout(make_timeout_time_ms(timeout_ms - elapsed_ms));
+    #endif
+  }
+  #if defined(MCU_IS_ESP32)
+    waiter_task_.store(NULL, std::memory_order_relaxed);
+  #endif
+  return Succeeded(handle);
+}
@@ -0,0 +1,102 @@
+#ifndef SECOND_CORE_TASK_QUEUE_H
+#define SECOND_CORE_TASK_QUEUE_H
+
+#include "common.h"
+#include <atomic>
+#if defined(MCU_IS_RP2040)
+  #include "pico/time.h"
+  #include "hardware/sync.h"
+#endif
+
+// Bounded lock-free multi producer / single consumer queue of second core tasks.
+// There is one slot per SecondCoreTask, so a task can be pending only once (deduplication)
+// and the queue can never overflow. A task submitted again while it runs is queued once more, to run
+// after the running one. A slot is claimed by producers with a compare and swap,
+// the consumer (loop1) takes the highest priority pending task and drops it if its deadline passed.
+// Paired tasks (start and stop of a server, WiFi connect and disconnect) run in submission order.
+// Push returns a handle, the waiting core sleeps on a FreeRTOS task notification (ESP32)
+// or WFE (RP2040) until Done() of that exact submission and then reads its result.
+class SecondCoreTaskQueue {
+
+public:
+
+  // if task is already pending, returns handle of that submission
+  // a running task is submitted again, it runs once more after the current run
+  SecondCoreTaskHandle Push(SecondCoreTask task, unsigned long deadline_ms = 0);
+
+  // consumer side, returns false if no task is pending
+  bool Pop(SecondCoreTask &task);
+  void Done(SecondCoreTask task, bool success);
+  // put running task back in queue, same submission and deadline, when it has to wait for something
+  void Defer(SecondCoreTask task);
+
+  // tasks waiting for consumer, running task not counted
+  uint8_t PendingCount();
+
+  bool Completed(const SecondCoreTaskHandle &handle);
+  // result of latest completed submission of handle's task
+  bool Succeeded(const SecondCoreTaskHandle &handle);
+
+  // block calling core until task completes or timeout, returns task success
+  // not for single core MCUs, where loop1() needs to run the task on the calling core
+  bool Wait(const SecondCoreTaskHandle &handle, unsigned long timeout_ms);
+
+private:
+
+  enum SlotState : uint8_t {
+    kSlotFree = 0,
+    kSlotClaimed,     // a producer is writing slot data
+    kSlotPending,     // waiting for consumer
+    kSlotRunning,     // consumer is executing task
+    kSlotRunningClaimed,    // running, and a producer is writing data of a new submission
+    kSlotRunningRequeued,   // running, new submission becomes pending when this run is done
+  };
+
+  SecondCoreTaskHandle Submit(SecondCoreTask task, unsigned long deadline_ms, SlotState submitted_state);
+  // consumer side, running slot goes to pending if it was requeued meanwhile, else to not_requeued_state
+  void EndRun(SecondCoreTask task, SlotState not_requeued_state);
+
+  // higher runs first. WiFi server stop and time update are most important,
+  // WiFi disconnect is last so that it runs after other pending WiFi tasks.
+  static inline const uint8_t kTaskPriority[kNoTask] = {
+    4,    // kStartSetWiFiSoftAP
+    6,    // kStopSetWiFiSoftAP
+    4,    // kStartLocationInputsLocalServer
+    6,    // kStopLocationInputsLocalServer
+    3,    // kGetWeatherInfo
+    5,    // kUpdateTimeFromNtpServer
+    4,    // kConnectWiFi
+    0,    // kDisconnectWiFi
+    2,    // kFirmwareVersionCheck
+  };
+
+  // a stop must not overtake an earlier start of same thing, so pending paired tasks run in submission order
+  static inline const SecondCoreTask kTaskPair[kNoTask] = {
+    kStopSetWiFiSoftAP,                 // kStartSetWiFiSoftAP
+    kStartSetWiFiSoftAP,                // kStopSetWiFiSoftAP
+    kStopLocationInputsLocalServer,     // kStartLocationInputsLocalServer
+    kStartLocationInputsLocalServer,    // kStopLocationInputsLocalServer
+    kNoTask,                            // kGetWeatherInfo
+    kNoTask,                            // kUpdateTimeFromNtpServer
+    kDisconnectWiFi,                    // kConnectWiFi
+    kConnectWiFi,                       // kDisconnectWiFi
+    kNoTask,                            // kFirmwareVersionCheck
+  };
+
+  std::atomic<uint8_t> slot_state_[kNoTask] = {};
+  unsigned long slot_deadline_ms_[kNoTask] = {};   // 0 = no deadline, written only while slot is claimed
+  uint32_t slot_sequence_[kNoTask] = {};           // submission order, written only while slot is claimed
+  std::atomic<uint32_t> next_sequence_ = {0};
+  std::atomic<uint32_t> submitted_generation_[kNoTask] = {};   // incremented only while slot is claimed
+  uint32_t running_generation_[kNoTask] = {};      // latest submission when consumer took the task, consumer only
+  std::atomic<uint32_t> completed_generation_[kNoTask] = {};
+  std::atomic<bool> result_[kNoTask] = {};      // written before completed_generation_
+
+#if defined(MCU_IS_ESP32)
+  // core waiting in Wait(), notified by Done()
+  std::atomic<TaskHandle_t> waiter_task_ = {NULL};
+#endif
+
+};
+
+#endif  // SECOND_CORE_TASK_QUEUE_H
@@ -0,0 +1,331 @@
+// Alarm schedule of the real sketch over simulated weeks: the whole sketch runs on the host
+// stand-ins, the simulated DS3231 is ticked every second and AlarmClock::NewMinute() is called on
+// each new minute as from loop(). For random and edge case schedules, in 12 and 24 hour RTC
+// modes, alarms must fire exactly at the minutes a brute force check of every slot gives, and
+// MinutesToAlarm() and the main page alarm string must match it in between. Also checks time
+// jumps, the main page alarm toggle, 12 hour set page round trips, the packed NVS blob and
+// migration of the single alarm keys into slot 0.
+
+#include "common.h"
+#include "host.h"
+#include "check.h"
+#include "rtc.h"
+#include "alarm_clock.h"
+#include "nvs_preferences.h"
+#include "general_constants.h"
+#include <uRTCLib.h>
+#include <Preferences.h>
+#include <random>
+#include <string.h>
+#include <vector>
+
+void setup();
+
+static std::mt19937 random_generator(28);
+static uint32_t wrong_fires = 0, wrong_minutes_to_alarm = 0, wrong_alarm_strings = 0;
+
+// brute force: any slot on this minute of week
+static bool AlarmDue(const AlarmSlot* schedule, uint16_t minute_of_week) {
+  for (int i = 0; i < kAlarmSlotsMax; i++)
+    if(schedule[i].on && (schedule[i].weekday_mask & (1 << (minute_of_week / kMinutesInDay))) && schedule[i].minute_of_day == minute_of_week % kMinutesInDay)
+      return true;
+  return false;
+}
+
+// brute force: minutes from each minute of week to the next due minute after it, a week if
+// that one is the only one, -1 if none is due
+static std::vector<int16_t> MinutesToNextDue(const AlarmSlot* schedule) {
+  std::vector<int16_t> minutes_to_next(kMinutesInWeek, -1);
+  for (uint16_t minute_of_week = 0; minute_of_week < kMinutesInWeek; minute_of_week++) {
+    if(!AlarmDue(schedule, minute_of_week)) continue;
+    // walk back to the previous due minute
+    for (uint16_t d = 1; d <= kMinutesInWeek; d++) {
+      uint16_t before = (minute_of_week + kMinutesInWeek - d) % kMinutesInWeek;
+      minutes_to_next[before] = d % kMinutesInWeek;
+      if(AlarmDue(schedule, before)) break;
+    }
+  }
+  return minutes_to_next;
+}
+
+// DS3231 SQW rising edge a second later
+static void TickSecond() {
+  HostSetPin(SQW_INT_PIN, LOW);
+  HostDs3231Tick();
+  HostSetPin(SQW_INT_PIN, HIGH);
+}
+
+// a minute of seconds, NewMinute() on the new minute as loop() does; returns NewMinute() result
+static bool RunMinute(uint16_t &minute_of_week) {
+  for (int i = 0; i < 60; i++)
+    TickSecond();
+  CHECK(rtc->rtc_hw_min_update_);
+  rtc->rtc_hw_min_update_ = false;
+  RTC::TimeSnapshot now = rtc->RefreshedNow();
+  minute_of_week = now.minute_of_week();
+  return alarm_clock->NewMinute(minute_of_week);
+}
+
+// RTC on Saturday Jun 1 2024 23:59:00, a minute before the week starts
+static void StartWeek(bool twelve_hour_mode) {
+  HostDs3231Set(0, 59, 23, 7, 1, 6, 24);
+  rtc->set_12hour_mode(twelve_hour_mode);
+  HostTakeSerialOutput();
+}
+
+// main page alarm string for the alarm minutes_to_next after minute_of_week, -1 for none
+static std::string ExpectedAlarmString(uint16_t minute_of_week, int16_t minutes_to_next) {
+  if(minutes_to_next < 0)
+    return std::string(kAlarmLabel) + " " + kOffLabel;
+  uint16_t minute_of_day = (minute_of_week + minutes_to_next) % kMinutesInDay;
+  uint8_t hr_12 = (minute_of_day / 60) % 12;
+  char alarm_str[kAlarmArraySize];
+  snprintf(alarm_str, kAlarmArraySize, "%d:%02d %s", (hr_12 == 0 ? 12 : hr_12), minute_of_day % 60, (minute_of_day < 12 * 60 ? kAmLabel : kPmLabel));
+  return alarm_str;
+}
+
+// main page strings as loop() prepares them, the alarm one checked against the brute force
+static void CheckMainPageAlarm(uint16_t minute_of_week, int16_t minutes_to_next) {
+  PrepareTimeDayDateArrays();
+  std::string expected = ExpectedAlarmString(minute_of_week, minutes_to_next);
+  if((new_display_data_.alarm_str != expected || new_display_data_.alarm_ON != (minutes_to_next >= 0)) && wrong_alarm_strings++ < 5)
+    fprintf(stderr, "minute of week %u: main page \"%s\" %d, expected \"%s\"\n", minute_of_week,
+      new_display_data_.alarm_str, new_display_data_.alarm_ON, expected.c_str());
+}
+
+// every minute of a week and the first minute of the next, returns alarms fired
+static uint32_t RunWeek(const AlarmSlot* schedule) {
+  std::vector<int16_t> minutes_to_next = MinutesToNextDue(schedule);
+  uint32_t fired = 0;
+  for (uint32_t minute = 0; minute <= kMinutesInWeek; minute++) {
+    uint16_t minute_of_week;
+    bool due = RunMinute(minute_of_week);
+    if(due) fired++;
+    if(due != AlarmDue(schedule, minute_of_week) && wrong_fires++ < 5)
+      fprintf(stderr, "minute of week %u: NewMinute() %d, expected %d\n", minute_of_week, due, !due);
+    int16_t expected = minutes_to_next[minute_of_week];
+    if(alarm_clock->MinutesToAlarm() != expected && wrong_minutes_to_alarm++ < 5)
+      fprintf(stderr, "minute of week %u: MinutesToAlarm() %d, expected %d\n", minute_of_week, alarm_clock->MinutesToAlarm(), expected);
+    CheckMainPageAlarm(minute_of_week, expected);
+    if(minute % 60 == 0)
+      HostTakeSerialOutput();   // RTC refresh prints every minute
+  }
+  return fired;
+}
+
+static void SetSchedule(const AlarmSlot* schedule) {
+  for (int i = 0; i < kAlarmSlotsMax; i++)
+    alarm_clock->SetAlarmSlot(i, schedule[i].minute_of_day, schedule[i].on, schedule[i].weekday_mask, false);
+}
+
+static uint32_t ExpectedFires(const AlarmSlot* schedule) {
+  // first minute of next week is Sunday 12:00 AM again
+  uint32_t fires = AlarmDue(schedule, 0);
+  for (uint16_t minute_of_week = 0; minute_of_week < kMinutesInWeek; minute_of_week++)
+    fires += AlarmDue(schedule, minute_of_week);
+  return fires;
+}
+
+// midnight, noon and the minutes around them, week ends and weekdays, overlapping slots
+static void TestEdgeCaseSchedules() {
+  const AlarmSlot schedules[][kAlarmSlotsMax] = {
+    { { 0, 1, 0, 0x01, 0 }, { 12 * 60, 1, 0, 0x40, 0 }, { 11 * 60 + 59, 1, 0, 0x3E, 0 }, { 23 * 60 + 59, 1, 0, 0x41, 0 } },
+    { { 12 * 60 + 59, 1, 0, 0x7F, 0 }, { 59, 1, 0, 0x7F, 0 }, { 13 * 60, 1, 0, 0x2A, 0 }, { 1 * 60, 1, 0, 0x55, 0 } },
+    // same minute in two slots fires once, masks without days and off slots never fire
+    { { 7 * 60, 1, 0, 0x3E, 0 }, { 7 * 60, 1, 0, 0x7F, 0 }, { 8 * 60, 1, 0, 0x00, 0 }, { 9 * 60, 0, 0, 0x7F, 0 } },
+    // only on Saturday, the day the week starts after
+    { { 23 * 60 + 59, 1, 0, 0x40, 0 }, { 0, 0, 0, 0x7F, 0 }, { 0, 0, 0, 0x7F, 0 }, { 0, 0, 0, 0x7F, 0 } },
+    // nothing on
+    { { 7 * 60, 0, 0, 0x7F, 0 }, { 0, 0, 0, 0x7F, 0 }, { 0, 0, 0, 0x7F, 0 }, { 0, 0, 0, 0x7F, 0 } },
+  };
+  for (bool twelve_hour_mode : { true, false }) {
+    for (const auto &schedule : schedules) {
+      StartWeek(twelve_hour_mode);
+      SetSchedule(schedule);
+      CHECK_EQ(RunWeek(schedule), ExpectedFires(schedule));
+    }
+  }
+  CHECK_EQ(ExpectedFires(schedules[2]), 7);
+  CHECK_EQ(ExpectedFires(schedules[4]), 0);
+}
+
+static void TestRandomSchedules() {
+  for (int run = 0; run < 6; run++) {
+    AlarmSlot schedule[kAlarmSlotsMax] = {};
+    for (int i = 0; i < kAlarmSlotsMax; i++) {
+      schedule[i].minute_of_day = random_generator() % kMinutesInDay;
+      schedule[i].on = (random_generator() % 4 != 0);
+      schedule[i].weekday_mask = random_generator() % 128;
+    }
+    StartWeek(run % 2 == 0);
+    SetSchedule(schedule);
+    CHECK_EQ(RunWeek(schedule), ExpectedFires(schedule));
+  }
+}
+
+// RTC set from NTP or the settings page: next alarm is recomputed, alarms jumped over do not fire
+static void TestTimeJumps() {
+  const AlarmSlot schedule[kAlarmSlotsMax] = { { 7 * 60, 1, 0, 0x3E, 0 } };    // weekdays 7:00 AM
+  SetSchedule(schedule);
+  uint16_t minute_of_week;
+
+  // Monday 6:58 AM
+  HostDs3231Set(0, 58, 6, 2, 3, 6, 24);
+  rtc->set_12hour_mode(true);
+  CHECK(!RunMinute(minute_of_week));
+  CHECK_EQ(alarm_clock->MinutesToAlarm(), 1);
+  // forward over 7:00 AM to 7:30:59 AM
+  HostDs3231Set(59, 30, 7, 2, 3, 6, 24);
+  rtc->set_12hour_mode(true);
+  CHECK(!RunMinute(minute_of_week));
+  CHECK_EQ(alarm_clock->MinutesToAlarm(), 24 * 60 - 31);
+  // back to 6:59:59 AM, the alarm is ahead again
+  HostDs3231Set(59, 59, 6, 2, 3, 6, 24);
+  rtc->set_12hour_mode(true);
+  CHECK(RunMinute(minute_of_week));
+  CHECK_EQ(minute_of_week, 1 * kMinutesInDay + 7 * 60);
+  CHECK_EQ(alarm_clock->MinutesToAlarm(), 24 * 60);
+  // Friday 7:00 AM fires, next is Monday
+  HostDs3231Set(0, 59, 6, 6, 7, 6, 24);
+  rtc->set_12hour_mode(false);
+  CHECK(RunMinute(minute_of_week));
+  CHECK_EQ(alarm_clock->MinutesToAlarm(), 3 * 24 * 60);
+  HostTakeSerialOutput();
+}
+
+// main page shows the alarm that fires next, whichever slot it is in, and its toggle turns the
+// whole schedule off and back on
+static void TestMainPageToggle() {
+  // Monday 6:00 AM; slot 0 is off, slot 2 fires Tuesday 6:30 AM, slot 3 today 11:00 PM
+  const AlarmSlot schedule[kAlarmSlotsMax] = { { 7 * 60, 0, 0, 0x7F, 0 }, { 5 * 60, 1, 0, 0x00, 0 }, { 6 * 60 + 30, 1, 0, 0x04, 0 }, { 23 * 60, 1, 0, 0x02, 0 } };
+  HostDs3231Set(0, 0, 6, 2, 3, 6, 24);
+  rtc->set_12hour_mode(true);
+  SetSchedule(schedule);
+  PrepareTimeDayDateArrays();
+  CHECK_STR(new_display_data_.alarm_str, "11:00 PM");
+  CHECK(new_display_data_.alarm_ON);
+  // slot 3 off: Tuesday's slot 2 is next, slot 1 without weekdays never is
+  alarm_clock->SetAlarmSlot(3, 23 * 60, false, 0x02, false);
+  PrepareTimeDayDateArrays();
+  CHECK_STR(new_display_data_.alarm_str, "6:30 AM");
+  CHECK_EQ(alarm_clock->MinutesToAlarm(), 24 * 60 + 30);
+
+  alarm_clock->ToggleAlarms();
+  PrepareTimeDayDateArrays();
+  CHECK_STR(new_display_data_.alarm_str, "Alarm Off");
+  CHECK(!new_display_data_.alarm_ON);
+  CHECK_EQ(alarm_clock->MinutesToAlarm(), -1);
+  AlarmSlot saved[kAlarmSlotsMax];
+  nvs_preferences->RetrieveAlarmSchedule(saved);
+  for (int i = 0; i < kAlarmSlotsMax; i++)
+    CHECK_EQ(saved[i].on, 0);
+  // back on: the slots that were on, not slot 0
+  alarm_clock->ToggleAlarms();
+  PrepareTimeDayDateArrays();
+  CHECK_STR(new_display_data_.alarm_str, "6:30 AM");
+  CHECK(new_display_data_.alarm_ON);
+  nvs_preferences->RetrieveAlarmSchedule(saved);
+  CHECK_EQ(saved[0].on, 0);
+  CHECK_EQ(saved[1].on, 1);
+  CHECK_EQ(saved[2].on, 1);
+  CHECK_EQ(saved[3].on, 0);
+
+  // nothing to turn back on, as after a boot: slot 0 is turned on, every day if it had no weekdays
+  AlarmClock booted_clock;
+  memset(booted_clock.alarm_schedule_, 0, sizeof(booted_clock.alarm_schedule_));
+  booted_clock.alarm_schedule_[0].minute_of_day = 7 * 60 + 5;
+  booted_clock.alarm_ON_ = false;
+  booted_clock.ToggleAlarms();
+  CHECK_EQ(booted_clock.alarm_schedule_[0].on, 1);
+  CHECK_EQ(booted_clock.alarm_schedule_[0].weekday_mask, kAlarmEveryDay);
+  CHECK(booted_clock.alarm_ON_);
+  CHECK_EQ(booted_clock.alarm_hr_, 7);
+  CHECK_EQ(booted_clock.alarm_min_, 5);
+  CHECK(booted_clock.alarm_is_AM_);
+  HostTakeSerialOutput();
+}
+
+// alarm set page works in 12 hour form: every minute of the day survives the round trip
+static void TestSetPageRoundTrip() {
+  for (uint16_t minute_of_day = 0; minute_of_day < kMinutesInDay; minute_of_day++) {
+    alarm_clock->SetAlarmSlot(0, minute_of_day, true, kAlarmEveryDay, false);
+    alarm_clock->LoadSetScreenVariables(0);
+    uint8_t hr_12 = (minute_of_day / 60) % 12;
+    CHECK_EQ(alarm_clock->var_1_, (hr_12 == 0 ? 12 : hr_12));
+    CHECK_EQ(alarm_clock->var_2_, minute_of_day % 60);
+    CHECK_EQ(alarm_clock->var_3_is_AM_, minute_of_day < 12 * 60);
+    // edit and save on slot 2
+    alarm_clock->var_0_slot_ = 2;
+    alarm_clock->var_5_weekday_mask_ = minute_of_day % 128;
+    alarm_clock->SaveAlarm();
+    CHECK_EQ(alarm_clock->alarm_schedule_[2].minute_of_day, minute_of_day);
+    CHECK_EQ(alarm_clock->alarm_schedule_[2].weekday_mask, minute_of_day % 128);
+    HostTakeSerialOutput();
+  }
+}
+
+// schedule is one packed blob in NVS, read back as saved
+static void TestNvsBlob() {
+  CHECK_EQ(sizeof(AlarmSlot), 4);
+  const AlarmSlot schedule[kAlarmSlotsMax] = { { 6 * 60 + 15, 1, 0, 0x3E, 0 }, { 23 * 60 + 59, 0, 0, 0x41, 0 }, { 0, 1, 0, 0x7F, 0 }, { 12 * 60, 1, 0, 0x00, 0 } };
+  for (int i = 0; i < kAlarmSlotsMax; i++)
+    alarm_clock->SetAlarmSlot(i, schedule[i].minute_of_day, schedule[i].on, schedule[i].weekday_mask);
+  std::vector<uint8_t> blob;
+  CHECK(HostNvsRead("longPressData", "AlarmSchedule", blob));
+  CHECK_EQ(blob.size(), sizeof(schedule));
+  CHECK(blob.size() == sizeof(schedule) && memcmp(blob.data(), schedule, sizeof(schedule)) == 0);
+  AlarmSlot saved[kAlarmSlotsMax];
+  nvs_preferences->RetrieveAlarmSchedule(saved);
+  CHECK(memcmp(saved, schedule, sizeof(schedule)) == 0);
+  HostTakeSerialOutput();
+}
+
+// single alarm settings of older firmware become slot 0, every day
+static void TestMigration() {
+  HostNvsErase();
+  Preferences preferences;
+  preferences.begin("longPressData", false);
+  preferences.putUChar("AlarmHr", 6);
+  preferences.putUChar("AlarmMin", 45);
+  preferences.putBool("AlarmIsAm", false);
+  preferences.putBool("AlarmOn", true);
+  preferences.end();
+  AlarmSlot migrated[kAlarmSlotsMax];
+  nvs_preferences->RetrieveAlarmSchedule(migrated);
+  CHECK_EQ(migrated[0].minute_of_day, 18 * 60 + 45);
+  CHECK_EQ(migrated[0].on, 1);
+  for (int i = 0; i < kAlarmSlotsMax; i++)
+    CHECK_EQ(migrated[i].weekday_mask, kAlarmEveryDay);
+  for (int i = 1; i < kAlarmSlotsMax; i++)
+    CHECK_EQ(migrated[i].on, 0);
+  std::vector<uint8_t> blob;
+  CHECK(HostNvsRead("longPressData", "AlarmSchedule", blob));
+  CHECK(blob.size() == sizeof(migrated) && memcmp(blob.data(), migrated, sizeof(migrated)) == 0);
+  HostTakeSerialOutput();
+}
+
+int main() {
+  HostDs3231Set(0, 0, 6, 2, 3, 6, 24);
+  HostSetPin(BUTTON_PIN, HIGH);
+  HostSetPin(INC_BUTTON_PIN, HIGH);
+  HostSetPin(DEC_BUTTON_PIN, HIGH);
+  setup();
+  HostTakeSerialOutput();
+
+  // first boot migrated the default single alarm, 7:30 AM off
+  CHECK_EQ(alarm_clock->alarm_schedule_[0].minute_of_day, 7 * 60 + 30);
+  CHECK_EQ(alarm_clock->alarm_schedule_[0].on, 0);
+  CHECK_EQ(alarm_clock->MinutesToAlarm(), -1);
+
+  TestEdgeCaseSchedules();
+  TestRandomSchedules();
+  TestTimeJumps();
+  TestMainPageToggle();
+  TestSetPageRoundTrip();
+  TestNvsBlob();
+  TestMigration();
+  CHECK_EQ(wrong_fires, 0);
+  CHECK_EQ(wrong_minutes_to_alarm, 0);
+  CHECK_EQ(wrong_alarm_strings, 0);
+  return CHECK_RESULT();
+}
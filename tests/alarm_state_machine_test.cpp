@@ -0,0 +1,326 @@
+// Alarm state machine of the real sketch on virtual time: the whole sketch runs on the host
+// stand-ins. AdvanceAlarm() is first driven with explicit timestamps and button events to check
+// ringing, held, released, good morning and dismissed transitions, that a hold needs a long press
+// event, exact long press, good morning and max on times, and the buzzer LEDC channel and beep
+// timer. Then the alarm is started from the serial
+// console and loop() runs every millisecond with the DS3231 SQW ticking: seconds, serial input
+// and second core tasks must keep going while it rings and while the good morning sun is
+// animated, a held push button must end it in the first loop() past the long press time, and
+// virtual time between loop() passes must never jump by seconds.
+
+#include "common.h"
+#include "host.h"
+#include "check.h"
+#include "alarm_clock.h"
+#include "second_core_task_queue.h"
+#include <uRTCLib.h>
+#include <esp_timer.h>
+#include <set>
+
+void setup();
+void loop();
+void loop1();
+void ResetWatchdog();
+
+const uint8_t kBuzzerChannel = 2;       // kBuzzerLedcChannel of alarm_clock.h
+
+static bool BuzzerOn() {
+  return HostLedcPinChannel(BUZZER_PIN) == kBuzzerChannel && HostLedcFrequency(kBuzzerChannel) == 2048;
+}
+
+// AdvanceAlarm() as from loop(), with no button event or the one loop() took at now_ms
+static void Advance(unsigned long now_ms) {
+  alarm_clock->AdvanceAlarm(now_ms, NULL);
+}
+
+static void Advance(unsigned long now_ms, ButtonEvents::EventType type, uint8_t buttons = ButtonEvents::kPushButtonBit) {
+  ButtonEvents::Event event = { type, buttons, (uint32_t)(now_ms * 1000) };
+  alarm_clock->AdvanceAlarm(now_ms, &event);
+}
+
+static void StartAndPress(unsigned long start_ms, unsigned long press_ms) {
+  alarm_clock->StartAlarm(start_ms);
+  CHECK_EQ(alarm_clock->alarm_state_, AlarmClock::kAlarmRinging);
+  Advance(press_ms - 1);
+  CHECK_EQ(alarm_clock->alarm_state_, AlarmClock::kAlarmRinging);
+  Advance(press_ms, ButtonEvents::kPress);
+  CHECK_EQ(alarm_clock->alarm_state_, AlarmClock::kAlarmHeld);
+}
+
+// dismissed state goes back to idle and the main page on the next call
+static void FinishDismissed(unsigned long now_ms) {
+  CHECK_EQ(alarm_clock->alarm_state_, AlarmClock::kAlarmDismissed);
+  CHECK(!BuzzerOn());
+  Advance(now_ms);
+  CHECK_EQ(alarm_clock->alarm_state_, AlarmClock::kAlarmIdle);
+  CHECK(!alarm_clock->AlarmActive());
+  CHECK_EQ(current_page, kMainPage);
+  HostTakeSerialOutput();
+}
+
+// good morning screen is shown for 5 s from start_ms, button events do not cut it short
+static void FinishGoodMorning(unsigned long start_ms) {
+  CHECK_EQ(alarm_clock->alarm_state_, AlarmClock::kAlarmGoodMorning);
+  CHECK(!BuzzerOn());
+  Advance(start_ms + 4998, ButtonEvents::kRelease);
+  Advance(start_ms + 4999, ButtonEvents::kPress);
+  CHECK_EQ(alarm_clock->alarm_state_, AlarmClock::kAlarmGoodMorning);
+  Advance(start_ms + 5000);
+  FinishDismissed(start_ms + 5001);
+}
+
+// buzzer beeps 800 ms on, 800 ms off from its timer while ringing, off while button is held
+static void TestBuzzer() {
+  alarm_clock->StartAlarm(1000);
+  CHECK_EQ(current_page, kAlarmTriggeredPage);
+  CHECK(BuzzerOn());
+  CHECK_EQ(HostLedcDuty(kBuzzerChannel), 128);
+  HostAdvanceMillis(801);
+  CHECK_EQ(HostLedcDuty(kBuzzerChannel), 0);
+  CHECK_EQ(HostPinOutput(LED_PIN), LOW);
+  HostAdvanceMillis(800);
+  CHECK_EQ(HostLedcDuty(kBuzzerChannel), 128);
+  CHECK_EQ(HostPinOutput(LED_PIN), HIGH);
+  // a second start while ringing is ignored
+  alarm_clock->StartAlarm(2000);
+  Advance(3000, ButtonEvents::kPress);
+  CHECK_EQ(alarm_clock->alarm_state_, AlarmClock::kAlarmHeld);
+  CHECK(!BuzzerOn());
+  CHECK_EQ(HostPinOutput(BUZZER_PIN), LOW);
+  CHECK_EQ(HostPinOutput(LED_PIN), LOW);
+  // beep timer is stopped too
+  HostAdvanceMillis(2000);
+  CHECK_EQ(HostLedcDuty(kBuzzerChannel), 0);
+  Advance(3001, ButtonEvents::kRelease);
+  CHECK_EQ(alarm_clock->alarm_state_, AlarmClock::kAlarmReleased);
+  Advance(3002);
+  CHECK_EQ(alarm_clock->alarm_state_, AlarmClock::kAlarmRinging);
+  CHECK(BuzzerOn());
+  // max on time counts from the first start
+  Advance(1000 + alarm_clock->kAlarmMaxON_TimeMs + 1);
+  FinishDismissed(200000);
+}
+
+// held for exactly the long press time is not enough, a millisecond more shows good morning
+static void TestLongPressIsExact() {
+  for (uint8_t long_press_seconds : { 5, 15, 25 }) {
+    alarm_clock->alarm_long_press_seconds_ = long_press_seconds;
+    unsigned long press_ms = 1000000 + long_press_seconds;
+    StartAndPress(1000000, press_ms);
+    // button events report repeats every 200 ms and the long press at 1 s
+    for (unsigned long held_ms = 1; held_ms <= long_press_seconds * 1000UL; held_ms += 7) {
+      if(held_ms >= 1000 && held_ms < 1007)
+        Advance(press_ms + held_ms, ButtonEvents::kLongPress);
+      else if(held_ms % 200 < 7)
+        Advance(press_ms + held_ms, ButtonEvents::kRepeat);
+      else
+        Advance(press_ms + held_ms);
+    }
+    Advance(press_ms + long_press_seconds * 1000UL);
+    CHECK_EQ(alarm_clock->alarm_state_, AlarmClock::kAlarmHeld);
+    Advance(press_ms + long_press_seconds * 1000UL + 1);
+    FinishGoodMorning(press_ms + long_press_seconds * 1000UL + 1);
+  }
+}
+
+// the hold ends the alarm only once button events reported it as a long press
+static void TestHoldNeedsLongPress() {
+  alarm_clock->alarm_long_press_seconds_ = 5;
+  StartAndPress(300000, 301000);
+  Advance(306001, ButtonEvents::kRepeat);
+  Advance(310000);
+  CHECK_EQ(alarm_clock->alarm_state_, AlarmClock::kAlarmHeld);
+  Advance(310001, ButtonEvents::kLongPress);
+  FinishGoodMorning(310001);
+
+  // a button held since before the alarm gives only repeats: it keeps ringing
+  alarm_clock->StartAlarm(400000);
+  Advance(400100, ButtonEvents::kRepeat, ButtonEvents::kIncButtonBit);
+  Advance(400200, ButtonEvents::kRelease, ButtonEvents::kIncButtonBit);
+  CHECK_EQ(alarm_clock->alarm_state_, AlarmClock::kAlarmRinging);
+  CHECK(BuzzerOn());
+
+  // held with inc and dec: held until both are released, other button's long press counts too
+  Advance(401000, ButtonEvents::kChord, ButtonEvents::kIncButtonBit | ButtonEvents::kDecButtonBit);
+  CHECK_EQ(alarm_clock->alarm_state_, AlarmClock::kAlarmHeld);
+  Advance(401500, ButtonEvents::kRelease, ButtonEvents::kIncButtonBit);
+  CHECK_EQ(alarm_clock->alarm_state_, AlarmClock::kAlarmHeld);
+  Advance(402000, ButtonEvents::kLongPress, ButtonEvents::kDecButtonBit);
+  Advance(404000, ButtonEvents::kRelease, ButtonEvents::kDecButtonBit);
+  CHECK_EQ(alarm_clock->alarm_state_, AlarmClock::kAlarmReleased);
+  Advance(404001);
+  CHECK_EQ(alarm_clock->alarm_state_, AlarmClock::kAlarmRinging);
+  // new hold needs its own long press
+  Advance(404100, ButtonEvents::kPress);
+  Advance(409101);
+  CHECK_EQ(alarm_clock->alarm_state_, AlarmClock::kAlarmHeld);
+  Advance(409102, ButtonEvents::kLongPress);
+  FinishGoodMorning(409102);
+}
+
+// letting go early rings again and the hold starts over
+static void TestReleaseRestartsHold() {
+  alarm_clock->alarm_long_press_seconds_ = 5;
+  StartAndPress(5000, 6000);
+  Advance(7000, ButtonEvents::kLongPress);
+  Advance(10999);
+  Advance(11000, ButtonEvents::kRelease);
+  CHECK_EQ(alarm_clock->alarm_state_, AlarmClock::kAlarmReleased);
+  Advance(11001);
+  CHECK_EQ(alarm_clock->alarm_state_, AlarmClock::kAlarmRinging);
+  CHECK(BuzzerOn());
+  Advance(12000, ButtonEvents::kPress);
+  CHECK_EQ(alarm_clock->alarm_state_, AlarmClock::kAlarmHeld);
+  Advance(13000, ButtonEvents::kLongPress);
+  Advance(17000);
+  CHECK_EQ(alarm_clock->alarm_state_, AlarmClock::kAlarmHeld);
+  Advance(17001);
+  FinishGoodMorning(17001);
+}
+
+// nobody presses: alarm stops itself after the max on time, without the good morning screen
+static void TestMaxOnTime() {
+  const unsigned long kMaxOnMs = alarm_clock->kAlarmMaxON_TimeMs;
+  alarm_clock->StartAlarm(50000);
+  Advance(50000 + kMaxOnMs);
+  CHECK_EQ(alarm_clock->alarm_state_, AlarmClock::kAlarmRinging);
+  Advance(50000 + kMaxOnMs + 1);
+  FinishDismissed(50000 + kMaxOnMs + 2);
+
+  // a hold is not cut by the max on time, ringing after it is
+  alarm_clock->alarm_long_press_seconds_ = 25;
+  StartAndPress(50000, 50000 + kMaxOnMs - 10000);
+  Advance(50000 + kMaxOnMs - 9000, ButtonEvents::kLongPress);
+  Advance(50000 + kMaxOnMs + 5000);
+  CHECK_EQ(alarm_clock->alarm_state_, AlarmClock::kAlarmHeld);
+  Advance(50000 + kMaxOnMs + 5001, ButtonEvents::kRelease);
+  Advance(50000 + kMaxOnMs + 5002);
+  CHECK_EQ(alarm_clock->alarm_state_, AlarmClock::kAlarmRinging);
+  Advance(50000 + kMaxOnMs + 5003);
+  FinishDismissed(50000 + kMaxOnMs + 5004);
+}
+
+// SQW 1 Hz output of DS3231
+static void SqwTick(void* arg) {
+  HostDs3231Tick();
+  HostSetPin(SQW_INT_PIN, LOW);
+  HostSetPin(SQW_INT_PIN, HIGH);
+}
+
+static uint64_t longest_loop_us = 0;
+
+// both cores, one loop() and loop1() every millisecond of virtual time
+static void RunLoopMs(uint32_t ms) {
+  for (uint32_t i = 0; i < ms; i++) {
+    uint64_t step_start_us = HostMicros();
+    loop();
+    loop1();
+    uint64_t loop_us = HostMicros() - step_start_us;
+    if(loop_us > longest_loop_us)
+      longest_loop_us = loop_us;
+    if(loop_us < 1000)
+      HostAdvanceMicros(1000 - loop_us);
+  }
+}
+
+static void TestLoopKeepsRunning() {
+  // AdvanceAlarm() calls above ran without loop() feeding the watchdog
+  ResetWatchdog();
+  uint32_t watchdog_overruns = HostWatchdogOverruns();
+  alarm_clock->alarm_long_press_seconds_ = 15;
+  RunLoopMs(3000);
+  HostTakeSerialOutput();
+  HostSerialInput("t");
+  RunLoopMs(1);
+  CHECK(alarm_clock->AlarmActive());
+  CHECK(BuzzerOn());
+
+  // 10 s of ringing: seconds tick, serial console answers, second core tasks run
+  std::set<std::string> seconds_seen;
+  for (int ms = 0; ms < 10000; ms++) {
+    RunLoopMs(1);
+    seconds_seen.insert(new_display_data_.time_SS);
+    if(ms == 4000) {
+      HostTakeSerialOutput();
+      HostSerialInput("B");
+    }
+    if(ms == 4010)
+      CHECK(HostTakeSerialOutput().find("Button Press To Reaction Latency") != std::string::npos);
+    if(ms == 5000)
+      AddSecondCoreTaskIfNotThere(kUpdateTimeFromNtpServer);
+  }
+  CHECK(seconds_seen.size() >= 10);
+  CHECK_EQ(second_core_tasks.PendingCount(), 0);
+  CHECK_EQ(alarm_clock->alarm_state_, AlarmClock::kAlarmRinging);
+
+  // push button held: good morning in the first loop() after the long press time
+  HostSetPin(BUTTON_PIN, LOW);
+  uint64_t press_us = HostMicros();
+  RunLoopMs(1);
+  CHECK_EQ(alarm_clock->alarm_state_, AlarmClock::kAlarmHeld);
+  CHECK(!BuzzerOn());
+  uint64_t previous_step_us = 0, good_morning_step_us = 0;
+  for (int ms = 0; ms < 20000 && good_morning_step_us == 0; ms++) {
+    uint64_t step_us = HostMicros();
+    RunLoopMs(1);
+    if(alarm_clock->alarm_state_ == AlarmClock::kAlarmGoodMorning)
+      good_morning_step_us = step_us;
+    else
+      previous_step_us = step_us;
+  }
+  // on millis() as AdvanceAlarm() sees it
+  CHECK(good_morning_step_us / 1000 - press_us / 1000 > 15000);
+  CHECK(previous_step_us / 1000 - press_us / 1000 <= 15000);
+  HostSetPin(BUTTON_PIN, HIGH);
+
+  // good morning sun is drawn a frame per loop() pass: seconds, serial console and second core
+  // tasks keep going for its 5 s
+  seconds_seen.clear();
+  uint64_t good_morning_start_us = good_morning_step_us;
+  bool serial_asked = false;
+  while(alarm_clock->alarm_state_ == AlarmClock::kAlarmGoodMorning && HostMicros() - good_morning_start_us < 6000000) {
+    RunLoopMs(1);
+    seconds_seen.insert(new_display_data_.time_SS);
+    if(!serial_asked && HostMicros() - good_morning_start_us >= 2000000) {
+      serial_asked = true;
+      HostTakeSerialOutput();
+      HostSerialInput("B");
+      AddSecondCoreTaskIfNotThere(kUpdateTimeFromNtpServer);
+      RunLoopMs(10);
+      CHECK(HostTakeSerialOutput().find("Button Press To Reaction Latency") != std::string::npos);
+    }
+  }
+  uint64_t good_morning_ms = (HostMicros() - good_morning_start_us) / 1000;
+  CHECK(good_morning_ms >= 4990 && good_morning_ms <= 5100);
+  CHECK(seconds_seen.size() >= 5);
+  CHECK_EQ(second_core_tasks.PendingCount(), 0);
+  RunLoopMs(100);
+  CHECK(!alarm_clock->AlarmActive());
+  CHECK_EQ(current_page, kMainPage);
+
+  // virtual time between loop() passes never jumped by seconds
+  CHECK(longest_loop_us < 1000000);
+  CHECK_EQ(HostWatchdogOverruns(), watchdog_overruns);
+}
+
+int main() {
+  HostDs3231Set(0, 0, 6, 2, 3, 6, 24);
+  HostSetPin(BUTTON_PIN, HIGH);
+  HostSetPin(INC_BUTTON_PIN, HIGH);
+  HostSetPin(DEC_BUTTON_PIN, HIGH);
+  setup();
+  HostTakeSerialOutput();
+
+  TestBuzzer();
+  TestLongPressIsExact();
+  TestHoldNeedsLongPress();
+  TestReleaseRestartsHold();
+  TestMaxOnTime();
+
+  esp_timer_handle_t sqw_timer;
+  esp_timer_create_args_t sqw_timer_args = { SqwTick, NULL };
+  esp_timer_create(&sqw_timer_args, &sqw_timer);
+  esp_timer_start_periodic(sqw_timer, 1000000);
+  TestLoopKeepsRunning();
+  return CHECK_RESULT();
+}
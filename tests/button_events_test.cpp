@@ -0,0 +1,308 @@
+// ButtonEvents fed with synthetic bouncy edge traces: pins are driven at virtual times,
+// edge ISRs run from the pin changes and Update() is called every millisecond as from loop().
+// Checks debouncing, press / release / repeat / long press / chord events and their edge
+// timestamps, edge ring overflow, presses after long idle and latency stats.
+
+#include "button_events.h"
+#include "host.h"
+#include "check.h"
+#include <random>
+#include <vector>
+#include <map>
+
+typedef ButtonEvents::Event Event;
+
+const int kPins[ButtonEvents::kButtonsCount] = { BUTTON_PIN, INC_BUTTON_PIN, DEC_BUTTON_PIN };
+const uint32_t kLoopPeriodUs = 1000;
+
+static std::mt19937 random_generator(5);
+static std::multimap<uint64_t, std::pair<int, int>> trace;    // time us -> pin, level
+static std::vector<Event> events;
+
+// contact bounce: level toggles a few times within a few ms and settles on pressed or released
+// returns time bounce starts
+static uint64_t AddBouncyEdge(ButtonEvents::Button button, uint64_t time_us, bool pressed) {
+  int settled_level = (pressed ? LOW : HIGH);
+  uint64_t start_us = time_us;
+  int toggles = random_generator() % 4 * 2;    // even, so it settles where it started toggling to
+  for (int i = 0; i < toggles; i++) {
+    trace.insert({ time_us, { kPins[button], (i % 2 == 0 ? settled_level : !settled_level) } });
+    time_us += 50 + random_generator() % 1500;
+  }
+  trace.insert({ time_us, { kPins[button], settled_level } });
+  return start_us;
+}
+
+// runs trace and loop() Update() calls until end_us
+static void RunUntil(ButtonEvents &buttons, uint64_t end_us) {
+  uint64_t next_update_us = (HostMicros() / kLoopPeriodUs + 1) * kLoopPeriodUs;
+  while(HostMicros() < end_us) {
+    uint64_t next_edge_us = (trace.empty() ? UINT64_MAX : trace.begin()->first);
+    uint64_t next_us = std::min(std::min(next_edge_us, next_update_us), end_us);
+    HostAdvanceMicros(next_us - HostMicros());
+    while(!trace.empty() && trace.begin()->first <= HostMicros()) {
+      HostSetPin(trace.begin()->second.first, trace.begin()->second.second);
+      trace.erase(trace.begin());
+    }
+    if(HostMicros() >= next_update_us) {
+      buttons.Update();
+      Event event;
+      while(buttons.GetEvent(event))
+        events.push_back(event);
+      next_update_us += kLoopPeriodUs;
+    }
+  }
+}
+
+static int Count(ButtonEvents::EventType type, uint8_t buttons) {
+  int count = 0;
+  for (const Event &event : events)
+    if(event.type == type && event.buttons == buttons)
+      count++;
+  return count;
+}
+
+static const Event* Find(ButtonEvents::EventType type, uint8_t buttons) {
+  for (const Event &event : events)
+    if(event.type == type && event.buttons == buttons)
+      return &event;
+  return NULL;
+}
+
+static void TestPushButtonPressHoldRelease(ButtonEvents &buttons) {
+  events.clear();
+  uint64_t t = HostMicros() + 10000;
+  uint64_t press_us = AddBouncyEdge(ButtonEvents::kPushButton, t, true);
+  uint64_t release_us = AddBouncyEdge(ButtonEvents::kPushButton, t + 500000, false);
+  RunUntil(buttons, t + 300000);
+  CHECK(buttons.Pressed(ButtonEvents::kPushButton));
+  CHECK(buttons.AnyPressed());
+  RunUntil(buttons, t + 700000);
+  CHECK(!buttons.AnyPressed());
+
+  CHECK_EQ(Count(ButtonEvents::kPress, ButtonEvents::kPushButtonBit), 1);
+  CHECK_EQ(Count(ButtonEvents::kRelease, ButtonEvents::kPushButtonBit), 1);
+  // held 500 ms: repeats at 200 and 400 ms
+  CHECK_EQ(Count(ButtonEvents::kRepeat, ButtonEvents::kPushButtonBit), 2);
+  CHECK_EQ((int)events.size(), 4);
+  // first edge of bounce is press time, push button press is not held back
+  const Event* press = Find(ButtonEvents::kPress, ButtonEvents::kPushButtonBit);
+  CHECK(press != NULL && press->edge_time_us == (uint32_t)press_us);
+  CHECK(events[0].type == ButtonEvents::kPress);
+  const Event* release = Find(ButtonEvents::kRelease, ButtonEvents::kPushButtonBit);
+  CHECK(release != NULL && release->edge_time_us == (uint32_t)release_us);
+}
+
+static void TestIncTapAndHold(ButtonEvents &buttons) {
+  // tap shorter than chord window is a press when released
+  events.clear();
+  uint64_t t = HostMicros() + 10000;
+  uint64_t press_us = AddBouncyEdge(ButtonEvents::kIncButton, t, true);
+  AddBouncyEdge(ButtonEvents::kIncButton, t + 60000, false);
+  RunUntil(buttons, t + 200000);
+  CHECK_EQ((int)events.size(), 2);
+  const Event* press = Find(ButtonEvents::kPress, ButtonEvents::kIncButtonBit);
+  CHECK(press != NULL && press->edge_time_us == (uint32_t)press_us);
+  CHECK_EQ(Count(ButtonEvents::kRelease, ButtonEvents::kIncButtonBit), 1);
+
+  // held: press once chord window passed, then repeats
+  events.clear();
+  t = HostMicros() + 10000;
+  press_us = AddBouncyEdge(ButtonEvents::kDecButton, t, true);
+  RunUntil(buttons, t + 90000);
+  CHECK(events.empty());
+  RunUntil(buttons, t + 120000);
+  press = Find(ButtonEvents::kPress, ButtonEvents::kDecButtonBit);
+  CHECK(press != NULL && press->edge_time_us == (uint32_t)press_us);
+  AddBouncyEdge(ButtonEvents::kDecButton, t + 500000, false);
+  RunUntil(buttons, t + 700000);
+  CHECK_EQ(Count(ButtonEvents::kPress, ButtonEvents::kDecButtonBit), 1);
+  CHECK_EQ(Count(ButtonEvents::kRepeat, ButtonEvents::kDecButtonBit), 2);
+  CHECK_EQ(Count(ButtonEvents::kRelease, ButtonEvents::kDecButtonBit), 1);
+}
+
+static void TestChord(ButtonEvents &buttons) {
+  // inc and dec within chord window: one chord, no press or repeat
+  events.clear();
+  uint64_t t = HostMicros() + 10000;
+  AddBouncyEdge(ButtonEvents::kIncButton, t, true);
+  uint64_t second_press_us = AddBouncyEdge(ButtonEvents::kDecButton, t + 40000, true);
+  AddBouncyEdge(ButtonEvents::kIncButton, t + 600000, false);
+  AddBouncyEdge(ButtonEvents::kDecButton, t + 620000, false);
+  RunUntil(buttons, t + 800000);
+  CHECK_EQ(Count(ButtonEvents::kChord, ButtonEvents::kIncButtonBit | ButtonEvents::kDecButtonBit), 1);
+  const Event* chord = Find(ButtonEvents::kChord, ButtonEvents::kIncButtonBit | ButtonEvents::kDecButtonBit);
+  CHECK(chord != NULL && chord->edge_time_us == (uint32_t)second_press_us);
+  CHECK_EQ(Count(ButtonEvents::kPress, ButtonEvents::kIncButtonBit) + Count(ButtonEvents::kPress, ButtonEvents::kDecButtonBit), 0);
+  CHECK_EQ(Count(ButtonEvents::kRepeat, ButtonEvents::kIncButtonBit) + Count(ButtonEvents::kRepeat, ButtonEvents::kDecButtonBit), 0);
+  CHECK_EQ(Count(ButtonEvents::kRelease, ButtonEvents::kIncButtonBit), 1);
+  CHECK_EQ(Count(ButtonEvents::kRelease, ButtonEvents::kDecButtonBit), 1);
+
+  // further apart than chord window: two presses
+  events.clear();
+  t = HostMicros() + 10000;
+  AddBouncyEdge(ButtonEvents::kIncButton, t, true);
+  AddBouncyEdge(ButtonEvents::kDecButton, t + 150000, true);
+  AddBouncyEdge(ButtonEvents::kIncButton, t + 180000, false);
+  AddBouncyEdge(ButtonEvents::kDecButton, t + 190000, false);
+  RunUntil(buttons, t + 400000);
+  CHECK_EQ(Count(ButtonEvents::kChord, ButtonEvents::kIncButtonBit | ButtonEvents::kDecButtonBit), 0);
+  CHECK_EQ(Count(ButtonEvents::kPress, ButtonEvents::kIncButtonBit), 1);
+  CHECK_EQ(Count(ButtonEvents::kPress, ButtonEvents::kDecButtonBit), 1);
+}
+
+// long press once per hold, at kLongPressMs after the first edge of the press bounce
+static void TestLongPress(ButtonEvents &buttons) {
+  // held 1.5 s with bounce on press and release
+  events.clear();
+  uint64_t t = HostMicros() + 10000;
+  uint64_t press_us = AddBouncyEdge(ButtonEvents::kPushButton, t, true);
+  AddBouncyEdge(ButtonEvents::kPushButton, t + 1500000, false);
+  RunUntil(buttons, t + 999000);
+  CHECK_EQ(Count(ButtonEvents::kLongPress, ButtonEvents::kPushButtonBit), 0);
+  RunUntil(buttons, t + 1800000);
+  CHECK_EQ(Count(ButtonEvents::kLongPress, ButtonEvents::kPushButtonBit), 1);
+  const Event* long_press = Find(ButtonEvents::kLongPress, ButtonEvents::kPushButtonBit);
+  CHECK(long_press != NULL && long_press->edge_time_us == (uint32_t)(press_us + 1000000));
+  // still repeats every 200 ms around it, after the press and before the release
+  CHECK_EQ(Count(ButtonEvents::kRepeat, ButtonEvents::kPushButtonBit), 7);
+  CHECK(events.front().type == ButtonEvents::kPress && events.back().type == ButtonEvents::kRelease);
+
+  // held just under kLongPressMs: none
+  events.clear();
+  t = HostMicros() + 10000;
+  AddBouncyEdge(ButtonEvents::kDecButton, t, true);
+  AddBouncyEdge(ButtonEvents::kDecButton, t + 990000, false);
+  RunUntil(buttons, t + 1500000);
+  CHECK_EQ(Count(ButtonEvents::kLongPress, ButtonEvents::kDecButtonBit), 0);
+  CHECK_EQ(Count(ButtonEvents::kRelease, ButtonEvents::kDecButtonBit), 1);
+
+  // pressed again: a new hold gives a new long press, 4 s hold gives only one
+  events.clear();
+  t = HostMicros() + 10000;
+  press_us = AddBouncyEdge(ButtonEvents::kDecButton, t, true);
+  AddBouncyEdge(ButtonEvents::kDecButton, t + 4000000, false);
+  RunUntil(buttons, t + 4500000);
+  CHECK_EQ(Count(ButtonEvents::kLongPress, ButtonEvents::kDecButtonBit), 1);
+  long_press = Find(ButtonEvents::kLongPress, ButtonEvents::kDecButtonBit);
+  CHECK(long_press != NULL && long_press->edge_time_us == (uint32_t)(press_us + 1000000));
+
+  // chord held: no repeats, but each button's long press
+  events.clear();
+  t = HostMicros() + 10000;
+  uint64_t inc_press_us = AddBouncyEdge(ButtonEvents::kIncButton, t, true);
+  uint64_t dec_press_us = AddBouncyEdge(ButtonEvents::kDecButton, t + 30000, true);
+  AddBouncyEdge(ButtonEvents::kIncButton, t + 1200000, false);
+  AddBouncyEdge(ButtonEvents::kDecButton, t + 1250000, false);
+  RunUntil(buttons, t + 1500000);
+  CHECK_EQ(Count(ButtonEvents::kChord, ButtonEvents::kIncButtonBit | ButtonEvents::kDecButtonBit), 1);
+  CHECK_EQ(Count(ButtonEvents::kRepeat, ButtonEvents::kIncButtonBit) + Count(ButtonEvents::kRepeat, ButtonEvents::kDecButtonBit), 0);
+  const Event* inc_long_press = Find(ButtonEvents::kLongPress, ButtonEvents::kIncButtonBit);
+  const Event* dec_long_press = Find(ButtonEvents::kLongPress, ButtonEvents::kDecButtonBit);
+  CHECK(inc_long_press != NULL && inc_long_press->edge_time_us == (uint32_t)(inc_press_us + 1000000));
+  CHECK(dec_long_press != NULL && dec_long_press->edge_time_us == (uint32_t)(dec_press_us + 1000000));
+  CHECK_EQ((int)events.size(), 5);
+}
+
+// many random presses with random bounce: one press and one release each, in order
+static void TestRandomPresses(ButtonEvents &buttons) {
+  events.clear();
+  std::vector<std::pair<uint64_t, int>> presses;    // press start, button
+  uint64_t t = HostMicros() + 10000;
+  for (int i = 0; i < 500; i++) {
+    ButtonEvents::Button button = (ButtonEvents::Button)(random_generator() % ButtonEvents::kButtonsCount);
+    uint32_t hold_us = 30000 + random_generator() % 150000;    // taps and short holds, no repeats
+    presses.push_back({ AddBouncyEdge(button, t, true), button });
+    AddBouncyEdge(button, t + hold_us, false);
+    t += hold_us + 30000 + random_generator() % 100000;
+  }
+  RunUntil(buttons, t + 100000);
+
+  int press_count = 0, release_count = 0;
+  size_t next_press = 0;
+  for (const Event &event : events) {
+    CHECK(event.type != ButtonEvents::kChord && event.type != ButtonEvents::kRepeat && event.type != ButtonEvents::kLongPress);
+    if(event.type == ButtonEvents::kRelease)
+      release_count++;
+    if(event.type != ButtonEvents::kPress)
+      continue;
+    press_count++;
+    if(next_press < presses.size()) {
+      CHECK_EQ(event.buttons, 1 << presses[next_press].second);
+      CHECK_EQ(event.edge_time_us, (uint32_t)presses[next_press].first);
+    }
+    next_press++;
+  }
+  CHECK_EQ(press_count, (int)presses.size());
+  CHECK_EQ(release_count, (int)presses.size());
+  CHECK(!buttons.AnyPressed());
+}
+
+// loop() stalled while edges keep coming: ring overflows, state settles to pin level afterwards
+static void TestEdgeRingOverflow(ButtonEvents &buttons) {
+  events.clear();
+  HostTakeSerialOutput();
+  for (int i = 0; i < 41; i++) {
+    HostAdvanceMicros(300);
+    HostSetPin(kPins[ButtonEvents::kPushButton], (i % 2 == 0 ? LOW : HIGH));
+  }
+  // released while ring is full, last edge in ring is a press
+  HostSetPin(kPins[ButtonEvents::kPushButton], HIGH);
+  RunUntil(buttons, HostMicros() + 50000);
+  CHECK(HostTakeSerialOutput().find("edge ring overflows") != std::string::npos);
+  CHECK(!buttons.AnyPressed());
+  AddBouncyEdge(ButtonEvents::kPushButton, HostMicros() + 1000, true);
+  RunUntil(buttons, HostMicros() + 50000);
+  CHECK(buttons.Pressed(ButtonEvents::kPushButton));
+  AddBouncyEdge(ButtonEvents::kPushButton, HostMicros() + 1000, false);
+  RunUntil(buttons, HostMicros() + 50000);
+  CHECK(!buttons.AnyPressed());
+}
+
+// press long after the last one, past 2^31 us and past micros() wrap at 2^32 us
+static void TestPressAfterLongIdle(ButtonEvents &buttons) {
+  for (uint64_t idle_us : { 40 * 60 * 1000000ULL, (1ULL << 32) - HostMicros() % (1ULL << 32) + 5000 }) {
+    events.clear();
+    HostAdvanceMicros(idle_us);
+    uint64_t t = HostMicros() + 10000;
+    AddBouncyEdge(ButtonEvents::kPushButton, t, true);
+    AddBouncyEdge(ButtonEvents::kPushButton, t + 100000, false);
+    RunUntil(buttons, t + 200000);
+    CHECK_EQ(Count(ButtonEvents::kPress, ButtonEvents::kPushButtonBit), 1);
+    CHECK_EQ(Count(ButtonEvents::kRelease, ButtonEvents::kPushButtonBit), 1);
+  }
+}
+
+static void TestLatencyStats(ButtonEvents &buttons) {
+  events.clear();
+  uint64_t t = HostMicros() + 10000;
+  AddBouncyEdge(ButtonEvents::kPushButton, t, true);
+  AddBouncyEdge(ButtonEvents::kPushButton, t + 50000, false);
+  RunUntil(buttons, t + 100000);
+  const Event* press = Find(ButtonEvents::kPress, ButtonEvents::kPushButtonBit);
+  CHECK(press != NULL);
+  if(press == NULL) return;
+  HostAdvanceMicros(2500);
+  buttons.RecordReaction(*press);
+  HostTakeSerialOutput();
+  buttons.PrintLatencyStats();
+  std::string stats = HostTakeSerialOutput();
+  CHECK(stats.find("count=1 ") != std::string::npos);
+  // reaction 2.5 ms after last Update(), which was within a loop period of the edge run
+  uint32_t latency_us = micros() - press->edge_time_us;
+  CHECK(stats.find("max=" + std::to_string(latency_us) + " us") != std::string::npos);
+}
+
+int main() {
+  ButtonEvents buttons;
+  CHECK(!buttons.AnyPressed());
+  TestPushButtonPressHoldRelease(buttons);
+  TestIncTapAndHold(buttons);
+  TestChord(buttons);
+  TestLongPress(buttons);
+  TestRandomPresses(buttons);
+  TestEdgeRingOverflow(buttons);
+  TestPressAfterLongIdle(buttons);
+  TestLatencyStats(buttons);
+  return CHECK_RESULT();
+}
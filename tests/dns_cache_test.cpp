@@ -0,0 +1,367 @@
+// DnsCache wire format and cache logic against a stub DNS server on a loopback UDP socket.
+// The stub answers A queries like a recursive resolver would: a CNAME chain for the weather host,
+// several A records for the NTP pool, NXDOMAIN for others, and can be turned off or
+// answer with a wrong id or truncated. Resolution goes through the same BuildQuery() and
+// ParseResponse() the clock sends over WiFiUDP. Every stub round trip advances virtual time by
+// kStubLatencyMs, so latency saved by the cache is exact.
+
+#include "dns_cache.h"
+#include "host.h"
+#include "check.h"
+#include <arpa/inet.h>
+#include <atomic>
+#include <netinet/in.h>
+#include <random>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+static const uint32_t kStubLatencyMs = 40;
+
+static uint32_t Ip(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+  return a | (b << 8) | (c << 16) | ((uint32_t)d << 24);    // as IPAddress uint32_t
+}
+
+static std::string Name(const std::string &host) {
+  std::string name;
+  size_t start = 0;
+  while(true) {
+    size_t dot = host.find('.', start);
+    std::string label = host.substr(start, dot == std::string::npos ? std::string::npos : dot - start);
+    name += (char)label.size();
+    name += label;
+    if(dot == std::string::npos) break;
+    start = dot + 1;
+  }
+  return name + '\0';
+}
+
+static std::string Record(const std::string &name, uint16_t type, uint32_t ttl, const std::string &data) {
+  std::string record = name;
+  const uint8_t fields[10] = { (uint8_t)(type >> 8), (uint8_t)type, 0, 1, (uint8_t)(ttl >> 24), (uint8_t)(ttl >> 16), (uint8_t)(ttl >> 8), (uint8_t)ttl,
+    (uint8_t)(data.size() >> 8), (uint8_t)data.size() };
+  record.append((const char*)fields, sizeof(fields));
+  return record + data;
+}
+
+class StubDnsServer {
+
+public:
+
+  std::atomic<bool> up{true}, wrong_id{false}, truncated{false};
+  std::atomic<uint32_t> queries{0};
+  std::atomic<uint32_t> weather_ttl{300}, weather_cname_ttl{900};
+
+  uint16_t Start() {
+    socket_ = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    CHECK(bind(socket_, (sockaddr*)&address, sizeof(address)) == 0);
+    socklen_t address_length = sizeof(address);
+    getsockname(socket_, (sockaddr*)&address, &address_length);
+    thread_ = std::thread(&StubDnsServer::Serve, this);
+    return ntohs(address.sin_port);
+  }
+
+  void Stop() {
+    stop_ = true;
+    shutdown(socket_, SHUT_RDWR);
+    close(socket_);
+    thread_.join();
+  }
+
+  // response for query, as a recursive resolver would send it
+  std::string Answer(const std::string &query) {
+    size_t pos = 12;
+    std::string host;
+    while(pos < query.size() && query[pos] != 0) {
+      if(!host.empty()) host += '.';
+      host += query.substr(pos + 1, (uint8_t)query[pos]);
+      pos += 1 + (uint8_t)query[pos];
+    }
+    for (char &c : host) c = tolower(c);
+    std::string question = query.substr(12, pos + 5 - 12);
+    std::string answers;
+    uint16_t count = 0, rcode = 0;
+    const std::string kQuestionName = "\xc0\x0c";     // compression pointer to question name
+    if(host == "api.openweathermap.org") {
+      std::string cname = Name("owm.weather.example.net");
+      answers += Record(kQuestionName, 5, weather_cname_ttl, cname);
+      answers += Record(cname, 1, weather_ttl, std::string("\xc0\x00\x02\x0a", 4));
+      count = 2;
+    }
+    else if(host == "pool.ntp.org") {
+      // an AAAA record first, it is skipped
+      answers += Record(kQuestionName, 28, 130, std::string(16, '\x20'));
+      for (uint8_t i = 1; i <= 4; i++)
+        answers += Record(kQuestionName, 1, 130, std::string("\xc6\x33\x64", 3) + (char)i);
+      count = 5;
+    }
+    else if(host == "negative.ttl.example") {
+      answers += Record(kQuestionName, 1, 0x80000010, std::string("\x0a\x00\x00\x01", 4));
+      count = 1;
+    }
+    else
+      rcode = 3;    // NXDOMAIN
+    uint16_t id = ((uint8_t)query[0] << 8 | (uint8_t)query[1]) + (wrong_id ? 1 : 0);
+    uint16_t flags = 0x8180 | rcode | (truncated ? 0x0200 : 0);
+    const uint8_t header[12] = { (uint8_t)(id >> 8), (uint8_t)id, (uint8_t)(flags >> 8), (uint8_t)flags, 0, 1, 0, (uint8_t)count, 0, 0, 0, 0 };
+    return std::string((const char*)header, sizeof(header)) + question + answers;
+  }
+
+private:
+
+  int socket_ = -1;
+  std::atomic<bool> stop_{false};
+  std::thread thread_;
+
+  void Serve() {
+    char buffer[512];
+    while(!stop_) {
+      sockaddr_in from;
+      socklen_t from_length = sizeof(from);
+      ssize_t received = recvfrom(socket_, buffer, sizeof(buffer), 0, (sockaddr*)&from, &from_length);
+      if(received < 12) continue;
+      queries++;
+      if(!up) continue;
+      std::string response = Answer(std::string(buffer, received));
+      sendto(socket_, response.data(), response.size(), 0, (sockaddr*)&from, from_length);
+    }
+  }
+
+};
+
+static StubDnsServer server;
+static uint16_t server_port;
+static uint32_t resolver_calls = 0;
+
+// like WiFiStuff::ResolveOverUdp(), one attempt with a short timeout
+static bool UdpResolve(const char* host, uint32_t &ip, uint32_t &ttl_seconds) {
+  resolver_calls++;
+  HostAdvanceMillis(kStubLatencyMs);
+  uint8_t packet[384];
+  uint16_t id = random(1, 65536);
+  size_t query_length = DnsCache::BuildQuery(packet, sizeof(packet), id, host);
+  if(query_length == 0) return false;
+  int udp = socket(AF_INET, SOCK_DGRAM, 0);
+  sockaddr_in to = {};
+  to.sin_family = AF_INET;
+  to.sin_port = htons(server_port);
+  to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  timeval timeout = { 0, 200 * 1000 };
+  setsockopt(udp, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  sendto(udp, packet, query_length, 0, (sockaddr*)&to, sizeof(to));
+  ssize_t received = recv(udp, packet, sizeof(packet), 0);
+  close(udp);
+  return received > 0 && DnsCache::ParseResponse(packet, received, id, host, ip, ttl_seconds);
+}
+
+static void TestBuildQuery() {
+  uint8_t buffer[300];
+  size_t length = DnsCache::BuildQuery(buffer, sizeof(buffer), 0x1234, "pool.ntp.org");
+  const std::string expected = std::string("\x12\x34\x01\x00\x00\x01\x00\x00\x00\x00\x00\x00", 12) + Name("pool.ntp.org") + std::string("\x00\x01\x00\x01", 4);
+  CHECK_EQ(length, expected.size());
+  CHECK(memcmp(buffer, expected.data(), expected.size()) == 0);
+
+  // not valid names, or no room
+  CHECK_EQ(DnsCache::BuildQuery(buffer, sizeof(buffer), 1, ""), 0);
+  CHECK_EQ(DnsCache::BuildQuery(buffer, sizeof(buffer), 1, "a..b"), 0);
+  CHECK_EQ(DnsCache::BuildQuery(buffer, sizeof(buffer), 1, ".ntp.org"), 0);
+  CHECK_EQ(DnsCache::BuildQuery(buffer, sizeof(buffer), 1, "pool.ntp.org."), 0);
+  CHECK_EQ(DnsCache::BuildQuery(buffer, sizeof(buffer), 1, (std::string(64, 'a') + ".org").c_str()), 0);
+  CHECK(DnsCache::BuildQuery(buffer, sizeof(buffer), 1, (std::string(63, 'a') + ".org").c_str()) > 0);
+  std::string long_name;
+  while(long_name.size() < 254) long_name += "abcdefghi.";
+  long_name.resize(254);
+  CHECK_EQ(DnsCache::BuildQuery(buffer, sizeof(buffer), 1, long_name.c_str()), 0);
+  CHECK_EQ(DnsCache::BuildQuery(buffer, expected.size() - 1, 1, "pool.ntp.org"), 0);
+  CHECK_EQ(DnsCache::BuildQuery(buffer, expected.size(), 1, "pool.ntp.org"), expected.size());
+}
+
+static void TestParseResponse() {
+  uint32_t ip = 0, ttl = 0;
+  // CNAME chain: lowest TTL on the way
+  CHECK(UdpResolve("api.openweathermap.org", ip, ttl));
+  CHECK_EQ(ip, Ip(192, 0, 2, 10));
+  CHECK_EQ(ttl, 300);
+  server.weather_ttl = 2000;
+  CHECK(UdpResolve("api.openweathermap.org", ip, ttl));
+  CHECK_EQ(ttl, 900);
+  server.weather_ttl = 300;
+  // first A record, AAAA before it skipped, question name case ignored
+  CHECK(UdpResolve("POOL.ntp.org", ip, ttl));
+  CHECK_EQ(ip, Ip(198, 51, 100, 1));
+  CHECK_EQ(ttl, 130);
+  // TTL with top bit set is 0
+  CHECK(UdpResolve("negative.ttl.example", ip, ttl));
+  CHECK_EQ(ttl, 0);
+  CHECK(!UdpResolve("nx.example", ip, ttl));
+  server.wrong_id = true;
+  CHECK(!UdpResolve("pool.ntp.org", ip, ttl));
+  server.wrong_id = false;
+  server.truncated = true;
+  CHECK(!UdpResolve("pool.ntp.org", ip, ttl));
+  server.truncated = false;
+
+  // response to another name, or not a response
+  uint8_t query[300];
+  size_t query_length = DnsCache::BuildQuery(query, sizeof(query), 7, "pool.ntp.org");
+  std::string response = server.Answer(std::string((const char*)query, query_length));
+  CHECK(DnsCache::ParseResponse((const uint8_t*)response.data(), response.size(), 7, "pool.ntp.org", ip, ttl));
+  CHECK(!DnsCache::ParseResponse((const uint8_t*)response.data(), response.size(), 7, "pool.ntp.or", ip, ttl));
+  CHECK(!DnsCache::ParseResponse((const uint8_t*)response.data(), response.size(), 7, "pool.ntp.org.uk", ip, ttl));
+  CHECK(!DnsCache::ParseResponse((const uint8_t*)response.data(), response.size(), 7, "ool.ntp.org", ip, ttl));
+  CHECK(!DnsCache::ParseResponse(query, query_length, 7, "pool.ntp.org", ip, ttl));
+
+  // every cut short response fails, up to the first A record's data
+  size_t first_a_end = response.find(std::string("\xc6\x33\x64\x01", 4)) + 4;
+  for (size_t length = 0; length < first_a_end; length++)
+    CHECK(!DnsCache::ParseResponse((const uint8_t*)response.data(), length, 7, "pool.ntp.org", ip, ttl));
+
+  // random corruption stays within buffer (ASan)
+  std::mt19937 random_generator(50);
+  for (const char* host : { "pool.ntp.org", "api.openweathermap.org" }) {
+    query_length = DnsCache::BuildQuery(query, sizeof(query), 7, host);
+    response = server.Answer(std::string((const char*)query, query_length));
+    for (int i = 0; i < 50000; i++) {
+      std::vector<uint8_t> corrupted(response.begin(), response.end());
+      for (int changes = 1 + random_generator() % 4; changes > 0; changes--)
+        corrupted[random_generator() % corrupted.size()] = random_generator();
+      corrupted.resize(random_generator() % 4 == 0 ? random_generator() % corrupted.size() : corrupted.size());
+      // exact size heap copy, so any read past it is caught
+      uint8_t* exact = new uint8_t[corrupted.size() + 1];
+      memcpy(exact, corrupted.data(), corrupted.size());
+      DnsCache::ParseResponse(exact, corrupted.size(), 7, host, ip, ttl);
+      delete[] exact;
+    }
+  }
+}
+
+static void TestCache() {
+  DnsCache cache(UdpResolve);
+  const char* kWeather = "api.openweathermap.org";
+  const char* kNtp = "pool.ntp.org";
+  uint32_t now = 30000000, ip = 0;
+  resolver_calls = 0;
+
+  // clock not set: resolved, not cached
+  CHECK_EQ(cache.Resolve(kNtp, 0, ip), DnsCache::kLive);
+  CHECK_EQ(cache.Resolve(kNtp, 0, ip), DnsCache::kLive);
+  CHECK_EQ(resolver_calls, 2);
+  CHECK(!cache.entries_changed_);
+
+  // sessions: a weather fetch every 2 minutes and an NTP sync every 6, radio on only for those
+  uint32_t expected_hits = 0, expected_lookups = 0;
+  for (int session = 0; session < 36; session++) {
+    cache.StartSession();
+    uint32_t resolver_calls_before = resolver_calls;
+    CHECK(cache.Resolve(kWeather, now, ip) != DnsCache::kFailed);
+    CHECK_EQ(ip, Ip(192, 0, 2, 10));
+    if(session % 3 == 0) {
+      CHECK(cache.Resolve(kNtp, now, ip) != DnsCache::kFailed);
+      CHECK_EQ(ip, Ip(198, 51, 100, 1));
+    }
+    uint32_t lookups = resolver_calls - resolver_calls_before;
+    uint32_t hits = 1 + (session % 3 == 0) - lookups;
+    CHECK_EQ(cache.session_lookups_, lookups);
+    CHECK_EQ(cache.session_hits_, hits);
+    CHECK_EQ(cache.session_saved_ms_, hits * kStubLatencyMs);
+    expected_hits += hits;
+    expected_lookups += lookups;
+    cache.PrintSession();
+    now += 120;
+  }
+  // weather TTL 300 s: 2 of 3 fetches are hits, NTP TTL 130 s: every sync 6 minutes apart is live
+  CHECK_EQ(expected_hits, 24);
+  CHECK_EQ(cache.hits_, expected_hits);
+  CHECK_EQ(cache.saved_ms_, expected_hits * kStubLatencyMs);
+  CHECK(cache.entries_changed_);
+
+  // within TTL: hits, no query sent
+  server.weather_ttl = 3600;
+  server.weather_cname_ttl = 3600;
+  now += 10000;
+  CHECK_EQ(cache.Resolve(kWeather, now, ip), DnsCache::kLive);
+  uint32_t queries_before = server.queries;
+  cache.StartSession();
+  for (int i = 1; i <= 5; i++)
+    CHECK_EQ(cache.Resolve(kWeather, now + i * 600, ip), DnsCache::kHit);
+  CHECK_EQ(server.queries, queries_before);
+  CHECK_EQ(cache.session_saved_ms_, 5 * kStubLatencyMs);
+  // expired: live again
+  CHECK_EQ(cache.Resolve(kWeather, now + 3600, ip), DnsCache::kLive);
+  now += 3600;
+
+  // resolver down: expired entry is used for up to kStaleMaxSeconds after it expired
+  server.up = false;
+  CHECK_EQ(cache.Resolve(kWeather, now + 1000, ip), DnsCache::kHit);
+  CHECK_EQ(cache.Resolve(kWeather, now + 3600, ip), DnsCache::kStale);
+  CHECK_EQ(ip, Ip(192, 0, 2, 10));
+  CHECK_EQ(cache.Resolve(kWeather, now + 3600 + DnsCache::kStaleMaxSeconds - 1, ip), DnsCache::kStale);
+  CHECK_EQ(cache.Resolve(kWeather, now + 3600 + DnsCache::kStaleMaxSeconds, ip), DnsCache::kFailed);
+  CHECK_EQ(cache.Resolve("nx.example", now, ip), DnsCache::kFailed);
+  // an address that did not answer is not used stale
+  cache.Invalidate(kWeather);
+  CHECK_EQ(cache.Resolve(kWeather, now + 3600, ip), DnsCache::kFailed);
+  server.up = true;
+  CHECK_EQ(cache.Resolve(kWeather, now + 3600, ip), DnsCache::kLive);
+  now += 3600;
+  CHECK_EQ(cache.Resolve(kWeather, now + 1, ip), DnsCache::kHit);
+  cache.Invalidate(kWeather);
+  CHECK_EQ(cache.Resolve(kWeather, now + 2, ip), DnsCache::kLive);
+
+  // TTL 0 and huge TTLs
+  CHECK_EQ(cache.Resolve("negative.ttl.example", now, ip), DnsCache::kLive);
+  CHECK_EQ(cache.Resolve("negative.ttl.example", now, ip), DnsCache::kLive);
+  server.weather_ttl = 7 * 24 * 3600;
+  server.weather_cname_ttl = 7 * 24 * 3600;
+  CHECK_EQ(cache.Resolve(kWeather, now + 3600 * 2, ip), DnsCache::kLive);
+  CHECK_EQ(cache.Resolve(kWeather, now + 3600 * 2 + DnsCache::kTtlMaxSeconds - 1, ip), DnsCache::kHit);
+  CHECK_EQ(cache.Resolve(kWeather, now + 3600 * 2 + DnsCache::kTtlMaxSeconds, ip), DnsCache::kLive);
+  server.weather_ttl = 300;
+  server.weather_cname_ttl = 900;
+
+  // host names too long for an entry are resolved, not cached
+  std::string long_host = std::string(sizeof(DnsCacheRecord::host), 'a') + ".org";
+  cache.Resolve(long_host.c_str(), now, ip);
+  for (uint8_t i = 0; i < DnsCache::kEntries; i++)
+    CHECK(strlen(cache.entries_[i].host) < sizeof(cache.entries_[i].host));
+}
+
+// more hosts than entries: the entry expiring first makes room
+static void TestEviction() {
+  std::vector<std::pair<std::string, uint32_t>> hosts = { { "a", 100 }, { "b", 400 }, { "c", 200 }, { "d", 300 }, { "e", 500 } };
+  static std::vector<std::pair<std::string, uint32_t>>* host_ttls = &hosts;
+  DnsCache cache([](const char* host, uint32_t &ip, uint32_t &ttl_seconds) {
+    for (auto &host_ttl : *host_ttls)
+      if(host_ttl.first == host) {
+        ip = host[0];
+        ttl_seconds = host_ttl.second;
+        return true;
+      }
+    return false;
+  });
+  uint32_t now = 1000, ip;
+  for (auto &host_ttl : hosts)
+    CHECK_EQ(cache.Resolve(host_ttl.first.c_str(), now, ip), DnsCache::kLive);
+  // "a" expired first and was replaced by "e"
+  CHECK_EQ(cache.Resolve("e", now + 1, ip), DnsCache::kHit);
+  CHECK_EQ(cache.Resolve("b", now + 1, ip), DnsCache::kHit);
+  CHECK_EQ(cache.Resolve("c", now + 1, ip), DnsCache::kHit);
+  CHECK_EQ(cache.Resolve("d", now + 1, ip), DnsCache::kHit);
+  CHECK_EQ(cache.Resolve("a", now + 1, ip), DnsCache::kLive);
+  CHECK_EQ(cache.Resolve("c", now + 2, ip), DnsCache::kLive);
+}
+
+int main() {
+  server_port = server.Start();
+  TestBuildQuery();
+  TestParseResponse();
+  TestCache();
+  TestEviction();
+  server.Stop();
+  return CHECK_RESULT();
+}
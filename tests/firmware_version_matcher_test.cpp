@@ -0,0 +1,316 @@
+// FirmwareVersionMatcher on the files the clock really fetches: configuration.h with all board
+// defines side by side and the build/<board>/version.txt manifests, fed split at every byte and in
+// small chunks, plus near misses (longer names, uses of the define, KMP overlaps) and overlong
+// versions. Both files are then served by a local HTTP server on a loopback socket and read as
+// WiFiStuff::FirmwareVersionCheck() does: header first, body in 128 byte reads until Done(). The
+// check reports body bytes read, heap allocated and duration for each mode.
+
+#include "firmware_version_matcher.h"
+#include "check.h"
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <netinet/in.h>
+#include <new>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// heap allocated by the thread that counts
+static thread_local bool count_heap = false;
+static thread_local size_t heap_bytes = 0;
+
+void* operator new(size_t size) {
+  if(count_heap) heap_bytes += size;
+  void* memory = malloc(size > 0 ? size : 1);
+  if(memory == NULL) throw std::bad_alloc();
+  return memory;
+}
+void operator delete(void* memory) noexcept { free(memory); }
+void operator delete(void* memory, size_t size) noexcept { free(memory); }
+
+struct Board {
+  const char* search_str;
+  const char* build_dir;
+  const char* version;
+};
+static const Board kBoards[] = {
+  { "ESP32_S2_MINI_FIRMWARE_VERSION", "esp32.esp32.lolin_s2_mini", "2.4" },
+  { "ESP32_WROOM_DA_MODULE_FIRMWARE_VERSION", "esp32.esp32.esp32da", "2.4" },
+  { "ESP32_S3_FIRMWARE_VERSION", "esp32.esp32.esp32s3", "2.4" },
+  { "RASPBERRY_PI_PICO_W_FIRMWARE_VERSION", NULL, "1.5" },
+};
+
+static std::string ReadFile(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  CHECK(file.good());
+  return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// version found in text fed in chunks of chunk_size, "" if none
+static std::string Match(const char* search_str, const std::string &text, size_t chunk_size) {
+  FirmwareVersionMatcher matcher;
+  CHECK(matcher.Reset(search_str));
+  for (size_t offset = 0; offset < text.size() && !matcher.Done(); offset += chunk_size)
+    matcher.Feed((const uint8_t*)text.data() + offset, std::min(chunk_size, text.size() - offset));
+  return (matcher.Done() ? matcher.version : "");
+}
+
+// same version for text split in two at every byte boundary and in chunks of 1 to 19 bytes
+static void CheckEverySplit(const char* search_str, const std::string &text, const std::string &expected_version) {
+  uint32_t wrong = 0;
+  for (size_t split = 0; split <= text.size(); split++) {
+    FirmwareVersionMatcher matcher;
+    CHECK(matcher.Reset(search_str));
+    matcher.Feed((const uint8_t*)text.data(), split);
+    matcher.Feed((const uint8_t*)text.data() + split, text.size() - split);
+    std::string version = (matcher.Done() ? matcher.version : "");
+    if(version != expected_version) wrong++;
+  }
+  CHECK_EQ(wrong, 0);
+  for (size_t chunk_size = 1; chunk_size < 20; chunk_size++)
+    CHECK_STR(Match(search_str, text, chunk_size), expected_version);
+}
+
+static void TestConfigurationAndManifests() {
+  std::string configuration = ReadFile("../configuration.h");
+  for (const Board &board : kBoards) {
+    CheckEverySplit(board.search_str, configuration, board.version);
+    if(board.build_dir != NULL)
+      CheckEverySplit(board.search_str, ReadFile(std::string("../build/") + board.build_dir + "/version.txt"), board.version);
+  }
+}
+
+// all boards of configuration.h with their own version, after common.h that names every define
+// in a use and in a search string
+static void TestDefinesSideBySide() {
+  std::string configuration = ReadFile("../configuration.h");
+  const char* kVersions[] = { "2.41", "2.42", "2.43", "1.51" };
+  for (int i = 0; i < 4; i++) {
+    size_t name = configuration.find(std::string("#define ") + kBoards[i].search_str);
+    CHECK(name != std::string::npos);
+    size_t quote = configuration.find('"', name);
+    size_t end_quote = configuration.find('"', quote + 1);
+    configuration.replace(quote + 1, end_quote - quote - 1, kVersions[i]);
+  }
+  std::string text = ReadFile("../common.h") + configuration;
+  for (int i = 0; i < 4; i++)
+    CheckEverySplit(kBoards[i].search_str, text, kVersions[i]);
+}
+
+static void TestNearMisses() {
+  // KMP: a partial match that restarts inside itself
+  CheckEverySplit("ESP32_S2_MINI_FIRMWARE_VERSION", "#define ESP32_S2_MINI_FIRMWARE_ESP32_S2_MINI_FIRMWARE_VERSION \"3.1\"\n", "3.1");
+  CheckEverySplit("ABAB", "#define ABABAB \"7\"", "7");
+  // longer names, uses of the define and the name in a string are not the define
+  CheckEverySplit("ESP32_S3_FIRMWARE_VERSION", "#define ESP32_S3_FIRMWARE_VERSION_OLD \"1.0\"\n#define ESP32_S3_FIRMWARE_VERSION \"3.2\"\n", "3.2");
+  CheckEverySplit("ESP32_S3_FIRMWARE_VERSION", "v = ESP32_S3_FIRMWARE_VERSION; s = \"ESP32_S3_FIRMWARE_VERSION\";\n#define ESP32_S3_FIRMWARE_VERSION\t \"3.3\"", "3.3");
+  CheckEverySplit("ESP32_S3_FIRMWARE_VERSION", "#define ESP32_S3_FIRMWARE_VERSION x \"1.0\"", "");
+  CheckEverySplit("ABAB", "ABAB A \"1\"", "");
+  CheckEverySplit("ESP32_S3_FIRMWARE_VERSION", "#define ESP32_S3_FIRMWARE_VERSION", "");
+}
+
+static void TestOverlongVersion() {
+  // version holds 15 characters
+  CheckEverySplit("ESP32_S3_FIRMWARE_VERSION", "#define ESP32_S3_FIRMWARE_VERSION \"123456789012345\"", "123456789012345");
+  CheckEverySplit("ESP32_S3_FIRMWARE_VERSION", "#define ESP32_S3_FIRMWARE_VERSION \"1234567890123456\"", "");
+  CheckEverySplit("ESP32_S3_FIRMWARE_VERSION", "#define ESP32_S3_FIRMWARE_VERSION \"1234567890123456789012345678901234567890\"\n"
+    "#define ESP32_S3_FIRMWARE_VERSION \"2.5\"\n", "2.5");
+}
+
+static void TestReset() {
+  FirmwareVersionMatcher matcher;
+  CHECK(!matcher.Reset(""));
+  CHECK(!matcher.Reset(std::string(FirmwareVersionMatcher::kMaxSearchLength + 1, 'A').c_str()));
+  CHECK(matcher.Reset(std::string(FirmwareVersionMatcher::kMaxSearchLength, 'A').c_str()));
+  // a finished matcher starts over
+  CHECK(matcher.Reset("ESP32_S3_FIRMWARE_VERSION"));
+  CHECK(matcher.Feed((const uint8_t*)"#define ESP32_S3_FIRMWARE_VERSION \"2.4\"", 39));
+  CHECK(matcher.Reset("ESP32_S3_FIRMWARE_VERSION"));
+  CHECK(!matcher.Done());
+  CHECK_STR(matcher.version, "");
+}
+
+// HTTP/1.0 server of files by path, body in 512 byte writes as TLS records would come
+class FileServer {
+
+public:
+
+  std::vector<std::pair<std::string, std::string>> files;    // path, content
+
+  uint16_t Start() {
+    listen_socket_ = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    CHECK(bind(listen_socket_, (sockaddr*)&address, sizeof(address)) == 0);
+    CHECK(listen(listen_socket_, 4) == 0);
+    socklen_t address_length = sizeof(address);
+    getsockname(listen_socket_, (sockaddr*)&address, &address_length);
+    thread_ = std::thread(&FileServer::Serve, this);
+    return ntohs(address.sin_port);
+  }
+
+  void Stop() {
+    stop_ = true;
+    shutdown(listen_socket_, SHUT_RDWR);
+    close(listen_socket_);
+    thread_.join();
+  }
+
+private:
+
+  int listen_socket_ = -1;
+  std::atomic<bool> stop_{false};
+  std::thread thread_;
+
+  void Serve() {
+    while(!stop_) {
+      int connection = accept(listen_socket_, NULL, NULL);
+      if(connection < 0) continue;
+      Respond(connection);
+      close(connection);
+    }
+  }
+
+  void Respond(int connection) {
+    std::string request;
+    char buffer[512];
+    while(request.find("\r\n\r\n") == std::string::npos) {
+      ssize_t received = recv(connection, buffer, sizeof(buffer), 0);
+      if(received <= 0) return;
+      request.append(buffer, received);
+    }
+    const std::string* body = NULL;
+    for (const auto &file : files)
+      if(request.find("GET " + file.first + " ") == 0)
+        body = &file.second;
+    if(body == NULL) {
+      const char* kNotFound = "HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+      send(connection, kNotFound, strlen(kNotFound), MSG_NOSIGNAL);
+      return;
+    }
+    std::string header = "HTTP/1.0 200 OK\r\nContent-Length: " + std::to_string(body->size()) + "\r\n\r\n";
+    if(send(connection, header.data(), header.size(), MSG_NOSIGNAL) <= 0) return;
+    for (size_t offset = 0; offset < body->size(); offset += 512)
+      if(send(connection, body->data() + offset, std::min((size_t)512, body->size() - offset), MSG_NOSIGNAL) <= 0)
+        return;
+  }
+
+};
+
+struct CheckMetrics {
+  std::string version;
+  uint32_t body_bytes_read = 0;
+  size_t heap_bytes = 0, body_loop_heap_bytes = 0;
+  double duration_ms = 0;
+};
+
+// firmware version check as in WiFiStuff::FirmwareVersionCheck(): status line and headers are read
+// line by line, then the body in reads of up to 128 bytes until the version literal is parsed
+static CheckMetrics CheckVersion(uint16_t port, const std::string &path, const char* search_str) {
+  CheckMetrics metrics;
+  auto start = std::chrono::steady_clock::now();
+  count_heap = true;
+  heap_bytes = 0;
+
+  FirmwareVersionMatcher matcher;
+  matcher.Reset(search_str);
+  int connection = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(port);
+  CHECK(connect(connection, (sockaddr*)&address, sizeof(address)) == 0);
+  std::string request = "GET " + path + " HTTP/1.0\r\n\r\n";
+  send(connection, request.data(), request.size(), MSG_NOSIGNAL);
+
+  std::string line, status_line;
+  int remaining_bytes = -1;
+  char c;
+  while(recv(connection, &c, 1, 0) == 1) {
+    if(c != '\n') {
+      line += c;
+      continue;
+    }
+    if(status_line.empty())
+      status_line = line;
+    else if(line.find("Content-Length: ") == 0)
+      remaining_bytes = atoi(line.c_str() + strlen("Content-Length: "));
+    else if(line == "\r")
+      break;
+    line.clear();
+  }
+  if(status_line.find("HTTP/1.0 200 ") == 0) {
+    size_t heap_bytes_before_body = heap_bytes;
+    uint8_t buffer[128];
+    while((remaining_bytes > 0 || remaining_bytes == -1) && !matcher.Done()) {
+      ssize_t read_bytes = recv(connection, buffer, (remaining_bytes > 0 ? std::min(remaining_bytes, (int)sizeof(buffer)) : sizeof(buffer)), 0);
+      if(read_bytes <= 0) break;
+      matcher.Feed(buffer, read_bytes);
+      metrics.body_bytes_read += read_bytes;
+      if(remaining_bytes > 0) remaining_bytes -= read_bytes;
+    }
+    metrics.body_loop_heap_bytes = heap_bytes - heap_bytes_before_body;
+  }
+  close(connection);
+
+  count_heap = false;
+  metrics.heap_bytes = heap_bytes;
+  metrics.duration_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  if(matcher.Done()) metrics.version = matcher.version;
+  return metrics;
+}
+
+static void TestVersionCheckOverHttp() {
+  FileServer server;
+  std::string configuration = ReadFile("../configuration.h");
+  server.files.push_back({ "/configuration.h", configuration });
+  for (const Board &board : kBoards)
+    if(board.build_dir != NULL)
+      server.files.push_back({ std::string("/") + board.build_dir + "/version.txt", ReadFile(std::string("../build/") + board.build_dir + "/version.txt") });
+  uint16_t port = server.Start();
+
+  for (const Board &board : kBoards) {
+    // configuration.h: reading stops in the read that has the end of the literal
+    CheckMetrics metrics = CheckVersion(port, "/configuration.h", board.search_str);
+    CHECK_STR(metrics.version, board.version);
+    size_t literal_end = configuration.find('"', configuration.find('"', configuration.find(std::string("#define ") + board.search_str)) + 1) + 1;
+    CHECK(metrics.body_bytes_read >= literal_end && metrics.body_bytes_read < literal_end + 128);
+    CHECK(metrics.body_bytes_read < configuration.size());
+    CHECK_EQ(metrics.body_loop_heap_bytes, 0);
+    printf("configuration.h %-38s version %s, %4u of %zu body bytes read, heap %3zu bytes, %.2f ms\n",
+      board.search_str, metrics.version.c_str(), metrics.body_bytes_read, configuration.size(), metrics.heap_bytes, metrics.duration_ms);
+    if(board.build_dir == NULL)
+      continue;
+
+    // manifest: one define line
+    std::string manifest_path = std::string("/") + board.build_dir + "/version.txt";
+    size_t manifest_size = ReadFile(std::string("..") + "/build/" + board.build_dir + "/version.txt").size();
+    metrics = CheckVersion(port, manifest_path, board.search_str);
+    CHECK_STR(metrics.version, board.version);
+    CHECK(metrics.body_bytes_read <= manifest_size);
+    CHECK_EQ(metrics.body_loop_heap_bytes, 0);
+    printf("version.txt     %-38s version %s, %4u of %zu body bytes read, heap %3zu bytes, %.2f ms\n",
+      board.search_str, metrics.version.c_str(), metrics.body_bytes_read, manifest_size, metrics.heap_bytes, metrics.duration_ms);
+  }
+
+  // no manifest for the board, or the define is not in the file
+  CHECK_STR(CheckVersion(port, "/esp32.esp32.pico_w/version.txt", kBoards[3].search_str).version, "");
+  CHECK_STR(CheckVersion(port, "/esp32.esp32.esp32s3/version.txt", kBoards[0].search_str).version, "");
+  server.Stop();
+}
+
+int main() {
+  TestConfigurationAndManifests();
+  TestDefinesSideBySide();
+  TestNearMisses();
+  TestOverlongVersion();
+  TestReset();
+  TestVersionCheckOverHttp();
+  return CHECK_RESULT();
+}
@@ -0,0 +1,193 @@
+// FramebufferMirror::Blit() against fake WebSocket clients on a single core, as on the ESP32-S2: frames of
+// the screensaver take a fixed drawing time in virtual time, a message written to TCP costs send time
+// per byte on the core and stays in the client's queue until acknowledged, and a message queued behind
+// another is sent by AsyncTCP's task when the one before it is acknowledged, taking that time from loop().
+// Mirroring must lower the frame rate by at most fps_cost_percent_limit_, with sent and skipped blits in
+// the ratio the limit allows, and must not stop mirroring when acknowledgements are slow.
+
+#include "common.h"
+#include "host.h"
+#include "check.h"
+#include "framebuffer_mirror.h"
+#include <ESPAsyncWebServer.h>
+#include <deque>
+
+const int16_t kCanvasW = 200, kCanvasH = 100;
+const size_t kMessageSize = 12 + ((kCanvasW + 7) / 8) * kCanvasH;
+const uint32_t kFrameUs = 20000;                // drawing time of a frame
+const uint32_t kSendUsPerKb = 3000;             // a message takes about a third of a frame to send
+const uint32_t kRunUs = 60000000;
+
+// client side of TCP: messages in the queue, the first one sent and waiting for its acknowledgement
+struct FakeClient {
+  std::deque<size_t> queue;
+  uint64_t acked_at_us = 0;
+  uint32_t send_us_per_kb;
+  uint32_t ack_us;
+};
+
+struct FakeNetwork {
+  std::vector<FakeClient> clients;
+  uint64_t async_send_us = 0;        // send time taken by AsyncTCP's task
+
+  void Send(FakeClient &client) {
+    uint32_t send_us = client.queue.front() * client.send_us_per_kb / 1024;
+    HostAdvanceMicros(send_us);
+    client.acked_at_us = HostMicros() + client.ack_us;
+  }
+
+  // AsyncTCP's task: acknowledged messages leave the queue, the next one is sent
+  void Run(AsyncWebSocket* ws) {
+    size_t i = 0;
+    for (AsyncWebSocketClient &ws_client : ws->getClients()) {
+      FakeClient &client = clients[i++];
+      while(!client.queue.empty() && HostMicros() >= client.acked_at_us) {
+        client.queue.pop_front();
+        if(!client.queue.empty()) {
+          uint64_t start_us = HostMicros();
+          Send(client);
+          async_send_us += HostMicros() - start_us;
+        }
+      }
+      ws_client.host_queue_len_ = client.queue.size();
+    }
+  }
+
+  // binaryAll() on the loop's core: a message into an empty queue is written to TCP right away
+  void BinaryAll(AsyncWebSocket* ws, const uint8_t* data, size_t length) {
+    size_t i = 0;
+    for (AsyncWebSocketClient &ws_client : ws->getClients()) {
+      FakeClient &client = clients[i++];
+      client.queue.push_back(length);
+      if(client.queue.size() == 1)
+        Send(client);
+      ws_client.host_queue_len_ = client.queue.size();
+    }
+  }
+};
+
+struct RunResult {
+  uint32_t frames, sent, skipped;
+  uint64_t async_send_us;
+};
+
+static RunResult RunScreensaver(uint8_t limit_percent, std::vector<FakeClient> clients) {
+  static uint8_t canvas[((kCanvasW + 7) / 8) * kCanvasH];
+  AsyncWebServer server(80);
+  FramebufferMirror mirror;
+  mirror.fps_cost_percent_limit_ = limit_percent;
+  mirror.Register(&server);
+  AsyncWebSocket* ws = static_cast<AsyncWebSocket*>(server.HostHandlers().back());
+  FakeNetwork network;
+  network.clients = clients;
+  for (size_t i = 0; i < clients.size(); i++)
+    ws->host_clients_.emplace_back(i);
+  ws->host_on_binary_all_ = [&](const uint8_t* data, size_t length){ network.BinaryAll(ws, data, length); };
+
+  RunResult result = {};
+  uint64_t end_us = HostMicros() + kRunUs;
+  while(HostMicros() < end_us) {
+    HostAdvanceMicros(kFrameUs);
+    network.Run(ws);
+    canvas[0] = result.frames;
+    mirror.Blit(10, 20, canvas, kCanvasW, kCanvasH, 0xF800, 0x001F);
+    result.frames++;
+  }
+  result.sent = mirror.blits_sent_;
+  result.skipped = mirror.blits_skipped_;
+  result.async_send_us = network.async_send_us;
+  mirror.Unregister();
+  return result;
+}
+
+static void Print(const char* name, uint8_t limit_percent, const RunResult &result, uint32_t baseline_frames) {
+  printf("%s, limit %u%%: %u frames (%.1f%% fewer), blits sent %u skipped %u\n", name, limit_percent, result.frames,
+      100.0 * (baseline_frames - result.frames) / baseline_frames, result.sent, result.skipped);
+}
+
+// frames lost to mirroring stay within the limit, and when the budget decides the sent blits take the
+// limit's share of the run in send time
+static void CheckLimit(const RunResult &result, uint32_t baseline_frames, uint8_t limit_percent, int budget_bound_clients) {
+  CHECK_EQ(result.sent + result.skipped, result.frames);
+  CHECK(result.sent > 0);
+  double lost = (double)(baseline_frames - result.frames) / baseline_frames;
+  CHECK(lost <= limit_percent / 100.0 + 0.002);
+  if(budget_bound_clients > 0) {
+    double send_us = (double)kMessageSize * kSendUsPerKb / 1024 * budget_bound_clients;
+    double expected_sent = kRunUs * limit_percent / 100.0 / send_us;
+    CHECK(result.sent <= expected_sent * 1.02 + 1);
+    CHECK(result.sent >= expected_sent * 0.98);
+  }
+}
+
+static void TestFrameRateCost() {
+  RunResult baseline = RunScreensaver(10, {});
+  CHECK_EQ(baseline.frames, kRunUs / kFrameUs);
+  CHECK_EQ(baseline.sent + baseline.skipped, 0);
+
+  // acknowledged within a frame: budget decides, as all of the send time is spent in Blit()
+  const uint8_t kLimits[] = { 5, 10, 25 };
+  for (uint8_t limit_percent : kLimits) {
+    RunResult result = RunScreensaver(limit_percent, { { {}, 0, kSendUsPerKb, 5000 } });
+    Print("1 client, fast ack", limit_percent, result, baseline.frames);
+    CheckLimit(result, baseline.frames, limit_percent, 1);
+    CHECK_EQ(result.async_send_us, 0);
+    CHECK(result.skipped > 0);
+  }
+
+  // two viewers cost twice the send time per message, half as many are sent
+  RunResult one = RunScreensaver(10, { { {}, 0, kSendUsPerKb, 5000 } });
+  RunResult two = RunScreensaver(10, { { {}, 0, kSendUsPerKb, 5000 }, { {}, 0, kSendUsPerKb, 5000 } });
+  Print("2 clients, fast ack", 10, two, baseline.frames);
+  CheckLimit(two, baseline.frames, 10, 2);
+  CHECK(two.sent * 2 <= one.sent + one.sent / 20);
+  CHECK(two.sent * 2 >= one.sent - one.sent / 20);
+
+  // acknowledged after 5 frames: queue decides, nothing is left to AsyncTCP's task
+  RunResult slow = RunScreensaver(25, { { {}, 0, kSendUsPerKb, 5 * kFrameUs } });
+  Print("1 client, slow ack", 25, slow, baseline.frames);
+  CheckLimit(slow, baseline.frames, 25, 0);
+  CHECK_EQ(slow.async_send_us, 0);
+  CHECK(slow.sent >= slow.frames / 7);
+}
+
+// message is the header and canvas bytes, no clients and unregistered mirror send nothing
+static void TestMessage() {
+  AsyncWebServer server(80);
+  FramebufferMirror mirror;
+  uint8_t bitmap[2 * 3] = { 0x81, 0x42, 0x24, 0x18, 0xFF, 0x00 };
+  mirror.Register(&server);
+  AsyncWebSocket* ws = static_cast<AsyncWebSocket*>(server.HostHandlers().back());
+  std::vector<uint8_t> message;
+  int messages = 0;
+  ws->host_on_binary_all_ = [&](const uint8_t* data, size_t length){ message.assign(data, data + length); messages++; };
+
+  mirror.Blit(1, 2, bitmap, 9, 3, 0xF800, 0x001F);
+  CHECK_EQ(messages, 0);
+  CHECK_EQ(mirror.blits_sent_ + mirror.blits_skipped_, 0);
+
+  ws->host_clients_.emplace_back(1);
+  HostAdvanceMicros(100000);
+  mirror.Blit(-3, 2, bitmap, 9, 3, 0xF800, 0x001F);
+  CHECK_EQ(messages, 1);
+  const uint8_t kExpected[] = { 0xFD, 0xFF, 2, 0, 9, 0, 3, 0, 0x00, 0xF8, 0x1F, 0x00, 0x81, 0x42, 0x24, 0x18, 0xFF, 0x00 };
+  CHECK(message == std::vector<uint8_t>(kExpected, kExpected + sizeof(kExpected)));
+
+  // still queued: skipped
+  ws->host_clients_.front().host_queue_len_ = 1;
+  HostAdvanceMicros(100000);
+  mirror.Blit(1, 2, bitmap, 9, 3, 0xF800, 0x001F);
+  CHECK_EQ(messages, 1);
+  CHECK_EQ(mirror.blits_skipped_, 1);
+
+  ws->host_clients_.front().host_queue_len_ = 0;
+  mirror.Unregister();
+  mirror.Blit(1, 2, bitmap, 9, 3, 0xF800, 0x001F);
+  CHECK_EQ(messages, 1);
+}
+
+int main() {
+  TestMessage();
+  TestFrameRateCost();
+  return CHECK_RESULT();
+}
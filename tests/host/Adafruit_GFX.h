@@ -0,0 +1,158 @@
+#ifndef ADAFRUIT_GFX_H
+#define ADAFRUIT_GFX_H
+
+// Host stand-in for Adafruit GFX: primitives, GFXfont text, 1 and 16 bit canvases and an SPI TFT
+// keeping its RGB565 frame in memory. Text layout follows the library, glyph shapes come from the
+// placeholder fonts of host_fonts.cpp. Drawing costs virtual time: TFT pixels cost SPI time and
+// canvas pixels cost CPU time, scaled with CPU frequency, see host_gfx.cpp.
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <vector>
+
+typedef struct {
+  uint16_t bitmapOffset;
+  uint8_t width;
+  uint8_t height;
+  uint8_t xAdvance;
+  int8_t xOffset;
+  int8_t yOffset;
+} GFXglyph;
+
+typedef struct {
+  uint8_t* bitmap;
+  GFXglyph* glyph;
+  uint16_t first;
+  uint16_t last;
+  uint8_t yAdvance;
+} GFXfont;
+
+class Adafruit_GFX : public Print {
+public:
+  Adafruit_GFX(int16_t w, int16_t h);
+
+  // a device draws pixels and horizontal spans, everything else is made of them
+  virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+  virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+  virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  virtual void fillScreen(uint16_t color) { fillRect(0, 0, _width, _height, color); }
+
+  void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+  void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  void drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+  void fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+  void drawRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color);
+  void fillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color);
+  void drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
+  void fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
+  void drawBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h, uint16_t color);
+  void drawBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h, uint16_t color, uint16_t bg);
+  void drawRGBBitmap(int16_t x, int16_t y, const uint16_t* bitmap, int16_t w, int16_t h);
+
+  // text, cursor y is baseline with a GFXfont and top of line with the built-in 6x8 font
+  size_t write(uint8_t c) override;
+  using Print::write;
+  void setFont(const GFXfont* font = NULL);
+  void setCursor(int16_t x, int16_t y) { cursor_x = x; cursor_y = y; }
+  int16_t getCursorX() const { return cursor_x; }
+  int16_t getCursorY() const { return cursor_y; }
+  void setTextColor(uint16_t color) { textcolor = textbgcolor = color; }
+  void setTextColor(uint16_t color, uint16_t bg) { textcolor = color; textbgcolor = bg; }
+  void setTextSize(uint8_t size) { textsize_x = textsize_y = (size > 0 ? size : 1); }
+  void setTextSize(uint8_t size_x, uint8_t size_y) { textsize_x = (size_x > 0 ? size_x : 1); textsize_y = (size_y > 0 ? size_y : 1); }
+  void setTextWrap(bool wrap) { wrap_ = wrap; }
+  void getTextBounds(const char* text, int16_t x, int16_t y, int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h);
+  void getTextBounds(const String &text, int16_t x, int16_t y, int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h) { getTextBounds(text.c_str(), x, y, x1, y1, w, h); }
+  void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size_x, uint8_t size_y);
+
+  virtual void setRotation(uint8_t rotation);
+  uint8_t getRotation() const { return rotation; }
+  int16_t width() const { return _width; }
+  int16_t height() const { return _height; }
+  virtual void invertDisplay(bool invert) {}
+
+protected:
+  void charBounds(unsigned char c, int16_t* x, int16_t* y, int16_t* minx, int16_t* miny, int16_t* maxx, int16_t* maxy);
+  void fillCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t corners, int16_t delta, uint16_t color);
+  void drawCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t corners, uint16_t color);
+
+  int16_t WIDTH, HEIGHT;    // unrotated size
+  int16_t _width, _height;
+  int16_t cursor_x = 0, cursor_y = 0;
+  uint16_t textcolor = 0xFFFF, textbgcolor = 0xFFFF;
+  uint8_t textsize_x = 1, textsize_y = 1;
+  uint8_t rotation = 0;
+  bool wrap_ = true;
+  const GFXfont* gfxFont = NULL;
+};
+
+// 1 bit canvas, rows MSB first, any non zero color sets a pixel
+class GFXcanvas1 : public Adafruit_GFX {
+public:
+  GFXcanvas1(uint16_t w, uint16_t h);
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+  void fillScreen(uint16_t color) override;
+  bool getPixel(int16_t x, int16_t y) const;
+  uint8_t* getBuffer() { return buffer_.data(); }
+private:
+  std::vector<uint8_t> buffer_;
+};
+
+class GFXcanvas16 : public Adafruit_GFX {
+public:
+  GFXcanvas16(uint16_t w, uint16_t h);
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+  uint16_t getPixel(int16_t x, int16_t y) const;
+  uint16_t* getBuffer() { return buffer_.data(); }
+private:
+  std::vector<uint16_t> buffer_;
+};
+
+// SPI TFT, frame is kept in rotated coordinates of the last setRotation()
+class Adafruit_SPITFT : public Adafruit_GFX {
+public:
+  Adafruit_SPITFT(uint16_t w, uint16_t h);
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+  void setRotation(uint8_t rotation) override;
+  void invertDisplay(bool invert) override { inverted_ = invert; }
+
+  void startWrite() {}
+  void endWrite() {}
+  void setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+  void writePixels(uint16_t* colors, uint32_t length, bool block = true, bool big_endian = false);
+  void writeColor(uint16_t color, uint32_t length);
+  void setSPISpeed(uint32_t frequency) { spi_frequency_ = frequency; }
+  void enableDisplay(bool enable) { display_on_ = enable; }
+  void enableSleep(bool sleep) { display_on_ = !sleep; }
+  void sendCommand(uint8_t command, const uint8_t* data = NULL, uint8_t length = 0) {}
+
+  // host side
+  uint16_t Pixel(int16_t x, int16_t y) const;
+  bool WriteScreenshot(const char* ppm_file_name) const;
+  uint64_t spi_pixels_ = 0;       // pixels sent to the panel
+  uint64_t spi_busy_us_ = 0;
+
+protected:
+  void Resize(uint16_t w, uint16_t h);
+  void Spend(uint32_t pixels, uint32_t windows);
+  void Store(int16_t x, int16_t y, uint16_t color);
+  // pixels into address window from its current index on, colors NULL fills with color
+  void StoreInWindow(const uint16_t* colors, uint16_t color, uint32_t length);
+
+  std::vector<uint16_t> frame_;
+  uint32_t spi_frequency_ = 40000000;
+  bool inverted_ = false;
+  bool display_on_ = true;
+  int16_t window_x_ = 0, window_y_ = 0, window_w_ = 0, window_h_ = 0;
+  uint32_t window_index_ = 0;
+};
+
+// CPU time of canvas drawing, fractions of a microsecond are carried over
+void HostGfxSpendCpu(double us_at_240_mhz);
+
+#endif  // ADAFRUIT_GFX_H
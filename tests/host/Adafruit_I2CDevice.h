@@ -0,0 +1,6 @@
+#ifndef HOST_ADAFRUIT_I2CDEVICE_H
+#define HOST_ADAFRUIT_I2CDEVICE_H
+
+// included by the sketch for Arduino library discovery only
+
+#endif  // HOST_ADAFRUIT_I2CDEVICE_H
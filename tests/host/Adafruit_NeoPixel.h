@@ -0,0 +1,55 @@
+#ifndef HOST_ADAFRUIT_NEOPIXEL_H
+#define HOST_ADAFRUIT_NEOPIXEL_H
+
+// NeoPixel strip that keeps the colors last shown, for tests to read
+
+#include <Arduino.h>
+#include <vector>
+
+#define NEO_GRB 0x52
+#define NEO_KHZ800 0x0000
+
+class Adafruit_NeoPixel {
+public:
+  Adafruit_NeoPixel(uint16_t count, int16_t pin, uint32_t type) : pixels_(count, 0), shown_(count, 0) {}
+  void begin() {}
+  void show() { shown_ = pixels_; shown_brightness_ = brightness_; shows_++; }
+  void clear() { std::fill(pixels_.begin(), pixels_.end(), 0); }
+  void setPixelColor(uint16_t n, uint32_t color) { if(n < pixels_.size()) pixels_[n] = color; }
+  void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b) { setPixelColor(n, Color(r, g, b)); }
+  void setBrightness(uint8_t brightness) { brightness_ = brightness; }
+  uint8_t getBrightness() const { return brightness_; }
+  void fill(uint32_t color = 0, uint16_t first = 0, uint16_t count = 0) {
+    uint16_t end = (count == 0 ? pixels_.size() : min((size_t)(first + count), pixels_.size()));
+    for (uint16_t n = first; n < end; n++) pixels_[n] = color;
+  }
+  uint16_t numPixels() const { return pixels_.size(); }
+  static uint32_t Color(uint8_t r, uint8_t g, uint8_t b) { return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b; }
+  static uint32_t ColorHSV(uint16_t hue, uint8_t sat = 255, uint8_t val = 255);
+  static uint32_t gamma32(uint32_t color) { return color; }
+
+  // host side, strip as last shown
+  uint32_t ShownColor(uint16_t n) const { return (n < shown_.size() ? shown_[n] : 0); }
+  uint8_t shown_brightness_ = 0;
+  uint32_t shows_ = 0;
+
+private:
+  std::vector<uint32_t> pixels_, shown_;
+  uint8_t brightness_ = 255;
+};
+
+// hue 0..65535 around the color wheel, as in the library
+inline uint32_t Adafruit_NeoPixel::ColorHSV(uint16_t hue, uint8_t sat, uint8_t val) {
+  uint8_t r, g, b;
+  hue = (hue * 1530L + 32768) / 65536;
+  if(hue < 510) { b = 0; if(hue < 255) { r = 255; g = hue; } else { r = 510 - hue; g = 255; } }
+  else if(hue < 1020) { r = 0; if(hue < 765) { g = 255; b = hue - 510; } else { g = 1020 - hue; b = 255; } }
+  else if(hue < 1530) { g = 0; if(hue < 1275) { r = hue - 1020; b = 255; } else { r = 255; b = 1530 - hue; } }
+  else { r = 255; g = b = 0; }
+  uint32_t v1 = 1 + val;
+  uint16_t s1 = 1 + sat;
+  uint8_t s2 = 255 - sat;
+  return ((((((r * s1) >> 8) + s2) * v1) & 0xff00) << 8) | (((((g * s1) >> 8) + s2) * v1) & 0xff00) | (((((b * s1) >> 8) + s2) * v1) >> 8);
+}
+
+#endif  // HOST_ADAFRUIT_NEOPIXEL_H
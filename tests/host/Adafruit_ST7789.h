@@ -0,0 +1,22 @@
+#ifndef ADAFRUIT_ST7789_H
+#define ADAFRUIT_ST7789_H
+
+// Host stand-in for the ST7789 driver, a 240x320 panel on Adafruit_SPITFT.
+
+#include "Adafruit_GFX.h"
+
+#define ST77XX_BLACK 0x0000
+#define ST77XX_WHITE 0xFFFF
+#define ST77XX_SLPIN 0x10
+#define ST77XX_SLPOUT 0x11
+#define ST77XX_DISPOFF 0x28
+#define ST77XX_DISPON 0x29
+
+class Adafruit_ST7789 : public Adafruit_SPITFT {
+public:
+  Adafruit_ST7789(SPIClass* spi, int8_t cs, int8_t dc, int8_t rst) : Adafruit_SPITFT(240, 320) {}
+  Adafruit_ST7789(int8_t cs, int8_t dc, int8_t rst) : Adafruit_SPITFT(240, 320) {}
+  void init(uint16_t width, uint16_t height, uint8_t spi_mode = 0) { Resize(width, height); setRotation(0); }
+};
+
+#endif  // ADAFRUIT_ST7789_H
@@ -0,0 +1,214 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Linux stand-in for the ESP32 Arduino core, enough of it for the clock modules and the sketch
+// to build and run on the host. Time is virtual: millis(), micros() and esp_timer_get_time()
+// only move when delay() is called or a test advances them, see host.h.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <math.h>
+#include <string>
+#include <algorithm>
+#include <atomic>
+
+using std::min;
+using std::max;
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define F(x) x
+#define PROGMEM
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define ARDUINO_ISR_ATTR
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+#define PI 3.1415926535897932384626433832795
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+#define strlen_P strlen
+#define memcpy_P memcpy
+
+// time
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+// gpio, levels of input pins are set by tests with HostSetPin()
+void pinMode(int pin, int mode);
+void digitalWrite(int pin, int level);
+int digitalRead(int pin);
+int analogRead(int pin);
+void analogWrite(int pin, int value);
+void analogReadResolution(int bits);
+void attachInterrupt(int interrupt, void (*isr)(), int mode);
+void detachInterrupt(int interrupt);
+inline int digitalPinToInterrupt(int pin) { return pin; }
+void noInterrupts();
+void interrupts();
+void tone(int pin, unsigned int frequency, unsigned long duration = 0);
+void noTone(int pin);
+
+long random(long max_value);
+long random(long min_value, long max_value);
+void randomSeed(unsigned long seed);
+inline long map(long x, long in_min, long in_max, long out_min, long out_max) { return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min; }
+
+class String : public std::string {
+public:
+  String() {}
+  String(const char* s) : std::string(s == NULL ? "" : s) {}
+  String(const std::string &s) : std::string(s) {}
+  String(char c) : std::string(1, c) {}
+  String(int value) : std::string(std::to_string(value)) {}
+  String(unsigned int value) : std::string(std::to_string(value)) {}
+  String(long value) : std::string(std::to_string(value)) {}
+  String(unsigned long value) : std::string(std::to_string(value)) {}
+  String(double value, unsigned int decimals = 2);
+  unsigned int length() const { return size(); }   // unsigned int as in the ESP32 core
+  long toInt() const { return atol(c_str()); }
+  float toFloat() const { return atof(c_str()); }
+  int indexOf(char c, unsigned int from = 0) const { size_t i = find(c, from); return (i == npos ? -1 : (int)i); }
+  int indexOf(const char* s, unsigned int from = 0) const { size_t i = find(s, from); return (i == npos ? -1 : (int)i); }
+  String substring(unsigned int from) const { return (from >= size() ? String() : String(substr(from))); }
+  String substring(unsigned int from, unsigned int to) const { return (from >= size() || to <= from ? String() : String(substr(from, to - from))); }
+  bool equals(const char* s) const { return compare(s) == 0; }
+  bool startsWith(const char* s) const { return rfind(s, 0) == 0; }
+  void trim();
+  void toCharArray(char* buffer, unsigned int size) const { if(size == 0) return; strncpy(buffer, c_str(), size - 1); buffer[size - 1] = '\0'; }
+};
+
+#define DEC 10
+#define HEX 16
+#define BIN 2
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size);
+  size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+  size_t print(const char* s) { return write(s); }
+  size_t print(const std::string &s) { return write((const uint8_t*)s.data(), s.size()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(unsigned char value, int base = DEC) { return print((unsigned long)value, base); }
+  size_t print(int value, int base = DEC) { return print((long)value, base); }
+  size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+  size_t print(long value, int base = DEC);
+  size_t print(unsigned long value, int base = DEC);
+  size_t print(long long value, int base = DEC) { return print((long)value, base); }
+  size_t print(unsigned long long value, int base = DEC) { return print((unsigned long)value, base); }
+  size_t print(double value, int decimals = 2);
+  size_t println() { return write("\r\n"); }
+  template<typename T> size_t println(const T &value) { size_t n = print(value); return n + println(); }
+  template<typename T> size_t println(const T &value, int format) { size_t n = print(value, format); return n + println(); }
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+  virtual void flush() {}
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  size_t readBytes(uint8_t* buffer, size_t length);
+  size_t readBytes(char* buffer, size_t length) { return readBytes((uint8_t*)buffer, length); }
+  String readString();
+  String readStringUntil(char terminator);
+  long parseInt();
+  void setTimeout(unsigned long timeout_ms) { timeout_ms_ = timeout_ms; }
+protected:
+  unsigned long timeout_ms_ = 1000;
+};
+
+// Serial output goes to stdout when HostSetSerialEcho(true), input is queued by HostSerialInput()
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long baud) {}
+  void end() {}
+  operator bool() { return true; }
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int peek() override;
+};
+extern HardwareSerial Serial;
+
+// ESP32 system
+uint32_t getCpuFrequencyMhz();
+bool setCpuFrequencyMhz(uint32_t cpu_freq_mhz);
+uint32_t esp_get_free_heap_size();
+uint32_t esp_get_minimum_free_heap_size();
+int64_t esp_timer_get_time();
+void esp_restart();
+
+// ESP32 hardware timers, alarms run from HostAdvanceMicros() at their virtual due time
+struct hw_timer_t;
+hw_timer_t* timerBegin(uint8_t num, uint16_t divider, bool count_up);
+void timerEnd(hw_timer_t* timer);
+void timerAttachInterrupt(hw_timer_t* timer, void (*isr)(), bool edge);
+void timerAlarmWrite(hw_timer_t* timer, uint64_t alarm_value, bool autoreload);
+void timerAlarmEnable(hw_timer_t* timer);
+void timerAlarmDisable(hw_timer_t* timer);
+void timerWrite(hw_timer_t* timer, uint64_t value);
+
+// LEDC PWM, frequency and duty of a channel are readable by tests
+uint32_t ledcSetup(uint8_t channel, uint32_t frequency, uint8_t resolution_bits);
+void ledcAttachPin(uint8_t pin, uint8_t channel);
+void ledcDetachPin(uint8_t pin);
+void ledcWrite(uint8_t channel, uint32_t duty);
+uint32_t ledcWriteTone(uint8_t channel, uint32_t frequency);
+
+// FreeRTOS, tasks are host threads
+typedef void* TaskHandle_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define portMAX_DELAY 0xFFFFFFFFUL
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) (ms)
+BaseType_t xTaskCreatePinnedToCore(void (*task)(void*), const char* name, uint32_t stack_depth, void* parameter, UBaseType_t priority, TaskHandle_t* handle, BaseType_t core_id);
+void vTaskDelay(TickType_t ticks);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+BaseType_t xPortGetCoreID();
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higher_priority_task_woken);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait);
+inline void portYIELD_FROM_ISR(BaseType_t = 0) {}
+
+// critical sections are a spinlock, as on a dual core ESP32
+struct portMUX_TYPE {
+  std::atomic<int> locked;
+};
+#define portMUX_INITIALIZER_UNLOCKED {0}
+void portENTER_CRITICAL(portMUX_TYPE* mux);
+void portEXIT_CRITICAL(portMUX_TYPE* mux);
+inline void portENTER_CRITICAL_ISR(portMUX_TYPE* mux) { portENTER_CRITICAL(mux); }
+inline void portEXIT_CRITICAL_ISR(portMUX_TYPE* mux) { portEXIT_CRITICAL(mux); }
+
+#endif  // HOST_ARDUINO_H
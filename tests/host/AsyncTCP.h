@@ -0,0 +1,6 @@
+#ifndef HOST_ASYNCTCP_H
+#define HOST_ASYNCTCP_H
+
+// connections are served by the loopback web server of ESPAsyncWebServer.h
+
+#endif  // HOST_ASYNCTCP_H
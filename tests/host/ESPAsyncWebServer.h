@@ -0,0 +1,156 @@
+#ifndef HOST_ESPASYNCWEBSERVER_H
+#define HOST_ESPASYNCWEBSERVER_H
+
+// ESPAsyncWebServer on a real TCP socket on 127.0.0.1, at an ephemeral port instead of the given one.
+// Nothing runs on its own: HostPollWebServers() of host.h accepts connections, reads requests and runs
+// handlers on the calling thread, as AsyncTCP's task would. A request body goes to the body handler in
+// chunks of up to kBodyChunkSize bytes before the request handler runs, responses close the connection.
+// WebSockets have the clients tests add, messages sent to them go to the socket's host_on_binary_all_.
+
+#include <Arduino.h>
+#include <functional>
+#include <list>
+#include <map>
+#include <vector>
+
+typedef enum { HTTP_GET = 1, HTTP_POST = 2, HTTP_DELETE = 4, HTTP_PUT = 8, HTTP_PATCH = 16, HTTP_HEAD = 32, HTTP_OPTIONS = 64, HTTP_ANY = 127 } WebRequestMethod;
+
+class AsyncWebParameter {
+public:
+  AsyncWebParameter(const String &name, const String &value) : name_(name), value_(value) {}
+  const String &name() const { return name_; }
+  const String &value() const { return value_; }
+private:
+  String name_, value_;
+};
+
+class AsyncWebServerResponse {
+public:
+  AsyncWebServerResponse(int code, const String &content_type, const std::string &content) : code_(code), content_type_(content_type), content_(content) {}
+  void addHeader(const String &name, const String &value) { headers_.push_back({ name, value }); }
+  void setCode(int code) { code_ = code; }
+  int code_;
+  String content_type_;
+  std::string content_;
+  std::vector<std::pair<String, String>> headers_;
+};
+
+class AsyncWebServerRequest {
+public:
+  void send(int code, const String &content_type = String(), const String &content = String()) { send(beginResponse(code, content_type, content)); }
+  void send(AsyncWebServerResponse* response);
+  AsyncWebServerResponse* beginResponse(int code, const String &content_type, const String &content = String()) { return new AsyncWebServerResponse(code, content_type, content); }
+  AsyncWebServerResponse* beginResponse_P(int code, const String &content_type, const uint8_t* content, size_t length) { return new AsyncWebServerResponse(code, content_type, std::string((const char*)content, length)); }
+  bool hasParam(const String &name, bool post = false, bool file = false) const { return getParam(name, post, file) != NULL; }
+  AsyncWebParameter* getParam(const String &name, bool post = false, bool file = false) const;
+  bool hasHeader(const char* name) const { return headers_.count(Lower(name)) > 0; }
+  const String &header(const char* name) const;
+  WebRequestMethod method() const { return method_; }
+  const String &url() const { return url_; }
+  ~AsyncWebServerRequest();
+
+private:
+  friend class AsyncWebServer;
+  static String Lower(const char* text);
+  WebRequestMethod method_ = HTTP_GET;
+  String url_;
+  std::vector<AsyncWebParameter*> params_;
+  std::map<String, String> headers_;    // lower case names
+  AsyncWebServerResponse* response_ = NULL;
+};
+
+typedef std::function<void(AsyncWebServerRequest*)> ArRequestHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest*, uint8_t*, size_t, size_t, size_t)> ArBodyHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest*, const String&, size_t, uint8_t*, size_t, bool)> ArUploadHandlerFunction;
+
+class AsyncWebHandler {
+public:
+  virtual ~AsyncWebHandler() {}
+};
+
+class AsyncCallbackWebHandler : public AsyncWebHandler {
+public:
+  String uri_;
+  WebRequestMethod method_;
+  ArRequestHandlerFunction on_request_;
+  ArBodyHandlerFunction on_body_;
+};
+
+class AsyncWebSocketClient {
+public:
+  AsyncWebSocketClient(uint32_t id = 0) : id_(id) {}
+  uint32_t id() { return id_; }
+  size_t queueLen() const { return host_queue_len_; }
+
+  // host side, messages not yet acknowledged
+  size_t host_queue_len_ = 0;
+
+private:
+  uint32_t id_;
+};
+
+typedef enum { WS_EVT_CONNECT, WS_EVT_DISCONNECT, WS_EVT_PONG, WS_EVT_ERROR, WS_EVT_DATA } AwsEventType;
+class AsyncWebSocket;
+typedef std::function<void(AsyncWebSocket*, AsyncWebSocketClient*, AwsEventType, void*, uint8_t*, size_t)> AwsEventHandler;
+
+class AsyncWebSocketMessageBuffer {
+public:
+  AsyncWebSocketMessageBuffer(size_t size) : data_(size) {}
+  uint8_t* get() { return data_.data(); }
+  size_t length() { return data_.size(); }
+private:
+  std::vector<uint8_t> data_;
+};
+
+class AsyncWebSocket : public AsyncWebHandler {
+public:
+  AsyncWebSocket(const String &url) {}
+  void onEvent(AwsEventHandler handler) {}
+  size_t count() const { return host_clients_.size(); }
+  std::list<AsyncWebSocketClient> &getClients() { return host_clients_; }
+  bool availableForWriteAll() { return true; }
+  AsyncWebSocketMessageBuffer* makeBuffer(size_t size = 0) { return new AsyncWebSocketMessageBuffer(size); }
+  void binaryAll(AsyncWebSocketMessageBuffer* buffer) {
+    if(host_on_binary_all_) host_on_binary_all_(buffer->get(), buffer->length());
+    delete buffer;
+  }
+  void cleanupClients(uint16_t max_clients = 8) {}
+
+  // host side
+  std::list<AsyncWebSocketClient> host_clients_;
+  std::function<void(const uint8_t*, size_t)> host_on_binary_all_;
+};
+
+class AsyncWebServer {
+public:
+  AsyncWebServer(uint16_t port);
+  ~AsyncWebServer();
+  void begin();
+  void end();
+  AsyncCallbackWebHandler &on(const char* uri, WebRequestMethod method, ArRequestHandlerFunction on_request) { return on(uri, method, on_request, NULL, NULL); }
+  AsyncCallbackWebHandler &on(const char* uri, WebRequestMethod method, ArRequestHandlerFunction on_request, ArUploadHandlerFunction on_upload, ArBodyHandlerFunction on_body = NULL);
+  AsyncWebHandler &addHandler(AsyncWebHandler* handler);
+  void onNotFound(ArRequestHandlerFunction on_request) { not_found_ = on_request; }
+
+  // host side
+  uint16_t HostPort() const { return port_; }
+  const std::vector<AsyncWebHandler*> &HostHandlers() const { return handlers_; }
+  bool Poll();
+  static constexpr size_t kBodyChunkSize = 1436;    // one TCP segment
+
+private:
+  struct Connection {
+    int fd;
+    std::string received;
+  };
+  bool Serve(Connection &connection);
+
+  uint16_t port_ = 0;
+  int listen_fd_ = -1;
+  std::vector<Connection> connections_;
+  std::vector<AsyncCallbackWebHandler*> callback_handlers_;
+  std::vector<AsyncWebHandler*> handlers_;
+  ArRequestHandlerFunction not_found_;
+};
+
+#endif  // HOST_ESPASYNCWEBSERVER_H
@@ -0,0 +1,8 @@
+#ifndef COMINGSOON_REGULAR70PT7B_H
+#define COMINGSOON_REGULAR70PT7B_H
+
+// placeholder font with approximate metrics, see host_fonts.cpp
+#include <Adafruit_GFX.h>
+extern const GFXfont ComingSoon_Regular70pt7b;
+
+#endif  // COMINGSOON_REGULAR70PT7B_H
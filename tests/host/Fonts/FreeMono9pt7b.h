@@ -0,0 +1,8 @@
+#ifndef FREEMONO9PT7B_H
+#define FREEMONO9PT7B_H
+
+// placeholder font with approximate metrics, see host_fonts.cpp
+#include <Adafruit_GFX.h>
+extern const GFXfont FreeMono9pt7b;
+
+#endif  // FREEMONO9PT7B_H
@@ -0,0 +1,8 @@
+#ifndef FREEMONOBOLD9PT7B_H
+#define FREEMONOBOLD9PT7B_H
+
+// placeholder font with approximate metrics, see host_fonts.cpp
+#include <Adafruit_GFX.h>
+extern const GFXfont FreeMonoBold9pt7b;
+
+#endif  // FREEMONOBOLD9PT7B_H
@@ -0,0 +1,8 @@
+#ifndef FREESANS12PT7B_H
+#define FREESANS12PT7B_H
+
+// placeholder font with approximate metrics, see host_fonts.cpp
+#include <Adafruit_GFX.h>
+extern const GFXfont FreeSans12pt7b;
+
+#endif  // FREESANS12PT7B_H
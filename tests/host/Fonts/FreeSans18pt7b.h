@@ -0,0 +1,8 @@
+#ifndef FREESANS18PT7B_H
+#define FREESANS18PT7B_H
+
+// placeholder font with approximate metrics, see host_fonts.cpp
+#include <Adafruit_GFX.h>
+extern const GFXfont FreeSans18pt7b;
+
+#endif  // FREESANS18PT7B_H
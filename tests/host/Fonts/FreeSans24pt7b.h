@@ -0,0 +1,8 @@
+#ifndef FREESANS24PT7B_H
+#define FREESANS24PT7B_H
+
+// placeholder font with approximate metrics, see host_fonts.cpp
+#include <Adafruit_GFX.h>
+extern const GFXfont FreeSans24pt7b;
+
+#endif  // FREESANS24PT7B_H
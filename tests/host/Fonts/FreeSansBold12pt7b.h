@@ -0,0 +1,8 @@
+#ifndef FREESANSBOLD12PT7B_H
+#define FREESANSBOLD12PT7B_H
+
+// placeholder font with approximate metrics, see host_fonts.cpp
+#include <Adafruit_GFX.h>
+extern const GFXfont FreeSansBold12pt7b;
+
+#endif  // FREESANSBOLD12PT7B_H
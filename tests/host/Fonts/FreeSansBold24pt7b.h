@@ -0,0 +1,8 @@
+#ifndef FREESANSBOLD24PT7B_H
+#define FREESANSBOLD24PT7B_H
+
+// placeholder font with approximate metrics, see host_fonts.cpp
+#include <Adafruit_GFX.h>
+extern const GFXfont FreeSansBold24pt7b;
+
+#endif  // FREESANSBOLD24PT7B_H
@@ -0,0 +1,8 @@
+#ifndef FREESANSBOLD48PT7B_H
+#define FREESANSBOLD48PT7B_H
+
+// placeholder font with approximate metrics, see host_fonts.cpp
+#include <Adafruit_GFX.h>
+extern const GFXfont FreeSansBold48pt7b;
+
+#endif  // FREESANSBOLD48PT7B_H
@@ -0,0 +1,8 @@
+#ifndef SATISFY_REGULAR24PT7B_H
+#define SATISFY_REGULAR24PT7B_H
+
+// placeholder font with approximate metrics, see host_fonts.cpp
+#include <Adafruit_GFX.h>
+extern const GFXfont Satisfy_Regular24pt7b;
+
+#endif  // SATISFY_REGULAR24PT7B_H
@@ -0,0 +1,40 @@
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+// Arduino Preferences on the in-memory NVS of host_nvs.cpp, every put is one commit as on the ESP32
+
+#include <Arduino.h>
+#include <string>
+
+class Preferences {
+public:
+  bool begin(const char* name_space, bool read_only = false);
+  void end() { name_space_.clear(); }
+  bool isKey(const char* key);
+  bool remove(const char* key);
+  size_t putUChar(const char* key, uint8_t value) { return Put(key, &value, sizeof(value)); }
+  size_t putBool(const char* key, bool value) { uint8_t byte = value; return Put(key, &byte, 1); }
+  size_t putUShort(const char* key, uint16_t value) { return Put(key, &value, sizeof(value)); }
+  size_t putInt(const char* key, int32_t value) { return Put(key, &value, sizeof(value)); }
+  size_t putUInt(const char* key, uint32_t value) { return Put(key, &value, sizeof(value)); }
+  size_t putULong(const char* key, uint32_t value) { return Put(key, &value, sizeof(value)); }
+  size_t putString(const char* key, const String &value) { return Put(key, value.c_str(), value.size() + 1); }
+  size_t putBytes(const char* key, const void* value, size_t length) { return Put(key, value, length); }
+  uint8_t getUChar(const char* key, uint8_t default_value = 0) { Get(key, &default_value, sizeof(default_value)); return default_value; }
+  bool getBool(const char* key, bool default_value = false) { uint8_t byte = default_value; Get(key, &byte, 1); return byte; }
+  uint16_t getUShort(const char* key, uint16_t default_value = 0) { Get(key, &default_value, sizeof(default_value)); return default_value; }
+  int32_t getInt(const char* key, int32_t default_value = 0) { Get(key, &default_value, sizeof(default_value)); return default_value; }
+  uint32_t getUInt(const char* key, uint32_t default_value = 0) { Get(key, &default_value, sizeof(default_value)); return default_value; }
+  uint32_t getULong(const char* key, uint32_t default_value = 0) { Get(key, &default_value, sizeof(default_value)); return default_value; }
+  String getString(const char* key, const String &default_value = String());
+  size_t getBytes(const char* key, void* buffer, size_t length);
+  size_t getBytesLength(const char* key);
+
+private:
+  size_t Put(const char* key, const void* value, size_t length);
+  bool Get(const char* key, void* value, size_t length);
+  std::string name_space_;
+  bool read_only_ = false;
+};
+
+#endif  // HOST_PREFERENCES_H
@@ -0,0 +1,17 @@
+#ifndef HOST_SPI_H
+#define HOST_SPI_H
+
+#include <Arduino.h>
+
+#define HSPI 2
+#define VSPI 3
+
+class SPIClass {
+public:
+  SPIClass(int bus = VSPI) {}
+  void begin(int sck = -1, int miso = -1, int mosi = -1, int ss = -1) {}
+  void end() {}
+};
+extern SPIClass SPI;
+
+#endif  // HOST_SPI_H
@@ -0,0 +1,14 @@
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include <Arduino.h>
+
+class TwoWire {
+public:
+  bool begin(int sda = -1, int scl = -1) { return true; }
+  void setSDA(int pin) {}
+  void setSCL(int pin) {}
+};
+extern TwoWire Wire;
+
+#endif  // HOST_WIRE_H
@@ -0,0 +1,28 @@
+#ifndef HOST_XPT2046_TOUCHSCREEN_H
+#define HOST_XPT2046_TOUCHSCREEN_H
+
+// XPT2046 touch controller, raw touch is set by HostTouch() of host.h
+
+#include <Arduino.h>
+#include <SPI.h>
+
+struct TS_Point {
+  int16_t x, y, z;
+};
+
+// raw controller reading, z 0 when not touched
+extern TS_Point host_touch_point;
+
+class XPT2046_Touchscreen {
+public:
+  XPT2046_Touchscreen(uint8_t cs_pin, uint8_t irq_pin = 255) {}
+  bool begin(SPIClass &spi) { return true; }
+  bool begin() { return true; }
+  void setRotation(uint8_t rotation) {}
+  TS_Point getPoint() { return host_touch_point; }
+  bool touched() { return host_touch_point.z > 0; }
+  // pen IRQ goes low on touch
+  bool tirqTouched() { return host_touch_point.z > 0; }
+};
+
+#endif  // HOST_XPT2046_TOUCHSCREEN_H
@@ -0,0 +1,26 @@
+#ifndef HOST_CHECK_H
+#define HOST_CHECK_H
+
+// minimal assertions for host tests: failures are counted and printed, CHECK_RESULT() is main's return value
+
+#include <stdio.h>
+
+inline int check_failures = 0;
+
+#define CHECK(condition) \
+  do { if(!(condition)) { check_failures++; fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); } } while(0)
+
+#define CHECK_EQ(actual, expected) \
+  do { long long actual_value = (long long)(actual), expected_value = (long long)(expected); \
+    if(actual_value != expected_value) { check_failures++; \
+      fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, #actual, #expected, actual_value, expected_value); } } while(0)
+
+#define CHECK_STR(actual, expected) \
+  do { std::string actual_value = (actual), expected_value = (expected); \
+    if(actual_value != expected_value) { check_failures++; \
+      fprintf(stderr, "%s:%d: CHECK_STR(%s, %s) failed: \"%s\" != \"%s\"\n", __FILE__, __LINE__, #actual, #expected, actual_value.c_str(), expected_value.c_str()); } } while(0)
+
+#define CHECK_RESULT() \
+  (check_failures == 0 ? (printf("%s: passed\n", __FILE__), 0) : (fprintf(stderr, "%s: %d checks failed\n", __FILE__, check_failures), 1))
+
+#endif  // HOST_CHECK_H
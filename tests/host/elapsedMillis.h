@@ -0,0 +1,17 @@
+#ifndef HOST_ELAPSED_MILLIS_H
+#define HOST_ELAPSED_MILLIS_H
+
+#include <Arduino.h>
+
+class elapsedMillis {
+public:
+  elapsedMillis(unsigned long value = 0) : start_ms_(millis() - value) {}
+  operator unsigned long() const { return millis() - start_ms_; }
+  elapsedMillis &operator=(unsigned long value) { start_ms_ = millis() - value; return *this; }
+  elapsedMillis &operator+=(unsigned long value) { start_ms_ -= value; return *this; }
+  elapsedMillis &operator-=(unsigned long value) { start_ms_ += value; return *this; }
+private:
+  unsigned long start_ms_;
+};
+
+#endif  // HOST_ELAPSED_MILLIS_H
@@ -0,0 +1,15 @@
+#ifndef HOST_ESP_TASK_WDT_H
+#define HOST_ESP_TASK_WDT_H
+
+// Task watchdog on virtual time. It does not reboot, the longest gap between resets of the
+// subscribed task is kept for tests, see HostWatchdogLongestGapMs() in host.h.
+
+#include "esp_err.h"
+#include <stdint.h>
+
+esp_err_t esp_task_wdt_init(uint32_t timeout_seconds, bool panic);
+esp_err_t esp_task_wdt_add(void* task);
+esp_err_t esp_task_wdt_reset();
+esp_err_t esp_task_wdt_deinit();
+
+#endif  // HOST_ESP_TASK_WDT_H
@@ -0,0 +1,60 @@
+#ifndef HOST_H
+#define HOST_H
+
+// Test side controls of the host Arduino stand-in.
+
+#include <Arduino.h>
+#include <string>
+#include <vector>
+
+// virtual time, starts at 0 and only moves forward
+// advancing runs hardware timer and esp_timer callbacks at their due times, in due time order
+uint64_t HostMicros();
+void HostAdvanceMicros(uint64_t us);
+void HostAdvanceMillis(uint32_t ms);
+// due time of next armed timer, UINT64_MAX if none is armed
+uint64_t HostNextTimerMicros();
+
+// drive an input pin, an attached interrupt runs if the level change matches its mode
+void HostSetPin(int pin, int level);
+// level last written by digitalWrite(), -1 if never written
+int HostPinOutput(int pin);
+void HostSetAnalog(int pin, int value);
+
+// serial
+void HostSetSerialEcho(bool echo);
+void HostSerialInput(const char* text);
+std::string HostTakeSerialOutput();
+
+// LEDC channel state, frequency 0 when channel output is off
+uint32_t HostLedcFrequency(uint8_t channel);
+uint32_t HostLedcDuty(uint8_t channel);
+int HostLedcPinChannel(int pin);
+
+// runs while the calling thread waits in delay() or ulTaskNotifyTake(), to let a
+// single threaded simulation run the other core cooperatively; runner is not re-entered
+void HostSetWaitRunner(void (*runner)());
+// runs the wait runner once as the other core, returns virtual time it took
+uint64_t HostRunWaitRunner();
+
+// tasks created with xTaskCreatePinnedToCore() are recorded, not started
+void (*HostCreatedTask(const char* name))(void*);
+
+// XPT2046 raw touch reading, z 0 = not touched
+void HostTouch(int16_t raw_x, int16_t raw_y, int16_t z);
+
+// task watchdog of esp_task_wdt.h on virtual time, gaps are between resets of the subscribed core
+uint32_t HostWatchdogTimeoutMs();        // 0 = not initialized
+uint32_t HostWatchdogLongestGapMs();
+uint32_t HostWatchdogOverruns();         // gaps over timeout, each would have rebooted the clock
+
+// NVS of Preferences and nvs.h, kept in memory, survives a simulated reboot
+uint32_t HostNvsCommits();
+void HostNvsErase();
+bool HostNvsRead(const char* name_space, const char* key, std::vector<uint8_t> &value);
+
+// web servers of ESPAsyncWebServer.h on 127.0.0.1, serves requests that have fully arrived
+bool HostPollWebServers();
+uint16_t HostWebServerPort();           // port of last started server, 0 if none is running
+
+#endif  // HOST_H
@@ -0,0 +1,699 @@
+#include "host.h"
+#include "esp_timer.h"
+#include "esp_task_wdt.h"
+#include <XPT2046_Touchscreen.h>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <thread>
+#include <random>
+#include <vector>
+#include <map>
+
+// VIRTUAL TIME AND TIMERS
+
+// a hardware timer alarm or an esp_timer, both run from HostAdvanceMicros()
+struct HostTimer {
+  uint64_t due_us = 0;
+  uint64_t period_us = 0;       // 0 = one shot
+  bool armed = false;
+  void (*isr)() = NULL;
+  esp_timer_cb_t callback = NULL;
+  void* arg = NULL;
+};
+
+struct hw_timer_t {
+  HostTimer timer;
+  uint16_t divider = 80;
+  uint64_t alarm_value = 0;
+  bool autoreload = false;
+};
+
+struct esp_timer {
+  HostTimer timer;
+};
+
+static std::atomic<uint64_t> now_us = {0};
+static std::recursive_mutex timers_mutex;
+static std::vector<HostTimer*> timers;
+
+static uint64_t TimerTicksToMicros(hw_timer_t* timer, uint64_t ticks) {
+  return ticks * timer->divider / 80;    // 80 MHz APB clock
+}
+
+uint64_t HostMicros() {
+  return now_us.load();
+}
+
+void HostAdvanceMicros(uint64_t us) {
+  std::lock_guard<std::recursive_mutex> lock(timers_mutex);
+  uint64_t target_us = now_us.load() + us;
+  while(true) {
+    HostTimer* next = NULL;
+    for (HostTimer* timer : timers)
+      if(timer->armed && timer->due_us <= target_us && (next == NULL || timer->due_us < next->due_us))
+        next = timer;
+    if(next == NULL)
+      break;
+    if(next->due_us > now_us.load())
+      now_us.store(next->due_us);
+    if(next->period_us > 0)
+      next->due_us += next->period_us;
+    else
+      next->armed = false;
+    if(next->isr != NULL)
+      next->isr();
+    else
+      next->callback(next->arg);
+  }
+  now_us.store(target_us);
+}
+
+void HostAdvanceMillis(uint32_t ms) {
+  HostAdvanceMicros((uint64_t)ms * 1000);
+}
+
+uint64_t HostNextTimerMicros() {
+  std::lock_guard<std::recursive_mutex> lock(timers_mutex);
+  uint64_t next_us = UINT64_MAX;
+  for (HostTimer* timer : timers)
+    if(timer->armed)
+      next_us = min(next_us, timer->due_us);
+  return next_us;
+}
+
+unsigned long millis() {
+  return (unsigned long)(now_us.load() / 1000);
+}
+
+unsigned long micros() {
+  return (unsigned long)now_us.load();
+}
+
+int64_t esp_timer_get_time() {
+  return (int64_t)now_us.load();
+}
+
+// WAIT RUNNER
+
+static void (*wait_runner)() = NULL;
+static thread_local bool in_wait_runner = false;
+
+void HostSetWaitRunner(void (*runner)()) {
+  wait_runner = runner;
+}
+
+uint64_t HostRunWaitRunner() {
+  if(wait_runner == NULL || in_wait_runner)
+    return 0;
+  uint64_t start_us = now_us.load();
+  in_wait_runner = true;
+  wait_runner();
+  in_wait_runner = false;
+  return now_us.load() - start_us;
+}
+
+void delay(unsigned long ms) {
+  uint64_t spent_us = HostRunWaitRunner();
+  if(spent_us < (uint64_t)ms * 1000)
+    HostAdvanceMicros((uint64_t)ms * 1000 - spent_us);
+  std::this_thread::yield();
+}
+
+void delayMicroseconds(unsigned int us) {
+  HostAdvanceMicros(us);
+}
+
+void yield() {
+  std::this_thread::yield();
+}
+
+// GPIO
+
+static const int kPins = 64;
+static int pin_input[kPins];
+static int pin_output[kPins];
+static int pin_mode[kPins];
+static int pin_analog[kPins];
+static void (*pin_isr[kPins])() = {};
+static int pin_isr_mode[kPins] = {};
+static bool pins_initialized = false;
+
+static void InitPins() {
+  if(pins_initialized) return;
+  for (int i = 0; i < kPins; i++) {
+    pin_input[i] = -1;
+    pin_output[i] = -1;
+    pin_mode[i] = INPUT;
+    pin_analog[i] = 0;
+  }
+  pins_initialized = true;
+}
+
+static bool ValidPin(int pin) {
+  InitPins();
+  return pin >= 0 && pin < kPins;
+}
+
+void pinMode(int pin, int mode) {
+  if(ValidPin(pin)) pin_mode[pin] = mode;
+}
+
+void digitalWrite(int pin, int level) {
+  if(ValidPin(pin)) pin_output[pin] = (level ? HIGH : LOW);
+}
+
+int digitalRead(int pin) {
+  if(!ValidPin(pin)) return LOW;
+  if(pin_mode[pin] == OUTPUT)
+    return (pin_output[pin] == HIGH ? HIGH : LOW);
+  if(pin_input[pin] < 0)
+    return (pin_mode[pin] == INPUT_PULLUP ? HIGH : LOW);
+  return pin_input[pin];
+}
+
+int analogRead(int pin) {
+  return (ValidPin(pin) ? pin_analog[pin] : 0);
+}
+
+void analogWrite(int pin, int value) {
+  if(ValidPin(pin)) pin_output[pin] = value;
+}
+
+void analogReadResolution(int bits) {}
+
+void attachInterrupt(int interrupt, void (*isr)(), int mode) {
+  if(!ValidPin(interrupt)) return;
+  pin_isr[interrupt] = isr;
+  pin_isr_mode[interrupt] = mode;
+}
+
+void detachInterrupt(int interrupt) {
+  if(ValidPin(interrupt)) pin_isr[interrupt] = NULL;
+}
+
+void noInterrupts() {}
+void interrupts() {}
+
+void HostSetPin(int pin, int level) {
+  if(!ValidPin(pin)) return;
+  int old_level = digitalRead(pin);
+  pin_input[pin] = (level ? HIGH : LOW);
+  if(pin_isr[pin] == NULL || old_level == pin_input[pin])
+    return;
+  int mode = pin_isr_mode[pin];
+  if(mode == CHANGE || (mode == RISING && pin_input[pin] == HIGH) || (mode == FALLING && pin_input[pin] == LOW))
+    pin_isr[pin]();
+}
+
+int HostPinOutput(int pin) {
+  return (ValidPin(pin) ? pin_output[pin] : -1);
+}
+
+void HostSetAnalog(int pin, int value) {
+  if(ValidPin(pin)) pin_analog[pin] = value;
+}
+
+// TOUCH
+
+TS_Point host_touch_point = { 0, 0, 0 };
+
+void HostTouch(int16_t raw_x, int16_t raw_y, int16_t z) {
+  host_touch_point = { raw_x, raw_y, z };
+}
+
+void tone(int pin, unsigned int frequency, unsigned long duration) {}
+void noTone(int pin) {}
+
+// RANDOM
+
+static std::mt19937 rng(1);
+
+long random(long max_value) {
+  return (max_value <= 0 ? 0 : (long)(rng() % (unsigned long)max_value));
+}
+
+long random(long min_value, long max_value) {
+  return (max_value <= min_value ? min_value : min_value + random(max_value - min_value));
+}
+
+void randomSeed(unsigned long seed) {
+  rng.seed(seed);
+}
+
+// STRING, PRINT AND STREAM
+
+String::String(double value, unsigned int decimals) {
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+  assign(buffer);
+}
+
+void String::trim() {
+  size_t start = find_first_not_of(" \t\r\n");
+  size_t end = find_last_not_of(" \t\r\n");
+  if(start == npos) clear();
+  else assign(substr(start, end - start + 1));
+}
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+  size_t n = 0;
+  while(size--)
+    n += write(*buffer++);
+  return n;
+}
+
+size_t Print::print(long value, int base) {
+  if(base == DEC) {
+    char buffer[24];
+    snprintf(buffer, sizeof(buffer), "%ld", value);
+    return write(buffer);
+  }
+  return print((unsigned long)value, base);
+}
+
+size_t Print::print(unsigned long value, int base) {
+  char buffer[72];
+  char* c = buffer + sizeof(buffer) - 1;
+  *c = '\0';
+  if(base < 2) base = DEC;
+  do {
+    int digit = value % base;
+    *--c = (digit < 10 ? '0' + digit : 'A' + digit - 10);
+    value /= base;
+  } while(value > 0);
+  return write(c);
+}
+
+size_t Print::print(double value, int decimals) {
+  char buffer[48];
+  snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+  return write(buffer);
+}
+
+size_t Print::printf(const char* format, ...) {
+  char buffer[256];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  if(length < 0)
+    return 0;
+  if((size_t)length < sizeof(buffer))
+    return write((const uint8_t*)buffer, length);
+  std::string long_buffer(length + 1, '\0');
+  va_start(args, format);
+  vsnprintf(&long_buffer[0], length + 1, format, args);
+  va_end(args);
+  return write((const uint8_t*)long_buffer.data(), length);
+}
+
+size_t Stream::readBytes(uint8_t* buffer, size_t length) {
+  size_t n = 0;
+  while(n < length && available() > 0)
+    buffer[n++] = read();
+  return n;
+}
+
+String Stream::readString() {
+  String text;
+  while(available() > 0)
+    text += (char)read();
+  return text;
+}
+
+String Stream::readStringUntil(char terminator) {
+  String text;
+  while(available() > 0) {
+    char c = read();
+    if(c == terminator) break;
+    text += c;
+  }
+  return text;
+}
+
+long Stream::parseInt() {
+  while(available() > 0 && peek() != '-' && (peek() < '0' || peek() > '9'))
+    read();
+  bool negative = (available() > 0 && peek() == '-');
+  if(negative) read();
+  long value = 0;
+  while(available() > 0 && peek() >= '0' && peek() <= '9')
+    value = value * 10 + (read() - '0');
+  return (negative ? -value : value);
+}
+
+// SERIAL
+
+HardwareSerial Serial;
+
+static std::mutex serial_mutex;
+static bool serial_echo = false;
+static std::string serial_output;
+static std::string serial_input;
+static const size_t kSerialOutputMax = 1 << 20;
+
+void HostSetSerialEcho(bool echo) {
+  serial_echo = echo;
+}
+
+void HostSerialInput(const char* text) {
+  std::lock_guard<std::mutex> lock(serial_mutex);
+  serial_input += text;
+}
+
+std::string HostTakeSerialOutput() {
+  std::lock_guard<std::mutex> lock(serial_mutex);
+  std::string output;
+  output.swap(serial_output);
+  return output;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  std::lock_guard<std::mutex> lock(serial_mutex);
+  if(serial_echo)
+    fwrite(buffer, 1, size, stdout);
+  // keep latest output only, simulations print for days
+  if(serial_output.size() + size > kSerialOutputMax)
+    serial_output.erase(0, serial_output.size() / 2);
+  serial_output.append((const char*)buffer, size);
+  return size;
+}
+
+int HardwareSerial::available() {
+  std::lock_guard<std::mutex> lock(serial_mutex);
+  return serial_input.size();
+}
+
+int HardwareSerial::read() {
+  std::lock_guard<std::mutex> lock(serial_mutex);
+  if(serial_input.empty()) return -1;
+  int c = (uint8_t)serial_input[0];
+  serial_input.erase(0, 1);
+  return c;
+}
+
+int HardwareSerial::peek() {
+  std::lock_guard<std::mutex> lock(serial_mutex);
+  return (serial_input.empty() ? -1 : (uint8_t)serial_input[0]);
+}
+
+// ESP32 SYSTEM
+
+static uint32_t cpu_frequency_mhz = 240;
+
+uint32_t getCpuFrequencyMhz() { return cpu_frequency_mhz; }
+bool setCpuFrequencyMhz(uint32_t cpu_freq_mhz) { cpu_frequency_mhz = cpu_freq_mhz; return true; }
+uint32_t esp_get_free_heap_size() { return 180000; }
+uint32_t esp_get_minimum_free_heap_size() { return 150000; }
+
+void esp_restart() {
+  fprintf(stderr, "esp_restart() called\n");
+  exit(3);
+}
+
+// TASK WATCHDOG
+
+static uint32_t watchdog_timeout_ms = 0;
+static int watchdog_core = -1;          // core of subscribed task, -1 = none
+static uint64_t watchdog_last_reset_us = 0;
+static uint32_t watchdog_longest_gap_ms = 0;
+static uint32_t watchdog_overruns = 0;
+
+esp_err_t esp_task_wdt_init(uint32_t timeout_seconds, bool panic) {
+  watchdog_timeout_ms = timeout_seconds * 1000;
+  return ESP_OK;
+}
+
+esp_err_t esp_task_wdt_add(void* task) {
+  // NULL = calling task
+  watchdog_core = xPortGetCoreID();
+  watchdog_last_reset_us = now_us.load();
+  return ESP_OK;
+}
+
+esp_err_t esp_task_wdt_reset() {
+  // like on the ESP32, a reset from a task that is not subscribed does not feed the watchdog
+  if(watchdog_core < 0 || xPortGetCoreID() != watchdog_core)
+    return ESP_FAIL;
+  uint32_t gap_ms = (now_us.load() - watchdog_last_reset_us) / 1000;
+  watchdog_last_reset_us = now_us.load();
+  watchdog_longest_gap_ms = max(watchdog_longest_gap_ms, gap_ms);
+  if(watchdog_timeout_ms > 0 && gap_ms > watchdog_timeout_ms)
+    watchdog_overruns++;
+  return ESP_OK;
+}
+
+esp_err_t esp_task_wdt_deinit() {
+  watchdog_timeout_ms = 0;
+  watchdog_core = -1;
+  return ESP_OK;
+}
+
+uint32_t HostWatchdogTimeoutMs() { return watchdog_timeout_ms; }
+uint32_t HostWatchdogLongestGapMs() { return watchdog_longest_gap_ms; }
+uint32_t HostWatchdogOverruns() { return watchdog_overruns; }
+
+// HARDWARE TIMERS
+
+static void ArmTimer(HostTimer* timer, uint64_t delay_us, uint64_t period_us) {
+  std::lock_guard<std::recursive_mutex> lock(timers_mutex);
+  timer->due_us = now_us.load() + delay_us;
+  timer->period_us = period_us;
+  timer->armed = true;
+}
+
+static void DisarmTimer(HostTimer* timer) {
+  std::lock_guard<std::recursive_mutex> lock(timers_mutex);
+  timer->armed = false;
+}
+
+static void AddTimer(HostTimer* timer) {
+  std::lock_guard<std::recursive_mutex> lock(timers_mutex);
+  timers.push_back(timer);
+}
+
+static void RemoveTimer(HostTimer* timer) {
+  std::lock_guard<std::recursive_mutex> lock(timers_mutex);
+  timers.erase(std::remove(timers.begin(), timers.end(), timer), timers.end());
+}
+
+hw_timer_t* timerBegin(uint8_t num, uint16_t divider, bool count_up) {
+  hw_timer_t* timer = new hw_timer_t;
+  timer->divider = divider;
+  AddTimer(&timer->timer);
+  return timer;
+}
+
+void timerEnd(hw_timer_t* timer) {
+  RemoveTimer(&timer->timer);
+  delete timer;
+}
+
+void timerAttachInterrupt(hw_timer_t* timer, void (*isr)(), bool edge) {
+  timer->timer.isr = isr;
+}
+
+void timerAlarmWrite(hw_timer_t* timer, uint64_t alarm_value, bool autoreload) {
+  timer->alarm_value = alarm_value;
+  timer->autoreload = autoreload;
+}
+
+void timerAlarmEnable(hw_timer_t* timer) {
+  uint64_t period_us = TimerTicksToMicros(timer, timer->alarm_value);
+  ArmTimer(&timer->timer, period_us, (timer->autoreload ? period_us : 0));
+}
+
+void timerAlarmDisable(hw_timer_t* timer) {
+  DisarmTimer(&timer->timer);
+}
+
+void timerWrite(hw_timer_t* timer, uint64_t value) {
+  // counter restarts from value
+  if(timer->timer.armed) {
+    uint64_t period_us = TimerTicksToMicros(timer, timer->alarm_value);
+    uint64_t counted_us = TimerTicksToMicros(timer, value);
+    ArmTimer(&timer->timer, (counted_us < period_us ? period_us - counted_us : 0), timer->timer.period_us);
+  }
+}
+
+// ESP_TIMER
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* handle) {
+  esp_timer* timer = new esp_timer;
+  timer->timer.callback = args->callback;
+  timer->timer.arg = args->arg;
+  AddTimer(&timer->timer);
+  *handle = timer;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+  ArmTimer(&timer->timer, timeout_us, 0);
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period_us) {
+  ArmTimer(&timer->timer, period_us, period_us);
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+  DisarmTimer(&timer->timer);
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+  RemoveTimer(&timer->timer);
+  delete timer;
+  return ESP_OK;
+}
+
+// LEDC
+
+static const int kLedcChannels = 16;
+static uint32_t ledc_frequency[kLedcChannels] = {};
+static uint32_t ledc_duty[kLedcChannels] = {};
+static uint8_t ledc_resolution_bits[kLedcChannels] = {};
+static std::map<int, int> ledc_pin_channel;
+
+static bool LedcChannelAttached(uint8_t channel) {
+  for (auto &pin_channel : ledc_pin_channel)
+    if(pin_channel.second == channel) return true;
+  return false;
+}
+
+uint32_t ledcSetup(uint8_t channel, uint32_t frequency, uint8_t resolution_bits) {
+  if(channel >= kLedcChannels) return 0;
+  ledc_frequency[channel] = frequency;
+  ledc_resolution_bits[channel] = resolution_bits;
+  return frequency;
+}
+
+void ledcAttachPin(uint8_t pin, uint8_t channel) {
+  ledc_pin_channel[pin] = channel;
+}
+
+void ledcDetachPin(uint8_t pin) {
+  ledc_pin_channel.erase(pin);
+}
+
+void ledcWrite(uint8_t channel, uint32_t duty) {
+  if(channel < kLedcChannels) ledc_duty[channel] = duty;
+}
+
+uint32_t ledcWriteTone(uint8_t channel, uint32_t frequency) {
+  if(channel >= kLedcChannels) return 0;
+  if(ledc_resolution_bits[channel] == 0) ledc_resolution_bits[channel] = 10;
+  ledc_frequency[channel] = frequency;
+  ledc_duty[channel] = (frequency == 0 ? 0 : (1U << ledc_resolution_bits[channel]) / 2);
+  return frequency;
+}
+
+uint32_t HostLedcFrequency(uint8_t channel) {
+  if(channel >= kLedcChannels || ledc_duty[channel] == 0 || !LedcChannelAttached(channel)) return 0;
+  return ledc_frequency[channel];
+}
+
+uint32_t HostLedcDuty(uint8_t channel) {
+  return (channel < kLedcChannels ? ledc_duty[channel] : 0);
+}
+
+int HostLedcPinChannel(int pin) {
+  auto pin_channel = ledc_pin_channel.find(pin);
+  return (pin_channel == ledc_pin_channel.end() ? -1 : pin_channel->second);
+}
+
+// FREERTOS
+
+// task notification of a host thread
+struct HostTaskNotify {
+  std::mutex mutex;
+  std::condition_variable notified;
+  uint32_t count = 0;
+};
+
+static thread_local HostTaskNotify task_notify;
+static std::map<std::string, void (*)(void*)> created_tasks;
+
+BaseType_t xTaskCreatePinnedToCore(void (*task)(void*), const char* name, uint32_t stack_depth, void* parameter, UBaseType_t priority, TaskHandle_t* handle, BaseType_t core_id) {
+  created_tasks[name] = task;
+  if(handle != NULL)
+    *handle = (TaskHandle_t)task;
+  return pdPASS;
+}
+
+void (*HostCreatedTask(const char* name))(void*) {
+  auto task = created_tasks.find(name);
+  return (task == created_tasks.end() ? NULL : task->second);
+}
+
+void vTaskDelay(TickType_t ticks) {
+  delay(ticks);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  return &task_notify;
+}
+
+BaseType_t xPortGetCoreID() {
+  return (in_wait_runner ? 0 : 1);
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  HostTaskNotify* notify = (HostTaskNotify*)task;
+  {
+    std::lock_guard<std::mutex> lock(notify->mutex);
+    notify->count++;
+  }
+  notify->notified.notify_all();
+  return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higher_priority_task_woken) {
+  xTaskNotifyGive(task);
+}
+
+static uint32_t TakeNotification(BaseType_t clear_on_exit) {
+  uint32_t count = task_notify.count;
+  if(count > 0)
+    task_notify.count = (clear_on_exit ? 0 : count - 1);
+  return count;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait) {
+  if(wait_runner != NULL && !in_wait_runner) {
+    // single threaded simulation: other core runs until it notifies or wait times out
+    uint64_t wait_start_us = now_us.load();
+    while(true) {
+      {
+        std::lock_guard<std::mutex> lock(task_notify.mutex);
+        uint32_t count = TakeNotification(clear_on_exit);
+        if(count > 0 || now_us.load() - wait_start_us >= (uint64_t)ticks_to_wait * 1000)
+          return count;
+      }
+      if(HostRunWaitRunner() == 0)
+        HostAdvanceMicros(1000);
+    }
+  }
+  std::unique_lock<std::mutex> lock(task_notify.mutex);
+  auto has_notification = []{ return task_notify.count > 0; };
+  if(ticks_to_wait == portMAX_DELAY)
+    task_notify.notified.wait(lock, has_notification);
+  else
+    task_notify.notified.wait_for(lock, std::chrono::milliseconds(ticks_to_wait), has_notification);
+  return TakeNotification(clear_on_exit);
+}
+
+void portENTER_CRITICAL(portMUX_TYPE* mux) {
+  while(mux->locked.exchange(1, std::memory_order_acquire))
+    std::this_thread::yield();
+}
+
+void portEXIT_CRITICAL(portMUX_TYPE* mux) {
+  mux->locked.store(0, std::memory_order_release);
+}
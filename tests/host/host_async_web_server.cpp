@@ -0,0 +1,250 @@
+#include "host.h"
+#include <ESPAsyncWebServer.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <mutex>
+
+static std::recursive_mutex servers_mutex;
+static std::vector<AsyncWebServer*> servers;
+
+bool HostPollWebServers() {
+  std::lock_guard<std::recursive_mutex> lock(servers_mutex);
+  bool served = false;
+  // a handler may stop its server, poll a copy
+  std::vector<AsyncWebServer*> polled = servers;
+  for (AsyncWebServer* server : polled)
+    if(std::find(servers.begin(), servers.end(), server) != servers.end())
+      served |= server->Poll();
+  return served;
+}
+
+uint16_t HostWebServerPort() {
+  std::lock_guard<std::recursive_mutex> lock(servers_mutex);
+  return (servers.empty() ? 0 : servers.back()->HostPort());
+}
+
+// REQUEST
+
+AsyncWebServerRequest::~AsyncWebServerRequest() {
+  for (AsyncWebParameter* param : params_)
+    delete param;
+  delete response_;
+}
+
+void AsyncWebServerRequest::send(AsyncWebServerResponse* response) {
+  delete response_;
+  response_ = response;
+}
+
+AsyncWebParameter* AsyncWebServerRequest::getParam(const String &name, bool post, bool file) const {
+  for (AsyncWebParameter* param : params_)
+    if(param->name() == name)
+      return param;
+  return NULL;
+}
+
+const String &AsyncWebServerRequest::header(const char* name) const {
+  static const String kEmpty;
+  auto header = headers_.find(Lower(name));
+  return (header == headers_.end() ? kEmpty : header->second);
+}
+
+String AsyncWebServerRequest::Lower(const char* text) {
+  String lower(text);
+  for (char &c : lower)
+    c = tolower(c);
+  return lower;
+}
+
+static String UrlDecode(const std::string &text) {
+  String decoded;
+  for (size_t i = 0; i < text.size(); i++) {
+    if(text[i] == '+')
+      decoded += ' ';
+    else if(text[i] == '%' && i + 2 < text.size()) {
+      decoded += (char)strtol(text.substr(i + 1, 2).c_str(), NULL, 16);
+      i += 2;
+    }
+    else
+      decoded += text[i];
+  }
+  return decoded;
+}
+
+// SERVER
+
+AsyncWebServer::AsyncWebServer(uint16_t port) {}
+
+AsyncWebServer::~AsyncWebServer() {
+  end();
+  for (AsyncCallbackWebHandler* handler : callback_handlers_)
+    delete handler;
+  for (AsyncWebHandler* handler : handlers_)
+    delete handler;
+}
+
+void AsyncWebServer::begin() {
+  if(listen_fd_ >= 0) return;
+  listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = 0;
+  socklen_t address_length = sizeof(address);
+  if(bind(listen_fd_, (sockaddr*)&address, sizeof(address)) != 0 || listen(listen_fd_, 8) != 0
+      || getsockname(listen_fd_, (sockaddr*)&address, &address_length) != 0) {
+    perror("AsyncWebServer::begin()");
+    close(listen_fd_);
+    listen_fd_ = -1;
+    return;
+  }
+  fcntl(listen_fd_, F_SETFL, O_NONBLOCK);
+  port_ = ntohs(address.sin_port);
+  std::lock_guard<std::recursive_mutex> lock(servers_mutex);
+  servers.push_back(this);
+}
+
+void AsyncWebServer::end() {
+  {
+    std::lock_guard<std::recursive_mutex> lock(servers_mutex);
+    servers.erase(std::remove(servers.begin(), servers.end(), this), servers.end());
+  }
+  for (Connection &connection : connections_)
+    close(connection.fd);
+  connections_.clear();
+  if(listen_fd_ >= 0)
+    close(listen_fd_);
+  listen_fd_ = -1;
+  port_ = 0;
+}
+
+AsyncCallbackWebHandler &AsyncWebServer::on(const char* uri, WebRequestMethod method, ArRequestHandlerFunction on_request, ArUploadHandlerFunction on_upload, ArBodyHandlerFunction on_body) {
+  AsyncCallbackWebHandler* handler = new AsyncCallbackWebHandler;
+  handler->uri_ = uri;
+  handler->method_ = method;
+  handler->on_request_ = on_request;
+  handler->on_body_ = on_body;
+  callback_handlers_.push_back(handler);
+  return *handler;
+}
+
+AsyncWebHandler &AsyncWebServer::addHandler(AsyncWebHandler* handler) {
+  handlers_.push_back(handler);
+  return *handler;
+}
+
+// accepts connections and serves requests that have fully arrived, returns true if any was served
+bool AsyncWebServer::Poll() {
+  if(listen_fd_ < 0) return false;
+  int fd;
+  while((fd = accept(listen_fd_, NULL, NULL)) >= 0) {
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+    connections_.push_back({ fd, "" });
+  }
+  bool served = false;
+  for (size_t i = 0; i < connections_.size(); ) {
+    Connection &connection = connections_[i];
+    char buffer[4096];
+    ssize_t length;
+    while((length = recv(connection.fd, buffer, sizeof(buffer), 0)) > 0)
+      connection.received.append(buffer, length);
+    bool done = (length == 0);    // peer closed before a whole request
+    if(!done && Serve(connection)) {
+      served = true;
+      done = true;
+    }
+    if(!done) {
+      i++;
+      continue;
+    }
+    close(connection.fd);
+    connections_.erase(connections_.begin() + i);
+    if(listen_fd_ < 0) break;     // stopped by a handler
+  }
+  return served;
+}
+
+// runs handlers once request head and body are in, returns false if request is not complete yet
+bool AsyncWebServer::Serve(Connection &connection) {
+  size_t head_end = connection.received.find("\r\n\r\n");
+  if(head_end == std::string::npos) return false;
+
+  AsyncWebServerRequest request;
+  std::string head = connection.received.substr(0, head_end);
+  size_t line_end = head.find("\r\n");
+  std::string request_line = head.substr(0, line_end);
+  size_t method_end = request_line.find(' '), target_end = request_line.rfind(' ');
+  std::string method = request_line.substr(0, method_end);
+  std::string target = request_line.substr(method_end + 1, target_end - method_end - 1);
+  static const std::pair<const char*, WebRequestMethod> kMethods[] = {
+    { "GET", HTTP_GET }, { "POST", HTTP_POST }, { "DELETE", HTTP_DELETE }, { "PUT", HTTP_PUT },
+    { "PATCH", HTTP_PATCH }, { "HEAD", HTTP_HEAD }, { "OPTIONS", HTTP_OPTIONS } };
+  for (auto &known_method : kMethods)
+    if(method == known_method.first)
+      request.method_ = known_method.second;
+
+  size_t query_start = target.find('?');
+  request.url_ = UrlDecode(target.substr(0, query_start));
+  if(query_start != std::string::npos) {
+    std::string query = target.substr(query_start + 1);
+    for (size_t start = 0; start <= query.size(); ) {
+      size_t end = query.find('&', start);
+      if(end == std::string::npos) end = query.size();
+      std::string pair = query.substr(start, end - start);
+      size_t equals = pair.find('=');
+      if(!pair.empty())
+        request.params_.push_back(new AsyncWebParameter(UrlDecode(pair.substr(0, equals)), (equals == std::string::npos ? String() : UrlDecode(pair.substr(equals + 1)))));
+      start = end + 1;
+    }
+  }
+
+  while(line_end != std::string::npos && line_end < head.size()) {
+    size_t next_end = head.find("\r\n", line_end + 2);
+    std::string line = head.substr(line_end + 2, (next_end == std::string::npos ? std::string::npos : next_end - line_end - 2));
+    size_t colon = line.find(':');
+    if(colon != std::string::npos) {
+      size_t value_start = line.find_first_not_of(' ', colon + 1);
+      request.headers_[AsyncWebServerRequest::Lower(line.substr(0, colon).c_str())] = (value_start == std::string::npos ? "" : line.substr(value_start));
+    }
+    line_end = next_end;
+  }
+
+  size_t content_length = atol(request.header("Content-Length").c_str());
+  if(connection.received.size() < head_end + 4 + content_length) return false;
+  std::string body = connection.received.substr(head_end + 4, content_length);
+
+  AsyncCallbackWebHandler* matched = NULL;
+  for (AsyncCallbackWebHandler* handler : callback_handlers_)
+    if(handler->uri_ == request.url_ && (handler->method_ & request.method_))
+      matched = (matched == NULL ? handler : matched);
+  if(matched != NULL) {
+    if(matched->on_body_ && !body.empty())
+      for (size_t index = 0; index < body.size(); index += kBodyChunkSize)
+        matched->on_body_(&request, (uint8_t*)body.data() + index, min(kBodyChunkSize, body.size() - index), index, body.size());
+    matched->on_request_(&request);
+  }
+  else if(not_found_)
+    not_found_(&request);
+  if(request.response_ == NULL)
+    request.send(404, "text/plain", "Not found");
+
+  AsyncWebServerResponse* response = request.response_;
+  std::string reply = "HTTP/1.1 " + std::to_string(response->code_) + (response->code_ < 300 ? " OK" : " Error") + "\r\n";
+  reply += "Content-Type: " + response->content_type_ + "\r\n";
+  reply += "Content-Length: " + std::to_string(response->content_.size()) + "\r\n";
+  for (auto &header : response->headers_)
+    reply += header.first + ": " + header.second + "\r\n";
+  reply += "Connection: close\r\n\r\n";
+  reply += response->content_;
+  // small replies over loopback, socket buffer takes them whole
+  fcntl(connection.fd, F_SETFL, 0);
+  for (size_t sent = 0; sent < reply.size(); ) {
+    ssize_t length = ::send(connection.fd, reply.data() + sent, reply.size() - sent, MSG_NOSIGNAL);
+    if(length <= 0) break;
+    sent += length;
+  }
+  return true;
+}
@@ -0,0 +1,105 @@
+#include <uRTCLib.h>
+#include <mutex>
+
+TwoWire Wire;
+
+// DS3231 time registers, hour is kept as 24 hour and converted on read
+struct Ds3231Registers {
+  uint8_t second = 0, minute = 0, hour_24 = 0, day_of_week = 1, day = 1, month = 1, year = 0;
+  bool twelve_hour_mode = false;
+  bool lost_power = true;
+};
+
+static std::mutex ds3231_mutex;
+static Ds3231Registers ds3231;
+
+static uint8_t DaysInMonth(uint8_t month, uint8_t year) {
+  if(month == 2)
+    return (year % 4 == 0 ? 29 : 28);
+  if(month == 4 || month == 6 || month == 9 || month == 11)
+    return 30;
+  return 31;
+}
+
+void HostDs3231Set(uint8_t second, uint8_t minute, uint8_t hour_24, uint8_t day_of_week, uint8_t day, uint8_t month, uint8_t year) {
+  std::lock_guard<std::mutex> lock(ds3231_mutex);
+  ds3231.second = second;
+  ds3231.minute = minute;
+  ds3231.hour_24 = hour_24;
+  ds3231.day_of_week = day_of_week;
+  ds3231.day = day;
+  ds3231.month = month;
+  ds3231.year = year;
+  ds3231.lost_power = false;
+}
+
+void HostDs3231Tick() {
+  std::lock_guard<std::mutex> lock(ds3231_mutex);
+  if(++ds3231.second < 60) return;
+  ds3231.second = 0;
+  if(++ds3231.minute < 60) return;
+  ds3231.minute = 0;
+  if(++ds3231.hour_24 < 24) return;
+  ds3231.hour_24 = 0;
+  ds3231.day_of_week = ds3231.day_of_week % 7 + 1;
+  if(++ds3231.day <= DaysInMonth(ds3231.month, ds3231.year)) return;
+  ds3231.day = 1;
+  if(++ds3231.month <= 12) return;
+  ds3231.month = 1;
+  ds3231.year = (ds3231.year + 1) % 100;
+}
+
+void HostDs3231SetLostPower(bool lost_power) {
+  std::lock_guard<std::mutex> lock(ds3231_mutex);
+  ds3231.lost_power = lost_power;
+}
+
+uint32_t HostDs3231Seconds() {
+  std::lock_guard<std::mutex> lock(ds3231_mutex);
+  uint32_t days = 0;
+  for (uint8_t y = 0; y < ds3231.year; y++)
+    days += (y % 4 == 0 ? 366 : 365);
+  for (uint8_t m = 1; m < ds3231.month; m++)
+    days += DaysInMonth(m, ds3231.year);
+  days += ds3231.day - 1;
+  return ((days * 24 + ds3231.hour_24) * 60 + ds3231.minute) * 60 + ds3231.second;
+}
+
+bool uRTCLib::refresh() {
+  std::lock_guard<std::mutex> lock(ds3231_mutex);
+  second_ = ds3231.second;
+  minute_ = ds3231.minute;
+  day_of_week_ = ds3231.day_of_week;
+  day_ = ds3231.day;
+  month_ = ds3231.month;
+  year_ = ds3231.year;
+  if(!ds3231.twelve_hour_mode) {
+    hour_ = ds3231.hour_24;
+    hour_mode_and_am_pm_ = 0;
+  }
+  else {
+    hour_ = (ds3231.hour_24 % 12 == 0 ? 12 : ds3231.hour_24 % 12);
+    hour_mode_and_am_pm_ = (ds3231.hour_24 < 12 ? 1 : 2);
+  }
+  return true;
+}
+
+void uRTCLib::set(uint8_t second, uint8_t minute, uint8_t hour, uint8_t day_of_week, uint8_t day, uint8_t month, uint8_t year) {
+  HostDs3231Set(second, minute, hour, day_of_week, day, month, year);
+  std::lock_guard<std::mutex> lock(ds3231_mutex);
+  ds3231.twelve_hour_mode = false;
+}
+
+void uRTCLib::set_12hour_mode(bool twelve_hour_mode) {
+  std::lock_guard<std::mutex> lock(ds3231_mutex);
+  ds3231.twelve_hour_mode = twelve_hour_mode;
+}
+
+bool uRTCLib::lostPower() {
+  std::lock_guard<std::mutex> lock(ds3231_mutex);
+  return ds3231.lost_power;
+}
+
+void uRTCLib::lostPowerClear() {
+  HostDs3231SetLostPower(false);
+}
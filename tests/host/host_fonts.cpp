@@ -0,0 +1,66 @@
+#include <Adafruit_GFX.h>
+#include <Fonts/ComingSoon_Regular70pt7b.h>
+#include <Fonts/FreeSansBold48pt7b.h>
+#include <Fonts/Satisfy_Regular24pt7b.h>
+#include <Fonts/FreeSansBold24pt7b.h>
+#include <Fonts/FreeSans24pt7b.h>
+#include <Fonts/FreeSans18pt7b.h>
+#include <Fonts/Satisfy_Regular18pt7b.h>
+#include <Fonts/FreeSansBold12pt7b.h>
+#include <Fonts/FreeSans12pt7b.h>
+#include <Fonts/FreeMonoBold9pt7b.h>
+#include <Fonts/FreeMono9pt7b.h>
+
+// The clock's fonts are not in this tree. These stand-ins have the size, advance and bounds of the
+// real ones within a few pixels, as made by fontconvert at 141 dpi, so layout, text bounds and the
+// number of pixels drawn are close. Glyph bitmaps are all one striped pattern.
+
+static uint8_t glyph_pattern[4096];
+
+// proportional width of a character, in em
+static float Advance(char c, float digit_advance, bool mono) {
+  if(mono) return 0.6f;
+  if(c >= '0' && c <= '9') return digit_advance;
+  if(c == ' ' || c == ':' || c == '.' || c == ',' || c == ';' || c == '!' || c == '\'' || c == '|') return 0.278f;
+  if(c >= 'A' && c <= 'Z') return (c == 'M' || c == 'W' ? 0.833f : (c == 'I' ? 0.278f : 0.667f));
+  if(c >= 'a' && c <= 'z') return (c == 'm' || c == 'w' ? 0.778f : (c == 'i' || c == 'j' || c == 'l' ? 0.222f : 0.5f));
+  return 0.4f;
+}
+
+static GFXfont MakeFont(int points, float digit_advance, float width_scale, bool mono) {
+  if(glyph_pattern[0] == 0)
+    for (size_t i = 0; i < sizeof(glyph_pattern); i++)
+      glyph_pattern[i] = (i % 3 == 0 ? 0x7E : 0x3C);
+
+  float em = points * 141.0f / 72;
+  GFXglyph* glyphs = new GFXglyph[0x7E - 0x20 + 1];
+  for (char c = 0x20; c <= 0x7E; c++) {
+    GFXglyph &glyph = glyphs[c - 0x20];
+    float advance = Advance(c, digit_advance, mono) * width_scale * em;
+    float top = 0.72f, bottom = 0;    // in em above baseline, cap height by default
+    if(c >= 'a' && c <= 'z') top = (strchr("bdfhklt", c) != NULL ? 0.74f : 0.52f);
+    if(strchr("gjpqy,;", c) != NULL) bottom = -0.2f;
+    if(c == ':' || c == ';') top = 0.52f;
+    if(c == '-') { top = 0.33f; bottom = 0.25f; }
+    if(c == '.' || c == ',') top = 0.1f;
+    glyph.bitmapOffset = 0;
+    glyph.xAdvance = (uint8_t)(advance + 0.5f);
+    glyph.xOffset = (int8_t)(advance * 0.07f + 0.5f);
+    glyph.width = (c == ' ' ? 0 : max(1, (int)(advance * 0.86f)));
+    glyph.height = (c == ' ' ? 0 : max(1, (int)((top - bottom) * em)));
+    glyph.yOffset = (int8_t)-(int)(top * em);
+  }
+  return { glyph_pattern, glyphs, 0x20, 0x7E, (uint8_t)(em * 1.17f + 0.5f) };
+}
+
+const GFXfont ComingSoon_Regular70pt7b = MakeFont(70, 0.5f, 1.0f, false);
+const GFXfont FreeSansBold48pt7b = MakeFont(48, 0.556f, 1.05f, false);
+const GFXfont Satisfy_Regular24pt7b = MakeFont(24, 0.45f, 0.9f, false);
+const GFXfont FreeSansBold24pt7b = MakeFont(24, 0.556f, 1.05f, false);
+const GFXfont FreeSans24pt7b = MakeFont(24, 0.556f, 1.0f, false);
+const GFXfont FreeSans18pt7b = MakeFont(18, 0.556f, 1.0f, false);
+const GFXfont Satisfy_Regular18pt7b = MakeFont(18, 0.45f, 0.9f, false);
+const GFXfont FreeSansBold12pt7b = MakeFont(12, 0.556f, 1.05f, false);
+const GFXfont FreeSans12pt7b = MakeFont(12, 0.556f, 1.0f, false);
+const GFXfont FreeMonoBold9pt7b = MakeFont(9, 0.6f, 1.0f, true);
+const GFXfont FreeMono9pt7b = MakeFont(9, 0.6f, 1.0f, true);
@@ -0,0 +1,497 @@
+#include "host.h"
+#include <Adafruit_GFX.h>
+
+// Cost model, from README measurements on a 240 MHz ESP32 with SPI at 80 MHz: a full 320x240 frame
+// by FastDrawTwoColorBitmapSpi() takes 50 ms, 0.2 us per pixel of SPI and 0.45 us of row conversion
+// and SPI driver, and a 40% sized screensaver canvas is drawn in 7 ms, mostly glyph pixels.
+// Every drawing call to the TFT also pays for its address window.
+static const double kTftWindowCpuUs = 1.5;
+static const double kTftPixelCpuUs = 0.02;
+static const double kTftStreamPixelCpuUs = 0.45;
+static const double kCanvasPixelCpuUs = 0.5;
+static const double kCanvasSpanPixelCpuUs = 0.01;
+
+static double pending_us = 0;
+
+static void Spend(double us) {
+  pending_us += us;
+  if(pending_us >= 1) {
+    uint64_t whole_us = (uint64_t)pending_us;
+    pending_us -= whole_us;
+    HostAdvanceMicros(whole_us);
+  }
+}
+
+void HostGfxSpendCpu(double us_at_240_mhz) {
+  Spend(us_at_240_mhz * 240 / getCpuFrequencyMhz());
+}
+
+// ADAFRUIT_GFX
+
+Adafruit_GFX::Adafruit_GFX(int16_t w, int16_t h) : WIDTH(w), HEIGHT(h), _width(w), _height(h) {}
+
+void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  for (int16_t i = 0; i < w; i++)
+    drawPixel(x + i, y, color);
+}
+
+void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  fillRect(x, y, 1, h, color);
+}
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  for (int16_t j = 0; j < h; j++)
+    drawFastHLine(x, y + j, w, color);
+}
+
+void Adafruit_GFX::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+  if(y0 == y1) {
+    if(x1 < x0) std::swap(x0, x1);
+    drawFastHLine(x0, y0, x1 - x0 + 1, color);
+    return;
+  }
+  if(x0 == x1) {
+    if(y1 < y0) std::swap(y0, y1);
+    drawFastVLine(x0, y0, y1 - y0 + 1, color);
+    return;
+  }
+  bool steep = abs(y1 - y0) > abs(x1 - x0);
+  if(steep) { std::swap(x0, y0); std::swap(x1, y1); }
+  if(x0 > x1) { std::swap(x0, x1); std::swap(y0, y1); }
+  int16_t dx = x1 - x0, dy = abs(y1 - y0), err = dx / 2, ystep = (y0 < y1 ? 1 : -1);
+  for (; x0 <= x1; x0++) {
+    if(steep) drawPixel(y0, x0, color);
+    else drawPixel(x0, y0, color);
+    err -= dy;
+    if(err < 0) { y0 += ystep; err += dx; }
+  }
+}
+
+void Adafruit_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  drawFastHLine(x, y, w, color);
+  drawFastHLine(x, y + h - 1, w, color);
+  drawFastVLine(x, y, h, color);
+  drawFastVLine(x + w - 1, y, h, color);
+}
+
+void Adafruit_GFX::drawCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t corners, uint16_t color) {
+  int16_t f = 1 - r, ddF_x = 1, ddF_y = -2 * r, x = 0, y = r;
+  while(x < y) {
+    if(f >= 0) { y--; ddF_y += 2; f += ddF_y; }
+    x++; ddF_x += 2; f += ddF_x;
+    if(corners & 0x4) { drawPixel(x0 + x, y0 + y, color); drawPixel(x0 + y, y0 + x, color); }
+    if(corners & 0x2) { drawPixel(x0 + x, y0 - y, color); drawPixel(x0 + y, y0 - x, color); }
+    if(corners & 0x8) { drawPixel(x0 - y, y0 + x, color); drawPixel(x0 - x, y0 + y, color); }
+    if(corners & 0x1) { drawPixel(x0 - y, y0 - x, color); drawPixel(x0 - x, y0 - y, color); }
+  }
+}
+
+void Adafruit_GFX::drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+  drawPixel(x0, y0 + r, color);
+  drawPixel(x0, y0 - r, color);
+  drawPixel(x0 + r, y0, color);
+  drawPixel(x0 - r, y0, color);
+  drawCircleHelper(x0, y0, r, 0xF, color);
+}
+
+// vertical spans of right (corners & 1) and left (corners & 2) halves, stretched by delta
+void Adafruit_GFX::fillCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t corners, int16_t delta, uint16_t color) {
+  int16_t f = 1 - r, ddF_x = 1, ddF_y = -2 * r, x = 0, y = r, px = x, py = y;
+  delta++;
+  while(x < y) {
+    if(f >= 0) { y--; ddF_y += 2; f += ddF_y; }
+    x++; ddF_x += 2; f += ddF_x;
+    if(x < (y + 1)) {
+      if(corners & 1) drawFastVLine(x0 + x, y0 - y, 2 * y + delta, color);
+      if(corners & 2) drawFastVLine(x0 - x, y0 - y, 2 * y + delta, color);
+    }
+    if(y != py) {
+      if(corners & 1) drawFastVLine(x0 + py, y0 - px, 2 * px + delta, color);
+      if(corners & 2) drawFastVLine(x0 - py, y0 - px, 2 * px + delta, color);
+      py = y;
+    }
+    px = x;
+  }
+}
+
+void Adafruit_GFX::fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+  drawFastVLine(x0, y0 - r, 2 * r + 1, color);
+  fillCircleHelper(x0, y0, r, 3, 0, color);
+}
+
+void Adafruit_GFX::drawRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color) {
+  r = min(r, (int16_t)(min(w, h) / 2));
+  drawFastHLine(x + r, y, w - 2 * r, color);
+  drawFastHLine(x + r, y + h - 1, w - 2 * r, color);
+  drawFastVLine(x, y + r, h - 2 * r, color);
+  drawFastVLine(x + w - 1, y + r, h - 2 * r, color);
+  drawCircleHelper(x + r, y + r, r, 1, color);
+  drawCircleHelper(x + w - r - 1, y + r, r, 2, color);
+  drawCircleHelper(x + w - r - 1, y + h - r - 1, r, 4, color);
+  drawCircleHelper(x + r, y + h - r - 1, r, 8, color);
+}
+
+void Adafruit_GFX::fillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color) {
+  r = min(r, (int16_t)(min(w, h) / 2));
+  fillRect(x + r, y, w - 2 * r, h, color);
+  fillCircleHelper(x + w - r - 1, y + r, r, 1, h - 2 * r - 1, color);
+  fillCircleHelper(x + r, y + r, r, 2, h - 2 * r - 1, color);
+}
+
+void Adafruit_GFX::drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color) {
+  drawLine(x0, y0, x1, y1, color);
+  drawLine(x1, y1, x2, y2, color);
+  drawLine(x2, y2, x0, y0, color);
+}
+
+void Adafruit_GFX::fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color) {
+  // sort by y, then one span per row between the long edge and the two short ones
+  if(y0 > y1) { std::swap(y0, y1); std::swap(x0, x1); }
+  if(y1 > y2) { std::swap(y2, y1); std::swap(x2, x1); }
+  if(y0 > y1) { std::swap(y0, y1); std::swap(x0, x1); }
+  for (int16_t y = y0; y <= y2; y++) {
+    int32_t a = (y2 == y0 ? x0 : x0 + (int32_t)(x2 - x0) * (y - y0) / (y2 - y0));
+    int32_t b;
+    if(y < y1 || (y == y1 && y1 == y2))
+      b = (y1 == y0 ? x1 : x0 + (int32_t)(x1 - x0) * (y - y0) / (y1 - y0));
+    else
+      b = (y2 == y1 ? x2 : x1 + (int32_t)(x2 - x1) * (y - y1) / (y2 - y1));
+    if(a > b) std::swap(a, b);
+    drawFastHLine(a, y, b - a + 1, color);
+  }
+}
+
+void Adafruit_GFX::drawBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h, uint16_t color) {
+  int16_t byte_width = (w + 7) / 8;
+  for (int16_t j = 0; j < h; j++)
+    for (int16_t i = 0; i < w; i++)
+      if(bitmap[j * byte_width + i / 8] & (0x80 >> (i & 7)))
+        drawPixel(x + i, y + j, color);
+}
+
+void Adafruit_GFX::drawBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h, uint16_t color, uint16_t bg) {
+  int16_t byte_width = (w + 7) / 8;
+  for (int16_t j = 0; j < h; j++)
+    for (int16_t i = 0; i < w; i++)
+      drawPixel(x + i, y + j, (bitmap[j * byte_width + i / 8] & (0x80 >> (i & 7)) ? color : bg));
+}
+
+void Adafruit_GFX::drawRGBBitmap(int16_t x, int16_t y, const uint16_t* bitmap, int16_t w, int16_t h) {
+  for (int16_t j = 0; j < h; j++)
+    for (int16_t i = 0; i < w; i++)
+      drawPixel(x + i, y + j, bitmap[j * w + i]);
+}
+
+// TEXT
+
+void Adafruit_GFX::setFont(const GFXfont* font) {
+  // cursor moves between top of line and baseline, as in the library
+  if(font != NULL && gfxFont == NULL) cursor_y += 6;
+  else if(font == NULL && gfxFont != NULL) cursor_y -= 6;
+  gfxFont = font;
+}
+
+void Adafruit_GFX::setRotation(uint8_t new_rotation) {
+  rotation = new_rotation & 3;
+  _width = (rotation & 1 ? HEIGHT : WIDTH);
+  _height = (rotation & 1 ? WIDTH : HEIGHT);
+}
+
+// built-in font has no glyph data here, a 5x8 pattern from the character code stands in
+static uint8_t ClassicColumn(unsigned char c, int8_t column) {
+  return (c == ' ' ? 0 : (uint8_t)((c * 0x9D + column * 0x3B) | 0x41) & 0x7F);
+}
+
+void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size_x, uint8_t size_y) {
+  if(gfxFont == NULL) {
+    for (int8_t i = 0; i < 6; i++) {
+      uint8_t line = (i < 5 ? ClassicColumn(c, i) : 0);
+      for (int8_t j = 0; j < 8; j++, line >>= 1) {
+        if(line & 1)
+          fillRect(x + i * size_x, y + j * size_y, size_x, size_y, color);
+        else if(bg != color)
+          fillRect(x + i * size_x, y + j * size_y, size_x, size_y, bg);
+      }
+    }
+    return;
+  }
+  const GFXglyph* glyph = gfxFont->glyph + (c - gfxFont->first);
+  const uint8_t* bitmap = gfxFont->bitmap + glyph->bitmapOffset;
+  uint8_t bits = 0, bit = 0;
+  for (int16_t yy = 0; yy < glyph->height; yy++) {
+    for (int16_t xx = 0; xx < glyph->width; xx++) {
+      if(!(bit++ & 7))
+        bits = *bitmap++;
+      if(bits & 0x80) {
+        if(size_x == 1 && size_y == 1)
+          drawPixel(x + glyph->xOffset + xx, y + glyph->yOffset + yy, color);
+        else
+          fillRect(x + (glyph->xOffset + xx) * size_x, y + (glyph->yOffset + yy) * size_y, size_x, size_y, color);
+      }
+      bits <<= 1;
+    }
+  }
+}
+
+size_t Adafruit_GFX::write(uint8_t c) {
+  if(gfxFont == NULL) {
+    if(c == '\n') {
+      cursor_x = 0;
+      cursor_y += textsize_y * 8;
+    }
+    else if(c != '\r') {
+      if(wrap_ && cursor_x + textsize_x * 6 > _width) {
+        cursor_x = 0;
+        cursor_y += textsize_y * 8;
+      }
+      drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize_x, textsize_y);
+      cursor_x += textsize_x * 6;
+    }
+    return 1;
+  }
+  if(c == '\n') {
+    cursor_x = 0;
+    cursor_y += textsize_y * gfxFont->yAdvance;
+  }
+  else if(c != '\r' && c >= gfxFont->first && c <= gfxFont->last) {
+    const GFXglyph* glyph = gfxFont->glyph + (c - gfxFont->first);
+    if(glyph->width > 0 && glyph->height > 0) {
+      if(wrap_ && cursor_x + textsize_x * (glyph->xOffset + glyph->width) > _width) {
+        cursor_x = 0;
+        cursor_y += textsize_y * gfxFont->yAdvance;
+      }
+      drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize_x, textsize_y);
+    }
+    cursor_x += glyph->xAdvance * textsize_x;
+  }
+  return 1;
+}
+
+void Adafruit_GFX::charBounds(unsigned char c, int16_t* x, int16_t* y, int16_t* minx, int16_t* miny, int16_t* maxx, int16_t* maxy) {
+  if(gfxFont == NULL) {
+    if(c == '\n') {
+      *x = 0;
+      *y += textsize_y * 8;
+    }
+    else if(c != '\r') {
+      if(wrap_ && *x + textsize_x * 6 > _width) {
+        *x = 0;
+        *y += textsize_y * 8;
+      }
+      int16_t x2 = *x + textsize_x * 6 - 1, y2 = *y + textsize_y * 8 - 1;
+      *minx = min(*minx, *x);
+      *miny = min(*miny, *y);
+      *maxx = max(*maxx, x2);
+      *maxy = max(*maxy, y2);
+      *x += textsize_x * 6;
+    }
+    return;
+  }
+  if(c == '\n') {
+    *x = 0;
+    *y += textsize_y * gfxFont->yAdvance;
+  }
+  else if(c != '\r' && c >= gfxFont->first && c <= gfxFont->last) {
+    const GFXglyph* glyph = gfxFont->glyph + (c - gfxFont->first);
+    if(wrap_ && *x + (glyph->xOffset + glyph->width) * textsize_x > _width) {
+      *x = 0;
+      *y += textsize_y * gfxFont->yAdvance;
+    }
+    int16_t x1 = *x + glyph->xOffset * textsize_x, y1 = *y + glyph->yOffset * textsize_y;
+    int16_t x2 = x1 + glyph->width * textsize_x - 1, y2 = y1 + glyph->height * textsize_y - 1;
+    *minx = min(*minx, x1);
+    *miny = min(*miny, y1);
+    *maxx = max(*maxx, x2);
+    *maxy = max(*maxy, y2);
+    *x += glyph->xAdvance * textsize_x;
+  }
+}
+
+void Adafruit_GFX::getTextBounds(const char* text, int16_t x, int16_t y, int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h) {
+  int16_t minx = 0x7FFF, miny = 0x7FFF, maxx = -1, maxy = -1;
+  *x1 = x;
+  *y1 = y;
+  *w = *h = 0;
+  for (const char* c = text; *c != '\0'; c++)
+    charBounds(*c, &x, &y, &minx, &miny, &maxx, &maxy);
+  if(maxx >= minx) {
+    *x1 = minx;
+    *w = maxx - minx + 1;
+  }
+  if(maxy >= miny) {
+    *y1 = miny;
+    *h = maxy - miny + 1;
+  }
+}
+
+// CANVASES
+
+GFXcanvas1::GFXcanvas1(uint16_t w, uint16_t h) : Adafruit_GFX(w, h), buffer_((w + 7) / 8 * h, 0) {}
+
+void GFXcanvas1::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  HostGfxSpendCpu(kCanvasPixelCpuUs);
+  if(x < 0 || y < 0 || x >= _width || y >= _height) return;
+  uint8_t &byte = buffer_[y * ((WIDTH + 7) / 8) + x / 8];
+  if(color) byte |= 0x80 >> (x & 7);
+  else byte &= ~(0x80 >> (x & 7));
+}
+
+void GFXcanvas1::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  if(y < 0 || y >= _height) return;
+  int16_t x2 = min((int16_t)(x + w), _width);
+  x = max(x, (int16_t)0);
+  HostGfxSpendCpu(kCanvasSpanPixelCpuUs * max(x2 - x, 0));
+  for (; x < x2; x++) {
+    uint8_t &byte = buffer_[y * ((WIDTH + 7) / 8) + x / 8];
+    if(color) byte |= 0x80 >> (x & 7);
+    else byte &= ~(0x80 >> (x & 7));
+  }
+}
+
+void GFXcanvas1::fillScreen(uint16_t color) {
+  HostGfxSpendCpu(kCanvasSpanPixelCpuUs * buffer_.size() * 8);
+  std::fill(buffer_.begin(), buffer_.end(), (color ? 0xFF : 0x00));
+}
+
+bool GFXcanvas1::getPixel(int16_t x, int16_t y) const {
+  if(x < 0 || y < 0 || x >= _width || y >= _height) return false;
+  return buffer_[y * ((WIDTH + 7) / 8) + x / 8] & (0x80 >> (x & 7));
+}
+
+GFXcanvas16::GFXcanvas16(uint16_t w, uint16_t h) : Adafruit_GFX(w, h), buffer_((size_t)w * h, 0) {}
+
+void GFXcanvas16::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  HostGfxSpendCpu(kCanvasPixelCpuUs);
+  if(x < 0 || y < 0 || x >= _width || y >= _height) return;
+  buffer_[y * WIDTH + x] = color;
+}
+
+void GFXcanvas16::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  if(y < 0 || y >= _height) return;
+  int16_t x2 = min((int16_t)(x + w), _width);
+  x = max(x, (int16_t)0);
+  HostGfxSpendCpu(kCanvasSpanPixelCpuUs * max(x2 - x, 0));
+  for (; x < x2; x++)
+    buffer_[y * WIDTH + x] = color;
+}
+
+uint16_t GFXcanvas16::getPixel(int16_t x, int16_t y) const {
+  if(x < 0 || y < 0 || x >= _width || y >= _height) return 0;
+  return buffer_[y * WIDTH + x];
+}
+
+// SPI TFT
+
+Adafruit_SPITFT::Adafruit_SPITFT(uint16_t w, uint16_t h) : Adafruit_GFX(w, h), frame_((size_t)w * h, 0) {}
+
+void Adafruit_SPITFT::Resize(uint16_t w, uint16_t h) {
+  WIDTH = w;
+  HEIGHT = h;
+  frame_.assign((size_t)w * h, 0);
+  setRotation(rotation);
+}
+
+void Adafruit_SPITFT::setRotation(uint8_t new_rotation) {
+  Adafruit_GFX::setRotation(new_rotation);
+}
+
+// pixels over SPI, and CPU time of drawing calls that each set an address window
+void Adafruit_SPITFT::Spend(uint32_t pixels, uint32_t windows) {
+  double spi_us = pixels * 16e6 / spi_frequency_;
+  spi_pixels_ += pixels;
+  spi_busy_us_ += (uint64_t)spi_us;
+  HostGfxSpendCpu(windows * kTftWindowCpuUs + pixels * kTftPixelCpuUs);
+  // SPI transfers block, at bus speed whatever the CPU frequency
+  ::Spend(spi_us);
+}
+
+void Adafruit_SPITFT::Store(int16_t x, int16_t y, uint16_t color) {
+  if(x < 0 || y < 0 || x >= _width || y >= _height) return;
+  frame_[y * _width + x] = color;
+}
+
+void Adafruit_SPITFT::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if(x < 0 || y < 0 || x >= _width || y >= _height) return;
+  Spend(1, 1);
+  Store(x, y, color);
+}
+
+void Adafruit_SPITFT::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  fillRect(x, y, w, 1, color);
+}
+
+void Adafruit_SPITFT::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  int16_t x2 = min((int16_t)(x + w), _width), y2 = min((int16_t)(y + h), _height);
+  x = max(x, (int16_t)0);
+  y = max(y, (int16_t)0);
+  if(x >= x2 || y >= y2) return;
+  Spend((uint32_t)(x2 - x) * (y2 - y), 1);
+  for (int16_t j = y; j < y2; j++)
+    std::fill(frame_.begin() + j * _width + x, frame_.begin() + j * _width + x2, color);
+}
+
+void Adafruit_SPITFT::setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+  window_x_ = x;
+  window_y_ = y;
+  window_w_ = w;
+  window_h_ = h;
+  window_index_ = 0;
+  Spend(0, 1);
+}
+
+// streamed pixels fill address window row by row, wrapping to its top as the panel does
+void Adafruit_SPITFT::writePixels(uint16_t* colors, uint32_t length, bool block, bool big_endian) {
+  uint32_t window_size = (uint32_t)window_w_ * window_h_;
+  if(window_size == 0) return;
+  HostGfxSpendCpu(length * kTftStreamPixelCpuUs);
+  Spend(length, 0);
+  StoreInWindow(colors, 0, length);
+}
+
+void Adafruit_SPITFT::writeColor(uint16_t color, uint32_t length) {
+  uint32_t window_size = (uint32_t)window_w_ * window_h_;
+  if(window_size == 0) return;
+  Spend(length, 0);
+  StoreInWindow(NULL, color, length);
+}
+
+// a window row at a time, the clock streams most of its drawing
+void Adafruit_SPITFT::StoreInWindow(const uint16_t* colors, uint16_t color, uint32_t length) {
+  uint32_t window_size = (uint32_t)window_w_ * window_h_;
+  while(length > 0) {
+    int16_t column = window_index_ % window_w_, y = window_y_ + window_index_ / window_w_;
+    uint32_t run = min(length, (uint32_t)(window_w_ - column));
+    int16_t x1 = max(window_x_ + column, 0), x2 = min(window_x_ + column + (int32_t)run, (int32_t)_width);
+    if(y >= 0 && y < _height && x1 < x2) {
+      uint16_t* row = &frame_[y * _width];
+      if(colors == NULL)
+        std::fill(row + x1, row + x2, color);
+      else
+        std::copy(colors + (x1 - window_x_ - column), colors + (x2 - window_x_ - column), row + x1);
+    }
+    if(colors != NULL) colors += run;
+    length -= run;
+    window_index_ = (window_index_ + run) % window_size;
+  }
+}
+
+uint16_t Adafruit_SPITFT::Pixel(int16_t x, int16_t y) const {
+  if(x < 0 || y < 0 || x >= _width || y >= _height) return 0;
+  return frame_[y * _width + x];
+}
+
+// binary PPM of frame as shown, black while display is off
+bool Adafruit_SPITFT::WriteScreenshot(const char* ppm_file_name) const {
+  FILE* file = fopen(ppm_file_name, "wb");
+  if(file == NULL) return false;
+  fprintf(file, "P6\n%d %d\n255\n", _width, _height);
+  for (int16_t y = 0; y < _height; y++) {
+    for (int16_t x = 0; x < _width; x++) {
+      uint16_t color = (display_on_ ? Pixel(x, y) : 0);
+      if(inverted_) color = ~color;
+      uint8_t rgb[3] = { (uint8_t)((color >> 11) * 255 / 31), (uint8_t)(((color >> 5) & 0x3F) * 255 / 63), (uint8_t)((color & 0x1F) * 255 / 31) };
+      fwrite(rgb, 1, 3, file);
+    }
+  }
+  return fclose(file) == 0;
+}
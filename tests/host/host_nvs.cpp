@@ -0,0 +1,140 @@
+#include "host.h"
+#include <Preferences.h>
+#include <nvs.h>
+#include <map>
+#include <mutex>
+#include <vector>
+
+// NVS flash as namespace/key to value bytes, values written by nvs_set_*() show only after nvs_commit()
+
+static std::recursive_mutex nvs_mutex;
+static std::map<std::string, std::vector<uint8_t>> nvs_committed;
+static uint32_t nvs_commits = 0;
+
+static std::string NvsKey(const std::string &name_space, const char* key) {
+  return name_space + '/' + key;
+}
+
+uint32_t HostNvsCommits() {
+  std::lock_guard<std::recursive_mutex> lock(nvs_mutex);
+  return nvs_commits;
+}
+
+void HostNvsErase() {
+  std::lock_guard<std::recursive_mutex> lock(nvs_mutex);
+  nvs_committed.clear();
+}
+
+bool HostNvsRead(const char* name_space, const char* key, std::vector<uint8_t> &value) {
+  std::lock_guard<std::recursive_mutex> lock(nvs_mutex);
+  auto entry = nvs_committed.find(NvsKey(name_space, key));
+  if(entry == nvs_committed.end()) return false;
+  value = entry->second;
+  return true;
+}
+
+// PREFERENCES
+
+bool Preferences::begin(const char* name_space, bool read_only) {
+  name_space_ = name_space;
+  read_only_ = read_only;
+  return true;
+}
+
+bool Preferences::isKey(const char* key) {
+  std::lock_guard<std::recursive_mutex> lock(nvs_mutex);
+  return nvs_committed.count(NvsKey(name_space_, key)) > 0;
+}
+
+bool Preferences::remove(const char* key) {
+  std::lock_guard<std::recursive_mutex> lock(nvs_mutex);
+  if(read_only_ || nvs_committed.erase(NvsKey(name_space_, key)) == 0) return false;
+  nvs_commits++;
+  return true;
+}
+
+size_t Preferences::Put(const char* key, const void* value, size_t length) {
+  if(read_only_ || name_space_.empty()) return 0;
+  std::lock_guard<std::recursive_mutex> lock(nvs_mutex);
+  nvs_committed[NvsKey(name_space_, key)].assign((const uint8_t*)value, (const uint8_t*)value + length);
+  nvs_commits++;
+  return length;
+}
+
+bool Preferences::Get(const char* key, void* value, size_t length) {
+  std::lock_guard<std::recursive_mutex> lock(nvs_mutex);
+  auto entry = nvs_committed.find(NvsKey(name_space_, key));
+  if(entry == nvs_committed.end() || entry->second.size() != length) return false;
+  memcpy(value, entry->second.data(), length);
+  return true;
+}
+
+String Preferences::getString(const char* key, const String &default_value) {
+  std::lock_guard<std::recursive_mutex> lock(nvs_mutex);
+  auto entry = nvs_committed.find(NvsKey(name_space_, key));
+  if(entry == nvs_committed.end() || entry->second.empty()) return default_value;
+  return String((const char*)entry->second.data());
+}
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t length) {
+  std::lock_guard<std::recursive_mutex> lock(nvs_mutex);
+  auto entry = nvs_committed.find(NvsKey(name_space_, key));
+  if(entry == nvs_committed.end() || entry->second.size() > length) return 0;
+  memcpy(buffer, entry->second.data(), entry->second.size());
+  return entry->second.size();
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+  std::lock_guard<std::recursive_mutex> lock(nvs_mutex);
+  auto entry = nvs_committed.find(NvsKey(name_space_, key));
+  return (entry == nvs_committed.end() ? 0 : entry->second.size());
+}
+
+// NVS
+
+struct NvsHandle {
+  std::string name_space;
+  bool read_write;
+  std::map<std::string, std::vector<uint8_t>> pending;
+};
+static std::map<nvs_handle_t, NvsHandle> nvs_handles;
+static nvs_handle_t next_nvs_handle = 1;
+
+esp_err_t nvs_open(const char* name_space, nvs_open_mode_t open_mode, nvs_handle_t* handle) {
+  std::lock_guard<std::recursive_mutex> lock(nvs_mutex);
+  *handle = next_nvs_handle++;
+  nvs_handles[*handle] = { name_space, open_mode == NVS_READWRITE, {} };
+  return ESP_OK;
+}
+
+static esp_err_t NvsSet(nvs_handle_t handle, const char* key, const void* value, size_t length) {
+  std::lock_guard<std::recursive_mutex> lock(nvs_mutex);
+  auto open_handle = nvs_handles.find(handle);
+  if(open_handle == nvs_handles.end() || !open_handle->second.read_write) return ESP_FAIL;
+  open_handle->second.pending[key].assign((const uint8_t*)value, (const uint8_t*)value + length);
+  return ESP_OK;
+}
+
+esp_err_t nvs_set_u8(nvs_handle_t handle, const char* key, uint8_t value) {
+  return NvsSet(handle, key, &value, 1);
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char* key, const void* value, size_t length) {
+  return NvsSet(handle, key, value, length);
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle) {
+  std::lock_guard<std::recursive_mutex> lock(nvs_mutex);
+  auto open_handle = nvs_handles.find(handle);
+  if(open_handle == nvs_handles.end()) return ESP_FAIL;
+  for (auto &value : open_handle->second.pending)
+    nvs_committed[NvsKey(open_handle->second.name_space, value.first.c_str())] = value.second;
+  open_handle->second.pending.clear();
+  nvs_commits++;
+  return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle) {
+  std::lock_guard<std::recursive_mutex> lock(nvs_mutex);
+  nvs_handles.erase(handle);
+}
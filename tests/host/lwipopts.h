@@ -0,0 +1,6 @@
+#ifndef HOST_LWIPOPTS_H
+#define HOST_LWIPOPTS_H
+
+// nothing needed on host
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef HOST_PGMSPACE_H
+#define HOST_PGMSPACE_H
+
+// nothing needed on host
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef HOST_SECRETS_H
+#define HOST_SECRETS_H
+
+// nothing needed on host
+
+#endif
@@ -0,0 +1,47 @@
+// Globals and helpers the sketch (.ino) provides to clock modules, for unit tests that link
+// modules without the sketch. Simulation links the real sketch instead.
+
+#include "common.h"
+
+SPIClass SPI;
+SPIClass* spi_obj = NULL;
+
+RTC* rtc = NULL;
+RGBDisplay* display = NULL;
+AlarmClock* alarm_clock = NULL;
+WiFiStuff* wifi_stuff = NULL;
+NvsPreferences* nvs_preferences = NULL;
+ButtonEvents* button_events = NULL;
+Touchscreen* ts = NULL;
+
+bool debug_mode = false;
+bool use_photoresistor = false;
+uint32_t cpu_speed_mhz = 80;
+bool firmware_updated_flag_user_information = false;
+elapsedMillis inactivity_millis = 0;
+ScreenPage current_page = kMainPage;
+Cursor current_cursor = kCursorNoSelection;
+
+void ResetWatchdog() {}
+
+void PrintLn(const char* someText1, const char* someText2) {
+  Serial.printf("%s %s\n", (someText1 != nullptr ? someText1 : ""), (someText2 != nullptr ? someText2 : ""));
+}
+void PrintLn(const char* someText1) {
+  Serial.printf("%s\n", (someText1 != nullptr ? someText1 : ""));
+}
+void PrintLn(const char* someText1, int someInt) {
+  Serial.printf("%s %d\n", someText1, someInt);
+}
+void PrintLn(std::string someTextStr1, std::string someTextStr2) {
+  Serial.printf("%s %s\n", someTextStr1.c_str(), someTextStr2.c_str());
+}
+void PrintLn(std::string &someTextStr1, std::string &someTextStr2) {
+  Serial.printf("%s %s\n", someTextStr1.c_str(), someTextStr2.c_str());
+}
+void PrintLn(std::string &someTextStr1) {
+  Serial.printf("%s\n", someTextStr1.c_str());
+}
+void PrintLn() {
+  Serial.println();
+}
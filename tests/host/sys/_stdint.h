@@ -0,0 +1,6 @@
+#ifndef HOST_SYS_STDINT_H
+#define HOST_SYS_STDINT_H
+
+#include <stdint.h>
+
+#endif
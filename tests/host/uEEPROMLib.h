@@ -0,0 +1,27 @@
+#ifndef HOST_UEEPROMLIB_H
+#define HOST_UEEPROMLIB_H
+
+// AT24C32 EEPROM of the DS3231 module, in memory and erased to 0xFF
+
+#include <Arduino.h>
+
+class uEEPROMLib {
+public:
+  uEEPROMLib() { memset(memory_, 0xFF, sizeof(memory_)); }
+  uEEPROMLib(int address) : uEEPROMLib() {}
+  void set_address(int address) {}
+  template<class T> bool eeprom_read(unsigned int address, T* value) {
+    if(address + sizeof(T) > sizeof(memory_)) return false;
+    memcpy(value, memory_ + address, sizeof(T));
+    return true;
+  }
+  template<class T> bool eeprom_write(unsigned int address, T value) {
+    if(address + sizeof(T) > sizeof(memory_)) return false;
+    memcpy(memory_ + address, &value, sizeof(T));
+    return true;
+  }
+private:
+  uint8_t memory_[4096];
+};
+
+#endif  // HOST_UEEPROMLIB_H
@@ -0,0 +1,65 @@
+#ifndef HOST_URTCLIB_H
+#define HOST_URTCLIB_H
+
+// uRTCLib stand-in backed by a simulated DS3231. The chip keeps time in its registers and
+// HostDs3231Tick() advances it one second; uRTCLib::refresh() reads registers into the
+// cached values returned by getters, as the real library does over I2C.
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#define URTCLIB_WIRE Wire
+
+#define URTCLIB_MODEL_DS1307 1
+#define URTCLIB_MODEL_DS3231 2
+#define URTCLIB_MODEL_DS3232 3
+
+#define URTCLIB_SQWG_OFF_0 0
+#define URTCLIB_SQWG_OFF_1 1
+#define URTCLIB_SQWG_1H 2
+
+#define URTCLIB_ALARM_1 1
+#define URTCLIB_ALARM_2 2
+#define URTCLIB_ALARM_TYPE_1_NONE 0
+#define URTCLIB_ALARM_TYPE_2_NONE 0
+
+class uRTCLib {
+public:
+  void set_model(uint8_t model) {}
+  bool refresh();
+  uint8_t second() { return second_; }
+  uint8_t minute() { return minute_; }
+  uint8_t hour() { return hour_; }
+  uint8_t day() { return day_; }
+  uint8_t month() { return month_; }
+  uint8_t year() { return year_; }
+  uint8_t dayOfWeek() { return day_of_week_; }
+  uint8_t hourModeAndAmPm() { return hour_mode_and_am_pm_; }
+  // set() takes 24 hour hour and leaves chip in 24 hour mode
+  void set(uint8_t second, uint8_t minute, uint8_t hour, uint8_t day_of_week, uint8_t day, uint8_t month, uint8_t year);
+  void set_12hour_mode(bool twelve_hour_mode);
+  bool lostPower();
+  void lostPowerClear();
+  bool getEOSCFlag() { return false; }
+  bool enableBattery() { return true; }
+  bool status32KOut() { return false; }
+  void disable32KOut() {}
+  void sqwgSetMode(uint8_t mode) {}
+  bool alarmTriggered(uint8_t alarm) { return false; }
+  void alarmClearFlag(uint8_t alarm) {}
+  uint8_t alarmMode(uint8_t alarm) { return 0; }
+  void alarmDisable(uint8_t alarm) {}
+private:
+  uint8_t second_ = 0, minute_ = 0, hour_ = 0, day_ = 1, month_ = 1, year_ = 0, day_of_week_ = 1;
+  uint8_t hour_mode_and_am_pm_ = 0;
+};
+
+// simulated DS3231 chip, shared by all uRTCLib objects
+// hour_24 is 0-23, year is 0-99 (2000-2099), day_of_week Sunday = 1
+void HostDs3231Set(uint8_t second, uint8_t minute, uint8_t hour_24, uint8_t day_of_week, uint8_t day, uint8_t month, uint8_t year);
+void HostDs3231Tick();
+void HostDs3231SetLostPower(bool lost_power);
+// chip time as seconds since Jan 1 2000 12:00 AM
+uint32_t HostDs3231Seconds();
+
+#endif  // HOST_URTCLIB_H
@@ -0,0 +1,190 @@
+// JsonReader, the bounded pull parser of REST API request bodies: token stream of valid
+// documents, structural errors and their stickiness, nesting limit, integer conversion limits,
+// string unescaping into fixed buffers, SkipValue(), and random mutations of valid bodies.
+// Inputs are copied into exactly sized heap buffers without terminator, so any read past the
+// body is caught by the address sanitizer.
+
+#include "json_reader.h"
+#include "check.h"
+#include <random>
+#include <string>
+#include <vector>
+
+typedef JsonReader::TokenType TokenType;
+
+// token stream as text: types as symbols, values as they appear, ! for error
+static std::string Tokens(const std::string &json) {
+  std::vector<char> body(json.begin(), json.end());
+  JsonReader reader(body.data(), body.size());
+  JsonReader::Token token;
+  std::string out;
+  for (size_t count = 0; count <= body.size() + 1; count++) {
+    TokenType type = reader.Next(token);
+    switch(type) {
+      case JsonReader::kObjectStart: out += "{"; break;
+      case JsonReader::kObjectEnd: out += "}"; break;
+      case JsonReader::kArrayStart: out += "["; break;
+      case JsonReader::kArrayEnd: out += "]"; break;
+      case JsonReader::kKey: out += "k:" + std::string(token.start, token.length) + " "; break;
+      case JsonReader::kString: out += "s:" + std::string(token.start, token.length) + " "; break;
+      case JsonReader::kNumber: out += "n:" + std::string(token.start, token.length) + " "; break;
+      case JsonReader::kTrue: out += "T "; break;
+      case JsonReader::kFalse: out += "F "; break;
+      case JsonReader::kNull: out += "N "; break;
+      case JsonReader::kEnd: return out + "$";
+      case JsonReader::kError: return out + "!";
+    }
+  }
+  return out + " (no end)";
+}
+
+static void TestValidDocuments() {
+  CHECK_STR(Tokens("{\"alarms\":[{\"slot\":0,\"minute_of_day\":420,\"on\":true,\"weekdays\":127}]}"),
+    "{k:alarms [{k:slot n:0 k:minute_of_day n:420 k:on T k:weekdays n:127 }]}$");
+  CHECK_STR(Tokens(" \t\r\n{ \"a\" : -1.5e+3 , \"b\" : [ ] , \"c\" : { } , \"d\" : null , \"e\" : false } \n"),
+    "{k:a n:-1.5e+3 k:b []k:c {}k:d N k:e F }$");
+  CHECK_STR(Tokens("[1,\"x\\\"y\",[[]]]"), "[n:1 s:x\\\"y [[]]]$");
+  CHECK_STR(Tokens("42"), "n:42 $");
+  CHECK_STR(Tokens("\"\""), "s: $");
+}
+
+static void TestMalformedDocuments() {
+  const char* malformed[] = {
+    "", " ", "{", "}", "[", "]", "{\"a\":1,}", "[1,]", "{\"a\" 1}", "{\"a\":}", "{1:2}", "{'a':1}",
+    "[1 2]", "{\"a\":1}}", "{\"a\":1} x", "{\"a\":1}{", "\"unterminated", "\"bad \\x escape\"",
+    "\"\\u12g4\"", "\"\\u12\"", "\"tab\tinside\"", "tru", "nul", "falsey", "01", "-", "1.", ".5", "1e",
+    "+1", "[1]]", "{\"a\":[}]",
+  };
+  for (const char* json : malformed) {
+    std::string tokens = Tokens(json);
+    if(tokens.empty() || tokens.back() != '!')
+      fprintf(stderr, "malformed %s gave %s\n", json, tokens.c_str());
+    CHECK(!tokens.empty() && tokens.back() == '!');
+  }
+}
+
+// once failed, every later token is an error too
+static void TestErrorIsSticky() {
+  std::string json = "{\"a\":1,,\"b\":2}";
+  JsonReader reader(json.data(), json.size());
+  JsonReader::Token token;
+  CHECK(reader.Next(token) == JsonReader::kObjectStart);
+  CHECK(reader.Next(token) == JsonReader::kKey);
+  CHECK(reader.Next(token) == JsonReader::kNumber);
+  for (int i = 0; i < 3; i++)
+    CHECK(reader.Next(token) == JsonReader::kError);
+}
+
+static void TestNestingLimit() {
+  std::string deepest = std::string(JsonReader::kMaxDepth, '[') + std::string(JsonReader::kMaxDepth, ']');
+  CHECK_STR(Tokens(deepest), std::string(JsonReader::kMaxDepth, '[') + std::string(JsonReader::kMaxDepth, ']') + "$");
+  std::string too_deep = "[" + deepest + "]";
+  CHECK_STR(Tokens(too_deep), std::string(JsonReader::kMaxDepth, '[') + "!");
+}
+
+static bool ToInt(const std::string &number, int32_t &value) {
+  JsonReader reader(number.data(), number.size());
+  JsonReader::Token token;
+  return reader.Next(token) == JsonReader::kNumber && JsonReader::ToInt(token, value);
+}
+
+static void TestToInt() {
+  int32_t value = 0;
+  CHECK(ToInt("0", value) && value == 0);
+  CHECK(ToInt("-0", value) && value == 0);
+  CHECK(ToInt("2147483647", value) && value == INT32_MAX);
+  CHECK(ToInt("-2147483648", value) && value == INT32_MIN);
+  CHECK(!ToInt("2147483648", value));
+  CHECK(!ToInt("-2147483649", value));
+  CHECK(!ToInt("99999999999999999999999", value));
+  CHECK(!ToInt("1.0", value));
+  CHECK(!ToInt("1e2", value));
+}
+
+static bool Copy(const std::string &string_json, char* out, size_t size) {
+  JsonReader reader(string_json.data(), string_json.size());
+  JsonReader::Token token;
+  return reader.Next(token) == JsonReader::kString && JsonReader::CopyString(token, out, size);
+}
+
+static void TestCopyString() {
+  char out[8];
+  CHECK(Copy("\"a\\\"\\\\\\/\\n\\t\"", out, sizeof(out)) && std::string(out) == "a\"\\/\n\t");
+  CHECK(Copy("\"\\u0041\\u007f\"", out, sizeof(out)) && std::string(out) == "A\x7f");
+  CHECK(!Copy("\"\\u00e9\"", out, sizeof(out)));
+  // 7 characters and terminator fit, 8 do not
+  CHECK(Copy("\"1234567\"", out, sizeof(out)) && std::string(out) == "1234567");
+  CHECK(!Copy("\"12345678\"", out, sizeof(out)));
+  CHECK(!Copy("\"\"", out, 0));
+  CHECK(Copy("\"\"", out, 1) && out[0] == '\0');
+}
+
+static void TestSkipValue() {
+  std::string json = "{\"skip\":{\"a\":[1,{\"b\":2}],\"c\":\"}\"},\"next\":3}";
+  JsonReader reader(json.data(), json.size());
+  JsonReader::Token token;
+  CHECK(reader.Next(token) == JsonReader::kObjectStart);
+  CHECK(reader.Next(token) == JsonReader::kKey && JsonReader::Equals(token, "skip"));
+  CHECK(reader.Next(token) == JsonReader::kObjectStart);
+  CHECK(reader.SkipValue(token));
+  CHECK(reader.Next(token) == JsonReader::kKey && JsonReader::Equals(token, "next"));
+  CHECK(reader.Next(token) == JsonReader::kNumber && reader.SkipValue(token));
+  CHECK(reader.Next(token) == JsonReader::kObjectEnd);
+  CHECK(reader.Next(token) == JsonReader::kEnd);
+
+  std::string broken = "[{\"a\":[1,}]";
+  JsonReader broken_reader(broken.data(), broken.size());
+  CHECK(broken_reader.Next(token) == JsonReader::kArrayStart);
+  CHECK(broken_reader.Next(token) == JsonReader::kObjectStart);
+  CHECK(!broken_reader.SkipValue(token));
+}
+
+// bytes flipped, dropped, repeated and truncated: parser ends with kEnd or kError within a
+// token per input byte, and tokens point inside the body
+static void TestMutatedBodies() {
+  const std::string seeds[] = {
+    "{\"alarms\":[{\"slot\":1,\"minute_of_day\":1439,\"on\":false,\"weekdays\":62}]}",
+    "{\"long_press_seconds\":15,\"night_dim_hour\":10,\"rgb_strip_mode\":2,\"screensaver_bounce\":true}",
+    "[\"\\u0041\\n\",-0.5e-3,null,[[{}]]]",
+  };
+  const char kJsonBytes[] = "{}[]\",:\\-0123456789.eEtrufalsn u ";
+  std::mt19937 random_generator(7);
+  for (int run = 0; run < 20000; run++) {
+    std::string json = seeds[run % 3];
+    int mutations = 1 + random_generator() % 4;
+    for (int i = 0; i < mutations && !json.empty(); i++) {
+      size_t pos = random_generator() % json.size();
+      switch(random_generator() % 4) {
+        case 0: json[pos] = kJsonBytes[random_generator() % (sizeof(kJsonBytes) - 1)]; break;
+        case 1: json.erase(pos, 1); break;
+        case 2: json.insert(pos, 1, json[pos]); break;
+        case 3: json.resize(pos); break;
+      }
+    }
+    std::vector<char> body(json.begin(), json.end());
+    JsonReader reader(body.data(), body.size());
+    JsonReader::Token token;
+    size_t tokens = 0;
+    TokenType type;
+    do {
+      type = reader.Next(token);
+      tokens++;
+      if(token.start != NULL)
+        CHECK(token.start >= body.data() && token.start + token.length <= body.data() + body.size());
+    } while(type != JsonReader::kEnd && type != JsonReader::kError && tokens <= body.size() + 1);
+    CHECK(tokens <= body.size() + 1);
+    CHECK(reader.depth() <= JsonReader::kMaxDepth);
+  }
+}
+
+int main() {
+  TestValidDocuments();
+  TestMalformedDocuments();
+  TestErrorIsSticky();
+  TestNestingLimit();
+  TestToInt();
+  TestCopyString();
+  TestSkipValue();
+  TestMutatedBodies();
+  return CHECK_RESULT();
+}
@@ -0,0 +1,259 @@
+#ifndef TESTS_JSON_REFERENCE_H
+#define TESTS_JSON_REFERENCE_H
+
+// Independent reference for WeatherJsonExtractor: a strict recursive descent JSON parser
+// building a DOM that keeps object members in document order, and a walk of that DOM that
+// takes the wanted fields, last occurrence winning.
+// Strings are decoded with the extractor's documented convention: \n \t \r become a space,
+// other escapes keep the escaped character and \uXXXX is kept as the text uXXXX.
+// Only the root value is parsed, input after it is ignored like the extractor does.
+
+#include "weather_json_extractor.h"
+#include <stdlib.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct JsonValue {
+  enum Type { kObject, kArray, kString, kNumber, kLiteral } type = kLiteral;
+  std::string text;     // decoded string, number text or literal
+  std::vector<std::pair<std::string, JsonValue>> members;
+  std::vector<JsonValue> elements;
+};
+
+class JsonReferenceParser {
+
+public:
+
+  // returns false if input does not start with a valid JSON value
+  bool Parse(const char* data, size_t length, JsonValue &root) {
+    data_ = data;
+    end_ = data + length;
+    depth_ = max_depth_ = 0;
+    root = JsonValue();
+    SkipWhitespace();
+    return ParseValue(root);
+  }
+
+  // deepest container nesting of last Parse(), root container is 1
+  int max_depth() { return max_depth_; }
+
+private:
+
+  const char* data_;
+  const char* end_;
+  int depth_, max_depth_;
+  static const int kDepthLimit = 64;
+
+  bool AtEnd() { return data_ >= end_; }
+
+  void SkipWhitespace() {
+    while(!AtEnd() && (*data_ == ' ' || *data_ == '\t' || *data_ == '\n' || *data_ == '\r'))
+      data_++;
+  }
+
+  bool Expect(char c) {
+    SkipWhitespace();
+    if(AtEnd() || *data_ != c) return false;
+    data_++;
+    SkipWhitespace();
+    return true;
+  }
+
+  static bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+  static bool IsHex(char c) { return IsDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'); }
+
+  bool ParseValue(JsonValue &value) {
+    if(AtEnd()) return false;
+    char c = *data_;
+    if(c == '{' || c == '[') {
+      if(++depth_ > kDepthLimit) return false;
+      if(depth_ > max_depth_) max_depth_ = depth_;
+      bool ok = (c == '{' ? ParseObject(value) : ParseArray(value));
+      depth_--;
+      return ok;
+    }
+    if(c == '"') {
+      value.type = JsonValue::kString;
+      return ParseString(value.text);
+    }
+    if(c == '-' || IsDigit(c)) {
+      value.type = JsonValue::kNumber;
+      return ParseNumber(value.text);
+    }
+    for (const char* literal : { "true", "false", "null" }) {
+      size_t length = strlen(literal);
+      if((size_t)(end_ - data_) >= length && memcmp(data_, literal, length) == 0) {
+        value.type = JsonValue::kLiteral;
+        value.text = literal;
+        data_ += length;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool ParseObject(JsonValue &value) {
+    value.type = JsonValue::kObject;
+    data_++;
+    SkipWhitespace();
+    if(!AtEnd() && *data_ == '}') {
+      data_++;
+      return true;
+    }
+    while(true) {
+      std::pair<std::string, JsonValue> member;
+      if(AtEnd() || *data_ != '"' || !ParseString(member.first)) return false;
+      if(!Expect(':')) return false;
+      if(!ParseValue(member.second)) return false;
+      value.members.push_back(std::move(member));
+      SkipWhitespace();
+      if(AtEnd()) return false;
+      if(*data_ == '}') {
+        data_++;
+        return true;
+      }
+      if(!Expect(',')) return false;
+    }
+  }
+
+  bool ParseArray(JsonValue &value) {
+    value.type = JsonValue::kArray;
+    data_++;
+    SkipWhitespace();
+    if(!AtEnd() && *data_ == ']') {
+      data_++;
+      return true;
+    }
+    while(true) {
+      value.elements.emplace_back();
+      if(!ParseValue(value.elements.back())) return false;
+      SkipWhitespace();
+      if(AtEnd()) return false;
+      if(*data_ == ']') {
+        data_++;
+        return true;
+      }
+      if(!Expect(',')) return false;
+    }
+  }
+
+  bool ParseString(std::string &text) {
+    data_++;
+    while(!AtEnd()) {
+      char c = *data_++;
+      if(c == '"') return true;
+      if((unsigned char)c < 0x20) return false;
+      if(c != '\\') {
+        text += c;
+        continue;
+      }
+      if(AtEnd()) return false;
+      c = *data_++;
+      switch(c) {
+        case '"': case '\\': case '/': case 'b': case 'f':
+          text += c;
+          break;
+        case 'n': case 't': case 'r':
+          text += ' ';
+          break;
+        case 'u':
+          if(end_ - data_ < 4) return false;
+          for (int i = 0; i < 4; i++)
+            if(!IsHex(data_[i])) return false;
+          text += 'u';
+          break;
+        default:
+          return false;
+      }
+    }
+    return false;
+  }
+
+  bool ParseNumber(std::string &text) {
+    const char* start = data_;
+    if(*data_ == '-') data_++;
+    if(AtEnd() || !IsDigit(*data_)) return false;
+    if(*data_ == '0')
+      data_++;
+    else
+      while(!AtEnd() && IsDigit(*data_)) data_++;
+    if(!AtEnd() && *data_ == '.') {
+      data_++;
+      if(AtEnd() || !IsDigit(*data_)) return false;
+      while(!AtEnd() && IsDigit(*data_)) data_++;
+    }
+    if(!AtEnd() && (*data_ == 'e' || *data_ == 'E')) {
+      data_++;
+      if(!AtEnd() && (*data_ == '+' || *data_ == '-')) data_++;
+      if(AtEnd() || !IsDigit(*data_)) return false;
+      while(!AtEnd() && IsDigit(*data_)) data_++;
+    }
+    text.assign(start, data_);
+    return true;
+  }
+
+};
+
+// wanted fields of a parsed document, as WeatherJsonExtractor should report them
+struct WeatherReference {
+  std::string weather_main, weather_description, name;
+  float number_values[WeatherJsonExtractor::kFieldsCount] = {};
+  uint16_t found_fields = 0;
+
+  // string values are truncated to extractor's buffer sizes, keys longer than its token are cut too
+  static const size_t kMainSize = sizeof(WeatherJsonExtractor::weather_main);
+  static const size_t kDescriptionSize = sizeof(WeatherJsonExtractor::weather_description);
+  static const size_t kNameSize = sizeof(WeatherJsonExtractor::name);
+  static const size_t kTokenLength = 23;
+
+  static std::string Key(const std::string &key) { return key.substr(0, kTokenLength); }
+
+  void TakeString(WeatherJsonExtractor::Field field, const JsonValue &value, std::string &out, size_t size) {
+    if(value.type != JsonValue::kString) return;
+    out = value.text.substr(0, size - 1);
+    found_fields |= (1 << field);
+  }
+
+  void TakeNumber(WeatherJsonExtractor::Field field, const JsonValue &value) {
+    if(value.type != JsonValue::kNumber || value.text.size() > kTokenLength) return;
+    number_values[field] = strtof(value.text.c_str(), NULL);
+    found_fields |= (1 << field);
+  }
+
+  void Extract(const JsonValue &root) {
+    if(root.type != JsonValue::kObject) return;
+    for (const auto &member : root.members) {
+      std::string key = Key(member.first);
+      const JsonValue &value = member.second;
+      if(key == "timezone")
+        TakeNumber(WeatherJsonExtractor::kTimezone, value);
+      else if(key == "name")
+        TakeString(WeatherJsonExtractor::kName, value, name, kNameSize);
+      else if(key == "main" && value.type == JsonValue::kObject) {
+        for (const auto &main_member : value.members) {
+          std::string main_key = Key(main_member.first);
+          if(main_key == "temp") TakeNumber(WeatherJsonExtractor::kMainTemp, main_member.second);
+          else if(main_key == "feels_like") TakeNumber(WeatherJsonExtractor::kMainFeelsLike, main_member.second);
+          else if(main_key == "temp_min") TakeNumber(WeatherJsonExtractor::kMainTempMin, main_member.second);
+          else if(main_key == "temp_max") TakeNumber(WeatherJsonExtractor::kMainTempMax, main_member.second);
+          else if(main_key == "humidity") TakeNumber(WeatherJsonExtractor::kMainHumidity, main_member.second);
+        }
+      }
+      else if(key == "wind" && value.type == JsonValue::kObject) {
+        for (const auto &wind_member : value.members)
+          if(Key(wind_member.first) == "speed")
+            TakeNumber(WeatherJsonExtractor::kWindSpeed, wind_member.second);
+      }
+      else if(key == "weather" && value.type == JsonValue::kArray && !value.elements.empty() && value.elements[0].type == JsonValue::kObject) {
+        for (const auto &weather_member : value.elements[0].members) {
+          std::string weather_key = Key(weather_member.first);
+          if(weather_key == "main") TakeString(WeatherJsonExtractor::kWeatherMain, weather_member.second, weather_main, kMainSize);
+          else if(weather_key == "description") TakeString(WeatherJsonExtractor::kWeatherDescription, weather_member.second, weather_description, kDescriptionSize);
+        }
+      }
+    }
+  }
+};
+
+#endif  // TESTS_JSON_REFERENCE_H
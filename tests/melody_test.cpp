@@ -0,0 +1,182 @@
+// Melody RTTTL parser and timer driven sequencer: songs are parsed into expected note tables,
+// malformed songs are rejected, and played songs are checked as the stream of buzzer tone calls
+// with their virtual timestamps. AlarmClock's buzzer tone functions are replaced by a recorder,
+// the note timer is the host esp_timer, so tones must start at the exact microsecond of the
+// song's timeline, also when note callbacks run late.
+
+#include "melody.h"
+#include "alarm_clock.h"
+#include "host.h"
+#include "check.h"
+#include <string>
+#include <vector>
+
+typedef Melody::Note Note;
+
+struct ToneEvent {
+  uint64_t time_us;
+  uint16_t frequency_hz;    // 0 = tone off
+  bool operator==(const ToneEvent &other) const { return time_us == other.time_us && frequency_hz == other.frequency_hz; }
+};
+
+static std::vector<ToneEvent> tone_events;
+static uint32_t callback_latency_us = 0;
+
+// buzzer of the alarm clock: tone calls are recorded, then the callback is held up
+void AlarmClock::BuzzerToneOn(uint16_t frequency_hz) {
+  tone_events.push_back({ HostMicros(), frequency_hz });
+  if(callback_latency_us > 0)
+    HostAdvanceMicros(callback_latency_us);
+}
+
+void AlarmClock::BuzzerToneOff() {
+  tone_events.push_back({ HostMicros(), 0 });
+}
+
+static std::vector<Note> Parse(const char* rtttl, uint8_t max_notes = Melody::kMaxNotes) {
+  Note notes[Melody::kMaxNotes];
+  uint8_t count = Melody::ParseRtttl(rtttl, notes, max_notes);
+  return std::vector<Note>(notes, notes + count);
+}
+
+static std::string NotesText(const std::vector<Note> &notes) {
+  std::string text;
+  for (const Note &note : notes)
+    text += std::to_string(note.frequency_hz) + "/" + std::to_string(note.duration_ms) + " ";
+  return text;
+}
+
+static void TestParseCharge() {
+  // whole note 240000 / 109 = 2201 ms, sixteenth 137 ms, dotted 205 ms
+  CHECK_STR(NotesText(Parse(kSongCharge)), "392/205 524/205 660/205 784/275 660/137 784/1100 ");
+}
+
+static void TestParseNotation() {
+  // sharps, rests, dotted before and after octave, upper case, b# to next octave
+  CHECK_STR(NotesText(Parse("x:d=4,o=5,b=120:c#,8p,d.6,e6.,A,b#4,16g#7,1f3")),
+    "554/500 0/250 1176/750 1320/750 880/500 524/500 3320/125 174/2000 ");
+  // defaults d=4, o=6, b=63 when not given, whole note 3809 ms
+  CHECK_STR(NotesText(Parse("x::a,2c")), "1760/952 1048/1904 ");
+  // out of range octave default is ignored, spaces between notes are skipped
+  CHECK_STR(NotesText(Parse("x:o=9,b=240,d=8: a , b ")), "1760/125 1976/125 ");
+  // note table is cut at max notes
+  CHECK_STR(NotesText(Parse("x:d=4,o=5,b=60:c,d,e,f", 2)), "524/1000 588/1000 ");
+  CHECK_EQ(Parse("x:d=4,o=5,b=60:").size(), 0);
+}
+
+static void TestParseMalformed() {
+  const char* malformed[] = { "", "name only", "x:d=4,o=5,b=60", "x:d=4:c,h", "x:d=4:c,#", "x:d=4:4" };
+  for (const char* rtttl : malformed)
+    CHECK_EQ(Parse(rtttl).size(), 0);
+}
+
+// songs of the clock fit the note table, tones the passive buzzer can play
+static void TestIncludedSongs() {
+  for (const char* song : { kSongCharge, kSongEntertainer, kSongMorning }) {
+    std::vector<Note> notes = Parse(song);
+    CHECK(notes.size() > 0 && notes.size() < Melody::kMaxNotes);
+    for (const Note &note : notes) {
+      CHECK(note.frequency_hz == 0 || (note.frequency_hz >= 100 && note.frequency_hz <= 4000));
+      CHECK(note.duration_ms >= 50 && note.duration_ms <= 3000);
+    }
+  }
+  CHECK_EQ(Parse(kSongEntertainer).size(), 18);
+  CHECK_EQ(Parse(kSongMorning).size(), 24);
+}
+
+// tone calls a song should give from start_us: off as Play() stops what was playing, each note
+// at the sum of durations before it, then off
+static std::vector<ToneEvent> ExpectedEvents(const char* rtttl, uint64_t start_us) {
+  std::vector<ToneEvent> events = { { start_us, 0 } };
+  uint64_t time_us = start_us;
+  for (const Note &note : Parse(rtttl)) {
+    events.push_back({ time_us, note.frequency_hz });
+    time_us += note.duration_ms * 1000ULL;
+  }
+  events.push_back({ time_us, 0 });
+  return events;
+}
+
+static void CheckEvents(const std::vector<ToneEvent> &expected) {
+  CHECK_EQ(tone_events.size(), expected.size());
+  for (size_t i = 0; i < tone_events.size() && i < expected.size(); i++) {
+    if(tone_events[i] == expected[i]) continue;
+    CHECK_EQ(tone_events[i].time_us, expected[i].time_us);
+    CHECK_EQ(tone_events[i].frequency_hz, expected[i].frequency_hz);
+  }
+}
+
+static void TestPlayTimeline() {
+  for (const char* song : { kSongCharge, kSongEntertainer, kSongMorning, "rests:d=4,o=5,b=200:p,c,8p,d,p" }) {
+    Melody melody;
+    HostAdvanceMicros(12345);
+    uint64_t start_us = HostMicros();
+    tone_events.clear();
+    CHECK(melody.Play(song));
+    CHECK(melody.IsPlaying());
+    // in steps that do not line up with notes, as from loop() and render calls
+    for (int step = 0; step < 1000 && melody.IsPlaying(); step++)
+      HostAdvanceMicros(16667);
+    CHECK(!melody.IsPlaying());
+    CheckEvents(ExpectedEvents(song, start_us));
+  }
+}
+
+// callbacks held up by 3 ms each: every note still starts on the song's timeline
+static void TestLateCallbacksDoNotDrift() {
+  Melody melody;
+  uint64_t start_us = HostMicros();
+  tone_events.clear();
+  callback_latency_us = 3000;
+  melody.Play(kSongMorning);
+  HostAdvanceMicros(60 * 1000000ULL);
+  callback_latency_us = 0;
+  CHECK(!melody.IsPlaying());
+  CheckEvents(ExpectedEvents(kSongMorning, start_us));
+}
+
+static void TestStopAndRestart() {
+  Melody melody;
+  tone_events.clear();
+  melody.Play(kSongEntertainer);
+  HostAdvanceMicros(1000000);
+  melody.Stop();
+  CHECK(!melody.IsPlaying());
+  uint64_t stop_us = HostMicros();
+  size_t events_at_stop = tone_events.size();
+  CHECK(events_at_stop > 2);
+  CHECK(tone_events.back() == (ToneEvent{ stop_us, 0 }));
+  // no more notes after stop
+  HostAdvanceMicros(10 * 1000000ULL);
+  CHECK_EQ(tone_events.size(), events_at_stop);
+
+  // play while playing starts over
+  melody.Play(kSongCharge);
+  HostAdvanceMicros(300000);
+  tone_events.clear();
+  uint64_t restart_us = HostMicros();
+  CHECK(melody.Play(kSongCharge));
+  HostAdvanceMicros(10 * 1000000ULL);
+  CheckEvents(ExpectedEvents(kSongCharge, restart_us));
+
+  // malformed song is not played
+  tone_events.clear();
+  CHECK(!melody.Play("x:d=4:q"));
+  CHECK(!melody.IsPlaying());
+  HostAdvanceMicros(1000000);
+  CHECK_EQ(tone_events.size(), 1);
+}
+
+int main() {
+  AlarmClock clock;
+  alarm_clock = &clock;
+
+  TestParseCharge();
+  TestParseNotation();
+  TestParseMalformed();
+  TestIncludedSongs();
+  TestPlayTimeline();
+  TestLateCallbacksDoNotDrift();
+  TestStopAndRestart();
+  return CHECK_RESULT();
+}
@@ -0,0 +1,194 @@
+// MinuteScheduler fast-forwarded over simulated weeks against a plain reference schedule
+// in absolute minutes. Jobs mirror the sketch's: hourly, daily, every minute, a pre-alarm
+// one shot and a retry job that reschedules itself from its job function. Random reschedules,
+// cancels and time jumps forward and back are applied to both, and every tick must run the
+// same jobs. A minute ticked again runs nothing.
+
+#include "minute_scheduler.h"
+#include "host.h"
+#include "check.h"
+#include <random>
+#include <vector>
+
+MinuteScheduler scheduler;
+
+enum TestJob { kHourly = 0, kDaily, kEveryMinute, kEvery7, kEvery90, kPreAlarm, kRetry, kTestJobs };
+const uint16_t kPeriod[kTestJobs] = { 60, kMinutesInDay, 1, 7, 90, 0, 0 };
+const uint8_t kRetryTimes = 3;
+const uint16_t kRetryMinutes = 5;
+
+static uint8_t job_ids[kTestJobs];
+static std::vector<int> ran;            // jobs run by scheduler this tick
+static uint8_t retries_left = 0;
+
+static RTC::TimeSnapshot SnapshotAt(uint32_t minutes) {
+  RTC::TimeSnapshot now = {};
+  now.day_of_week = (minutes / kMinutesInDay) % 7 + 1;
+  now.todays_minutes = minutes % kMinutesInDay;
+  return now;
+}
+
+template<int kJob> static void RunJob(const RTC::TimeSnapshot &now) {
+  ran.push_back(kJob);
+  // like NTP retry: schedules itself again from its job function
+  if(kJob == kRetry && retries_left > 0) {
+    retries_left--;
+    scheduler.ScheduleJobIn(job_ids[kRetry], kRetryMinutes);
+  }
+}
+
+static const MinuteScheduler::JobFunction kJobFunction[kTestJobs] = {
+  RunJob<kHourly>, RunJob<kDaily>, RunJob<kEveryMinute>, RunJob<kEvery7>, RunJob<kEvery90>, RunJob<kPreAlarm>, RunJob<kRetry> };
+
+// reference schedule: absolute due minute of each job, -1 = not scheduled
+struct Reference {
+  int64_t due[kTestJobs];
+
+  // first minute at or after from with minute of week of due
+  static int64_t NextSameMinuteOfWeek(int64_t due, int64_t from) {
+    int64_t delta = ((due - from) % kMinutesInWeek + kMinutesInWeek) % kMinutesInWeek;
+    return from + delta;
+  }
+
+  // first minute at or after from in phase with due
+  static int64_t NextInPhase(int64_t due, int64_t from, uint16_t period) {
+    int64_t delta = ((due - from) % period + period) % period;
+    return from + delta;
+  }
+
+  void Jump(int64_t previous, int64_t now) {
+    int64_t jump = ((now - previous) % kMinutesInWeek + kMinutesInWeek) % kMinutesInWeek;
+    bool forward_jump = (jump < kMinutesInWeek / 2);
+    for (int job = 0; job < kTestJobs; job++) {
+      if(due[job] < 0) continue;
+      if(kPeriod[job] > 0)
+        due[job] = NextInPhase(due[job], now, kPeriod[job]);
+      else if(forward_jump && due[job] > previous && due[job] <= previous + jump)
+        due[job] = now;
+      else
+        due[job] = NextSameMinuteOfWeek(due[job], now);
+    }
+  }
+
+  std::vector<int> Run(int64_t now) {
+    std::vector<int> run;
+    for (int job = 0; job < kTestJobs; job++) {
+      if(due[job] != now) continue;
+      run.push_back(job);
+      due[job] = (kPeriod[job] > 0 ? now + kPeriod[job] : -1);
+    }
+    return run;
+  }
+};
+
+// first run of a periodic job added at minute now: in phase with next first_minute_of_day, after now
+static int64_t FirstPeriodicRun(int64_t now, uint16_t period, uint16_t first_minute_of_day) {
+  int64_t run = now + ((first_minute_of_day - now) % kMinutesInDay + kMinutesInDay) % kMinutesInDay;
+  while(run - period > now)
+    run -= period;
+  return (run == now ? now + period : run);
+}
+
+static void TestFastForward(uint32_t seed, int weeks) {
+  std::mt19937 random_generator(seed);
+  ran.clear();
+  retries_left = 0;
+  scheduler = MinuteScheduler();
+
+  // Wednesday 5:17 PM, some weeks in so that time set back stays positive
+  int64_t now = 4 * kMinutesInWeek + 3 * kMinutesInDay + 17 * 60 + 17;
+  Reference reference;
+  scheduler.Setup(SnapshotAt(now).minute_of_week());
+  job_ids[kHourly] = scheduler.AddPeriodicJob(kJobFunction[kHourly], 60, 0);
+  reference.due[kHourly] = now + 43;
+  job_ids[kDaily] = scheduler.AddDailyJob(kJobFunction[kDaily], 7 * 60);
+  reference.due[kDaily] = now + 24 * 60 - (10 * 60 + 17);
+  job_ids[kEveryMinute] = scheduler.AddPeriodicJob(kJobFunction[kEveryMinute], 1, 0);
+  reference.due[kEveryMinute] = now + 1;
+  job_ids[kEvery7] = scheduler.AddPeriodicJob(kJobFunction[kEvery7], 7, 3);
+  reference.due[kEvery7] = FirstPeriodicRun(now, 7, 3);
+  job_ids[kEvery90] = scheduler.AddPeriodicJob(kJobFunction[kEvery90], 90, 30);
+  reference.due[kEvery90] = FirstPeriodicRun(now, 90, 30);
+  job_ids[kPreAlarm] = scheduler.AddJob(kJobFunction[kPreAlarm]);
+  reference.due[kPreAlarm] = -1;
+  job_ids[kRetry] = scheduler.AddJob(kJobFunction[kRetry]);
+  reference.due[kRetry] = -1;
+  for (int job = 0; job < kTestJobs; job++)
+    CHECK(job_ids[job] != MinuteScheduler::kNoJob);
+
+  int mismatches = 0;
+  uint32_t runs = 0, jumps = 0;
+  for (int64_t tick = 0; tick < (int64_t)weeks * kMinutesInWeek; tick++) {
+    int64_t previous = now;
+    uint32_t action = random_generator() % 1000;
+    if(action == 0) {
+      // time set forward: manual set or NTP correction
+      now += 2 + random_generator() % 3000;
+      jumps++;
+    }
+    else if(action == 1) {
+      // time set back
+      now -= 1 + random_generator() % 3000;
+      jumps++;
+    }
+    else if(action == 2) {
+      // time set back by seconds over a minute change: same minute ticks again
+      jumps++;
+    }
+    else
+      now++;
+
+    uint8_t retries_before_tick = retries_left;
+    scheduler.Tick(SnapshotAt(now));
+    if(now != previous + 1 && now != previous)
+      reference.Jump(previous, now);
+    std::vector<int> expected = reference.Run(now);
+    if(std::find(expected.begin(), expected.end(), kRetry) != expected.end() && retries_before_tick > 0)
+      reference.due[kRetry] = now + kRetryMinutes;
+    std::sort(ran.begin(), ran.end());
+    if(ran != expected && mismatches++ < 5) {
+      fprintf(stderr, "seed %u minute %lld: ran", seed, (long long)now);
+      for (int job : ran) fprintf(stderr, " %d", job);
+      fprintf(stderr, ", expected");
+      for (int job : expected) fprintf(stderr, " %d", job);
+      fprintf(stderr, "\n");
+    }
+    runs += ran.size();
+    ran.clear();
+
+    // subsystems rescheduling jobs between ticks
+    action = random_generator() % 200;
+    if(action == 0) {
+      // alarm set: pre-alarm job at a minute of week within next week
+      uint16_t minutes = 1 + random_generator() % (kMinutesInWeek - 1);
+      scheduler.ScheduleJobIn(job_ids[kPreAlarm], minutes);
+      reference.due[kPreAlarm] = now + minutes;
+    }
+    else if(action == 1) {
+      scheduler.CancelJob(job_ids[kPreAlarm]);
+      reference.due[kPreAlarm] = -1;
+    }
+    else if(action == 2) {
+      // NTP update failed, retry soon
+      retries_left = kRetryTimes;
+      scheduler.ScheduleJobIn(job_ids[kRetry], 1);
+      reference.due[kRetry] = now + 1;
+    }
+    else if(action == 3) {
+      // daily job moved to another time of day, as night time dim hour
+      uint16_t minute_of_day = random_generator() % kMinutesInDay;
+      scheduler.ScheduleJobAtMinuteOfDay(job_ids[kDaily], minute_of_day);
+      int64_t delta = ((minute_of_day - now) % kMinutesInDay + kMinutesInDay) % kMinutesInDay;
+      reference.due[kDaily] = now + (delta == 0 ? kMinutesInDay : delta);
+    }
+  }
+  CHECK_EQ(mismatches, 0);
+  CHECK(jumps > 0);
+  CHECK(runs > (uint32_t)weeks * kMinutesInWeek);
+}
+
+int main() {
+  for (uint32_t seed = 1; seed <= 20; seed++)
+    TestFastForward(seed, 8);
+  return CHECK_RESULT();
+}
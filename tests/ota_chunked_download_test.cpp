@@ -0,0 +1,346 @@
+// Resumable OTA download through OtaChunkedWriter from a local HTTP server that injects faults.
+// The server on a loopback socket answers Range requests for a firmware binary and its manifest
+// made by tools/ota_image.py, and drops connections mid-body, ignores Range, or flips a byte.
+// The client follows WiFiStuff::UpdateFirmwareResumable(): Range from bytes_done(), checkpoint after
+// every verified chunk, drop partial chunk and retry after a failed connection. Some drops are
+// reboots with power lost mid-write: a new writer resumes from the checkpoint, sometimes after a
+// done chunk was corrupted in flash. Flash only takes writes to erased bytes.
+// Needs python3 to run the image tool.
+
+#include "ota_image.h"
+#include "common.h"
+#include "check.h"
+#include <arpa/inet.h>
+#include <atomic>
+#include <fstream>
+#include <iterator>
+#include <netinet/in.h>
+#include <random>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+static const uint32_t kChunkSize = 1 << 15;
+
+static std::vector<uint8_t> ReadFile(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  CHECK(file.good());
+  return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// NOR flash: erase sets sector to 0xFF, a write must land on erased bytes
+struct FakeFlash {
+  std::vector<uint8_t> bytes = std::vector<uint8_t>(1 << 20, 0x00);
+  uint32_t erased_bytes = 0;
+};
+
+static bool FlashWrite(uint32_t offset, const uint8_t* data, size_t length, void* context) {
+  FakeFlash* flash = (FakeFlash*)context;
+  if(offset + length > flash->bytes.size()) return false;
+  for (size_t i = 0; i < length; i++) {
+    if(flash->bytes[offset + i] != 0xFF) return false;
+    flash->bytes[offset + i] = data[i];
+  }
+  return true;
+}
+
+static bool FlashErase(uint32_t offset, size_t length, void* context) {
+  FakeFlash* flash = (FakeFlash*)context;
+  if(offset % OtaChunkedWriter::kFlashSectorSize != 0 || length % OtaChunkedWriter::kFlashSectorSize != 0 || offset + length > flash->bytes.size())
+    return false;
+  memset(flash->bytes.data() + offset, 0xFF, length);
+  flash->erased_bytes += length;
+  return true;
+}
+
+static bool FlashRead(uint32_t offset, uint8_t* data, size_t length, void* context) {
+  FakeFlash* flash = (FakeFlash*)context;
+  if(offset + length > flash->bytes.size()) return false;
+  memcpy(data, flash->bytes.data() + offset, length);
+  return true;
+}
+
+// HTTP/1.0 server for /fw.bin and /fw.bin.manifest, one connection at a time
+class FaultyRangeServer {
+
+public:
+
+  std::vector<uint8_t> firmware, manifest;
+  std::atomic<uint32_t> drops{0}, ignored_ranges{0}, corruptions{0};
+
+  uint16_t Start(uint32_t seed) {
+    random_generator_.seed(seed);
+    listen_socket_ = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    CHECK(bind(listen_socket_, (sockaddr*)&address, sizeof(address)) == 0);
+    CHECK(listen(listen_socket_, 4) == 0);
+    socklen_t address_length = sizeof(address);
+    getsockname(listen_socket_, (sockaddr*)&address, &address_length);
+    thread_ = std::thread(&FaultyRangeServer::Serve, this);
+    return ntohs(address.sin_port);
+  }
+
+  void Stop() {
+    stop_ = true;
+    shutdown(listen_socket_, SHUT_RDWR);
+    close(listen_socket_);
+    thread_.join();
+  }
+
+private:
+
+  int listen_socket_ = -1;
+  std::atomic<bool> stop_{false};
+  std::thread thread_;
+  std::mt19937 random_generator_;
+
+  void Serve() {
+    while(!stop_) {
+      int connection = accept(listen_socket_, NULL, NULL);
+      if(connection < 0) continue;
+      Respond(connection);
+      close(connection);
+    }
+  }
+
+  void Respond(int connection) {
+    std::string request;
+    char buffer[512];
+    while(request.find("\r\n\r\n") == std::string::npos) {
+      ssize_t received = recv(connection, buffer, sizeof(buffer), 0);
+      if(received <= 0) return;
+      request.append(buffer, received);
+    }
+    const std::vector<uint8_t> &body = (request.find("GET /fw.bin.manifest ") == 0 ? manifest : firmware);
+    uint32_t range_start = 0;
+    size_t range = request.find("\r\nRange: bytes=");
+    if(range != std::string::npos)
+      range_start = strtoul(request.c_str() + range + strlen("\r\nRange: bytes="), NULL, 10);
+    if(range_start > 0 && random_generator_() % 10 == 0) {
+      // server that does not do Range
+      range_start = 0;
+      ignored_ranges++;
+    }
+
+    char header[256];
+    size_t length = body.size() - range_start;
+    if(range_start > 0)
+      snprintf(header, sizeof(header), "HTTP/1.0 206 Partial Content\r\nContent-Range: bytes %u-%zu/%zu\r\nContent-Length: %zu\r\n\r\n", range_start, body.size() - 1, body.size(), length);
+    else
+      snprintf(header, sizeof(header), "HTTP/1.0 200 OK\r\nContent-Length: %zu\r\n\r\n", length);
+    if(!SendAll(connection, (const uint8_t*)header, strlen(header))) return;
+
+    // firmware bodies: mostly dropped somewhere, sometimes a flipped byte
+    size_t drop_at = length;
+    if(&body == &firmware && random_generator_() % 8 != 0) {
+      drop_at = random_generator_() % std::min(length + 1, (size_t)kChunkSize * 3);
+      drops++;
+    }
+    size_t corrupt_at = SIZE_MAX;
+    if(&body == &firmware && random_generator_() % 12 == 0) {
+      corrupt_at = random_generator_() % length;
+      corruptions++;
+    }
+    for (size_t offset = 0; offset < drop_at; ) {
+      size_t piece = std::min(drop_at - offset, (size_t)(1 + random_generator_() % 3000));
+      std::vector<uint8_t> data(body.begin() + range_start + offset, body.begin() + range_start + offset + piece);
+      if(corrupt_at >= offset && corrupt_at < offset + piece)
+        data[corrupt_at - offset] ^= 0x10;
+      if(!SendAll(connection, data.data(), piece)) return;
+      offset += piece;
+    }
+  }
+
+  static bool SendAll(int connection, const uint8_t* data, size_t length) {
+    while(length > 0) {
+      ssize_t sent = send(connection, data, length, MSG_NOSIGNAL);
+      if(sent <= 0) return false;
+      data += sent;
+      length -= sent;
+    }
+    return true;
+  }
+
+};
+
+// one GET, body bytes to on_data(status, data, length) until it returns false or connection ends, returns HTTP status
+template<typename OnData> static int HttpGet(uint16_t port, const char* path, uint32_t range_start, int &content_length, OnData on_data) {
+  int connection = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(port);
+  if(connect(connection, (sockaddr*)&address, sizeof(address)) != 0) {
+    close(connection);
+    return -1;
+  }
+  char request[128];
+  int request_length = snprintf(request, sizeof(request), "GET %s HTTP/1.0\r\nRange: bytes=%u-\r\n\r\n", path, range_start);
+  send(connection, request, request_length, MSG_NOSIGNAL);
+
+  std::string header;
+  uint8_t buffer[512];
+  int status = -1;
+  content_length = -1;
+  while(true) {
+    ssize_t received = recv(connection, buffer, sizeof(buffer), 0);
+    if(received <= 0) break;
+    if(status < 0) {
+      header.append((const char*)buffer, received);
+      size_t header_end = header.find("\r\n\r\n");
+      if(header_end == std::string::npos) continue;
+      status = atoi(header.c_str() + strlen("HTTP/1.0 "));
+      size_t length_field = header.find("Content-Length: ");
+      if(length_field != std::string::npos) content_length = atoi(header.c_str() + length_field + strlen("Content-Length: "));
+      size_t body_start = header_end + 4;
+      if(header.size() > body_start && !on_data(status, (const uint8_t*)header.data() + body_start, header.size() - body_start))
+        break;
+    }
+    else if(!on_data(status, buffer, received))
+      break;
+  }
+  close(connection);
+  return status;
+}
+
+struct DownloadStats {
+  uint32_t drops = 0, ignored_ranges = 0, corruptions = 0, reboots = 0, resumed_bytes_lost = 0;
+};
+
+static void TestFaultyDownload(uint32_t seed, const std::vector<uint8_t> &firmware, const std::vector<uint8_t> &manifest, DownloadStats &stats) {
+  std::mt19937 random_generator(seed);
+  FaultyRangeServer server;
+  server.firmware = firmware;
+  server.manifest = manifest;
+  uint16_t port = server.Start(seed);
+
+  FakeFlash flash;
+  OtaCheckpointRecord checkpoint = {};     // as in NVS
+  uint32_t reboots = 0, failed_connections = 0, resumed_bytes_lost = 0, flash_corruptions = 0, fed_bytes = 0;
+  bool complete = false;
+  for (uint32_t boot = 0; boot < 200 && !complete; boot++) {
+    OtaChunkedWriter* writer = new OtaChunkedWriter;
+    std::vector<uint8_t> downloaded_manifest;
+    int manifest_size;
+    CHECK_EQ(HttpGet(port, "/fw.bin.manifest", 0, manifest_size, [&](int status, const uint8_t* data, size_t length) {
+      downloaded_manifest.insert(downloaded_manifest.end(), data, data + length);
+      return true;
+    }), 200);
+    CHECK(writer->SetManifest(downloaded_manifest.data(), downloaded_manifest.size(), FlashWrite, FlashErase, FlashRead, &flash));
+    if(memcmp(checkpoint.image_sha256, writer->manifest().image_sha256, sizeof(checkpoint.image_sha256)) == 0) {
+      uint32_t resumed = writer->Resume(checkpoint.bytes_done);
+      CHECK(resumed <= checkpoint.bytes_done);
+      CHECK_EQ(resumed % kChunkSize, 0);
+      resumed_bytes_lost += checkpoint.bytes_done - resumed;
+    }
+    memcpy(checkpoint.image_sha256, writer->manifest().image_sha256, sizeof(checkpoint.image_sha256));
+    checkpoint.bytes_done = writer->bytes_done();
+
+    // connections of this boot, a reboot with some probability after each failure
+    bool reboot = false;
+    while(!writer->Complete() && !reboot) {
+      uint32_t range_start = writer->bytes_done();
+      int remaining_bytes;
+      int status = HttpGet(port, "/fw.bin", range_start, remaining_bytes, [&](int status, const uint8_t* data, size_t length) {
+        // a server that ignores Range sends whole file, taken only when asked from 0
+        if(status != 206 && !(status == 200 && range_start == 0))
+          return false;
+        fed_bytes += length;
+        if(!writer->Feed(data, length))
+          return false;
+        if(writer->bytes_done() != checkpoint.bytes_done) {
+          CHECK(writer->bytes_done() > checkpoint.bytes_done);
+          checkpoint.bytes_done = writer->bytes_done();
+        }
+        return !writer->Complete();
+      });
+      CHECK(status == 206 || status == 200);
+      if(status == 200 && range_start > 0)
+        CHECK_EQ(writer->bytes_done(), range_start);
+      writer->DropPartialChunk();
+      if(writer->Complete()) break;
+      failed_connections++;
+      reboot = (random_generator() % 4 == 0);
+    }
+
+    if(reboot) {
+      reboots++;
+      // power lost mid-write: some of next chunk's bytes may be in flash
+      uint32_t next_chunk = writer->bytes_done();
+      if(next_chunk < firmware.size() && random_generator() % 2 == 0) {
+        size_t partial = std::min((size_t)(random_generator() % kChunkSize), firmware.size() - next_chunk);
+        memcpy(flash.bytes.data() + next_chunk, firmware.data() + next_chunk, partial);
+      }
+      // a done chunk no longer reads back right
+      if(checkpoint.bytes_done > 0 && random_generator() % 5 == 0) {
+        flash.bytes[random_generator() % checkpoint.bytes_done] ^= 0x01;
+        flash_corruptions++;
+      }
+    }
+    complete = writer->Complete();
+    delete writer;
+  }
+  server.Stop();
+
+  CHECK(complete);
+  CHECK(memcmp(flash.bytes.data(), firmware.data(), firmware.size()) == 0);
+  // verified chunks are not downloaded again, except the corrupted ones found on resume,
+  // a failed connection costs at most the chunk it was in
+  CHECK(fed_bytes - firmware.size() <= failed_connections * kChunkSize + resumed_bytes_lost);
+  if(resumed_bytes_lost > 0) CHECK(flash_corruptions > 0);
+  stats.drops += server.drops;
+  stats.ignored_ranges += server.ignored_ranges;
+  stats.corruptions += server.corruptions;
+  stats.reboots += reboots;
+  stats.resumed_bytes_lost += resumed_bytes_lost;
+}
+
+static void TestManifest(const std::vector<uint8_t> &firmware, const std::vector<uint8_t> &manifest) {
+  FakeFlash flash;
+  OtaChunkedWriter writer;
+  CHECK(writer.SetManifest(manifest.data(), manifest.size(), FlashWrite, FlashErase, FlashRead, &flash));
+  CHECK_EQ(writer.manifest().image_size, firmware.size());
+  CHECK_EQ(1 << writer.manifest().chunk_sz2, kChunkSize);
+  // cut short, or with magic or chunk size out of range
+  CHECK(!writer.SetManifest(manifest.data(), manifest.size() - 1, FlashWrite, FlashErase, FlashRead, &flash));
+  std::vector<uint8_t> bad = manifest;
+  bad[0] = 'X';
+  CHECK(!writer.SetManifest(bad.data(), bad.size(), FlashWrite, FlashErase, FlashRead, &flash));
+  bad = manifest;
+  bad[5] = 11;
+  CHECK(!writer.SetManifest(bad.data(), bad.size(), FlashWrite, FlashErase, FlashRead, &flash));
+
+  // nothing to resume on blank flash, a whole image in one feed
+  CHECK(writer.SetManifest(manifest.data(), manifest.size(), FlashWrite, FlashErase, FlashRead, &flash));
+  CHECK_EQ(writer.Resume(firmware.size()), 0);
+  CHECK(writer.Feed(firmware.data(), firmware.size()));
+  CHECK(writer.Complete());
+  CHECK(flash.erased_bytes >= firmware.size() && flash.erased_bytes < firmware.size() + OtaChunkedWriter::kFlashSectorSize);
+  CHECK_EQ(writer.Resume(firmware.size()), firmware.size());
+  CHECK_EQ(writer.Resume(firmware.size() - 1), firmware.size() / kChunkSize * kChunkSize);
+}
+
+int main() {
+  CHECK(system("mkdir -p build/ota") == 0);
+  std::mt19937 random_generator(44);
+  std::vector<uint8_t> firmware(300 * 1000 + 123);
+  for (uint8_t &byte : firmware)
+    byte = random_generator();
+  std::ofstream("build/ota/raw.bin", std::ios::binary).write((const char*)firmware.data(), firmware.size());
+  CHECK(system("python3 ../tools/ota_image.py manifest build/ota/raw.bin build/ota/raw.bin.manifest > /dev/null") == 0);
+  std::vector<uint8_t> manifest = ReadFile("build/ota/raw.bin.manifest");
+
+  TestManifest(firmware, manifest);
+  DownloadStats stats;
+  for (uint32_t seed = 1; seed <= 20; seed++)
+    TestFaultyDownload(seed, firmware, manifest, stats);
+  // every fault was injected
+  CHECK(stats.drops > 20 && stats.ignored_ranges > 0 && stats.corruptions > 0 && stats.reboots > 5 && stats.resumed_bytes_lost > 0);
+  printf("%u connections dropped, %u ignored Range, %u corrupted, %u reboots, %u done bytes found corrupt on resume\n",
+    stats.drops, stats.ignored_ranges, stats.corruptions, stats.reboots, stats.resumed_bytes_lost);
+  return CHECK_RESULT();
+}
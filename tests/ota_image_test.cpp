@@ -0,0 +1,455 @@
+// OtaImageDecoder against images made by tools/ota_image.py from synthetic firmware:
+// compressed and delta images are fed in many chunkings and must write exactly the firmware,
+// a delta against another base, truncated, corrupted and bad header images must fail
+// without writing past image size. Host SHA-256 is checked against FIPS 180-4 vectors first.
+// Then the committed S2 Mini binary and an edited copy of it as next version are made into
+// images and served by a local HTTP server on a loopback socket, read as
+// WiFiStuff::UpdateFirmwareFromOtaImage() reads them: header first, then 512 byte reads.
+// Needs python3 to run the image tool.
+
+#include "ota_image.h"
+#include "check.h"
+#include <arpa/inet.h>
+#include <atomic>
+#include <fstream>
+#include <iterator>
+#include <netinet/in.h>
+#include <random>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+static const char* kDirectory = "build/ota";
+static const char* kBuildBinary = "../build/esp32.esp32.lolin_s2_mini/long_press_alarm_clock.ino.bin";
+
+static std::vector<uint8_t> ReadFile(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  CHECK(file.good());
+  return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static void WriteFile(const std::string &path, const std::vector<uint8_t> &data) {
+  std::ofstream file(path, std::ios::binary);
+  file.write((const char*)data.data(), data.size());
+}
+
+static std::string Hex(const uint8_t* data, size_t length) {
+  std::string hex;
+  char digits[3];
+  for (size_t i = 0; i < length; i++) {
+    snprintf(digits, sizeof(digits), "%02x", data[i]);
+    hex += digits;
+  }
+  return hex;
+}
+
+static std::string Sha256Hex(const uint8_t* data, size_t length) {
+  mbedtls_sha256_context sha256;
+  uint8_t digest[32];
+  mbedtls_sha256_init(&sha256);
+  mbedtls_sha256_starts(&sha256, /*is224 = */ 0);
+  // in uneven pieces, across block boundaries
+  for (size_t offset = 0; offset < length; ) {
+    size_t piece = std::min(length - offset, (size_t)(offset % 97 + 1));
+    mbedtls_sha256_update(&sha256, data + offset, piece);
+    offset += piece;
+  }
+  mbedtls_sha256_finish(&sha256, digest);
+  mbedtls_sha256_free(&sha256);
+  return Hex(digest, sizeof(digest));
+}
+
+static void TestSha256() {
+  CHECK_STR(Sha256Hex(NULL, 0), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+  CHECK_STR(Sha256Hex((const uint8_t*)"abc", 3), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+  const char* two_blocks = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+  CHECK_STR(Sha256Hex((const uint8_t*)two_blocks, strlen(two_blocks)), "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+  std::vector<uint8_t> million_a(1000000, 'a');
+  CHECK_STR(Sha256Hex(million_a.data(), million_a.size()), "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+}
+
+// firmware-like: instruction-ish repeats, string tables, random constants and erased padding
+static std::vector<uint8_t> MakeFirmware(uint32_t seed, size_t size) {
+  std::mt19937 random_generator(seed);
+  std::vector<uint8_t> firmware;
+  static const char* kStrings[] = { "WiFiStuff::GetTodaysWeatherInfo()", "alarm_clock", "Long Press Alarm Clock", "ButtonEvents: edge ring overflows " };
+  while(firmware.size() < size) {
+    switch(random_generator() % 4) {
+      case 0:
+        for (int i = random_generator() % 200; i > 0; i--) {
+          static const uint8_t kInstructions[][3] = { { 0x36, 0x41, 0x00 }, { 0x1d, 0xf0, 0x00 }, { 0x0c, 0x02, 0x81 }, { 0xe5, 0x12, 0x00 } };
+          const uint8_t* instruction = kInstructions[random_generator() % 4];
+          firmware.insert(firmware.end(), instruction, instruction + 3);
+        }
+        break;
+      case 1: {
+        const char* string = kStrings[random_generator() % 4];
+        firmware.insert(firmware.end(), string, string + strlen(string) + 1);
+        break;
+      }
+      case 2:
+        for (int i = random_generator() % 300; i > 0; i--) firmware.push_back(random_generator());
+        break;
+      case 3:
+        firmware.insert(firmware.end(), random_generator() % 64, 0xFF);
+        break;
+    }
+  }
+  firmware.resize(size);
+  return firmware;
+}
+
+// next version: edits, an inserted function shifting everything after it, a removed block
+static std::vector<uint8_t> MakeNextFirmware(const std::vector<uint8_t> &base) {
+  std::mt19937 random_generator(43);
+  std::vector<uint8_t> firmware = base;
+  for (int i = 0; i < 40; i++)
+    firmware[random_generator() % firmware.size()] ^= 0x5A;
+  std::vector<uint8_t> inserted = MakeFirmware(7, 3000);
+  firmware.insert(firmware.begin() + firmware.size() / 3, inserted.begin(), inserted.end());
+  firmware.erase(firmware.begin() + firmware.size() * 2 / 3, firmware.begin() + firmware.size() * 2 / 3 + 1500);
+  return firmware;
+}
+
+struct Target {
+  std::vector<uint8_t> written;
+  const std::vector<uint8_t>* base = NULL;
+  size_t fail_write_after = SIZE_MAX;   // bytes
+};
+
+static bool Write(const uint8_t* data, size_t length, void* context) {
+  Target* target = (Target*)context;
+  if(target->written.size() + length > target->fail_write_after) return false;
+  target->written.insert(target->written.end(), data, data + length);
+  return true;
+}
+
+static bool BaseRead(uint32_t offset, uint8_t* data, size_t length, void* context) {
+  Target* target = (Target*)context;
+  if(target->base == NULL || offset + length > target->base->size()) return false;
+  memcpy(data, target->base->data() + offset, length);
+  return true;
+}
+
+// feeds image in pieces of chunk bytes (0 = random pieces), returns Finish()
+static bool Decode(const std::vector<uint8_t> &image, Target &target, size_t chunk, OtaImageDecoder::Error &error, std::mt19937* random_generator = NULL) {
+  OtaImageDecoder* decoder = new OtaImageDecoder;    // large window buffer, like on the clock's heap
+  decoder->Begin(Write, BaseRead, &target);
+  bool fed = true;
+  for (size_t offset = 0; offset < image.size() && fed; ) {
+    size_t length = (chunk > 0 ? chunk : 1 + (*random_generator)() % 1500);
+    length = std::min(length, image.size() - offset);
+    fed = decoder->Feed(image.data() + offset, length);
+    offset += length;
+  }
+  bool finished = fed && decoder->Finish();
+  error = decoder->error();
+  // never more than header's image size reaches the writer
+  CHECK(!decoder->HeaderReady() || target.written.size() <= decoder->header().image_size);
+  CHECK(fed || !finished);
+  delete decoder;
+  return finished;
+}
+
+static bool Tool(const std::string &arguments) {
+  std::string command = "python3 ../tools/ota_image.py " + arguments + " > /dev/null";
+  return system(command.c_str()) == 0;
+}
+
+// HTTP/1.0 server of images by path, one connection at a time, body in random pieces as TCP
+// segments and TLS records come, 404 for others
+class ImageServer {
+
+public:
+
+  std::vector<std::pair<std::string, std::vector<uint8_t>>> files;    // path, content
+
+  uint16_t Start() {
+    listen_socket_ = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    CHECK(bind(listen_socket_, (sockaddr*)&address, sizeof(address)) == 0);
+    CHECK(listen(listen_socket_, 4) == 0);
+    socklen_t address_length = sizeof(address);
+    getsockname(listen_socket_, (sockaddr*)&address, &address_length);
+    thread_ = std::thread(&ImageServer::Serve, this);
+    return ntohs(address.sin_port);
+  }
+
+  void Stop() {
+    stop_ = true;
+    shutdown(listen_socket_, SHUT_RDWR);
+    close(listen_socket_);
+    thread_.join();
+  }
+
+private:
+
+  int listen_socket_ = -1;
+  std::atomic<bool> stop_{false};
+  std::thread thread_;
+  std::mt19937 random_generator_{45};
+
+  void Serve() {
+    while(!stop_) {
+      int connection = accept(listen_socket_, NULL, NULL);
+      if(connection < 0) continue;
+      Respond(connection);
+      close(connection);
+    }
+  }
+
+  void Respond(int connection) {
+    std::string request;
+    char buffer[512];
+    while(request.find("\r\n\r\n") == std::string::npos) {
+      ssize_t received = recv(connection, buffer, sizeof(buffer), 0);
+      if(received <= 0) return;
+      request.append(buffer, received);
+    }
+    const std::vector<uint8_t>* body = NULL;
+    for (const auto &file : files)
+      if(request.find("GET " + file.first + " ") == 0)
+        body = &file.second;
+    std::string header = (body == NULL ? "HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\n\r\n"
+                                       : "HTTP/1.0 200 OK\r\nContent-Length: " + std::to_string(body->size()) + "\r\n\r\n");
+    if(send(connection, header.data(), header.size(), MSG_NOSIGNAL) <= 0 || body == NULL) return;
+    for (size_t offset = 0; offset < body->size(); ) {
+      size_t piece = std::min(body->size() - offset, (size_t)(1 + random_generator_() % 3000));
+      if(send(connection, body->data() + offset, piece, MSG_NOSIGNAL) <= 0) return;
+      offset += piece;
+    }
+  }
+
+};
+
+struct ImageDownload {
+  int status = 0;
+  bool update_started = false;
+  uint32_t update_size = 0;                 // size given to Update.begin()
+  size_t written_before_update = 0;         // firmware bytes that reached the writer before Update.begin()
+  uint32_t image_bytes_read = 0;
+  OtaImageDecoder::Error error = OtaImageDecoder::kOk;
+  bool success = false;
+};
+
+// GET of an image, decoded as in WiFiStuff::UpdateFirmwareFromOtaImage(): status line and headers
+// are read line by line, then the image header alone, so that Update is begun with the firmware
+// size before any firmware byte, then the rest in reads of up to 512 bytes
+static ImageDownload DownloadImage(uint16_t port, const std::string &path, Target &target) {
+  ImageDownload download;
+  int connection = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(port);
+  CHECK(connect(connection, (sockaddr*)&address, sizeof(address)) == 0);
+  std::string request = "GET " + path + " HTTP/1.0\r\n\r\n";
+  send(connection, request.data(), request.size(), MSG_NOSIGNAL);
+
+  std::string line;
+  int remaining_bytes = -1;
+  char c;
+  while(recv(connection, &c, 1, 0) == 1) {
+    if(c != '\n') {
+      line += c;
+      continue;
+    }
+    if(download.status == 0)
+      download.status = atoi(line.c_str() + strlen("HTTP/1.0 "));
+    else if(line.find("Content-Length: ") == 0)
+      remaining_bytes = atoi(line.c_str() + strlen("Content-Length: "));
+    else if(line == "\r")
+      break;
+    line.clear();
+  }
+  if(download.status != 200) {
+    close(connection);
+    return download;
+  }
+
+  OtaImageDecoder* decoder = new OtaImageDecoder;
+  decoder->Begin(Write, BaseRead, &target);
+  uint8_t buffer[512];
+  while(remaining_bytes > 0 || remaining_bytes == -1) {
+    size_t read_size = (download.update_started ? sizeof(buffer) : OtaImageDecoder::kHeaderSize - download.image_bytes_read);
+    if(remaining_bytes > 0) read_size = std::min(read_size, (size_t)remaining_bytes);
+    ssize_t read_bytes = recv(connection, buffer, read_size, 0);
+    if(read_bytes <= 0) break;
+    download.image_bytes_read += read_bytes;
+    if(remaining_bytes > 0) remaining_bytes -= read_bytes;
+    if(!decoder->Feed(buffer, read_bytes))
+      break;
+    if(!download.update_started && decoder->HeaderReady()) {
+      download.update_started = true;
+      download.update_size = decoder->header().image_size;
+      download.written_before_update = target.written.size();
+    }
+  }
+  close(connection);
+  download.success = (download.update_started && decoder->Finish());
+  download.error = decoder->error();
+  delete decoder;
+  return download;
+}
+
+// the committed S2 Mini binary as running firmware, an edited copy of it as next version
+static void TestBuildBinaryOverHttp() {
+  std::string directory = kDirectory;
+  std::vector<uint8_t> running = ReadFile(kBuildBinary), next = MakeNextFirmware(running);
+  CHECK(running.size() > 1000 * 1000);
+  WriteFile(directory + "/s2_next.bin", next);
+  CHECK(Tool("compress " + std::string(kBuildBinary) + " " + directory + "/s2_running.lpoi"));
+  CHECK(Tool("compress " + directory + "/s2_next.bin " + directory + "/s2_next.lpoi"));
+  CHECK(Tool("delta " + std::string(kBuildBinary) + " " + directory + "/s2_next.bin " + directory + "/s2_delta.lpoi"));
+  std::vector<uint8_t> running_image = ReadFile(directory + "/s2_running.lpoi"), next_image = ReadFile(directory + "/s2_next.lpoi"),
+    delta_image = ReadFile(directory + "/s2_delta.lpoi");
+  CHECK(running_image.size() < running.size() * 4 / 5);
+  CHECK(next_image.size() < next.size() * 4 / 5);
+  CHECK(delta_image.size() < next.size() / 100);
+  printf("S2 Mini build binary %zu bytes, compressed image %zu bytes (%.1f%%), next version %zu bytes, compressed %zu bytes, delta %zu bytes (%.2f%%)\n",
+    running.size(), running_image.size(), 100.0 * running_image.size() / running.size(), next.size(), next_image.size(), delta_image.size(), 100.0 * delta_image.size() / next.size());
+
+  ImageServer server;
+  server.files.push_back({ "/running.lpoi", running_image });
+  server.files.push_back({ "/long_press_alarm_clock.ino.bin.lpoi", next_image });
+  server.files.push_back({ "/delta_from_2.4.lpoi", delta_image });
+  uint16_t port = server.Start();
+
+  // compressed images of both versions, delta from running version
+  struct { const char* path; const std::vector<uint8_t>* firmware; const std::vector<uint8_t>* image; } kDownloads[] = {
+    { "/running.lpoi", &running, &running_image },
+    { "/long_press_alarm_clock.ino.bin.lpoi", &next, &next_image },
+    { "/delta_from_2.4.lpoi", &next, &delta_image },
+  };
+  for (const auto &expected : kDownloads) {
+    Target target;
+    target.base = &running;
+    ImageDownload download = DownloadImage(port, expected.path, target);
+    CHECK_EQ(download.status, 200);
+    CHECK(download.success);
+    CHECK_EQ(download.error, OtaImageDecoder::kOk);
+    CHECK_EQ(download.update_size, expected.firmware->size());
+    CHECK_EQ(download.written_before_update, 0);
+    CHECK_EQ(download.image_bytes_read, expected.image->size());
+    CHECK(target.written == *expected.firmware);
+  }
+
+  // delta on a clock already running next version: rejected at header, Update is not begun
+  Target target;
+  target.base = &next;
+  ImageDownload download = DownloadImage(port, "/delta_from_2.4.lpoi", target);
+  CHECK(!download.success && !download.update_started);
+  CHECK_EQ(download.error, OtaImageDecoder::kBaseMismatch);
+  CHECK_EQ(download.image_bytes_read, OtaImageDecoder::kHeaderSize);
+  CHECK_EQ(target.written.size(), 0);
+
+  // no delta from this version: falls back to compressed image
+  target = Target();
+  download = DownloadImage(port, "/delta_from_2.3.lpoi", target);
+  CHECK_EQ(download.status, 404);
+  CHECK(!download.update_started);
+  server.Stop();
+}
+
+int main() {
+  TestSha256();
+
+  std::string directory = kDirectory;
+  CHECK(system(("mkdir -p " + directory).c_str()) == 0);
+  std::vector<uint8_t> base = MakeFirmware(1, 160 * 1024), firmware = MakeNextFirmware(base), other_base = MakeFirmware(2, 160 * 1024);
+  WriteFile(directory + "/base.bin", base);
+  WriteFile(directory + "/firmware.bin", firmware);
+  CHECK(Tool("compress " + directory + "/firmware.bin " + directory + "/full.lpoi"));
+  CHECK(Tool("delta " + directory + "/base.bin " + directory + "/firmware.bin " + directory + "/delta.lpoi"));
+  std::vector<uint8_t> full_image = ReadFile(directory + "/full.lpoi"), delta_image = ReadFile(directory + "/delta.lpoi");
+  CHECK(full_image.size() < firmware.size() * 3 / 4);
+  CHECK(delta_image.size() < firmware.size() / 10);
+  printf("firmware %zu bytes, compressed image %zu bytes, delta image %zu bytes\n", firmware.size(), full_image.size(), delta_image.size());
+
+  // uncompressed image, header laid out by hand
+  std::vector<uint8_t> raw_image(OtaImageDecoder::kHeaderSize);
+  OtaImageDecoder::Header* header = (OtaImageDecoder::Header*)raw_image.data();
+  memcpy(header->magic, "LPOI", 4);
+  header->format_version = 1;
+  header->image_size = firmware.size();
+  mbedtls_sha256_context sha256;
+  mbedtls_sha256_init(&sha256);
+  mbedtls_sha256_starts(&sha256, /*is224 = */ 0);
+  mbedtls_sha256_update(&sha256, firmware.data(), firmware.size());
+  mbedtls_sha256_finish(&sha256, header->image_sha256);
+  raw_image.insert(raw_image.end(), firmware.begin(), firmware.end());
+
+  std::mt19937 random_generator(43);
+  OtaImageDecoder::Error error;
+  for (const std::vector<uint8_t>* image : { &raw_image, &full_image, &delta_image }) {
+    for (size_t chunk : { (size_t)1, (size_t)7, (size_t)64, (size_t)512, (size_t)4096, image->size(), (size_t)0 }) {
+      Target target;
+      target.base = &base;
+      CHECK(Decode(*image, target, chunk, error, &random_generator));
+      CHECK_EQ(error, OtaImageDecoder::kOk);
+      CHECK(target.written == firmware);
+    }
+  }
+
+  // delta on a clock running other firmware
+  Target target;
+  target.base = &other_base;
+  CHECK(!Decode(delta_image, target, 512, error));
+  CHECK_EQ(error, OtaImageDecoder::kBaseMismatch);
+  CHECK_EQ(target.written.size(), 0);
+  target = Target();
+  CHECK(!Decode(delta_image, target, 512, error));
+  CHECK_EQ(error, OtaImageDecoder::kBaseMismatch);
+
+  // download cut short
+  for (const std::vector<uint8_t>* image : { &raw_image, &full_image, &delta_image }) {
+    std::vector<uint8_t> truncated(image->begin(), image->begin() + image->size() * 9 / 10);
+    target = Target();
+    target.base = &base;
+    CHECK(!Decode(truncated, target, 512, error));
+    CHECK_EQ(error, OtaImageDecoder::kSizeMismatch);
+  }
+
+  // flash write failing half way
+  target = Target();
+  target.fail_write_after = firmware.size() / 2;
+  CHECK(!Decode(full_image, target, 512, error));
+  CHECK_EQ(error, OtaImageDecoder::kWriteFailed);
+
+  // bad headers
+  for (int field = 0; field < 4; field++) {
+    std::vector<uint8_t> bad = full_image;
+    OtaImageDecoder::Header* bad_header = (OtaImageDecoder::Header*)bad.data();
+    if(field == 0) bad_header->magic[3] = 'X';
+    if(field == 1) bad_header->format_version = 2;
+    if(field == 2) bad_header->window_sz2 = OtaImageDecoder::kMaxWindowSz2 + 1;
+    if(field == 3) bad_header->lookahead_sz2 = bad_header->window_sz2;
+    target = Target();
+    CHECK(!Decode(bad, target, 512, error));
+    CHECK_EQ(error, OtaImageDecoder::kBadHeader);
+    CHECK_EQ(target.written.size(), 0);
+  }
+
+  // corrupted payload bytes: must fail one way or another, within buffers (ASan) and image size
+  int corrupted_failed = 0;
+  for (int i = 0; i < 300; i++) {
+    const std::vector<uint8_t> &image = (i % 2 ? full_image : delta_image);
+    std::vector<uint8_t> corrupted = image;
+    for (int flips = 1 + random_generator() % 3; flips > 0; flips--) {
+      size_t position = OtaImageDecoder::kHeaderSize + random_generator() % (image.size() - OtaImageDecoder::kHeaderSize);
+      corrupted[position] ^= 1 << (random_generator() % 8);
+    }
+    target = Target();
+    target.base = &base;
+    if(!Decode(corrupted, target, 1 + random_generator() % 2000, error))
+      corrupted_failed++;
+  }
+  CHECK_EQ(corrupted_failed, 300);
+
+  TestBuildBinaryOverHttp();
+  return CHECK_RESULT();
+}
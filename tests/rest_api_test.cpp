@@ -0,0 +1,198 @@
+// REST API of the real sketch, body parsing and end to end over a loopback socket: the whole
+// sketch runs on the host stand-ins with the fake WiFiStuff of sim/ and token "sim" from the
+// Makefile's MY_REST_API_TOKEN, the location server is started as from its page, and requests
+// come from a plain HTTP client. Checks bearer token handling, PUT bodies accepted and rejected
+// by ParseAlarms() / ParseSettings(), the one batch mailbox, and that loop() applies an accepted
+// PUT to the clock and saves it to NVS in one commit that survives a reboot.
+
+#include "common.h"
+#include "host.h"
+#include "check.h"
+#include "sim.h"
+#include "rest_api.h"
+#include "alarm_clock.h"
+#include "rgb_display.h"
+#include "wifi_stuff.h"
+#include "nvs_preferences.h"
+#include <uRTCLib.h>
+
+void setup();
+void loop();
+
+const std::string kToken = "Authorization: Bearer sim\r\n";
+
+static std::string ParseSettings(const std::string &body, SettingsBatch &batch) {
+  const char* error = RestApi::ParseSettings(body.data(), body.size(), batch);
+  return (error == NULL ? "" : error);
+}
+
+static std::string ParseAlarms(const std::string &body, SettingsBatch &batch) {
+  const char* error = RestApi::ParseAlarms(body.data(), body.size(), batch);
+  return (error == NULL ? "" : error);
+}
+
+static void TestParseSettings() {
+  SettingsBatch batch = {};
+  CHECK_STR(ParseSettings("{\"long_press_seconds\":25,\"night_dim_hour\":11,\"rgb_strip_mode\":1,\"screensaver_bounce\":false}", batch), "");
+  CHECK_EQ(batch.fields, kSettingsLongPressSeconds | kSettingsNightTimeDimHour | kSettingsAutorunRgbLedStripMode | kSettingsScreensaverMotion);
+  CHECK_EQ(batch.long_press_seconds, 25);
+  CHECK_EQ(batch.night_time_dim_hour, 11);
+  CHECK_EQ(batch.autorun_rgb_led_strip_mode, 1);
+  CHECK_EQ(batch.screensaver_bounce_not_fly_horizontally, false);
+  CHECK_STR(ParseSettings(" { \"night_dim_hour\" : 8 } ", batch), "");
+  CHECK_EQ(batch.fields, kSettingsNightTimeDimHour);
+
+  const char* rejected[][2] = {
+    { "{\"long_press_seconds\":10}", "invalid value" },      // not a step the settings page offers
+    { "{\"long_press_seconds\":35}", "invalid value" },
+    { "{\"long_press_seconds\":15.0}", "invalid value" },
+    { "{\"night_dim_hour\":12}", "invalid value" },
+    { "{\"rgb_strip_mode\":0}", "invalid value" },
+    { "{\"screensaver_bounce\":1}", "invalid value" },
+    { "{\"night_dim_hour\":9,\"night_dim_hour\":10}", "member repeated" },
+    { "{\"brightness\":5}", "unknown member" },
+    { "{}", "no settings" },
+    { "[]", "expected object" },
+    { "{\"night_dim_hour\":9", "malformed JSON" },
+    { "{\"night_dim_hour\":9}x", "malformed JSON" },
+  };
+  for (auto &body_error : rejected)
+    CHECK_STR(ParseSettings(body_error[0], batch), body_error[1]);
+}
+
+static void TestParseAlarms() {
+  SettingsBatch batch = {};
+  CHECK_STR(ParseAlarms("{\"alarms\":[{\"slot\":3,\"minute_of_day\":1439,\"on\":true,\"weekdays\":65},"
+    "{\"weekdays\":0,\"on\":false,\"minute_of_day\":0,\"slot\":0}]}", batch), "");
+  CHECK_EQ(batch.fields, kSettingsAlarmSchedule);
+  CHECK_EQ(batch.alarm_slots_mask, 0x09);
+  CHECK_EQ(batch.alarm_schedule[3].minute_of_day, 1439);
+  CHECK_EQ(batch.alarm_schedule[3].on, 1);
+  CHECK_EQ(batch.alarm_schedule[3].weekday_mask, 65);
+  CHECK_EQ(batch.alarm_schedule[0].on, 0);
+
+  const char* rejected[][2] = {
+    { "{\"alarms\":[{\"slot\":4,\"minute_of_day\":0,\"on\":true,\"weekdays\":1}]}", "alarm: invalid value" },
+    { "{\"alarms\":[{\"slot\":0,\"minute_of_day\":1440,\"on\":true,\"weekdays\":1}]}", "alarm: invalid value" },
+    { "{\"alarms\":[{\"slot\":0,\"minute_of_day\":0,\"on\":true,\"weekdays\":128}]}", "alarm: invalid value" },
+    { "{\"alarms\":[{\"slot\":0,\"minute_of_day\":0,\"on\":\"yes\",\"weekdays\":1}]}", "alarm: invalid value" },
+    { "{\"alarms\":[{\"slot\":0,\"minute_of_day\":0,\"on\":true}]}", "alarm: needs slot, minute_of_day, on and weekdays" },
+    { "{\"alarms\":[{\"slot\":0,\"minute_of_day\":0,\"on\":true,\"weekdays\":1,\"snooze\":5}]}", "alarm: unknown member" },
+    { "{\"alarms\":[{\"slot\":1,\"minute_of_day\":0,\"on\":true,\"weekdays\":1},"
+      "{\"slot\":1,\"minute_of_day\":5,\"on\":true,\"weekdays\":1}]}", "alarm: slot repeated" },
+    { "{\"alarms\":[]}", "no alarms" },
+    { "{\"alarms\":{}}", "alarms: expected array" },
+    { "{\"settings\":[]}", "unknown member" },
+    { "{\"alarms\":[1]}", "malformed JSON" },
+  };
+  for (auto &body_error : rejected)
+    CHECK_STR(ParseAlarms(body_error[0], batch), body_error[1]);
+}
+
+static void TestAuthorization() {
+  const std::string rejected_headers[] = {
+    "", "Authorization: Bearer si\r\n", "Authorization: Bearer simx\r\n", "Authorization: Bearer SIM\r\n",
+    "Authorization: Basic sim\r\n", "Authorization: sim\r\n",
+  };
+  for (const std::string &headers : rejected_headers) {
+    SimHttpResponse response = SimHttpRequest("GET", "/api/settings", "", headers);
+    CHECK_EQ(response.code, 401);
+    CHECK(response.headers.find("WWW-Authenticate: Bearer\r\n") != std::string::npos);
+    CHECK_STR(response.body, "{\"error\":\"unauthorized\"}");
+    CHECK_EQ(SimHttpRequest("PUT", "/api/settings", "{\"night_dim_hour\":9}", headers).code, 401);
+  }
+  CHECK_EQ(SimHttpRequest("GET", "/api/settings", "", kToken).code, 200);
+}
+
+// loop() iteration, returns NVS commits it made
+static uint32_t LoopCommits() {
+  uint32_t commits = HostNvsCommits();
+  loop();
+  return HostNvsCommits() - commits;
+}
+
+static void TestPutSettings() {
+  CHECK_EQ(LoopCommits(), 0);
+  SimHttpResponse response = SimHttpRequest("PUT", "/api/settings",
+    "{\"long_press_seconds\":5,\"night_dim_hour\":9,\"rgb_strip_mode\":3,\"screensaver_bounce\":false}", kToken);
+  CHECK_EQ(response.code, 202);
+  CHECK_STR(response.body, "{\"accepted\":true}");
+  // accepted, not applied until loop() takes it
+  CHECK_EQ(alarm_clock->alarm_long_press_seconds_, 15);
+  // mailbox holds one batch
+  CHECK_EQ(SimHttpRequest("PUT", "/api/settings", "{\"night_dim_hour\":11}", kToken).code, 503);
+
+  CHECK_EQ(LoopCommits(), 1);
+  CHECK_EQ(alarm_clock->alarm_long_press_seconds_, 5);
+  CHECK_EQ(night_time_minutes, 21 * 60);
+  CHECK_EQ(autorun_rgb_led_strip_mode, 3);
+  CHECK(!display->screensaver_bounce_not_fly_horizontally_);
+  CHECK_STR(SimHttpRequest("GET", "/api/settings", "", kToken).body,
+    "{\"long_press_seconds\":5,\"night_dim_hour\":9,\"rgb_strip_mode\":3,\"screensaver_bounce\":false}");
+  CHECK_EQ(LoopCommits(), 0);
+
+  // saved, as read back after a reboot
+  uint8_t long_press_seconds = 0;
+  nvs_preferences->RetrieveLongPressSeconds(long_press_seconds);
+  CHECK_EQ(long_press_seconds, 5);
+  CHECK_EQ(nvs_preferences->RetrieveNightTimeDimHour(), 9);
+  CHECK_EQ(nvs_preferences->RetrieveAutorunRgbLedStripMode(), 3);
+  CHECK(!nvs_preferences->RetrieveScreensaverBounceNotFlyHorizontally());
+}
+
+static void TestPutAlarms() {
+  AlarmSlot slot_0_before = alarm_clock->alarm_schedule_[0];
+  SimHttpResponse response = SimHttpRequest("PUT", "/api/alarms",
+    "{\"alarms\":[{\"slot\":2,\"minute_of_day\":390,\"on\":true,\"weekdays\":62}]}", kToken);
+  CHECK_EQ(response.code, 202);
+  CHECK_EQ(LoopCommits(), 1);
+  CHECK_EQ(alarm_clock->alarm_schedule_[2].minute_of_day, 390);
+  CHECK_EQ(alarm_clock->alarm_schedule_[2].on, 1);
+  CHECK_EQ(alarm_clock->alarm_schedule_[2].weekday_mask, 62);
+  // only listed slots change
+  CHECK_EQ(alarm_clock->alarm_schedule_[0].minute_of_day, slot_0_before.minute_of_day);
+  CHECK(SimHttpRequest("GET", "/api/alarms", "", kToken).body.find("{\"slot\":2,\"minute_of_day\":390,\"on\":true,\"weekdays\":62}") != std::string::npos);
+
+  AlarmSlot saved[kAlarmSlotsMax];
+  nvs_preferences->RetrieveAlarmSchedule(saved);
+  CHECK_EQ(saved[2].minute_of_day, 390);
+  CHECK_EQ(saved[2].weekday_mask, 62);
+  CHECK_EQ(saved[0].minute_of_day, slot_0_before.minute_of_day);
+}
+
+static void TestRejectedPuts() {
+  SimHttpResponse response = SimHttpRequest("PUT", "/api/settings", "{\"night_dim_hour\":7}", kToken);
+  CHECK_EQ(response.code, 400);
+  CHECK_STR(response.body, "{\"error\":\"invalid value\"}");
+  CHECK_EQ(SimHttpRequest("PUT", "/api/settings", "", kToken).code, 400);
+  // body over 512 bytes
+  std::string large = "{\"night_dim_hour\":9" + std::string(600, ' ') + "}";
+  CHECK_EQ(SimHttpRequest("PUT", "/api/settings", large, kToken).code, 413);
+  // body just under the limit is taken
+  std::string padded = "{\"night_dim_hour\":10" + std::string(480, ' ') + "}";
+  CHECK_EQ(SimHttpRequest("PUT", "/api/settings", padded, kToken).code, 202);
+  CHECK_EQ(LoopCommits(), 1);
+  CHECK_EQ(night_time_minutes, 22 * 60);
+  // nothing left pending by the rejected ones
+  CHECK_EQ(LoopCommits(), 0);
+}
+
+int main() {
+  TestParseSettings();
+  TestParseAlarms();
+
+  HostDs3231Set(0, 0, 6, 2, 3, 6, 24);
+  HostSetPin(BUTTON_PIN, HIGH);
+  HostSetPin(INC_BUTTON_PIN, HIGH);
+  HostSetPin(DEC_BUTTON_PIN, HIGH);
+  setup();
+  wifi_stuff->StartSetLocationLocalServer();
+  CHECK(HostWebServerPort() != 0);
+  HostTakeSerialOutput();
+
+  TestAuthorization();
+  TestPutSettings();
+  TestPutAlarms();
+  TestRejectedPuts();
+  return CHECK_RESULT();
+}
@@ -0,0 +1,145 @@
+// RTC time snapshot seqlock under concurrent writers and readers.
+// An ISR thread ticks the simulated DS3231 and raises SQW, so the seconds ISR advances the
+// snapshot; a core0 thread refreshes from RTC HW on new minutes; reader threads call Now().
+// Every copy a reader gets must be internally consistent and track the chip's time. Phases
+// cross noon, the year rollover and Feb 29 2028 in 12 hour mode.
+
+#include "rtc.h"
+#include "host.h"
+#include "check.h"
+#include <thread>
+#include <vector>
+
+const uint32_t kSeconds2000To2024 = 8766UL * 24 * 3600;
+
+static std::atomic<bool> stop_threads;
+static std::atomic<uint32_t> ticks_published, core0_ticks_seen;
+static std::atomic<uint64_t> reads;
+static std::atomic<int> bad_reads;
+
+static bool SnapshotConsistent(const RTC::TimeSnapshot &now) {
+  static const uint8_t kDaysInMonth[12] = { 31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+  if(now.second > 59 || now.minute > 59 || now.hour < 1 || now.hour > 12 || now.hour_mode_and_am_pm == 0)
+    return false;
+  if(now.month < 1 || now.month > 12 || now.day < 1 || now.day > kDaysInMonth[now.month - 1] || (now.month == 2 && now.day == 29 && now.year % 4 != 0))
+    return false;
+  if(now.todays_minutes != rtc->ClockTimeToDaysMinutes(now.hour_mode_and_am_pm, now.hour, now.minute))
+    return false;
+  // Jan 1 2024 was a Monday
+  uint32_t days = now.minutes_since_2024() / kMinutesInDay;
+  return now.day_of_week == (days + 1) % 7 + 1;
+}
+
+// snapshot time must lie within the chip's time around the read: ISR or a refresh may be a tick late
+static bool SnapshotTracksChip(const RTC::TimeSnapshot &now, uint32_t chip_before, uint32_t chip_after) {
+  uint32_t seconds = now.minutes_since_2024() * 60 + now.second + kSeconds2000To2024;
+  return seconds + 2 >= chip_before && seconds <= chip_after + 1;
+}
+
+static void CheckRead(const RTC::TimeSnapshot &now, uint32_t chip_before, uint32_t chip_after) {
+  reads++;
+  if(SnapshotConsistent(now) && SnapshotTracksChip(now, chip_before, chip_after))
+    return;
+  if(bad_reads++ < 5)
+    fprintf(stderr, "bad snapshot %04u-%02u-%02u dow %u %02u:%02u:%02u mode %u todays_minutes %u, chip %u..%u\n",
+      now.year, now.month, now.day, now.day_of_week, now.hour, now.minute, now.second, now.hour_mode_and_am_pm, now.todays_minutes,
+      chip_before, chip_after);
+}
+
+// DS3231 SQW 1 Hz, seconds ISR runs on its rising edge
+static void IsrThread(uint32_t seconds) {
+  for (uint32_t i = 1; i <= seconds; i++) {
+    // a second is long compared to an I2C refresh: core0 is at most one tick behind
+    while(core0_ticks_seen.load() + 1 < ticks_published.load())
+      std::this_thread::yield();
+    HostSetPin(SQW_INT_PIN, LOW);
+    HostDs3231Tick();
+    HostSetPin(SQW_INT_PIN, HIGH);
+    ticks_published = i;
+  }
+  stop_threads = true;
+}
+
+static void Core0Thread() {
+  while(!stop_threads) {
+    uint32_t ticks = ticks_published.load();
+    uint32_t chip_before = HostDs3231Seconds();
+    RTC::TimeSnapshot now = rtc->RefreshedNow();
+    CheckRead(now, chip_before, HostDs3231Seconds());
+    if(RTC::rtc_hw_min_update_)
+      RTC::rtc_hw_min_update_ = false;
+    core0_ticks_seen = ticks;
+  }
+}
+
+static void ReaderThread() {
+  for (uint32_t i = 1; !stop_threads; i++) {
+    uint32_t chip_before = HostDs3231Seconds();
+    RTC::TimeSnapshot now = rtc->Now();
+    CheckRead(now, chip_before, HostDs3231Seconds());
+    // let writers run on a single CPU host
+    if(i % 64 == 0)
+      std::this_thread::yield();
+  }
+}
+
+static void RunPhase(uint8_t hour_24, uint8_t minute, uint8_t day_of_week, uint8_t day, uint8_t month, uint16_t year, uint32_t seconds) {
+  rtc->SetRtcTimeAndDate(0, minute, hour_24, day_of_week, day, month, year);
+  stop_threads = false;
+  ticks_published = 0;
+  core0_ticks_seen = 0;
+  std::vector<std::thread> threads;
+  threads.emplace_back(Core0Thread);
+  threads.emplace_back(ReaderThread);
+  threads.emplace_back(ReaderThread);
+  threads.emplace_back(IsrThread, seconds);
+  for (std::thread &thread : threads)
+    thread.join();
+
+  // snapshot ends on chip time once refreshed on a minute
+  RTC::TimeSnapshot now = rtc->RefreshedNow();
+  CheckRead(now, HostDs3231Seconds(), HostDs3231Seconds());
+}
+
+int main() {
+  HostDs3231Set(0, 0, 0, 1, 1, 1, 24);
+  rtc = new RTC();
+  CHECK(rtc->hourModeAndAmPm() != 0);
+
+  // Friday Dec 31 2027 11:55 PM into New Year's day
+  RunPhase(23, 55, 6, 31, 12, 2027, 600);
+  CHECK_EQ(rtc->year(), 2028);
+  CHECK_EQ(rtc->month(), 1);
+  CHECK_EQ(rtc->day(), 1);
+  CHECK_EQ(rtc->dayOfWeek(), 7);
+  CHECK_EQ(rtc->hourModeAndAmPm(), 1);
+  CHECK_EQ(rtc->hour(), 12);
+  CHECK_EQ(rtc->minute(), 5);
+
+  // 11:55 AM into PM
+  RunPhase(11, 55, 7, 1, 1, 2028, 600);
+  CHECK_EQ(rtc->hourModeAndAmPm(), 2);
+  CHECK_EQ(rtc->hour(), 12);
+  CHECK_EQ(rtc->minute(), 5);
+
+  // Monday Feb 28 2028 into leap day, then leap day into March
+  RunPhase(23, 55, 2, 28, 2, 2028, 600);
+  CHECK_EQ(rtc->month(), 2);
+  CHECK_EQ(rtc->day(), 29);
+  CHECK_EQ(rtc->dayOfWeek(), 3);
+  RunPhase(23, 55, 3, 29, 2, 2028, 600);
+  CHECK_EQ(rtc->month(), 3);
+  CHECK_EQ(rtc->day(), 1);
+  CHECK_EQ(rtc->dayOfWeek(), 4);
+
+  // Feb 28 2029 into March, not a leap year
+  RunPhase(23, 55, 4, 28, 2, 2029, 600);
+  CHECK_EQ(rtc->month(), 3);
+  CHECK_EQ(rtc->day(), 1);
+  CHECK_EQ(rtc->dayOfWeek(), 5);
+
+  printf("%llu snapshot reads\n", (unsigned long long)reads.load());
+  CHECK(reads > 0);
+  CHECK_EQ(bad_reads.load(), 0);
+  return CHECK_RESULT();
+}
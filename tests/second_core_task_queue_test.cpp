@@ -0,0 +1,173 @@
+// SecondCoreTaskQueue ordering rules, then a multi producer stress run built with
+// ThreadSanitizer: producer threads submit tasks while a consumer thread runs and defers
+// them, and every submission must complete by a run that saw the producer's inputs.
+
+#include "second_core_task_queue.h"
+#include "host.h"
+#include "check.h"
+#include <thread>
+#include <vector>
+#include <random>
+
+SecondCoreTaskQueue second_core_tasks;
+
+static void TestOrdering() {
+  SecondCoreTaskQueue queue;
+  SecondCoreTask task;
+  CHECK(!queue.Pop(task));
+
+  // duplicate pending submission gets same handle, running task is queued once more
+  SecondCoreTaskHandle first = queue.Push(kGetWeatherInfo);
+  CHECK_EQ(queue.Push(kGetWeatherInfo).generation, first.generation);
+  CHECK(queue.Pop(task) && task == kGetWeatherInfo);
+  SecondCoreTaskHandle second = queue.Push(kGetWeatherInfo);
+  CHECK_EQ(second.generation, first.generation + 1);
+  CHECK_EQ(queue.Push(kGetWeatherInfo).generation, second.generation);
+  CHECK_EQ(queue.PendingCount(), 1);
+  queue.Done(task, true);
+  CHECK(queue.Completed(first) && queue.Succeeded(first));
+  CHECK(!queue.Completed(second));
+  CHECK(queue.Pop(task) && task == kGetWeatherInfo);
+  queue.Done(task, false);
+  CHECK(queue.Completed(second) && !queue.Succeeded(second));
+
+  // priority: time update before weather before firmware check, WiFi disconnect last
+  queue.Push(kDisconnectWiFi);
+  queue.Push(kFirmwareVersionCheck);
+  queue.Push(kGetWeatherInfo);
+  queue.Push(kUpdateTimeFromNtpServer);
+  const SecondCoreTask kPriorityOrder[] = { kUpdateTimeFromNtpServer, kGetWeatherInfo, kFirmwareVersionCheck, kDisconnectWiFi };
+  for (SecondCoreTask expected : kPriorityOrder) {
+    CHECK(queue.Pop(task) && task == expected);
+    queue.Done(task, true);
+  }
+
+  // paired tasks keep submission order whatever their priority
+  queue.Push(kStartSetWiFiSoftAP);
+  queue.Push(kStopSetWiFiSoftAP);
+  CHECK(queue.Pop(task) && task == kStartSetWiFiSoftAP);
+  queue.Done(task, true);
+  CHECK(queue.Pop(task) && task == kStopSetWiFiSoftAP);
+  queue.Done(task, true);
+  queue.Push(kDisconnectWiFi);
+  queue.Push(kConnectWiFi);
+  CHECK(queue.Pop(task) && task == kDisconnectWiFi);
+  queue.Done(task, true);
+  CHECK(queue.Pop(task) && task == kConnectWiFi);
+
+  // deferred task keeps its submission
+  queue.Defer(task);
+  CHECK_EQ(queue.PendingCount(), 1);
+  CHECK(queue.Pop(task) && task == kConnectWiFi);
+  queue.Done(task, true);
+  CHECK(!queue.Pop(task));
+
+  // stale task is dropped on Pop, its submission completes unsuccessfully
+  SecondCoreTaskHandle stale = queue.Push(kGetWeatherInfo, millis() + 1000);
+  SecondCoreTaskHandle fresh = queue.Push(kFirmwareVersionCheck, millis() + 5000);
+  HostAdvanceMillis(2000);
+  CHECK(queue.Pop(task) && task == kFirmwareVersionCheck);
+  CHECK(queue.Completed(stale) && !queue.Succeeded(stale));
+  queue.Done(task, true);
+  CHECK(queue.Succeeded(fresh));
+  CHECK(!queue.Pop(task));
+}
+
+const int kProducers = 3;
+const int kSubmissionsPerProducer = 20000;
+
+static std::atomic<uint32_t> next_input;
+static std::atomic<uint32_t> task_input[kNoTask];        // written by producers before Push
+static std::atomic<uint32_t> task_run_input[kNoTask];    // latest input a finished run of task saw
+static std::atomic<bool> producers_done, consumer_done;
+static std::atomic<int> stale_completions;
+
+static void Consumer() {
+  std::mt19937 random_generator(7);
+  SecondCoreTask task;
+  while(true) {
+    if(!second_core_tasks.Pop(task)) {
+      if(producers_done && second_core_tasks.PendingCount() == 0)
+        break;
+      std::this_thread::yield();
+      continue;
+    }
+    if(random_generator() % 8 == 0) {
+      second_core_tasks.Defer(task);
+      continue;
+    }
+    uint32_t input = task_input[task].load();
+    if(random_generator() % 4 == 0)
+      std::this_thread::yield();
+    // inputs only grow, keep the largest seen
+    uint32_t run_input = task_run_input[task].load();
+    while(run_input < input && !task_run_input[task].compare_exchange_weak(run_input, input)) {}
+    second_core_tasks.Done(task, true);
+  }
+  consumer_done = true;
+}
+
+static void CheckCompleted(SecondCoreTask task, uint32_t input) {
+  if(task_run_input[task].load() < input && stale_completions++ < 5)
+    fprintf(stderr, "task %d completed by a run that did not see input %u\n", task, input);
+}
+
+// polls for completion of some submissions
+static void Producer(int id) {
+  std::mt19937 random_generator(id);
+  for (int i = 0; i < kSubmissionsPerProducer; i++) {
+    SecondCoreTask task = (SecondCoreTask)(random_generator() % kNoTask);
+    uint32_t input = next_input++;
+    uint32_t previous_input = task_input[task].load();
+    while(previous_input < input && !task_input[task].compare_exchange_weak(previous_input, input)) {}
+    SecondCoreTaskHandle handle = second_core_tasks.Push(task);
+    CHECK(handle.task == task);
+    if(random_generator() % 16 == 0) {
+      while(!second_core_tasks.Completed(handle))
+        std::this_thread::yield();
+      CheckCompleted(task, input);
+    }
+  }
+}
+
+// like core0 loop, the one core sleeping in Wait()
+static void Waiter() {
+  std::mt19937 random_generator(99);
+  for (int i = 0; i < kSubmissionsPerProducer / 20; i++) {
+    SecondCoreTask task = (SecondCoreTask)(random_generator() % kNoTask);
+    uint32_t input = next_input++;
+    uint32_t previous_input = task_input[task].load();
+    while(previous_input < input && !task_input[task].compare_exchange_weak(previous_input, input)) {}
+    SecondCoreTaskHandle handle = second_core_tasks.Push(task);
+    CHECK(second_core_tasks.Wait(handle, 60000));
+    CheckCompleted(task, input);
+  }
+  // Done() may still notify this thread
+  while(!consumer_done)
+    std::this_thread::yield();
+}
+
+static void TestStress() {
+  std::vector<std::thread> producers;
+  std::thread consumer(Consumer);
+  std::thread waiter(Waiter);
+  for (int i = 0; i < kProducers; i++)
+    producers.emplace_back(Producer, i + 1);
+  for (std::thread &producer : producers)
+    producer.join();
+  producers_done = true;
+  consumer.join();
+  waiter.join();
+
+  CHECK_EQ(second_core_tasks.PendingCount(), 0);
+  CHECK_EQ(stale_completions.load(), 0);
+  // last submission of every task ran with its latest input
+  for (int task = 0; task < kNoTask; task++)
+    CHECK_EQ(task_run_input[task].load(), task_input[task].load());
+}
+
+int main() {
+  TestOrdering();
+  TestStress();
+  return CHECK_RESULT();
+}
@@ -0,0 +1,370 @@
+// Runs the clock sketch on the host in simulated time, days of clock operation in seconds.
+//
+//   clock_sim [--start "YYYY-MM-DD HH:MM:SS"] [--hours H] [--script FILE] [--rtc-ppm PPM]
+//             [--lost-power] [--no-weather-cache] [--max-weather-requests N] [--serial] [--quiet]
+//
+// The real setup(), loop() and loop1() of long_press_alarm_clock.ino run against the host
+// stand-ins: a DS3231 ticked by a 1 Hz SQW esp_timer, the ST7789 frame in memory, buttons and
+// touchscreen on scripted pins, NVS in memory and the fake WiFiStuff of fake_wifi_stuff.cpp.
+// Time is virtual and moves only by modeled costs (drawing, SPI, loop overhead) and delays.
+// When nothing is due, time jumps to the next timer or script event, so an idle minute costs a
+// few loop() calls. While the screensaver runs, an alarm rings, a button is held or a WiFi connect
+// or second core task is pending, loop() is polled at least every millisecond.
+//
+// Both cores run on one thread. loop1() runs after every loop() and inside delay() and task
+// waits of loop(), as the other core would while loop() waits. Interleaving within a function is
+// not modeled, so races between the cores are not found here, see second_core_task_queue_test.
+//
+// Output is a timeline of activity trace events and script actions, then CPU busy percentage per
+// simulated hour as closed by the clock's own accounting (CpuBusyHourJob), SPI busy percentage of
+// the display, weather HTTP requests of the fake WiFiStuff and the watchdog summary. Exit status is
+// 1 if the task watchdog would have rebooted the clock or there were more weather requests than
+// --max-weather-requests. --no-weather-cache fetches weather every time it is asked for, as the
+// clock did before its weather cache.
+//
+// Script lines are "<elapsed HH:MM:SS[.mmm]> <command>", elapsed from start, # starts a comment:
+//   press push|inc|dec|both [hold_ms]    button press, held 100 ms by default
+//   touch <x> <y> [hold_ms]              touch at screen pixel, 100 ms by default
+//   serial <text>                        serial input, newline added
+//   network up|down                      access point of the fake WiFi
+//   http <METHOD> <path> [body]          request to the running web server, response is printed
+//   screenshot <file.ppm>                display frame
+
+#include "common.h"
+#include "host.h"
+#include "sim.h"
+#include "alarm_clock.h"
+#include "button_events.h"
+#include "second_core_task_queue.h"
+#include "activity_trace.h"
+#include "rgb_display.h"
+#include "wifi_stuff.h"
+#include <esp_timer.h>
+#include <uRTCLib.h>
+#include <XPT2046_Touchscreen.h>
+#include <time.h>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+
+void setup();
+void loop();
+void loop1();
+
+static const double kLoopOverheadUs = 4;        // loop() and loop1() with nothing due, at 240 MHz
+static const uint64_t kPollUs = 1000;           // polling step while something is going on
+static const uint64_t kInputSettleUs = 300000;  // debounce, repeat and UI response after an input
+
+static uint64_t end_us = 0;
+static int max_weather_requests = -1;
+static bool quiet = false;
+static std::multimap<uint64_t, std::function<void()>> script;
+static uint64_t last_input_us = 0;
+static std::chrono::steady_clock::time_point wall_start;
+
+// elapsed simulated time as +HH:MM:SS.mmm
+static std::string Elapsed(uint64_t us) {
+  char text[32];
+  uint64_t ms = us / 1000;
+  snprintf(text, sizeof(text), "+%02u:%02u:%02u.%03u", (unsigned)(ms / 3600000), (unsigned)(ms / 60000 % 60), (unsigned)(ms / 1000 % 60), (unsigned)(ms % 1000));
+  return text;
+}
+
+static void Timeline(const char* format, ...) __attribute__((format(printf, 1, 2)));
+static void Timeline(const char* format, ...) {
+  if(quiet) return;
+  printf("%s  ", Elapsed(HostMicros()).c_str());
+  va_list args;
+  va_start(args, format);
+  vprintf(format, args);
+  va_end(args);
+  printf("\n");
+}
+
+// SQW 1 Hz OUTPUT OF DS3231
+
+static void SqwTick(void* arg) {
+  HostDs3231Tick();
+  HostSetPin(SQW_INT_PIN, LOW);
+  HostSetPin(SQW_INT_PIN, HIGH);
+}
+
+// ACTIVITY TRACE AND HOURLY REPORT
+
+struct HourRow {
+  uint64_t end_us;
+  int32_t core0_per_mille, core1_per_mille;
+  double spi_busy_percent;
+};
+static std::vector<HourRow> hour_rows;
+static uint32_t trace_next_index = 0;
+static uint64_t spi_busy_us_at_hour = 0, hour_start_us = 0;
+
+static void DrainTrace() {
+  ActivityTrace::TraceEntry entry;
+  uint32_t expected_index = trace_next_index;
+  while(activity_trace.Read(trace_next_index, entry)) {
+    if(trace_next_index - 1 != expected_index)
+      Timeline("trace: %u events lost", trace_next_index - 1 - expected_index);
+    expected_index = trace_next_index;
+    if(entry.event == ActivityTrace::kTraceCore0BusyHour) {
+      uint64_t spi_busy_us = display->tft.spi_busy_us_;
+      uint64_t window_us = max(HostMicros() - hour_start_us, (uint64_t)1);
+      hour_rows.push_back({ HostMicros(), entry.arg, 0, 100.0 * (spi_busy_us - spi_busy_us_at_hour) / window_us });
+      spi_busy_us_at_hour = spi_busy_us;
+      hour_start_us = HostMicros();
+    }
+    else if(entry.event == ActivityTrace::kTraceCore1BusyHour && !hour_rows.empty())
+      hour_rows.back().core1_per_mille = entry.arg;
+    Timeline("%-20s %ld", ActivityTrace::EventName(entry.event), (long)entry.arg);
+  }
+}
+
+static void Finish() {
+  DrainTrace();
+  double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+  printf("\nCPU busy per simulated hour, closed by the clock at every full hour:\n");
+  printf("  hour ends at     loop()  loop1()  display SPI\n");
+  for (const HourRow &row : hour_rows)
+    printf("  %s  %5.1f%%  %6.1f%%  %10.1f%%\n", Elapsed(row.end_us).c_str(), row.core0_per_mille / 10.0, row.core1_per_mille / 10.0, row.spi_busy_percent);
+  bool weather_requests_ok = (max_weather_requests < 0 || wifi_stuff->weather_http_requests_ <= max_weather_requests);
+  printf("WiFi: weather HTTP requests %u%s\n", wifi_stuff->weather_http_requests_, (weather_requests_ok ? "" : ", more than --max-weather-requests"));
+  printf("Watchdog: timeout %u ms, longest gap %u ms, overruns %u\n", HostWatchdogTimeoutMs(), HostWatchdogLongestGapMs(), HostWatchdogOverruns());
+  printf("Simulated %.2f h in %.2f s\n", HostMicros() / 3.6e9, wall_s);
+  fflush(stdout);
+  exit(HostWatchdogOverruns() == 0 && weather_requests_ok ? 0 : 1);
+}
+
+// SCRIPT
+
+static void RunDueScript() {
+  while(!script.empty() && script.begin()->first <= HostMicros()) {
+    std::function<void()> action = script.begin()->second;
+    script.erase(script.begin());
+    last_input_us = HostMicros();
+    action();
+  }
+}
+
+static void HttpRequest(const std::string &method, const std::string &path, const std::string &body) {
+  std::string headers;
+  #if defined(MY_REST_API_TOKEN)
+    headers = std::string("Authorization: Bearer ") + MY_REST_API_TOKEN + "\r\n";
+  #endif
+  SimHttpResponse response = SimHttpRequest(method, path, body, headers);
+  if(response.code == 0) {
+    Timeline("http %s %s: no response%s", method.c_str(), path.c_str(), (HostWebServerPort() == 0 ? ", no web server running" : ""));
+    return;
+  }
+  if(response.body.size() > 300)
+    response.body = response.body.substr(0, 300) + "...";
+  Timeline("http %s %s -> %d %s", method.c_str(), path.c_str(), response.code, response.body.c_str());
+}
+
+static bool ParseElapsed(const std::string &text, uint64_t &us) {
+  unsigned hours, minutes;
+  double seconds;
+  if(sscanf(text.c_str(), "%u:%u:%lf", &hours, &minutes, &seconds) != 3)
+    return false;
+  us = ((uint64_t)hours * 3600 + minutes * 60) * 1000000 + (uint64_t)(seconds * 1e6 + 0.5);
+  return true;
+}
+
+static void Press(const std::string &button, uint64_t at_us, uint32_t hold_ms) {
+  std::vector<int> pins;
+  if(button == "push") pins = { BUTTON_PIN };
+  else if(button == "inc") pins = { INC_BUTTON_PIN };
+  else if(button == "dec") pins = { DEC_BUTTON_PIN };
+  else if(button == "both") pins = { INC_BUTTON_PIN, DEC_BUTTON_PIN };
+  script.insert({ at_us, [=]() {
+    Timeline("sim: press %s %u ms", button.c_str(), hold_ms);
+    for (int pin : pins) HostSetPin(pin, LOW);
+  } });
+  script.insert({ at_us + hold_ms * 1000ULL, [=]() {
+    for (int pin : pins) HostSetPin(pin, HIGH);
+  } });
+}
+
+static void Touch(int16_t x, int16_t y, uint64_t at_us, uint32_t hold_ms) {
+  // inverse of calibration in touchscreen.cpp
+  int16_t raw_x = 220 + (int32_t)x * (3800 - 220) / kTftWidth;
+  int16_t raw_y = 280 + (int32_t)y * (3830 - 280) / kTftHeight;
+  script.insert({ at_us, [=]() {
+    Timeline("sim: touch %d,%d %u ms", x, y, hold_ms);
+    HostTouch(raw_x, raw_y, 1000);
+  } });
+  script.insert({ at_us + hold_ms * 1000ULL, []() { HostTouch(0, 0, 0); } });
+}
+
+static bool LoadScript(const char* file_name) {
+  std::ifstream file(file_name);
+  if(!file) {
+    fprintf(stderr, "cannot open script %s\n", file_name);
+    return false;
+  }
+  std::string line;
+  int line_number = 0;
+  while(std::getline(file, line)) {
+    line_number++;
+    line = line.substr(0, line.find('#'));
+    std::istringstream words(line);
+    std::string time_text, command;
+    if(!(words >> time_text))
+      continue;
+    uint64_t at_us;
+    if(!ParseElapsed(time_text, at_us) || !(words >> command)) {
+      fprintf(stderr, "%s:%d: expected <HH:MM:SS> <command>\n", file_name, line_number);
+      return false;
+    }
+    std::string rest;
+    std::getline(words >> std::ws, rest);
+    std::istringstream args(rest);
+    if(command == "press") {
+      std::string button;
+      uint32_t hold_ms = 100;
+      args >> button >> hold_ms;
+      if(button != "push" && button != "inc" && button != "dec" && button != "both") {
+        fprintf(stderr, "%s:%d: press push|inc|dec|both\n", file_name, line_number);
+        return false;
+      }
+      Press(button, at_us, hold_ms);
+    }
+    else if(command == "touch") {
+      int x = -1, y = -1;
+      uint32_t hold_ms = 100;
+      args >> x >> y >> hold_ms;
+      if(x < 0 || x >= kTftWidth || y < 0 || y >= kTftHeight) {
+        fprintf(stderr, "%s:%d: touch x y, on screen\n", file_name, line_number);
+        return false;
+      }
+      Touch(x, y, at_us, hold_ms);
+    }
+    else if(command == "serial") {
+      script.insert({ at_us, [=]() {
+        Timeline("sim: serial %s", rest.c_str());
+        HostSerialInput((rest + "\n").c_str());
+      } });
+    }
+    else if(command == "network") {
+      bool up = (rest == "up");
+      script.insert({ at_us, [=]() {
+        Timeline("sim: network %s", (up ? "up" : "down"));
+        sim_network.up = up;
+      } });
+    }
+    else if(command == "http") {
+      std::string method, path, body;
+      args >> method >> path;
+      std::getline(args >> std::ws, body);
+      script.insert({ at_us, [=]() { HttpRequest(method, path, body); } });
+    }
+    else if(command == "screenshot") {
+      script.insert({ at_us, [=]() {
+        bool written = display->tft.WriteScreenshot(rest.c_str());
+        Timeline("sim: screenshot %s%s", rest.c_str(), (written ? "" : " failed"));
+      } });
+    }
+    else {
+      fprintf(stderr, "%s:%d: unknown command %s\n", file_name, line_number, command.c_str());
+      return false;
+    }
+  }
+  return true;
+}
+
+// STEPPING
+
+// other core, also runs while loop() waits in delay() or for a second core task
+static void WaitRunner() {
+  if(HostMicros() >= end_us)
+    Finish();
+  RunDueScript();
+  loop1();
+  HostGfxSpendCpu(kLoopOverheadUs);
+  HostPollWebServers();
+  DrainTrace();
+}
+
+// nothing to poll for until next timer or script event
+static bool Idle() {
+  return current_page != kScreensaverPage && !alarm_clock->AlarmActive() && !button_events->AnyPressed()
+    && HostMicros() - last_input_us >= kInputSettleUs && host_touch_point.z == 0 && Serial.available() == 0
+    && second_core_tasks.PendingCount() == 0 && !wifi_stuff->WiFiConnectInProgress();
+}
+
+static void Run() {
+  while(true) {
+    uint64_t step_start_us = HostMicros();
+    loop();
+    HostGfxSpendCpu(kLoopOverheadUs);
+    HostRunWaitRunner();
+    if(Idle()) {
+      uint64_t next_us = min(HostNextTimerMicros(), end_us);
+      if(!script.empty())
+        next_us = min(next_us, script.begin()->first);
+      if(next_us > HostMicros())
+        HostAdvanceMicros(next_us - HostMicros());
+    }
+    else if(HostMicros() - step_start_us < kPollUs)
+      HostAdvanceMicros(kPollUs - (HostMicros() - step_start_us));
+  }
+}
+
+int main(int argc, char* argv[]) {
+  const char* start_text = "2024-06-03 06:00:00";
+  double hours = 24, rtc_ppm = 0;
+  const char* script_file = NULL;
+  bool lost_power = false, serial_echo = false;
+  for (int i = 1; i < argc; i++) {
+    std::string option = argv[i];
+    bool has_value = (i + 1 < argc);
+    if(option == "--start" && has_value) start_text = argv[++i];
+    else if(option == "--hours" && has_value) hours = atof(argv[++i]);
+    else if(option == "--script" && has_value) script_file = argv[++i];
+    else if(option == "--rtc-ppm" && has_value) rtc_ppm = atof(argv[++i]);
+    else if(option == "--lost-power") lost_power = true;
+    else if(option == "--no-weather-cache") sim_network.weather_cache = false;
+    else if(option == "--max-weather-requests" && has_value) max_weather_requests = atoi(argv[++i]);
+    else if(option == "--serial") serial_echo = true;
+    else if(option == "--quiet") quiet = true;
+    else {
+      fprintf(stderr, "usage: %s [--start \"YYYY-MM-DD HH:MM:SS\"] [--hours H] [--script FILE] [--rtc-ppm PPM] [--lost-power] [--no-weather-cache] [--max-weather-requests N] [--serial] [--quiet]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  struct tm start = {};
+  if(sscanf(start_text, "%d-%d-%d %d:%d:%d", &start.tm_year, &start.tm_mon, &start.tm_mday, &start.tm_hour, &start.tm_min, &start.tm_sec) != 6 || start.tm_year < 2024) {
+    fprintf(stderr, "--start takes local time \"YYYY-MM-DD HH:MM:SS\", 2024 or later\n");
+    return 2;
+  }
+  start.tm_year -= 1900;
+  start.tm_mon -= 1;
+  time_t local_start = timegm(&start);
+  gmtime_r(&local_start, &start);     // fills day of week
+  sim_network.utc_at_start = local_start - sim_network.gmt_offset_sec;
+  end_us = (uint64_t)(hours * 3.6e9);
+  if(script_file != NULL && !LoadScript(script_file))
+    return 2;
+
+  // DS3231 keeps time on its battery, or lost it
+  HostDs3231Set(start.tm_sec, start.tm_min, start.tm_hour, start.tm_wday + 1, start.tm_mday, start.tm_mon + 1, start.tm_year - 100);
+  HostDs3231SetLostPower(lost_power);
+  esp_timer_handle_t sqw_timer;
+  esp_timer_create_args_t sqw_timer_args = { SqwTick, NULL };
+  esp_timer_create(&sqw_timer_args, &sqw_timer);
+  esp_timer_start_periodic(sqw_timer, (uint64_t)(1e6 * (1 + rtc_ppm * 1e-6) + 0.5));
+  // buttons released, pulled up
+  HostSetPin(BUTTON_PIN, HIGH);
+  HostSetPin(INC_BUTTON_PIN, HIGH);
+  HostSetPin(DEC_BUTTON_PIN, HIGH);
+  HostSetSerialEcho(serial_echo);
+
+  wall_start = std::chrono::steady_clock::now();
+  Timeline("sim: boot, RTC %s", start_text);
+  setup();
+  HostSetWaitRunner(WaitRunner);
+  Run();
+}
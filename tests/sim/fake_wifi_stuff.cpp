@@ -0,0 +1,431 @@
+// WiFiStuff for the simulation, in place of wifi_stuff.cpp. The connect state machine, radio
+// accounting, weather cache and NTP update keep the behaviour and timing the rest of the clock
+// sees, against the network of sim_network: connects, fetches and NTP take its virtual times,
+// weather is fixed, NTP answers SimUtcEpochSeconds() and the server never has a newer firmware.
+// Soft AP and location servers run the real routes of web_server.cpp on a loopback port.
+
+#include "wifi_stuff.h"
+#include "nvs_preferences.h"
+#include "rtc.h"
+#include "sim.h"
+#include <ESPAsyncWebServer.h>
+#include "web_server.h"
+#include "framebuffer_mirror.h"
+#include <time.h>
+
+WiFiStuff::WiFiStuff() {
+  nvs_preferences->RetrieveWiFiDetails(wifi_ssid_, wifi_password_);
+  nvs_preferences->RetrieveWeatherLocationDetails(location_zip_code_, location_country_code_, weather_units_metric_not_imperial_);
+  WeatherCacheRecord weather_cache;
+  if(nvs_preferences->RetrieveWeatherCache(&weather_cache) && weather_cache.fetch_minutes != 0 && weather_cache.zip_code == location_zip_code_
+      && location_country_code_ == weather_cache.country_code && weather_cache.units_metric == weather_units_metric_not_imperial_) {
+    ApplyWeatherCache(weather_cache);
+    got_weather_info_ = WeatherCacheFresh();
+  }
+  if(!nvs_preferences->RetrieveWiFiConnectCache(&wifi_connect_cache_))
+    wifi_connect_cache_ = {};
+  TurnWiFiOff();
+  PrintLn("WiFiStuff Initialized!");
+}
+
+void WiFiStuff::SaveWiFiDetails() {
+  nvs_preferences->SaveWiFiDetails(wifi_ssid_, wifi_password_);
+  incorrect_wifi_details_ = false;
+  wifi_connect_cache_.ssid_hash = 0;
+}
+
+std::string WiFiStuff::WiFiDetailsShortString() {
+  return wifi_ssid_.substr(0, 6) + "*, " + wifi_password_.substr(0, 1) + "*";
+}
+
+void WiFiStuff::SaveWeatherLocationDetails() {
+  nvs_preferences->SaveWeatherLocationDetails(location_zip_code_, location_country_code_, weather_units_metric_not_imperial_);
+  incorrect_zip_code = false;
+}
+
+void WiFiStuff::SaveWeatherUnits() {
+  nvs_preferences->SaveWeatherUnits(weather_units_metric_not_imperial_);
+}
+
+bool WiFiStuff::TurnWiFiOn() {
+  WiFiConnectState state = WiFiConnectStep();
+  while(state != kWiFiConnected && state != kWiFiFailedCredentials && state != kWiFiFailedNoAp) {
+    delay(kWiFiConnectPollMs);
+    ResetWatchdog();
+    state = WiFiConnectStep();
+  }
+  return wifi_connected_;
+}
+
+// same states, timeouts and backoff as wifi_stuff.cpp, an attempt succeeds after the
+// connect time of sim_network if its access point is up
+WiFiStuff::WiFiConnectState WiFiStuff::WiFiConnectStep() {
+  unsigned long now_ms = millis();
+  switch(wifi_connect_state_) {
+    case kWiFiIdle:
+      if(no_ap_failure_ms_ != 0 && now_ms - no_ap_failure_ms_ < wifi_no_ap_retry_holdoff_ms_)
+        return kWiFiFailedNoAp;
+      no_ap_failure_ms_ = 0;
+      if(!radio_on_) {
+        radio_on_ = true;
+        radio_on_start_ms_ = now_ms;
+      }
+      connect_start_ms_ = now_ms;
+      connect_attempt_ = 0;
+      auth_failures_ = 0;
+      StartWiFiConnectAttempt(wifi_connect_cache_.ssid_hash != 0 && wifi_connect_cache_.ssid_hash == WiFiDetailsHash());
+      break;
+
+    case kWiFiFastConnecting:
+    case kWiFiConnecting: {
+      bool fast_connect = (wifi_connect_state_ == kWiFiFastConnecting);
+      unsigned long attempt_ms = now_ms - attempt_start_ms_;
+      if(sim_network.up && !sim_network.reject_credentials && attempt_ms >= (fast_connect ? sim_network.fast_connect_ms : sim_network.full_connect_ms)) {
+        wifi_connected_ = true;
+        incorrect_wifi_details_ = false;
+        digitalWrite(WIFI_LED, HIGH);
+        RecordWiFiConnectTime(fast_connect, now_ms - connect_start_ms_);
+        SaveWiFiConnectCache();
+        SetWiFiConnectState(kWiFiConnected);
+      }
+      else if(sim_network.up && sim_network.reject_credentials && attempt_ms >= sim_network.full_connect_ms)
+        WiFiConnectAttemptFailed(/*auth_failure = */ true);
+      else if(attempt_ms >= (fast_connect ? wifi_fast_connect_timeout_ms_ : wifi_connect_timeout_ms_))
+        WiFiConnectAttemptFailed(/*auth_failure = */ false);
+      break;
+    }
+
+    case kWiFiBackoff:
+      if(now_ms - attempt_start_ms_ >= backoff_ms_)
+        StartWiFiConnectAttempt(/*fast_connect = */ false);
+      break;
+
+    case kWiFiConnected:
+      if(!sim_network.up) {
+        PrintLn("WiFiStuff::WiFiConnectStep(): WiFi connection lost");
+        wifi_connected_ = false;
+        digitalWrite(WIFI_LED, LOW);
+        SetWiFiConnectState(kWiFiIdle);
+      }
+      break;
+
+    default:
+      break;
+  }
+  return wifi_connect_state_;
+}
+
+void WiFiStuff::StartWiFiConnectAttempt(bool fast_connect) {
+  attempt_start_ms_ = millis();
+  if(!fast_connect)
+    connect_attempt_++;
+  SetWiFiConnectState(fast_connect ? kWiFiFastConnecting : kWiFiConnecting);
+}
+
+void WiFiStuff::WiFiConnectAttemptFailed(bool auth_failure) {
+  Serial.printf("WiFiStuff::WiFiConnectAttemptFailed(): attempt %u\n", connect_attempt_);
+  if(wifi_connect_state_ == kWiFiFastConnecting) {
+    StartWiFiConnectAttempt(/*fast_connect = */ false);
+    return;
+  }
+  if(auth_failure)
+    auth_failures_++;
+  if(auth_failures_ >= 2) {
+    incorrect_wifi_details_ = true;
+    SetWiFiConnectState(kWiFiFailedCredentials);
+  }
+  else if(connect_attempt_ >= wifi_connect_attempts_) {
+    no_ap_failure_ms_ = max(millis(), 1UL);
+    SetWiFiConnectState(kWiFiFailedNoAp);
+  }
+  else {
+    backoff_ms_ = wifi_backoff_base_ms_ << (connect_attempt_ - 1);
+    attempt_start_ms_ = millis();
+    SetWiFiConnectState(kWiFiBackoff);
+  }
+}
+
+void WiFiStuff::SetWiFiConnectState(WiFiConnectState state) {
+  wifi_connect_state_ = state;
+  if(wifi_connect_progress_callback_ != NULL)
+    wifi_connect_progress_callback_(state, connect_attempt_);
+}
+
+uint32_t WiFiStuff::WiFiDetailsHash() {
+  uint32_t hash = 2166136261UL;
+  for (char c : wifi_ssid_ + '\n' + wifi_password_) {
+    hash ^= (uint8_t)c;
+    hash *= 16777619UL;
+  }
+  return (hash == 0 ? 1 : hash);
+}
+
+void WiFiStuff::SaveWiFiConnectCache() {
+  if(wifi_connect_cache_.ssid_hash == WiFiDetailsHash()) return;
+  wifi_connect_cache_ = {};
+  wifi_connect_cache_.ssid_hash = WiFiDetailsHash();
+  wifi_connect_cache_.lease_minutes = rtc->Now().minutes_since_2024();
+  nvs_preferences->SaveWiFiConnectCache(&wifi_connect_cache_);
+}
+
+void WiFiStuff::RecordWiFiConnectTime(bool fast_connect, unsigned long connect_ms) {
+  WiFiConnectTimes &connect_times = wifi_connect_times_[fast_connect];
+  connect_times.samples_ms[connect_times.count % kWiFiConnectTimeSamples] = min(connect_ms, (unsigned long)UINT16_MAX);
+  connect_times.count++;
+  Serial.printf("WiFiStuff::TurnWiFiOn(): %s connect %lu ms\n", (fast_connect ? "fast" : "full"), connect_ms);
+}
+
+bool WiFiStuff::WiFiConnectTimePercentiles(bool fast_connect, uint16_t &connects, uint16_t &p50_ms, uint16_t &p90_ms, uint16_t &max_ms) {
+  const WiFiConnectTimes &connect_times = wifi_connect_times_[fast_connect];
+  connects = connect_times.count;
+  uint8_t samples_count = min(connect_times.count, (uint16_t)kWiFiConnectTimeSamples);
+  if(samples_count == 0)
+    return false;
+  uint16_t sorted_ms[kWiFiConnectTimeSamples];
+  memcpy(sorted_ms, connect_times.samples_ms, samples_count * sizeof(uint16_t));
+  std::sort(sorted_ms, sorted_ms + samples_count);
+  p50_ms = sorted_ms[samples_count / 2];
+  p90_ms = sorted_ms[samples_count * 9 / 10];
+  max_ms = sorted_ms[samples_count - 1];
+  return true;
+}
+
+void WiFiStuff::PrintWiFiConnectTimes() {
+  for (uint8_t fast_connect = 0; fast_connect < 2; fast_connect++) {
+    uint16_t connects, p50_ms, p90_ms, max_ms;
+    if(WiFiConnectTimePercentiles(fast_connect, connects, p50_ms, p90_ms, max_ms))
+      Serial.printf("%s connect: %u connects, p50 %u ms, p90 %u ms, max %u ms\n", (fast_connect ? "fast" : "full"), connects, p50_ms, p90_ms, max_ms);
+  }
+}
+
+void WiFiStuff::TurnWiFiOff() {
+  PrintLn("WiFiStuff::TurnWiFiOff(): WiFi Off.");
+  digitalWrite(WIFI_LED, LOW);
+  wifi_connected_ = false;
+  SetWiFiConnectState(kWiFiIdle);
+  if(radio_on_) {
+    radio_on_ = false;
+    radio_on_ms_ += millis() - radio_on_start_ms_;
+  }
+}
+
+uint32_t WiFiStuff::TakeRadioOnSeconds() {
+  if(radio_on_) {
+    unsigned long now_ms = millis();
+    radio_on_ms_ += now_ms - radio_on_start_ms_;
+    radio_on_start_ms_ = now_ms;
+  }
+  uint32_t radio_on_seconds = radio_on_ms_ / 1000;
+  radio_on_ms_ = 0;
+  return radio_on_seconds;
+}
+
+void WiFiStuff::ApplyWeatherCache(const WeatherCacheRecord &weather_cache) {
+  weather_cache_ = weather_cache;
+  char unit = (weather_cache_.units_metric ? 'C' : 'F');
+  char valArr[16];
+  weather_main_.assign(weather_cache_.weather_main);
+  weather_description_.assign(weather_cache_.weather_description);
+  snprintf(valArr, sizeof(valArr), "%.1f%c", weather_cache_.temp_x10 / 10.0, unit);
+  weather_temp_.assign(valArr);
+  snprintf(valArr, sizeof(valArr), "%.1f%c", weather_cache_.feels_like_x10 / 10.0, unit);
+  weather_temp_feels_like_.assign(valArr);
+  snprintf(valArr, sizeof(valArr), "%.1f%c", weather_cache_.temp_max_x10 / 10.0, unit);
+  weather_temp_max_.assign(valArr);
+  snprintf(valArr, sizeof(valArr), "%.1f%c", weather_cache_.temp_min_x10 / 10.0, unit);
+  weather_temp_min_.assign(valArr);
+  snprintf(valArr, sizeof(valArr), "%d%s", weather_cache_.wind_speed_x10 / 10, (weather_cache_.units_metric ? "m/s" : "mi/hr"));
+  weather_wind_speed_.assign(valArr);
+  snprintf(valArr, sizeof(valArr), "%d%%", weather_cache_.humidity);
+  weather_humidity_.assign(valArr);
+  city_.assign(weather_cache_.city);
+  gmt_offset_sec_ = weather_cache_.gmt_offset_sec;
+  got_weather_info_ = true;
+}
+
+uint32_t WiFiStuff::WeatherCacheAgeMinutes() {
+  if(weather_cache_.fetch_minutes == 0) return UINT32_MAX;
+  uint32_t now_minutes = rtc->Now().minutes_since_2024();
+  if(now_minutes == 0 || now_minutes < weather_cache_.fetch_minutes) return UINT32_MAX;
+  return now_minutes - weather_cache_.fetch_minutes;
+}
+
+bool WiFiStuff::WeatherCacheFresh() {
+  if(!sim_network.weather_cache) return false;
+  return got_weather_info_ && WeatherCacheAgeMinutes() < kWeatherCacheTtlMinutes;
+}
+
+bool WiFiStuff::GmtOffsetFresh() {
+  if(!sim_network.weather_cache || weather_cache_.fetch_minutes == 0) return false;
+  RTC::TimeSnapshot now = rtc->Now();
+  uint32_t now_minutes = now.minutes_since_2024();
+  if(now_minutes == 0) return true;
+  if(now_minutes < weather_cache_.fetch_minutes || now_minutes - weather_cache_.fetch_minutes >= kGmtOffsetCacheTtlMinutes)
+    return false;
+  uint32_t last_2am_minutes = now_minutes - (now.todays_minutes + kMinutesInDay - 2 * 60) % kMinutesInDay;
+  return (weather_cache_.fetch_minutes > last_2am_minutes);
+}
+
+void WiFiStuff::InvalidateWeatherCache() {
+  weather_cache_.fetch_minutes = 0;
+  got_weather_info_ = false;
+}
+
+void WiFiStuff::GetTodaysWeatherInfo() {
+  got_weather_info_ = false;
+  if(last_fetch_weather_info_time_ms_ != 0 && millis() - last_fetch_weather_info_time_ms_ < kFetchWeatherInfoMinIntervalMs) {
+    get_weather_info_wait_seconds_ = (kFetchWeatherInfoMinIntervalMs - (millis() - last_fetch_weather_info_time_ms_)) / 1000;
+    return;
+  }
+  get_weather_info_wait_seconds_ = 0;
+  if(!wifi_connected_ && !TurnWiFiOn())
+    return;
+
+  delay(sim_network.weather_fetch_ms);
+  last_fetch_weather_info_time_ms_ = millis();
+  weather_http_requests_++;
+  if(!wifi_connected_) return;
+
+  WeatherCacheRecord weather_cache = {};
+  weather_cache.fetch_minutes = rtc->Now().minutes_since_2024();
+  weather_cache.zip_code = location_zip_code_;
+  strncpy(weather_cache.country_code, location_country_code_.c_str(), sizeof(weather_cache.country_code) - 1);
+  weather_cache.units_metric = weather_units_metric_not_imperial_;
+  weather_cache.humidity = 64;
+  weather_cache.temp_x10 = (weather_units_metric_not_imperial_ ? 183 : 649);
+  weather_cache.feels_like_x10 = weather_cache.temp_x10 - 8;
+  weather_cache.temp_min_x10 = weather_cache.temp_x10 - 31;
+  weather_cache.temp_max_x10 = weather_cache.temp_x10 + 42;
+  weather_cache.wind_speed_x10 = 31;
+  weather_cache.gmt_offset_sec = sim_network.gmt_offset_sec;
+  strncpy(weather_cache.weather_main, "Clouds", sizeof(weather_cache.weather_main) - 1);
+  strncpy(weather_cache.weather_description, "scattered clouds", sizeof(weather_cache.weather_description) - 1);
+  strncpy(weather_cache.city, "Sim City", sizeof(weather_cache.city) - 1);
+  ApplyWeatherCache(weather_cache);
+  weather_cache_unstamped_ = (weather_cache.fetch_minutes == 0);
+  if(!weather_cache_unstamped_)
+    nvs_preferences->SaveWeatherCache(&weather_cache_);
+}
+
+bool WiFiStuff::GetTimeFromNtpServer() {
+  manual_time_update_successful_ = false;
+  if(!GmtOffsetFresh()) {
+    GetTodaysWeatherInfo();
+    if(!got_weather_info_)
+      return false;
+  }
+  if(!wifi_connected_ && !TurnWiFiOn())
+    return false;
+
+  delay(sim_network.ntp_ms);
+  if(!wifi_connected_)
+    return false;
+
+  time_t local_epoch = (time_t)SimUtcEpochSeconds() + gmt_offset_sec_;
+  struct tm local_time;
+  gmtime_r(&local_epoch, &local_time);
+
+  RTC::TimeSnapshot rtc_before = rtc->Now();
+  if(rtc_before.minutes_since_2024() != 0) {
+    const uint32_t kEpochJan2024 = 1704067200;
+    last_ntp_offset_sec_ = (int32_t)(local_epoch - kEpochJan2024) - (int32_t)(rtc_before.minutes_since_2024() * 60 + rtc_before.second);
+    if(ntp_offset_valid_ && local_epoch - last_ntp_epoch_ >= kRtcDriftMinSeconds && abs(last_ntp_offset_sec_) <= kRtcDriftMaxOffsetSec)
+      rtc_drift_ppm_ = last_ntp_offset_sec_ * 1e6f / (local_epoch - last_ntp_epoch_);
+    ntp_offset_valid_ = true;
+    Serial.printf("NTP - RTC offset %ld s, RTC drift %.1f ppm\n", (long)last_ntp_offset_sec_, rtc_drift_ppm_);
+  }
+  last_ntp_epoch_ = local_epoch;
+
+  rtc->SetRtcTimeAndDate(local_time.tm_sec, local_time.tm_min, local_time.tm_hour, local_time.tm_wday + 1, local_time.tm_mday, local_time.tm_mon + 1, local_time.tm_year + 1900);
+  last_ntp_server_time_update_time_ms = millis();
+  RTC::TimeSnapshot now = rtc->Now();
+  if(weather_cache_unstamped_ && got_weather_info_) {
+    weather_cache_.fetch_minutes = now.minutes_since_2024();
+    weather_cache_unstamped_ = false;
+    nvs_preferences->SaveWeatherCache(&weather_cache_);
+  }
+  if(now.hour_mode_and_am_pm == 1 && now.hour == 2 && now.minute >= 1)
+    auto_updated_time_today_ = true;
+  manual_time_update_successful_ = true;
+  return true;
+}
+
+bool WiFiStuff::ResolveOverUdp(const char* host, uint32_t &ip, uint32_t &ttl_seconds) {
+  return false;
+}
+
+void WiFiStuff::StartSetWiFiSoftAP() {
+  PrintLn("WiFiStuff::StartSetWiFiSoftAP()");
+  TurnWiFiOff();
+  delay(100);
+  if(server != NULL) {
+    framebuffer_mirror.Unregister();
+    delete server;
+  }
+  server = new AsyncWebServer(80);
+  soft_AP_IP = "127.0.0.1";
+  server->begin();
+  digitalWrite(WIFI_LED, HIGH);
+  _SoftAPWiFiDetails();
+  Serial.printf("Soft AP server on 127.0.0.1:%u\n", server->HostPort());
+}
+
+void WiFiStuff::StopSetWiFiSoftAP() {
+  PrintLn("WiFiStuff::StopSetWiFiSoftAP()");
+  TurnWiFiOff();
+  delay(100);
+  if(server != NULL) {
+    framebuffer_mirror.Unregister();
+    server->end();
+    delete server;
+    server = NULL;
+  }
+  wifi_ssid_ = temp_ssid_str.c_str();
+  wifi_password_ = temp_passwd_str.c_str();
+}
+
+void WiFiStuff::StartSetLocationLocalServer() {
+  PrintLn("WiFiStuff::StartSetLocationLocalServer()");
+  TurnWiFiOff();
+  delay(100);
+  if(server != NULL) {
+    framebuffer_mirror.Unregister();
+    delete server;
+    server = NULL;
+  }
+  soft_AP_IP = "";
+  if(!TurnWiFiOn())
+    return;
+  delay(100);
+  server = new AsyncWebServer(80);
+  soft_AP_IP = "127.0.0.1";
+  _LocalServerLocationInputs();
+  Serial.printf("Location server on 127.0.0.1:%u\n", server->HostPort());
+}
+
+void WiFiStuff::StopSetLocationLocalServer() {
+  PrintLn("WiFiStuff::StopSetLocationLocalServer()");
+  TurnWiFiOff();
+  delay(100);
+  if(server != NULL) {
+    framebuffer_mirror.Unregister();
+    server->end();
+    delete server;
+    server = NULL;
+  }
+  location_zip_code_ = std::atoi(temp_zip_pin_str.c_str());
+  location_country_code_ = temp_country_code_str.c_str();
+}
+
+bool WiFiStuff::FirmwareVersionCheck() {
+  if(!wifi_connected_ && !TurnWiFiOn())
+    return false;
+  delay(sim_network.version_check_ms);
+  firmware_update_available_ = false;
+  return wifi_connected_;
+}
+
+void WiFiStuff::UpdateFirmware() {
+  PrintLn("WiFiStuff::UpdateFirmware(): no firmware image in simulation");
+  firmware_update_available_ = false;
+}
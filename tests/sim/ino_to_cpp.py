@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""Turn the sketch into a C++ file the host compiler builds, as the Arduino builder does.
+
+  ino_to_cpp.py <sketch.ino> <out.cpp>
+
+Prototypes of all top level functions are put before the first function definition, with
+default arguments left out, and #line directives keep compiler messages on .ino lines.
+"""
+
+import re
+import sys
+
+FUNCTION = re.compile(r"^([A-Za-z_][\w:<>,\s\*&]*?[\s\*&])([A-Za-z_]\w*)\s*\(([^;{}]*)\)\s*\{")
+KEYWORDS = {"if", "for", "while", "switch", "return", "else"}
+
+
+def code_lines(lines):
+    """Lines with comments and string contents blanked, block comments may span lines."""
+    in_block = False
+    for line in lines:
+        out = []
+        i = 0
+        while i < len(line):
+            if in_block:
+                end = line.find("*/", i)
+                if end < 0:
+                    break
+                in_block = False
+                i = end + 2
+            elif line.startswith("/*", i):
+                in_block = True
+                i += 2
+            elif line.startswith("//", i):
+                break
+            elif line[i] in "\"'":
+                quote = line[i]
+                i += 1
+                while i < len(line) and line[i] != quote:
+                    i += 2 if line[i] == "\\" else 1
+                out.append(quote + quote)
+                i += 1
+            else:
+                out.append(line[i])
+                i += 1
+        yield "".join(out)
+
+
+def strip_defaults(args):
+    parts = []
+    for arg in args.split(","):
+        parts.append(arg.split("=")[0].strip())
+    return ", ".join(part for part in parts if part)
+
+
+def main():
+    ino_path, out_path = sys.argv[1], sys.argv[2]
+    with open(ino_path) as ino:
+        lines = ino.read().split("\n")
+
+    prototypes = []
+    first_function = None
+    depth = 0
+    for number, line in enumerate(code_lines(lines)):
+        match = FUNCTION.match(line) if depth == 0 else None
+        if match and match.group(2) not in KEYWORDS:
+            if first_function is None:
+                first_function = number
+            prototypes.append("%s%s(%s);" % (match.group(1), match.group(2), strip_defaults(match.group(3))))
+        depth += line.count("{") - line.count("}")
+
+    path = ino_path.replace("\\", "/")
+    with open(out_path, "w") as out:
+        out.write("#include <Arduino.h>\n")
+        out.write('#line 1 "%s"\n' % path)
+        out.write("\n".join(lines[:first_function]) + "\n")
+        out.write("\n".join(prototypes) + "\n")
+        out.write('#line %d "%s"\n' % (first_function + 1, path))
+        out.write("\n".join(lines[first_function:]))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,51 @@
+#include "sim.h"
+#include "host.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+SimNetwork sim_network;
+
+uint32_t SimUtcEpochSeconds() {
+  return sim_network.utc_at_start + HostMicros() / 1000000;
+}
+
+SimHttpResponse SimHttpRequest(const std::string &method, const std::string &path, const std::string &body,
+    const std::string &extra_headers) {
+  SimHttpResponse response;
+  uint16_t port = HostWebServerPort();
+  if(port == 0) return response;
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  timeval timeout = { 1, 0 };
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(port);
+  if(connect(fd, (sockaddr*)&address, sizeof(address)) != 0) {
+    close(fd);
+    return response;
+  }
+  std::string request = method + " " + path + " HTTP/1.1\r\nHost: 127.0.0.1\r\n" + extra_headers;
+  if(!body.empty())
+    request += "Content-Type: application/json\r\nContent-Length: " + std::to_string(body.size()) + "\r\n";
+  request += "\r\n" + body;
+  send(fd, request.data(), request.size(), MSG_NOSIGNAL);
+  for (int polls = 0; polls < 1000 && !HostPollWebServers(); polls++)
+    usleep(1000);
+  std::string reply;
+  char buffer[4096];
+  ssize_t length;
+  while((length = recv(fd, buffer, sizeof(buffer), 0)) > 0)
+    reply.append(buffer, length);
+  close(fd);
+
+  size_t status_end = reply.find("\r\n"), headers_end = reply.find("\r\n\r\n");
+  if(reply.compare(0, 9, "HTTP/1.1 ") != 0 || headers_end == std::string::npos) return response;
+  response.code = atoi(reply.c_str() + 9);
+  response.headers = reply.substr(status_end + 2, headers_end + 2 - (status_end + 2));
+  response.body = reply.substr(headers_end + 4);
+  return response;
+}
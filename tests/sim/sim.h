@@ -0,0 +1,39 @@
+#ifndef SIM_H
+#define SIM_H
+
+// Simulated world around the clock: the network the fake WiFiStuff connects to and the true
+// time NTP answers with. The DS3231 keeps its own time and drifts from it, see clock_sim.cpp.
+// Shared by clock_sim and the host tests that link the whole sketch.
+
+#include <stdint.h>
+#include <string>
+
+struct SimNetwork {
+  bool up = true;                       // access point is there
+  bool reject_credentials = false;      // access point rejects WiFi details
+  uint32_t fast_connect_ms = 600;       // directed connect to cached access point
+  uint32_t full_connect_ms = 2500;      // scan, association and DHCP
+  uint32_t weather_fetch_ms = 700;
+  uint32_t ntp_ms = 150;
+  uint32_t version_check_ms = 900;
+  bool weather_cache = true;            // false: fake WiFiStuff never serves weather or gmt offset from its cache
+  int32_t gmt_offset_sec = -7 * 3600;
+  uint32_t utc_at_start = 1717419600;   // true time at virtual time 0, 3 Jun 2024 06:00 at gmt_offset_sec
+};
+
+extern SimNetwork sim_network;
+
+// true time in seconds since 1 Jan 1970 UTC, what NTP answers
+uint32_t SimUtcEpochSeconds();
+
+// request to the running web server over loopback, handlers run on the calling thread while
+// it waits, as AsyncTCP's task would; code 0 if no server is running or no response came
+struct SimHttpResponse {
+  int code = 0;
+  std::string headers;    // header lines after status line
+  std::string body;
+};
+SimHttpResponse SimHttpRequest(const std::string &method, const std::string &path, const std::string &body = "",
+    const std::string &extra_headers = "");
+
+#endif  // SIM_H
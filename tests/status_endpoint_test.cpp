@@ -0,0 +1,141 @@
+// /status of the real sketch served over a loopback socket: the whole sketch runs on the host
+// stand-ins with the fake WiFiStuff of sim/, the location server is started as from its page and
+// /status is fetched with a plain HTTP client. The response must be the document
+// WriteStatusJson() writes at that moment, valid JSON with the expected members, and the largest
+// document the clock can produce must fit the endpoint's buffer.
+
+#include "common.h"
+#include "host.h"
+#include "check.h"
+#include "sim.h"
+#include "wifi_stuff.h"
+#include "json_reader.h"
+#include "framebuffer_mirror.h"
+#include <uRTCLib.h>
+#include <map>
+
+void setup();
+size_t WriteStatusJson(char* buffer, size_t size);
+extern uint8_t screensaver_fps;
+
+const size_t kStatusBufferSize = 640;     // status_json_buffer of web_server.cpp
+
+// members of a JSON document as "object.member" -> value text, false if it is not valid JSON
+static bool Flatten(const std::string &json, std::map<std::string, std::string> &members) {
+  JsonReader reader(json.data(), json.size());
+  JsonReader::Token token;
+  std::vector<std::string> path;
+  std::string key;
+  while(true) {
+    JsonReader::TokenType type = reader.Next(token);
+    if(type == JsonReader::kError) return false;
+    if(type == JsonReader::kEnd) return true;
+    if(type == JsonReader::kKey)
+      key = std::string(token.start, token.length);
+    else if(type == JsonReader::kObjectStart) {
+      if(reader.depth() > 1) path.push_back(key);
+    }
+    else if(type == JsonReader::kObjectEnd) {
+      if(!path.empty()) path.pop_back();
+    }
+    else {
+      std::string name;
+      for (const std::string &object : path)
+        name += object + ".";
+      if(type == JsonReader::kTrue || type == JsonReader::kFalse)
+        members[name + key] = (type == JsonReader::kTrue ? "true" : "false");
+      else
+        members[name + key] = std::string(token.start, token.length);
+    }
+  }
+}
+
+static std::string StatusJson() {
+  char buffer[kStatusBufferSize];
+  size_t length = WriteStatusJson(buffer, sizeof(buffer));
+  return std::string(buffer, length);
+}
+
+static void TestNoServerBeforeStart() {
+  CHECK_EQ(HostWebServerPort(), 0);
+  CHECK_EQ(SimHttpRequest("GET", "/status").code, 0);
+}
+
+static void TestStatusOverLoopback() {
+  wifi_stuff->StartSetLocationLocalServer();
+  CHECK(HostWebServerPort() != 0);
+  SimHttpResponse response = SimHttpRequest("GET", "/status");
+  CHECK_EQ(response.code, 200);
+  CHECK(response.headers.find("Content-Type: application/json\r\n") != std::string::npos);
+  CHECK(response.headers.find("Content-Length: " + std::to_string(response.body.size()) + "\r\n") != std::string::npos);
+  // same serializer, same instant: no virtual time passes while the request is served
+  CHECK_STR(response.body, StatusJson());
+
+  std::map<std::string, std::string> members;
+  CHECK(Flatten(response.body, members));
+  CHECK_STR(members["uptime_s"], std::to_string(esp_timer_get_time() / 1000000));
+  CHECK_STR(members["firmware"], kFirmwareVersion);
+  CHECK_STR(members["heap.free"], std::to_string(esp_get_free_heap_size()));
+  CHECK_STR(members["wifi.connected"], "true");
+  CHECK_STR(members["wifi.full_connect.connects"], "1");
+  CHECK_STR(members["wifi.full_connect.p50_ms"], std::to_string(sim_network.full_connect_ms));
+  CHECK_STR(members["task_queue_pending"], "0");
+  CHECK(members.count("ntp.rtc_drift_ppm") == 1);
+}
+
+// NTP offset appears once an NTP update went through
+static void TestNtpMembers() {
+  wifi_stuff->ntp_offset_valid_ = false;
+  std::map<std::string, std::string> members;
+  CHECK(Flatten(SimHttpRequest("GET", "/status").body, members));
+  CHECK(members.count("ntp.last_offset_s") == 0);
+
+  CHECK(wifi_stuff->GetTimeFromNtpServer());
+  members.clear();
+  CHECK(Flatten(SimHttpRequest("GET", "/status").body, members));
+  CHECK_STR(members["ntp.last_offset_s"], std::to_string(wifi_stuff->last_ntp_offset_sec_));
+  CHECK_STR(members["ntp.last_update_s_ago"], "0");
+}
+
+// every counter at its widest, connect times at their timeouts: still fits, with room to spare
+static void TestLargestDocumentFits() {
+  screensaver_fps = 255;
+  wifi_stuff->last_ntp_offset_sec_ = INT32_MIN;
+  wifi_stuff->rtc_drift_ppm_ = -99999.9;
+  wifi_stuff->dns_cache_.hits_ = wifi_stuff->dns_cache_.lookups_ = wifi_stuff->dns_cache_.saved_ms_ = UINT32_MAX;
+  framebuffer_mirror.blits_sent_ = framebuffer_mirror.blits_skipped_ = UINT32_MAX;
+  sim_network.fast_connect_ms = wifi_stuff->wifi_fast_connect_timeout_ms_ - 1;
+  sim_network.full_connect_ms = wifi_stuff->wifi_connect_timeout_ms_ - 1;
+  // WiFi details saved again: full connect, then fast connect to the cached access point
+  wifi_stuff->SaveWiFiDetails();
+  for (int connect = 0; connect < 2; connect++) {
+    wifi_stuff->TurnWiFiOff();
+    CHECK(wifi_stuff->TurnWiFiOn());
+  }
+  HostAdvanceMicros(10ULL * 365 * 24 * 3600 * 1000000);    // 10 years of uptime
+
+  std::string status = StatusJson();
+  CHECK(!status.empty());
+  CHECK(status.size() < kStatusBufferSize * 9 / 10);
+  std::map<std::string, std::string> members;
+  CHECK(Flatten(status, members));
+  // connect ends at a connect poll after the connect time
+  CHECK(atoi(members["wifi.fast_connect.max_ms"].c_str()) >= (int)sim_network.fast_connect_ms);
+  CHECK(atoi(members["wifi.full_connect.max_ms"].c_str()) >= (int)sim_network.full_connect_ms);
+  CHECK_STR(members["dns_cache.hits"], "4294967295");
+}
+
+int main() {
+  HostDs3231Set(0, 0, 6, 2, 3, 6, 24);
+  HostSetPin(BUTTON_PIN, HIGH);
+  HostSetPin(INC_BUTTON_PIN, HIGH);
+  HostSetPin(DEC_BUTTON_PIN, HIGH);
+  setup();
+  HostTakeSerialOutput();
+
+  TestNoServerBeforeStart();
+  TestStatusOverLoopback();
+  TestNtpMembers();
+  TestLargestDocumentFits();
+  return CHECK_RESULT();
+}
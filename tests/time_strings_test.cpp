@@ -0,0 +1,171 @@
+// Incremental time and date strings of the real sketch against the snprintf() formatting they
+// replaced: the whole sketch runs on the host stand-ins, the simulated DS3231 is ticked and
+// raises SQW so the seconds ISR advances the RTC snapshot, and PrepareTimeDayDateArrays() is
+// called every second as from loop(). Over a year of seconds in 12 hour mode, two days in
+// 24 hour mode and time jumps, every string must equal the snprintf() one and changed_fields
+// must flag exactly the fields whose inputs changed. Alarm slot 0 is edited along the way.
+
+#include "common.h"
+#include "host.h"
+#include "check.h"
+#include "rtc.h"
+#include "alarm_clock.h"
+#include "general_constants.h"
+#include <uRTCLib.h>
+#include <string.h>
+
+void setup();
+
+static uint32_t mismatches = 0, wrong_flags = 0;
+
+struct AlarmFields {
+  uint8_t hr, min;
+  bool is_AM, ON;
+  bool operator!=(const AlarmFields &other) const { return hr != other.hr || min != other.min || is_AM != other.is_AM || ON != other.ON; }
+};
+
+static AlarmFields CurrentAlarmFields() {
+  return { alarm_clock->alarm_hr_, alarm_clock->alarm_min_, alarm_clock->alarm_is_AM_, alarm_clock->alarm_ON_ };
+}
+
+// strings as PrepareTimeDayDateArrays() wrote them with snprintf() every second
+static void CheckStrings(const RTC::TimeSnapshot &now) {
+  char time_HHMM[kHHMM_ArraySize], time_SS[kSS_ArraySize], date_str[kDateArraySize], alarm_str[kAlarmArraySize];
+  snprintf(time_HHMM, kHHMM_ArraySize, "%d:%02d", now.hour, now.minute);
+  snprintf(time_SS, kSS_ArraySize, ":%02d", now.second);
+  snprintf(date_str, kDateArraySize, "%s  %d  %s", kDaysTable_[now.day_of_week - 1], now.day, kMonthsTable[now.month - 1]);
+  if(alarm_clock->alarm_ON_)
+    snprintf(alarm_str, kAlarmArraySize, "%d:%02d %s", alarm_clock->alarm_hr_, alarm_clock->alarm_min_, (alarm_clock->alarm_is_AM_ ? kAmLabel : kPmLabel));
+  else
+    snprintf(alarm_str, kAlarmArraySize, "%s %s", kAlarmLabel, kOffLabel);
+  bool equal = strcmp(new_display_data_.time_HHMM, time_HHMM) == 0 && strcmp(new_display_data_.time_SS, time_SS) == 0
+    && strcmp(new_display_data_.date_str, date_str) == 0 && strcmp(new_display_data_.alarm_str, alarm_str) == 0
+    && new_display_data_._12_hour_mode == (now.hour_mode_and_am_pm != 0)
+    && (now.hour_mode_and_am_pm == 0 || new_display_data_.pm_not_am == (now.hour_mode_and_am_pm == 2))
+    && new_display_data_.alarm_ON == alarm_clock->alarm_ON_;
+  if(!equal && mismatches++ < 5)
+    fprintf(stderr, "%04u-%02u-%02u %s%s \"%s\" \"%s\" != %s%s \"%s\" \"%s\"\n", now.year, now.month, now.day,
+      new_display_data_.time_HHMM, new_display_data_.time_SS, new_display_data_.date_str, new_display_data_.alarm_str,
+      time_HHMM, time_SS, date_str, alarm_str);
+}
+
+// one PrepareTimeDayDateArrays() call, then changed_fields is taken as the display would
+static void PrepareAndCheck(uint8_t expected_fields) {
+  PrepareTimeDayDateArrays();
+  RTC::TimeSnapshot now = rtc->Now();
+  CheckStrings(now);
+  if(new_display_data_.changed_fields != expected_fields && wrong_flags++ < 5)
+    fprintf(stderr, "%04u-%02u-%02u %02u:%02u:%02u changed_fields 0x%02x, expected 0x%02x\n", now.year, now.month, now.day,
+      now.hour, now.minute, now.second, new_display_data_.changed_fields, expected_fields);
+  new_display_data_.changed_fields = 0;
+}
+
+// DS3231 SQW rising edge a second later
+static void TickSecond() {
+  HostSetPin(SQW_INT_PIN, LOW);
+  HostDs3231Tick();
+  HostSetPin(SQW_INT_PIN, HIGH);
+}
+
+// seconds ticked one by one; alarm slot 0 is edited every 997 minutes, between seconds
+static void RunSeconds(uint32_t seconds) {
+  static uint32_t alarm_edits = 0;
+  for (uint32_t i = 0; i < seconds; i++) {
+    RTC::TimeSnapshot before = rtc->Now();
+    AlarmFields alarm_before = CurrentAlarmFields();
+    if(i % (997 * 60) == 30) {
+      alarm_edits++;
+      alarm_clock->SetAlarmSlot(0, alarm_edits * 37 % kMinutesInDay, alarm_edits % 3 != 0, kAlarmEveryDay, false);
+    }
+    TickSecond();
+    RTC::TimeSnapshot now = rtc->Now();
+    uint8_t expected = kTimeSSChanged;
+    if(now.minute != before.minute || now.hour_mode_and_am_pm != before.hour_mode_and_am_pm)
+      expected |= kTimeHHMMChanged;
+    if(now.day != before.day)
+      expected |= kDateChanged;
+    if(CurrentAlarmFields() != alarm_before)
+      expected |= kAlarmChanged;
+    PrepareAndCheck(expected);
+    if(now.second == 0 && now.minute == 0)
+      HostTakeSerialOutput();   // RTC refresh prints every minute
+  }
+}
+
+// Dec 31 2023 to Jan 1 2025: leap day, every AM/PM flip and single digit hour of a year
+static void TestYearIn12HourMode() {
+  HostDs3231Set(50, 59, 23, 1, 31, 12, 23);
+  rtc->set_12hour_mode(true);
+  PrepareAndCheck(kTimeSSChanged | kTimeHHMMChanged | kDateChanged);
+  RunSeconds(366 * 24 * 3600 + 20);
+  RTC::TimeSnapshot now = rtc->Now();
+  CHECK_EQ(now.year, 2025);
+  CHECK_EQ(now.month, 1);
+  CHECK_EQ(now.day, 1);
+  CHECK_STR(new_display_data_.time_HHMM, "12:00");
+  CHECK_STR(new_display_data_.date_str, "Wed  1  Jan");
+}
+
+static void TestTwoDaysIn24HourMode() {
+  rtc->set_12hour_mode(false);
+  PrepareAndCheck(kTimeHHMMChanged);
+  CHECK_STR(new_display_data_.time_HHMM, "0:00");
+  CHECK(!new_display_data_._12_hour_mode);
+  RunSeconds(2 * 24 * 3600);
+  CHECK_STR(new_display_data_.date_str, "Fri  3  Jan");
+  rtc->set_12hour_mode(true);
+  PrepareAndCheck(kTimeHHMMChanged);
+  CHECK_STR(new_display_data_.time_HHMM, "12:00");
+}
+
+// time set from NTP or the settings page: seconds are rewritten, not incremented
+static void TestTimeJumps() {
+  const uint8_t jumps[][7] = {
+    { 59, 59, 9, 3, 29, 2, 28 },      // second, minute, hour_24, day_of_week, day, month, year
+    { 8, 59, 9, 3, 29, 2, 28 },       // back in time, same minute
+    { 9, 59, 9, 3, 29, 2, 28 },       // one second on, after a jump
+    { 9, 0, 12, 3, 29, 2, 28 },
+    { 0, 0, 0, 4, 1, 3, 28 },
+  };
+  uint8_t expected[] = {
+    kTimeSSChanged | kTimeHHMMChanged | kDateChanged,
+    kTimeSSChanged,
+    kTimeSSChanged,
+    kTimeHHMMChanged,
+    kTimeSSChanged | kTimeHHMMChanged | kDateChanged,
+  };
+  for (size_t i = 0; i < sizeof(jumps) / sizeof(jumps[0]); i++) {
+    HostDs3231Set(jumps[i][0], jumps[i][1], jumps[i][2], jumps[i][3], jumps[i][4], jumps[i][5], jumps[i][6]);
+    rtc->set_12hour_mode(true);
+    PrepareAndCheck(expected[i]);
+  }
+  CHECK_STR(new_display_data_.date_str, "Wed  1  Mar");
+  RunSeconds(3600);
+}
+
+// no change, no flag: nothing to redraw
+static void TestNoChangeNoFlags() {
+  PrepareAndCheck(0);
+  alarm_clock->SetAlarmSlot(0, alarm_clock->alarm_schedule_[0].minute_of_day, alarm_clock->alarm_schedule_[0].on, 0x3E, false);
+  PrepareAndCheck(0);
+  alarm_clock->SetAlarmSlot(0, 13 * 60 + 5, true, kAlarmEveryDay, false);
+  PrepareAndCheck(kAlarmChanged);
+  CHECK_STR(new_display_data_.alarm_str, "1:05 PM");
+}
+
+int main() {
+  HostDs3231Set(0, 0, 6, 2, 3, 6, 24);
+  HostSetPin(BUTTON_PIN, HIGH);
+  HostSetPin(INC_BUTTON_PIN, HIGH);
+  HostSetPin(DEC_BUTTON_PIN, HIGH);
+  setup();
+  HostTakeSerialOutput();
+
+  TestYearIn12HourMode();
+  TestTwoDaysIn24HourMode();
+  TestTimeJumps();
+  TestNoChangeNoFlags();
+  CHECK_EQ(mismatches, 0);
+  CHECK_EQ(wrong_flags, 0);
+  return CHECK_RESULT();
+}
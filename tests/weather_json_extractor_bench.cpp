@@ -0,0 +1,71 @@
+// Throughput of WeatherJsonExtractor against parsing the same responses into the reference
+// DOM of json_reference.h and walking it, as a stand-in for a DOM JSON library.
+// Heap bytes allocated per parse are counted too, that is what the extractor saves on the clock.
+// Run with `make bench`, built without sanitizers.
+
+#include "weather_json_extractor.h"
+#include "json_reference.h"
+#include <chrono>
+#include <fstream>
+#include <new>
+#include <sstream>
+
+static size_t heap_bytes = 0;
+
+void* operator new(size_t size) {
+  heap_bytes += size;
+  void* pointer = malloc(size);
+  if(pointer == NULL) throw std::bad_alloc();
+  return pointer;
+}
+void operator delete(void* pointer) noexcept { free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { free(pointer); }
+
+static std::string ReadFixture(const char* file_name) {
+  std::ifstream file(std::string("fixtures/weather/") + file_name, std::ios::binary);
+  std::stringstream contents;
+  contents << file.rdbuf();
+  return contents.str();
+}
+
+// returns MB/s, heap bytes allocated by one run in heap_per_run
+template<typename Function> static double MegabytesPerSecond(size_t bytes_per_run, size_t &heap_per_run, Function function) {
+  const int kRuns = 20000;
+  heap_bytes = 0;
+  function();
+  heap_per_run = heap_bytes;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kRuns; i++)
+    function();
+  std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+  return (double)bytes_per_run * kRuns / seconds.count() / 1e6;
+}
+
+int main() {
+  static const char* kFixtures[] = { "san_diego_standard.json", "anchorage_imperial_snow_pretty.json", "long_strings_and_escapes.json" };
+  volatile uint32_t sink = 0;
+  for (const char* fixture : kFixtures) {
+    std::string json = ReadFixture(fixture);
+
+    size_t extractor_heap, reference_heap;
+    double extractor_mb_s = MegabytesPerSecond(json.size(), extractor_heap, [&]() {
+      WeatherJsonExtractor extractor;
+      extractor.Reset();
+      extractor.Feed((const uint8_t*)json.data(), json.size());
+      sink = sink + extractor.found_fields;
+    });
+
+    double reference_mb_s = MegabytesPerSecond(json.size(), reference_heap, [&]() {
+      JsonReferenceParser parser;
+      JsonValue root;
+      parser.Parse(json.data(), json.size(), root);
+      WeatherReference reference;
+      reference.Extract(root);
+      sink = sink + reference.found_fields;
+    });
+
+    printf("%-38s %4zu bytes  extractor %6.1f MB/s %5zu heap bytes  reference DOM %6.1f MB/s %5zu heap bytes\n",
+      fixture, json.size(), extractor_mb_s, extractor_heap, reference_mb_s, reference_heap);
+  }
+  return 0;
+}
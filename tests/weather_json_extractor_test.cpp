@@ -0,0 +1,377 @@
+// WeatherJsonExtractor against recorded OpenWeatherMap responses in fixtures/weather and,
+// differentially, against the strict DOM parser in json_reference.h:
+// - fixtures give explicit expected values
+// - any split of the input into chunks gives the same result as one Feed()
+// - random valid documents, with wanted keys at random places, repeated and of wrong types,
+//   must extract what the reference extracts, deeper than 6 levels must fail
+// - byte level mutations of fixtures must not crash or overrun (built with ASan/UBSan) and
+//   must match the reference whenever the mutation is still valid JSON
+
+#include "weather_json_extractor.h"
+#include "json_reference.h"
+#include "check.h"
+#include <math.h>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+static std::string ReadFixture(const char* file_name) {
+  std::ifstream file(std::string("fixtures/weather/") + file_name, std::ios::binary);
+  CHECK(file.good());
+  std::stringstream contents;
+  contents << file.rdbuf();
+  return contents.str();
+}
+
+static void FeedOnce(WeatherJsonExtractor &extractor, const std::string &json) {
+  extractor.Reset();
+  extractor.Feed((const uint8_t*)json.data(), json.size());
+}
+
+// same outcome and same bytes in value buffers, both were zero initialized before Reset()
+static bool SameResult(WeatherJsonExtractor &a, WeatherJsonExtractor &b) {
+  return a.Done() == b.Done() && a.Failed() == b.Failed() && a.found_fields == b.found_fields &&
+    memcmp(a.weather_main, b.weather_main, sizeof(a.weather_main)) == 0 &&
+    memcmp(a.weather_description, b.weather_description, sizeof(a.weather_description)) == 0 &&
+    memcmp(a.name, b.name, sizeof(a.name)) == 0 &&
+    memcmp(a.number_values, b.number_values, sizeof(a.number_values)) == 0;
+}
+
+static int reference_mismatches = 0;
+
+static void CheckAgainstReference(const WeatherJsonExtractor &extractor, const WeatherReference &reference, const std::string &json) {
+  bool same = (extractor.found_fields == reference.found_fields);
+  same = same && reference.weather_main == extractor.weather_main;
+  same = same && reference.weather_description == extractor.weather_description;
+  same = same && reference.name == extractor.name;
+  for (int field = WeatherJsonExtractor::kMainTemp; field <= WeatherJsonExtractor::kTimezone; field++)
+    if(reference.found_fields & (1 << field))
+      same = same && memcmp(&reference.number_values[field], &extractor.number_values[field], sizeof(float)) == 0;
+  if(!same) {
+    check_failures++;
+    if(reference_mismatches++ < 5)
+      fprintf(stderr, "reference mismatch, found %03x expected %03x, input:\n%s\n", extractor.found_fields, reference.found_fields, json.c_str());
+  }
+}
+
+static void TestFixtures() {
+  WeatherJsonExtractor extractor{};
+
+  FeedOnce(extractor, ReadFixture("san_diego_standard.json"));
+  CHECK(extractor.Done() && !extractor.Failed());
+  CHECK_EQ(extractor.found_fields, WeatherJsonExtractor::kAllFieldsFound);
+  CHECK_STR(extractor.weather_main, "Clear");
+  CHECK_STR(extractor.weather_description, "clear sky");
+  CHECK_STR(extractor.name, "San Diego");
+  CHECK_EQ(lroundf(extractor.number_values[WeatherJsonExtractor::kMainTemp] * 100), 29115);
+  CHECK_EQ(lroundf(extractor.number_values[WeatherJsonExtractor::kMainHumidity]), 59);
+  CHECK_EQ(lroundf(extractor.number_values[WeatherJsonExtractor::kWindSpeed] * 10), 36);
+  CHECK_EQ(lroundf(extractor.number_values[WeatherJsonExtractor::kTimezone]), -25200);
+
+  // first of two weather conditions is taken
+  FeedOnce(extractor, ReadFixture("london_metric_rain.json"));
+  CHECK(extractor.Done());
+  CHECK_EQ(extractor.found_fields, WeatherJsonExtractor::kAllFieldsFound);
+  CHECK_STR(extractor.weather_main, "Rain");
+  CHECK_STR(extractor.weather_description, "moderate rain");
+  CHECK_EQ(lroundf(extractor.number_values[WeatherJsonExtractor::kMainFeelsLike] * 10), 59);
+  CHECK_EQ(lroundf(extractor.number_values[WeatherJsonExtractor::kTimezone]), 0);
+
+  FeedOnce(extractor, ReadFixture("anchorage_imperial_snow_pretty.json"));
+  CHECK(extractor.Done());
+  CHECK_EQ(extractor.found_fields, WeatherJsonExtractor::kAllFieldsFound);
+  CHECK_STR(extractor.weather_main, "Snow");
+  CHECK_EQ(lroundf(extractor.number_values[WeatherJsonExtractor::kMainFeelsLike] * 10), -13);
+  CHECK_EQ(lroundf(extractor.number_values[WeatherJsonExtractor::kMainTempMax]), 14);
+
+  // escapes, exponents and strings longer than the buffers
+  FeedOnce(extractor, ReadFixture("long_strings_and_escapes.json"));
+  CHECK(extractor.Done());
+  CHECK_EQ(extractor.found_fields, WeatherJsonExtractor::kAllFieldsFound);
+  CHECK_STR(extractor.weather_main, "Thunderstorm");
+  CHECK_STR(extractor.weather_description, "thunderstorm with heavy drizzle");
+  CHECK_EQ(strlen(extractor.name), sizeof(extractor.name) - 1);
+  CHECK_EQ(lroundf(extractor.number_values[WeatherJsonExtractor::kMainTemp]), 15);
+  CHECK_EQ(lroundf(extractor.number_values[WeatherJsonExtractor::kMainTempMax] * 100), -5);
+  CHECK_EQ(lroundf(extractor.number_values[WeatherJsonExtractor::kWindSpeed]), 0);
+
+  // UTF-8 is copied as bytes, \u escapes as text
+  FeedOnce(extractor, ReadFixture("sao_paulo_utf8.json"));
+  CHECK(extractor.Done());
+  CHECK_STR(extractor.name, "S\xc3\xa3o Paulo");
+  FeedOnce(extractor, ReadFixture("zurich_unicode_escape.json"));
+  CHECK(extractor.Done());
+  CHECK_STR(extractor.name, "Zu00fcrich");
+  CHECK_EQ(lroundf(extractor.number_values[WeatherJsonExtractor::kMainTemp] * 100), -207);
+
+  FeedOnce(extractor, ReadFixture("city_not_found.json"));
+  CHECK(extractor.Done() && !extractor.Failed());
+  CHECK_EQ(extractor.found_fields, 0);
+
+  // wanted keys with values of wrong type are not found
+  FeedOnce(extractor, "{\"name\":5,\"timezone\":\"3600\",\"main\":{\"temp\":true,\"humidity\":null},\"weather\":[{\"main\":7}]}");
+  CHECK(extractor.Done());
+  CHECK_EQ(extractor.found_fields, 0);
+  // numbers too long for the token are not taken truncated
+  FeedOnce(extractor, "{\"timezone\":3600.00000000000000000000001,\"main\":{\"temp\":1.000000000000000000e2}}");
+  CHECK(extractor.Done());
+  CHECK_EQ(extractor.found_fields, (1 << WeatherJsonExtractor::kMainTemp));
+  CHECK_EQ(lroundf(extractor.number_values[WeatherJsonExtractor::kMainTemp]), 100);
+
+  FeedOnce(extractor, "{\"main\":{\"temp\":1}");
+  CHECK(!extractor.Done() && !extractor.Failed());
+  FeedOnce(extractor, "{\"a\":[[[[[[1]]]]]]}");
+  CHECK(extractor.Failed());
+  FeedOnce(extractor, "{\"a\":[[[[1]]]]} trailing ] garbage");
+  CHECK(extractor.Done() && !extractor.Failed());
+}
+
+// any chunking gives the same result as one Feed()
+static void CheckChunked(const std::string &json, std::mt19937 &random_generator) {
+  WeatherJsonExtractor once{}, chunked{}, bytes{};
+  FeedOnce(once, json);
+
+  chunked.Reset();
+  for (size_t i = 0; i < json.size(); ) {
+    size_t length = std::min(json.size() - i, (size_t)(1 + random_generator() % 64));
+    chunked.Feed((const uint8_t*)json.data() + i, length);
+    i += length;
+  }
+  CHECK(SameResult(once, chunked));
+
+  bytes.Reset();
+  for (char c : json)
+    bytes.Feed(c);
+  CHECK(SameResult(once, bytes));
+}
+
+static void CheckInput(const std::string &json, std::mt19937 &random_generator, uint32_t &compared) {
+  CheckChunked(json, random_generator);
+
+  WeatherJsonExtractor extractor{};
+  FeedOnce(extractor, json);
+  if(extractor.Done()) {
+    CHECK(strlen(extractor.weather_main) < sizeof(extractor.weather_main));
+    CHECK(strlen(extractor.weather_description) < sizeof(extractor.weather_description));
+    CHECK(strlen(extractor.name) < sizeof(extractor.name));
+  }
+
+  JsonReferenceParser parser;
+  JsonValue root;
+  if(!parser.Parse(json.data(), json.size(), root) || root.type != JsonValue::kObject)
+    return;
+  if(parser.max_depth() > 6) {
+    CHECK(extractor.Failed());
+    return;
+  }
+  CHECK(extractor.Done() && !extractor.Failed());
+  WeatherReference reference;
+  reference.Extract(root);
+  CheckAgainstReference(extractor, reference, json);
+  compared++;
+}
+
+// random valid documents built around the wanted paths
+class DocumentGenerator {
+
+public:
+
+  explicit DocumentGenerator(std::mt19937 &random_generator) : random_generator_(random_generator) {}
+
+  std::string Document() {
+    std::string json;
+    Object(json, 1, kRoot);
+    return json;
+  }
+
+private:
+
+  std::mt19937 &random_generator_;
+
+  // where a value is, so that wanted paths are generated often
+  enum Context { kRoot, kMain, kWind, kWeatherArray, kWeatherElement, kOther, kWantedNumber, kWantedString };
+
+  uint32_t Random(uint32_t n) { return random_generator_() % n; }
+
+  void Space(std::string &json) {
+    static const char kWhitespace[] = { ' ', '\n', '\r', '\t' };
+    while(Random(4) == 0)
+      json += kWhitespace[Random(4)];
+  }
+
+  // writes a key of an object in context, returns context of its value
+  Context Key(std::string &json, Context context) {
+    static const char* kKeys[] = { "weather", "main", "description", "temp", "feels_like", "temp_min", "temp_max",
+      "humidity", "wind", "speed", "timezone", "name", "id", "coord", "Temp", "main ", "te\\u006dp", "na\\/me",
+      "a_key_much_longer_than_the_token_buffer", "" };
+    static const char* kWantedKeys[][5] = {
+      { "weather", "main", "wind", "timezone", "name" },                    // kRoot
+      { "temp", "feels_like", "temp_min", "temp_max", "humidity" },         // kMain
+      { "speed", "speed", "speed", "gust", "deg" },                         // kWind
+      { "", "", "", "", "" },                                               // kWeatherArray, has no keys
+      { "main", "description", "main", "description", "icon" },             // kWeatherElement
+    };
+    std::string key;
+    if(context != kOther && Random(3) != 0)
+      key = kWantedKeys[context][Random(5)];
+    else
+      key = kKeys[Random(sizeof(kKeys) / sizeof(kKeys[0]))];
+    json += '"' + key + '"';
+
+    if(context == kRoot) {
+      if(key == "weather") return kWeatherArray;
+      if(key == "main") return kMain;
+      if(key == "wind") return kWind;
+      if(key == "timezone") return kWantedNumber;
+      if(key == "name") return kWantedString;
+    }
+    else if(context == kMain) {
+      for (int i = 0; i < 5; i++)
+        if(key == kWantedKeys[kMain][i]) return kWantedNumber;
+    }
+    else if(context == kWind && key == "speed")
+      return kWantedNumber;
+    else if(context == kWeatherElement && (key == "main" || key == "description"))
+      return kWantedString;
+    return kOther;
+  }
+
+  void String(std::string &json) {
+    static const char* kPieces[] = { "a", "Clear", " ", "\\\"", "\\\\", "\\/", "\\b", "\\f", "\\n", "\\r", "\\t",
+      "\\u00e9", "\\uD83D\\uDE00", "\xc3\xa3", "\xe2\x82\xac", "{", "]", ",", ":" };
+    json += '"';
+    int pieces = Random(3) == 0 ? Random(60) : Random(8);
+    for (int i = 0; i < pieces; i++)
+      json += kPieces[Random(sizeof(kPieces) / sizeof(kPieces[0]))];
+    json += '"';
+  }
+
+  void Number(std::string &json) {
+    if(Random(2)) json += '-';
+    if(Random(5) == 0)
+      json += '0';
+    else {
+      json += (char)('1' + Random(9));
+      int digits = Random(6) == 0 ? Random(30) : Random(5);
+      for (int i = 0; i < digits; i++) json += (char)('0' + Random(10));
+    }
+    if(Random(2)) {
+      json += '.';
+      int digits = 1 + Random(Random(6) == 0 ? 25 : 4);
+      for (int i = 0; i < digits; i++) json += (char)('0' + Random(10));
+    }
+    if(Random(4) == 0) {
+      json += (Random(2) ? 'e' : 'E');
+      if(Random(2)) json += (Random(2) ? '+' : '-');
+      json += (char)('0' + Random(10));
+    }
+  }
+
+  void Value(std::string &json, int depth, Context context) {
+    // mostly the type a wanted path expects, sometimes any
+    if(Random(4) != 0) {
+      if(context == kWantedNumber) return Number(json);
+      if(context == kWantedString) return String(json);
+      if(context == kMain || context == kWind) return Object(json, depth + 1, context);
+      if(context == kWeatherArray) return Array(json, depth + 1, context);
+    }
+    if(context == kWeatherArray || context == kWeatherElement) context = kOther;
+    uint32_t type = Random(depth < 8 ? 10 : 6);
+    if(type < 2) String(json);
+    else if(type < 4) Number(json);
+    else if(type == 4) json += (Random(2) ? "true" : "null");
+    else if(type == 5) json += "false";
+    else if(type < 8) Object(json, depth + 1, (context == kMain || context == kWind ? context : kOther));
+    else Array(json, depth + 1, kOther);
+  }
+
+  void Object(std::string &json, int depth, Context context) {
+    json += '{';
+    Space(json);
+    int members = Random(context == kRoot ? 12 : 5);
+    for (int i = 0; i < members; i++) {
+      if(i > 0) { json += ','; Space(json); }
+      Context value_context = Key(json, context);
+      Space(json);
+      json += ':';
+      Space(json);
+      Value(json, depth, value_context);
+      Space(json);
+    }
+    json += '}';
+  }
+
+  void Array(std::string &json, int depth, Context context) {
+    json += '[';
+    Space(json);
+    int elements = Random(4);
+    for (int i = 0; i < elements; i++) {
+      if(i > 0) { json += ','; Space(json); }
+      if(context == kWeatherArray && Random(3) != 0)
+        Object(json, depth + 1, kWeatherElement);
+      else
+        Value(json, depth, kOther);
+      Space(json);
+    }
+    json += ']';
+  }
+
+};
+
+static void TestRandomDocuments() {
+  std::mt19937 random_generator(37);
+  DocumentGenerator generator(random_generator);
+  uint32_t compared = 0, found = 0;
+  for (int i = 0; i < 30000; i++) {
+    std::string json = generator.Document();
+    CheckInput(json, random_generator, compared);
+    WeatherJsonExtractor extractor{};
+    FeedOnce(extractor, json);
+    found += __builtin_popcount(extractor.found_fields);
+  }
+  // most documents are valid and within depth, and wanted fields do get found
+  CHECK(compared > 20000);
+  CHECK(found > 10000);
+  printf("random documents: %u compared with reference, %u fields found\n", compared, found);
+}
+
+static void TestMutatedFixtures() {
+  static const char* kFixtures[] = { "san_diego_standard.json", "london_metric_rain.json", "anchorage_imperial_snow_pretty.json",
+    "long_strings_and_escapes.json", "sao_paulo_utf8.json", "zurich_unicode_escape.json", "city_not_found.json" };
+  static const char* kTokens[] = { "{", "}", "[", "]", ",", ":", "\"", "\\", "\\u", "0", "-", "1e5", "true", " ", "\n", "\xff", "\0" };
+  std::mt19937 random_generator(4037);
+  uint32_t compared = 0, inputs = 0;
+  for (const char* fixture : kFixtures) {
+    std::string original = ReadFixture(fixture);
+    for (int i = 0; i < 3000; i++) {
+      std::string json = original;
+      int mutations = 1 + random_generator() % 3;
+      for (int m = 0; m < mutations && !json.empty(); m++) {
+        size_t position = random_generator() % json.size();
+        switch(random_generator() % 6) {
+          case 0: json[position] = (char)(random_generator() % 256); break;
+          case 1: json.erase(position, 1 + random_generator() % 8); break;
+          case 2: {
+            const char* token = kTokens[random_generator() % (sizeof(kTokens) / sizeof(kTokens[0]))];
+            json.insert(position, token, std::max((size_t)1, strlen(token)));
+            break;
+          }
+          case 3: json.insert(position, json.substr(position, random_generator() % 40)); break;
+          case 4: json.resize(position); break;
+          case 5: std::swap(json[position], json[random_generator() % json.size()]); break;
+        }
+      }
+      CheckInput(json, random_generator, compared);
+      inputs++;
+    }
+  }
+  CHECK(compared > 0);
+  printf("mutated fixtures: %u inputs, %u still valid and compared with reference\n", inputs, compared);
+}
+
+int main() {
+  TestFixtures();
+  TestRandomDocuments();
+  TestMutatedFixtures();
+  return CHECK_RESULT();
+}
@@ -0,0 +1,293 @@
+// Gzip pages of web_pages.h and the /values endpoints of the soft AP and location servers. The whole
+// sketch runs on the host stand-ins with the fake WiFiStuff of sim/, the servers are started as from
+// their pages and answer on a loopback socket. Every page in web_pages.h must inflate to its
+// tools/web_pages/ source as tools/web_pages.py build strips it, "/" must send it with
+// Content-Encoding: gzip, and /values must escape quotes, backslashes and control characters in the
+// entered values so that the page's JSON parser reads them back as entered.
+// Then tools/web_pages.py bench fetches each page as served now and as served before from its
+// %placeholder% template, uncompressed, and reports bytes on the wire, median and max response time.
+// On loopback the time does not depend on the bytes, the bench checks only that the gzip page and
+// /values together are smaller than the page was. Needs python3 for the bench, and zlib.
+
+#include "common.h"
+#include "host.h"
+#include "check.h"
+#include "sim.h"
+#include "json_reader.h"
+#include "web_pages.h"
+#include "web_server.h"
+#include "wifi_stuff.h"
+#include <ESPAsyncWebServer.h>
+#include <uRTCLib.h>
+#include <zlib.h>
+#include <atomic>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <unistd.h>
+
+void setup();
+
+static std::string ReadFile(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  CHECK(file.good());
+  return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// page as tools/web_pages.py build compresses it: lines stripped, blank lines dropped
+static std::string StrippedPage(const std::string &path) {
+  std::string html = ReadFile(path), stripped, line;
+  size_t start = 0;
+  while(start < html.size()) {
+    size_t end = html.find('\n', start);
+    if(end == std::string::npos) end = html.size();
+    line = html.substr(start, end - start);
+    start = end + 1;
+    size_t first = line.find_first_not_of(" \t\r\v\f"), last = line.find_last_not_of(" \t\r\v\f");
+    if(first == std::string::npos) continue;
+    if(!stripped.empty()) stripped += '\n';
+    stripped += line.substr(first, last - first + 1);
+  }
+  return stripped;
+}
+
+static bool Gunzip(const std::string &data, std::string &out) {
+  z_stream stream = {};
+  if(inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK) return false;
+  stream.next_in = (Bytef*)data.data();
+  stream.avail_in = data.size();
+  char buffer[4096];
+  int result;
+  do {
+    stream.next_out = (Bytef*)buffer;
+    stream.avail_out = sizeof(buffer);
+    result = inflate(&stream, Z_NO_FLUSH);
+    out.append(buffer, sizeof(buffer) - stream.avail_out);
+  } while(result == Z_OK);
+  inflateEnd(&stream);
+  return result == Z_STREAM_END && stream.avail_in == 0;
+}
+
+static void TestPagesMatchSources() {
+  struct { const uint8_t* page; size_t size; const char* source; } kPages[] = {
+    { kWiFiDetailsHtmlGz, sizeof(kWiFiDetailsHtmlGz), "wifi_details.html" },
+    { kLocationDetailsHtmlGz, sizeof(kLocationDetailsHtmlGz), "location_details.html" },
+    { kFramebufferViewerHtmlGz, sizeof(kFramebufferViewerHtmlGz), "framebuffer_viewer.html" },
+  };
+  for (auto &page : kPages) {
+    std::string html;
+    CHECK(Gunzip(std::string((const char*)page.page, page.size), html));
+    CHECK(html == StrippedPage(std::string("../tools/web_pages/") + page.source));
+    CHECK(page.size < html.size());
+  }
+}
+
+static std::string Header(const SimHttpResponse &response, const std::string &name) {
+  size_t start = response.headers.find(name + ": ");
+  if(start == std::string::npos) return "";
+  start += name.size() + 2;
+  return response.headers.substr(start, response.headers.find("\r\n", start) - start);
+}
+
+// "/" sends page_gz as it is, gzip encoded
+static void CheckPage(const uint8_t* page_gz, size_t page_size, const char* source) {
+  SimHttpResponse response = SimHttpRequest("GET", "/", "", "Accept-Encoding: gzip\r\n");
+  CHECK_EQ(response.code, 200);
+  CHECK_STR(Header(response, "Content-Encoding"), "gzip");
+  CHECK_STR(Header(response, "Content-Type"), "text/html");
+  CHECK(response.body == std::string((const char*)page_gz, page_size));
+  std::string html;
+  CHECK(Gunzip(response.body, html));
+  CHECK(html == StrippedPage(std::string("../tools/web_pages/") + source));
+}
+
+// /values is one JSON object whose members read back as values, as the page's JSON.parse() would
+static void CheckValues(const std::string &expected_json, const char* keys[2], const String* values[2]) {
+  SimHttpResponse response = SimHttpRequest("GET", "/values");
+  CHECK_EQ(response.code, 200);
+  CHECK_STR(Header(response, "Content-Type"), "application/json");
+  CHECK_STR(response.body, expected_json);
+  JsonReader reader(response.body.data(), response.body.size());
+  JsonReader::Token token;
+  CHECK_EQ(reader.Next(token), JsonReader::kObjectStart);
+  for (int i = 0; i < 2; i++) {
+    CHECK_EQ(reader.Next(token), JsonReader::kKey);
+    CHECK(JsonReader::Equals(token, keys[i]));
+    CHECK_EQ(reader.Next(token), JsonReader::kString);
+    char value[128];
+    CHECK(JsonReader::CopyString(token, value, sizeof(value)));
+    CHECK_STR(value, values[i]->c_str());
+  }
+  CHECK_EQ(reader.Next(token), JsonReader::kObjectEnd);
+  CHECK_EQ(reader.Next(token), JsonReader::kEnd);
+}
+
+static void TestSoftApPage() {
+  wifi_stuff->wifi_ssid_ = "Home \"5G\"";
+  wifi_stuff->wifi_password_ = "C:\\pass\"word\t1";
+  wifi_stuff->StartSetWiFiSoftAP();
+  CHECK(HostWebServerPort() != 0);
+  CheckPage(kWiFiDetailsHtmlGz, sizeof(kWiFiDetailsHtmlGz), "wifi_details.html");
+  const char* keys[2] = { "html_ssid", "html_passwd" };
+  const String* values[2] = { &temp_ssid_str, &temp_passwd_str };
+  CheckValues("{\"html_ssid\":\"Home \\\"5G\\\"\",\"html_passwd\":\"C:\\\\pass\\\"word\\u00091\"}", keys, values);
+
+  // value entered on the page comes back escaped
+  CHECK_EQ(SimHttpRequest("GET", "/get?html_ssid=a%22b%5Cc").code, 200);
+  CHECK_STR(temp_ssid_str, "a\"b\\c");
+  CheckValues("{\"html_ssid\":\"a\\\"b\\\\c\",\"html_passwd\":\"C:\\\\pass\\\"word\\u00091\"}", keys, values);
+
+  // longest SSID and password WiFi allows, every character escaped, still fit the endpoint's buffer
+  temp_ssid_str = std::string(32, '"');
+  temp_passwd_str = std::string(63, '\\');
+  std::string escaped_ssid, escaped_passwd;
+  for (int i = 0; i < 32; i++) escaped_ssid += "\\\"";
+  for (int i = 0; i < 63; i++) escaped_passwd += "\\\\";
+  CheckValues("{\"html_ssid\":\"" + escaped_ssid + "\",\"html_passwd\":\"" + escaped_passwd + "\"}", keys, values);
+}
+
+static void TestLocationPage() {
+  wifi_stuff->location_zip_code_ = 92101;
+  wifi_stuff->location_country_code_ = "U\"S";
+  wifi_stuff->StartSetLocationLocalServer();
+  CHECK(HostWebServerPort() != 0);
+  CheckPage(kLocationDetailsHtmlGz, sizeof(kLocationDetailsHtmlGz), "location_details.html");
+  const char* keys[2] = { "html_zip_pin", "html_country_code" };
+  const String* values[2] = { &temp_zip_pin_str, &temp_country_code_str };
+  CheckValues("{\"html_zip_pin\":\"92101\",\"html_country_code\":\"U\\\"S\"}", keys, values);
+  CHECK_EQ(SimHttpRequest("GET", "/get?html_country_code=%5C%01").code, 200);
+  CheckValues("{\"html_zip_pin\":\"92101\",\"html_country_code\":\"\\\\\\u0001\"}", keys, values);
+}
+
+// pages as served before web_pages.h: template in flash, %placeholder% replaced by its value on each
+// request, uncompressed
+static const char kWiFiDetailsTemplate[] = R"rawliteral(
+<!DOCTYPE HTML><html><head>
+  <title>Long Press Alarm Clock</title>
+  <meta name="viewport" content="width=device-width, initial-scale=1">
+  <script>
+    function submitMessage() {
+      alert("Sent! Press 'Save' on device to set!");
+      setTimeout(function(){ document.location.reload(false); }, 500);   
+    }
+  </script></head><body>
+  <form action="/get" target="hidden-form">
+  	<a href="https://github.com/pk17r/Long_Press_Alarm_Clock/tree/release" target="_blank"><h3>Long Press Alarm Clock</h3></a>
+    <h4>Enter WiFi Details:</h4>
+    <label>WiFi SSID (2.4GHz):</label><br>
+    <input type="text" name="html_ssid" value="%html_ssid%"><br><br>
+    <label>WiFi Password:</label><br>
+    <input type="text" name="html_passwd" value="%html_passwd%"><br><br>
+    <input type="submit" value="Submit" onclick="submitMessage()">
+  </form>
+  <iframe style="display:none" name="hidden-form"></iframe>
+</body></html>)rawliteral";
+
+static const char kLocationDetailsTemplate[] = R"rawliteral(
+<!DOCTYPE HTML><html><head>
+  <title>Long Press Alarm Clock</title>
+  <meta name="viewport" content="width=device-width, initial-scale=1">
+  <script>
+    function submitMessage() {
+      alert("Sent! Press 'Save' on device to set!");
+      setTimeout(function(){ document.location.reload(false); }, 500);   
+    }
+  </script></head><body>
+  <form action="/get" target="hidden-form">
+  	<a href="https://github.com/pk17r/Long_Press_Alarm_Clock/tree/release" target="_blank"><h3>Long Press Alarm Clock</h3></a>
+    <h4>Enter Location Details:</h4>
+    <label>Location ZIP/PIN Code:</label><br>
+    <input type="number" name="html_zip_pin" value="%html_zip_pin%" min="10000" max="999999"><br><br>
+    <label>2-Letter Country Code (</label>
+    <a href="https://en.wikipedia.org/wiki/List_of_ISO_3166_country_codes#Current_ISO_3166_country_codes" target="_blank">List</a>
+    <label>):</label><br>
+    <input type="text" name="html_country_code" value="%html_country_code%" oninput="this.value = this.value.toUpperCase()"><br><br>
+    <input type="submit" value="Submit" onclick="submitMessage()">
+  </form>
+  <iframe style="display:none" name="hidden-form"></iframe>
+</body></html>)rawliteral";
+
+static String RenderTemplate(const char* page) {
+  String html = page;
+  const std::pair<const char*, const String*> kPlaceholders[] = {
+    { "%html_ssid%", &temp_ssid_str }, { "%html_passwd%", &temp_passwd_str },
+    { "%html_zip_pin%", &temp_zip_pin_str }, { "%html_country_code%", &temp_country_code_str } };
+  for (auto &placeholder : kPlaceholders) {
+    size_t at = html.find(placeholder.first);
+    if(at != std::string::npos)
+      html.replace(at, strlen(placeholder.first), *placeholder.second);
+  }
+  return html;
+}
+
+// tools/web_pages.py bench on path of the running server, served while it runs, its output line
+static std::string Bench(const std::string &path, int count) {
+  std::string command = "python3 ../tools/web_pages.py bench http://127.0.0.1:" + std::to_string(HostWebServerPort()) +
+      path + " " + std::to_string(count);
+  std::string output;
+  std::atomic<bool> done(false);
+  std::thread client([&]() {
+    FILE* pipe = popen(command.c_str(), "r");
+    if(pipe != NULL) {
+      char buffer[256];
+      while(fgets(buffer, sizeof(buffer), pipe) != NULL)
+        output += buffer;
+      pclose(pipe);
+    }
+    done = true;
+  });
+  while(!done)
+    if(!HostPollWebServers()) usleep(50);
+  client.join();
+  printf("%s", output.c_str());
+  return output;
+}
+
+static int BenchBytes(const std::string &output) {
+  size_t at = output.find(": ");
+  return (at == std::string::npos ? -1 : atoi(output.c_str() + at + 2));
+}
+
+static void BenchPages() {
+  const int kRequests = 50;
+  wifi_stuff->wifi_ssid_ = "Home Network";
+  wifi_stuff->wifi_password_ = "password1234";
+  wifi_stuff->StartSetWiFiSoftAP();
+  server->on("/before", HTTP_GET, [](AsyncWebServerRequest *request){
+    request->send(200, "text/html", RenderTemplate(kWiFiDetailsTemplate));
+  });
+  int before = BenchBytes(Bench("/before", kRequests));
+  int after = BenchBytes(Bench("/", kRequests));
+  int values = BenchBytes(Bench("/values", kRequests));
+  CHECK_EQ(before, RenderTemplate(kWiFiDetailsTemplate).size());
+  CHECK_EQ(after, sizeof(kWiFiDetailsHtmlGz));
+  CHECK(after + values < before);
+
+  wifi_stuff->StartSetLocationLocalServer();
+  server->on("/before", HTTP_GET, [](AsyncWebServerRequest *request){
+    request->send(200, "text/html", RenderTemplate(kLocationDetailsTemplate));
+  });
+  before = BenchBytes(Bench("/before", kRequests));
+  after = BenchBytes(Bench("/", kRequests));
+  values = BenchBytes(Bench("/values", kRequests));
+  CHECK_EQ(before, RenderTemplate(kLocationDetailsTemplate).size());
+  CHECK_EQ(after, sizeof(kLocationDetailsHtmlGz));
+  CHECK(after + values < before);
+}
+
+int main() {
+  TestPagesMatchSources();
+
+  HostDs3231Set(0, 0, 6, 2, 3, 6, 24);
+  HostSetPin(BUTTON_PIN, HIGH);
+  HostSetPin(INC_BUTTON_PIN, HIGH);
+  HostSetPin(DEC_BUTTON_PIN, HIGH);
+  setup();
+  HostTakeSerialOutput();
+
+  TestSoftApPage();
+  TestLocationPage();
+  BenchPages();
+  HostTakeSerialOutput();
+  return CHECK_RESULT();
+}
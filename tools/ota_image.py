@@ -0,0 +1,258 @@
+#!/usr/bin/env python3
+"""Make compressed and delta OTA images for OtaImageDecoder (ota_image.h).
+
+  ota_image.py compress <firmware.bin> <out.lpoi>
+  ota_image.py delta <base_firmware.bin> <firmware.bin> <out.lpoi>
+  ota_image.py decode <image.lpoi> <out.bin> [base_firmware.bin]
+  ota_image.py manifest <firmware.bin> <out.manifest>
+
+Compressed images are served as build/<board>/long_press_alarm_clock.ino.bin.lpoi,
+deltas as build/<board>/delta_from_<running firmware version>.lpoi.
+decode is a reference decoder, use it to check an image before pushing it.
+The manifest holds SHA-256 of every chunk of the raw binary, for resumable download with
+HTTP Range requests, and is served as build/<board>/long_press_alarm_clock.ino.bin.manifest.
+"""
+
+import hashlib
+import struct
+import sys
+
+MAGIC = b"LPOI"
+FORMAT_VERSION = 1
+FLAG_HEATSHRINK = 0x01
+FLAG_DELTA = 0x02
+WINDOW_SZ2 = 10
+LOOKAHEAD_SZ2 = 5
+HEADER = struct.Struct("<4sBBBBII32s32s")
+
+MANIFEST_MAGIC = b"LPOM"
+MANIFEST_HEADER = struct.Struct("<4sBBHI32s")
+MANIFEST_CHUNK_SZ2 = 15     # 32 kB chunks
+
+DELTA_COPY = 0x01
+DELTA_LITERAL = 0x02
+DELTA_BLOCK = 16          # base index granularity
+DELTA_MIN_COPY = 24       # shorter matches are sent as literals
+
+
+class BitWriter:
+    def __init__(self):
+        self.out = bytearray()
+        self.byte = 0
+        self.bits = 0
+
+    def put(self, value, count):
+        for bit in range(count - 1, -1, -1):
+            self.byte = (self.byte << 1) | ((value >> bit) & 1)
+            self.bits += 1
+            if self.bits == 8:
+                self.out.append(self.byte)
+                self.byte = 0
+                self.bits = 0
+
+    def finish(self):
+        if self.bits:
+            self.out.append(self.byte << (8 - self.bits))
+        return bytes(self.out)
+
+
+def heatshrink_compress(data, window_sz2=WINDOW_SZ2, lookahead_sz2=LOOKAHEAD_SZ2):
+    """Greedy LZSS in heatshrink bit format, matches are found through 3 byte hash chains."""
+    window = 1 << window_sz2
+    max_count = 1 << lookahead_sz2
+    writer = BitWriter()
+    chains = {}
+    i = 0
+    n = len(data)
+
+    def insert(pos):
+        if pos + 3 <= n:
+            chains.setdefault(data[pos:pos + 3], []).append(pos)
+
+    while i < n:
+        best_length, best_distance = 0, 0
+        for candidate in reversed(chains.get(data[i:i + 3], [])[-64:]):
+            distance = i - candidate
+            if distance > window:
+                break
+            length = 0
+            while length < max_count and i + length < n and data[candidate + length] == data[i + length]:
+                length += 1
+            if length > best_length:
+                best_length, best_distance = length, distance
+                if length == max_count:
+                    break
+        if best_length >= 2:
+            writer.put(0, 1)
+            writer.put(best_distance - 1, window_sz2)
+            writer.put(best_length - 1, lookahead_sz2)
+            for pos in range(i, i + best_length):
+                insert(pos)
+            i += best_length
+        else:
+            writer.put(1, 1)
+            writer.put(data[i], 8)
+            insert(i)
+            i += 1
+    return writer.finish()
+
+
+def heatshrink_decompress(data, window_sz2, lookahead_sz2):
+    out = bytearray()
+    bits = "".join(format(byte, "08b") for byte in data)
+    pos = 0
+    while True:
+        if pos + 1 > len(bits):
+            break
+        if bits[pos] == "1":
+            if pos + 9 > len(bits):
+                break
+            out.append(int(bits[pos + 1:pos + 9], 2))
+            pos += 9
+        else:
+            if pos + 1 + window_sz2 + lookahead_sz2 > len(bits):
+                break
+            index = int(bits[pos + 1:pos + 1 + window_sz2], 2) + 1
+            count = int(bits[pos + 1 + window_sz2:pos + 1 + window_sz2 + lookahead_sz2], 2) + 1
+            for _ in range(count):
+                out.append(out[-index])
+            pos += 1 + window_sz2 + lookahead_sz2
+    return bytes(out)
+
+
+def make_delta(base, target):
+    """Copy-from-base and literal commands, matches are found on a block index of base."""
+    index = {}
+    for pos in range(0, len(base) - DELTA_BLOCK + 1, DELTA_BLOCK):
+        index.setdefault(base[pos:pos + DELTA_BLOCK], pos)
+    commands = bytearray()
+    literal = bytearray()
+
+    def flush_literal():
+        if literal:
+            commands.extend(struct.pack("<BI", DELTA_LITERAL, len(literal)))
+            commands.extend(literal)
+            literal.clear()
+
+    i = 0
+    n = len(target)
+    while i < n:
+        offset = index.get(target[i:i + DELTA_BLOCK])
+        if offset is not None:
+            # extend match back into pending literal and forward past the block
+            back = 0
+            while back < len(literal) and back < offset and base[offset - back - 1] == target[i - back - 1]:
+                back += 1
+            length = DELTA_BLOCK
+            while i + length < n and offset + length < len(base) and base[offset + length] == target[i + length]:
+                length += 1
+            if back + length >= DELTA_MIN_COPY:
+                if back:
+                    del literal[-back:]
+                flush_literal()
+                commands.extend(struct.pack("<BII", DELTA_COPY, offset - back, back + length))
+                i += length
+                continue
+        literal.append(target[i])
+        i += 1
+    flush_literal()
+    return bytes(commands)
+
+
+def apply_delta(base, commands):
+    out = bytearray()
+    pos = 0
+    while pos < len(commands):
+        command = commands[pos]
+        if command == DELTA_COPY:
+            offset, length = struct.unpack_from("<II", commands, pos + 1)
+            out.extend(base[offset:offset + length])
+            pos += 9
+        elif command == DELTA_LITERAL:
+            (length,) = struct.unpack_from("<I", commands, pos + 1)
+            out.extend(commands[pos + 5:pos + 5 + length])
+            pos += 5 + length
+        else:
+            raise ValueError("bad delta command at %d" % pos)
+    return bytes(out)
+
+
+def make_image(firmware, base=None):
+    flags = FLAG_HEATSHRINK
+    payload = firmware
+    base_sha256 = bytes(32)
+    base_size = 0
+    if base is not None:
+        flags |= FLAG_DELTA
+        payload = make_delta(base, firmware)
+        base_size = len(base)
+        base_sha256 = hashlib.sha256(base).digest()
+    payload = heatshrink_compress(payload)
+    header = HEADER.pack(MAGIC, FORMAT_VERSION, flags, WINDOW_SZ2, LOOKAHEAD_SZ2, len(firmware), base_size,
+                         hashlib.sha256(firmware).digest(), base_sha256)
+    return header + payload
+
+
+def decode_image(image, base=None):
+    magic, version, flags, window_sz2, lookahead_sz2, image_size, base_size, image_sha256, base_sha256 = HEADER.unpack_from(image)
+    if magic != MAGIC or version != FORMAT_VERSION:
+        raise ValueError("not an OTA image")
+    payload = image[HEADER.size:]
+    if flags & FLAG_HEATSHRINK:
+        payload = heatshrink_decompress(payload, window_sz2, lookahead_sz2)
+    if flags & FLAG_DELTA:
+        if base is None or hashlib.sha256(base[:base_size]).digest() != base_sha256:
+            raise ValueError("delta base mismatch")
+        payload = apply_delta(base[:base_size], payload)
+    payload = payload[:image_size]
+    if hashlib.sha256(payload).digest() != image_sha256:
+        raise ValueError("firmware hash mismatch")
+    return payload
+
+
+def make_manifest(firmware, chunk_sz2=MANIFEST_CHUNK_SZ2):
+    chunk_size = 1 << chunk_sz2
+    manifest = bytearray(MANIFEST_HEADER.pack(MANIFEST_MAGIC, FORMAT_VERSION, chunk_sz2, 0, len(firmware),
+                                              hashlib.sha256(firmware).digest()))
+    for pos in range(0, len(firmware), chunk_size):
+        manifest.extend(hashlib.sha256(firmware[pos:pos + chunk_size]).digest())
+    return bytes(manifest)
+
+
+def main(argv):
+    def read(path):
+        with open(path, "rb") as f:
+            return f.read()
+
+    if len(argv) == 4 and argv[1] == "compress":
+        firmware = read(argv[2])
+        image = make_image(firmware)
+    elif len(argv) == 5 and argv[1] == "delta":
+        base, firmware = read(argv[2]), read(argv[3])
+        image = make_image(firmware, base)
+    elif len(argv) == 4 and argv[1] == "manifest":
+        firmware = read(argv[2])
+        manifest = make_manifest(firmware)
+        with open(argv[3], "wb") as f:
+            f.write(manifest)
+        print("%s: %d chunks" % (argv[3], (len(manifest) - MANIFEST_HEADER.size) // 32))
+        return 0
+    elif len(argv) in (4, 5) and argv[1] == "decode":
+        firmware = decode_image(read(argv[2]), read(argv[4]) if len(argv) == 5 else None)
+        with open(argv[3], "wb") as f:
+            f.write(firmware)
+        print("%s: %d bytes, hash ok" % (argv[3], len(firmware)))
+        return 0
+    else:
+        print(__doc__)
+        return 1
+
+    decode_image(image, base if argv[1] == "delta" else None)
+    with open(argv[-1], "wb") as f:
+        f.write(image)
+    print("%s: %d -> %d bytes (%.1f%%)" % (argv[-1], len(firmware), len(image), 100.0 * len(image) / len(firmware)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
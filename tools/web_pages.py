@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+"""Gzip the SoftAP and location server web pages into web_pages.h.
+
+  web_pages.py build              tools/web_pages/*.html -> web_pages.h
+  web_pages.py bench <url> [n]    fetch a page n times (default 20), bytes on wire and response time
+
+Pages are static, current values are fetched by the page from /values, so the clock sends
+the gzip bytes from flash as they are with Content-Encoding: gzip and no template processing.
+Run build after editing a page and commit web_pages.h with it.
+"""
+
+import gzip
+import os
+import sys
+import time
+import urllib.request
+
+TOOLS_DIR = os.path.dirname(os.path.abspath(__file__))
+PAGES_DIR = os.path.join(TOOLS_DIR, "web_pages")
+HEADER_PATH = os.path.join(TOOLS_DIR, "..", "web_pages.h")
+
+# page file -> array name
+PAGES = [
+    ("wifi_details.html", "kWiFiDetailsHtmlGz"),
+    ("location_details.html", "kLocationDetailsHtmlGz"),
+    ("framebuffer_viewer.html", "kFramebufferViewerHtmlGz"),
+]
+
+
+def build():
+    lines = [
+        "#ifndef WEB_PAGES_H",
+        "#define WEB_PAGES_H",
+        "",
+        "// generated by tools/web_pages.py from tools/web_pages/*.html, do not edit",
+        "// gzip compressed pages, served with Content-Encoding: gzip",
+        "",
+        "#include <stdint.h>",
+        "#include <pgmspace.h>",
+        "",
+    ]
+    for page, name in PAGES:
+        with open(os.path.join(PAGES_DIR, page), "rb") as f:
+            html = f.read()
+        # indentation and blank lines carry nothing for the browser
+        html = b"\n".join(line.strip() for line in html.splitlines() if line.strip())
+        # mtime 0 keeps output same for same page
+        data = gzip.compress(html, compresslevel=9, mtime=0)
+        print("%s: %d -> %d bytes (%.1f%%)" % (page, len(html), len(data), 100.0 * len(data) / len(html)))
+        lines.append("// %s, %d bytes uncompressed" % (page, len(html)))
+        lines.append("const uint8_t %s[] PROGMEM = {" % name)
+        for pos in range(0, len(data), 16):
+            lines.append("  " + ", ".join("0x%02x" % b for b in data[pos:pos + 16]) + ",")
+        lines.append("};")
+        lines.append("")
+    lines.append("#endif  // WEB_PAGES_H")
+    with open(HEADER_PATH, "w") as f:
+        f.write("\n".join(lines) + "\n")
+
+
+def bench(url, count):
+    # urllib does not decode gzip, bytes read are bytes on the wire (without headers)
+    request = urllib.request.Request(url, headers={"Accept-Encoding": "gzip"})
+    times_ms = []
+    body_bytes = 0
+    for _ in range(count):
+        start = time.monotonic()
+        with urllib.request.urlopen(request, timeout=10) as response:
+            body_bytes = len(response.read())
+            encoding = response.headers.get("Content-Encoding", "identity")
+        times_ms.append((time.monotonic() - start) * 1000)
+    times_ms.sort()
+    print("%s: %d bytes %s, %d requests, median %.2f ms, max %.2f ms" %
+          (url, body_bytes, encoding, count, times_ms[len(times_ms) // 2], times_ms[-1]))
+
+
+def main(argv):
+    if len(argv) == 2 and argv[1] == "build":
+        build()
+    elif len(argv) in (3, 4) and argv[1] == "bench":
+        bench(argv[2], int(argv[3]) if len(argv) == 4 else 20)
+    else:
+        print(__doc__)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
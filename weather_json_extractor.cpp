@@ -0,0 +1,225 @@
+#include "weather_json_extractor.h"
+
+void WeatherJsonExtractor::Reset() {
+  weather_main[0] = '\0';
+  weather_description[0] = '\0';
+  name[0] = '\0';
+  for (uint8_t i = 0; i < kFieldsCount; i++)
+    number_values[i] = 0;
+  found_fields = 0;
+  depth_ = 0;
+  state_ = kExpectValue;
+  escape_ = false;
+  done_ = false;
+  failed_ = false;
+  token_length_ = 0;
+}
+
+bool WeatherJsonExtractor::Feed(const uint8_t* data, size_t length) {
+  for (size_t i = 0; i < length && !done_; i++)
+    if(!Feed((char)data[i]))
+      return false;
+  return true;
+}
+
+bool WeatherJsonExtractor::Feed(char c) {
+  if(failed_) return false;
+  if(done_) return true;
+
+  switch(state_) {
+    case kInKeyString:
+    case kInValueString:
+      if(escape_) {
+        escape_ = false;
+        // keep escaped character as is, \uXXXX digits are copied as text
+        if(c == 'n' || c == 't' || c == 'r') c = ' ';
+      }
+      else if(c == '\\') {
+        escape_ = true;
+        return true;
+      }
+      else if(c == '"') {
+        if(state_ == kInKeyString) {
+          token_[token_length_] = '\0';
+          stack_[depth_ - 1].key = LookupKey(token_);
+          state_ = kExpectColon;
+        }
+        else {
+          if(string_out_ != NULL) {
+            string_out_[min(token_length_, (uint8_t)(string_out_size_ - 1))] = '\0';
+            found_fields |= (1 << token_field_);
+          }
+          ValueDone();
+        }
+        return true;
+      }
+      if(state_ == kInKeyString) {
+        if(token_length_ < sizeof(token_) - 1)
+          token_[token_length_++] = c;
+      }
+      else if(string_out_ != NULL) {
+        if(token_length_ < string_out_size_ - 1)
+          string_out_[token_length_] = c;
+        if(token_length_ < UINT8_MAX)
+          token_length_++;
+      }
+      return true;
+
+    case kInLiteral:
+      if((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E' || (c >= 'a' && c <= 'z')) {
+        if(token_length_ < sizeof(token_) - 1)
+          token_[token_length_++] = c;
+        else
+          token_field_ = kNoField;    // too long for a wanted number, truncated value would be wrong
+        return true;
+      }
+      // literal ended by this character
+      token_[token_length_] = '\0';
+      if(token_field_ >= kMainTemp && token_field_ <= kTimezone && ((token_[0] >= '0' && token_[0] <= '9') || token_[0] == '-')) {
+        number_values[token_field_] = strtof(token_, NULL);
+        found_fields |= (1 << token_field_);
+      }
+      ValueDone();
+      return Feed(c);
+
+    default:
+      break;
+  }
+
+  // structural characters
+  if(c == ' ' || c == '\n' || c == '\r' || c == '\t')
+    return true;
+
+  switch(state_) {
+    case kExpectValue:
+      if(c == '{')
+        return Push(/*is_array = */ false);
+      if(c == '[')
+        return Push(/*is_array = */ true);
+      if(c == ']' && depth_ > 0 && stack_[depth_ - 1].is_array)
+        return Pop(/*is_array = */ true);
+      token_field_ = CurrentField();
+      token_length_ = 0;
+      if(c == '"') {
+        string_out_ = NULL;
+        if(token_field_ == kWeatherMain) { string_out_ = weather_main; string_out_size_ = sizeof(weather_main); }
+        else if(token_field_ == kWeatherDescription) { string_out_ = weather_description; string_out_size_ = sizeof(weather_description); }
+        else if(token_field_ == kName) { string_out_ = name; string_out_size_ = sizeof(name); }
+        state_ = kInValueString;
+        return true;
+      }
+      if((c >= '0' && c <= '9') || c == '-' || c == 't' || c == 'f' || c == 'n') {
+        token_[token_length_++] = c;
+        state_ = kInLiteral;
+        return true;
+      }
+      return Fail();
+
+    case kExpectKey:
+      if(c == '"') {
+        token_length_ = 0;
+        state_ = kInKeyString;
+        return true;
+      }
+      if(c == '}')
+        return Pop(/*is_array = */ false);
+      return Fail();
+
+    case kExpectColon:
+      if(c != ':') return Fail();
+      state_ = kExpectValue;
+      return true;
+
+    case kExpectCommaOrEnd:
+      if(c == ',') {
+        Level &level = stack_[depth_ - 1];
+        if(level.is_array) {
+          if(level.index < UINT8_MAX) level.index++;
+          state_ = kExpectValue;
+        }
+        else
+          state_ = kExpectKey;
+        return true;
+      }
+      if(c == '}' || c == ']')
+        return Pop(/*is_array = */ (c == ']'));
+      return Fail();
+
+    default:
+      return Fail();
+  }
+}
+
+bool WeatherJsonExtractor::Fail() {
+  failed_ = true;
+  return false;
+}
+
+bool WeatherJsonExtractor::Push(bool is_array) {
+  if(depth_ >= kMaxDepth) return Fail();
+  stack_[depth_++] = { is_array, kKeyOther, 0 };
+  state_ = (is_array ? kExpectValue : kExpectKey);
+  return true;
+}
+
+bool WeatherJsonExtractor::Pop(bool is_array) {
+  if(depth_ == 0 || stack_[depth_ - 1].is_array != is_array) return Fail();
+  depth_--;
+  ValueDone();
+  return true;
+}
+
+void WeatherJsonExtractor::ValueDone() {
+  if(depth_ == 0)
+    done_ = true;
+  else
+    state_ = kExpectCommaOrEnd;
+}
+
+// wanted field at current path
+WeatherJsonExtractor::Field WeatherJsonExtractor::CurrentField() {
+  if(depth_ == 0 || stack_[0].is_array) return kNoField;
+  Key key0 = stack_[0].key;
+  if(depth_ == 1) {
+    if(key0 == kKeyTimezone) return kTimezone;
+    if(key0 == kKeyName) return kName;
+  }
+  else if(depth_ == 2 && !stack_[1].is_array) {
+    Key key1 = stack_[1].key;
+    if(key0 == kKeyMain) {
+      if(key1 == kKeyTemp) return kMainTemp;
+      if(key1 == kKeyFeelsLike) return kMainFeelsLike;
+      if(key1 == kKeyTempMin) return kMainTempMin;
+      if(key1 == kKeyTempMax) return kMainTempMax;
+      if(key1 == kKeyHumidity) return kMainHumidity;
+    }
+    else if(key0 == kKeyWind && key1 == kKeySpeed)
+      return kWindSpeed;
+  }
+  else if(depth_ == 3 && key0 == kKeyWeather && stack_[1].is_array && stack_[1].index == 0 && !stack_[2].is_array) {
+    if(stack_[2].key == kKeyMain) return kWeatherMain;
+    if(stack_[2].key == kKeyDescription) return kWeatherDescription;
+  }
+  return kNoField;
+}
+
+WeatherJsonExtractor::Key WeatherJsonExtractor::LookupKey(const char* key) {
+  static const struct { const char* str; Key key; } kKeys[] = {
+    { "weather", kKeyWeather },
+    { "main", kKeyMain },
+    { "description", kKeyDescription },
+    { "temp", kKeyTemp },
+    { "feels_like", kKeyFeelsLike },
+    { "temp_min", kKeyTempMin },
+    { "temp_max", kKeyTempMax },
+    { "humidity", kKeyHumidity },
+    { "wind", kKeyWind },
+    { "speed", kKeySpeed },
+    { "timezone", kKeyTimezone },
+    { "name", kKeyName },
+  };
+  for (uint8_t i = 0; i < sizeof(kKeys) / sizeof(kKeys[0]); i++)
+    if(strcmp(key, kKeys[i].str) == 0)
+      return kKeys[i].key;
+  return kKeyOther;
+}
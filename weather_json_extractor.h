@@ -0,0 +1,107 @@
+#ifndef WEATHER_JSON_EXTRACTOR_H
+#define WEATHER_JSON_EXTRACTOR_H
+
+#include "common.h"
+
+// Streaming OpenWeatherMap current weather JSON extractor.
+// Bytes are fed as they arrive from the HTTP stream, a small tokenizer keeps only the
+// current key path on a fixed depth stack and copies the few wanted values into fixed
+// buffers. No heap allocation and no copy of the payload is made.
+// Wanted paths: weather[0].main, weather[0].description, main.temp, main.feels_like,
+// main.temp_min, main.temp_max, main.humidity, wind.speed, timezone, name
+class WeatherJsonExtractor {
+
+public:
+
+  enum Field : uint8_t {
+    kWeatherMain = 0,
+    kWeatherDescription,
+    kMainTemp,
+    kMainFeelsLike,
+    kMainTempMin,
+    kMainTempMax,
+    kMainHumidity,
+    kWindSpeed,
+    kTimezone,
+    kName,
+    kFieldsCount,
+    kNoField = kFieldsCount,
+  };
+
+  static const uint16_t kAllFieldsFound = (1 << kFieldsCount) - 1;
+
+  // extracted values
+  char weather_main[16];
+  char weather_description[32];
+  char name[32];
+  float number_values[kFieldsCount];    // indexed by Field, for numeric fields
+  uint16_t found_fields;                // bit per Field
+
+  void Reset();
+  // returns false once input is malformed, extra input after root object is ignored
+  bool Feed(const uint8_t* data, size_t length);
+  bool Feed(char c);
+  // root object closed
+  bool Done() { return done_; }
+  bool Failed() { return failed_; }
+
+private:
+
+  // keys on wanted paths
+  enum Key : uint8_t {
+    kKeyOther = 0,
+    kKeyWeather,
+    kKeyMain,
+    kKeyDescription,
+    kKeyTemp,
+    kKeyFeelsLike,
+    kKeyTempMin,
+    kKeyTempMax,
+    kKeyHumidity,
+    kKeyWind,
+    kKeySpeed,
+    kKeyTimezone,
+    kKeyName,
+  };
+
+  enum State : uint8_t {
+    kExpectValue = 0,       // value, or end of array
+    kExpectKey,             // key string, or end of object
+    kExpectColon,
+    kExpectCommaOrEnd,
+    kInKeyString,
+    kInValueString,
+    kInLiteral,             // number, true, false, null
+  };
+
+  struct Level {
+    bool is_array;
+    Key key;            // objects: key of current member
+    uint8_t index;      // arrays: index of current element (saturates)
+  };
+  static const uint8_t kMaxDepth = 6;
+  Level stack_[kMaxDepth];
+  uint8_t depth_ = 0;
+
+  State state_ = kExpectValue;
+  bool escape_ = false;
+  bool done_ = false;
+  bool failed_ = false;
+
+  // current token, longer tokens are truncated
+  char token_[24];
+  uint8_t token_length_ = 0;
+  Field token_field_ = kNoField;
+  char* string_out_ = NULL;
+  uint8_t string_out_size_ = 0;
+
+  bool Fail();
+  bool Push(bool is_array);
+  bool Pop(bool is_array);
+  void ValueDone();
+  Field CurrentField();
+  static Key LookupKey(const char* key);
+
+};
+
+#endif  // WEATHER_JSON_EXTRACTOR_H
@@ -0,0 +1,181 @@
+#ifndef WEB_PAGES_H
+#define WEB_PAGES_H
+
+// generated by tools/web_pages.py from tools/web_pages/*.html, do not edit
+// gzip compressed pages, served with Content-Encoding: gzip
+
+#include <stdint.h>
+#include <pgmspace.h>
+
+// wifi_details.html, 1131 bytes uncompressed
+const uint8_t kWiFiDetailsHtmlGz[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x95, 0x54, 0x5d, 0x4f, 0xdb, 0x30,
+  0x14, 0x7d, 0xef, 0xaf, 0xb8, 0xf8, 0x85, 0x44, 0x82, 0x1a, 0x36, 0xa6, 0x49, 0x90, 0x54, 0xda,
+  0x80, 0x7d, 0x48, 0xb0, 0x55, 0x2a, 0xda, 0x34, 0xa1, 0xa9, 0x72, 0x93, 0x5b, 0xe2, 0xd5, 0xb1,
+  0x23, 0xfb, 0x26, 0xac, 0x43, 0xfd, 0xef, 0xbb, 0x4e, 0x0a, 0x54, 0xd3, 0xf6, 0xb0, 0x97, 0xa6,
+  0xce, 0x3d, 0xf7, 0x9c, 0x63, 0xdf, 0xe3, 0x64, 0x7b, 0x17, 0x9f, 0xcf, 0x6f, 0xbe, 0x4d, 0x2f,
+  0xe1, 0xc3, 0xcd, 0xf5, 0xd5, 0x24, 0xab, 0xa8, 0x36, 0xfc, 0x8b, 0xaa, 0x9c, 0x8c, 0x32, 0xd2,
+  0x64, 0x70, 0x72, 0xe5, 0xec, 0x1d, 0x4c, 0x3d, 0x86, 0x00, 0x6f, 0x8c, 0xf2, 0x35, 0x9c, 0x1b,
+  0x57, 0xac, 0x32, 0x39, 0x54, 0x47, 0x59, 0x8d, 0xa4, 0xc0, 0xaa, 0x1a, 0x73, 0xd1, 0x69, 0xbc,
+  0x6f, 0x9c, 0x27, 0x01, 0x85, 0xb3, 0x84, 0x96, 0x72, 0x71, 0xaf, 0x4b, 0xaa, 0xf2, 0x12, 0x3b,
+  0x5d, 0xe0, 0x61, 0xbf, 0x38, 0x00, 0x6d, 0x35, 0x69, 0x65, 0x0e, 0x43, 0xa1, 0x0c, 0xe6, 0xc7,
+  0x82, 0x49, 0x42, 0xe1, 0x75, 0x43, 0x93, 0xd1, 0xb2, 0xb5, 0x05, 0x69, 0x67, 0x21, 0xb4, 0x8b,
+  0x5a, 0xd3, 0x35, 0xab, 0xaa, 0x3b, 0x4c, 0x52, 0x78, 0x18, 0x31, 0xd6, 0x53, 0x22, 0x66, 0x4c,
+  0xbb, 0xb7, 0xf5, 0xb3, 0x3f, 0x53, 0x1d, 0xee, 0x03, 0xc3, 0x07, 0x01, 0x20, 0x07, 0x01, 0x69,
+  0x4f, 0xa4, 0x67, 0x23, 0x7e, 0xde, 0xe8, 0x1a, 0x5d, 0x4b, 0xc9, 0x23, 0x69, 0x92, 0x3e, 0x80,
+  0x71, 0xaa, 0xfc, 0xa2, 0x4c, 0x8b, 0x21, 0x49, 0xcf, 0x60, 0x73, 0x00, 0xaf, 0x8e, 0x8e, 0x18,
+  0xbd, 0x19, 0x49, 0x09, 0x45, 0xeb, 0x3d, 0xb3, 0x43, 0xd7, 0xd7, 0x79, 0x0f, 0x35, 0xc2, 0xd2,
+  0xbb, 0x1a, 0xe4, 0xf0, 0xe6, 0x00, 0x1a, 0x36, 0x03, 0x9a, 0x02, 0x9a, 0x25, 0xe8, 0x00, 0x81,
+  0x14, 0xe9, 0xe2, 0xd9, 0xf4, 0x2e, 0x39, 0x3b, 0x5e, 0x22, 0x15, 0x55, 0x22, 0xb6, 0xdd, 0x22,
+  0x1d, 0x53, 0x85, 0xf6, 0xd9, 0x8d, 0x67, 0x3b, 0x1e, 0xa9, 0xf5, 0x16, 0xfc, 0xf8, 0x47, 0x88,
+  0xfe, 0xd8, 0xd1, 0x9f, 0xa8, 0x2e, 0x65, 0x22, 0xe7, 0x21, 0xe9, 0x94, 0x87, 0x15, 0xae, 0xf9,
+  0xf4, 0xa0, 0x63, 0x76, 0x88, 0x6b, 0x6d, 0x9b, 0x96, 0x20, 0x87, 0xd2, 0x15, 0x6d, 0xcd, 0xd6,
+  0xc7, 0x77, 0x48, 0x97, 0x06, 0xe3, 0xdf, 0xf0, 0x76, 0xfd, 0x89, 0x87, 0x92, 0x70, 0x4b, 0x7a,
+  0x7b, 0xf4, 0xfd, 0x0c, 0xf4, 0x12, 0x92, 0x1e, 0x9f, 0x0e, 0x6d, 0xe3, 0xde, 0x16, 0x37, 0x77,
+  0xb7, 0x8c, 0x61, 0xc0, 0x66, 0xb4, 0xe9, 0x4f, 0x22, 0x93, 0xdb, 0x69, 0x64, 0xb2, 0x0f, 0x42,
+  0xb6, 0x70, 0xe5, 0x9a, 0x0f, 0x39, 0xee, 0x2e, 0x17, 0xbb, 0x7b, 0x8c, 0x93, 0x63, 0x6f, 0x35,
+  0xa8, 0xde, 0x6b, 0x2e, 0x24, 0xeb, 0x0b, 0x20, 0xe5, 0xf9, 0x99, 0x8b, 0x4a, 0x97, 0x25, 0xda,
+  0xc3, 0x88, 0x88, 0x48, 0x05, 0x95, 0xc7, 0x25, 0xbf, 0x26, 0x6a, 0xc2, 0xa9, 0x94, 0x77, 0x9a,
+  0xaa, 0x76, 0x31, 0xe6, 0x63, 0x96, 0xcd, 0xea, 0xf8, 0xb5, 0x97, 0x31, 0x69, 0xf3, 0x7e, 0xb2,
+  0xf3, 0x3e, 0x69, 0xf3, 0x3e, 0x69, 0x92, 0x3c, 0xa2, 0xf4, 0x68, 0x50, 0x05, 0x7c, 0x26, 0x9f,
+  0x2f, 0x8c, 0xb2, 0x2b, 0xc1, 0x61, 0x7d, 0xf9, 0xcf, 0x88, 0x72, 0x29, 0x93, 0x8a, 0xa5, 0xab,
+  0x93, 0xc9, 0x25, 0x07, 0xd2, 0xc3, 0x57, 0xfd, 0x4e, 0xc3, 0x05, 0x27, 0x56, 0x9b, 0x70, 0xca,
+  0x80, 0x13, 0x2e, 0x1a, 0xb5, 0x40, 0x33, 0xe9, 0x2b, 0xb3, 0xd9, 0xc7, 0x0b, 0x48, 0x5e, 0x8c,
+  0x4f, 0xde, 0x7f, 0xf8, 0x95, 0x72, 0x7d, 0x28, 0x65, 0x0b, 0xcf, 0xb0, 0xe1, 0xac, 0x69, 0xdd,
+  0x70, 0xd0, 0x09, 0x7f, 0xf2, 0x3e, 0x87, 0xd0, 0xc7, 0x2b, 0x33, 0x0f, 0x41, 0x97, 0x02, 0x1a,
+  0xa3, 0x0a, 0xac, 0x9c, 0x29, 0xd1, 0xe7, 0x62, 0x10, 0x8c, 0x8c, 0xa2, 0x67, 0x18, 0x58, 0x76,
+  0xc4, 0xa6, 0x2a, 0x84, 0x7b, 0xe7, 0xcb, 0xff, 0xd1, 0x69, 0x62, 0xcf, 0xdf, 0x95, 0xa6, 0x43,
+  0x69, 0x47, 0x6b, 0x97, 0x69, 0xb8, 0x4f, 0x62, 0xc8, 0x76, 0x2e, 0x66, 0xdb, 0xa5, 0xb3, 0x85,
+  0xd1, 0xc5, 0xea, 0xb1, 0xfe, 0x74, 0xdf, 0xe2, 0xbc, 0x64, 0x1c, 0x5c, 0xa4, 0x59, 0x7a, 0x36,
+  0xc0, 0x61, 0x5f, 0xf3, 0x6d, 0x15, 0xa5, 0x0e, 0x2c, 0xbe, 0x3e, 0xb5, 0xce, 0xe2, 0x93, 0xb5,
+  0xdd, 0x41, 0x67, 0x72, 0x68, 0x88, 0x0c, 0x31, 0x39, 0x31, 0x46, 0xf1, 0xab, 0xf2, 0x1b, 0x3b,
+  0x5e, 0x81, 0xe2, 0x6b, 0x04, 0x00, 0x00,
+};
+
+// location_details.html, 1385 bytes uncompressed
+const uint8_t kLocationDetailsHtmlGz[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x7d, 0x54, 0xd1, 0x6e, 0xdb, 0x38,
+  0x10, 0x7c, 0xf7, 0x57, 0x6c, 0x78, 0x0f, 0x95, 0x80, 0xc4, 0x4c, 0xae, 0x6d, 0x8a, 0x26, 0x92,
+  0x81, 0x3b, 0x37, 0xc0, 0x05, 0x70, 0xda, 0x00, 0x49, 0x0f, 0x68, 0x8b, 0x83, 0x40, 0x4b, 0x6b,
+  0x8b, 0x67, 0x8a, 0x14, 0xc8, 0x95, 0x13, 0x5f, 0x91, 0x7f, 0xef, 0x52, 0x72, 0x62, 0x5f, 0xd3,
+  0x56, 0x0f, 0x96, 0xe8, 0x1d, 0xce, 0x0e, 0x87, 0x43, 0x66, 0x07, 0xef, 0x3e, 0x4c, 0x6f, 0x3f,
+  0x5d, 0x5f, 0xc0, 0x5f, 0xb7, 0x57, 0xb3, 0x49, 0x56, 0x53, 0x63, 0xf8, 0x17, 0x55, 0x35, 0x19,
+  0x65, 0xa4, 0xc9, 0xe0, 0x64, 0xe6, 0xec, 0x12, 0xae, 0x3d, 0x86, 0x00, 0x7f, 0x18, 0xe5, 0x1b,
+  0x98, 0x1a, 0x57, 0xae, 0x32, 0x39, 0x54, 0x47, 0x59, 0x83, 0xa4, 0xc0, 0xaa, 0x06, 0x73, 0xb1,
+  0xd6, 0x78, 0xd7, 0x3a, 0x4f, 0x02, 0x4a, 0x67, 0x09, 0x2d, 0xe5, 0xe2, 0x4e, 0x57, 0x54, 0xe7,
+  0x15, 0xae, 0x75, 0x89, 0x47, 0xfd, 0xe0, 0x10, 0xb4, 0xd5, 0xa4, 0x95, 0x39, 0x0a, 0xa5, 0x32,
+  0x98, 0x9f, 0x08, 0x26, 0x09, 0xa5, 0xd7, 0x2d, 0x4d, 0x46, 0x8b, 0xce, 0x96, 0xa4, 0x9d, 0x85,
+  0xd0, 0xcd, 0x1b, 0x4d, 0x57, 0xdc, 0x55, 0x2d, 0x31, 0x49, 0xe1, 0xeb, 0x88, 0xb1, 0x9e, 0x12,
+  0x71, 0xc3, 0xb4, 0x07, 0x5b, 0x3d, 0x2f, 0x6e, 0xd4, 0x1a, 0x5f, 0x00, 0xc3, 0x87, 0x06, 0x40,
+  0x0e, 0x02, 0xd2, 0x81, 0x48, 0xcf, 0x47, 0xfc, 0xbe, 0xd5, 0x0d, 0xba, 0x8e, 0x92, 0x47, 0xd2,
+  0x24, 0xfd, 0x0a, 0xc6, 0xa9, 0xea, 0x6f, 0x65, 0x3a, 0x0c, 0x49, 0x7a, 0x0e, 0x0f, 0x87, 0xf0,
+  0xfa, 0xf8, 0x98, 0xd1, 0x0f, 0x23, 0x29, 0xa1, 0xec, 0xbc, 0x67, 0x76, 0x58, 0xf7, 0x75, 0x5e,
+  0x43, 0x83, 0xb0, 0xf0, 0xae, 0x01, 0x39, 0xfc, 0x73, 0x08, 0x2d, 0x8b, 0x01, 0x4d, 0x01, 0xcd,
+  0x02, 0x74, 0x80, 0x40, 0x8a, 0x74, 0xb9, 0x13, 0xbd, 0x4f, 0xce, 0x8a, 0x17, 0x48, 0x65, 0x9d,
+  0x88, 0xed, 0x6c, 0x91, 0x8e, 0xa9, 0x46, 0xbb, 0x53, 0xe3, 0x59, 0x8e, 0x47, 0xea, 0xbc, 0x05,
+  0x3f, 0xfe, 0x37, 0x44, 0x7d, 0xac, 0xe8, 0x7b, 0xd4, 0x3a, 0x65, 0x22, 0xe7, 0x21, 0x59, 0x2b,
+  0x0f, 0x2b, 0xdc, 0xb0, 0x7b, 0xb0, 0x66, 0x76, 0x88, 0x63, 0x6d, 0xdb, 0x8e, 0x20, 0x87, 0xca,
+  0x95, 0x5d, 0xc3, 0xd2, 0xc7, 0x4b, 0xa4, 0x0b, 0x83, 0xf1, 0x33, 0xfc, 0xb9, 0x79, 0xcf, 0x9b,
+  0x92, 0xf0, 0x94, 0xf4, 0xcb, 0xf1, 0x3f, 0xe7, 0xa0, 0x17, 0x90, 0xf4, 0xf8, 0x74, 0x98, 0x36,
+  0xee, 0x65, 0xf1, 0xe4, 0xf5, 0x17, 0xc6, 0x30, 0xe0, 0x61, 0xf4, 0xd0, 0x3b, 0x91, 0xc9, 0xed,
+  0x6e, 0x64, 0xb2, 0x0f, 0x42, 0x36, 0x77, 0xd5, 0x86, 0x4d, 0x8e, 0xab, 0xcb, 0xc5, 0xfe, 0x1a,
+  0xe3, 0xce, 0xb1, 0xb6, 0x06, 0x54, 0xaf, 0x35, 0x17, 0x92, 0xfb, 0x0b, 0x20, 0xe5, 0xf9, 0x9d,
+  0x8b, 0x5a, 0x57, 0x15, 0xda, 0xa3, 0x88, 0x88, 0x48, 0x05, 0xb5, 0xc7, 0x05, 0xff, 0x4d, 0xd4,
+  0x86, 0x33, 0x29, 0x97, 0x9a, 0xea, 0x6e, 0x3e, 0x66, 0x9b, 0x65, 0xbb, 0x3a, 0x79, 0xe3, 0x65,
+  0x4c, 0x5a, 0xd1, 0xef, 0x6c, 0xd1, 0x27, 0xad, 0xe8, 0x93, 0x26, 0xc9, 0x23, 0x4a, 0x8f, 0x06,
+  0x55, 0xc0, 0x1d, 0x79, 0x31, 0x37, 0xca, 0xae, 0x04, 0x87, 0xf5, 0xe5, 0x4f, 0x23, 0xca, 0xa5,
+  0x4c, 0x2a, 0x6e, 0x5d, 0xbf, 0x9a, 0x5c, 0x70, 0x20, 0x3d, 0xcc, 0x5c, 0xa9, 0xfa, 0xad, 0x7a,
+  0xc7, 0xa9, 0xd5, 0x26, 0x9c, 0x31, 0xe8, 0x15, 0x03, 0x8c, 0x9a, 0xa3, 0x99, 0x3c, 0x55, 0x3f,
+  0x5f, 0x5e, 0xcb, 0xeb, 0xcb, 0xf7, 0x30, 0x75, 0x15, 0x32, 0x64, 0xa8, 0x66, 0x73, 0xcf, 0xc8,
+  0xc1, 0x72, 0xda, 0xb4, 0x9c, 0x77, 0xdb, 0x35, 0x73, 0xf4, 0x62, 0x9b, 0xfe, 0x78, 0x76, 0x8a,
+  0xff, 0x74, 0x5b, 0xb4, 0xda, 0x0a, 0x68, 0x8d, 0x2a, 0xb1, 0x76, 0xa6, 0x42, 0x9f, 0x8b, 0xa1,
+  0xf9, 0x96, 0x55, 0x40, 0xa3, 0xd9, 0xab, 0x93, 0x63, 0x7e, 0xf8, 0x5b, 0xdd, 0xe7, 0xe2, 0x6d,
+  0xff, 0x88, 0xbe, 0xc5, 0xd0, 0x66, 0x68, 0xf9, 0xfb, 0xd1, 0x0c, 0x29, 0x4e, 0x9d, 0xba, 0xce,
+  0x92, 0xdf, 0xf4, 0x82, 0x20, 0x79, 0x54, 0xf4, 0xdc, 0x53, 0xb4, 0xe3, 0x3b, 0xbd, 0xd2, 0x2d,
+  0x56, 0x5a, 0x8d, 0x9d, 0x5f, 0xca, 0x38, 0x92, 0x33, 0x1d, 0xa8, 0x70, 0x8b, 0xe2, 0xf2, 0xe6,
+  0x43, 0xf1, 0xf2, 0xe4, 0xf4, 0xb4, 0x28, 0x07, 0x3a, 0x7e, 0x57, 0x18, 0x7e, 0x9b, 0x0e, 0xb9,
+  0xff, 0x49, 0xf9, 0xb9, 0xe5, 0x91, 0x6e, 0xf0, 0x75, 0x90, 0x91, 0xfe, 0xc2, 0x22, 0xc2, 0x7b,
+  0xfa, 0x9f, 0x41, 0xfb, 0xdc, 0x3f, 0x74, 0x69, 0x7f, 0xa9, 0x82, 0x63, 0xd7, 0xb3, 0x31, 0x51,
+  0xad, 0xc3, 0x53, 0x64, 0x77, 0x83, 0x31, 0xb9, 0x8f, 0x6d, 0x8b, 0x7e, 0xca, 0xe1, 0x88, 0x81,
+  0xdc, 0x39, 0xb8, 0xaf, 0x62, 0xb8, 0x4d, 0xc4, 0x70, 0xb2, 0x73, 0x71, 0xb3, 0x1d, 0x3a, 0x5b,
+  0x1a, 0x5d, 0xae, 0x1e, 0xeb, 0x4f, 0xb7, 0x4d, 0x4c, 0xab, 0x8c, 0xb1, 0x8d, 0x34, 0x0b, 0xcf,
+  0xe2, 0xf9, 0xa8, 0x6f, 0xf8, 0xae, 0x12, 0x95, 0x0e, 0x2c, 0x79, 0x73, 0x66, 0x9d, 0xc5, 0xa7,
+  0x65, 0xed, 0xc7, 0x3c, 0x93, 0xc3, 0x84, 0xc8, 0x10, 0xcf, 0x4d, 0x3c, 0x44, 0xf1, 0x4e, 0xfd,
+  0x06, 0x82, 0x48, 0x0b, 0xb3, 0x69, 0x05, 0x00, 0x00,
+};
+
+// framebuffer_viewer.html, 2126 bytes uncompressed
+const uint8_t kFramebufferViewerHtmlGz[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xa5, 0x56, 0x7f, 0x6f, 0xdb, 0x46,
+  0x0c, 0xfd, 0xdf, 0x9f, 0x82, 0xd3, 0xb0, 0x42, 0x9e, 0x1d, 0x4b, 0xb2, 0x93, 0xd4, 0xf0, 0xaf,
+  0xa1, 0x4d, 0x3a, 0x2c, 0x40, 0x8b, 0x15, 0x68, 0xb6, 0x61, 0x08, 0x82, 0xe0, 0x2c, 0xd1, 0xf6,
+  0x35, 0xf2, 0x49, 0x38, 0x9d, 0x2d, 0x1b, 0x6b, 0xbe, 0xfb, 0xde, 0xdd, 0xc9, 0xb1, 0x97, 0xb5,
+  0xc0, 0x80, 0x21, 0x41, 0xec, 0x23, 0x79, 0x24, 0xdf, 0x23, 0x8f, 0xcc, 0xe4, 0xbb, 0xeb, 0x5f,
+  0xaf, 0x6e, 0xff, 0xfc, 0xf8, 0x8e, 0x7e, 0xb9, 0xfd, 0xf0, 0x7e, 0x36, 0x59, 0x99, 0x75, 0x8e,
+  0xbf, 0x2c, 0xb2, 0x59, 0x6b, 0x62, 0xa4, 0xc9, 0x79, 0xf6, 0xbe, 0x50, 0x4b, 0xfa, 0xa8, 0xb9,
+  0xaa, 0xe8, 0x4d, 0x2e, 0xf4, 0x9a, 0xae, 0xf2, 0x22, 0x7d, 0xa4, 0x6b, 0x59, 0x95, 0xb9, 0xd8,
+  0x4f, 0x22, 0x6f, 0xd5, 0x9a, 0xac, 0xd9, 0x08, 0x52, 0x62, 0xcd, 0xd3, 0x60, 0x2b, 0xb9, 0x2e,
+  0x0b, 0x6d, 0x02, 0x4a, 0x0b, 0x65, 0x58, 0x99, 0x69, 0x50, 0xcb, 0xcc, 0xac, 0xa6, 0x19, 0x6f,
+  0x65, 0xca, 0x67, 0xee, 0xd0, 0x25, 0xa9, 0xa4, 0x91, 0x22, 0x3f, 0xab, 0x52, 0x91, 0xf3, 0x34,
+  0x09, 0xe0, 0xa4, 0x32, 0x7b, 0x38, 0x4b, 0x85, 0xda, 0x8a, 0x8a, 0xfe, 0x22, 0x67, 0x38, 0xa2,
+  0xcb, 0xf3, 0xb8, 0xdc, 0x8d, 0x69, 0x2d, 0x76, 0x67, 0x8d, 0x24, 0x89, 0xe3, 0x1f, 0xc6, 0x24,
+  0xd7, 0x62, 0xc9, 0x67, 0x9a, 0x55, 0xc6, 0x5a, 0xaa, 0xe5, 0x88, 0x4a, 0xb9, 0xe3, 0x5c, 0x18,
+  0xce, 0xc6, 0x34, 0x2f, 0x34, 0xa4, 0xb0, 0x2c, 0x77, 0x54, 0x15, 0xb9, 0xcc, 0xe8, 0xfb, 0xe1,
+  0x70, 0x38, 0xa6, 0xa7, 0x49, 0xe4, 0x83, 0x20, 0x58, 0xaa, 0x65, 0x69, 0x66, 0xad, 0xad, 0xd0,
+  0x94, 0x9a, 0x1d, 0x12, 0x5a, 0x2f, 0xbb, 0x34, 0xcf, 0xa5, 0xa9, 0x68, 0x4a, 0xf1, 0xb8, 0xb5,
+  0xd8, 0xa8, 0xd4, 0xc8, 0x42, 0x91, 0x5e, 0xce, 0xc3, 0xb4, 0x8d, 0x84, 0x34, 0x9b, 0x8d, 0x56,
+  0x74, 0x17, 0x86, 0x29, 0xcd, 0x66, 0x94, 0x24, 0x6d, 0x7a, 0x45, 0xf1, 0x2e, 0xf9, 0xb9, 0x4d,
+  0x3f, 0x52, 0xff, 0xe2, 0x82, 0x22, 0x1a, 0x24, 0x5d, 0x6a, 0xd4, 0x17, 0x5e, 0x3b, 0x38, 0xd1,
+  0x5e, 0x0e, 0xa0, 0x4d, 0xbf, 0x72, 0xe9, 0x1e, 0xa9, 0xb5, 0xa2, 0x88, 0xd6, 0x20, 0x1a, 0xa8,
+  0x46, 0x60, 0xc7, 0x24, 0x97, 0x84, 0xac, 0xf6, 0x5d, 0xda, 0xf8, 0x43, 0xdd, 0x25, 0xd0, 0xb6,
+  0xb0, 0x49, 0x2e, 0x09, 0x69, 0x82, 0x78, 0x02, 0x78, 0x29, 0x54, 0x97, 0xcc, 0x8a, 0x15, 0x25,
+  0x67, 0x73, 0x69, 0x48, 0x17, 0x75, 0x45, 0x1f, 0x3e, 0xbd, 0xa5, 0x85, 0xd4, 0x95, 0x39, 0xa2,
+  0xb0, 0xc8, 0xc2, 0xf9, 0x66, 0xb1, 0x60, 0x0d, 0x2c, 0x0e, 0xf6, 0x16, 0x40, 0x15, 0xd7, 0x74,
+  0x2d, 0x8c, 0xf8, 0x1d, 0x55, 0x3b, 0xa8, 0xbb, 0xb4, 0x83, 0x66, 0xdb, 0x5b, 0xb2, 0xb9, 0xb1,
+  0xa1, 0xc3, 0x18, 0x11, 0xf4, 0x86, 0xa1, 0xd8, 0xff, 0x53, 0xd1, 0x7f, 0x56, 0xd4, 0x07, 0xc5,
+  0x6f, 0x2e, 0xdb, 0xf0, 0xfc, 0x59, 0xb3, 0x7a, 0xa1, 0xb9, 0x6c, 0x34, 0x63, 0x97, 0xc3, 0x62,
+  0x09, 0xb5, 0x65, 0xf8, 0xd4, 0x64, 0xd8, 0x98, 0xb4, 0x1d, 0xd6, 0x7f, 0xeb, 0x93, 0xf8, 0xc4,
+  0xc0, 0x17, 0xcc, 0xe2, 0xb0, 0xda, 0xe1, 0x1b, 0xad, 0xc5, 0xbe, 0x41, 0xd2, 0xa5, 0xa4, 0x0f,
+  0x13, 0x50, 0x02, 0x8b, 0xb0, 0xa6, 0x0e, 0xbd, 0x6e, 0xdb, 0xd2, 0x0c, 0x50, 0xdd, 0x42, 0x53,
+  0x68, 0x13, 0xf8, 0xec, 0xaa, 0x8d, 0x8f, 0x09, 0xad, 0xf0, 0xd1, 0xe9, 0x58, 0x76, 0xe4, 0x82,
+  0xc2, 0x3d, 0xcc, 0xad, 0x34, 0xa6, 0x2f, 0x5f, 0xc8, 0x1f, 0x66, 0x53, 0xdb, 0x25, 0xbd, 0x15,
+  0xcb, 0xe5, 0xca, 0xb4, 0x5d, 0x7f, 0x4b, 0xb5, 0xe1, 0x13, 0x6f, 0xd2, 0x7b, 0x93, 0xb8, 0x57,
+  0xe3, 0xe3, 0xe8, 0x6d, 0x07, 0x07, 0xf2, 0xe0, 0xcd, 0x1f, 0x1a, 0x6f, 0xae, 0xa9, 0x4f, 0x9d,
+  0xb9, 0x8e, 0xb4, 0x09, 0x5b, 0x68, 0x77, 0x9f, 0xd1, 0x26, 0x16, 0x40, 0x87, 0x42, 0xe9, 0x72,
+  0x6f, 0xdf, 0xa3, 0x81, 0xc2, 0x78, 0x37, 0x8c, 0xed, 0x11, 0xc2, 0x57, 0x40, 0xd5, 0x6e, 0xd3,
+  0x4f, 0x96, 0xcb, 0x11, 0x08, 0xeb, 0x52, 0x69, 0x6f, 0x7b, 0x00, 0xb6, 0xcb, 0x9e, 0xa3, 0x40,
+  0xe0, 0x42, 0x5b, 0xe1, 0xf9, 0xb8, 0x65, 0xe5, 0x19, 0x6a, 0x7f, 0x57, 0xde, 0xe3, 0x42, 0x7a,
+  0x17, 0xdf, 0x8f, 0xe9, 0x28, 0x83, 0x61, 0xe2, 0xe5, 0xc9, 0x4b, 0x79, 0xdf, 0xcb, 0xfb, 0x2f,
+  0xe5, 0x03, 0x2b, 0x47, 0x4f, 0x8f, 0x5b, 0x4f, 0xf8, 0xc1, 0xab, 0xea, 0x95, 0x1b, 0x73, 0x63,
+  0xdf, 0xa9, 0x6d, 0xb1, 0xd0, 0xbd, 0xb0, 0xd8, 0xfd, 0xfa, 0xce, 0xb6, 0x2d, 0x8d, 0x3e, 0x70,
+  0x8f, 0xae, 0xd3, 0xb1, 0xb7, 0x9e, 0xdb, 0x15, 0x74, 0x28, 0x4e, 0x4d, 0x78, 0xe8, 0xd5, 0xfa,
+  0x50, 0xe4, 0x3f, 0x78, 0xfe, 0x09, 0x23, 0x88, 0x4d, 0x18, 0xd4, 0xd5, 0x28, 0x8a, 0x02, 0xc4,
+  0xc5, 0x4c, 0x12, 0xf6, 0x56, 0x6f, 0x55, 0x54, 0x06, 0xe7, 0x20, 0x5a, 0xcc, 0x03, 0x38, 0xae,
+  0xab, 0xde, 0x5c, 0x2a, 0xa1, 0xf7, 0xb7, 0xfb, 0x92, 0x71, 0x3f, 0x10, 0xb6, 0x39, 0x7c, 0x6f,
+  0x04, 0x4e, 0x5d, 0xa8, 0xe6, 0xc9, 0x41, 0x7b, 0x88, 0x1d, 0xb2, 0x7d, 0xec, 0xee, 0xbd, 0xb0,
+  0xc3, 0xd6, 0xc6, 0xeb, 0x6c, 0xac, 0x8b, 0x12, 0x0f, 0xed, 0xc4, 0xd4, 0x5a, 0x66, 0x45, 0xba,
+  0x59, 0x63, 0xce, 0xd9, 0x06, 0x7d, 0x97, 0xb3, 0xfd, 0xfa, 0x76, 0x7f, 0x93, 0x85, 0x41, 0x65,
+  0x30, 0x8d, 0x82, 0x76, 0xcf, 0xf0, 0xce, 0x5c, 0xf9, 0x59, 0x68, 0x93, 0xc8, 0xe5, 0x96, 0x83,
+  0xa3, 0xcb, 0x34, 0x2f, 0x2a, 0xfe, 0xbf, 0x3e, 0x35, 0x37, 0x84, 0x61, 0x12, 0xc2, 0x77, 0xc5,
+  0xe6, 0x56, 0xae, 0xb9, 0xd8, 0x98, 0xb0, 0x91, 0x77, 0xa9, 0x1f, 0xc7, 0xb1, 0x47, 0x72, 0x42,
+  0x33, 0xdc, 0x69, 0x4f, 0x32, 0xaa, 0x05, 0x47, 0xdf, 0x8c, 0x6b, 0x09, 0xb5, 0x42, 0x17, 0x73,
+  0x07, 0xf2, 0xfb, 0x99, 0x65, 0x18, 0x25, 0xb5, 0xad, 0x80, 0x4a, 0xa7, 0x9a, 0x91, 0xd9, 0xb1,
+  0xd8, 0x83, 0x3e, 0xca, 0xdc, 0x3f, 0x47, 0xc8, 0xd6, 0x73, 0x2d, 0xc7, 0xad, 0xca, 0x4d, 0x0e,
+  0xd6, 0x5b, 0x91, 0x87, 0xff, 0x0d, 0xb0, 0xfe, 0x1a, 0x5e, 0x3f, 0xa6, 0x51, 0x68, 0xff, 0x2d,
+  0xaa, 0x80, 0xf9, 0x38, 0xba, 0xe9, 0xa9, 0x6b, 0x77, 0x84, 0x0d, 0xfd, 0xd4, 0xc2, 0xc4, 0xf7,
+  0x93, 0x7e, 0x12, 0xb9, 0xcd, 0x36, 0x99, 0x17, 0xd9, 0x9e, 0x0a, 0x95, 0x17, 0x22, 0x9b, 0x06,
+  0x0d, 0x7e, 0xbb, 0x7d, 0x04, 0xad, 0x34, 0x2f, 0xa6, 0xc1, 0xca, 0x98, 0xd2, 0x36, 0xd6, 0x52,
+  0x9a, 0xd5, 0x66, 0xde, 0x4b, 0x8b, 0x75, 0x54, 0x3e, 0x26, 0xaf, 0x75, 0x64, 0x77, 0xe1, 0x83,
+  0xdb, 0x85, 0x0f, 0x6e, 0x17, 0x3e, 0xb8, 0x5d, 0x18, 0x19, 0xcd, 0x1c, 0x69, 0xce, 0x59, 0x54,
+  0x1c, 0x10, 0xfc, 0x01, 0xc1, 0x34, 0x78, 0x98, 0xe7, 0x42, 0x3d, 0x06, 0x58, 0xa7, 0x83, 0x6f,
+  0x2c, 0x51, 0xe4, 0x33, 0x40, 0x52, 0x02, 0xa1, 0x9b, 0x95, 0x27, 0x91, 0x10, 0x78, 0xf6, 0x8b,
+  0x6f, 0x1a, 0x80, 0xc1, 0x80, 0xfc, 0xac, 0x99, 0x06, 0x60, 0x12, 0xce, 0x22, 0x6f, 0x89, 0x2b,
+  0xe5, 0x6c, 0x52, 0x95, 0x42, 0xb9, 0x3b, 0xbe, 0x27, 0x66, 0xc7, 0x0e, 0x00, 0x66, 0xe8, 0x66,
+  0x5d, 0x3a, 0xda, 0x38, 0x1a, 0x67, 0x8d, 0x62, 0x12, 0x95, 0xce, 0xc5, 0x95, 0x8f, 0x9b, 0x69,
+  0x51, 0x63, 0xcd, 0xf1, 0x12, 0xc5, 0xa8, 0x2c, 0x35, 0xfb, 0x11, 0x81, 0x34, 0x66, 0x55, 0x89,
+  0x2d, 0x6b, 0x12, 0x2a, 0xc3, 0xfa, 0x95, 0x8a, 0x4a, 0xfb, 0x50, 0x0c, 0x1a, 0xab, 0xe7, 0x3d,
+  0x44, 0x96, 0x4b, 0x4b, 0xac, 0xfd, 0xc7, 0xe1, 0x6f, 0xcc, 0xb5, 0xe0, 0xf4, 0x4e, 0x08, 0x00,
+  0x00,
+};
+
+#endif  // WEB_PAGES_H
@@ -0,0 +1,151 @@
+#include "web_server.h"
+#if defined(MCU_IS_ESP32)
+  #include <AsyncTCP.h>
+  #include <ESPAsyncWebServer.h>
+  #include "wifi_stuff.h"
+  #include "web_pages.h"
+  #include "json_writer.h"
+  #include "rest_api.h"
+  #include "framebuffer_mirror.h"
+#endif
+
+#if defined(MCU_IS_ESP32)
+
+AsyncWebServer* server = NULL;
+
+const char* kHtmlParamKeySsid = "html_ssid";
+const char* kHtmlParamKeyPasswd = "html_passwd";
+const char* kHtmlParamKeyZipPin = "html_zip_pin";
+const char* kHtmlParamKeyCountryCode = "html_country_code";
+
+String temp_ssid_str = "Enter SSID";
+String temp_passwd_str = "Enter Passwd";
+String temp_zip_pin_str = "Enter ZIP/PIN";
+String temp_country_code_str = "Enter Country Code";
+
+// gzip page from flash as it is, pages are made by tools/web_pages.py and fetch their values from /values
+static void SendGzipPage(AsyncWebServerRequest *request, const uint8_t* page, size_t page_size) {
+  AsyncWebServerResponse *response = request->beginResponse_P(200, "text/html", page, page_size);
+  response->addHeader("Content-Encoding", "gzip");
+  request->send(response);
+}
+
+// read-only JSON status and metrics, serialized into a preallocated buffer
+static char status_json_buffer[640];
+static void AddStatusEndpoint() {
+  server->on("/status", HTTP_GET, [](AsyncWebServerRequest *request){
+    extern size_t WriteStatusJson(char* buffer, size_t size);
+    if(WriteStatusJson(status_json_buffer, sizeof(status_json_buffer)) == 0)
+      request->send(500, "text/plain", "status too long");
+    else
+      request->send(200, "application/json", status_json_buffer);
+  });
+}
+
+// live display mirror, viewer page connects to WebSocket /fb
+static void AddFramebufferMirror() {
+  server->on("/fb.html", HTTP_GET, [](AsyncWebServerRequest *request){
+    SendGzipPage(request, kFramebufferViewerHtmlGz, sizeof(kFramebufferViewerHtmlGz));
+  });
+  framebuffer_mirror.Register(server);
+}
+
+void _SoftAPWiFiDetails() {
+
+  temp_ssid_str = wifi_stuff->wifi_ssid_.c_str();
+  temp_passwd_str = wifi_stuff->wifi_password_.c_str();
+
+  // Send web page with input fields to client
+  server->on("/", HTTP_GET, [](AsyncWebServerRequest *request){
+    SendGzipPage(request, kWiFiDetailsHtmlGz, sizeof(kWiFiDetailsHtmlGz));
+  });
+
+  // current values for page's input fields
+  server->on("/values", HTTP_GET, [](AsyncWebServerRequest *request){
+    char buffer[256];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.BeginObject();
+    json.AddString(kHtmlParamKeySsid, temp_ssid_str.c_str());
+    json.AddString(kHtmlParamKeyPasswd, temp_passwd_str.c_str());
+    json.EndObject();
+    if(json.overflow())
+      request->send(500, "text/plain", "values too long");
+    else
+      request->send(200, "application/json", buffer);
+  });
+
+  // Send a GET request to <ESP_IP>/get?inputString=<inputMessage>
+  server->on("/get", HTTP_GET, [] (AsyncWebServerRequest *request) {
+    String inputMessage;
+    // GET inputString value on <ESP_IP>/get?inputString=<inputMessage>
+    if (request->hasParam(kHtmlParamKeySsid)) {
+      inputMessage = request->getParam(kHtmlParamKeySsid)->value();
+      temp_ssid_str = inputMessage;
+    }
+    // GET html_passwd value on <ESP_IP>/get?html_passwd=<inputMessage>
+    if (request->hasParam(kHtmlParamKeyPasswd)) {
+      inputMessage = request->getParam(kHtmlParamKeyPasswd)->value();
+      temp_passwd_str = inputMessage;
+    }
+    Serial.println(inputMessage);
+    request->send(200, "text/text", inputMessage);
+  });
+
+  AddStatusEndpoint();
+  rest_api.Register(server);
+  AddFramebufferMirror();
+
+  // server->onNotFound(notFound);
+  server->begin();
+}
+
+void _LocalServerLocationInputs() {
+
+  temp_zip_pin_str = std::to_string(wifi_stuff->location_zip_code_).c_str();
+  temp_country_code_str = wifi_stuff->location_country_code_.c_str();
+
+  // Send web page with input fields to client
+  server->on("/", HTTP_GET, [](AsyncWebServerRequest *request){
+    SendGzipPage(request, kLocationDetailsHtmlGz, sizeof(kLocationDetailsHtmlGz));
+  });
+
+  // current values for page's input fields
+  server->on("/values", HTTP_GET, [](AsyncWebServerRequest *request){
+    char buffer[96];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.BeginObject();
+    json.AddString(kHtmlParamKeyZipPin, temp_zip_pin_str.c_str());
+    json.AddString(kHtmlParamKeyCountryCode, temp_country_code_str.c_str());
+    json.EndObject();
+    if(json.overflow())
+      request->send(500, "text/plain", "values too long");
+    else
+      request->send(200, "application/json", buffer);
+  });
+
+  // Send a GET request to <ESP_IP>/get?inputString=<inputMessage>
+  server->on("/get", HTTP_GET, [] (AsyncWebServerRequest *request) {
+    String inputMessage;
+    // GET inputString value on <ESP_IP>/get?inputString=<inputMessage>
+    if (request->hasParam(kHtmlParamKeyZipPin)) {
+      inputMessage = request->getParam(kHtmlParamKeyZipPin)->value();
+      temp_zip_pin_str = inputMessage;
+    }
+    // GET html_passwd value on <ESP_IP>/get?html_passwd=<inputMessage>
+    if (request->hasParam(kHtmlParamKeyCountryCode)) {
+      inputMessage = request->getParam(kHtmlParamKeyCountryCode)->value();
+      temp_country_code_str = inputMessage;
+    }
+    Serial.println(inputMessage);
+    request->send(200, "text/text", inputMessage);
+  });
+
+  AddStatusEndpoint();
+  rest_api.Register(server);
+  AddFramebufferMirror();
+
+  // server->onNotFound(notFound);
+  server->begin();
+}
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef WEB_SERVER_H
+#define WEB_SERVER_H
+
+#include "common.h"
+
+// Web server pages of WiFi details soft AP and location local server, with /status, REST API
+// and framebuffer mirror on both. WiFiStuff creates server and brings WiFi up, then adds these routes.
+#if defined(MCU_IS_ESP32)
+  class AsyncWebServer;
+  extern AsyncWebServer* server;
+
+  // values entered on the pages, read back by WiFiStuff when server is stopped
+  extern String temp_ssid_str, temp_passwd_str;
+  extern String temp_zip_pin_str, temp_country_code_str;
+
+  void _SoftAPWiFiDetails();
+  void _LocalServerLocationInputs();
+#endif
+
+#endif  // WEB_SERVER_H
@@ -1,10 +1,12 @@
 #include <string.h>
 #include <string>
 #include <cstddef>
+#include <algorithm>
 #include "wifi_stuff.h"
 #include <WiFi.h>
 #include <HTTPClient.h>
-#include <Arduino_JSON.h>
+#include "weather_json_extractor.h"
+#include "firmware_version_matcher.h"
 #include "nvs_preferences.h"
 #include <WiFiUdp.h>
 #include <NTPClient.h>
@@ -15,6 +17,11 @@
   // Web OTA Update https://github.com/programmer131/ESP8266_ESP32_SelfUpdate/tree/master
   #include <HTTPUpdate.h>
   #include <WiFiClientSecure.h>
+  #include <Update.h>
+  #include <esp_ota_ops.h>
+  #include "ota_image.h"
+  #include "web_server.h"
+  #include "framebuffer_mirror.h"
 #endif
 
 WiFiStuff::WiFiStuff() {
@@ -23,6 +30,37 @@ WiFiStuff::WiFiStuff() {
 
   nvs_preferences->RetrieveWeatherLocationDetails(location_zip_code_, location_country_code_, weather_units_metric_not_imperial_);
 
+  // serve weather and gmt offset from cache after a reboot
+  WeatherCacheRecord weather_cache;
+  if(nvs_preferences->RetrieveWeatherCache(&weather_cache) && weather_cache.fetch_minutes != 0 && weather_cache.zip_code == location_zip_code_
+      && location_country_code_ == weather_cache.country_code && weather_cache.units_metric == weather_units_metric_not_imperial_) {
+    ApplyWeatherCache(weather_cache);
+    // weather is shown only while fresh, gmt offset stays usable
+    got_weather_info_ = WeatherCacheFresh();
+  }
+
+  // last access point and DHCP lease for fast reconnect
+  if(!nvs_preferences->RetrieveWiFiConnectCache(&wifi_connect_cache_))
+    wifi_connect_cache_ = {};
+
+  // weather and NTP host addresses of earlier sessions
+  if(save_dns_cache_to_nvs && nvs_preferences->RetrieveDnsCache(dns_cache_.entries_, DnsCache::kEntries)) {
+    for (uint8_t i = 0; i < DnsCache::kEntries; i++)
+      dns_cache_.entries_[i].host[sizeof(dns_cache_.entries_[i].host) - 1] = '\0';
+  }
+
+  #if defined(MCU_IS_ESP32)
+    // WiFi events come on WiFi event task, only flags are set there
+    WiFi.onEvent([this](arduino_event_id_t event, arduino_event_info_t info) {
+      if(event == ARDUINO_EVENT_WIFI_STA_GOT_IP)
+        sta_got_ip_ = true;
+      else if(event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED) {
+        sta_got_ip_ = false;
+        sta_disconnect_reason_ = max(info.wifi_sta_disconnected.reason, (uint8_t)1);
+      }
+    });
+  #endif
+
   TurnWiFiOff();
 
   PrintLn("WiFiStuff Initialized!");
@@ -31,6 +69,8 @@ WiFiStuff::WiFiStuff() {
 void WiFiStuff::SaveWiFiDetails() {
   nvs_preferences->SaveWiFiDetails(wifi_ssid_, wifi_password_);
   incorrect_wifi_details_ = false;
+  // cached access point is for old WiFi details
+  wifi_connect_cache_.ssid_hash = 0;
 }
 
 std::string WiFiStuff::WiFiDetailsShortString() {
@@ -56,40 +96,294 @@ void WiFiStuff::SaveWeatherUnits() {
   nvs_preferences->SaveWeatherUnits(weather_units_metric_not_imperial_);
 }
 
+// blocking connect for callers on second core, UI loop uses WiFiConnectStep()
 bool WiFiStuff::TurnWiFiOn() {
+  WiFiConnectState state = WiFiConnectStep();
+  while(state != kWiFiConnected && state != kWiFiFailedCredentials && state != kWiFiFailedNoAp) {
+    delay(kWiFiConnectPollMs);
+    ResetWatchdog();
+    state = WiFiConnectStep();
+  }
+  return wifi_connected_;
+}
 
-  PrintLn("WiFiStuff::TurnWiFiOn(): Connecting to WiFi");
-  WiFi.mode(WIFI_STA);
-  delay(1);
-  WiFi.persistent(true);
-  delay(1);
-  PrintLn(wifi_ssid_.c_str());
-  PrintLn(wifi_password_.c_str());
-  WiFi.begin(wifi_ssid_.c_str(), wifi_password_.c_str());
-  int i = 0;
-  while(WiFi.status() != WL_CONNECTED) {
-    delay(500);
-    PrintLn(".");
-    i++;
-    if(i >= 5) break;
+// non blocking WiFi connect state machine, call repeatedly
+// starts a connect if idle, advances it on WiFi events and timeouts, returns current state
+WiFiStuff::WiFiConnectState WiFiStuff::WiFiConnectStep() {
+  unsigned long now_ms = millis();
+  switch(wifi_connect_state_) {
+    case kWiFiIdle:
+      // give up for a while after access point was not found, so that callers do not keep radio on
+      if(no_ap_failure_ms_ != 0 && now_ms - no_ap_failure_ms_ < wifi_no_ap_retry_holdoff_ms_)
+        return kWiFiFailedNoAp;
+      no_ap_failure_ms_ = 0;
+      PrintLn("WiFiStuff::WiFiConnectStep(): Connecting to WiFi");
+      if(!radio_on_) {
+        radio_on_ = true;
+        radio_on_start_ms_ = now_ms;
+        dns_cache_.StartSession();
+      }
+      connect_start_ms_ = now_ms;
+      connect_attempt_ = 0;
+      auth_failures_ = 0;
+      WiFi.mode(WIFI_STA);
+      delay(1);
+      WiFi.persistent(true);
+      delay(1);
+      PrintLn(wifi_ssid_.c_str());
+      // directed connect to last access point first
+      StartWiFiConnectAttempt(wifi_connect_cache_.ssid_hash != 0 && wifi_connect_cache_.ssid_hash == WiFiDetailsHash());
+      break;
+
+    case kWiFiFastConnecting:
+    case kWiFiConnecting:
+      if(sta_got_ip_ || WiFi.status() == WL_CONNECTED) {
+        wifi_connected_ = true;
+        incorrect_wifi_details_ = false;
+        digitalWrite(WIFI_LED, HIGH);
+        RecordWiFiConnectTime(wifi_connect_state_ == kWiFiFastConnecting, now_ms - connect_start_ms_);
+        if(!connect_static_ip_)
+          SaveWiFiConnectCache();
+        sta_disconnect_reason_ = 0;
+        SetWiFiConnectState(kWiFiConnected);
+      }
+      else if(sta_disconnect_reason_ != 0 && IsAuthFailure(sta_disconnect_reason_))
+        WiFiConnectAttemptFailed(/*auth_failure = */ true);
+      else if(now_ms - attempt_start_ms_ >= (wifi_connect_state_ == kWiFiFastConnecting ? wifi_fast_connect_timeout_ms_ : wifi_connect_timeout_ms_))
+        WiFiConnectAttemptFailed(/*auth_failure = */ false);
+      break;
+
+    case kWiFiBackoff:
+      if(now_ms - attempt_start_ms_ >= backoff_ms_)
+        StartWiFiConnectAttempt(/*fast_connect = */ false);
+      break;
+
+    case kWiFiConnected:
+      // connection lost, next step reconnects
+      if(sta_disconnect_reason_ != 0 && WiFi.status() != WL_CONNECTED) {
+        PrintLn("WiFiStuff::WiFiConnectStep(): WiFi connection lost, reason ", sta_disconnect_reason_);
+        wifi_connected_ = false;
+        digitalWrite(WIFI_LED, LOW);
+        SetWiFiConnectState(kWiFiIdle);
+      }
+      break;
+
+    default:    // failed states stay until TurnWiFiOff()
+      break;
   }
-  if(WiFi.status() == WL_CONNECTED) {
-    PrintLn("WiFiStuff::TurnWiFiOn(): WiFi Connected.");
-    digitalWrite(WIFI_LED, HIGH);
-    wifi_connected_ = true;
-    incorrect_wifi_details_ = false;
+  return wifi_connect_state_;
+}
+
+void WiFiStuff::StartWiFiConnectAttempt(bool fast_connect) {
+  WiFi.disconnect();
+  sta_got_ip_ = false;
+  sta_disconnect_reason_ = 0;
+  attempt_start_ms_ = millis();
+
+  if(fast_connect) {
+    // skip scan, and reuse last DHCP lease while it is recent
+    uint32_t now_minutes = rtc->Now().minutes_since_2024();
+    connect_static_ip_ = (now_minutes != 0 && now_minutes >= wifi_connect_cache_.lease_minutes && now_minutes - wifi_connect_cache_.lease_minutes < kWiFiLeaseReuseMinutes);
+    if(connect_static_ip_)
+      WiFi.config(IPAddress(wifi_connect_cache_.ip), IPAddress(wifi_connect_cache_.gateway), IPAddress(wifi_connect_cache_.subnet), IPAddress(wifi_connect_cache_.dns));
+    else
+      WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
+    WiFi.begin(wifi_ssid_.c_str(), wifi_password_.c_str(), wifi_connect_cache_.channel, wifi_connect_cache_.bssid);
+    SetWiFiConnectState(kWiFiFastConnecting);
   }
   else {
-    PrintLn("WiFiStuff::TurnWiFiOn(): Could NOT connect to WiFi.");
-    digitalWrite(WIFI_LED, LOW);
-    wifi_connected_ = false;
+    // static IP config stays in WiFi driver until cleared, DHCP for every non-static connect
+    WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
+    connect_static_ip_ = false;
+    connect_attempt_++;
+    WiFi.begin(wifi_ssid_.c_str(), wifi_password_.c_str());
+    SetWiFiConnectState(kWiFiConnecting);
+  }
+}
+
+// wrong WiFi details only if access point rejects them twice, a slow or missing access point is retried with backoff
+void WiFiStuff::WiFiConnectAttemptFailed(bool auth_failure) {
+  Serial.printf("WiFiStuff::WiFiConnectAttemptFailed(): attempt %u, reason %u\n", connect_attempt_, sta_disconnect_reason_);
+  if(wifi_connect_state_ == kWiFiFastConnecting) {
+    // access point moved or lease is gone, full connect right away
+    StartWiFiConnectAttempt(/*fast_connect = */ false);
+    return;
+  }
+  WiFi.disconnect();
+  if(auth_failure)
+    auth_failures_++;
+  if(auth_failures_ >= 2) {
+    PrintLn("WiFiStuff::WiFiConnectAttemptFailed(): Incorrect WiFi details.");
     incorrect_wifi_details_ = true;
+    SetWiFiConnectState(kWiFiFailedCredentials);
+  }
+  else if(connect_attempt_ >= wifi_connect_attempts_) {
+    PrintLn("WiFiStuff::WiFiConnectAttemptFailed(): Could NOT connect to WiFi.");
+    no_ap_failure_ms_ = max(millis(), 1UL);
+    SetWiFiConnectState(kWiFiFailedNoAp);
+  }
+  else {
+    backoff_ms_ = wifi_backoff_base_ms_ << (connect_attempt_ - 1);
+    attempt_start_ms_ = millis();
+    SetWiFiConnectState(kWiFiBackoff);
   }
+}
 
-  return wifi_connected_;
+void WiFiStuff::SetWiFiConnectState(WiFiConnectState state) {
+  wifi_connect_state_ = state;
+  if(wifi_connect_progress_callback_ != NULL)
+    wifi_connect_progress_callback_(state, connect_attempt_);
+}
+
+bool WiFiStuff::IsAuthFailure(uint8_t reason) {
+  #if defined(MCU_IS_ESP32)
+    return (reason == WIFI_REASON_AUTH_FAIL || reason == WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT || reason == WIFI_REASON_HANDSHAKE_TIMEOUT || reason == WIFI_REASON_AUTH_EXPIRE);
+  #else
+    return false;
+  #endif
+}
+
+// FNV-1a hash of WiFi details, a cached access point is used only for same details
+uint32_t WiFiStuff::WiFiDetailsHash() {
+  uint32_t hash = 2166136261UL;
+  for (char c : wifi_ssid_ + '\n' + wifi_password_) {
+    hash ^= (uint8_t)c;
+    hash *= 16777619UL;
+  }
+  return (hash == 0 ? 1 : hash);
+}
+
+// save access point and DHCP lease of current connection, NVS is written only if they changed
+void WiFiStuff::SaveWiFiConnectCache() {
+  WiFiConnectCacheRecord wifi_connect_cache = {};
+  wifi_connect_cache.ssid_hash = WiFiDetailsHash();
+  wifi_connect_cache.lease_minutes = rtc->Now().minutes_since_2024();
+  uint8_t* bssid = WiFi.BSSID();
+  if(bssid == NULL) return;
+  memcpy(wifi_connect_cache.bssid, bssid, sizeof(wifi_connect_cache.bssid));
+  wifi_connect_cache.channel = WiFi.channel();
+  wifi_connect_cache.ip = (uint32_t)WiFi.localIP();
+  wifi_connect_cache.gateway = (uint32_t)WiFi.gatewayIP();
+  wifi_connect_cache.subnet = (uint32_t)WiFi.subnetMask();
+  wifi_connect_cache.dns = (uint32_t)WiFi.dnsIP();
+
+  // same access point and lease, NVS lease time is refreshed only once it is half way through reuse time
+  uint32_t new_lease_minutes = wifi_connect_cache.lease_minutes;
+  wifi_connect_cache.lease_minutes = wifi_connect_cache_.lease_minutes;
+  bool unchanged = (memcmp(&wifi_connect_cache, &wifi_connect_cache_, sizeof(WiFiConnectCacheRecord)) == 0);
+  wifi_connect_cache.lease_minutes = new_lease_minutes;
+  if(unchanged && new_lease_minutes - wifi_connect_cache_.lease_minutes < kWiFiLeaseReuseMinutes / 2)
+    return;
+  wifi_connect_cache_ = wifi_connect_cache;
+  nvs_preferences->SaveWiFiConnectCache(&wifi_connect_cache_);
+}
+
+// A record query to DNS server given by DHCP, which unlike WiFi.hostByName() gives record TTL
+bool WiFiStuff::ResolveOverUdp(const char* host, uint32_t &ip, uint32_t &ttl_seconds) {
+  uint8_t packet[384];    // query, then response in same buffer
+  uint16_t id = random(1, 65536);
+  IPAddress dns_server = WiFi.dnsIP();
+  if(DnsCache::BuildQuery(packet, sizeof(packet), id, host) > 0 && (uint32_t)dns_server != 0) {
+    WiFiUDP udp;
+    // random source port and id make a spoofed answer unlikely to match
+    if(udp.begin(random(49152, 65536))) {
+      for (uint8_t attempt = 0; attempt < kDnsAttempts; attempt++) {
+        size_t query_length = DnsCache::BuildQuery(packet, sizeof(packet), id, host);
+        udp.beginPacket(dns_server, 53);
+        udp.write(packet, query_length);
+        udp.endPacket();
+        unsigned long send_ms = millis();
+        while(millis() - send_ms < kDnsTimeoutMs) {
+          if(udp.parsePacket() > 0) {
+            int response_length = udp.read(packet, sizeof(packet));
+            if(response_length > 0 && DnsCache::ParseResponse(packet, response_length, id, host, ip, ttl_seconds)) {
+              udp.stop();
+              return true;
+            }
+          }
+          else
+            delay(1);
+        }
+      }
+      udp.stop();
+    }
+  }
+  // resolver without TTL, entry is then kept only as a fallback
+  IPAddress address;
+  if(WiFi.hostByName(host, address) != 1)
+    return false;
+  ip = (uint32_t)address;
+  ttl_seconds = 0;
+  return true;
+}
+
+// DNS cache clock, RTC seconds since 2024, 0 while RTC is not set
+uint32_t WiFiStuff::DnsNowSeconds() {
+  RTC::TimeSnapshot now = rtc->Now();
+  return (now.minutes_since_2024() == 0 ? 0 : now.minutes_since_2024() * 60 + now.second);
+}
+
+// connect client to host through DNS cache, a cached address that does not answer is resolved again
+bool WiFiStuff::ConnectViaDnsCache(WiFiClient &client, const char* host, uint16_t port) {
+  uint32_t ip = 0;
+  DnsCache::Result result = dns_cache_.Resolve(host, DnsNowSeconds(), ip);
+  if(result == DnsCache::kFailed)
+    return false;
+  if(client.connect(IPAddress(ip), port))
+    return true;
+  if(result != DnsCache::kHit)
+    return false;
+  PrintLn("WiFiStuff::ConnectViaDnsCache(): cached address did not answer, resolving ", host);
+  dns_cache_.Invalidate(host);
+  return (dns_cache_.Resolve(host, DnsNowSeconds(), ip) != DnsCache::kFailed && client.connect(IPAddress(ip), port));
+}
+
+void WiFiStuff::RecordWiFiConnectTime(bool fast_connect, unsigned long connect_ms) {
+  WiFiConnectTimes &connect_times = wifi_connect_times_[fast_connect];
+  connect_times.samples_ms[connect_times.count % kWiFiConnectTimeSamples] = min(connect_ms, (unsigned long)UINT16_MAX);
+  connect_times.count++;
+  Serial.printf("WiFiStuff::TurnWiFiOn(): %s connect %lu ms\n", (fast_connect ? "fast" : "full"), connect_ms);
+}
+
+// connect time percentiles of last kWiFiConnectTimeSamples connects, per connect path
+bool WiFiStuff::WiFiConnectTimePercentiles(bool fast_connect, uint16_t &connects, uint16_t &p50_ms, uint16_t &p90_ms, uint16_t &max_ms) {
+  const WiFiConnectTimes &connect_times = wifi_connect_times_[fast_connect];
+  connects = connect_times.count;
+  uint8_t samples_count = min(connect_times.count, (uint16_t)kWiFiConnectTimeSamples);
+  if(samples_count == 0)
+    return false;
+  uint16_t sorted_ms[kWiFiConnectTimeSamples];
+  memcpy(sorted_ms, connect_times.samples_ms, samples_count * sizeof(uint16_t));
+  std::sort(sorted_ms, sorted_ms + samples_count);
+  p50_ms = sorted_ms[samples_count / 2];
+  p90_ms = sorted_ms[samples_count * 9 / 10];
+  max_ms = sorted_ms[samples_count - 1];
+  return true;
+}
+
+void WiFiStuff::PrintWiFiConnectTimes() {
+  for (uint8_t fast_connect = 0; fast_connect < 2; fast_connect++) {
+    uint16_t connects, p50_ms, p90_ms, max_ms;
+    if(!WiFiConnectTimePercentiles(fast_connect, connects, p50_ms, p90_ms, max_ms)) {
+      Serial.printf("%s connect: no samples\n", (fast_connect ? "fast" : "full"));
+      continue;
+    }
+    Serial.printf("%s connect: %u connects, last %u: p50 %u ms, p90 %u ms, max %u ms\n", (fast_connect ? "fast" : "full"),
+      connects, min(connects, (uint16_t)kWiFiConnectTimeSamples), p50_ms, p90_ms, max_ms);
+  }
 }
 
 void WiFiStuff::TurnWiFiOff() {
+#if defined(MCU_IS_ESP32)
+  // a version check or firmware update in progress on other core owns the client, it fails with WiFi
+  // going off and its owner releases the client
+  if(github_client_mutex_.try_lock()) {
+    ReleaseGitHubClient();
+    github_client_mutex_.unlock();
+  }
+#endif
+  // back to DHCP, a static IP of a fast connect must not outlive its session
+  WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
   WiFi.persistent(false);
   delay(1);
   WiFi.mode(WIFI_OFF);
@@ -98,6 +392,100 @@ void WiFiStuff::TurnWiFiOff() {
   PrintLn("WiFiStuff::TurnWiFiOff(): WiFi Off.");
   digitalWrite(WIFI_LED, LOW);
   wifi_connected_ = false;
+  connect_static_ip_ = false;
+  SetWiFiConnectState(kWiFiIdle);
+  if(radio_on_) {
+    radio_on_ = false;
+    radio_on_ms_ += millis() - radio_on_start_ms_;
+    dns_cache_.PrintSession();
+    if(save_dns_cache_to_nvs && dns_cache_.entries_changed_) {
+      nvs_preferences->SaveDnsCache(dns_cache_.entries_, DnsCache::kEntries);
+      dns_cache_.entries_changed_ = false;
+    }
+  }
+}
+
+// radio on seconds since last call, includes ongoing radio on time
+uint32_t WiFiStuff::TakeRadioOnSeconds() {
+  if(radio_on_) {
+    unsigned long now_ms = millis();
+    radio_on_ms_ += now_ms - radio_on_start_ms_;
+    radio_on_start_ms_ = now_ms;
+  }
+  uint32_t radio_on_seconds = radio_on_ms_ / 1000;
+  radio_on_ms_ = 0;
+  return radio_on_seconds;
+}
+
+// set weather strings from a weather cache record
+void WiFiStuff::ApplyWeatherCache(const WeatherCacheRecord &weather_cache) {
+  weather_cache_ = weather_cache;
+  weather_cache_.country_code[sizeof(weather_cache_.country_code) - 1] = '\0';
+  weather_cache_.weather_main[sizeof(weather_cache_.weather_main) - 1] = '\0';
+  weather_cache_.weather_description[sizeof(weather_cache_.weather_description) - 1] = '\0';
+  weather_cache_.city[sizeof(weather_cache_.city) - 1] = '\0';
+
+  char unit = (weather_cache_.units_metric ? 'C' : 'F');
+  char valArr[12];
+  weather_main_.assign(weather_cache_.weather_main);
+  weather_description_.assign(weather_cache_.weather_description);
+  sprintf(valArr,"%.1f%c", weather_cache_.temp_x10 / 10.0, unit);
+  weather_temp_.assign(valArr);
+  sprintf(valArr,"%.1f%c", weather_cache_.feels_like_x10 / 10.0, unit);
+  weather_temp_feels_like_.assign(valArr);
+  sprintf(valArr,"%.1f%c", weather_cache_.temp_max_x10 / 10.0, unit);
+  weather_temp_max_.assign(valArr);
+  sprintf(valArr,"%.1f%c", weather_cache_.temp_min_x10 / 10.0, unit);
+  weather_temp_min_.assign(valArr);
+  sprintf(valArr,"%d%s", weather_cache_.wind_speed_x10 / 10, (weather_cache_.units_metric ? "m/s" : "mi/hr"));
+  weather_wind_speed_.assign(valArr);
+  sprintf(valArr,"%d%%", weather_cache_.humidity);
+  weather_humidity_.assign(valArr);
+  city_.assign(weather_cache_.city);
+  gmt_offset_sec_ = weather_cache_.gmt_offset_sec;
+  got_weather_info_ = true;
+
+  Serial.print("weather_main "); Serial.println(weather_main_.c_str());
+  Serial.print("weather_description "); Serial.println(weather_description_.c_str());
+  Serial.print("weather_temp "); Serial.println(weather_temp_.c_str());
+  Serial.print("weather_temp_feels_like_ "); Serial.println(weather_temp_feels_like_.c_str());
+  Serial.print("weather_temp_max "); Serial.println(weather_temp_max_.c_str());
+  Serial.print("weather_temp_min "); Serial.println(weather_temp_min_.c_str());
+  Serial.print("weather_wind_speed "); Serial.println(weather_wind_speed_.c_str());
+  Serial.print("weather_humidity "); Serial.println(weather_humidity_.c_str());
+  Serial.print("city_ "); Serial.println(city_.c_str());
+  Serial.print("gmt_offset_sec_ "); Serial.println(gmt_offset_sec_);
+}
+
+// minutes since cached weather was fetched, UINT32_MAX if there is no cache or RTC time is not set
+uint32_t WiFiStuff::WeatherCacheAgeMinutes() {
+  if(weather_cache_.fetch_minutes == 0) return UINT32_MAX;
+  uint32_t now_minutes = rtc->Now().minutes_since_2024();
+  if(now_minutes == 0 || now_minutes < weather_cache_.fetch_minutes) return UINT32_MAX;
+  return now_minutes - weather_cache_.fetch_minutes;
+}
+
+bool WiFiStuff::WeatherCacheFresh() {
+  return got_weather_info_ && WeatherCacheAgeMinutes() < kWeatherCacheTtlMinutes;
+}
+
+bool WiFiStuff::GmtOffsetFresh() {
+  if(weather_cache_.fetch_minutes == 0) return false;
+  RTC::TimeSnapshot now = rtc->Now();
+  uint32_t now_minutes = now.minutes_since_2024();
+  // if time was lost on power failure, cached gmt offset is what is needed to get time back
+  if(now_minutes == 0) return true;
+  if(now_minutes < weather_cache_.fetch_minutes || now_minutes - weather_cache_.fetch_minutes >= kGmtOffsetCacheTtlMinutes)
+    return false;
+  // daylight saving time starts and ends at 2 AM, an offset fetched before last 2 AM is never reused
+  uint32_t last_2am_minutes = now_minutes - (now.todays_minutes + kMinutesInDay - 2 * 60) % kMinutesInDay;
+  return (weather_cache_.fetch_minutes > last_2am_minutes);
+}
+
+// location or units changed
+void WiFiStuff::InvalidateWeatherCache() {
+  weather_cache_.fetch_minutes = 0;
+  got_weather_info_ = false;
 }
 
 void WiFiStuff::GetTodaysWeatherInfo() {
@@ -132,22 +520,48 @@ void WiFiStuff::GetTodaysWeatherInfo() {
   // Check WiFi connection status
   if(WiFi.status()== WL_CONNECTED) {
     // std::string serverPath = "http://api.openweathermap.org/data/2.5/weather?q=" + city_copy + "," + countryCode + "&APPID=" + openWeatherMapApiKey + "&units=imperial";
+    const char* kWeatherHost = "api.openweathermap.org";
     std::string serverPath = "http://api.openweathermap.org/data/2.5/weather?zip=" + std::to_string(location_zip_code_) + "," + location_country_code_ + "&appid=" + openWeatherMapApiKey + "&units=" + (weather_units_metric_not_imperial_ ? "metric" : "imperial" );
     WiFiClient client;
     HTTPClient http;
-      
+    // HTTP 1.0 response is not chunked, so body can be parsed straight from the stream
+    http.useHTTP10(true);
+
+    // client connected through DNS cache is used by HTTPClient as is, request still carries host name
+    // if it could not connect, HTTPClient resolves and connects itself
+    ConnectViaDnsCache(client, kWeatherHost, 80);
+
     // Your Domain name with URL path or IP address with path
     http.begin(client, serverPath.c_str());
     
     // Send HTTP POST request
     int httpResponseCode = http.GET();
     last_fetch_weather_info_time_ms_ = millis();
-    
-    String jsonBuffer = "{}"; 
-    
+    weather_http_requests_++;
+    PrintLn("WiFiStuff::GetTodaysWeatherInfo(): weather HTTP requests since boot ", weather_http_requests_);
+
+    // stream body through extractor, without buffering the payload
+    WeatherJsonExtractor extractor;
+    extractor.Reset();
     if (httpResponseCode>0) {
       PrintLn("WiFiStuff::GetTodaysWeatherInfo(): HTTP Response code: ", httpResponseCode);
-      jsonBuffer = http.getString();
+      WiFiClient* stream = http.getStreamPtr();
+      int remaining_bytes = http.getSize();   // -1 if server did not send length
+      unsigned long last_data_time_ms = millis();
+      uint8_t buffer[64];
+      while((remaining_bytes > 0 || remaining_bytes == -1) && !extractor.Done() && !extractor.Failed()) {
+        int available_bytes = stream->available();
+        if(available_bytes > 0) {
+          int read_bytes = stream->readBytes(buffer, min(available_bytes, (int)sizeof(buffer)));
+          extractor.Feed(buffer, read_bytes);
+          if(remaining_bytes > 0) remaining_bytes -= read_bytes;
+          last_data_time_ms = millis();
+        }
+        else if(!http.connected() || millis() - last_data_time_ms > kWeatherStreamTimeoutMs)
+          break;
+        else
+          delay(1);
+      }
     }
     else {
       Serial.print("Error code: ");
@@ -155,54 +569,34 @@ void WiFiStuff::GetTodaysWeatherInfo() {
     }
     // Free resources
     http.end();
-    
-    Serial.println(jsonBuffer);
-    JSONVar myObject = JSON.parse(jsonBuffer);
-
-    // JSON.typeof(jsonVar) can be used to get the type of the var
-    // if (JSON.typeof(myObject) == "undefined" || httpResponseCode <= 0) {
-    //   Serial.println("Parsing input failed!");
-    // }
-    if(httpResponseCode >= 200 && httpResponseCode < 300)
+
+    if(httpResponseCode >= 200 && httpResponseCode < 300 && extractor.Done())
     {
       // got response
-      wifi_stuff->got_weather_info_ = true;
-
-      Serial.print("JSON object = ");
-      Serial.println(myObject);
-      Serial.print("Weather: ");
-      weather_main_.assign(myObject["weather"][0]["main"]);
-      weather_description_.assign(myObject["weather"][0]["description"]);
-      double val = atof(JSONVar::stringify(myObject["main"]["temp"]).c_str());
-      char valArr[10]; sprintf(valArr,"%.1f%c", val, (weather_units_metric_not_imperial_ ? 'C' : 'F'));
-      weather_temp_.assign(valArr);
-      val = atof(JSONVar::stringify(myObject["main"]["feels_like"]).c_str());
-      sprintf(valArr,"%.1f%c", val, (weather_units_metric_not_imperial_ ? 'C' : 'F'));
-      weather_temp_feels_like_.assign(valArr);
-      val = atof(JSONVar::stringify(myObject["main"]["temp_max"]).c_str());
-      sprintf(valArr,"%.1f%c", val, (weather_units_metric_not_imperial_ ? 'C' : 'F'));
-      weather_temp_max_.assign(valArr);
-      val = atof(JSONVar::stringify(myObject["main"]["temp_min"]).c_str());
-      sprintf(valArr,"%.1f%c", val, (weather_units_metric_not_imperial_ ? 'C' : 'F'));
-      weather_temp_min_.assign(valArr);
-      val = atof(JSONVar::stringify(myObject["wind"]["speed"]).c_str());
-      sprintf(valArr,"%d%s", (int)val, (weather_units_metric_not_imperial_ ? "m/s" : "mi/hr"));
-      weather_wind_speed_.assign(valArr);
-      weather_humidity_.assign(JSONVar::stringify(myObject["main"]["humidity"]).c_str());
-      weather_humidity_ = weather_humidity_ + '%';
-      city_.assign(myObject["name"]);
-      gmt_offset_sec_ = atoi(JSONVar::stringify(myObject["timezone"]).c_str());
-      Serial.print("weather_main "); Serial.println(weather_main_.c_str());
-      Serial.print("weather_description "); Serial.println(weather_description_.c_str());
-      Serial.print("weather_temp "); Serial.println(weather_temp_.c_str());
-      Serial.print("weather_temp_feels_like_ "); Serial.println(weather_temp_feels_like_.c_str());
-      Serial.print("weather_temp_max "); Serial.println(weather_temp_max_.c_str());
-      Serial.print("weather_temp_min "); Serial.println(weather_temp_min_.c_str());
-      Serial.print("weather_wind_speed "); Serial.println(weather_wind_speed_.c_str());
-      Serial.print("weather_humidity "); Serial.println(weather_humidity_.c_str());
-      Serial.print("city_ "); Serial.println(city_.c_str());
-      Serial.print("gmt_offset_sec_ "); Serial.println(gmt_offset_sec_);
-
+      if(extractor.found_fields != WeatherJsonExtractor::kAllFieldsFound)
+        PrintLn("WiFiStuff::GetTodaysWeatherInfo(): missing fields mask ", WeatherJsonExtractor::kAllFieldsFound & ~extractor.found_fields);
+
+      // compact weather record, kept in NVS with fetch time
+      WeatherCacheRecord weather_cache = {};
+      weather_cache.fetch_minutes = rtc->Now().minutes_since_2024();
+      weather_cache.zip_code = location_zip_code_;
+      strncpy(weather_cache.country_code, location_country_code_.c_str(), sizeof(weather_cache.country_code) - 1);
+      weather_cache.units_metric = weather_units_metric_not_imperial_;
+      weather_cache.humidity = (uint8_t)extractor.number_values[WeatherJsonExtractor::kMainHumidity];
+      weather_cache.temp_x10 = (int16_t)(extractor.number_values[WeatherJsonExtractor::kMainTemp] * 10);
+      weather_cache.feels_like_x10 = (int16_t)(extractor.number_values[WeatherJsonExtractor::kMainFeelsLike] * 10);
+      weather_cache.temp_min_x10 = (int16_t)(extractor.number_values[WeatherJsonExtractor::kMainTempMin] * 10);
+      weather_cache.temp_max_x10 = (int16_t)(extractor.number_values[WeatherJsonExtractor::kMainTempMax] * 10);
+      weather_cache.wind_speed_x10 = (int16_t)(extractor.number_values[WeatherJsonExtractor::kWindSpeed] * 10);
+      weather_cache.gmt_offset_sec = (int32_t)extractor.number_values[WeatherJsonExtractor::kTimezone];
+      strncpy(weather_cache.weather_main, extractor.weather_main, sizeof(weather_cache.weather_main) - 1);
+      strncpy(weather_cache.weather_description, extractor.weather_description, sizeof(weather_cache.weather_description) - 1);
+      strncpy(weather_cache.city, extractor.name, sizeof(weather_cache.city) - 1);
+      ApplyWeatherCache(weather_cache);
+      // without RTC time the record cannot be aged, it is saved after NTP sets RTC
+      weather_cache_unstamped_ = (weather_cache.fetch_minutes == 0);
+      if(!weather_cache_unstamped_)
+        nvs_preferences->SaveWeatherCache(&weather_cache_);
     }
     else if(httpResponseCode >= 400) {
       PrintLn("WiFiStuff::GetTodaysWeatherInfo(): Incorrect zip code!");
@@ -223,7 +617,7 @@ void WiFiStuff::GetTodaysWeatherInfo() {
 bool WiFiStuff::GetTimeFromNtpServer() {
   manual_time_update_successful_ = false;
 
-  if(!got_weather_info_) { // we need gmt_offset_sec_ before getting time update!
+  if(!GmtOffsetFresh()) { // we need gmt_offset_sec_ before getting time update!
     PrintLn("WiFiStuff::GetTimeFromNtpServer(): Fetching gmt_offset_sec_ before getting time update.");
     GetTodaysWeatherInfo();
     PrintLn("WiFiStuff::GetTimeFromNtpServer(): got_weather_info_ = ", got_weather_info_);
@@ -250,12 +644,24 @@ bool WiFiStuff::GetTimeFromNtpServer() {
     const char* NTP_SERVER = "pool.ntp.org";
     // const long  GMT_OFFSET_SEC = -8*60*60;
 
-    // Define an NTP Client object
+    // Define an NTP Client object, on address from DNS cache, by name if that could not resolve
     WiFiUDP udpSocket;
-    NTPClient ntpClient(udpSocket, NTP_SERVER, gmt_offset_sec_);
+    uint32_t ntp_server_ip = 0;
+    DnsCache::Result dns_result = dns_cache_.Resolve(NTP_SERVER, DnsNowSeconds(), ntp_server_ip);
+    NTPClient ntpClient = (dns_result != DnsCache::kFailed ? NTPClient(udpSocket, IPAddress(ntp_server_ip), gmt_offset_sec_) : NTPClient(udpSocket, NTP_SERVER, gmt_offset_sec_));
 
     ntpClient.begin();
     returnVal = ntpClient.update();
+    if(!returnVal && dns_result == DnsCache::kHit) {
+      // cached address did not answer, resolve again
+      PrintLn("WiFiStuff::GetTimeFromNtpServer(): cached NTP server address did not answer");
+      ntpClient.end();
+      dns_cache_.Invalidate(NTP_SERVER);
+      dns_result = dns_cache_.Resolve(NTP_SERVER, DnsNowSeconds(), ntp_server_ip);
+      ntpClient = (dns_result != DnsCache::kFailed ? NTPClient(udpSocket, IPAddress(ntp_server_ip), gmt_offset_sec_) : NTPClient(udpSocket, NTP_SERVER, gmt_offset_sec_));
+      ntpClient.begin();
+      returnVal = ntpClient.update();
+    }
     PrintLn("WiFiStuff::GetTimeFromNtpServer(): ntpClient.update() = ", returnVal);
 
     if(returnVal) {
@@ -270,12 +676,33 @@ bool WiFiStuff::GetTimeFromNtpServer() {
       int today, month, year;
       ConvertEpochIntoDate(epoch_since_1970, today, month, year);
 
+      // RTC error before setting it, local time seconds since 2024 on both sides
+      RTC::TimeSnapshot rtc_before = rtc->Now();
+      if(rtc_before.minutes_since_2024() != 0) {
+        const uint32_t kEpochJan2024 = 1704067200;
+        last_ntp_offset_sec_ = (int32_t)(epoch_since_1970 - kEpochJan2024) - (int32_t)(rtc_before.minutes_since_2024() * 60 + rtc_before.second);
+        // drift since previous update, that one left RTC at zero offset
+        // large offsets are time zone or manual time changes, not drift
+        if(ntp_offset_valid_ && epoch_since_1970 - last_ntp_epoch_ >= kRtcDriftMinSeconds && abs(last_ntp_offset_sec_) <= kRtcDriftMaxOffsetSec)
+          rtc_drift_ppm_ = last_ntp_offset_sec_ * 1e6f / (epoch_since_1970 - last_ntp_epoch_);
+        ntp_offset_valid_ = true;
+        Serial.printf("NTP - RTC offset %ld s, RTC drift %.1f ppm\n", (long)last_ntp_offset_sec_, rtc_drift_ppm_);
+      }
+      last_ntp_epoch_ = epoch_since_1970;
+
       // RTC::SetRtcTimeAndDate(uint8_t second, uint8_t minute, uint8_t hour_24_hr_mode, uint8_t dayOfWeek_Sun_is_1, uint8_t day, uint8_t month_Jan_is_1, uint16_t year)
       rtc->SetRtcTimeAndDate(seconds, minutes, hours, dayOfWeekSunday0 + 1, today, month, year);
 
       last_ntp_server_time_update_time_ms = millis();
       // auto update time today at 2:01AM success
-      if(rtc->hourModeAndAmPm() == 1 && rtc->hour() == 2 && rtc->minute() >= 1)
+      RTC::TimeSnapshot now = rtc->Now();
+      if(weather_cache_unstamped_ && got_weather_info_) {
+        // weather fetched moments ago for this time update
+        weather_cache_.fetch_minutes = now.minutes_since_2024();
+        weather_cache_unstamped_ = false;
+        nvs_preferences->SaveWeatherCache(&weather_cache_);
+      }
+      if(now.hour_mode_and_am_pm == 1 && now.hour == 2 && now.minute >= 1)
         auto_updated_time_today_ = true;
     }
 
@@ -371,14 +798,12 @@ void WiFiStuff::ConvertEpochIntoDate(unsigned long epoch_since_1970, int &today,
 #if defined(MCU_IS_ESP32)
 void WiFiStuff::StartSetWiFiSoftAP() {
   PrintLn("WiFiStuff::StartSetWiFiSoftAP()");
-  extern void _SoftAPWiFiDetails();
-
-  extern AsyncWebServer* server;
 
   TurnWiFiOff();
   delay(100);
 
   if(server != NULL) {
+    framebuffer_mirror.Unregister();
     delete server;
     server = NULL;
   }
@@ -406,8 +831,6 @@ void WiFiStuff::StartSetWiFiSoftAP() {
 
 void WiFiStuff::StopSetWiFiSoftAP() {
   PrintLn("WiFiStuff::StopSetWiFiSoftAP()");
-  extern AsyncWebServer* server;
-  extern String temp_ssid_str, temp_passwd_str;
 
   // To access your stored values on ssid_str, passwd_str
   Serial.print("SSID: ");
@@ -420,6 +843,7 @@ void WiFiStuff::StopSetWiFiSoftAP() {
   delay(100);
 
   if(server != NULL) {
+    framebuffer_mirror.Unregister();
     server->end();
 
     delete server;
@@ -432,14 +856,12 @@ void WiFiStuff::StopSetWiFiSoftAP() {
 
 void WiFiStuff::StartSetLocationLocalServer() {
   PrintLn("WiFiStuff::StartSetLocationLocalServer()");
-  extern void _LocalServerLocationInputs();
-
-  extern AsyncWebServer* server;
 
   TurnWiFiOff();
   delay(100);
 
   if(server != NULL) {
+    framebuffer_mirror.Unregister();
     delete server;
     server = NULL;
   }
@@ -462,8 +884,6 @@ void WiFiStuff::StartSetLocationLocalServer() {
 
 void WiFiStuff::StopSetLocationLocalServer() {
   PrintLn("WiFiStuff::StopSetLocationLocalServer()");
-  extern AsyncWebServer* server;
-  extern String temp_zip_pin_str, temp_country_code_str;
 
   // To access your stored values on ssid_str, passwd_str
   Serial.print("ZIP/PIN: ");
@@ -476,6 +896,7 @@ void WiFiStuff::StopSetLocationLocalServer() {
   delay(100);
 
   if(server != NULL) {
+    framebuffer_mirror.Unregister();
     server->end();
 
     delete server;
@@ -486,149 +907,6 @@ void WiFiStuff::StopSetLocationLocalServer() {
   wifi_stuff->location_country_code_ = temp_country_code_str.c_str();
 }
 
-AsyncWebServer* server = NULL;
-
-const char* kHtmlParamKeySsid = "html_ssid";
-const char* kHtmlParamKeyPasswd = "html_passwd";
-const char* kHtmlParamKeyZipPin = "html_zip_pin";
-const char* kHtmlParamKeyCountryCode = "html_country_code";
-
-String temp_ssid_str = "Enter SSID";
-String temp_passwd_str = "Enter Passwd";
-String temp_zip_pin_str = "Enter ZIP/PIN";
-String temp_country_code_str = "Enter Country Code";
-
-// HTML web page to handle 2 input fields (html_ssid, html_passwd)
-const char index_html_wifi_details[] PROGMEM = R"rawliteral(
-<!DOCTYPE HTML><html><head>
-  <title>Long Press Alarm Clock</title>
-  <meta name="viewport" content="width=device-width, initial-scale=1">
-  <script>
-    function submitMessage() {
-      alert("Sent! Press 'Save' on device to set!");
-      setTimeout(function(){ document.location.reload(false); }, 500);   
-    }
-  </script></head><body>
-  <form action="/get" target="hidden-form">
-  	<a href="https://github.com/pk17r/Long_Press_Alarm_Clock/tree/release" target="_blank"><h3>Long Press Alarm Clock</h3></a>
-    <h4>Enter WiFi Details:</h4>
-    <label>WiFi SSID (2.4GHz):</label><br>
-    <input type="text" name="html_ssid" value="%html_ssid%"><br><br>
-    <label>WiFi Password:</label><br>
-    <input type="text" name="html_passwd" value="%html_passwd%"><br><br>
-    <input type="submit" value="Submit" onclick="submitMessage()">
-  </form>
-  <iframe style="display:none" name="hidden-form"></iframe>
-</body></html>)rawliteral";
-
-// HTML web page to handle 2 input fields (html_zip_pin, html_country_code)
-const char index_html_location_details[] PROGMEM = R"rawliteral(
-<!DOCTYPE HTML><html><head>
-  <title>Long Press Alarm Clock</title>
-  <meta name="viewport" content="width=device-width, initial-scale=1">
-  <script>
-    function submitMessage() {
-      alert("Sent! Press 'Save' on device to set!");
-      setTimeout(function(){ document.location.reload(false); }, 500);   
-    }
-  </script></head><body>
-  <form action="/get" target="hidden-form">
-  	<a href="https://github.com/pk17r/Long_Press_Alarm_Clock/tree/release" target="_blank"><h3>Long Press Alarm Clock</h3></a>
-    <h4>Enter Location Details:</h4>
-    <label>Location ZIP/PIN Code:</label><br>
-    <input type="number" name="html_zip_pin" value="%html_zip_pin%" min="10000" max="999999"><br><br>
-    <label>2-Letter Country Code (</label>
-    <a href="https://en.wikipedia.org/wiki/List_of_ISO_3166_country_codes#Current_ISO_3166_country_codes" target="_blank">List</a>
-    <label>):</label><br>
-    <input type="text" name="html_country_code" value="%html_country_code%" oninput="this.value = this.value.toUpperCase()"><br><br>
-    <input type="submit" value="Submit" onclick="submitMessage()">
-  </form>
-  <iframe style="display:none" name="hidden-form"></iframe>
-</body></html>)rawliteral";
-
-// Replaces placeholder with stored values
-String processor(const String& var){
-  if(strcmp(var.c_str(), kHtmlParamKeySsid) == 0){
-    return temp_ssid_str;
-  }
-  else if(strcmp(var.c_str(), kHtmlParamKeyPasswd) == 0){
-    return temp_passwd_str;
-  }
-  else if(strcmp(var.c_str(), kHtmlParamKeyZipPin) == 0){
-    return temp_zip_pin_str;
-  }
-  else if(strcmp(var.c_str(), kHtmlParamKeyCountryCode) == 0){
-    return temp_country_code_str;
-  }
-  return String();
-}
-
-void _SoftAPWiFiDetails() {
-
-  temp_ssid_str = wifi_stuff->wifi_ssid_.c_str();
-  temp_passwd_str = wifi_stuff->wifi_password_.c_str();
-
-  extern String processor(const String& var);
-
-  // Send web page with input fields to client
-  server->on("/", HTTP_GET, [](AsyncWebServerRequest *request){
-    request->send_P(200, "text/html", index_html_wifi_details, processor);
-  });
-
-  // Send a GET request to <ESP_IP>/get?inputString=<inputMessage>
-  server->on("/get", HTTP_GET, [] (AsyncWebServerRequest *request) {
-    String inputMessage;
-    // GET inputString value on <ESP_IP>/get?inputString=<inputMessage>
-    if (request->hasParam(kHtmlParamKeySsid)) {
-      inputMessage = request->getParam(kHtmlParamKeySsid)->value();
-      temp_ssid_str = inputMessage;
-    }
-    // GET html_passwd value on <ESP_IP>/get?html_passwd=<inputMessage>
-    if (request->hasParam(kHtmlParamKeyPasswd)) {
-      inputMessage = request->getParam(kHtmlParamKeyPasswd)->value();
-      temp_passwd_str = inputMessage;
-    }
-    Serial.println(inputMessage);
-    request->send(200, "text/text", inputMessage);
-  });
-
-  // server->onNotFound(notFound);
-  server->begin();
-}
-
-void _LocalServerLocationInputs() {
-
-  temp_zip_pin_str = std::to_string(wifi_stuff->location_zip_code_).c_str();
-  temp_country_code_str = wifi_stuff->location_country_code_.c_str();
-
-  extern String processor(const String& var);
-
-  // Send web page with input fields to client
-  server->on("/", HTTP_GET, [](AsyncWebServerRequest *request){
-    request->send_P(200, "text/html", index_html_location_details, processor);
-  });
-
-  // Send a GET request to <ESP_IP>/get?inputString=<inputMessage>
-  server->on("/get", HTTP_GET, [] (AsyncWebServerRequest *request) {
-    String inputMessage;
-    // GET inputString value on <ESP_IP>/get?inputString=<inputMessage>
-    if (request->hasParam(kHtmlParamKeyZipPin)) {
-      inputMessage = request->getParam(kHtmlParamKeyZipPin)->value();
-      temp_zip_pin_str = inputMessage;
-    }
-    // GET html_passwd value on <ESP_IP>/get?html_passwd=<inputMessage>
-    if (request->hasParam(kHtmlParamKeyCountryCode)) {
-      inputMessage = request->getParam(kHtmlParamKeyCountryCode)->value();
-      temp_country_code_str = inputMessage;
-    }
-    Serial.println(inputMessage);
-    request->send(200, "text/text", inputMessage);
-  });
-
-  // server->onNotFound(notFound);
-  server->begin();
-}
-
 // ESP32 Web OTA Update
 
 // check for available firmware update
@@ -640,57 +918,60 @@ bool WiFiStuff::FirmwareVersionCheck() {
     if(!TurnWiFiOn())
       return false;
 
-  String payload;
+  // check metrics
+  unsigned long check_start_ms = millis();
+  uint32_t heap_free_start = esp_get_free_heap_size(), heap_free_min = heap_free_start;
+  uint32_t body_bytes_read = 0;
+
+  FirmwareVersionMatcher matcher;
+  matcher.Reset(kFwSearchStr.c_str());
+
+  std::lock_guard<std::mutex> github_client_lock(github_client_mutex_);
+
   int httpCode;
-  String fwurl = "";
-  fwurl += (debug_mode ? URL_fw_Version_debug_mode.c_str() : URL_fw_Version_release.c_str());
-  fwurl += "?";
-  fwurl += String(rand());
-  Serial.println(fwurl);
-  WiFiClientSecure * client = new WiFiClientSecure;
-
-  if (client) 
+  std::string fwurl = (use_version_manifest ? (debug_mode ? URL_fw_Manifest_debug_mode : URL_fw_Manifest_release)
+                                            : (debug_mode ? URL_fw_Version_debug_mode : URL_fw_Version_release));
+  fwurl += "?" + std::to_string(rand());
+  Serial.println(fwurl.c_str());
   {
-    if(use_secure_connection)
-      client->setCACert(rootCACertificate);
-    else
-      client->setInsecure();//skip verification
-
-    // Add a scoping block for HTTPClient https to make sure it is destroyed before WiFiClientSecure *client is 
     HTTPClient https;
-
-    if (https.begin( * client, fwurl)) 
-    { // HTTPS      
-      Serial.print("[HTTPS] GET...\n");
-      // start connection and send HTTP header
-      delay(100);
-      httpCode = https.GET();
-      delay(100);
-      if (httpCode == HTTP_CODE_OK) // if version received
-        payload = https.getString(); // save received version
-      else
-        Serial.printf("error in downloading version file: %d\n", httpCode);
-      https.end();
+    Serial.print("[HTTPS] GET...\n");
+    httpCode = GitHubGet(https, fwurl);
+    heap_free_min = min(heap_free_min, esp_get_free_heap_size());   // TLS handshake buffers
+    int remaining_bytes = https.getSize();   // -1 over HTTP/1.0 without length, body ends at close
+    if (httpCode == HTTP_CODE_OK) { // if version received
+      // scan body chunk by chunk, stop reading as soon as version literal is parsed
+      WiFiClient* stream = https.getStreamPtr();
+      unsigned long last_data_time_ms = millis();
+      uint8_t buffer[128];
+      while((remaining_bytes > 0 || remaining_bytes == -1) && !matcher.Done()) {
+        heap_free_min = min(heap_free_min, esp_get_free_heap_size());
+        int available_bytes = stream->available();
+        if(available_bytes > 0) {
+          int read_bytes = stream->readBytes(buffer, min(available_bytes, (int)sizeof(buffer)));
+          matcher.Feed(buffer, read_bytes);
+          body_bytes_read += read_bytes;
+          if(remaining_bytes > 0) remaining_bytes -= read_bytes;
+          last_data_time_ms = millis();
+        }
+        else if(!https.connected() || millis() - last_data_time_ms > kWeatherStreamTimeoutMs)
+          break;
+        else
+          delay(1);
+      }
     }
-    delete client;
+    else
+      Serial.printf("error in downloading version file: %d\n", httpCode);
+    GitHubRequestEnd(https, remaining_bytes);
   }
+  // connection stays for firmware download
+  if(!reuse_github_connection || !matcher.Done() || strcmp(matcher.version, kFirmwareVersion.c_str()) == 0)
+    ReleaseGitHubClient();
 
-  std::string payload_str = payload.c_str();
-  Serial.printf("payload_str: %s\n\n", payload_str.c_str());
-  Serial.printf("kFwSearchStr: %s\n", kFwSearchStr.c_str());
-
-  int search_str_index = payload_str.find(kFwSearchStr);
-  // Serial.print("search_str_index = ");
-  // Serial.println(search_str_index);
+  Serial.printf("Firmware version check: %u body bytes read, heap peak %u bytes, %lu ms\n", body_bytes_read, heap_free_start - heap_free_min, millis() - check_start_ms);
 
-  if(search_str_index >= 0) {
-    int fw_start_index = payload_str.find('"', search_str_index) + 1;
-    int fw_end_index = payload_str.find('"', fw_start_index);
-    // Serial.print("fw_start_index = ");
-    // Serial.println(fw_start_index);
-    // Serial.print("fw_end_index = ");
-    // Serial.println(fw_end_index);
-    std::string fw_str = payload_str.substr(fw_start_index, fw_end_index - fw_start_index);
+  if(matcher.Done()) {
+    std::string fw_str = matcher.version;
     Serial.printf("Available kFirmwareVersion: %s\n", fw_str.c_str());
     Serial.printf("Active kFirmwareVersion: %s\n", kFirmwareVersion.c_str());
     firmware_update_available_str_ = fw_str;
@@ -717,20 +998,33 @@ void WiFiStuff::UpdateFirmware() {
     if(!TurnWiFiOn())
       return;
 
-  WiFiClientSecure client;
-
-  if(use_secure_connection)
-    client.setCACert(rootCACertificate);
-  else
-    client.setInsecure();//skip verification
-
   httpUpdate.setLedPin(LED_PIN, HIGH);
 
+  std::lock_guard<std::mutex> github_client_lock(github_client_mutex_);
+
   // increase watchdog timeout to 90s to accomodate OTA update
   if(!debug_mode) SetWatchdogTime(kWatchdogTimeoutOtaUpdateMs);
 
-  Serial.println(debug_mode ? URL_fw_Bin_debug_mode.c_str() : URL_fw_Bin_release.c_str());
-  t_httpUpdate_return ret = httpUpdate.update(client, (debug_mode ? URL_fw_Bin_debug_mode.c_str() : URL_fw_Bin_release.c_str()));
+  // smallest image first: delta against running firmware, compressed firmware, then full binary
+  std::string fw_bin_url = (debug_mode ? URL_fw_Bin_debug_mode : URL_fw_Bin_release);
+  std::string build_dir_url = fw_bin_url.substr(0, fw_bin_url.rfind('/') + 1);
+  if(UpdateFirmwareFromOtaImage(build_dir_url + "delta_from_" + kFirmwareVersion + ".lpoi")
+      || UpdateFirmwareFromOtaImage(fw_bin_url + ".lpoi")) {
+    Serial.println("OTA image update done, restarting.");
+    delay(100);
+    esp_restart();
+  }
+
+  // raw binary in verified chunks, resumes a previous download
+  if(UpdateFirmwareResumable(fw_bin_url)) {
+    Serial.println("Resumable OTA update done, restarting.");
+    delay(100);
+    esp_restart();
+  }
+
+  Serial.println(fw_bin_url.c_str());
+  github_requests_++;
+  t_httpUpdate_return ret = httpUpdate.update(*GitHubClient(fw_bin_url), fw_bin_url.c_str());
 
   switch (ret) {
   case HTTP_UPDATE_FAILED:
@@ -746,6 +1040,290 @@ void WiFiStuff::UpdateFirmware() {
     break;
   }
   PrintLn("UpdateFirmware() unsuccessful.");
+  ReleaseGitHubClient();
   if(!debug_mode) SetWatchdogTime(kWatchdogTimeoutMs);
 }
+
+static bool OtaImageWrite(const uint8_t* data, size_t length, void* context) {
+  return Update.write((uint8_t*)data, length) == length;
+}
+
+static bool OtaImageBaseRead(uint32_t offset, uint8_t* data, size_t length, void* context) {
+  return esp_partition_read((const esp_partition_t*)context, offset, data, length) == ESP_OK;
+}
+
+static bool OtaFlashWrite(uint32_t offset, const uint8_t* data, size_t length, void* context) {
+  return esp_partition_write((const esp_partition_t*)context, offset, data, length) == ESP_OK;
+}
+
+static bool OtaFlashErase(uint32_t offset, size_t length, void* context) {
+  return esp_partition_erase_range((const esp_partition_t*)context, offset, length) == ESP_OK;
+}
+
+// TLS client for raw.githubusercontent.com, connects if not connected
+// with reuse_github_connection an open keep-alive connection from the previous request is used again,
+// Arduino ssl_client has no TLS session ticket cache, so a closed connection costs a full handshake
+WiFiClientSecure* WiFiStuff::GitHubClient(const std::string &url) {
+  if(github_client_ == NULL) {
+    github_client_ = new WiFiClientSecure;
+    if(use_secure_connection)
+      github_client_->setCACert(rootCACertificate);
+    else
+      github_client_->setInsecure();//skip verification
+  }
+  github_client_reused_ = github_client_->connected();
+  if(!github_client_reused_) {
+    size_t host_start = url.find("://") + 3;
+    std::string host = url.substr(host_start, url.find('/', host_start) - host_start);
+    unsigned long handshake_start_ms = millis();
+    uint32_t heap_free_before = esp_get_free_heap_size();
+    if(github_client_->connect(host.c_str(), 443)) {
+      github_handshakes_++;
+      github_handshake_ms_ += millis() - handshake_start_ms;
+      github_tls_heap_bytes_ = heap_free_before - esp_get_free_heap_size();
+      Serial.printf("GitHub TLS handshake %lu ms, mbedTLS heap %u bytes\n", millis() - handshake_start_ms, github_tls_heap_bytes_);
+    }
+  }
+  return github_client_;
+}
+
+// GET on shared GitHub connection, a stale reused connection is replaced by a new one once
+// body is read raw from stream by callers, so it is either Content-Length bytes or, over HTTP/1.0 only,
+// everything until connection closes. getSize() is -1 only in the HTTP/1.0 case.
+int WiFiStuff::GitHubGet(HTTPClient &https, const std::string &url, const char* range) {
+  int httpCode = HTTPC_ERROR_CONNECTION_REFUSED;
+  bool http10 = !reuse_github_connection;
+  for (uint8_t attempt = 0; attempt < 3; attempt++) {
+    WiFiClientSecure* client = GitHubClient(url);
+    if(!https.begin(*client, url.c_str()))
+      return HTTPC_ERROR_CONNECTION_REFUSED;
+    // HTTP/1.0 has no chunked encoding and closes connection, HTTP/1.1 keeps it alive
+    https.useHTTP10(http10);
+    https.setReuse(!http10);
+    if(range != NULL)
+      https.addHeader("Range", range);
+    github_requests_++;
+    httpCode = https.GET();
+    if(httpCode > 0 && !http10 && https.getSize() < 0)
+      // HTTP/1.1 body without Content-Length is chunked, ask again over HTTP/1.0
+      http10 = true;
+    else if(httpCode > 0 || !github_client_reused_)
+      break;
+    https.setReuse(false);
+    https.end();
+    client->stop();
+  }
+  return httpCode;
+}
+
+// end request, connection is kept only if whole response body is read off
+void WiFiStuff::GitHubRequestEnd(HTTPClient &https, int unread_bytes) {
+  if(unread_bytes > 0 && unread_bytes <= kGitHubDrainMaxBytes) {
+    WiFiClient* stream = https.getStreamPtr();
+    unsigned long last_data_time_ms = millis();
+    while(unread_bytes > 0 && https.connected() && millis() - last_data_time_ms < kWeatherStreamTimeoutMs) {
+      int available_bytes = stream->available();
+      if(available_bytes > 0) {
+        uint8_t buffer[128];
+        unread_bytes -= stream->readBytes(buffer, min(min(available_bytes, unread_bytes), (int)sizeof(buffer)));
+        last_data_time_ms = millis();
+      }
+      else
+        delay(1);
+    }
+  }
+  if(unread_bytes != 0)
+    https.setReuse(false);    // body length unknown or not read, connection closes
+  https.end();
+}
+
+void WiFiStuff::ReleaseGitHubClient() {
+  if(github_client_ == NULL)
+    return;
+  Serial.printf("GitHub TLS %s: %u requests, %u handshakes, %lu ms handshaking, mbedTLS heap %u bytes\n",
+    (reuse_github_connection ? "keep-alive" : "connection per request"), github_requests_, github_handshakes_, github_handshake_ms_, github_tls_heap_bytes_);
+  github_client_->stop();
+  delete github_client_;
+  github_client_ = NULL;
+  github_requests_ = 0;
+  github_handshakes_ = 0;
+  github_handshake_ms_ = 0;
+}
+
+// stream an OTA image through OtaImageDecoder into Update partition writer
+// returns false if image is not there or update failed, next image is tried then
+bool WiFiStuff::UpdateFirmwareFromOtaImage(const std::string &url) {
+  Serial.println(url.c_str());
+  HTTPClient https;
+  int httpCode = GitHubGet(https, url);
+  if(httpCode != HTTP_CODE_OK) {
+    Serial.printf("OTA image not available: %d\n", httpCode);
+    GitHubRequestEnd(https, https.getSize());
+    return false;
+  }
+
+  WiFiClient* stream = https.getStreamPtr();
+  int remaining_bytes = https.getSize();   // -1 over HTTP/1.0 without length, body ends at close
+  OtaImageDecoder* decoder = new OtaImageDecoder;
+  decoder->Begin(OtaImageWrite, OtaImageBaseRead, (void*)esp_ota_get_running_partition());
+  bool update_started = false;
+  bool success = false;
+  uint8_t buffer[512];
+  unsigned long start_ms = millis(), last_data_time_ms = millis();
+  uint32_t image_bytes_read = 0;
+
+  while(remaining_bytes > 0 || remaining_bytes == -1) {
+    int available_bytes = stream->available();
+    if(available_bytes > 0) {
+      // header alone first, so that Update partition is opened with firmware size before any firmware byte
+      size_t read_size = (update_started ? sizeof(buffer) : OtaImageDecoder::kHeaderSize - image_bytes_read);
+      int read_bytes = stream->readBytes(buffer, min(available_bytes, (int)read_size));
+      image_bytes_read += read_bytes;
+      if(remaining_bytes > 0) remaining_bytes -= read_bytes;
+      last_data_time_ms = millis();
+      if(!decoder->Feed(buffer, read_bytes))
+        break;
+      // decoding and flash writes of a whole image outlast watchdog timeout in debug mode
+      ResetWatchdog();
+      if(!update_started && decoder->HeaderReady()) {
+        // Update writes next OTA partition, a resumable download checkpoint there is void
+        OtaCheckpointRecord checkpoint = {};
+        nvs_preferences->SaveOtaCheckpoint(&checkpoint);
+        if(!Update.begin(decoder->header().image_size)) {
+          Serial.println("OTA image: Update.begin() failed");
+          break;
+        }
+        update_started = true;
+      }
+    }
+    else if(!https.connected() || millis() - last_data_time_ms > kWeatherStreamTimeoutMs)
+      break;
+    else
+      delay(1);
+  }
+  GitHubRequestEnd(https, remaining_bytes);
+
+  if(update_started && decoder->Finish() && Update.end())
+    success = true;
+  else if(update_started)
+    Update.abort();
+  Serial.printf("OTA image: %u bytes read, firmware %u bytes, %lu ms, error %d, success %d\n", image_bytes_read, decoder->output_size(), millis() - start_ms, decoder->error(), success);
+  delete decoder;
+  return success;
+}
+
+// download raw firmware binary with HTTP Range requests into next OTA partition, chunk hashes from manifest
+// progress is checkpointed in NVS after every verified chunk, a dropped connection resumes from there,
+// in this attempt after a backoff, or in a later attempt if this one runs out of retries
+bool WiFiStuff::UpdateFirmwareResumable(const std::string &fw_bin_url) {
+  const esp_partition_t* partition = esp_ota_get_next_update_partition(NULL);
+  if(partition == NULL)
+    return false;
+
+  // manifest
+  OtaChunkedWriter* writer = new OtaChunkedWriter;
+  bool manifest_ok = false;
+  {
+    HTTPClient https;
+    std::string manifest_url = fw_bin_url + ".manifest";
+    Serial.println(manifest_url.c_str());
+    int httpCode = GitHubGet(https, manifest_url);
+    int manifest_size = https.getSize();
+    if(httpCode == HTTP_CODE_OK && manifest_size > 0 && manifest_size <= kOtaManifestMaxSize) {
+      uint8_t* manifest = new uint8_t[manifest_size];
+      int read_bytes = https.getStreamPtr()->readBytes(manifest, manifest_size);
+      manifest_ok = (read_bytes == manifest_size && writer->SetManifest(manifest, manifest_size, OtaFlashWrite, OtaFlashErase, OtaImageBaseRead, (void*)partition));
+      manifest_size -= read_bytes;
+      delete[] manifest;
+    }
+    else
+      Serial.printf("OTA manifest not available: %d\n", httpCode);
+    GitHubRequestEnd(https, manifest_size);
+  }
+  uint32_t image_size = writer->manifest().image_size;
+  if(!manifest_ok || image_size > partition->size) {
+    delete writer;
+    return false;
+  }
+
+  // resume same firmware in same partition
+  OtaCheckpointRecord checkpoint;
+  if(nvs_preferences->RetrieveOtaCheckpoint(&checkpoint) && checkpoint.partition_address == partition->address
+      && memcmp(checkpoint.image_sha256, writer->manifest().image_sha256, sizeof(checkpoint.image_sha256)) == 0)
+    writer->Resume(checkpoint.bytes_done);
+  memcpy(checkpoint.image_sha256, writer->manifest().image_sha256, sizeof(checkpoint.image_sha256));
+  checkpoint.partition_address = partition->address;
+  checkpoint.bytes_done = writer->bytes_done();
+  Serial.printf("Resumable OTA: %u of %u bytes done\n", checkpoint.bytes_done, image_size);
+
+  unsigned long start_ms = millis();
+  uint32_t start_bytes = writer->bytes_done();
+  uint8_t failed_attempts = 0;
+  uint8_t buffer[512];
+  while(!writer->Complete() && failed_attempts < kOtaDownloadAttempts) {
+    HTTPClient https;
+    bool progress = false;
+    {
+      uint32_t range_start = writer->bytes_done();
+      char range[24];
+      snprintf(range, sizeof(range), "bytes=%u-", range_start);
+      int httpCode = GitHubGet(https, fw_bin_url, range);
+      int remaining_bytes = https.getSize();
+      // a server that ignores Range sends whole file
+      if(httpCode == 206 || (httpCode == HTTP_CODE_OK && range_start == 0)) {
+        WiFiClient* stream = https.getStreamPtr();
+        unsigned long last_data_time_ms = millis();
+        while(!writer->Complete()) {
+          int available_bytes = stream->available();
+          if(available_bytes > 0) {
+            int read_bytes = stream->readBytes(buffer, min(available_bytes, (int)sizeof(buffer)));
+            if(remaining_bytes > 0) remaining_bytes -= read_bytes;
+            uint32_t bytes_done_before = writer->bytes_done();
+            if(!writer->Feed(buffer, read_bytes))
+              break;
+            last_data_time_ms = millis();
+            if(writer->bytes_done() != bytes_done_before) {
+              // chunk verified
+              progress = true;
+              checkpoint.bytes_done = writer->bytes_done();
+              nvs_preferences->SaveOtaCheckpoint(&checkpoint);
+              ResetWatchdog();
+              unsigned long elapsed_ms = max(millis() - start_ms, 1UL);
+              if(ota_progress_callback_ != NULL)
+                ota_progress_callback_(writer->bytes_done(), image_size, (uint64_t)(writer->bytes_done() - start_bytes) * 1000 / elapsed_ms);
+            }
+          }
+          else if(!https.connected() || millis() - last_data_time_ms > kWeatherStreamTimeoutMs)
+            break;
+          else
+            delay(1);
+        }
+      }
+      else
+        Serial.printf("Resumable OTA: HTTP %d\n", httpCode);
+      GitHubRequestEnd(https, remaining_bytes);
+    }
+    writer->DropPartialChunk();
+    if(!writer->Complete()) {
+      // retry from last verified chunk, attempts count only while no chunk gets through
+      failed_attempts = (progress ? 0 : failed_attempts + 1);
+      Serial.printf("Resumable OTA: connection dropped at %u bytes, attempt %u\n", writer->bytes_done(), failed_attempts);
+      if(failed_attempts < kOtaDownloadAttempts)
+        delay(1000 * failed_attempts);
+      if(!wifi_connected_ && !TurnWiFiOn())
+        break;
+    }
+  }
+
+  bool success = false;
+  if(writer->Complete()) {
+    // whole image verified chunk by chunk, boot partition check validates image again
+    success = (esp_ota_set_boot_partition(partition) == ESP_OK);
+    checkpoint.bytes_done = 0;
+    nvs_preferences->SaveOtaCheckpoint(&checkpoint);
+  }
+  Serial.printf("Resumable OTA: %u of %u bytes, %lu ms, success %d\n", writer->bytes_done(), image_size, millis() - start_ms, success);
+  delete writer;
+  return success;
+}
 #endif
\ No newline at end of file
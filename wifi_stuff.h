@@ -4,26 +4,60 @@
 
 #include "common.h"
 #include "secrets.h"
+#include "dns_cache.h"
 #include <sys/_stdint.h>      // try removing it, don't know why it is here
 
+class WiFiClient;
+#if defined(MCU_IS_ESP32)
+  #include <mutex>
+  class WiFiClientSecure;
+  class HTTPClient;
+#endif
+
 class WiFiStuff {
 
 public:
+
+  enum WiFiConnectState : uint8_t {
+    kWiFiIdle = 0,            // not connected and not connecting
+    kWiFiFastConnecting,      // directed connect to cached access point
+    kWiFiConnecting,          // scan, association and DHCP
+    kWiFiBackoff,             // waiting before next connect attempt
+    kWiFiConnected,
+    kWiFiFailedCredentials,   // access point rejected WiFi details
+    kWiFiFailedNoAp,          // access point not found or too slow in all attempts
+  };
+  typedef void (*WiFiConnectProgressCallback)(WiFiConnectState state, uint8_t attempt);
+  typedef void (*OtaProgressCallback)(uint32_t bytes_done, uint32_t bytes_total, uint32_t bytes_per_second);
+
   WiFiStuff();
   void SaveWiFiDetails();
   std::string WiFiDetailsShortString();
   void SaveWeatherLocationDetails();
   void SaveWeatherUnits();
   bool TurnWiFiOn();
+  WiFiConnectState WiFiConnectStep();
+  WiFiConnectState wifi_connect_state() { return wifi_connect_state_; }
+  // connect attempts or backoff still running, connect ends in kWiFiConnected or a failed state
+  bool WiFiConnectInProgress() { WiFiConnectState state = wifi_connect_state_; return (state == kWiFiFastConnecting || state == kWiFiConnecting || state == kWiFiBackoff); }
+  void SetWiFiConnectProgressCallback(WiFiConnectProgressCallback callback) { wifi_connect_progress_callback_ = callback; }
   void TurnWiFiOff();
   void GetTodaysWeatherInfo();
+  bool WeatherCacheFresh();
+  bool GmtOffsetFresh();
+  void InvalidateWeatherCache();
   bool GetTimeFromNtpServer();
+  uint32_t TakeRadioOnSeconds();
+  void PrintWiFiConnectTimes();
+  // percentiles of last connect times, returns false if there are none
+  bool WiFiConnectTimePercentiles(bool fast_connect, uint16_t &connects, uint16_t &p50_ms, uint16_t &p90_ms, uint16_t &max_ms);
 #if defined(MCU_IS_ESP32)
   void StartSetWiFiSoftAP();
   void StopSetWiFiSoftAP();
   void StartSetLocationLocalServer();
   void StopSetLocationLocalServer();
   void UpdateFirmware();
+  void SetOtaProgressCallback(OtaProgressCallback callback) { ota_progress_callback_ = callback; }
   bool FirmwareVersionCheck();
 #endif
 
@@ -54,11 +88,27 @@ public:
   uint8_t get_weather_info_wait_seconds_ = 0;   // wait to delay weather info pulls
   unsigned long last_fetch_weather_info_time_ms_ = 0;
   const unsigned long kFetchWeatherInfoMinIntervalMs = 60*1000;    //  1 minute
+  const unsigned long kWeatherStreamTimeoutMs = 3000;    // no data for this long ends weather response read
+  const uint32_t kWeatherCacheTtlMinutes = 60;    // weather is served from cache, fetched only after this
+  const uint32_t kGmtOffsetCacheTtlMinutes = 12 * 60;   // gmt offset from cache is used for time updates, if not fetched before last 2 AM
+  uint16_t weather_http_requests_ = 0;    // since boot
   bool incorrect_zip_code = false;
 
   bool auto_updated_time_today_ = false;   // auto update time once every day at 2:01 AM
   bool manual_time_update_successful_ = false;   // flag used to know if manual time update fetch was success
   unsigned long last_ntp_server_time_update_time_ms = 0;
+  // RTC error found by NTP updates, NTP minus RTC seconds, drift over time since previous update
+  bool ntp_offset_valid_ = false;
+  int32_t last_ntp_offset_sec_ = 0;
+  float rtc_drift_ppm_ = 0;
+  uint32_t last_ntp_epoch_ = 0;
+  const uint32_t kRtcDriftMinSeconds = 6 * 3600;   // 1 s offset resolution, shorter spans give noisy drift
+  const int32_t kRtcDriftMaxOffsetSec = 300;
+
+  // weather and NTP host addresses, kept across WiFi sessions while their TTL runs
+  DnsCache dns_cache_{ResolveOverUdp};
+  // also keep DNS cache in NVS over reboots, saved only when an address changes
+  const bool save_dns_cache_to_nvs = true;
 
   uint32_t location_zip_code_ = 92104;
 
@@ -68,9 +118,23 @@ public:
 
   volatile bool wifi_connected_ = false;
 
+  // radio on time accounting, from TurnWiFiOn() to TurnWiFiOff()
+  bool radio_on_ = false;
+  unsigned long radio_on_start_ms_ = 0;
+  unsigned long radio_on_ms_ = 0;    // since last TakeRadioOnSeconds()
+
   // flag to stop trying auto connect to WiFi
   bool incorrect_wifi_details_ = false;
 
+  // WiFi connect timeouts and backoff
+  unsigned long wifi_fast_connect_timeout_ms_ = 1500;     // directed connect to cached access point
+  unsigned long wifi_connect_timeout_ms_ = 8000;          // scan, association and DHCP, slow access points need a few seconds
+  unsigned long wifi_backoff_base_ms_ = 1000;             // wait before next attempt, doubles every attempt
+  uint8_t wifi_connect_attempts_ = 3;
+  unsigned long wifi_no_ap_retry_holdoff_ms_ = 60*1000;   // no new connect for this long after all attempts failed
+  const unsigned long kWiFiConnectPollMs = 20;
+  const uint32_t kWiFiLeaseReuseMinutes = 12 * 60;        // cached DHCP lease is used as static IP within this age
+
   std::string soft_AP_IP = "";
 
   // flag to to know if new firmware update is available
@@ -111,20 +175,31 @@ public:
 
   // bool to indicate whether Web OTA Update needs to be secure or insecure
   const bool use_secure_connection = false;
+  // keep one TLS connection to raw.githubusercontent.com open for version check and firmware download,
+  // false does a new TLS handshake for every request
+  const bool reuse_github_connection = true;
 
   // Web OTA Update https://github.com/programmer131/ESP8266_ESP32_SelfUpdate/tree/master
   // ESP32 WiFiClientSecure examples: WiFiClientInsecure.ino WiFiClientSecure.ino
   const std::string URL_fw_Version_debug_mode = "https://raw.githubusercontent.com/pk17r/Long_Press_Alarm_Clock/main/configuration.h";
   const std::string URL_fw_Version_release    = "https://raw.githubusercontent.com/pk17r/Long_Press_Alarm_Clock/release/configuration.h";
+  // optional version manifest next to firmware binary, holds only this MCU's firmware version define line
+  const bool use_version_manifest = false;
   #if defined(MCU_IS_ESP32_WROOM_DA_MODULE)
     const std::string URL_fw_Bin_debug_mode = "https://raw.githubusercontent.com/pk17r/Long_Press_Alarm_Clock/main/build/esp32.esp32.esp32da/long_press_alarm_clock.ino.bin";
     const std::string URL_fw_Bin_release    = "https://raw.githubusercontent.com/pk17r/Long_Press_Alarm_Clock/release/build/esp32.esp32.esp32da/long_press_alarm_clock.ino.bin";
+    const std::string URL_fw_Manifest_debug_mode = "https://raw.githubusercontent.com/pk17r/Long_Press_Alarm_Clock/main/build/esp32.esp32.esp32da/version.txt";
+    const std::string URL_fw_Manifest_release    = "https://raw.githubusercontent.com/pk17r/Long_Press_Alarm_Clock/release/build/esp32.esp32.esp32da/version.txt";
   #elif defined(MCU_IS_ESP32_S2_MINI)
     const std::string URL_fw_Bin_debug_mode = "https://raw.githubusercontent.com/pk17r/Long_Press_Alarm_Clock/main/build/esp32.esp32.lolin_s2_mini/long_press_alarm_clock.ino.bin";
     const std::string URL_fw_Bin_release    = "https://raw.githubusercontent.com/pk17r/Long_Press_Alarm_Clock/release/build/esp32.esp32.lolin_s2_mini/long_press_alarm_clock.ino.bin";
+    const std::string URL_fw_Manifest_debug_mode = "https://raw.githubusercontent.com/pk17r/Long_Press_Alarm_Clock/main/build/esp32.esp32.lolin_s2_mini/version.txt";
+    const std::string URL_fw_Manifest_release    = "https://raw.githubusercontent.com/pk17r/Long_Press_Alarm_Clock/release/build/esp32.esp32.lolin_s2_mini/version.txt";
   #elif defined(MCU_IS_ESP32_S3)
     const std::string URL_fw_Bin_debug_mode = "https://raw.githubusercontent.com/pk17r/Long_Press_Alarm_Clock/main/build/esp32.esp32.esp32s3/long_press_alarm_clock.ino.bin";
     const std::string URL_fw_Bin_release    = "https://raw.githubusercontent.com/pk17r/Long_Press_Alarm_Clock/release/build/esp32.esp32.esp32s3/long_press_alarm_clock.ino.bin";
+    const std::string URL_fw_Manifest_debug_mode = "https://raw.githubusercontent.com/pk17r/Long_Press_Alarm_Clock/main/build/esp32.esp32.esp32s3/version.txt";
+    const std::string URL_fw_Manifest_release    = "https://raw.githubusercontent.com/pk17r/Long_Press_Alarm_Clock/release/build/esp32.esp32.esp32s3/version.txt";
   #endif
 
 // PRIVATE VARIABLES
@@ -132,6 +207,72 @@ public:
 private:
 
   void ConvertEpochIntoDate(unsigned long epoch_since_1970, int &today, int &month, int &year);
+  void ApplyWeatherCache(const WeatherCacheRecord &weather_cache);
+  uint32_t WeatherCacheAgeMinutes();
+#if defined(MCU_IS_ESP32)
+  bool UpdateFirmwareFromOtaImage(const std::string &url);
+  bool UpdateFirmwareResumable(const std::string &fw_bin_url);
+  OtaProgressCallback ota_progress_callback_ = NULL;
+  // shared TLS client for raw.githubusercontent.com, all OTA requests go to this host.
+  // Version check runs on second core and firmware update on loop(), so github_client_ and its
+  // functions below are used only while holding github_client_mutex_.
+  WiFiClientSecure* GitHubClient(const std::string &url);
+  int GitHubGet(HTTPClient &https, const std::string &url, const char* range = NULL);
+  void GitHubRequestEnd(HTTPClient &https, int unread_bytes);
+  void ReleaseGitHubClient();
+  std::mutex github_client_mutex_;
+  WiFiClientSecure* github_client_ = NULL;
+  bool github_client_reused_ = false;
+  uint16_t github_requests_ = 0;
+  uint16_t github_handshakes_ = 0;
+  unsigned long github_handshake_ms_ = 0;
+  uint32_t github_tls_heap_bytes_ = 0;        // heap held by mbedTLS for a connection
+  const int kGitHubDrainMaxBytes = 16384;     // unread body up to this size is read off to keep connection
+  const int kOtaManifestMaxSize = 4096;
+  const uint8_t kOtaDownloadAttempts = 4;     // in a row without a verified chunk
+#endif
+  void StartWiFiConnectAttempt(bool fast_connect);
+  void WiFiConnectAttemptFailed(bool auth_failure);
+  void SetWiFiConnectState(WiFiConnectState state);
+  static bool IsAuthFailure(uint8_t reason);
+  uint32_t WiFiDetailsHash();
+  void SaveWiFiConnectCache();
+  void RecordWiFiConnectTime(bool fast_connect, unsigned long connect_ms);
+
+  // last fetched weather, also kept in NVS
+  WeatherCacheRecord weather_cache_ = {};
+  // weather fetched while RTC time was not set, fetch time is stamped and cache saved once NTP sets RTC
+  bool weather_cache_unstamped_ = false;
+
+  // WiFi connect state machine
+  volatile WiFiConnectState wifi_connect_state_ = kWiFiIdle;
+  WiFiConnectProgressCallback wifi_connect_progress_callback_ = NULL;
+  unsigned long connect_start_ms_ = 0, attempt_start_ms_ = 0, backoff_ms_ = 0;
+  unsigned long no_ap_failure_ms_ = 0;    // 0 = no failure
+  uint8_t connect_attempt_ = 0;           // full connect attempts
+  uint8_t auth_failures_ = 0;
+  bool connect_static_ip_ = false;
+  // set by WiFi event task
+  volatile bool sta_got_ip_ = false;
+  volatile uint8_t sta_disconnect_reason_ = 0;    // 0 = none
+
+  // last access point and DHCP lease, also kept in NVS
+  WiFiConnectCacheRecord wifi_connect_cache_ = {};
+
+  // DNS over UDP to DHCP given DNS server, for TTL, falls back to WiFi.hostByName()
+  static bool ResolveOverUdp(const char* host, uint32_t &ip, uint32_t &ttl_seconds);
+  uint32_t DnsNowSeconds();
+  bool ConnectViaDnsCache(WiFiClient &client, const char* host, uint16_t port);
+  static const uint16_t kDnsTimeoutMs = 600;
+  static const uint8_t kDnsAttempts = 2;
+
+  // connect times ring per connect path, [0] = full connect, [1] = fast connect
+  static const uint8_t kWiFiConnectTimeSamples = 32;
+  struct WiFiConnectTimes {
+    uint16_t samples_ms[kWiFiConnectTimeSamples];
+    uint16_t count;
+  };
+  WiFiConnectTimes wifi_connect_times_[2] = {};
 
   #if defined(MY_OPEN_WEATHER_MAP_API_KEY)   // create a secrets.h file with #define for MY_OPEN_WEATHER_MAP_API_KEY
     std::string openWeatherMapApiKey = MY_OPEN_WEATHER_MAP_API_KEY;